@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Algo/BinarySearch.h"
+
+/**
+ *	Evaluation of the animation tracks, shared by the full precision and the compact animations.
+ *	The keys are interpolated linearly, rotations with slerp. Before the first and after the last key the channel holds its value.
+ */
+struct FAnimationKeySampling
+{
+    // 'getValue' returns the value of a key, so the quantized rotations are only unpacked for the two keys around 'time'
+    template<typename T, typename GetFunc, typename LerpFunc>
+    static T SampleKeys(const TArray<float>& times, const float time, const T& defaultValue, GetFunc getValue, LerpFunc lerp)
+    {
+        const int32 numKeys = times.Num();
+        if (numKeys == 0)
+        {
+            return defaultValue;
+        }
+        if (numKeys == 1 || time <= times[0])
+        {
+            return getValue(0);
+        }
+        if (time >= times[numKeys - 1])
+        {
+            return getValue(numKeys - 1);
+        }
+
+        const int32 key = Algo::UpperBound(times, time) - 1;
+        const float span = times[key + 1] - times[key];
+        const float alpha = span > 0.f ? (time - times[key]) / span : 0.f;
+        return lerp(getValue(key), getValue(key + 1), alpha);
+    }
+
+    // The positions, rotations and scales of a track replace the ones of 'restTransform' they have keys for
+    template<typename TrackType, typename GetRotationFunc>
+    static FTransform SampleTrack(const TrackType& track, const float time, const FTransform& restTransform, GetRotationFunc getRotation)
+    {
+        const auto lerpVector = [](const FVector& a, const FVector& b, const float alpha) { return FMath::Lerp(a, b, alpha); };
+        const FVector position = SampleKeys(track.positionTimes, time, restTransform.GetTranslation(), [&track](const int32 key) { return track.positions[key]; }, lerpVector);
+        const FVector scale = SampleKeys(track.scaleTimes, time, restTransform.GetScale3D(), [&track](const int32 key) { return track.scales[key]; }, lerpVector);
+        const FQuat rotation = SampleKeys(track.rotationTimes, time, restTransform.GetRotation(), getRotation
+            , [](const FQuat& a, const FQuat& b, const float alpha) { return FQuat::Slerp(a, b, alpha); });
+        return FTransform(rotation, position, scale);
+    }
+
+    /**
+     *	Poses 'inOutTransforms' with the tracks of an animation at 'time'. 'inOutTransforms' holds the rest transforms of the bones or nodes.
+     *	@param bNodes	Uses the node indices of the tracks instead of the bone indices
+     */
+    template<typename TrackType>
+    static void SampleTracks(const TArray<TrackType>& tracks, const float time, const bool bNodes, TArray<FTransform>& inOutTransforms)
+    {
+        for (const TrackType& track : tracks)
+        {
+            const int32 index = bNodes ? track.nodeIndex : track.boneIndex;
+            if (inOutTransforms.IsValidIndex(index))
+            {
+                inOutTransforms[index] = track.Sample(time, inOutTransforms[index]);
+            }
+        }
+    }
+};
@@ -4,9 +4,21 @@
 
 #include "AssimpCustom.h"
 #include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
 #include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "RuntimeMeshDeferredRelease.h"
 #include "RuntimeMeshImportExportLibrary.h"
 #include "RuntimeMeshImportExportTypes.h"
+#include "MeshConversionKernels.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "RuntimeMeshImportExportTextureCache.h"
+#include "RuntimeMeshStreamWriter.h"
 //#include "C:/Program Files/Epic Games/UE_4.25/Engine/Source/Runtime/ImageWriteQueue/Public/ImageWriteBlueprintLibrary.h"
 #include "Exporters/TextureExporterTGA.h"
 #include "Exporters/TextureExporterBMP.h"
@@ -14,6 +26,121 @@
 
 #include "ProfilingDebugging/ScopedTimers.h"
 
+namespace
+{
+    bool HasOnlyDefaultColors(const TArray<FColor>& colors)
+    {
+        return FMeshConversionKernels::HasOnlyDefaultColors(colors.GetData(), colors.Num());
+    }
+
+    // Only views may leave out the colors
+    bool AllowsNoColors(const FExportableMeshSection&)
+    {
+        return false;
+    }
+
+    bool AllowsNoColors(const FExportableMeshSectionView&)
+    {
+        return true;
+    }
+
+    bool UsesMeshOptimization(const FRuntimeMeshExportParam& param)
+    {
+        return param.bWeldVertices || param.bRemoveDegenerateTriangles || param.triangleRatio < 1.f || param.bOptimizeVertexCache;
+    }
+
+    // The optimization changes the cached meshes of the nodes
+    uint32 HashMeshOptimization(const FRuntimeMeshExportParam& param)
+    {
+        if (!UsesMeshOptimization(param))
+        {
+            return 0;
+        }
+        uint32 hash = HashCombine(GetTypeHash(param.bWeldVertices), GetTypeHash(param.weldPositionTolerance));
+        hash = HashCombine(hash, HashCombine(GetTypeHash(param.weldNormalTolerance), GetTypeHash(param.weldUVTolerance)));
+        hash = HashCombine(hash, HashCombine(GetTypeHash(param.bRemoveDegenerateTriangles), GetTypeHash(param.triangleRatio)));
+        return HashCombine(hash, HashCombine(GetTypeHash(param.bOptimizeVertexCache), GetTypeHash(param.vertexCacheSize)));
+    }
+
+    /**
+     *	Runs the optimization steps of 'param' on a grouped section with the optimizers of the import.
+     *	Placeholder colors are not converted, the section gets them back for its new vertex count.
+     */
+    void OptimizeExportSection(const FRuntimeMeshExportParam& param, FExportableMeshSection& section)
+    {
+        FRuntimeMeshImportSectionInfo sectionInfo;
+        const int32 numVertices = section.vertices.Num();
+        const bool bHasColors = !HasOnlyDefaultColors(section.vertexColors);
+        sectionInfo.vertices = MoveTemp(section.vertices);
+        sectionInfo.normals = MoveTemp(section.normals);
+        sectionInfo.tangents = MoveTemp(section.tangents);
+        sectionInfo.uv0 = MoveTemp(section.textureCoordinates);
+        sectionInfo.triangles = MoveTemp(section.triangles);
+        if (bHasColors)
+        {
+            sectionInfo.vertexColors.SetNumUninitialized(numVertices);
+            FMeshConversionKernels::ReinterpretColorsAsLinear(section.vertexColors.GetData(), sectionInfo.vertexColors.GetData(), numVertices);
+        }
+
+        bool bHasUnusedVertices = false;
+        if (param.bWeldVertices)
+        {
+            FMeshOptimizer::WeldVertices(sectionInfo, param.weldPositionTolerance, param.weldNormalTolerance, param.weldUVTolerance);
+        }
+        if (param.bRemoveDegenerateTriangles)
+        {
+            bHasUnusedVertices = FMeshOptimizer::RemoveDegenerateTriangles(sectionInfo, KINDA_SMALL_NUMBER) > 0;
+        }
+        if (param.triangleRatio < 1.f)
+        {
+            // Only keeps the used vertices
+            const int32 targetTriangles = FMath::Max(FMath::RoundToInt(sectionInfo.triangles.Num() / 3 * FMath::Max(param.triangleRatio, 0.f)), 1);
+            FRuntimeMeshImportSectionInfo simplified;
+            FMeshSimplifier::Simplify(sectionInfo, targetTriangles, simplified);
+            sectionInfo = MoveTemp(simplified);
+            bHasUnusedVertices = false;
+        }
+        if (param.bOptimizeVertexCache)
+        {
+            FMeshOptimizer::OptimizeSection(sectionInfo, param.vertexCacheSize, false);
+        }
+        else if (bHasUnusedVertices)
+        {
+            FMeshOptimizer::OptimizeVertexFetch(sectionInfo);
+        }
+
+        section.vertices = MoveTemp(sectionInfo.vertices);
+        section.normals = MoveTemp(sectionInfo.normals);
+        section.tangents = MoveTemp(sectionInfo.tangents);
+        section.textureCoordinates = MoveTemp(sectionInfo.uv0);
+        section.triangles = MoveTemp(sectionInfo.triangles);
+        if (bHasColors)
+        {
+            section.vertexColors.SetNumUninitialized(sectionInfo.vertexColors.Num());
+            // Back to the bytes they were reinterpreted from, FillAssimpMesh decodes them with FRuntimeMeshExportParam::vertexColorSpace
+            FMeshConversionKernels::QuantizeColors(sectionInfo.vertexColors.GetData(), section.vertexColors.GetData(), sectionInfo.vertexColors.Num(), false);
+        }
+        else
+        {
+            section.vertexColors.Init(FColor::White, section.vertices.Num());
+        }
+    }
+
+    // The exporters of these formats only write the tangents together with the bitangents, @see aiMesh::HasTangentsAndBitangents
+    bool FormatNeedsBitangents(const FString& formatId)
+    {
+        static const TCHAR* formats[] = { TEXT("collada"), TEXT("ply"), TEXT("plyb"), TEXT("assbin"), TEXT("assxml"), TEXT("assjson") };
+        for (const TCHAR* format : formats)
+        {
+            if (formatId.Equals(format, ESearchCase::IgnoreCase))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
 FAssimpScene::FAssimpScene()
 {
     rootNode = new FAssimpNode(FName(), nullptr);
@@ -27,21 +154,53 @@ FAssimpScene::~FAssimpScene()
     delete rootNode;
 }
 
+FAssimpNode* FAssimpScene::FindOrCreateNode(const FString& hierarchicalName)
+{
+    if (FAssimpNode** foundNode = nodesByName.Find(hierarchicalName))
+    {
+        return *foundNode;
+    }
+
+    TArray<FString> nodeList;
+    hierarchicalName.ParseIntoArray(nodeList, TEXT("."), true);
+    FAssimpNode* node = rootNode->FindOrCreateNode(nodeList);
+    nodesByName.Add(hierarchicalName, node);
+    return node;
+}
+
 void FAssimpScene::SetDataAndPtrsToParentClass_EntireScene(const FRuntimeMeshExportParam& param)
 {
     mNumMeshes = meshes.Num();
     mMeshes = (aiMesh**)meshes.GetData();
     mNumMaterials = materials.Num();
     mMaterials = materials.GetData();
+    mNumTextures = embeddedTextures.Num();
+    mTextures = embeddedTextures.GetData();
 
     check(rootNode);
     mRootNode = (aiNode*)rootNode;
+    BuildExportHierarchy(param);
     rootNode->SetDataAndPtrsToParentClass(param);
 
     for (FAssimpMesh* mesh : meshes)
     {
         mesh->SetDataAndPtrsToParentClass(param);
     }
+
+#if STATS
+    int64 sceneMemory = exportArena.GetByteCount();
+    for (const FAssimpMesh* mesh : meshes)
+    {
+        sceneMemory += mesh->vertices.GetAllocatedSize() + mesh->normals.GetAllocatedSize() + mesh->tangents.GetAllocatedSize() + mesh->vertexColors.GetAllocatedSize();
+        for (const TArray<aiVector3D>& textureCoordinates : mesh->textureCoordinates)
+        {
+            sceneMemory += textureCoordinates.GetAllocatedSize();
+        }
+    }
+    DEC_MEMORY_STAT_BY(STAT_RMIE_ExportSceneMemory, statSceneMemory);
+    statSceneMemory = sceneMemory;
+    INC_MEMORY_STAT_BY(STAT_RMIE_ExportSceneMemory, statSceneMemory);
+#endif
 }
 
 FAssimpMesh::~FAssimpMesh()
@@ -62,13 +221,6 @@ FAssimpMesh::~FAssimpMesh()
     mFaces = nullptr;
     mBones = nullptr;
     mAnimMeshes = nullptr;
-
-    for (aiFace& face : faces)
-    {
-        delete[] face.mIndices;
-        face.mIndices = nullptr;
-        face.mNumIndices = 0;
-    }
 }
 
 void FAssimpMesh::SetDataAndPtrsToParentClass(const FRuntimeMeshExportParam& param)
@@ -97,10 +249,41 @@ FAssimpNode::~FAssimpNode()
     {
         delete child;
     }
+    for (FAssimpNode* instanceNode : instanceNodes)
+    {
+        delete instanceNode;
+    }
     // Free our own data
     parent = nullptr;
 }
 
+FTransform FAssimpNode::GetCorrectedRootTransform(const FRuntimeMeshExportParam& param) const
+{
+    // Apply transform corrections
+    FTransform relativeTransform = worldTransform;
+    FVector scale = relativeTransform.GetScale3D();
+    scale *= param.correction.scaleFactor;
+    if (param.correction.bFlipX)
+    {
+        scale.X *= -1.f;
+    }
+    if (param.correction.bFlipY)
+    {
+        scale.Y *= -1.f;
+    }
+    if (param.correction.bFlipZ)
+    {
+        scale.Z *= -1.f;
+    }
+    relativeTransform.SetScale3D(scale);
+
+    FRotator deltaRot(URuntimeMeshImportExportLibrary::RotationCorrectionToValue(param.correction.PitchCorrection_Y)
+                      , URuntimeMeshImportExportLibrary::RotationCorrectionToValue(param.correction.YawCorrection_Z)
+                      , URuntimeMeshImportExportLibrary::RotationCorrectionToValue(param.correction.RollCorrection_X));
+    relativeTransform.ConcatenateRotation(deltaRot.Quaternion());
+    return relativeTransform;
+}
+
 void FAssimpNode::SetDataAndPtrsToParentClass(const FRuntimeMeshExportParam& param)
 {
     // Set the name of the node
@@ -108,45 +291,26 @@ void FAssimpNode::SetDataAndPtrsToParentClass(const FRuntimeMeshExportParam& par
 
     // Set the transform for the node
     FTransform relativeTransform = worldTransform;
-    if (parent) 
+    if (exportParent) 
     {
 		// If has a parent
-        relativeTransform = parent->worldTransform.Inverse() * worldTransform;
+        relativeTransform = exportParent->worldTransform.Inverse() * worldTransform;
     }
     else
     {
 		// Is parent
-
-        // Apply transform corrections
-        FVector scale = relativeTransform.GetScale3D();
-        scale *= param.correction.scaleFactor;
-        if (param.correction.bFlipX)
-        {
-            scale.X *= -1.f;
-        }
-        if (param.correction.bFlipY)
-        {
-            scale.Y *= -1.f;
-        }
-        if (param.correction.bFlipZ)
-        {
-            scale.Z *= -1.f;
-        }
-        relativeTransform.SetScale3D(scale);
-
-        FRotator deltaRot(URuntimeMeshImportExportLibrary::RotationCorrectionToValue(param.correction.PitchCorrection_Y)
-                          , URuntimeMeshImportExportLibrary::RotationCorrectionToValue(param.correction.YawCorrection_Z)
-                          , URuntimeMeshImportExportLibrary::RotationCorrectionToValue(param.correction.RollCorrection_X));
-        relativeTransform.ConcatenateRotation(deltaRot.Quaternion());
+        relativeTransform = GetCorrectedRootTransform(param);
     }
     mTransformation = URuntimeMeshImportExportLibrary::FTransformToAiTransform(relativeTransform);
 
     mNumMeshes = meshRefIndices.Num();
     mMeshes = (unsigned int*)meshRefIndices.GetData();
-    mNumChildren = children.Num();
-    mChildren = (aiNode**)children.GetData();
+    exportChildren = hierarchyChildren;
+    exportChildren.Append(instanceNodes);
+    mNumChildren = exportChildren.Num();
+    mChildren = (aiNode**)exportChildren.GetData();
 
-    for (FAssimpNode* child : children)
+    for (FAssimpNode* child : exportChildren)
     {
         child->SetDataAndPtrsToParentClass(param);
     }
@@ -166,6 +330,8 @@ void FAssimpNode::ClearMeshData()
 {
     indexGatherNext = 0;
     gatheredExportables.Empty();
+    gatheredViews.Empty();
+    gatheredLods.Empty();
     meshRefIndices.Empty();
 }
 
@@ -181,38 +347,35 @@ FString FAssimpNode::GetHierarchicalName() const
     }
 }
 
-FAssimpNode* FAssimpNode::FindOrCreateNode(TArray<FString>& nodePathRelative)
+FAssimpNode* FAssimpNode::FindOrCreateNode(const TArray<FString>& nodePathRelative)
 {
-    if (nodePathRelative.Num() > 0)
+    FAssimpNode* node = this;
+    for (const FString& nodeNameString : nodePathRelative)
     {
-        FName nodeName = FName(*MoveTemp(nodePathRelative[0]));
-        nodePathRelative.RemoveAt(0);
-
-        FAssimpNode** foundNode = children.FindByPredicate([nodeName](FAssimpNode* child) -> bool {
-            return child->name == nodeName;
-        });
-
-        FAssimpNode* childNode = nullptr;
-        if (foundNode)
-        {
-            childNode = *foundNode;
-        }
-        else
+        const FName nodeName = FName(*nodeNameString);
+        FAssimpNode*& childNode = node->childrenByName.FindOrAdd(nodeName);
+        if (!childNode)
         {
-            childNode = children.Add_GetRef(new FAssimpNode(nodeName, this));
+            childNode = node->children.Add_GetRef(new FAssimpNode(nodeName, node));
         }
-
-        check(childNode);
-        return childNode->FindOrCreateNode(nodePathRelative);
+        node = childNode;
     }
 
-    return this;
+    check(node);
+    return node;
 }
 
 void FAssimpNode::ClearExportData()
 {
     ClearParentDataAndPtrs();
     ClearMeshData();
+    for (FAssimpNode* instanceNode : instanceNodes)
+    {
+        delete instanceNode;
+    }
+    instanceNodes.Empty();
+    exportChildren.Empty();
+    sharedGroupedSections.Empty();
     for (FAssimpNode* child : children)
     {
         child->ClearExportData();
@@ -231,516 +394,1573 @@ void FAssimpNode::GetNodesRecursive(TArray<FAssimpNode*>& outNodes)
     }
 }
 
-int32 FAssimpNode::GatherMeshData(FAssimpScene& scene, const FRuntimeMeshExportParam& param, const bool bGatherAll, const int32 numToGather)
+void FAssimpNode::ResetGather()
+{
+    indexGatherNext = 0;
+    gatheredExportables.Reset();
+    gatheredViews.Reset();
+    // One slot per exportable, so the parallel gather writes to its own slots and the order of the exportables is kept
+    gatheredExportables.SetNum(exportObjects.Num());
+    gatheredViews.SetNum(exportObjects.Num());
+    gatheredLods.Reset();
+    gatheredLods.SetNum(exportObjects.Num());
+    sharedInstances.Reset();
+    objectSharedInstances.Reset();
+    objectInstanceTransforms.Reset();
+    objectInstanceTransforms.SetNum(exportObjects.Num());
+}
+
+int32 FAssimpNode::GatherMeshData(FAssimpScene& scene, const FRuntimeMeshExportParam& param, const bool bGatherAll, const int32 numToGather
+        , const double deadline, const bool bGatherAtLeastOne)
 {
     check(IsInGameThread());
     check(bGatherAll || numToGather > 0);
 
+    // The thread safe exportables are skipped, FAssimpScene::GatherThreadSafe gathers them
     int32 numGathered = 0;
-    const int32 startIndex = bGatherAll ? 0 : indexGatherNext;
-    const int32 endIndex = FMath::Min(bGatherAll ? exportObjects.Num() : startIndex + numToGather, exportObjects.Num());
-    for (; indexGatherNext < endIndex; ++indexGatherNext)
+    for (; indexGatherNext < exportObjects.Num() && (bGatherAll || numGathered < numToGather); ++indexGatherNext)
     {
-        ++numGathered;
-
-        TScriptInterface<IMeshExportable>& object = exportObjects[indexGatherNext];
-        TArray<FExportableMeshSection> sections;
-        if (!object->Execute_GetMeshData(object.GetObject(), param.lod, param.bSkipLodNotValid, sections))
+        const TScriptInterface<IMeshExportable>& object = exportObjects[indexGatherNext];
+        // The instances of a shared mesh are placed by their key's transform, the thread safe exportables are gathered in parallel
+        if (IsSharedInstanceOnly(indexGatherNext) || FAssimpScene::IsThreadSafeGather(object))
         {
-            scene.WriteToLogWithNewLine(FString::Printf(TEXT("Object %s refused to be part of export."), *object.GetObject()->GetName()));
-            ++scene.numObjectsSkipped;
             continue;
         }
 
-        if (sections.Num() == 0)
+        const double startTime = FPlatformTime::Seconds();
+        if (deadline > 0.0 && (numGathered > 0 || !bGatherAtLeastOne)
+            && (startTime >= deadline || (scene.bUseGatherCostEstimates && startTime + scene.EstimateGatherCost(object) > deadline)))
+        {
+            break;
+        }
+
+        ++numGathered;
+        if (!GatherExportable(scene, param, indexGatherNext))
         {
-            scene.WriteToLogWithNewLine(FString::Printf(TEXT("Object %s did not return any sections."), *object.GetObject()->GetName()));
             ++scene.numObjectsSkipped;
-            continue;
         }
+        scene.UpdateGatherCostEstimate(object, FPlatformTime::Seconds() - startTime);
+    }
+
+    return numGathered;
+}
+
+bool FAssimpNode::GatherExportable(FAssimpScene& scene, const FRuntimeMeshExportParam& param, const int32 objectIndex)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ExportGather);
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+    TScriptInterface<IMeshExportable>& object = exportObjects[objectIndex];
+    const bool bViews = FAssimpScene::HasMeshDataViews(object);
+    bool bValid = false;
+    if (bViews)
+    {
+        TArray<FExportableMeshSectionView>& views = gatheredViews[objectIndex];
+        const bool bGathered = object.GetInterface()->GetMeshDataViews(param.lod, param.bSkipLodNotValid, views);
+        bValid = ValidateGatheredSections(scene, object, bGathered, views);
+    }
+    else
+    {
+        TArray<FExportableMeshSection>& sections = gatheredExportables[objectIndex];
+        const bool bGathered = object->Execute_GetMeshData(object.GetObject(), param.lod, param.bSkipLodNotValid, sections);
+        bValid = ValidateGatheredSections(scene, object, bGathered, sections);
+    }
+    if (!bValid || scene.additionalLods.Num() == 0)
+    {
+        return bValid;
+    }
 
-        // Validate all sections
+    // An LOD the exportable does not have stays empty, the writers skip it
+    TArray<FGatheredLod>& lods = gatheredLods[objectIndex];
+    lods.SetNum(scene.additionalLods.Num());
+    for (int32 lodIndex = 0; lodIndex < lods.Num(); ++lodIndex)
+    {
+        FGatheredLod& lod = lods[lodIndex];
+        if (bViews)
         {
-            bool bAllSectionsValid = true;
-            for (int32 sectionIndex = sections.Num() - 1; sectionIndex >= 0; --sectionIndex)
+            if (!object.GetInterface()->GetMeshDataViews(scene.additionalLods[lodIndex], param.bSkipLodNotValid, lod.views) || lod.views.Num() == 0)
             {
-                if (!ValidateMeshSection(scene, object, sections[sectionIndex]))
-                {
-                    scene.WriteToLogWithNewLine(FString::Printf(TEXT("Object %s: Section %d failed validation."), *object.GetObject()->GetName(), sectionIndex));
-                    bAllSectionsValid = false;
-                }
+                lod.views.Empty();
+                continue;
             }
-
-            if (!bAllSectionsValid)
+            ValidateGatheredSections(scene, object, true, lod.views);
+        }
+        else
+        {
+            if (!object->Execute_GetMeshData(object.GetObject(), scene.additionalLods[lodIndex], param.bSkipLodNotValid, lod.sections) || lod.sections.Num() == 0)
             {
-                scene.WriteToLogWithNewLine(FString::Printf(TEXT("Object %s has invalid sections. Skipped."), *object.GetObject()->GetName()));
-                ++scene.numObjectsSkipped;
+                lod.sections.Empty();
                 continue;
             }
+            ValidateGatheredSections(scene, object, true, lod.sections);
         }
+    }
+    return true;
+}
 
-        gatheredExportables.Add(sections);
+template<typename SectionType>
+bool FAssimpNode::ValidateGatheredSections(FAssimpScene& scene, TScriptInterface<IMeshExportable>& object, const bool bGathered, TArray<SectionType>& sections)
+{
+    if (!bGathered)
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Object %s refused to be part of export."), *object.GetObject()->GetName());
+        sections.Empty();
+        return false;
     }
 
-    return numGathered;
+    if (sections.Num() == 0)
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Object %s did not return any sections."), *object.GetObject()->GetName());
+        return false;
+    }
+
+    // Validate all sections
+    bool bAllSectionsValid = true;
+    for (int32 sectionIndex = sections.Num() - 1; sectionIndex >= 0; --sectionIndex)
+    {
+        if (!ValidateMeshSection(scene, object, sections[sectionIndex]))
+        {
+            scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Object %s: Section %d failed validation."), *object.GetObject()->GetName(), sectionIndex);
+            bAllSectionsValid = false;
+        }
+    }
+
+    if (!bAllSectionsValid)
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Object %s has invalid sections. Skipped."), *object.GetObject()->GetName());
+        sections.Empty();
+        return false;
+    }
+    return true;
+}
+
+void FAssimpNode::CopyTransformedView(const FExportableMeshSectionView& view, const FMatrix& meshToSpace, const bool bParallel, FExportableMeshSection& outSection)
+{
+    const int32 numVertices = view.vertices.Num();
+    outSection.meshToWorld = view.meshToWorld;
+    outSection.material = view.material;
+    outSection.vertices.SetNumUninitialized(numVertices);
+    outSection.normals.SetNumUninitialized(numVertices);
+    outSection.tangents.SetNumUninitialized(numVertices);
+    FMeshConversionKernels::TransformVertices(meshToSpace, view.vertices.GetData(), view.normals.GetData(), view.tangents.GetData()
+        , outSection.vertices.GetData(), outSection.normals.GetData(), outSection.tangents.GetData(), numVertices, bParallel);
+    outSection.textureCoordinates.Reset();
+    outSection.textureCoordinates.Append(view.textureCoordinates.GetData(), view.textureCoordinates.Num());
+    outSection.vertexColors.Reset();
+    if (view.vertexColors.Num() > 0)
+    {
+        outSection.vertexColors.Append(view.vertexColors.GetData(), view.vertexColors.Num());
+    }
+    else
+    {
+        // The placeholder of a mesh without colors, the Assimp export skips it again
+        outSection.vertexColors.Init(FColor::White, numVertices);
+    }
+    outSection.triangles.Reset();
+    outSection.triangles.Append(view.triangles.GetData(), view.triangles.Num());
 }
 
 void FAssimpNode::ProcessGatheredData_Recursive(FAssimpScene& scene, const FRuntimeMeshExportParam& param)
 {
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ExportProcess);
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
     check(!parent); // should only be called on the root node
-    scene.WriteToLogWithNewLine(FString(TEXT("Begin processing gathered data.")));
+    scene.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Begin processing gathered data."));
     double duration = 0.f;
     {
         FScopedDurationTimer timer(duration);
-        ProcessGatheredData_Internal(scene, param);
+
+        // The nodes are independent until their meshes and materials are registered in the scene
+        TArray<FAssimpNode*> nodes;
+        GetNodesRecursive(nodes);
+        ParallelFor(nodes.Num(), [&scene, &nodes, &param](int32 nodeIndex)
+        {
+            FRuntimeMeshMetrics::FScopedThreadCycles threadCycles(scene.metricsThreadCycles);
+            RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+            if (!param.cancellationToken.IsCancelled())
+            {
+                nodes[nodeIndex]->GroupGatheredSections(param);
+            }
+        });
+
+        // Each grouped section becomes one aiMesh, they are optimized independently
+        if (UsesMeshOptimization(param))
+        {
+            TArray<FExportableMeshSection*> sections;
+            int32 numTrianglesBefore = 0;
+            for (FAssimpNode* node : nodes)
+            {
+                for (FExportableMeshSection& section : node->groupedSections)
+                {
+                    sections.Add(&section);
+                    numTrianglesBefore += section.triangles.Num() / 3;
+                }
+                for (TPair<uint64, TArray<FExportableMeshSection>>& sharedSections : node->sharedGroupedSections)
+                {
+                    for (FExportableMeshSection& section : sharedSections.Value)
+                    {
+                        sections.Add(&section);
+                        numTrianglesBefore += section.triangles.Num() / 3;
+                    }
+                }
+            }
+            FThreadSafeCounter numTrianglesAfter;
+            ParallelFor(sections.Num(), [&scene, &sections, &param, &numTrianglesAfter](int32 sectionIndex)
+            {
+                FRuntimeMeshMetrics::FScopedThreadCycles threadCycles(scene.metricsThreadCycles);
+                RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+                if (!param.cancellationToken.IsCancelled())
+                {
+                    OptimizeExportSection(param, *sections[sectionIndex]);
+                    numTrianglesAfter.Add(sections[sectionIndex]->triangles.Num() / 3);
+                }
+            });
+            scene.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Optimized %d meshes, %d of %d triangles kept."), sections.Num(), numTrianglesAfter.GetValue(), numTrianglesBefore);
+        }
+
+        // Serial and in the order of the hierarchy, so the mesh and material indices are the same as before
+        TArray<FPendingAssimpMesh> pendingMeshes;
+        ProcessGatheredData_Internal(scene, param, pendingMeshes);
+        for (FAssimpNode* node : nodes)
+        {
+            node->CreateInstanceNodes(scene);
+        }
+
+        ParallelFor(pendingMeshes.Num(), [&scene, &pendingMeshes, &param](int32 meshIndex)
+        {
+            FRuntimeMeshMetrics::FScopedThreadCycles threadCycles(scene.metricsThreadCycles);
+            RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+            if (param.cancellationToken.IsCancelled())
+            {
+                return;
+            }
+            const FPendingAssimpMesh& pendingMesh = pendingMeshes[meshIndex];
+            if (pendingMesh.cachedMesh)
+            {
+                FillAssimpMeshFromCache(*pendingMesh.mesh, *pendingMesh.cachedMesh);
+            }
+            else
+            {
+                FillAssimpMesh(*pendingMesh.mesh, *pendingMesh.section, param.vertexColorSpace == ERuntimeMeshVertexColorSpace::SRGB);
+            }
+        });
+        scene.bMeshDataComplete = !param.cancellationToken.IsCancelled();
+
+        for (FAssimpNode* node : nodes)
+        {
+            node->groupedSections.Empty();
+            node->sharedGroupedSections.Empty();
+        }
     }
-    scene.WriteToLogWithNewLine(FString::Printf(TEXT("End processing gathered data. Duration: %.3fs"), duration));
+    scene.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("End processing gathered data. Duration: %.3fs"), duration);
 }
 
-void FAssimpNode::ProcessGatheredData_Internal(FAssimpScene& scene, const FRuntimeMeshExportParam& param)
+void FAssimpNode::ProcessGatheredData_Internal(FAssimpScene& scene, const FRuntimeMeshExportParam& param, TArray<FPendingAssimpMesh>& outPendingMeshes)
 {
-    FString hierarchicalName = GetHierarchicalName();
+    if (param.cancellationToken.IsCancelled())
+    {
+        return;
+    }
+
+    // The name is only built for the log
+    const bool bLogNode = scene.IsLogged(ERuntimeMeshExportLogSeverity::Verbose);
+    const FString hierarchicalName = bLogNode ? GetHierarchicalName() : FString();
 
     // Create meshes
-    CreateAssimpMeshesFromMeshData(scene, param);
-    scene.WriteToLogWithNewLine(FString::Printf(TEXT("Node %s has %d meshes for export."), *hierarchicalName, meshRefIndices.Num()));
+    CreateAssimpMeshesFromMeshData(scene, param, outPendingMeshes);
+    if (bLogNode)
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Verbose, TEXT("Node %s has %d meshes for export."), *hierarchicalName, meshRefIndices.Num());
+    }
 
     // Process children
     for (int32 childIndex = children.Num() - 1; childIndex >= 0; --childIndex)
     {
-        children[childIndex]->ProcessGatheredData_Internal(scene, param);
+        children[childIndex]->ProcessGatheredData_Internal(scene, param, outPendingMeshes);
     }
 
-    if (children.Num() == 0 && meshRefIndices.Num() == 0)
+    if (bLogNode && children.Num() == 0 && meshRefIndices.Num() == 0)
     {
-        scene.WriteToLogWithNewLine(FString::Printf(TEXT("Node %s has no children and no meshes."), *hierarchicalName));
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Verbose, TEXT("Node %s has no children and no meshes."), *hierarchicalName);
     }
 }
 
-
-void FAssimpNode::CreateAssimpMeshesFromMeshData(FAssimpScene& scene, const FRuntimeMeshExportParam& param)
+void FAssimpNode::GroupGatheredSections(const FRuntimeMeshExportParam& param)
 {
     // Process the gathered mesh data
     TMap<UMaterialInterface*, TArray<FExportableMeshSection>> mapMaterialSections;
-    UE_LOG(LogTemp,Warning,TEXT(" oooo gathered sections = %d"), gatheredExportables.Num());
-    for(TArray<FExportableMeshSection>& sections : gatheredExportables)
+    auto AddSection = [](TMap<UMaterialInterface*, TArray<FExportableMeshSection>>& sectionsByMaterial, FExportableMeshSection&& section)
+    {
+        sectionsByMaterial.FindOrAdd(section.material).Add(MoveTemp(section));
+    };
+    // Combine data of the same material if wanted, once all sections of the material are known
+    auto CombineSameMaterial = [&param](TMap<UMaterialInterface*, TArray<FExportableMeshSection>>& sectionsByMaterial)
     {
-        // Transform the data
-        for (FExportableMeshSection& section : sections)
+        if (!param.bCombineSameMaterial)
         {
-            FTransform objectSpaceToNodeSpace = section.meshToWorld * this->worldTransform.Inverse();
-            for (int32 i = section.vertices.Num() -1 ; i >= 0; --i)
-            {
-                section.vertices[i] = objectSpaceToNodeSpace.TransformPosition(section.vertices[i]);
-                section.normals[i] = objectSpaceToNodeSpace.TransformVector(section.normals[i]);
-                section.tangents[i] = objectSpaceToNodeSpace.TransformVector(section.tangents[i]);              
-            }
+            return;
+        }
+        for (auto& element : sectionsByMaterial)
+        {
+            CombineSections(element.Value);
+        }
+    };
+
+    // One matrix per section into the space of the node or the shared mesh, the sections are transformed in parallel before they are grouped
+    struct FSectionTransform
+    {
+        FExportableMeshSection* section;
+        const FExportableMeshSectionView* view;
+        FMatrix meshToSpace;
+    };
+    const FTransform worldToNode = this->worldTransform.Inverse();
+    TArray<TArray<FExportableMeshSection>> viewSections;
+    viewSections.SetNum(gatheredExportables.Num());
+    TArray<FSectionTransform> sectionTransforms;
+    for (int32 objectIndex = 0; objectIndex < gatheredExportables.Num(); ++objectIndex)
+    {
+        // The shared meshes are in the space of their instance, the instance nodes place them
+        // The sections of an instanced exportable are in the space of the instances already
+        const int32 sharedInstanceIndex = objectSharedInstances.Num() > 0 ? objectSharedInstances[objectIndex] : INDEX_NONE;
+        const FTransform worldToSpace = sharedInstanceIndex == INDEX_NONE ? worldToNode
+            : sharedInstances[sharedInstanceIndex].instanceIndex != INDEX_NONE ? FTransform::Identity : sharedInstances[sharedInstanceIndex].meshToWorld.Inverse();
+        for (FExportableMeshSection& section : gatheredExportables[objectIndex])
+        {
+            sectionTransforms.Add({ &section, nullptr, (section.meshToWorld * worldToSpace).ToMatrixWithScale() });
+        }
+        // Views are transformed straight out of the buffers of the exportable
+        viewSections[objectIndex].SetNum(gatheredViews[objectIndex].Num());
+        for (int32 viewIndex = 0; viewIndex < gatheredViews[objectIndex].Num(); ++viewIndex)
+        {
+            const FExportableMeshSectionView& view = gatheredViews[objectIndex][viewIndex];
+            sectionTransforms.Add({ &viewSections[objectIndex][viewIndex], &view, (view.meshToWorld * worldToSpace).ToMatrixWithScale() });
+        }
+    }
+    // A node with few large sections splits their vertices into chunks as well
+    const bool bParallelVertices = sectionTransforms.Num() < FTaskGraphInterface::Get().GetNumWorkerThreads();
+    ParallelFor(sectionTransforms.Num(), [&sectionTransforms, bParallelVertices](int32 transformIndex)
+    {
+        const FSectionTransform& transform = sectionTransforms[transformIndex];
+        if (transform.view)
+        {
+            CopyTransformedView(*transform.view, transform.meshToSpace, bParallelVertices, *transform.section);
+            return;
+        }
+        FExportableMeshSection& section = *transform.section;
+        FMeshConversionKernels::TransformVertices(transform.meshToSpace, section.vertices.GetData(), section.normals.GetData(), section.tangents.GetData()
+            , section.vertices.GetData(), section.normals.GetData(), section.tangents.GetData(), section.vertices.Num(), bParallelVertices);
+    });
 
-            TArray<FExportableMeshSection>& materialSections = mapMaterialSections.FindOrAdd(section.material);
+    sharedGroupedSections.Reset();
+    for (int32 objectIndex = 0; objectIndex < gatheredExportables.Num(); ++objectIndex)
+    {
+        const int32 sharedInstanceIndex = objectSharedInstances.Num() > 0 ? objectSharedInstances[objectIndex] : INDEX_NONE;
+        TMap<UMaterialInterface*, TArray<FExportableMeshSection>> sharedMaterialSections;
+        TMap<UMaterialInterface*, TArray<FExportableMeshSection>>& targetSections = sharedInstanceIndex != INDEX_NONE ? sharedMaterialSections : mapMaterialSections;
+        for (FExportableMeshSection& section : gatheredExportables[objectIndex])
+        {
+            AddSection(targetSections, MoveTemp(section));
+        }
+        for (FExportableMeshSection& section : viewSections[objectIndex])
+        {
+            AddSection(targetSections, MoveTemp(section));
+        }
 
-            // Combine data of the same material if wanted
-            if (param.bCombineSameMaterial && materialSections.IsValidIndex(0))
-            {
-                materialSections[0].Append(MoveTemp(section));
-            }
-            else
+        CombineSameMaterial(sharedMaterialSections);
+        if (sharedMaterialSections.Num() > 0)
+        {
+            TPair<uint64, TArray<FExportableMeshSection>>& sharedSections = sharedGroupedSections.AddDefaulted_GetRef();
+            sharedSections.Key = sharedInstances[sharedInstanceIndex].key;
+            for (auto& element : sharedMaterialSections)
             {
-                materialSections.Add(MoveTemp(section));
+                sharedSections.Value.Append(MoveTemp(element.Value));
             }
         }
     }
     gatheredExportables.Empty();
+    gatheredViews.Empty();
 
-    // Create aiMeshes from the gathered data
+    // One aiMesh per section, grouped by material
+    CombineSameMaterial(mapMaterialSections);
+    groupedSections.Reset();
     for (auto& element : mapMaterialSections)
     {
-        for (FExportableMeshSection& section : element.Value)
-        {            
-            // Create the aiMesh
-            FAssimpMesh* mesh = new FAssimpMesh();
-            meshRefIndices.Add(scene.meshes.Add(mesh));
-
-            // mesh->mName = TODO do we need a name for the meshes?! Problem with merged meshes
-            mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
-
-            // Add the material to the mesh
-			const int32 foundMaterialIndex = scene.uniqueMaterials.Find(section.material);
-            //scene.WriteToLogWithNewLine(FString::Printf(TEXT("oooo mesh material index = %d"), foundMaterialIndex));
-			if (foundMaterialIndex == INDEX_NONE)
-			{                
-                aiString assimpTexturePath;
-                assimpTexturePath = "E:\\Unreal Engine Projects\\ImportExportDemo\\Export\\T_Chair_M.jpg";
-				mesh->mMaterialIndex = scene.uniqueMaterials.Add(section.material);
-				aiMaterial* material = new aiMaterial();
-				scene.materials.Add(material);
-				check(scene.uniqueMaterials.Num() == scene.materials.Num())
-				// Set the material name
-				{                    
-					aiString materialName;
-					if (section.material)
-					{
-						materialName = TCHAR_TO_ANSI(*section.material->GetName());
-					}
-					else
-					{
-						materialName = "Unknown";
-					}
-					material->AddProperty(&materialName, AI_MATKEY_NAME);
-				}
-				// Set the material to be two sided
-				{
-					const int bTwoSided = true;
-					material->AddProperty(&bTwoSided, 1, AI_MATKEY_TWOSIDED);
-				}
-				// Shininess (only a FIX for gltf.v1 crash cause shininess not available)
-				{
-					const float shininess = 1.0f;
-					material->AddProperty(&shininess, 1, AI_MATKEY_SHININESS);
-				}
-
-                //Export Normal texture and add in aiMaterial - begin
-                TArray<UTexture*> OutTextures;
-                TArray<TArray<int32>> OutIndices;
-                section.material->GetUsedTexturesAndIndices(OutTextures,OutIndices,EMaterialQualityLevel::Type::High,ERHIFeatureLevel::SM5);
-                UE_LOG(LogTemp, Display, TEXT("M_M Total texture in material = %d"), OutTextures.Num()); 
-                for (UTexture* currentTex : OutTextures)
-                {   
-                    FString FileName;
-                    ExportTexture(currentTex, FileName);
-                    UE_LOG(LogTemp, Display, TEXT("M_M Assimp Exporting mesh..."));
-                                       
-                    //convert FString texture path into aiString for assimp
-                    aiString assimpTexPath;
-                    assimpTexPath = FStringToaiString(FileName);
-                    
-                    //FTextureFormatSettings contains texture details
-                    FTextureFormatSettings texFormatSetting;
-                    currentTex->GetDefaultFormatSettings(texFormatSetting);
-
-                    //Check for Normal texture
-                    if (texFormatSetting.CompressionSettings == TextureCompressionSettings::TC_Normalmap)
-                    {
-                        //Add texture as a property to material being exported
-                        material->AddProperty(&assimpTexPath,AI_MATKEY_TEXTURE_NORMALS(0));
-                    }
-                }
-                //Export Normal texture and add into aiMaterial - end
+        groupedSections.Append(MoveTemp(element.Value));
+    }
+}
 
-                //Read metallic parameter and add into aiMaterial
-                {
-                    FHashedMaterialParameterInfo matOpaqueParamInfo;
-                    UTexture* diffuse_tex;
-                    matOpaqueParamInfo.Name = FName("DiffuseMap");                    
-                    if (section.material->GetTextureParameterValue(matOpaqueParamInfo, diffuse_tex))
-                    {
-                        FString FileName;
-                        ExportTexture(diffuse_tex, FileName);
-                        aiString str = FStringToaiString(diffuse_tex->GetFName().ToString() + ".bmp");
-                        material->AddProperty(&str, AI_MATKEY_TEXTURE_DIFFUSE(0));
-                    }
-                }
+void FAssimpNode::CombineSections(TArray<FExportableMeshSection>& sections)
+{
+    if (sections.Num() < 2)
+    {
+        return;
+    }
+    TArray<FExportableMeshSection*> others;
+    others.Reserve(sections.Num() - 1);
+    for (int32 sectionIndex = 1; sectionIndex < sections.Num(); ++sectionIndex)
+    {
+        others.Add(&sections[sectionIndex]);
+    }
+    sections[0].AppendAll(others);
+    sections.SetNum(1);
+}
 
-                {
-                    FHashedMaterialParameterInfo matOpaqueParamInfo;
-                    UTexture* emissive_tex;
-                    matOpaqueParamInfo.Name = FName("EmissiveMap");
-                    if (section.material->GetTextureParameterValue(matOpaqueParamInfo, emissive_tex))
-                    {
-                        FString FileName;
-                        ExportTexture(emissive_tex, FileName);
-                        aiString str = FStringToaiString(emissive_tex->GetFName().ToString() + ".bmp");
-                        material->AddProperty(&str, AI_MATKEY_TEXTURE_EMISSIVE(0));
-                    }
-                }
+void FAssimpNode::FillAssimpMesh(FAssimpMesh& mesh, FExportableMeshSection& section, const bool bSRGBColors)
+{
+    // Vertices
+    {
+        // Do some checks to make sure we move the data
+        check(sizeof(aiVector3D) == sizeof(FVector));
+        check(sizeof(aiColor4D) == sizeof(FLinearColor));
 
-                {
-                    FHashedMaterialParameterInfo matOpaqueParamInfo;
-                    UTexture* ao_tex;
-                    matOpaqueParamInfo.Name = FName("AOMap");
-                    if (section.material->GetTextureParameterValue(matOpaqueParamInfo, ao_tex))
-                    {
-                        FString FileName;
-                        ExportTexture(ao_tex, FileName);
-                        aiString str = FStringToaiString(ao_tex->GetFName().ToString() + ".bmp");
-                        material->AddProperty(&str, AI_MATKEY_TEXTURE_LIGHTMAP(0));
-                    }
-                }
+        int32 numVertices = section.vertices.Num();
 
-                {
-                    FHashedMaterialParameterInfo matOpaqueParamInfo;
-                    UTexture* opacity_tex;
-                    matOpaqueParamInfo.Name = FName("OpacityMap");
-                    if (section.material->GetTextureParameterValue(matOpaqueParamInfo, opacity_tex))
-                    {
-                        FString FileName;
-                        ExportTexture(opacity_tex, FileName);
-                        aiString str = FStringToaiString(opacity_tex->GetFName().ToString() + ".bmp");
-                        material->AddProperty(&str, AI_MATKEY_TEXTURE_OPACITY(0));
-                    }
-                }
+        // Positions
+        mesh.vertices = MoveTemp(*reinterpret_cast<TArray<aiVector3D>*>(&section.vertices));
+        check(section.vertices.Num() == 0); // just to check that the move worked
 
-                {
-                    FHashedMaterialParameterInfo matOpaqueParamInfo;
-                    UTexture* metallic_tex;
-                    matOpaqueParamInfo.Name = FName("MetallicMap");
-                    if (section.material->GetTextureParameterValue(matOpaqueParamInfo, metallic_tex))
-                    {
-                        FString FileName;
-                        ExportTexture(metallic_tex, FileName);
-                        aiString str = FStringToaiString(metallic_tex->GetFName().ToString() + ".bmp");
-                        float mettalicFactor = 0.8f;
-                        material->AddProperty(&str, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE);
-                    }
+        // Normals
+        mesh.normals = MoveTemp(*reinterpret_cast<TArray<aiVector3D>*>(&section.normals));
+
+        // Tangents
+        mesh.tangents = MoveTemp(*reinterpret_cast<TArray<aiVector3D>*>(&section.tangents));
+
+        // Bitangents, only allocated when the format needs them
+        if (mesh.bitangents.Num() > 0)
+        {
+            FMeshConversionKernels::ComputeBitangents(FMeshConversionKernels::AsFVector(mesh.normals.GetData()), FMeshConversionKernels::AsFVector(mesh.tangents.GetData())
+                , reinterpret_cast<FVector*>(mesh.bitangents.GetData()), numVertices);
+        }
+
+        // Colors, skipped when they are only the placeholders of a mesh without colors
+        if (!HasOnlyDefaultColors(section.vertexColors))
+        {
+            mesh.vertexColors.SetNumUninitialized(numVertices);
+            FLinearColor* colors = reinterpret_cast<FLinearColor*>(mesh.vertexColors.GetData());
+            if (bSRGBColors)
+            {
+                FMeshConversionKernels::SRGBColorsToLinear(section.vertexColors.GetData(), colors, numVertices);
+            }
+            else
+            {
+                FMeshConversionKernels::ReinterpretColorsAsLinear(section.vertexColors.GetData(), colors, numVertices);
+            }
+        }
+
+        // TextureCoordinates
+        mesh.numUVComponents[0] = 2;
+        mesh.textureCoordinates[0].SetNumUninitialized(numVertices);
+        FMeshConversionKernels::ExpandUVs(section.textureCoordinates.GetData(), reinterpret_cast<FVector*>(mesh.textureCoordinates[0].GetData()), numVertices);
+    }
+
+    // Faces, the arrays are allocated from the arena when the mesh is registered
+    FMeshConversionKernels::BuildTriangleFaces(section.triangles.GetData(), section.triangles.Num(), mesh.faceIndices.GetData(), mesh.faces.GetData());
+}
+
+void FAssimpNode::FillAssimpMeshFromCache(FAssimpMesh& mesh, FCachedMesh& cachedMesh)
+{
+    const int32 numVertices = cachedMesh.vertices.Num();
+    mesh.vertices = MoveTemp(cachedMesh.vertices);
+    mesh.normals = MoveTemp(cachedMesh.normals);
+    mesh.tangents = MoveTemp(cachedMesh.tangents);
+    if (mesh.bitangents.Num() > 0)
+    {
+        FMeshConversionKernels::ComputeBitangents(FMeshConversionKernels::AsFVector(mesh.normals.GetData()), FMeshConversionKernels::AsFVector(mesh.tangents.GetData())
+            , reinterpret_cast<FVector*>(mesh.bitangents.GetData()), numVertices);
+    }
+    mesh.vertexColors = MoveTemp(cachedMesh.vertexColors);
+    mesh.numUVComponents[0] = 2;
+    mesh.textureCoordinates[0] = MoveTemp(cachedMesh.textureCoordinates);
+
+    // The triangles stay in the cache, the faces point into the arena copy
+    FMeshConversionKernels::BuildTriangleFaces(cachedMesh.triangles.GetData(), cachedMesh.triangles.Num(), mesh.faceIndices.GetData(), mesh.faces.GetData());
+}
+
+bool FAssimpNode::PrepareMeshCache(const FRuntimeMeshExportParam& param, const bool bUseMeshCache)
+{
+    bReusesMeshCache = false;
+    bStoresMeshCache = bUseMeshCache && exportObjects.Num() > 0;
+    pendingKey = FMeshCacheKey();
+    for (int32 objectIndex = 0; bStoresMeshCache && objectIndex < exportObjects.Num(); ++objectIndex)
+    {
+        // One exportable without a version makes the node dirty on every export
+        const int64 version = FAssimpScene::GetMeshDataVersion(exportObjects[objectIndex]);
+        bStoresMeshCache = version != 0;
+        pendingKey.versions.Emplace(exportObjects[objectIndex].GetObject(), version);
+    }
+
+    if (!bStoresMeshCache)
+    {
+        pendingKey = FMeshCacheKey();
+        InvalidateMeshCache();
+        return false;
+    }
+
+    // The meshes are in node space and depend on how the sections are gathered and grouped
+    pendingKey.worldTransform = worldTransform;
+    pendingKey.paramHash = HashCombine(HashCombine(GetTypeHash(param.lod), GetTypeHash(param.bSkipLodNotValid)), GetTypeHash(param.bCombineSameMaterial));
+    pendingKey.paramHash = HashCombine(pendingKey.paramHash, HashCombine(HashMeshOptimization(param), GetTypeHash(uint8(param.vertexColorSpace))));
+
+    bReusesMeshCache = bMeshCacheValid && pendingKey.Matches(cachedKey) && !cachedMeshes.ContainsByPredicate([](const FCachedMesh& cachedMesh) {
+        return cachedMesh.material.IsStale();
+    });
+    if (bReusesMeshCache)
+    {
+        // The data moves into the meshes of this export until StoreMeshCache
+        bMeshCacheValid = false;
+    }
+    else
+    {
+        InvalidateMeshCache();
+    }
+    return bReusesMeshCache;
+}
+
+void FAssimpNode::StoreMeshCache(FAssimpScene& scene, const bool bMeshDataComplete)
+{
+    if (bStoresMeshCache && bMeshDataComplete && cachedMeshes.Num() == meshRefIndices.Num())
+    {
+        for (int32 meshIndex = 0; meshIndex < meshRefIndices.Num(); ++meshIndex)
+        {
+            FAssimpMesh& mesh = *scene.meshes[meshRefIndices[meshIndex]];
+            FCachedMesh& cachedMesh = cachedMeshes[meshIndex];
+            cachedMesh.vertices = MoveTemp(mesh.vertices);
+            cachedMesh.normals = MoveTemp(mesh.normals);
+            cachedMesh.tangents = MoveTemp(mesh.tangents);
+            cachedMesh.textureCoordinates = MoveTemp(mesh.textureCoordinates[0]);
+            cachedMesh.vertexColors = MoveTemp(mesh.vertexColors);
+            if (!bReusesMeshCache)
+            {
+                // The indices are arena memory, the only copy of the cache
+                cachedMesh.triangles.SetNumUninitialized(mesh.faceIndices.Num());
+                FMemory::Memcpy(cachedMesh.triangles.GetData(), mesh.faceIndices.GetData(), mesh.faceIndices.Num() * sizeof(uint32));
+            }
+        }
+        cachedKey = MoveTemp(pendingKey);
+        bMeshCacheValid = true;
+    }
+    else if (bStoresMeshCache)
+    {
+        // Cancelled or failed, a reused cache was moved into the meshes
+        InvalidateMeshCache();
+    }
+
+    pendingKey = FMeshCacheKey();
+    bReusesMeshCache = false;
+    bStoresMeshCache = false;
+}
+
+void FAssimpNode::InvalidateMeshCache()
+{
+    cachedMeshes.Empty();
+    cachedKey = FMeshCacheKey();
+    bMeshCacheValid = false;
+}
+
+void FAssimpNode::CreateAssimpMeshesFromMeshData(FAssimpScene& scene, const FRuntimeMeshExportParam& param, TArray<FPendingAssimpMesh>& outPendingMeshes)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ExportCreateMeshes);
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+    // Register the aiMeshes and their materials, the vertex data is filled in parallel afterwards
+    if (bReusesMeshCache)
+    {
+        for (FCachedMesh& cachedMesh : cachedMeshes)
+        {
+            FAssimpMesh* mesh = RegisterAssimpMesh(scene, param, cachedMesh.material.Get(), cachedMesh.vertices.Num(), cachedMesh.triangles.Num(), meshRefIndices);
+            outPendingMeshes.Add({ mesh, nullptr, &cachedMesh });
+        }
+        return;
+    }
+
+    if (bStoresMeshCache)
+    {
+        cachedMeshes.Reset();
+    }
+    for (FExportableMeshSection& section : groupedSections)
+    {
+        FAssimpMesh* mesh = RegisterAssimpMesh(scene, param, section.material, section.vertices.Num(), section.triangles.Num(), meshRefIndices);
+        outPendingMeshes.Add({ mesh, &section, nullptr });
+        if (bStoresMeshCache)
+        {
+            // The vertex data is moved in from the mesh after the export, @see StoreMeshCache
+            cachedMeshes.AddDefaulted_GetRef().material = section.material;
+        }
+    }
+
+    // Registered once per key, the instance nodes reference them
+    for (TPair<uint64, TArray<FExportableMeshSection>>& sharedSections : sharedGroupedSections)
+    {
+        TArray<uint32>& meshIndices = scene.sharedMeshIndices.FindOrAdd(sharedSections.Key);
+        for (FExportableMeshSection& section : sharedSections.Value)
+        {
+            FAssimpMesh* mesh = RegisterAssimpMesh(scene, param, section.material, section.vertices.Num(), section.triangles.Num(), meshIndices);
+            outPendingMeshes.Add({ mesh, &section, nullptr });
+        }
+    }
+}
+
+void FAssimpNode::CreateInstanceNodes(FAssimpScene& scene)
+{
+    for (const FSharedMeshInstance& instance : sharedInstances)
+    {
+        const UObject* object = exportObjects[instance.objectIndex].GetObject();
+        const TArray<uint32>* meshIndices = scene.sharedMeshIndices.Find(instance.key);
+        if (!meshIndices)
+        {
+            if (instance.instanceIndex <= 0)
+            {
+                scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("The exportable with the shared mesh of %s was skipped, it is not exported."), *GetNameSafe(object));
+            }
+            continue;
+        }
+        const FName objectName = object ? object->GetFName() : FName(TEXT("Instance"));
+        FAssimpNode* instanceNode = new FAssimpNode(instance.instanceIndex == INDEX_NONE ? objectName : FName(objectName, instance.instanceIndex + 1), this);
+        instanceNode->worldTransform = instance.meshToWorld;
+        instanceNode->meshRefIndices = *meshIndices;
+        instanceNodes.Add(instanceNode);
+        ++scene.metrics.numInstances;
+    }
+}
+
+FAssimpMesh* FAssimpNode::RegisterAssimpMesh(FAssimpScene& scene, const FRuntimeMeshExportParam& param, UMaterialInterface* material, const int32 numVertices, const int32 numIndices
+    , TArray<uint32>& outMeshIndices)
+{
+    INC_DWORD_STAT_BY(STAT_RMIE_ExportedVertices, numVertices);
+    INC_DWORD_STAT_BY(STAT_RMIE_ExportedTriangles, numIndices / 3);
+    ++scene.metrics.numMeshes;
+    scene.metrics.numVertices += numVertices;
+    scene.metrics.numTriangles += numIndices / 3;
+
+    // Create the aiMesh
+    FAssimpMesh* mesh = new(scene.exportArena) FAssimpMesh();
+    outMeshIndices.Add(scene.meshes.Add(mesh));
+
+    // mesh->mName = TODO do we need a name for the meshes?! Problem with merged meshes
+    mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+
+    // Add the material to the mesh
+    mesh->mMaterialIndex = FindOrAddMaterial(scene, param, material);
+
+    check((numIndices % 3) == 0);
+    // The export arena is not thread safe, so the arrays are allocated here and FillAssimpMesh only fills them in parallel
+    if (FormatNeedsBitangents(param.formatId))
+    {
+        mesh->bitangents = scene.AllocateExportArray<aiVector3D>(numVertices);
+    }
+    mesh->faces = scene.AllocateExportArray<aiFace>(numIndices / 3);
+    mesh->faceIndices = scene.AllocateExportArray<uint32>(numIndices);
+    return mesh;
+}
+
+uint32 FAssimpNode::FindOrAddMaterial(FAssimpScene& scene, const FRuntimeMeshExportParam& param, UMaterialInterface* sectionMaterial)
+{
+    uint32 materialIndex = 0;
+	const int32* foundMaterialIndex = scene.uniqueMaterials.Find(sectionMaterial);
+	if (!foundMaterialIndex)
+	{                
+		materialIndex = scene.materials.Num();
+		scene.uniqueMaterials.Add(sectionMaterial, materialIndex);
+		++scene.metrics.numMaterials;
+		aiMaterial* material = new(scene.exportArena) aiMaterial();
+		scene.materials.Add(material);
+		check(scene.uniqueMaterials.Num() == scene.materials.Num())
+		// Set the material name
+		{                    
+			aiString materialName;
+			if (sectionMaterial)
+			{
+				materialName = TCHAR_TO_ANSI(*sectionMaterial->GetName());
+			}
+			else
+			{
+				materialName = "Unknown";
+			}
+			material->AddProperty(&materialName, AI_MATKEY_NAME);
+		}
+		// Set the material to be two sided
+		{
+			const int bTwoSided = true;
+			material->AddProperty(&bTwoSided, 1, AI_MATKEY_TWOSIDED);
+		}
+		// Shininess (only a FIX for gltf.v1 crash cause shininess not available)
+		{
+			const float shininess = 1.0f;
+			material->AddProperty(&shininess, 1, AI_MATKEY_SHININESS);
+		}
+
+        //Export Normal texture and add in aiMaterial - begin
+        TArray<UTexture*> OutTextures;
+        TArray<TArray<int32>> OutIndices;
+        sectionMaterial->GetUsedTexturesAndIndices(OutTextures,OutIndices,EMaterialQualityLevel::Type::High,ERHIFeatureLevel::SM5);
+        UE_LOG(LogTemp, Display, TEXT("M_M Total texture in material = %d"), OutTextures.Num()); 
+        for (UTexture* currentTex : OutTextures)
+        {   
+            //FTextureFormatSettings contains texture details
+            FTextureFormatSettings texFormatSetting;
+            currentTex->GetDefaultFormatSettings(texFormatSetting);
+
+            //Check for Normal texture, the other used textures are not referenced by the material
+            FString FileName;
+            if (texFormatSetting.CompressionSettings == TextureCompressionSettings::TC_Normalmap && ExportTexture(scene, param, currentTex, FileName))
+            {
+                //convert FString texture path into aiString for assimp
+                aiString assimpTexPath;
+                assimpTexPath = FStringToaiString(FileName);
+
+                //Add texture as a property to material being exported
+                material->AddProperty(&assimpTexPath,AI_MATKEY_TEXTURE_NORMALS(0));
+            }
+        }
+        //Export Normal texture and add into aiMaterial - end
+
+        //Read metallic parameter and add into aiMaterial
+        {
+            FHashedMaterialParameterInfo matOpaqueParamInfo;
+            UTexture* diffuse_tex;
+            matOpaqueParamInfo.Name = FName("DiffuseMap");                    
+            FString FileName;
+            if (sectionMaterial->GetTextureParameterValue(matOpaqueParamInfo, diffuse_tex) && ExportTexture(scene, param, diffuse_tex, FileName))
+            {
+                aiString str = FStringToaiString(FileName);
+                material->AddProperty(&str, AI_MATKEY_TEXTURE_DIFFUSE(0));
+            }
+        }
+
+        {
+            FHashedMaterialParameterInfo matOpaqueParamInfo;
+            UTexture* emissive_tex;
+            matOpaqueParamInfo.Name = FName("EmissiveMap");
+            FString FileName;
+            if (sectionMaterial->GetTextureParameterValue(matOpaqueParamInfo, emissive_tex) && ExportTexture(scene, param, emissive_tex, FileName))
+            {
+                aiString str = FStringToaiString(FileName);
+                material->AddProperty(&str, AI_MATKEY_TEXTURE_EMISSIVE(0));
+            }
+        }
+
+        {
+            FHashedMaterialParameterInfo matOpaqueParamInfo;
+            UTexture* ao_tex;
+            matOpaqueParamInfo.Name = FName("AOMap");
+            FString FileName;
+            if (sectionMaterial->GetTextureParameterValue(matOpaqueParamInfo, ao_tex) && ExportTexture(scene, param, ao_tex, FileName))
+            {
+                aiString str = FStringToaiString(FileName);
+                material->AddProperty(&str, AI_MATKEY_TEXTURE_LIGHTMAP(0));
+            }
+        }
+
+        {
+            FHashedMaterialParameterInfo matOpaqueParamInfo;
+            UTexture* opacity_tex;
+            matOpaqueParamInfo.Name = FName("OpacityMap");
+            FString FileName;
+            if (sectionMaterial->GetTextureParameterValue(matOpaqueParamInfo, opacity_tex) && ExportTexture(scene, param, opacity_tex, FileName))
+            {
+                aiString str = FStringToaiString(FileName);
+                material->AddProperty(&str, AI_MATKEY_TEXTURE_OPACITY(0));
+            }
+        }
+
+        {
+            FHashedMaterialParameterInfo matOpaqueParamInfo;
+            UTexture* metallic_tex;
+            matOpaqueParamInfo.Name = FName("MetallicMap");
+            FString FileName;
+            if (sectionMaterial->GetTextureParameterValue(matOpaqueParamInfo, metallic_tex) && ExportTexture(scene, param, metallic_tex, FileName))
+            {
+                aiString str = FStringToaiString(FileName);
+                float mettalicFactor = 0.8f;
+                material->AddProperty(&str, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE);
+            }
+        }
+
+        //Vector material parameters
+        {
+            FHashedMaterialParameterInfo color4DBasecolorParam;
+            FLinearColor basecolorValue;
+            color4DBasecolorParam.Name = FName("BaseColor");
+            if (sectionMaterial->GetVectorParameterValue(color4DBasecolorParam, basecolorValue))
+            {
+                aiColor3D transColor(basecolorValue.R, basecolorValue.G, basecolorValue.B);
+                material->AddProperty(&transColor, 1, AI_MATKEY_COLOR_DIFFUSE);
+            }
+        }
+        
+        {
+            FHashedMaterialParameterInfo color4DSpecularParam;
+            FLinearColor specColor;
+            color4DSpecularParam.Name = FName("SpecularColor");
+            if (sectionMaterial->GetVectorParameterValue(color4DSpecularParam, specColor))
+            {
+                aiColor4D specularColor(specColor.R, specColor.G, specColor.B,specColor.A);
+                material->AddProperty(&specularColor, 1, AI_MATKEY_GLTF_PBRSPECULARGLOSSINESS_SPECULAR_FACTOR);
+            }
+        }
+          
+        {
+            FHashedMaterialParameterInfo color4DSpecularParam;
+            FLinearColor emissiveColor;
+            color4DSpecularParam.Name = FName("EmissiveColor");
+            if (sectionMaterial->GetVectorParameterValue(color4DSpecularParam, emissiveColor))
+            {
+                aiColor4D specularColor(emissiveColor.R, emissiveColor.G, emissiveColor.B, emissiveColor.A);
+                material->AddProperty(&specularColor, 1, AI_MATKEY_COLOR_EMISSIVE);
+            }
+        }
+
+        //Scalar material parameters
+        {
+            FHashedMaterialParameterInfo constRoughnessParam;
+            constRoughnessParam.Name = FName("Roughness_strength");
+            float roughnessValue=0.0f;
+            if (sectionMaterial->GetScalarParameterValue(constRoughnessParam, roughnessValue))
+            {
+                material->AddProperty(&roughnessValue, 1, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_ROUGHNESS_FACTOR);
+            }
+        }
+
+        {
+            FHashedMaterialParameterInfo constMetallicParam;
+            constMetallicParam.Name = FName("Metallic_strength");
+            float MetallicValue = 0.0f;
+            if (sectionMaterial->GetScalarParameterValue(constMetallicParam, MetallicValue))
+            {
+                material->AddProperty(&MetallicValue, 1, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLIC_FACTOR);
+            }
+        }
+
+        {
+            FHashedMaterialParameterInfo constRefractionParam;
+            constRefractionParam.Name = FName("Refraction_strength");
+            float refractionValue = 0.0f;      
+            if (sectionMaterial->GetScalarParameterValue(constRefractionParam, refractionValue))
+            {
+                material->AddProperty(&refractionValue, 1, AI_MATKEY_REFRACTI);
+            }
+        }
+
+        {
+            FHashedMaterialParameterInfo constOpacityParam;
+            constOpacityParam.Name = FName("Opacity_strength");
+            float opacityValue = 1;
+            if (sectionMaterial->GetScalarParameterValue(constOpacityParam, opacityValue))
+            {
+                material->AddProperty(&opacityValue, 1, AI_MATKEY_OPACITY);
+            }
+        }
+
+        //experiment
+        /*{
+            float matProperty = 0.85, property2 = 0.8, roughValue = 0.1f;
+            //material->AddProperty(&matProperty,1,AI_MATKEY_REFLECTIVITY);
+            aiColor4D property3(0.45, 0.45, 0.45, 0.5);
+            aiColor3D specularColor(0.69, 0.69, 0.69);
+            //material->AddProperty(&specularColor, 1, AI_MATKEY_COLOR_SPECULAR);
+            //material->AddProperty<aiColor4D>(&property3, 1, AI_MATKEY_COLOR_REFLECTIVE);
+            material->AddProperty(&property2, 1, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLIC_FACTOR);
+
+        }*/
+        
+        if (sectionMaterial->GetBlendMode() == EBlendMode::BLEND_Translucent)
+        {
+
+        }
+        else if (sectionMaterial->GetBlendMode() == EBlendMode::BLEND_Opaque)
+        {
+            
+        }
+	}
+	else
+	{
+		materialIndex = *foundMaterialIndex;
+	}
+    return materialIndex;
+}
+
+
+template<typename SectionType>
+bool FAssimpNode::ValidateMeshSection(FAssimpScene& scene, TScriptInterface<IMeshExportable>& exportable, const SectionType& section)
+{
+    bool bMeshValid = true;
+    int32 numVertices = section.vertices.Num();
+    if (section.normals.Num() != numVertices)
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Object %s: Number of normals not equal number of vertices!"), *exportable.GetObject()->GetName());
+        bMeshValid = false;
+    }
+
+    if (section.tangents.Num() != numVertices)
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Object %s: Number of tangents not equal number of vertices!"), *exportable.GetObject()->GetName());
+        bMeshValid = false;
+    }
+
+    if (section.vertexColors.Num() != numVertices && !(AllowsNoColors(section) && section.vertexColors.Num() == 0))
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Object %s: Number of vertexColors not equal number of vertices!"), *exportable.GetObject()->GetName());
+        bMeshValid = false;
+    }
+
+    if (section.textureCoordinates.Num() != numVertices)
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Object %s: Number of textureCoordinates not equal number of vertices!"), *exportable.GetObject()->GetName());
+        bMeshValid = false;
+    }
+
+    if (section.triangles.Num() % 3 != 0)
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Object %s: Number of triangles is not dividable by 3!"), *exportable.GetObject()->GetName());
+        bMeshValid = false;
+    }
+
+    return bMeshValid;
+}
+
+
+void FAssimpScene::WriteTextToLog(const ERuntimeMeshExportLogSeverity severity, const FString& logText)
+{
+    log.Add(severity, CopyTemp(logText));
+}
+
+void FAssimpScene::AddExportedFile(const FRuntimeMeshExportParam& param, FRuntimeMeshExportedFile&& file)
+{
+    // The textures are added while Assimp exports the geometry
+    FScopeLock lock(&exportedFilesCriticalSection);
+    metricsBytesWritten.Add(file.data.Num());
+    if (param.exportedFileSink)
+    {
+        param.exportedFileSink(MoveTemp(file));
+    }
+    else if (exportedFiles)
+    {
+        exportedFiles->Add(MoveTemp(file));
+    }
+}
+
+bool FAssimpScene::IsThreadSafeGather(const TScriptInterface<IMeshExportable>& object)
+{
+    // Blueprint implementations and Blueprint subclasses run through the script VM, which is not thread safe
+    const IMeshExportable* exportable = object.GetInterface();
+    return exportable && object.GetObject() && !object.GetObject()->GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint)
+        && exportable->IsThreadSafeGather();
+}
+
+bool FAssimpScene::HasMeshDataViews(const TScriptInterface<IMeshExportable>& object)
+{
+    // A Blueprint subclass may override GetMeshData, it keeps the Blueprint path
+    const IMeshExportable* exportable = object.GetInterface();
+    return exportable && object.GetObject() && !object.GetObject()->GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint)
+        && exportable->HasMeshDataViews();
+}
+
+int64 FAssimpScene::GetMeshDataVersion(const TScriptInterface<IMeshExportable>& object)
+{
+    const IMeshExportable* exportable = object.GetInterface();
+    if (!exportable || !object.GetObject() || object.GetObject()->GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint))
+    {
+        return 0;
+    }
+    return exportable->GetMeshDataVersion();
+}
+
+uint64 FAssimpScene::GetSharedMeshKey(const TScriptInterface<IMeshExportable>& object, const int32 lod, FTransform& outMeshToWorld)
+{
+    const IMeshExportable* exportable = object.GetInterface();
+    if (!exportable || !object.GetObject() || object.GetObject()->GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint))
+    {
+        return 0;
+    }
+    return exportable->GetSharedMeshKey(lod, outMeshToWorld);
+}
+
+bool FAssimpScene::GetInstanceTransforms(const TScriptInterface<IMeshExportable>& object, const int32 lod, TArray<FTransform>& outInstanceToWorld)
+{
+    const IMeshExportable* exportable = object.GetInterface();
+    if (!exportable || !object.GetObject() || object.GetObject()->GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint))
+    {
+        return false;
+    }
+    if (!exportable->GetInstanceTransforms(lod, outInstanceToWorld))
+    {
+        outInstanceToWorld.Reset();
+    }
+    return outInstanceToWorld.Num() > 0;
+}
+
+void FAssimpScene::BuildExportHierarchy(const FRuntimeMeshExportParam& param)
+{
+    // 'allNodesHelper' has the parents before their children, so walking it backwards sees the children first
+    const int32 numNodes = allNodesHelper.Num();
+    TMap<const FAssimpNode*, int32> nodeIndices;
+    nodeIndices.Reserve(numNodes);
+    for (int32 nodeIndex = 0; nodeIndex < numNodes; ++nodeIndex)
+    {
+        nodeIndices.Add(allNodesHelper[nodeIndex], nodeIndex);
+        allNodesHelper[nodeIndex]->hierarchyChildren.Reset();
+    }
+    TArray<bool> hasExportables;
+    TArray<int32> numChildrenWithExportables;
+    hasExportables.SetNumZeroed(numNodes);
+    numChildrenWithExportables.SetNumZeroed(numNodes);
+    for (int32 nodeIndex = numNodes - 1; nodeIndex >= 0; --nodeIndex)
+    {
+        const FAssimpNode* node = allNodesHelper[nodeIndex];
+        hasExportables[nodeIndex] |= node->exportObjects.Num() > 0;
+        if (hasExportables[nodeIndex] && node->parent)
+        {
+            const int32 parentIndex = nodeIndices.FindChecked(node->parent);
+            hasExportables[parentIndex] = true;
+            ++numChildrenWithExportables[parentIndex];
+        }
+    }
+
+    // The nearest kept node of each node, a removed node passes its children on to it
+    TArray<int32> keptNodes;
+    keptNodes.SetNumUninitialized(numNodes);
+    int32 numKept = 0;
+    for (int32 nodeIndex = 0; nodeIndex < numNodes; ++nodeIndex)
+    {
+        FAssimpNode* node = allNodesHelper[nodeIndex];
+        if (!node->parent)
+        {
+            // The root carries the correction of the file and is always kept
+            node->exportParent = nullptr;
+            node->bInExportHierarchy = true;
+            keptNodes[nodeIndex] = nodeIndex;
+            ++numKept;
+            continue;
+        }
+
+        const int32 parentIndex = nodeIndices.FindChecked(node->parent);
+        bool bKeep = true;
+        if (param.hierarchy == ERuntimeMeshExportHierarchy::CollapseEmpty)
+        {
+            bKeep = node->exportObjects.Num() > 0 || numChildrenWithExportables[nodeIndex] > 1;
+        }
+        else if (param.hierarchy == ERuntimeMeshExportHierarchy::Flatten)
+        {
+            bKeep = node->exportObjects.Num() > 0;
+        }
+        keptNodes[nodeIndex] = bKeep ? nodeIndex : keptNodes[parentIndex];
+        node->bInExportHierarchy = bKeep;
+        node->exportParent = nullptr;
+        if (bKeep)
+        {
+            FAssimpNode* exportParentNode = param.hierarchy == ERuntimeMeshExportHierarchy::Flatten ? rootNode : allNodesHelper[keptNodes[parentIndex]];
+            node->exportParent = exportParentNode;
+            exportParentNode->hierarchyChildren.Add(node);
+            ++numKept;
+        }
+    }
+    if (numKept < numNodes)
+    {
+        WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("%d of %d nodes are written, the others are removed by the hierarchy option."), numKept, numNodes);
+    }
+}
+
+bool FAssimpScene::PrepareSharedMeshes(const FRuntimeMeshExportParam& param, FAssimpNode& node, TSet<uint64>& gatheredKeys)
+{
+    for (int32 objectIndex = 0; objectIndex < node.exportObjects.Num(); ++objectIndex)
+    {
+        const TArray<FTransform>& instanceTransforms = node.objectInstanceTransforms[objectIndex];
+        FTransform meshToWorld;
+        uint64 key = param.bShareIdenticalMeshes ? GetSharedMeshKey(node.exportObjects[objectIndex], param.lod, meshToWorld) : 0;
+        if (key == 0 && instanceTransforms.Num() > 0)
+        {
+            // The mesh of an instanced exportable is only shared by its own instances
+            key = uint64(UPTRINT(node.exportObjects[objectIndex].GetObject()));
+        }
+        if (key == 0)
+        {
+            continue;
+        }
+        if (node.objectSharedInstances.Num() == 0)
+        {
+            node.objectSharedInstances.Init(INDEX_NONE, node.exportObjects.Num());
+        }
+        node.objectSharedInstances[objectIndex] = node.sharedInstances.Num();
+        bool bAlreadyGathered = false;
+        gatheredKeys.Add(key, &bAlreadyGathered);
+        const int32 numInstances = FMath::Max(instanceTransforms.Num(), 1);
+        for (int32 instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex)
+        {
+            FAssimpNode::FSharedMeshInstance& instance = node.sharedInstances.AddDefaulted_GetRef();
+            instance.key = key;
+            instance.objectIndex = objectIndex;
+            instance.bGathered = !bAlreadyGathered && instanceIndex == 0;
+            if (instanceTransforms.Num() > 0)
+            {
+                instance.meshToWorld = instanceTransforms[instanceIndex];
+                instance.instanceIndex = instanceIndex;
+            }
+            else
+            {
+                instance.meshToWorld = meshToWorld;
+            }
+        }
+    }
+    return node.sharedInstances.Num() > 0;
+}
+
+void FAssimpScene::StartGather(const FRuntimeMeshExportParam& param, const bool bAssimpScene)
+{
+    numObjectsSkipped = 0;
+    bMeshDataComplete = false;
+    allNodesHelper.Reset();
+    rootNode->GetNodesRecursive(allNodesHelper);
+    threadSafeGathers.Reset();
+    sharedMeshIndices.Reset();
+    // The Assimp scene has no place for more LODs, only the stream writers write them
+    additionalLods.Reset();
+    if (!bAssimpScene)
+    {
+        for (const int32 additionalLod : param.additionalLods)
+        {
+            if (additionalLod != param.lod && additionalLod >= 0)
+            {
+                additionalLods.AddUnique(additionalLod);
+            }
+        }
+    }
+    else if (param.additionalLods.Num() > 0)
+    {
+        WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("The additional LODs are only written with bStreamingExport or bNativeGltfExport, only LOD %d is exported."), param.lod);
+    }
+    TSet<uint64> gatheredKeys;
+    int32 numNodesReused = 0;
+    int32 numSharedInstances = 0;
+    for (FAssimpNode* node : allNodesHelper)
+    {
+        node->ResetGather();
+        bool bHasInstances = false;
+        for (int32 objectIndex = 0; objectIndex < node->exportObjects.Num(); ++objectIndex)
+        {
+            bHasInstances |= GetInstanceTransforms(node->exportObjects[objectIndex], param.lod, node->objectInstanceTransforms[objectIndex]);
+        }
+        // The cached meshes are in the space of the node, a node with shared meshes builds them on every export
+        const bool bHasSharedMeshes = bAssimpScene && (param.bShareIdenticalMeshes || bHasInstances) && PrepareSharedMeshes(param, *node, gatheredKeys);
+        numSharedInstances += node->sharedInstances.Num();
+        if (node->PrepareMeshCache(param, bAssimpScene && !bHasSharedMeshes))
+        {
+            // Nothing to gather, the node is done
+            node->indexGatherNext = node->exportObjects.Num();
+            ++numNodesReused;
+            continue;
+        }
+        for (int32 objectIndex = 0; objectIndex < node->exportObjects.Num(); ++objectIndex)
+        {
+            if (!node->IsSharedInstanceOnly(objectIndex) && IsThreadSafeGather(node->exportObjects[objectIndex]))
+            {
+                threadSafeGathers.Emplace(node, objectIndex);
+            }
+        }
+    }
+    if (numNodesReused > 0)
+    {
+        WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("%d of %d nodes are unchanged and reuse the meshes of the last export."), numNodesReused, allNodesHelper.Num());
+    }
+    if (numSharedInstances > 0)
+    {
+        WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("%d exportables and instances share the meshes of %d."), numSharedInstances, gatheredKeys.Num());
+    }
+}
+
+void FAssimpScene::GatherThreadSafe(const FRuntimeMeshExportParam& param)
+{
+    FThreadSafeCounter numSkipped;
+    ParallelFor(threadSafeGathers.Num(), [this, &param, &numSkipped](int32 index)
+    {
+        if (param.cancellationToken.IsCancelled())
+        {
+            return;
+        }
+        FRuntimeMeshMetrics::FScopedThreadCycles threadCycles(metricsThreadCycles);
+        RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+        if (!threadSafeGathers[index].Key->GatherExportable(*this, param, threadSafeGathers[index].Value))
+        {
+            numSkipped.Increment();
+        }
+    });
+    numThreadSafeSkipped = numSkipped.GetValue();
+}
+
+void FAssimpScene::PrepareSceneForExport(const FRuntimeMeshExportParam& param)
+{
+	WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Begin gather mesh data."));
+    StartGather(param, true);
+	double duration = 0.f;
+	{
+		FScopedDurationTimer timer(duration);
+		for (FAssimpNode* node : allNodesHelper)
+		{
+			node->GatherMeshData(*this, param, true);
+		}
+		GatherThreadSafe(param);
+		numObjectsSkipped += numThreadSafeSkipped;
+	}
+	WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("End gather mesh data. Duration: %.3fs, %d of the exportables in parallel"), duration, threadSafeGathers.Num());
+	stageTimings.gatherSeconds = float(duration);
+
+	const double startTimeProcess = FPlatformTime::Seconds();
+    rootNode->ProcessGatheredData_Recursive(*this, param);
+    StartTextureExport(param);
+    SetDataAndPtrsToParentClass_EntireScene(param);
+	stageTimings.processSeconds = float(FPlatformTime::Seconds() - startTimeProcess);
+}
+
+bool FAssimpScene::ExportWithStreamWriter(const FRuntimeMeshExportParam& param, const bool bAlreadyGathered, FString& outError)
+{
+    check(bAlreadyGathered || IsInGameThread());
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+    TUniquePtr<FRuntimeMeshStreamWriter> writer = FRuntimeMeshStreamWriter::Create(param);
+    if (!writer)
+    {
+        outError = FString::Printf(TEXT("Format %s can not be exported streaming."), *param.formatId);
+        return false;
+    }
+    if (!writer->Begin(param.file))
+    {
+        outError = writer->GetError();
+        return false;
+    }
+
+    // Same result as the root correction and aiProcess_MakeLeftHanded of the regular export.
+    // With the hierarchy the mirror is applied on both sides of each node matrix, so it cancels out between the nodes.
+    const FMatrix mirror = FScaleMatrix(FVector(1.f, 1.f, -1.f));
+    const FMatrix worldToFile = rootNode->worldTransform.Inverse().ToMatrixWithScale() * rootNode->GetCorrectedRootTransform(param).ToMatrixWithScale() * mirror;
+    const bool bHierarchy = writer->KeepsHierarchy();
+
+    WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Begin export with the %s writer of the plugin."), *param.formatId);
+    if (!bAlreadyGathered)
+    {
+        // The writer needs the sections of every exportable
+        StartGather(param, false);
+    }
+    BuildExportHierarchy(param);
+
+    // The writers that can not write the LODs into the same file write a file per LOD
+    const bool bLodsInFile = writer->WritesLods();
+    TArray<TUniquePtr<FRuntimeMeshStreamWriter>> lodWriters;
+    TArray<FString> lodFiles;
+    for (int32 lodIndex = 0; lodIndex < additionalLods.Num() && !bLodsInFile; ++lodIndex)
+    {
+        lodFiles.Add(GetLodFile(param.file, additionalLods[lodIndex]));
+        lodWriters.Add(FRuntimeMeshStreamWriter::Create(param));
+        if (!lodWriters.Last()->Begin(lodFiles.Last()))
+        {
+            outError = lodWriters.Last()->GetError();
+            return false;
+        }
+    }
+
+    // Parents come before their children in 'allNodesHelper'
+    TMap<const FAssimpNode*, int32> writerNodes;
+    int32 numWritten = 0;
+    double duration = 0.f;
+    {
+        FScopedDurationTimer timer(duration);
+        for (FAssimpNode* node : allNodesHelper)
+        {
+            int32 writerNode = INDEX_NONE;
+            FMatrix worldToSpace = worldToFile;
+            if (bHierarchy && node->bInExportHierarchy)
+            {
+                const FMatrix localToParent = node->exportParent ? node->worldTransform.ToMatrixWithScale() * node->exportParent->worldTransform.ToInverseMatrixWithScale()
+                    : node->GetCorrectedRootTransform(param).ToMatrixWithScale();
+                const int32* parentNode = node->exportParent ? writerNodes.Find(node->exportParent) : nullptr;
+                writerNode = writer->AddNode(node->name.ToString(), parentNode ? *parentNode : INDEX_NONE, mirror * localToParent * mirror);
+                writerNodes.Add(node, writerNode);
+                worldToSpace = node->worldTransform.ToInverseMatrixWithScale() * mirror;
+            }
+
+            for (int32 objectIndex = 0; objectIndex < node->exportObjects.Num() && !param.cancellationToken.IsCancelled(); ++objectIndex)
+            {
+                if (!bAlreadyGathered && !node->GatherExportable(*this, param, objectIndex))
+                {
+                    ++numObjectsSkipped;
+                    continue;
                 }
 
-                //Vector material parameters
+                TArray<FExportableMeshSection>& sections = node->gatheredExportables[objectIndex];
+                TArray<FAssimpNode::FGatheredLod>& lods = node->gatheredLods[objectIndex];
+                // The sections of an instanced exportable only go to the mirrored space of the instances, the instance matrices place them
+                const TArray<FTransform>& instanceTransforms = node->objectInstanceTransforms[objectIndex];
+                const FMatrix& worldToSectionSpace = instanceTransforms.Num() > 0 ? mirror : worldToSpace;
+                auto TransformToSpace = [&worldToSectionSpace](TArray<FExportableMeshSection>& lodSections, TArray<FExportableMeshSectionView>& lodViews)
                 {
-                    FHashedMaterialParameterInfo color4DBasecolorParam;
-                    FLinearColor basecolorValue;
-                    color4DBasecolorParam.Name = FName("BaseColor");
-                    if (section.material->GetVectorParameterValue(color4DBasecolorParam, basecolorValue))
+                    if (lodViews.Num() > 0)
                     {
-                        aiColor3D transColor(basecolorValue.R, basecolorValue.G, basecolorValue.B);
-                        material->AddProperty(&transColor, 1, AI_MATKEY_COLOR_DIFFUSE);
+                        lodSections.SetNum(lodViews.Num());
+                        for (int32 viewIndex = 0; viewIndex < lodViews.Num(); ++viewIndex)
+                        {
+                            FAssimpNode::CopyTransformedView(lodViews[viewIndex], lodViews[viewIndex].meshToWorld.ToMatrixWithScale() * worldToSectionSpace, false, lodSections[viewIndex]);
+                        }
+                        lodViews.Empty();
+                        return;
                     }
-                }
-                
-                {
-                    FHashedMaterialParameterInfo color4DSpecularParam;
-                    FLinearColor specColor;
-                    color4DSpecularParam.Name = FName("SpecularColor");
-                    if (section.material->GetVectorParameterValue(color4DSpecularParam, specColor))
+                    for (FExportableMeshSection& section : lodSections)
                     {
-                        aiColor4D specularColor(specColor.R, specColor.G, specColor.B,specColor.A);
-                        material->AddProperty(&specularColor, 1, AI_MATKEY_GLTF_PBRSPECULARGLOSSINESS_SPECULAR_FACTOR);
+                        const FMatrix meshToSpace = section.meshToWorld.ToMatrixWithScale() * worldToSectionSpace;
+                        FMeshConversionKernels::TransformVertices(meshToSpace, section.vertices.GetData(), section.normals.GetData(), section.tangents.GetData()
+                            , section.vertices.GetData(), section.normals.GetData(), section.tangents.GetData(), section.vertices.Num());
                     }
-                }
-                  
+                };
+                // Each exportable is written on its own, so only its own sections are combined
+                auto CombineSameMaterial = [](TArray<FExportableMeshSection>& lodSections)
                 {
-                    FHashedMaterialParameterInfo color4DSpecularParam;
-                    FLinearColor emissiveColor;
-                    color4DSpecularParam.Name = FName("EmissiveColor");
-                    if (section.material->GetVectorParameterValue(color4DSpecularParam, emissiveColor))
+                    TMap<UMaterialInterface*, TArray<FExportableMeshSection>> sectionsByMaterial;
+                    for (FExportableMeshSection& section : lodSections)
                     {
-                        aiColor4D specularColor(emissiveColor.R, emissiveColor.G, emissiveColor.B, emissiveColor.A);
-                        material->AddProperty(&specularColor, 1, AI_MATKEY_COLOR_EMISSIVE);
+                        sectionsByMaterial.FindOrAdd(section.material).Add(MoveTemp(section));
                     }
-                }
-
-                //Scalar material parameters
-                {
-                    FHashedMaterialParameterInfo constRoughnessParam;
-                    constRoughnessParam.Name = FName("Roughness_strength");
-                    float roughnessValue=0.0f;
-                    if (section.material->GetScalarParameterValue(constRoughnessParam, roughnessValue))
+                    lodSections.Reset();
+                    for (auto& element : sectionsByMaterial)
                     {
-                        material->AddProperty(&roughnessValue, 1, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_ROUGHNESS_FACTOR);
+                        FAssimpNode::CombineSections(element.Value);
+                        lodSections.Append(MoveTemp(element.Value));
                     }
-                }
-
+                };
+                // The LODs of the exportable are transformed in parallel, the writers take them one after the other
+                ParallelFor(lods.Num() + 1, [&](const int32 lodIndex)
                 {
-                    FHashedMaterialParameterInfo constMetallicParam;
-                    constMetallicParam.Name = FName("Metallic_strength");
-                    float MetallicValue = 0.0f;
-                    if (section.material->GetScalarParameterValue(constMetallicParam, MetallicValue))
+                    TArray<FExportableMeshSection>& lodSections = lodIndex == 0 ? sections : lods[lodIndex - 1].sections;
+                    TransformToSpace(lodSections, lodIndex == 0 ? node->gatheredViews[objectIndex] : lods[lodIndex - 1].views);
+                    if (param.bCombineSameMaterial)
                     {
-                        material->AddProperty(&MetallicValue, 1, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLIC_FACTOR);
+                        CombineSameMaterial(lodSections);
                     }
+                }, lods.Num() == 0);
+                if (sections.Num() == 0)
+                {
+                    lods.Empty();
+                    continue;
                 }
-
+                for (const FExportableMeshSection& section : sections)
                 {
-                    FHashedMaterialParameterInfo constRefractionParam;
-                    constRefractionParam.Name = FName("Refraction_strength");
-                    float refractionValue = 0.0f;      
-                    if (section.material->GetScalarParameterValue(constRefractionParam, refractionValue))
-                    {
-                        material->AddProperty(&refractionValue, 1, AI_MATKEY_REFRACTI);
-                    }
+                    ++metrics.numMeshes;
+                    metrics.numVertices += section.vertices.Num();
+                    metrics.numTriangles += section.triangles.Num() / 3;
                 }
-
+                const FString meshName = node->exportObjects[objectIndex].GetObject()->GetName();
+                if (instanceTransforms.Num() > 0)
                 {
-                    FHashedMaterialParameterInfo constOpacityParam;
-                    constOpacityParam.Name = FName("Opacity_strength");
-                    float opacityValue = 1;
-                    if (section.material->GetScalarParameterValue(constOpacityParam, opacityValue))
+                    TArray<FMatrix> instanceToSpace;
+                    instanceToSpace.Reserve(instanceTransforms.Num());
+                    for (const FTransform& instanceToWorld : instanceTransforms)
                     {
-                        material->AddProperty(&opacityValue, 1, AI_MATKEY_OPACITY);
+                        instanceToSpace.Add(mirror * instanceToWorld.ToMatrixWithScale() * worldToSpace);
                     }
+                    writer->WriteInstancedMesh(meshName, sections, instanceToSpace, writerNode);
+                    for (int32 lodIndex = 0; lodIndex < lodWriters.Num() && lodIndex < lods.Num(); ++lodIndex)
+                    {
+                        lodWriters[lodIndex]->WriteInstancedMesh(meshName, lods[lodIndex].sections, instanceToSpace, writerNode);
+                    }
+                    metrics.numInstances += instanceTransforms.Num();
                 }
-
-                //experiment
-                /*{
-                    float matProperty = 0.85, property2 = 0.8, roughValue = 0.1f;
-                    //material->AddProperty(&matProperty,1,AI_MATKEY_REFLECTIVITY);
-                    aiColor4D property3(0.45, 0.45, 0.45, 0.5);
-                    aiColor3D specularColor(0.69, 0.69, 0.69);
-                    //material->AddProperty(&specularColor, 1, AI_MATKEY_COLOR_SPECULAR);
-                    //material->AddProperty<aiColor4D>(&property3, 1, AI_MATKEY_COLOR_REFLECTIVE);
-                    material->AddProperty(&property2, 1, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLIC_FACTOR);
-
-                }*/
-                
-                if (section.material->GetBlendMode() == EBlendMode::BLEND_Translucent)
-                {
-
-                }
-                else if (section.material->GetBlendMode() == EBlendMode::BLEND_Opaque)
+                else if (bLodsInFile && lods.Num() > 0)
                 {
-                    
+                    TArray<TArrayView<const FExportableMeshSection>> lodSections;
+                    for (const FAssimpNode::FGatheredLod& lod : lods)
+                    {
+                        lodSections.Add(lod.sections);
+                    }
+                    writer->WriteMeshWithLods(meshName, sections, lodSections, writerNode);
                 }
-			}
-			else
-			{
-				mesh->mMaterialIndex = foundMaterialIndex;
-			}
-
-            // Vertices
-            {
-                // Do some checks to make sure we move the data
-                check(sizeof(aiVector3D) == sizeof(FVector));
-                check(sizeof(aiColor4D) == sizeof(FLinearColor));
-
-                int32 numVertices = section.vertices.Num();
-
-                // Positions
-                mesh->vertices = MoveTemp(*reinterpret_cast<TArray<aiVector3D>*>(&section.vertices));
-                check(section.vertices.Num() == 0); // just to check that the move worked
-
-                // Normals
-                mesh->normals = MoveTemp(*reinterpret_cast<TArray<aiVector3D>*>(&section.normals));
-
-                // Tangents
-                mesh->tangents = MoveTemp(*reinterpret_cast<TArray<aiVector3D>*>(&section.tangents));
-
-                // Bitangents
-                // Seems that Assimp requires bitangents, though we do not supply values for now. See how it works out.
-                mesh->bitangents.AddZeroed(numVertices);
-
-                // Colors
-                TArray<FLinearColor> linearColors;
-                linearColors.Reserve(numVertices);
-                for (int32 colorIndex = 0; colorIndex < numVertices; ++colorIndex)
+                else
                 {
-                    linearColors.Add(section.vertexColors[colorIndex].ReinterpretAsLinear());
+                    writer->WriteMesh(meshName, sections, writerNode);
+                    for (int32 lodIndex = 0; lodIndex < lodWriters.Num() && lodIndex < lods.Num(); ++lodIndex)
+                    {
+                        lodWriters[lodIndex]->WriteMesh(meshName, lods[lodIndex].sections, writerNode);
+                    }
                 }
-                mesh->vertexColors = MoveTemp(*reinterpret_cast<TArray<aiColor4D>*>(&linearColors));
+                ++numWritten;
 
-
-                // TextureCoordinates
-                mesh->numUVComponents[0] = 2;
-                mesh->textureCoordinates->Reserve(numVertices);
-                for (int32 texIndex = 0; texIndex < numVertices; ++texIndex)
-                {
-                    FVector2D& coord = section.textureCoordinates[texIndex];
-                    mesh->textureCoordinates[0].Add(aiVector3D(coord.X, coord.Y, 0.f));
-                }
+                // Only one exportable is kept in memory when streaming
+                sections.Empty();
+                lods.Empty();
             }
+        }
+    }
 
-            // Faces
-            {
-                const int32 numIndicesPerFace = 3;
-                check((section.triangles.Num() % numIndicesPerFace) == 0);
-                const int32 numFaces = section.triangles.Num() / numIndicesPerFace;
-                mesh->faces.SetNum(numFaces);
-                for (int32 faceIndex = 0; faceIndex < numFaces; ++faceIndex)
-                {
-                    int32 triangleStart = faceIndex * numIndicesPerFace;
-                    aiFace& face = mesh->faces[faceIndex];
-                    face.mNumIndices = numIndicesPerFace;
-                    face.mIndices = new unsigned int[numIndicesPerFace];
-                    face.mIndices[0] = section.triangles[triangleStart];
-                    face.mIndices[1] = section.triangles[triangleStart + 1];
-                    face.mIndices[2] = section.triangles[triangleStart + 2];
-                }
-            }
+    bool bSuccess = writer->End() && !param.cancellationToken.IsCancelled();
+    FString writerError = writer->GetError();
+    metricsBytesWritten.Add(FMath::Max<int64>(FPlatformFileManager::Get().GetPlatformFile().FileSize(*param.file), 0));
+    for (int32 lodIndex = 0; lodIndex < lodWriters.Num(); ++lodIndex)
+    {
+        if (!lodWriters[lodIndex]->End())
+        {
+            bSuccess = false;
+            URuntimeMeshImportExportLibrary::NewLineAndAppend(writerError, lodWriters[lodIndex]->GetError());
         }
+        metricsBytesWritten.Add(FMath::Max<int64>(FPlatformFileManager::Get().GetPlatformFile().FileSize(*lodFiles[lodIndex]), 0));
+    }
+    WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("End export with the writer of the plugin. Duration: %.3fs, %d exportables written with %d additional LODs")
+        , duration, numWritten, additionalLods.Num());
+    if (!bSuccess)
+    {
+        outError = param.cancellationToken.IsCancelled() ? FString(TEXT("Export cancelled.")) : writerError;
     }
+    return bSuccess;
 }
 
+FString FAssimpScene::GetLodFile(const FString& file, const int32 lod)
+{
+    return FPaths::Combine(FPaths::GetPath(file), FString::Printf(TEXT("%s_LOD%d%s"), *FPaths::GetBaseFilename(file), lod, *FPaths::GetExtension(file, true)));
+}
 
-bool FAssimpNode::ValidateMeshSection(FAssimpScene& scene, TScriptInterface<IMeshExportable>& exportable, FExportableMeshSection& section)
+bool FAssimpScene::UsesStreamWriter(const FRuntimeMeshExportParam& param, const bool bAsync)
 {
-    bool bMeshValid = true;
-    int32 numVertices = section.vertices.Num();
-    if (section.normals.Num() != numVertices)
+    // The writers write to files
+    if (param.bExportToMemory)
     {
-        scene.WriteToLogWithNewLine(FString::Printf(TEXT("Object %: Number of normals not equal number of vertices!"), *exportable.GetObject()->GetName()));
-        bMeshValid = false;
+        return false;
     }
-
-    if (section.tangents.Num() != numVertices)
+    if (param.bNativeGltfExport && FRuntimeMeshStreamWriter::IsGltf(param.formatId))
     {
-        scene.WriteToLogWithNewLine(FString::Printf(TEXT("Object %: Number of tangents not equal number of vertices!"), *exportable.GetObject()->GetName()));
-        bMeshValid = false;
+        return true;
     }
+    // The async gathering keeps all exportables anyway
+    return param.bStreamingExport && !bAsync && FRuntimeMeshStreamWriter::IsSupported(param.formatId);
+}
 
-    if (section.vertexColors.Num() != numVertices)
+void FAssimpScene::PrepareSceneForExport_Async_Start(const FRuntimeMeshExportAsyncParam& param, FRuntimeMeshImportExportProgressUpdate callbackProgress
+        , TFunction<void()> onPrepareFinished)
+{
+    gatheredMeshNum = 0;
+    currentNodeIndex = 0;
+    delegateProgress = callbackProgress;
+    onGameThreadPrepareFinished = onPrepareFinished;
+	numGatherPerTick = param.numGatherPerTick < 1 ? 1 : param.numGatherPerTick;
+	gatherBudgetSeconds = FMath::Max(0.f, param.gatherBudgetMs) / 1000.0;
+	bUseGatherCostEstimates = param.bUseGatherCostEstimates;
+	startTimeGatherMeshData = FPlatformTime::Seconds();
+	WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Begin gather mesh data."));
+    StartGather(param.param, !UsesStreamWriter(param.param, true));
+    if (param.bSnapshotGather)
     {
-        scene.WriteToLogWithNewLine(FString::Printf(TEXT("Object %: Number of vertexColors not equal number of vertices!"), *exportable.GetObject()->GetName()));
-        bMeshValid = false;
+        GatherSnapshot(param.param);
     }
 
-    if (section.textureCoordinates.Num() != numVertices)
+    // The ticker gathers the exportables that need the GameThread, worker threads gather the thread safe ones meanwhile
+    numPendingGathers.Set(threadSafeGathers.Num() > 0 ? 2 : 1);
+    if (!param.bSnapshotGather)
     {
-        scene.WriteToLogWithNewLine(FString::Printf(TEXT("Object %: Number of textureCoordinates not equal number of vertices!"), *exportable.GetObject()->GetName()));
-        bMeshValid = false;
+        gatherMeshDataTicker = MakeUnique<FGatherMeshDataTicker>(this, param);
     }
-
-    if (section.triangles.Num() % 3 != 0)
+    if (threadSafeGathers.Num() > 0)
     {
-        scene.WriteToLogWithNewLine(FString::Printf(TEXT("Object %: Number of triangles is not dividable by 3!"), *exportable.GetObject()->GetName()));
-        bMeshValid = false;
+        const FRuntimeMeshExportParam gatherParam = param.param;
+        FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([this, gatherParam]() {
+            GatherThreadSafe(gatherParam);
+            FinishGather();
+        });
+    }
+    if (param.bSnapshotGather)
+    {
+        // The GameThread part is done already
+        delegateProgress.ExecuteIfBound(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::GatheringMeshs, allNodesHelper.Num(), allNodesHelper.Num()));
+        FinishGather();
     }
-
-    return bMeshValid;
 }
 
-
-void FAssimpScene::WriteToLogWithNewLine(const FString& logText)
+void FAssimpScene::GatherSnapshot(const FRuntimeMeshExportParam& param)
 {
-    if (exportLog)
+    check(IsInGameThread());
+    const double startTime = FPlatformTime::Seconds();
+
+    // A view only references the buffers of its exportable, so the thread safe ones are taken now as well.
+    // Only the thread safe exportables that copy their data are left to the worker threads.
+    int32 numViews = 0;
+    for (int32 index = threadSafeGathers.Num() - 1; index >= 0; --index)
+    {
+        FAssimpNode* node = threadSafeGathers[index].Key;
+        const int32 objectIndex = threadSafeGathers[index].Value;
+        if (!HasMeshDataViews(node->exportObjects[objectIndex]))
+        {
+            continue;
+        }
+        if (!node->GatherExportable(*this, param, objectIndex))
+        {
+            ++numObjectsSkipped;
+        }
+        threadSafeGathers.RemoveAt(index, 1, false);
+        ++numViews;
+    }
+
+    int32 numCopied = 0;
+    for (FAssimpNode* node : allNodesHelper)
     {
-        URuntimeMeshImportExportLibrary::NewLineAndAppend(*exportLog, logText);
+        for (int32 objectIndex = node->indexGatherNext; objectIndex < node->exportObjects.Num(); ++objectIndex)
+        {
+            const TScriptInterface<IMeshExportable>& object = node->exportObjects[objectIndex];
+            if (node->IsSharedInstanceOnly(objectIndex) || IsThreadSafeGather(object))
+            {
+                continue;
+            }
+            if (HasMeshDataViews(object))
+            {
+                ++numViews;
+            }
+            else
+            {
+                ++numCopied;
+            }
+        }
+        gatheredMeshNum += node->GatherMeshData(*this, param, true, 0, 0.0, true);
     }
+    currentNodeIndex = allNodesHelper.Num();
 
-    if (bLogToUnreal)
+    WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Snapshot of the scene in %.3fs: %d exportables as views, %d copied on the GameThread, %d left to the worker threads.")
+        , FPlatformTime::Seconds() - startTime, numViews, numCopied, threadSafeGathers.Num());
+    if (numCopied > 0)
     {
-        RMIE_LOG(Log, "%s", *logText);
+        WriteToLog(ERuntimeMeshExportLogSeverity::Verbose, TEXT("The exportables without IMeshExportable::GetMeshDataViews copy their data in the snapshot tick."));
     }
 }
 
-void FAssimpScene::PrepareSceneForExport(const FRuntimeMeshExportParam& param)
+double FAssimpScene::EstimateGatherCost(const TScriptInterface<IMeshExportable>& object) const
 {
-    numObjectsSkipped = 0;
-	WriteToLogWithNewLine(FString(TEXT("Begin gather mesh data.")));
-    rootNode->GetNodesRecursive(allNodesHelper);
-	double duration = 0.f;
-	{
-		FScopedDurationTimer timer(duration);
-		for (FAssimpNode* node : allNodesHelper)
-		{
-			node->GatherMeshData(*this, param, true);
-		}
-	}
-	WriteToLogWithNewLine(FString::Printf(TEXT("End gather mesh data. Duration: %.3fs"), duration));
+    const double* estimate = gatherCostEstimates.Find(object.GetObject()->GetClass());
+    return estimate ? *estimate : 0.0;
+}
 
-    rootNode->ProcessGatheredData_Recursive(*this, param);
-    SetDataAndPtrsToParentClass_EntireScene(param);
+void FAssimpScene::UpdateGatherCostEstimate(const TScriptInterface<IMeshExportable>& object, const double duration)
+{
+    // Exponential moving average, so the estimate follows when the meshes of a class get heavier
+    double* estimate = gatherCostEstimates.Find(object.GetObject()->GetClass());
+    if (estimate)
+    {
+        *estimate = FMath::Lerp(*estimate, duration, 0.25);
+    }
+    else
+    {
+        gatherCostEstimates.Add(object.GetObject()->GetClass(), duration);
+    }
 }
 
-void FAssimpScene::PrepareSceneForExport_Async_Start(const FRuntimeMeshExportAsyncParam& param, FRuntimeMeshImportExportProgressUpdate callbackProgress
-        , TFunction<void()> onPrepareFinished)
+void FAssimpScene::FinishGather()
 {
-    numObjectsSkipped = 0;
-    gatheredMeshNum = 0;
-    currentNodeIndex = 0;
-    delegateProgress = callbackProgress;
-    onGameThreadPrepareFinished = onPrepareFinished;
-	numGatherPerTick = param.numGatherPerTick < 1 ? 1 : param.numGatherPerTick;
-    rootNode->GetNodesRecursive(allNodesHelper);
-	startTimeGatherMeshData = FPlatformTime::Seconds();
-	WriteToLogWithNewLine(FString(TEXT("Begin gather mesh data.")));
-    gatherMeshDataTicker = MakeUnique<FGatherMeshDataTicker>(this, param);
+    if (numPendingGathers.Decrement() > 0)
+    {
+        return;
+    }
+
+    auto finish = [this]() {
+        numObjectsSkipped += numThreadSafeSkipped;
+        stageTimings.gatherSeconds = float(FPlatformTime::Seconds() - startTimeGatherMeshData);
+        WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("End gather mesh data. Duration: %.3fs, %d of the exportables in parallel")
+            , stageTimings.gatherSeconds, threadSafeGathers.Num());
+        onGameThreadPrepareFinished();
+    };
+    if (IsInGameThread())
+    {
+        finish();
+    }
+    else
+    {
+        AsyncTask(ENamedThreads::GameThread, finish);
+    }
 }
 
 void FAssimpScene::PrepareSceneForExport_Update(const FRuntimeMeshExportParam& param)
@@ -753,13 +1973,29 @@ void FAssimpScene::PrepareSceneForExport_Update(const FRuntimeMeshExportParam& p
         checkNoEntry();
     }
 
-    const int32 endIndex = currentNodeIndex + numGatherPerTick;
-    int32 numToGather = numGatherPerTick;
+    // On cancel, skip the remaining nodes. The export itself is skipped after the gathering.
+    if (param.cancellationToken.IsCancelled())
+    {
+        currentNodeIndex = allNodesHelper.Num();
+        AsyncTask(ENamedThreads::GameThread, [this]() {
+            gatherMeshDataTicker.Reset();
+        });
+        WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Gather mesh data cancelled."));
+        FinishGather();
+        return;
+    }
+
+    // With a budget the count is unlimited and the deadline ends the tick
+    const double deadline = gatherBudgetSeconds > 0.0 ? FPlatformTime::Seconds() + gatherBudgetSeconds : 0.0;
+    int32 numToGather = deadline > 0.0 ? MAX_int32 : numGatherPerTick;
+    int32 numGatheredThisTick = 0;
     while (numToGather)
     {
-        int32 numGathered = allNodesHelper[currentNodeIndex]->GatherMeshData(*this, param, false, numToGather);
+        FAssimpNode* node = allNodesHelper[currentNodeIndex];
+        int32 numGathered = node->GatherMeshData(*this, param, false, numToGather, deadline, numGatheredThisTick == 0);
         gatheredMeshNum += numGathered;
-        if (numGathered == 0)
+        numGatheredThisTick += numGathered;
+        if (node->IsGatherDone())
         {
             ++currentNodeIndex;
             if (currentNodeIndex >= allNodesHelper.Num())
@@ -772,12 +2008,15 @@ void FAssimpScene::PrepareSceneForExport_Update(const FRuntimeMeshExportParam& p
 					}
                 });
 
-				WriteToLogWithNewLine(FString::Printf(TEXT("End gather mesh data. Duration: %.3fs"), FPlatformTime::Seconds() - startTimeGatherMeshData));
-
-                onGameThreadPrepareFinished();
+                FinishGather();
                 break;
             }
         }
+        else if (deadline > 0.0)
+        {
+            // The node stopped for the budget
+            break;
+        }
         numToGather -= numGathered;
     }
 
@@ -792,12 +2031,112 @@ void FAssimpScene::PrepareSceneForExport_Async_Finish(const FRuntimeMeshExportPa
 		//delegateStatus.ExecuteIfBound(FString::Printf(TEXT("Processing gathered data")));
   //  });
 
+    const double startTimeProcess = FPlatformTime::Seconds();
     rootNode->ProcessGatheredData_Recursive(*this, param);
+    StartTextureExport(param);
 
   //  AsyncTask(ENamedThreads::GameThread, [this]() {
 		//delegateStatus.ExecuteIfBound(FString::Printf(TEXT("Giving Assimp types data access")));
   //  });
     SetDataAndPtrsToParentClass_EntireScene(param);
+    stageTimings.processSeconds = float(FPlatformTime::Seconds() - startTimeProcess);
+}
+
+void FAssimpScene::StartTextureExport(const FRuntimeMeshExportParam& param)
+{
+    if (textureExportJobs.Num() == 0 || param.cancellationToken.IsCancelled())
+    {
+        return;
+    }
+
+    const ERuntimeMeshExportTextureFormat format = param.textureFormat;
+    const int32 quality = param.textureQuality;
+    if (param.bEmbedTextures)
+    {
+        WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Begin encoding %d embedded textures."), textureExportJobs.Num());
+        double duration = 0.f;
+        {
+            FScopedDurationTimer timer(duration);
+            ParallelFor(textureExportJobs.Num(), [this, format, quality](int32 jobIndex)
+            {
+                FRuntimeMeshMetrics::FScopedThreadCycles threadCycles(metricsThreadCycles);
+                RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+                FTextureExportJob& job = textureExportJobs[jobIndex];
+                FRuntimeMeshTextureBuilder::EncodeImage_AnyThread(job.pixels, format, quality, job.fileBytes);
+                job.pixels = FRuntimeMeshTextureMips();
+            });
+        }
+        WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("End encoding embedded textures. Duration: %.3fs"), duration);
+        stageTimings.textureSeconds = float(duration);
+
+        // Compressed textures, the index is the one the materials reference with "*<index>"
+        for (FTextureExportJob& job : textureExportJobs)
+        {
+            aiTexture* texture = new(exportArena) aiTexture();
+            texture->mWidth = job.fileBytes.Num();
+            texture->mHeight = 0;
+            texture->pcData = reinterpret_cast<aiTexel*>(job.fileBytes.GetData());
+            FCStringAnsi::Strncpy(texture->achFormatHint, TCHAR_TO_ANSI(FRuntimeMeshTextureBuilder::GetExtension(format)), sizeof(texture->achFormatHint));
+            embeddedTextures.Add(texture);
+        }
+        return;
+    }
+
+    // The files do not depend on the geometry, write them while Assimp exports it
+    textureExportTask = Async(EAsyncExecution::ThreadPool, [this, format, quality, param]()
+    {
+        SCOPE_CYCLE_COUNTER(STAT_RMIE_ExportWriteTextures);
+        RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+        WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Begin writing %d textures."), textureExportJobs.Num());
+        double duration = 0.f;
+        FThreadSafeCounter numFailed;
+        {
+            FScopedDurationTimer timer(duration);
+            ParallelFor(textureExportJobs.Num(), [this, format, quality, &param, &numFailed](int32 jobIndex)
+            {
+                TRACE_CPUPROFILER_EVENT_SCOPE(RMIE_WriteTexture);
+                FRuntimeMeshMetrics::FScopedThreadCycles threadCycles(metricsThreadCycles);
+                RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+                FTextureExportJob& job = textureExportJobs[jobIndex];
+                if (param.bExportToMemory && FRuntimeMeshTextureBuilder::EncodeImage_AnyThread(job.pixels, format, quality, job.fileBytes))
+                {
+                    INC_DWORD_STAT_BY(STAT_RMIE_ExportedFileBytes, job.fileBytes.Num());
+                    FRuntimeMeshExportedFile file;
+                    file.name = FPaths::GetCleanFilename(job.file);
+                    file.data = MoveTemp(job.fileBytes);
+                    AddExportedFile(param, MoveTemp(file));
+                }
+                else if (!param.bExportToMemory && FRuntimeMeshTextureBuilder::EncodeImage_AnyThread(job.pixels, format, quality, job.fileBytes)
+                    && FFileHelper::SaveArrayToFile(job.fileBytes, *job.file))
+                {
+                    INC_DWORD_STAT_BY(STAT_RMIE_ExportedFileBytes, job.fileBytes.Num());
+                    metricsBytesWritten.Add(job.fileBytes.Num());
+                    FRuntimeMeshImportExportTextureCache::Get().AddExportedTexture_AnyThread(job.file, job.texture);
+                }
+                else
+                {
+                    WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Failed to write texture %s."), *job.file);
+                    numFailed.Increment();
+                }
+                job.pixels = FRuntimeMeshTextureMips();
+                job.fileBytes.Empty();
+            });
+        }
+        WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("End writing textures. Duration: %.3fs, %d failed"), duration, numFailed.GetValue());
+        // Read after FinishTextureExport
+        stageTimings.textureSeconds = float(duration);
+    });
+}
+
+void FAssimpScene::FinishTextureExport()
+{
+    if (textureExportTask.IsValid())
+    {
+        const double startTimeWait = FPlatformTime::Seconds();
+        textureExportTask.Wait();
+        textureExportTask = TFuture<void>();
+        stageTimings.textureWaitSeconds = float(FPlatformTime::Seconds() - startTimeWait);
+    }
 }
 
 void FAssimpScene::ClearSceneExportData()
@@ -807,6 +2146,14 @@ void FAssimpScene::ClearSceneExportData()
     numGatherPerTick = -1;
 
     ClearParentDataAndPtrs();
+    // The nodes keep the vertex data before the meshes are destroyed
+    TArray<FAssimpNode*> nodes;
+    rootNode->GetNodesRecursive(nodes);
+    for (FAssimpNode* node : nodes)
+    {
+        node->StoreMeshCache(*this, bMeshDataComplete);
+    }
+    bMeshDataComplete = false;
     ClearMeshData();
     rootNode->ClearExportData();
 }
@@ -830,35 +2177,131 @@ void FAssimpScene::ClearParentDataAndPtrs()
 
 void FAssimpScene::ClearMeshData()
 {
+	DEC_MEMORY_STAT_BY(STAT_RMIE_ExportSceneMemory, statSceneMemory);
+	statSceneMemory = 0;
+	// The texture writes read the jobs
+	FinishTextureExport();
 	uniqueMaterials.Empty();
+	exportedTextures.Empty();
+	textureFileNames.Empty();
+	sharedMeshIndices.Empty();
 
+	// The objects live in the arena, only run the destructors to free the data they own.
+	// The vertex data and the encoded textures are freed on a background thread, this can run on the GameThread after an export.
+	FRuntimeMeshDeferredRelease::FBatch released;
 	for (FAssimpMesh* mesh : meshes)
     {
-        delete mesh;
+        released.Add(MoveTemp(mesh->vertices));
+        released.Add(MoveTemp(mesh->normals));
+        released.Add(MoveTemp(mesh->tangents));
+        released.Add(MoveTemp(mesh->vertexColors));
+        for (TArray<aiVector3D>& textureCoordinates : mesh->textureCoordinates)
+        {
+            if (textureCoordinates.Num() > 0)
+            {
+                released.Add(MoveTemp(textureCoordinates));
+            }
+        }
+        mesh->~FAssimpMesh();
     }
     meshes.Empty();
 
     for (aiMaterial* material : materials)
     {
-        delete material;
+        material->~aiMaterial();
     }
     materials.Empty();
+
+    for (aiTexture* texture : embeddedTextures)
+    {
+        // The data belongs to the job
+        texture->pcData = nullptr;
+        texture->~aiTexture();
+    }
+    embeddedTextures.Empty();
+    for (FTextureExportJob& job : textureExportJobs)
+    {
+        released.Add(MoveTemp(job.fileBytes));
+        for (TArray<uint8>& mip : job.pixels.mips)
+        {
+            released.Add(MoveTemp(mip));
+        }
+    }
+    textureExportJobs.Empty();
+    FRuntimeMeshDeferredRelease::Release(MoveTemp(released));
+
+    exportArena.Flush();
 }
 
-bool FAssimpNode::ExportTexture(UTexture* textureRef,FString &outTexturePath)
+bool FAssimpNode::ExportTexture(FAssimpScene& scene, const FRuntimeMeshExportParam& param, UTexture* textureRef, FString& outTexturePath)
 {
-    if (textureRef != nullptr)
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ExportTexture);
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+    if (textureRef == nullptr)
     {
-        bool isExported;
-        outTexturePath = FPaths::ProjectDir() + "Export/" + textureRef->GetFName().ToString() + ".bmp";
-        // Exports texture
-        isExported = UExporter::ExportToFile(textureRef, NULL, *outTexturePath, false) >=1 ? true : false;
-        UE_LOG(LogTemp, Display, TEXT("M_M exported texture name = %s  is successfully exported? = %d"), *outTexturePath, isExported);
-        return isExported;
-        
+        return false;
+    }
+
+    // Many materials share their textures, each one is only exported once per export
+    if (const FString* exportedPath = scene.exportedTextures.Find(textureRef))
+    {
+        outTexturePath = *exportedPath;
+        return !outTexturePath.IsEmpty();
+    }
+    outTexturePath.Empty();
+
+    // Next to the export file with a name that is unique within this export
+    const FString baseName = FPaths::MakeValidFileName(textureRef->GetName());
+    const TCHAR* extension = FRuntimeMeshTextureBuilder::GetExtension(param.textureFormat);
+    FString fileName = FString::Printf(TEXT("%s.%s"), *baseName, extension);
+    for (int32 suffix = 1; scene.textureFileNames.Contains(fileName); ++suffix)
+    {
+        fileName = FString::Printf(TEXT("%s_%d.%s"), *baseName, suffix, extension);
+    }
+    scene.textureFileNames.Add(fileName);
+    const FString exportDirectory = FPaths::GetPath(param.file);
+
+    FAssimpScene::FTextureExportJob job;
+    job.texture = textureRef;
+    if (!param.bEmbedTextures)
+    {
+        job.file = FPaths::Combine(exportDirectory, fileName);
+        // Files in memory are always sent along
+        if (!param.bExportToMemory && FRuntimeMeshImportExportTextureCache::Get().FindExportedTexture_AnyThread(job.file, textureRef))
+        {
+            // Written by an earlier export and neither the texture nor the file changed since
+            outTexturePath = fileName;
+        }
+    }
+
+    if (outTexturePath.IsEmpty())
+    {
+        if (FRuntimeMeshTextureBuilder::ReadPixels(textureRef, job.pixels))
+        {
+            outTexturePath = param.bEmbedTextures ? FString::Printf(TEXT("*%d"), scene.textureExportJobs.Num()) : fileName;
+            scene.textureExportJobs.Add(MoveTemp(job));
+        }
+        else if (!param.bExportToMemory)
+        {
+            // No uncompressed pixels on the CPU, the texture exporters can still write a BMP from the source data in the editor
+            const FString bmpName = FPaths::GetBaseFilename(fileName) + TEXT(".bmp");
+            if (UExporter::ExportToFile(textureRef, NULL, *FPaths::Combine(exportDirectory, bmpName), false) >= 1)
+            {
+                outTexturePath = bmpName;
+            }
+        }
+    }
+
+    if (outTexturePath.IsEmpty())
+    {
+        scene.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Texture %s can not be exported, it has no readable pixels."), *textureRef->GetName());
     }
     else
-        return false;
+    {
+        ++scene.metrics.numTextures;
+    }
+    scene.exportedTextures.Add(textureRef, outTexturePath);
+    return !outTexturePath.IsEmpty();
 }
 
 aiString FAssimpNode::FStringToaiString(FString str)
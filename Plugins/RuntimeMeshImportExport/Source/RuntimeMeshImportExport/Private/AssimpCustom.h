@@ -9,7 +9,14 @@
 #include "assimp/mesh.h"
 #include "RuntimeMeshImportExportTypes.h"
 #include "Tickable.h"
+#include "Misc/MemStack.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Async/Future.h"
 #include "Interface/MeshExportable.h"
+#include "RuntimeMeshTextureBuilder.h"
+#include "RuntimeMeshImportExportStats.h"
+#include "RuntimeMeshExportLog.h"
 
 struct FAssimpScene;
 struct FAssimpMesh;
@@ -22,6 +29,8 @@ struct FRuntimeMeshExportParam;
  *  The destructors of the types makes sure that the pointers in the parent
  *  classes are removed before the parent destructor is called to prevent 
  *  heap corruption.
+ *  The meshes, materials, faces and bitangents are allocated from the export arena
+ *  of the scene and are released all at once in FAssimpScene::ClearMeshData.
  */
 
 struct FAssimpMesh : public aiMesh
@@ -32,9 +41,11 @@ public:
     TArray<aiVector3D> vertices;
     TArray<aiVector3D> normals;
     TArray<aiVector3D> tangents;
-    TArray<aiVector3D> bitangents;
+    // Arena memory of the scene, empty when the format does not need them
+    TArrayView<aiVector3D> bitangents;
     TArray<aiVector3D> textureCoordinates[AI_MAX_NUMBER_OF_TEXTURECOORDS];
 	uint32 numUVComponents[AI_MAX_NUMBER_OF_TEXTURECOORDS];
+    // Empty when the exported mesh has no colors
     TArray<aiColor4D> vertexColors;
 
 	// Note:: We had a FAssimpFace before that had an array
@@ -44,7 +55,10 @@ public:
 	// larger. We can't do that, so work with aiFaces directly.
 	// (If the parent would need a ptr to an array of aiFace*, it
 	// would be no problem)
-    TArray<aiFace> faces;
+	// The faces do not own their indices, they point into 'faceIndices'.
+	// Both are arena memory of the scene, ~aiFace is never called on them.
+    TArrayView<aiFace> faces;
+    TArrayView<uint32> faceIndices;
 
 private:
     friend FAssimpScene;
@@ -54,7 +68,7 @@ private:
 struct FAssimpNode : public aiNode
 {
 public:
-	FAssimpNode(const FName& inName, FAssimpNode* inParent) :  parent(inParent), name(inName)
+	FAssimpNode(const FName& inName, FAssimpNode* inParent) :  parent(inParent), exportParent(inParent), name(inName)
 	{}
     ~FAssimpNode();
 
@@ -62,30 +76,168 @@ public:
     TArray<uint32> meshRefIndices;
 
     const FAssimpNode* parent = nullptr;
+    // The parent in the exported file, 'parent' unless FRuntimeMeshExportParam::hierarchy removed it. Null for the root and the removed nodes.
+    const FAssimpNode* exportParent = nullptr;
     const FName name;
     FTransform worldTransform;
     TArray<TScriptInterface<IMeshExportable>> exportObjects;
 
     FString GetHierarchicalName() const;
-	FAssimpNode* FindOrCreateNode(TArray<FString>& nodePathRelative);
+    // The world transform of the root node with FRuntimeMeshExportParam::correction applied
+    FTransform GetCorrectedRootTransform(const FRuntimeMeshExportParam& param) const;
+	FAssimpNode* FindOrCreateNode(const TArray<FString>& nodePathRelative);
 
 private:
     friend struct FAssimpScene;
 
+	// The same nodes as 'children', for the lookup by name
+	TMap<FName, FAssimpNode*> childrenByName;
+
 	// Helper index for async export
 	int32 indexGatherNext = 0;
+	// The sections of each of 'exportObjects', empty when it was skipped or gathered as views
 	TArray<TArray<FExportableMeshSection>> gatheredExportables;
+	// The sections of the exportables with IMeshExportable::HasMeshDataViews, they point into the buffers of the exportable
+	TArray<TArray<FExportableMeshSectionView>> gatheredViews;
+	// The sections of FAssimpScene::additionalLods of an exportable, gathered like its first LOD
+	struct FGatheredLod
+	{
+		TArray<FExportableMeshSection> sections;
+		TArray<FExportableMeshSectionView> views;
+	};
+	// Per exportable, empty when there are no additional LODs
+	TArray<TArray<FGatheredLod>> gatheredLods;
+
+	void ResetGather();
 	/**
-	 *	Gathers the data from the exportables. This function must be run on the game thread.
+	 *	Gathers the data from the exportables that are not thread safe. This function must be run on the game thread.
+	 *	With a 'deadline' in FPlatformTime::Seconds the gathering stops before an exportable whose estimated cost
+	 *	does not fit anymore, unless 'bGatherAtLeastOne' and nothing was gathered yet.
 	 *	Returns the number of exportables gathered.
 	 */ 
-	int32 GatherMeshData(FAssimpScene& scene, const FRuntimeMeshExportParam& param, const bool bGatherAll, const int32 numToGather = 0);
+	int32 GatherMeshData(FAssimpScene& scene, const FRuntimeMeshExportParam& param, const bool bGatherAll, const int32 numToGather = 0
+		, const double deadline = 0.0, const bool bGatherAtLeastOne = true);
+	bool IsGatherDone() const
+	{
+		return indexGatherNext >= exportObjects.Num();
+	}
+	// Gathers and validates one exportable into its slot. Returns false when it is skipped.
+	bool GatherExportable(FAssimpScene& scene, const FRuntimeMeshExportParam& param, const int32 objectIndex);
+	// Validates the sections an exportable returned, they are emptied when one is invalid
+	template<typename SectionType>
+	bool ValidateGatheredSections(FAssimpScene& scene, TScriptInterface<IMeshExportable>& exportable, const bool bGathered, TArray<SectionType>& sections);
+	// Transforms the streams of 'view' by 'meshToSpace' into 'outSection', the only copy of a view. 'bParallel' chunks a large view.
+	static void CopyTransformedView(const FExportableMeshSectionView& view, const FMatrix& meshToSpace, const bool bParallel, FExportableMeshSection& outSection);
+
+	// The transformed sections after GroupGatheredSections, one aiMesh each
+	TArray<FExportableMeshSection> groupedSections;
+
+	// An exportable of this node with a shared mesh key, @see FRuntimeMeshExportParam::bShareIdenticalMeshes, or an instance of an instanced exportable
+	struct FSharedMeshInstance
+	{
+		uint64 key = 0;
+		FTransform meshToWorld;
+		int32 objectIndex = INDEX_NONE;
+		// The index in IMeshExportable::GetInstanceTransforms, INDEX_NONE for an exportable with a shared mesh key
+		int32 instanceIndex = INDEX_NONE;
+		// The first exportable of the key in the export, whose meshes the others reference
+		bool bGathered = false;
+	};
+	// Set by FAssimpScene::StartGather, empty when nothing is shared
+	TArray<FSharedMeshInstance> sharedInstances;
+	// The index in 'sharedInstances' of the first instance of each of 'exportObjects', INDEX_NONE for the exportables with their own meshes
+	TArray<int32> objectSharedInstances;
+	// The transforms of IMeshExportable::GetInstanceTransforms of each of 'exportObjects', read by FAssimpScene::StartGather
+	TArray<TArray<FTransform>> objectInstanceTransforms;
+	// The grouped sections of the gathered shared exportables by their key, in the space of their instance. One aiMesh each.
+	TArray<TPair<uint64, TArray<FExportableMeshSection>>> sharedGroupedSections;
+	// A node per shared instance of this export, they only reference the shared meshes
+	TArray<FAssimpNode*> instanceNodes;
+	// The children in the exported file, set by FAssimpScene::BuildExportHierarchy
+	TArray<FAssimpNode*> hierarchyChildren;
+	// Whether the node is written, false for the nodes FRuntimeMeshExportParam::hierarchy removed
+	bool bInExportHierarchy = true;
+	// 'hierarchyChildren' followed by 'instanceNodes', what the aiNode points to
+	TArray<FAssimpNode*> exportChildren;
+	bool IsSharedInstanceOnly(const int32 objectIndex) const
+	{
+		return objectSharedInstances.Num() > 0 && objectSharedInstances[objectIndex] != INDEX_NONE && !sharedInstances[objectSharedInstances[objectIndex]].bGathered;
+	}
+	// Creates 'instanceNodes' with the meshes the scene registered for their key. After all meshes are registered.
+	void CreateInstanceNodes(FAssimpScene& scene);
 
-	void ProcessGatheredData_Recursive(FAssimpScene& scene, const FRuntimeMeshExportParam& param);
-	void ProcessGatheredData_Internal(FAssimpScene& scene, const FRuntimeMeshExportParam& param);
+	// The vertex data of an aiMesh of this node, kept between exports. @see IMeshExportable::GetMeshDataVersion
+	struct FCachedMesh
+	{
+		TWeakObjectPtr<UMaterialInterface> material;
+		TArray<aiVector3D> vertices;
+		TArray<aiVector3D> normals;
+		TArray<aiVector3D> tangents;
+		TArray<aiVector3D> textureCoordinates;
+		TArray<aiColor4D> vertexColors;
+		TArray<int32> triangles;
+	};
+	// What the cached meshes were built from, they are reused while it matches
+	struct FMeshCacheKey
+	{
+		TArray<TPair<const UObject*, int64>> versions;
+		FTransform worldTransform;
+		uint32 paramHash = 0;
 
-    void CreateAssimpMeshesFromMeshData(FAssimpScene& scene, const FRuntimeMeshExportParam& param);
-    bool ValidateMeshSection(FAssimpScene& scene, TScriptInterface<IMeshExportable>& exportable, FExportableMeshSection& section);
+		bool Matches(const FMeshCacheKey& other) const
+		{
+			return paramHash == other.paramHash && versions == other.versions && worldTransform.Equals(other.worldTransform, 0.f);
+		}
+	};
+	TArray<FCachedMesh> cachedMeshes;
+	FMeshCacheKey cachedKey;
+	bool bMeshCacheValid = false;
+	// Set by PrepareMeshCache for the current export
+	FMeshCacheKey pendingKey;
+	bool bReusesMeshCache = false;
+	bool bStoresMeshCache = false;
+
+	/**
+	 *	Decides if this export reuses the cached meshes of the node. Only nodes whose exportables all report a version are cached.
+	 *	Returns true when the node reuses them, its exportables are not gathered then. Must be run on the game thread.
+	 */
+	bool PrepareMeshCache(const FRuntimeMeshExportParam& param, const bool bUseMeshCache);
+	// Moves the vertex data of the meshes of this export into the cache, must be called before the meshes of the scene are cleared
+	void StoreMeshCache(FAssimpScene& scene, const bool bMeshDataComplete);
+	void InvalidateMeshCache();
+
+	// A registered aiMesh that still needs its vertex data from 'section' or 'cachedMesh'
+	struct FPendingAssimpMesh
+	{
+		FAssimpMesh* mesh;
+		FExportableMeshSection* section;
+		FCachedMesh* cachedMesh;
+	};
+
+	/**
+	 *	Builds the aiMeshes of all nodes. Transforming and grouping the sections and filling the meshes run in parallel,
+	 *	only registering the meshes and materials in the scene runs serially in the order of the hierarchy.
+	 */
+	void ProcessGatheredData_Recursive(FAssimpScene& scene, const FRuntimeMeshExportParam& param);
+	void ProcessGatheredData_Internal(FAssimpScene& scene, const FRuntimeMeshExportParam& param, TArray<FPendingAssimpMesh>& outPendingMeshes);
+
+	// Transforms the gathered sections into node space and groups them by material into 'groupedSections'. Only touches this node.
+	void GroupGatheredSections(const FRuntimeMeshExportParam& param);
+	// Appends all of 'sections', which have the same material, to the first one with one allocation per stream
+	static void CombineSections(TArray<FExportableMeshSection>& sections);
+	// Moves and converts the vertex data of 'section' into 'mesh', its arena arrays must be allocated already
+	// @param bSRGBColors	Decodes the colors, @see FRuntimeMeshExportParam::vertexColorSpace
+	static void FillAssimpMesh(FAssimpMesh& mesh, FExportableMeshSection& section, const bool bSRGBColors);
+	// Moves the vertex data of 'cachedMesh' into 'mesh', it goes back with StoreMeshCache
+	static void FillAssimpMeshFromCache(FAssimpMesh& mesh, FCachedMesh& cachedMesh);
+    void CreateAssimpMeshesFromMeshData(FAssimpScene& scene, const FRuntimeMeshExportParam& param, TArray<FPendingAssimpMesh>& outPendingMeshes);
+	// Adds an aiMesh to the scene, its index to 'outMeshIndices', and allocates its arena arrays
+	FAssimpMesh* RegisterAssimpMesh(FAssimpScene& scene, const FRuntimeMeshExportParam& param, UMaterialInterface* material, const int32 numVertices, const int32 numIndices
+		, TArray<uint32>& outMeshIndices);
+	// Returns the index of the aiMaterial of 'sectionMaterial', it is created when this export has none yet
+	uint32 FindOrAddMaterial(FAssimpScene& scene, const FRuntimeMeshExportParam& param, UMaterialInterface* sectionMaterial);
+    template<typename SectionType>
+    bool ValidateMeshSection(FAssimpScene& scene, TScriptInterface<IMeshExportable>& exportable, const SectionType& section);
 
     void SetDataAndPtrsToParentClass(const FRuntimeMeshExportParam& param);
 	void ClearParentDataAndPtrs();
@@ -94,7 +246,12 @@ private:
 
 	void GetNodesRecursive(TArray<FAssimpNode*>& outNodes);
 
-	bool ExportTexture(UTexture* textureRef, FString& outTexturePath);
+	/**
+	 *	Queues the texture for the texture export stage of the scene and returns the path the material references,
+	 *	relative to the export file or "*<index>" when embedded. Only its pixels are read here.
+	 *	Skipped when it was already exported in this export, or written by an earlier one and is unchanged.
+	 */
+	bool ExportTexture(FAssimpScene& scene, const FRuntimeMeshExportParam& param, UTexture* textureRef, FString& outTexturePath);
 	aiString FStringToaiString(FString str);
 };
 
@@ -107,23 +264,77 @@ public:
     FAssimpNode* rootNode = nullptr;
     TArray<FAssimpMesh*> meshes;
     TArray<aiMaterial*> materials;
-	// Helper array to find unique materials
-	TArray<UMaterialInterface*> uniqueMaterials;
+	// Index in 'materials' of each exported material
+	TMap<UMaterialInterface*, int32> uniqueMaterials;
+	// The path each texture is referenced with in this export, empty when it failed
+	TMap<UTexture*, FString> exportedTextures;
 
-	bool bLogToUnreal = false;
 	int32 numObjectsSkipped = 0;
 
-	// Writes to 'exportLog' if available and adds a new line at the end.
-	void WriteToLogWithNewLine(const FString& logText);
-	FString* exportLog = nullptr;
+	// Returns the node of 'hierarchicalName' in the format Outer1.Outer2.MyNode and creates the missing ones, the root node when it is empty
+	FAssimpNode* FindOrCreateNode(const FString& hierarchicalName);
+
+	/**
+	 *	Allocates an uninitialized array from the export arena. The memory lives until ClearMeshData.
+	 *	No destructors are called for the elements, only use it for data that does not own memory.
+	 */
+	template<typename T>
+	TArrayView<T> AllocateExportArray(const int32 num)
+	{
+		if (num <= 0)
+		{
+			return TArrayView<T>();
+		}
+		return TArrayView<T>(reinterpret_cast<T*>(exportArena.PushBytes(num * sizeof(T), alignof(T))), num);
+	}
+
+	// Adds a line to 'log' when 'severity' is kept, it is only formatted then. Thread safe.
+	template <typename FmtType, typename... Types>
+	void WriteToLog(const ERuntimeMeshExportLogSeverity severity, const FmtType& fmt, Types... args)
+	{
+		if (log.IsLogged(severity))
+		{
+			log.Add(severity, FString::Printf(fmt, args...));
+		}
+	}
+	void WriteTextToLog(const ERuntimeMeshExportLogSeverity severity, const FString& logText);
+	bool IsLogged(const ERuntimeMeshExportLogSeverity severity) const
+	{
+		return log.IsLogged(severity);
+	}
+	// Reset by the exporter before each export, joined into FRuntimeMeshExportResult::exportLog after it
+	FRuntimeMeshExportLog log;
+
+	// Passes 'file' to FRuntimeMeshExportParam::exportedFileSink or adds it to 'exportedFiles'. Thread safe.
+	void AddExportedFile(const FRuntimeMeshExportParam& param, FRuntimeMeshExportedFile&& file);
+	TArray<FRuntimeMeshExportedFile>* exportedFiles = nullptr;
+	// Filled by the stages of the export, reset by the exporter before each export
+	FRuntimeMeshExportStageTimings stageTimings;
+	// The counts, the bytes and the thread seconds are added up in the counters below by the worker threads
+	FRuntimeMeshExportMetrics metrics;
+	FThreadSafeCounter64 metricsBytesWritten;
+	FThreadSafeCounter64 metricsThreadCycles;
 	
 	void PrepareSceneForExport(const FRuntimeMeshExportParam& param);
+	/**
+	 *	Writes the exportables one after the other with FRuntimeMeshStreamWriter, without building the Assimp data.
+	 *	Each exportable is freed after it is written.
+	 *	@param bAlreadyGathered		False: gathers each exportable right before writing it, must be called on the GameThread.
+	 *								True: uses the data of PrepareSceneForExport_Async_Start, can be called on any thread.
+	 *	@see FRuntimeMeshExportParam::bStreamingExport, FRuntimeMeshExportParam::bNativeGltfExport
+	 */
+	bool ExportWithStreamWriter(const FRuntimeMeshExportParam& param, const bool bAlreadyGathered, FString& outError);
+	static bool UsesStreamWriter(const FRuntimeMeshExportParam& param, const bool bAsync);
+	// <file>_LOD<lod>.<ext>, written by the stream writers that can not put the LODs into one file
+	static FString GetLodFile(const FString& file, const int32 lod);
 	// Must be called on GameThread to gather mesh data.
 	void PrepareSceneForExport_Async_Start(const FRuntimeMeshExportAsyncParam& param, FRuntimeMeshImportExportProgressUpdate callbackProgress
 		, TFunction<void()> onPrepareFinished);
 
 	// Call on NONE GameThread to finish processing the data
 	void PrepareSceneForExport_Async_Finish(const FRuntimeMeshExportParam& param);
+	// Waits until the texture files are written. Call it after the export of the geometry.
+	void FinishTextureExport();
 	void ClearSceneExportData();
 
 private:
@@ -136,15 +347,94 @@ private:
 	void ClearMeshData();
 
 	TArray<FAssimpNode*> allNodesHelper;
+	// The nodes by the hierarchical names they were added with. Nodes are never removed, so the entries stay valid.
+	TMap<FString, FAssimpNode*> nodesByName;
+
+	// A texture that is encoded and written, or embedded, by the texture export stage
+	struct FTextureExportJob
+	{
+		UTexture* texture = nullptr;
+		// Empty when embedded
+		FString file;
+		FRuntimeMeshTextureMips pixels;
+		TArray<uint8> fileBytes;
+	};
+	TArray<FTextureExportJob> textureExportJobs;
+	// The file names used by the textures of this export, to keep them unique
+	TSet<FString> textureFileNames;
+	// Arena memory, their data points into 'textureExportJobs'
+	TArray<aiTexture*> embeddedTextures;
+	TFuture<void> textureExportTask;
+	/**
+	 *	Encodes the queued textures in parallel. Embedded ones are encoded before returning.
+	 *	Files are written in the background while Assimp exports the geometry, @see FinishTextureExport.
+	 */
+	void StartTextureExport(const FRuntimeMeshExportParam& param);
+
+	// @see IMeshExportable::IsThreadSafeGather
+	static bool IsThreadSafeGather(const TScriptInterface<IMeshExportable>& object);
+	// @see IMeshExportable::HasMeshDataViews
+	static bool HasMeshDataViews(const TScriptInterface<IMeshExportable>& object);
+	// @see IMeshExportable::GetMeshDataVersion
+	static int64 GetMeshDataVersion(const TScriptInterface<IMeshExportable>& object);
+	// @see IMeshExportable::GetSharedMeshKey
+	static uint64 GetSharedMeshKey(const TScriptInterface<IMeshExportable>& object, const int32 lod, FTransform& outMeshToWorld);
+	// @see IMeshExportable::GetInstanceTransforms
+	static bool GetInstanceTransforms(const TScriptInterface<IMeshExportable>& object, const int32 lod, TArray<FTransform>& outInstanceToWorld);
+	/**
+	 *	Collects the nodes and the thread safe exportables and resets the gathered data.
+	 *	With 'bAssimpScene' the gathered data builds the Assimp scene: the unchanged nodes reuse the meshes of the last export and are not gathered,
+	 *	and the exportables share their meshes when 'param' asks for it.
+	 */
+	void StartGather(const FRuntimeMeshExportParam& param, const bool bAssimpScene);
+	// Sets the export parents and children of 'allNodesHelper' for FRuntimeMeshExportParam::hierarchy, after StartGather
+	void BuildExportHierarchy(const FRuntimeMeshExportParam& param);
+	// Finds the shared and the instanced exportables of 'node', only the first of each key is gathered. Returns true when the node has any.
+	bool PrepareSharedMeshes(const FRuntimeMeshExportParam& param, FAssimpNode& node, TSet<uint64>& gatheredKeys);
+	// The meshes of each shared mesh key of this export, @see FRuntimeMeshExportParam::bShareIdenticalMeshes
+	TMap<uint64, TArray<uint32>> sharedMeshIndices;
+	// The LODs of FRuntimeMeshExportParam::additionalLods that are gathered with 'lod', only for the stream writers
+	TArray<int32> additionalLods;
+	// Set when the aiMeshes of this export are complete, so the nodes can cache them in ClearSceneExportData
+	bool bMeshDataComplete = false;
+	// Gathers 'threadSafeGathers' in parallel, can run on any thread
+	void GatherThreadSafe(const FRuntimeMeshExportParam& param);
+	// Gathers everything that needs the GameThread at once and takes the views of the thread safe exportables, @see FRuntimeMeshExportAsyncParam::bSnapshotGather
+	void GatherSnapshot(const FRuntimeMeshExportParam& param);
+
+	// The exportables that are gathered in parallel, by node and index in FAssimpNode::exportObjects
+	TArray<TPair<FAssimpNode*, int32>> threadSafeGathers;
+	int32 numThreadSafeSkipped = 0;
+	FCriticalSection exportedFilesCriticalSection;
+
+	// Average GameThread gather duration in seconds per exportable class, kept across exports of this scene
+	TMap<const UClass*, double> gatherCostEstimates;
+	double EstimateGatherCost(const TScriptInterface<IMeshExportable>& object) const;
+	void UpdateGatherCostEstimate(const TScriptInterface<IMeshExportable>& object, const double duration);
+
+	friend struct FAssimpNode;
+	/**
+	 *	Linear allocator for all export data that lives as long as the scene data.
+	 *	Not thread safe, the export data is processed on one thread at a time.
+	 */
+	FMemStackBase exportArena{ 0 };
+	// What this scene added to STAT_RMIE_ExportSceneMemory
+	int64 statSceneMemory = 0;
 
 	// Called from ticker
 	void PrepareSceneForExport_Update(const FRuntimeMeshExportParam& param);
+	// Called when the ticker and the parallel gather are done, the last one finishes the preparation on the GameThread
+	void FinishGather();
 
 #pragma region Async
 	int32 currentNodeIndex = 0;
 	int32 numGatherPerTick = -1;
+	// 0 when 'numGatherPerTick' is used
+	double gatherBudgetSeconds = 0.0;
+	bool bUseGatherCostEstimates = false;
 	int32 gatheredMeshNum = 0;
 	double startTimeGatherMeshData = 0.f;
+	FThreadSafeCounter numPendingGathers;
 	FRuntimeMeshImportExportProgressUpdate delegateProgress;
 	TFunction<void()> onGameThreadPrepareFinished;
 
@@ -173,7 +463,7 @@ private:
 
 		virtual TStatId GetStatId() const override
 		{
-			return TStatId(); // Creation of a valid stat id is confusing, just pass an empty for now.
+			RETURN_QUICK_DECLARE_CYCLE_STAT(FGatherMeshDataTicker, STATGROUP_RuntimeMeshImportExport);
 		}
 
 		virtual void Tick(float DeltaTime) override
@@ -0,0 +1,457 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "AssimpIOSystem.h"
+#include "RuntimeMeshImportExport.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformFile.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Async/Async.h"
+#include "RuntimeMeshImportExportStats.h"
+
+void FAssimpIOSystem::AddMemoryFile(const FString& name, TArrayView<const uint8> data)
+{
+    FString path = name;
+    FPaths::NormalizeFilename(path);
+    memoryFiles.Add(path, data);
+}
+
+bool FAssimpIOSystem::Exists(const char* file) const
+{
+    const FString path = ResolvePath(file);
+    return FindMemoryFile(path) || FPlatformFileManager::Get().GetPlatformFile().FileExists(*path);
+}
+
+char FAssimpIOSystem::getOsSeparator() const
+{
+    // Paths are normalized to forward slashes
+    return '/';
+}
+
+Assimp::IOStream* FAssimpIOSystem::Open(const char* file, const char* mode)
+{
+    if (FCStringAnsi::Strchr(mode, 'w') || FCStringAnsi::Strchr(mode, 'a'))
+    {
+        RMIE_LOG(Error, "Only reading is supported. File: %s", ANSI_TO_TCHAR(file));
+        return nullptr;
+    }
+
+    const FString path = ResolvePath(file);
+    if (const TArrayView<const uint8>* memoryFile = FindMemoryFile(path))
+    {
+        return CountOpened(new FAssimpMemoryIOStream(*memoryFile));
+    }
+
+    if (bMemoryMapFiles)
+    {
+        if (Assimp::IOStream* mappedStream = OpenMapped(path))
+        {
+            return CountOpened(mappedStream);
+        }
+    }
+
+    IFileHandle* handle = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*path);
+    if (!handle)
+    {
+        return nullptr;
+    }
+    return CountOpened(new FAssimpPlatformFileIOStream(handle));
+}
+
+void FAssimpIOSystem::Close(Assimp::IOStream* stream)
+{
+    delete stream;
+}
+
+Assimp::IOStream* FAssimpIOSystem::OpenView(const char* file, TArray<uint8>& outBuffer, TArrayView<const uint8>& outView)
+{
+    const FString path = ResolvePath(file);
+    if (const TArrayView<const uint8>* memoryFile = FindMemoryFile(path))
+    {
+        outView = *memoryFile;
+        return CountOpened(new FAssimpMemoryIOStream(*memoryFile));
+    }
+
+    if (bMemoryMapFiles)
+    {
+        if (FAssimpMappedFileIOStream* mappedStream = OpenMapped(path))
+        {
+            // A TArrayView can not address larger files
+            if (mappedStream->FileSize() <= MAX_int32)
+            {
+                outView = TArrayView<const uint8>(mappedStream->GetData(), mappedStream->FileSize());
+                return CountOpened(mappedStream);
+            }
+            delete mappedStream;
+        }
+    }
+
+    if (!FFileHelper::LoadFileToArray(outBuffer, *path, FILEREAD_Silent))
+    {
+        return nullptr;
+    }
+    outView = outBuffer;
+    return CountOpened(new FAssimpMemoryIOStream(outBuffer));
+}
+
+Assimp::IOStream* FAssimpIOSystem::CountOpened(Assimp::IOStream* stream)
+{
+    bytesOpened.Add(int64(stream->FileSize()));
+    return stream;
+}
+
+FAssimpMappedFileIOStream* FAssimpIOSystem::OpenMapped(const FString& path)
+{
+    IMappedFileHandle* handle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*path);
+    if (!handle)
+    {
+        RMIE_LOG(Log, "Memory mapping not supported, reading the file. File: %s", *path);
+        return nullptr;
+    }
+
+    if (handle->GetFileSize() <= 0)
+    {
+        delete handle;
+        return nullptr;
+    }
+
+    IMappedFileRegion* region = handle->MapRegion(0, handle->GetFileSize());
+    if (!region)
+    {
+        RMIE_LOG(Log, "Failed to map the file, reading it. File: %s", *path);
+        delete handle;
+        return nullptr;
+    }
+    return new FAssimpMappedFileIOStream(handle, region);
+}
+
+FString FAssimpIOSystem::ResolvePath(const char* file) const
+{
+    FString path = UTF8_TO_TCHAR(file);
+    FPaths::NormalizeFilename(path);
+    if (FPaths::IsRelative(path) && !baseDirectory.IsEmpty())
+    {
+        path = FPaths::Combine(baseDirectory, path);
+    }
+    FPaths::CollapseRelativeDirectories(path);
+    return path;
+}
+
+const TArrayView<const uint8>* FAssimpIOSystem::FindMemoryFile(const FString& path) const
+{
+    if (const TArrayView<const uint8>* found = memoryFiles.Find(path))
+    {
+        return found;
+    }
+    // Sibling files are often referenced with a different directory than the one they were added with
+    const FString fileName = FPaths::GetCleanFilename(path);
+    for (const TPair<FString, TArrayView<const uint8>>& memoryFile : memoryFiles)
+    {
+        if (FPaths::GetCleanFilename(memoryFile.Key).Equals(fileName, ESearchCase::IgnoreCase))
+        {
+            return &memoryFile.Value;
+        }
+    }
+    return nullptr;
+}
+
+size_t FAssimpMemoryIOStream::Read(void* buffer, size_t elementSize, size_t count)
+{
+    if (elementSize == 0 || count == 0)
+    {
+        return 0;
+    }
+    const size_t remaining = size - position;
+    const size_t numElements = FMath::Min(count, remaining / elementSize);
+    FMemory::Memcpy(buffer, data + position, numElements * elementSize);
+    position += numElements * elementSize;
+    return numElements;
+}
+
+size_t FAssimpMemoryIOStream::Write(const void* buffer, size_t elementSize, size_t count)
+{
+    return 0;
+}
+
+aiReturn FAssimpMemoryIOStream::Seek(size_t offset, aiOrigin origin)
+{
+    size_t newPosition = 0;
+    switch (origin)
+    {
+    case aiOrigin_SET:
+        newPosition = offset;
+        break;
+    case aiOrigin_CUR:
+        newPosition = position + offset;
+        break;
+    case aiOrigin_END:
+        // Assimp passes the offset as unsigned, it is only valid to seek to the end itself
+        newPosition = size - offset;
+        break;
+    default:
+        return aiReturn_FAILURE;
+    }
+
+    if (newPosition > size)
+    {
+        return aiReturn_FAILURE;
+    }
+    position = newPosition;
+    return aiReturn_SUCCESS;
+}
+
+size_t FAssimpMemoryIOStream::Tell() const
+{
+    return position;
+}
+
+size_t FAssimpMemoryIOStream::FileSize() const
+{
+    return size;
+}
+
+FAssimpMappedFileIOStream::FAssimpMappedFileIOStream(IMappedFileHandle* inHandle, IMappedFileRegion* inRegion)
+    : FAssimpMemoryIOStream(inRegion->GetMappedPtr(), inRegion->GetMappedSize())
+    , handle(inHandle)
+    , region(inRegion)
+{
+}
+
+FAssimpMappedFileIOStream::~FAssimpMappedFileIOStream()
+{
+    // The region must be released before its handle
+    delete region;
+    delete handle;
+}
+
+FAssimpPlatformFileIOStream::~FAssimpPlatformFileIOStream()
+{
+    delete handle;
+}
+
+size_t FAssimpPlatformFileIOStream::Read(void* buffer, size_t size, size_t count)
+{
+    if (size == 0 || count == 0)
+    {
+        return 0;
+    }
+    const int64 remaining = handle->Size() - handle->Tell();
+    const size_t numElements = FMath::Min<size_t>(count, FMath::Max<int64>(remaining, 0) / size);
+    if (numElements == 0 || !handle->Read(static_cast<uint8*>(buffer), numElements * size))
+    {
+        return 0;
+    }
+    return numElements;
+}
+
+size_t FAssimpPlatformFileIOStream::Write(const void* buffer, size_t size, size_t count)
+{
+    return 0;
+}
+
+aiReturn FAssimpPlatformFileIOStream::Seek(size_t offset, aiOrigin origin)
+{
+    bool bSuccess = false;
+    switch (origin)
+    {
+    case aiOrigin_SET:
+        bSuccess = handle->Seek(offset);
+        break;
+    case aiOrigin_CUR:
+        bSuccess = handle->Seek(handle->Tell() + offset);
+        break;
+    case aiOrigin_END:
+        bSuccess = handle->SeekFromEnd(-int64(offset));
+        break;
+    default:
+        break;
+    }
+    return bSuccess ? aiReturn_SUCCESS : aiReturn_FAILURE;
+}
+
+size_t FAssimpPlatformFileIOStream::Tell() const
+{
+    return handle->Tell();
+}
+
+size_t FAssimpPlatformFileIOStream::FileSize() const
+{
+    return handle->Size();
+}
+
+bool FAssimpExportIOSystem::Exists(const char* file) const
+{
+    return FPlatformFileManager::Get().GetPlatformFile().FileExists(UTF8_TO_TCHAR(file));
+}
+
+char FAssimpExportIOSystem::getOsSeparator() const
+{
+    return '/';
+}
+
+Assimp::IOStream* FAssimpExportIOSystem::Open(const char* file, const char* mode)
+{
+    FString path = UTF8_TO_TCHAR(file);
+    FPaths::NormalizeFilename(path);
+    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+    if (!FCStringAnsi::Strchr(mode, 'w') && !FCStringAnsi::Strchr(mode, 'a'))
+    {
+        IFileHandle* handle = platformFile.OpenRead(*path);
+        return handle ? new FAssimpPlatformFileIOStream(handle) : nullptr;
+    }
+
+    IFileHandle* handle = platformFile.OpenWrite(*path, FCStringAnsi::Strchr(mode, 'a') != nullptr);
+    if (!handle)
+    {
+        AddWriteError(FString::Printf(TEXT("Failed to open file for writing: %s"), *path));
+        return nullptr;
+    }
+    return new FAssimpBufferedWriteIOStream(*this, handle, path, bufferSize);
+}
+
+void FAssimpExportIOSystem::Close(Assimp::IOStream* stream)
+{
+    delete stream;
+}
+
+FString FAssimpExportIOSystem::GetWriteError() const
+{
+    FScopeLock lock(&writeErrorCriticalSection);
+    return writeError;
+}
+
+void FAssimpExportIOSystem::AddWriteError(const FString& error)
+{
+    RMIE_LOG(Error, "%s", *error);
+    FScopeLock lock(&writeErrorCriticalSection);
+    if (!writeError.IsEmpty())
+    {
+        writeError += TEXT("\n");
+    }
+    writeError += error;
+}
+
+FAssimpBufferedWriteIOStream::FAssimpBufferedWriteIOStream(FAssimpExportIOSystem& inIOSystem, IFileHandle* inHandle, const FString& inPath, const int32 inBufferSize)
+    : ioSystem(inIOSystem)
+    , handle(inHandle)
+    , path(inPath)
+    , bufferSize(inBufferSize)
+{
+    bufferOffset = handle->Tell();
+    fileSize = handle->Size();
+    buffer.Reserve(bufferSize);
+}
+
+FAssimpBufferedWriteIOStream::~FAssimpBufferedWriteIOStream()
+{
+    SubmitBuffer();
+    WaitForWrite();
+    delete handle;
+}
+
+size_t FAssimpBufferedWriteIOStream::Read(void* inBuffer, size_t size, size_t count)
+{
+    return 0;
+}
+
+size_t FAssimpBufferedWriteIOStream::Write(const void* inBuffer, size_t size, size_t count)
+{
+    const size_t numBytes = size * count;
+    if (numBytes == 0)
+    {
+        return 0;
+    }
+    buffer.Append(static_cast<const uint8*>(inBuffer), int32(numBytes));
+    if (buffer.Num() >= bufferSize)
+    {
+        SubmitBuffer();
+    }
+    return count;
+}
+
+aiReturn FAssimpBufferedWriteIOStream::Seek(size_t offset, aiOrigin origin)
+{
+    int64 newPosition = 0;
+    switch (origin)
+    {
+    case aiOrigin_SET:
+        newPosition = int64(offset);
+        break;
+    case aiOrigin_CUR:
+        newPosition = int64(Tell() + offset);
+        break;
+    case aiOrigin_END:
+        newPosition = int64(FileSize() - offset);
+        break;
+    default:
+        return aiReturn_FAILURE;
+    }
+
+    SubmitBuffer();
+    WaitForWrite();
+    if (newPosition < 0 || !handle->Seek(newPosition))
+    {
+        return aiReturn_FAILURE;
+    }
+    bufferOffset = newPosition;
+    return aiReturn_SUCCESS;
+}
+
+size_t FAssimpBufferedWriteIOStream::Tell() const
+{
+    return size_t(bufferOffset + buffer.Num());
+}
+
+size_t FAssimpBufferedWriteIOStream::FileSize() const
+{
+    return size_t(FMath::Max<int64>(fileSize, bufferOffset + buffer.Num()));
+}
+
+void FAssimpBufferedWriteIOStream::Flush()
+{
+    SubmitBuffer();
+    WaitForWrite();
+    handle->Flush();
+}
+
+void FAssimpBufferedWriteIOStream::SubmitBuffer()
+{
+    if (buffer.Num() == 0)
+    {
+        return;
+    }
+
+    WaitForWrite();
+    // The buffers swap their allocations, so neither is reallocated per write
+    Swap(buffer, writingBuffer);
+    buffer.Reset();
+    bufferOffset += writingBuffer.Num();
+    INC_DWORD_STAT_BY(STAT_RMIE_ExportedFileBytes, writingBuffer.Num());
+    ioSystem.AddBytesWritten(writingBuffer.Num());
+    fileSize = FMath::Max(fileSize, bufferOffset);
+
+    IFileHandle* writeHandle = handle;
+    const TArray<uint8>* data = &writingBuffer;
+    pendingWrite = Async(EAsyncExecution::ThreadPool, [writeHandle, data]() {
+        return writeHandle->Write(data->GetData(), data->Num());
+    });
+}
+
+void FAssimpBufferedWriteIOStream::WaitForWrite()
+{
+    if (!pendingWrite.IsValid())
+    {
+        return;
+    }
+    const bool bWritten = pendingWrite.Get();
+    pendingWrite = TFuture<bool>();
+    if (!bWritten)
+    {
+        ioSystem.AddWriteError(FString::Printf(TEXT("Failed to write file: %s"), *path));
+    }
+}
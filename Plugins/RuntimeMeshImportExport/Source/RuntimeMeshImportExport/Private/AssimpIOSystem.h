@@ -0,0 +1,197 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "assimp/IOSystem.hpp"
+#include "assimp/IOStream.hpp"
+#include "Async/Future.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+class FAssimpMappedFileIOStream;
+
+/**
+ *	Lets Assimp read from memory buffers and through IPlatformFile instead of the C runtime,
+ *	so files inside of paks can be imported and multi file formats (obj + mtl, gltf + bin)
+ *	can resolve their sibling files without temporary files on disk.
+ *
+ *	A file is first looked up in the memory files by its path and then by its file name.
+ *	Everything else goes to IPlatformFile, relative paths are resolved against 'baseDirectory'.
+ *	The memory files are not copied, they must outlive the IOSystem.
+ *	With 'bMemoryMapFiles' the files are mapped into memory instead of being read into buffers,
+ *	the pages are only loaded when Assimp touches them. Falls back to reading when mapping is not supported.
+ *	Only reading is supported.
+ */
+class FAssimpIOSystem : public Assimp::IOSystem
+{
+public:
+    FAssimpIOSystem(const FString& inBaseDirectory, const bool bInMemoryMapFiles = false) : baseDirectory(inBaseDirectory), bMemoryMapFiles(bInMemoryMapFiles) {}
+
+    void AddMemoryFile(const FString& name, TArrayView<const uint8> data);
+
+    virtual bool Exists(const char* file) const override;
+    virtual char getOsSeparator() const override;
+    virtual Assimp::IOStream* Open(const char* file, const char* mode = "rb") override;
+    virtual void Close(Assimp::IOStream* stream) override;
+
+    /**
+     * Opens 'file' to access its bytes directly in 'outView'. Memory files and mapped files are not copied,
+     * other files are read into 'outBuffer'. The view is valid until the returned stream is closed.
+     * Null when the file can not be opened.
+     */
+    Assimp::IOStream* OpenView(const char* file, TArray<uint8>& outBuffer, TArrayView<const uint8>& outView);
+
+    // The sizes of all files opened so far, memory files included
+    int64 GetBytesOpened() const
+    {
+        return bytesOpened.GetValue();
+    }
+
+private:
+    FString ResolvePath(const char* file) const;
+    const TArrayView<const uint8>* FindMemoryFile(const FString& path) const;
+
+    FAssimpMappedFileIOStream* OpenMapped(const FString& path);
+    // Adds the size of 'stream' to 'bytesOpened'
+    Assimp::IOStream* CountOpened(Assimp::IOStream* stream);
+
+    FString baseDirectory;
+    const bool bMemoryMapFiles;
+    TMap<FString, TArrayView<const uint8>> memoryFiles;
+    FThreadSafeCounter64 bytesOpened;
+};
+
+// Reads from a memory buffer that is not owned by the stream
+class FAssimpMemoryIOStream : public Assimp::IOStream
+{
+public:
+    FAssimpMemoryIOStream(TArrayView<const uint8> inData) : data(inData.GetData()), size(inData.Num()) {}
+    // Size as size_t, mapped files can be larger than a TArrayView can address
+    FAssimpMemoryIOStream(const uint8* inData, const size_t inSize) : data(inData), size(inSize) {}
+
+    virtual size_t Read(void* buffer, size_t elementSize, size_t count) override;
+    virtual size_t Write(const void* buffer, size_t elementSize, size_t count) override;
+    virtual aiReturn Seek(size_t offset, aiOrigin origin) override;
+    virtual size_t Tell() const override;
+    virtual size_t FileSize() const override;
+    virtual void Flush() override {}
+
+    const uint8* GetData() const
+    {
+        return data;
+    }
+
+protected:
+    const uint8* data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+};
+
+// Reads from a memory mapped file, owns the mapping
+class FAssimpMappedFileIOStream : public FAssimpMemoryIOStream
+{
+public:
+    FAssimpMappedFileIOStream(IMappedFileHandle* inHandle, IMappedFileRegion* inRegion);
+    virtual ~FAssimpMappedFileIOStream();
+
+private:
+    IMappedFileHandle* handle = nullptr;
+    IMappedFileRegion* region = nullptr;
+};
+
+// Reads from a file handle of IPlatformFile
+class FAssimpPlatformFileIOStream : public Assimp::IOStream
+{
+public:
+    FAssimpPlatformFileIOStream(IFileHandle* inHandle) : handle(inHandle) {}
+    virtual ~FAssimpPlatformFileIOStream();
+
+    virtual size_t Read(void* buffer, size_t size, size_t count) override;
+    virtual size_t Write(const void* buffer, size_t size, size_t count) override;
+    virtual aiReturn Seek(size_t offset, aiOrigin origin) override;
+    virtual size_t Tell() const override;
+    virtual size_t FileSize() const override;
+    virtual void Flush() override {}
+
+private:
+    IFileHandle* handle = nullptr;
+};
+
+/**
+ *	Lets Assimp write its files through IPlatformFile with write behind buffers, @see FAssimpBufferedWriteIOStream.
+ *	Reading goes to IPlatformFile directly. Owned by the Assimp::Exporter it is set on.
+ */
+class FAssimpExportIOSystem : public Assimp::IOSystem
+{
+public:
+    FAssimpExportIOSystem(const int32 inBufferSize) : bufferSize(FMath::Max(inBufferSize, 4096)) {}
+
+    virtual bool Exists(const char* file) const override;
+    virtual char getOsSeparator() const override;
+    virtual Assimp::IOStream* Open(const char* file, const char* mode = "wb") override;
+    virtual void Close(Assimp::IOStream* stream) override;
+
+    // The errors of all writes so far, empty when every write succeeded. Assimp does not check its writes.
+    FString GetWriteError() const;
+    void AddWriteError(const FString& error);
+
+    // The bytes handed to the writes of all files so far
+    int64 GetBytesWritten() const
+    {
+        return bytesWritten.GetValue();
+    }
+    void AddBytesWritten(const int64 numBytes)
+    {
+        bytesWritten.Add(numBytes);
+    }
+
+private:
+    const int32 bufferSize;
+    FThreadSafeCounter64 bytesWritten;
+
+    mutable FCriticalSection writeErrorCriticalSection;
+    FString writeError;
+};
+
+/**
+ *	Writes to a file handle of IPlatformFile. The writes are collected in a buffer, a full buffer is written by a task
+ *	on the thread pool while the next one is filled. At most one write per file runs at a time, the handle is not shared.
+ *	Seeking writes the buffer synchronously first, it is only used to patch headers.
+ */
+class FAssimpBufferedWriteIOStream : public Assimp::IOStream
+{
+public:
+    FAssimpBufferedWriteIOStream(FAssimpExportIOSystem& inIOSystem, IFileHandle* inHandle, const FString& inPath, const int32 inBufferSize);
+    // Writes what is left and waits for it
+    virtual ~FAssimpBufferedWriteIOStream();
+
+    virtual size_t Read(void* buffer, size_t size, size_t count) override;
+    virtual size_t Write(const void* buffer, size_t size, size_t count) override;
+    virtual aiReturn Seek(size_t offset, aiOrigin origin) override;
+    virtual size_t Tell() const override;
+    virtual size_t FileSize() const override;
+    virtual void Flush() override;
+
+private:
+    void SubmitBuffer();
+    void WaitForWrite();
+
+    FAssimpExportIOSystem& ioSystem;
+    IFileHandle* handle = nullptr;
+    const FString path;
+    const int32 bufferSize;
+
+    TArray<uint8> buffer;
+    // Owned by 'pendingWrite' until it is done
+    TArray<uint8> writingBuffer;
+    TFuture<bool> pendingWrite;
+    // The file offset 'buffer' starts at
+    int64 bufferOffset = 0;
+    int64 fileSize = 0;
+};
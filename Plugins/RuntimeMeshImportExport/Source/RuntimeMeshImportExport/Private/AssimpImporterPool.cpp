@@ -0,0 +1,67 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "AssimpImporterPool.h"
+#include "Async/TaskGraphInterfaces.h"
+#include <assimp/Importer.hpp>
+
+static TUniquePtr<FAssimpImporterPool> importerPoolInstance;
+
+FAssimpImporterPool& FAssimpImporterPool::Get()
+{
+    check(importerPoolInstance.IsValid());
+    return *importerPoolInstance;
+}
+
+void FAssimpImporterPool::Startup()
+{
+    importerPoolInstance = MakeUnique<FAssimpImporterPool>();
+    // The imports run on the thread pool of the plugin, which is smaller than the task graph by default, the batch importer on its own pool
+    importerPoolInstance->maxFree = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1) + 2;
+}
+
+void FAssimpImporterPool::Shutdown()
+{
+    importerPoolInstance.Reset();
+}
+
+FAssimpImporterPool::~FAssimpImporterPool()
+{
+    while (Assimp::Importer* importer = freeImporters.Pop())
+    {
+        delete importer;
+    }
+}
+
+Assimp::Importer* FAssimpImporterPool::Acquire()
+{
+    if (Assimp::Importer* importer = freeImporters.Pop())
+    {
+        numFree.Decrement();
+        return importer;
+    }
+    return new Assimp::Importer();
+}
+
+void FAssimpImporterPool::Release(Assimp::Importer* importer)
+{
+    if (!importer)
+    {
+        return;
+    }
+
+    // The handlers are owned by the import, Assimp must not keep or delete them
+    importer->FreeScene();
+    importer->SetProgressHandler(nullptr);
+    importer->SetIOHandler(nullptr);
+
+    // Can overshoot by a few when many threads release at once, which does not matter
+    if (numFree.GetValue() >= maxFree)
+    {
+        delete importer;
+        return;
+    }
+    numFree.Increment();
+    freeImporters.Push(importer);
+}
@@ -0,0 +1,61 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LockFreeList.h"
+#include "HAL/ThreadSafeCounter.h"
+
+namespace Assimp
+{
+    class Importer;
+}
+
+/**
+ *	Reuses Assimp::Importer across imports, so the importers and post process steps are not registered again for each file.
+ *	The pool keeps about one importer per worker thread of the task graph, more importers are deleted when they are released.
+ *	The scene is freed before an importer goes back into the pool, its properties stay as they were set.
+ */
+class FAssimpImporterPool
+{
+public:
+    // Is created and destroyed with the module
+    static FAssimpImporterPool& Get();
+    static void Startup();
+    static void Shutdown();
+
+    ~FAssimpImporterPool();
+
+    // Any thread
+    Assimp::Importer* Acquire();
+    void Release(Assimp::Importer* importer);
+
+private:
+    TLockFreePointerListUnordered<Assimp::Importer, PLATFORM_CACHE_LINE_SIZE> freeImporters;
+    FThreadSafeCounter numFree;
+    int32 maxFree = 1;
+};
+
+// Acquires an importer of the pool for the lifetime of the scope
+class FScopedAssimpImporter
+{
+public:
+    FScopedAssimpImporter()
+        : importer(FAssimpImporterPool::Get().Acquire())
+    {}
+
+    ~FScopedAssimpImporter()
+    {
+        FAssimpImporterPool::Get().Release(importer);
+    }
+
+    Assimp::Importer& operator*() const
+    {
+        return *importer;
+    }
+
+private:
+    Assimp::Importer* importer;
+};
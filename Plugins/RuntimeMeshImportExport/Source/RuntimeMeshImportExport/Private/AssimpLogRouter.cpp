@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "AssimpLogRouter.h"
+#include "AssimpCustom.h"
+#include "Misc/ScopeLock.h"
+#include "assimp/DefaultLogger.hpp"
+#include "assimp/LogStream.hpp"
+
+namespace
+{
+    thread_local FAssimpScene* logTarget = nullptr;
+
+    struct FRoutingLogStream : public Assimp::LogStream
+    {
+        virtual void write(const char* message) override
+        {
+            FAssimpScene* scene = logTarget;
+            if (!scene)
+            {
+                return;
+            }
+
+            // The messages start with their severity, e.g. "Warn,  T0: "
+            ERuntimeMeshExportLogSeverity severity = ERuntimeMeshExportLogSeverity::Log;
+            if (FCStringAnsi::Strncmp(message, "Debug", 5) == 0)
+            {
+                severity = ERuntimeMeshExportLogSeverity::Verbose;
+            }
+            else if (FCStringAnsi::Strncmp(message, "Warn", 4) == 0)
+            {
+                severity = ERuntimeMeshExportLogSeverity::Warning;
+            }
+            else if (FCStringAnsi::Strncmp(message, "Error", 5) == 0)
+            {
+                severity = ERuntimeMeshExportLogSeverity::Error;
+            }
+            if (scene->IsLogged(severity))
+            {
+                // The messages end with a newline, the log adds its own
+                FString text(UTF8_TO_TCHAR(message));
+                text.TrimEndInline();
+                scene->WriteTextToLog(severity, text);
+            }
+        }
+    };
+
+    FCriticalSection loggerCriticalSection;
+    bool bLoggerCreated = false;
+}
+
+void FAssimpLogRouter::Startup()
+{
+    FScopeLock lock(&loggerCriticalSection);
+    if (bLoggerCreated)
+    {
+        return;
+    }
+
+    // The logger owns and deletes its streams
+    Assimp::DefaultLogger::create("", Assimp::Logger::NORMAL)->attachStream(new FRoutingLogStream()
+        , Assimp::Logger::Debugging | Assimp::Logger::Info | Assimp::Logger::Warn | Assimp::Logger::Err);
+    bLoggerCreated = true;
+}
+
+void FAssimpLogRouter::Shutdown()
+{
+    FScopeLock lock(&loggerCriticalSection);
+    if (bLoggerCreated)
+    {
+        Assimp::DefaultLogger::kill();
+        bLoggerCreated = false;
+    }
+}
+
+FAssimpLogRouter::FScopedTarget::FScopedTarget(FAssimpScene& scene) : previousTarget(logTarget)
+{
+    logTarget = &scene;
+}
+
+FAssimpLogRouter::FScopedTarget::~FScopedTarget()
+{
+    logTarget = previousTarget;
+}
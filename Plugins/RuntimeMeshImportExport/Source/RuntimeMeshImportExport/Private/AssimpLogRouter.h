@@ -0,0 +1,34 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FAssimpScene;
+
+/**
+ *	The DefaultLogger of Assimp is a process global singleton, so exports must not create and kill it on their own.
+ *	It is created once, on the first export, and lives until the module shuts down. Its single stream passes each message
+ *	to the export that logs on the calling thread, so any number of exporters can run at the same time.
+ *	Messages of threads without a target, e.g. from imports, are dropped.
+ */
+class FAssimpLogRouter
+{
+public:
+    // Creates the logger when it does not exist yet. Thread safe.
+    static void Startup();
+    // Is called when the module shuts down, no export may run anymore
+    static void Shutdown();
+
+    // Routes the messages of Assimp on this thread to 'scene' while it is in scope
+    struct FScopedTarget
+    {
+        FScopedTarget(FAssimpScene& scene);
+        ~FScopedTarget();
+
+    private:
+        FAssimpScene* previousTarget;
+    };
+};
@@ -0,0 +1,446 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "AssimpSkinningImport.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "MeshConversionKernels.h"
+#include "Async/ParallelFor.h"
+#include <assimp/scene.h>
+
+namespace
+{
+    void AddBonesOfNode(const aiNode* node, const int32 parentBoneIndex, const FTransform& parentBoneToNodeParent, const TMap<FName, FTransform>& inverseBindTransforms
+        , TArray<FRuntimeMeshImportBone>& outBones, TMap<FName, int32>& outBoneIndices)
+    {
+        // Nodes between two bones are folded into the local transform of the lower bone
+        const FTransform local = URuntimeMeshImportExportLibrary::AiTransformToFTransform(node->mTransformation) * parentBoneToNodeParent;
+        const FName nodeName(node->mName.C_Str());
+
+        int32 childParentBoneIndex = parentBoneIndex;
+        FTransform childParentTransform = local;
+        if (const FTransform* inverseBindTransform = inverseBindTransforms.Find(nodeName))
+        {
+            if (!outBoneIndices.Contains(nodeName))
+            {
+                FRuntimeMeshImportBone& bone = outBones.AddDefaulted_GetRef();
+                bone.name = nodeName;
+                bone.parentIndex = parentBoneIndex;
+                bone.localTransform = local;
+                bone.inverseBindTransform = *inverseBindTransform;
+                childParentBoneIndex = outBones.Num() - 1;
+                outBoneIndices.Add(nodeName, childParentBoneIndex);
+                childParentTransform = FTransform::Identity;
+            }
+        }
+
+        for (uint32 childIndex = 0; childIndex < node->mNumChildren; ++childIndex)
+        {
+            AddBonesOfNode(node->mChildren[childIndex], childParentBoneIndex, childParentTransform, inverseBindTransforms, outBones, outBoneIndices);
+        }
+    }
+
+    /**
+     * Removes the keys that linear interpolation between the kept keys around them reproduces within 'tolerance'.
+     * A key is only dropped when the segment from the last kept key to the key after it stays within the tolerance at every key dropped
+     * in between, so the error does not add up over a run of dropped keys. A channel that does not change at all keeps a single key.
+     */
+    template<typename T, typename LerpFunc, typename DistanceFunc>
+    void ReduceKeys(TArray<float>& times, TArray<T>& values, const float tolerance, LerpFunc lerp, DistanceFunc distance)
+    {
+        const int32 numKeys = values.Num();
+        if (numKeys < 2 || tolerance <= 0.f)
+        {
+            return;
+        }
+
+        bool bConstant = true;
+        for (int32 key = 1; key < numKeys && bConstant; ++key)
+        {
+            bConstant = distance(values[0], values[key]) <= tolerance;
+        }
+        if (bConstant)
+        {
+            times.SetNum(1);
+            values.SetNum(1);
+            return;
+        }
+
+        // Bounds the checks of a long run of dropped keys, after that many a key is kept
+        const int32 maxDroppedRun = 256;
+        int32 numKept = 1;
+        int32 lastKeptKey = 0;
+        for (int32 key = 1; key < numKeys - 1; ++key)
+        {
+            // The kept keys are compacted to the front, the dropped keys after 'lastKeptKey' are not overwritten yet
+            const T& start = values[numKept - 1];
+            const float startTime = times[numKept - 1];
+            const float span = times[key + 1] - startTime;
+            bool bKeep = key - lastKeptKey > maxDroppedRun;
+            for (int32 dropped = lastKeptKey + 1; dropped <= key && !bKeep; ++dropped)
+            {
+                const float alpha = span > 0.f ? (times[dropped] - startTime) / span : 0.f;
+                bKeep = distance(lerp(start, values[key + 1], alpha), values[dropped]) > tolerance;
+            }
+            if (bKeep)
+            {
+                times[numKept] = times[key];
+                values[numKept] = values[key];
+                ++numKept;
+                lastKeptKey = key;
+            }
+        }
+        times[numKept] = times[numKeys - 1];
+        values[numKept] = values[numKeys - 1];
+        ++numKept;
+
+        times.SetNum(numKept);
+        values.SetNum(numKept);
+    }
+
+    // Assimp leaves it 0 when the file does not say, 25 is its documented default
+    double GetTicksPerSecond(const aiAnimation* animation)
+    {
+        return animation->mTicksPerSecond != 0.0 ? animation->mTicksPerSecond : 25.0;
+    }
+
+    void ImportChannel(const aiNodeAnim* channel, const double ticksPerSecond, const float keyTolerance, FRuntimeMeshImportAnimationTrack& track)
+    {
+        track.positionTimes.SetNumUninitialized(channel->mNumPositionKeys);
+        track.positions.SetNumUninitialized(channel->mNumPositionKeys);
+        for (uint32 key = 0; key < channel->mNumPositionKeys; ++key)
+        {
+            const aiVectorKey& positionKey = channel->mPositionKeys[key];
+            track.positionTimes[key] = float(positionKey.mTime / ticksPerSecond);
+            track.positions[key] = FVector(positionKey.mValue.x, positionKey.mValue.y, positionKey.mValue.z);
+        }
+
+        track.rotationTimes.SetNumUninitialized(channel->mNumRotationKeys);
+        track.rotations.SetNumUninitialized(channel->mNumRotationKeys);
+        for (uint32 key = 0; key < channel->mNumRotationKeys; ++key)
+        {
+            const aiQuatKey& rotationKey = channel->mRotationKeys[key];
+            track.rotationTimes[key] = float(rotationKey.mTime / ticksPerSecond);
+            track.rotations[key] = FQuat(rotationKey.mValue.x, rotationKey.mValue.y, rotationKey.mValue.z, rotationKey.mValue.w);
+        }
+
+        track.scaleTimes.SetNumUninitialized(channel->mNumScalingKeys);
+        track.scales.SetNumUninitialized(channel->mNumScalingKeys);
+        for (uint32 key = 0; key < channel->mNumScalingKeys; ++key)
+        {
+            const aiVectorKey& scaleKey = channel->mScalingKeys[key];
+            track.scaleTimes[key] = float(scaleKey.mTime / ticksPerSecond);
+            track.scales[key] = FVector(scaleKey.mValue.x, scaleKey.mValue.y, scaleKey.mValue.z);
+        }
+
+        const auto lerpVector = [](const FVector& a, const FVector& b, const float alpha) { return FMath::Lerp(a, b, alpha); };
+        const auto distanceVector = [](const FVector& a, const FVector& b) { return FVector::Dist(a, b); };
+        ReduceKeys(track.positionTimes, track.positions, keyTolerance, lerpVector, distanceVector);
+        ReduceKeys(track.scaleTimes, track.scales, keyTolerance, lerpVector, distanceVector);
+        ReduceKeys(track.rotationTimes, track.rotations, keyTolerance
+            , [](const FQuat& a, const FQuat& b, const float alpha) { return FQuat::Slerp(a, b, alpha); }
+            , [](const FQuat& a, const FQuat& b) { return a.AngularDistance(b); });
+
+        track.positionTimes.Shrink();
+        track.positions.Shrink();
+        track.rotationTimes.Shrink();
+        track.rotations.Shrink();
+        track.scaleTimes.Shrink();
+        track.scales.Shrink();
+    }
+}
+
+void FAssimpSkinningImport::BuildSkeleton(const aiScene* scene, TArray<FRuntimeMeshImportBone>& outBones, TMap<FName, int32>& outBoneIndices)
+{
+    outBones.Reset();
+    outBoneIndices.Reset();
+
+    // The offset matrix of a bone is the same in all meshes that use it
+    TMap<FName, FTransform> inverseBindTransforms;
+    for (uint32 meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex)
+    {
+        const aiMesh* mesh = scene->mMeshes[meshIndex];
+        for (uint32 boneIndex = 0; boneIndex < mesh->mNumBones; ++boneIndex)
+        {
+            const aiBone* bone = mesh->mBones[boneIndex];
+            const FName boneName(bone->mName.C_Str());
+            if (!inverseBindTransforms.Contains(boneName))
+            {
+                inverseBindTransforms.Add(boneName, URuntimeMeshImportExportLibrary::AiTransformToFTransform(bone->mOffsetMatrix));
+            }
+        }
+    }
+
+    if (inverseBindTransforms.Num() == 0)
+    {
+        return;
+    }
+
+    AddBonesOfNode(scene->mRootNode, INDEX_NONE, FTransform::Identity, inverseBindTransforms, outBones, outBoneIndices);
+
+    // Bones without a node are kept as roots, so every weight has a bone
+    for (const TPair<FName, FTransform>& inverseBindTransform : inverseBindTransforms)
+    {
+        if (!outBoneIndices.Contains(inverseBindTransform.Key))
+        {
+            RMIE_LOG(Warning, "Bone %s has no node in the scene, it is added as a root bone.", *inverseBindTransform.Key.ToString());
+            FRuntimeMeshImportBone& bone = outBones.AddDefaulted_GetRef();
+            bone.name = inverseBindTransform.Key;
+            bone.localTransform = inverseBindTransform.Value.Inverse();
+            bone.inverseBindTransform = inverseBindTransform.Value;
+            outBoneIndices.Add(bone.name, outBones.Num() - 1);
+        }
+    }
+
+    if (outBones.Num() > MAX_uint16 + 1)
+    {
+        RMIE_LOG(Error, "The scene has %d bones, only %d are supported.", outBones.Num(), MAX_uint16 + 1);
+    }
+}
+
+void FAssimpSkinningImport::ImportSkinWeights(const aiMesh* mesh, const TMap<FName, int32>& boneIndices, const int32 maxInfluences, FRuntimeMeshImportSectionInfo& section)
+{
+    if (mesh->mNumBones == 0 || maxInfluences <= 0)
+    {
+        return;
+    }
+
+    const int32 numVertices = mesh->mNumVertices;
+    const int32 numSlots = numVertices * maxInfluences;
+    section.numBoneInfluences = maxInfluences;
+    section.boneIndices.SetNumZeroed(numSlots);
+    section.boneWeights.SetNumZeroed(numSlots);
+
+    // The largest weights of each vertex, sorted descending
+    TArray<float> weights;
+    weights.SetNumZeroed(numSlots);
+    int32 numDropped = 0;
+    for (uint32 meshBoneIndex = 0; meshBoneIndex < mesh->mNumBones; ++meshBoneIndex)
+    {
+        const aiBone* bone = mesh->mBones[meshBoneIndex];
+        const int32* boneIndex = boneIndices.Find(FName(bone->mName.C_Str()));
+        if (!boneIndex || *boneIndex > MAX_uint16)
+        {
+            continue;
+        }
+
+        for (uint32 weightIndex = 0; weightIndex < bone->mNumWeights; ++weightIndex)
+        {
+            const aiVertexWeight& vertexWeight = bone->mWeights[weightIndex];
+            if (vertexWeight.mVertexId >= uint32(numVertices) || vertexWeight.mWeight <= 0.f)
+            {
+                continue;
+            }
+
+            float* vertexWeights = weights.GetData() + vertexWeight.mVertexId * maxInfluences;
+            uint16* vertexBones = section.boneIndices.GetData() + vertexWeight.mVertexId * maxInfluences;
+            if (vertexWeights[maxInfluences - 1] >= vertexWeight.mWeight)
+            {
+                ++numDropped;
+                continue;
+            }
+            numDropped += vertexWeights[maxInfluences - 1] > 0.f ? 1 : 0;
+
+            // Insert sorted, the smallest weight falls off the end
+            int32 slot = maxInfluences - 1;
+            while (slot > 0 && vertexWeights[slot - 1] < vertexWeight.mWeight)
+            {
+                vertexWeights[slot] = vertexWeights[slot - 1];
+                vertexBones[slot] = vertexBones[slot - 1];
+                --slot;
+            }
+            vertexWeights[slot] = vertexWeight.mWeight;
+            vertexBones[slot] = uint16(*boneIndex);
+        }
+    }
+
+    if (numDropped > 0)
+    {
+        RMIE_LOG(Log, "Mesh %s: dropped %d bone weights beyond %d influences per vertex.", *FString(mesh->mName.C_Str()), numDropped, maxInfluences);
+    }
+
+    // Normalize and quantize in one pass. The rounding error goes to the largest weight, so every vertex sums up to exactly 255.
+    for (int32 vertex = 0; vertex < numVertices; ++vertex)
+    {
+        const float* vertexWeights = weights.GetData() + vertex * maxInfluences;
+        uint8* quantized = section.boneWeights.GetData() + vertex * maxInfluences;
+        float sum = 0.f;
+        for (int32 slot = 0; slot < maxInfluences; ++slot)
+        {
+            sum += vertexWeights[slot];
+        }
+        if (sum <= 0.f)
+        {
+            continue;
+        }
+
+        int32 quantizedSum = 0;
+        for (int32 slot = 0; slot < maxInfluences; ++slot)
+        {
+            quantized[slot] = uint8(FMath::RoundToInt(vertexWeights[slot] / sum * 255.f));
+            quantizedSum += quantized[slot];
+        }
+        quantized[0] = uint8(FMath::Clamp(quantized[0] + 255 - quantizedSum, 0, 255));
+    }
+}
+
+void FAssimpSkinningImport::MoveSkeletonToResultSpace(const TArray<TPair<const aiMesh*, FTransform>>& meshTransforms, const FTransform& sceneToResult
+    , const TMap<FName, int32>& boneIndices, TArray<FRuntimeMeshImportBone>& bones)
+{
+    TBitArray<> bMoved(false, bones.Num());
+    for (const TPair<const aiMesh*, FTransform>& meshTransform : meshTransforms)
+    {
+        const aiMesh* mesh = meshTransform.Key;
+        const FTransform resultToMesh = meshTransform.Value.Inverse();
+        for (uint32 meshBoneIndex = 0; meshBoneIndex < mesh->mNumBones; ++meshBoneIndex)
+        {
+            const int32* boneIndex = boneIndices.Find(FName(mesh->mBones[meshBoneIndex]->mName.C_Str()));
+            if (boneIndex && !bMoved[*boneIndex])
+            {
+                bMoved[*boneIndex] = true;
+                bones[*boneIndex].inverseBindTransform = resultToMesh * bones[*boneIndex].inverseBindTransform;
+            }
+        }
+    }
+
+    for (FRuntimeMeshImportBone& bone : bones)
+    {
+        if (bone.parentIndex == INDEX_NONE)
+        {
+            bone.localTransform = bone.localTransform * sceneToResult;
+        }
+    }
+}
+
+void FAssimpSkinningImport::MoveRootTracksToResultSpace(const FTransform& sceneToResult, const TArray<FRuntimeMeshImportBone>& bones, TArray<FRuntimeMeshImportAnimation>& animations)
+{
+    // The channels are keyed separately, each one is composed with the matching part of 'sceneToResult'
+    for (FRuntimeMeshImportAnimation& animation : animations)
+    {
+        for (FRuntimeMeshImportAnimationTrack& track : animation.tracks)
+        {
+            if (track.boneIndex == INDEX_NONE || bones[track.boneIndex].parentIndex != INDEX_NONE)
+            {
+                continue;
+            }
+            for (FVector& position : track.positions)
+            {
+                position = sceneToResult.TransformPosition(position);
+            }
+            for (FQuat& rotation : track.rotations)
+            {
+                rotation = sceneToResult.GetRotation() * rotation;
+            }
+            for (FVector& scale : track.scales)
+            {
+                scale *= sceneToResult.GetScale3D();
+            }
+        }
+    }
+}
+
+void FAssimpSkinningImport::ImportMorphTargets(const aiMesh* mesh, const FTransform& transform, const float threshold, const bool bParallel, FRuntimeMeshImportSectionInfo& section)
+{
+    const int32 numVertices = mesh->mNumVertices;
+    if (mesh->mNumAnimMeshes == 0 || section.vertices.Num() != numVertices)
+    {
+        return;
+    }
+
+    // The anim meshes store absolute positions and normals, the deltas are taken in the space of the section
+    const FMatrix positionMatrix = transform.ToMatrixWithScale();
+    const FMatrix normalMatrix = FMeshConversionKernels::GetNormalMatrix(positionMatrix);
+    const FVector* basePositions = FMeshConversionKernels::AsFVector(mesh->mVertices);
+    const bool bHasNormals = section.normals.Num() == numVertices && mesh->HasNormals();
+    const float thresholdSquared = threshold * threshold;
+
+    TArray<FRuntimeMeshImportMorphTarget> targets;
+    targets.SetNum(mesh->mNumAnimMeshes);
+    ParallelFor(targets.Num(), [&](const int32 targetIndex)
+    {
+        const aiAnimMesh* animMesh = mesh->mAnimMeshes[targetIndex];
+        if (!animMesh || !animMesh->HasPositions() || animMesh->mNumVertices != uint32(numVertices))
+        {
+            return;
+        }
+        const FVector* targetPositions = FMeshConversionKernels::AsFVector(animMesh->mVertices);
+        const FVector* targetNormals = bHasNormals && animMesh->HasNormals() ? FMeshConversionKernels::AsFVector(animMesh->mNormals) : nullptr;
+
+        FRuntimeMeshImportMorphTarget& target = targets[targetIndex];
+        target.name = animMesh->mName.length > 0 ? FName(animMesh->mName.C_Str()) : FName(*FString::Printf(TEXT("MorphTarget_%d"), targetIndex));
+        for (int32 vertex = 0; vertex < numVertices; ++vertex)
+        {
+            const FVector positionDelta = positionMatrix.TransformVector(targetPositions[vertex] - basePositions[vertex]);
+            const FVector normalDelta = targetNormals ? normalMatrix.TransformVector(targetNormals[vertex]).GetSafeNormal() - section.normals[vertex] : FVector::ZeroVector;
+            if (positionDelta.SizeSquared() <= thresholdSquared && normalDelta.SizeSquared() <= thresholdSquared)
+            {
+                continue;
+            }
+            target.vertexIndices.Add(vertex);
+            target.positionDeltas.Add(positionDelta);
+            if (targetNormals)
+            {
+                target.normalDeltas.Add(normalDelta);
+            }
+        }
+        target.vertexIndices.Shrink();
+        target.positionDeltas.Shrink();
+        target.normalDeltas.Shrink();
+    }, !bParallel);
+
+    // A target that moves nothing is dropped
+    targets.RemoveAll([](const FRuntimeMeshImportMorphTarget& target) {
+        return target.vertexIndices.Num() == 0;
+    });
+    section.morphTargets = MoveTemp(targets);
+}
+
+void FAssimpSkinningImport::ImportAnimations(const aiScene* scene, const TMap<FName, int32>& boneIndices, const TMap<FName, int32>& nodeIndices, const float keyTolerance
+    , TArray<FRuntimeMeshImportAnimation>& outAnimations)
+{
+    // The tracks are allocated up front, so the channels can be converted in parallel into their slots
+    TArray<TTuple<int32, int32>> channels;
+    outAnimations.Reset(scene->mNumAnimations);
+    for (uint32 animationIndex = 0; animationIndex < scene->mNumAnimations; ++animationIndex)
+    {
+        const aiAnimation* animation = scene->mAnimations[animationIndex];
+        const double ticksPerSecond = GetTicksPerSecond(animation);
+
+        FRuntimeMeshImportAnimation& outAnimation = outAnimations.AddDefaulted_GetRef();
+        outAnimation.name = FName(animation->mName.C_Str());
+        outAnimation.duration = float(animation->mDuration / ticksPerSecond);
+        outAnimation.tracks.SetNum(animation->mNumChannels);
+        for (uint32 channelIndex = 0; channelIndex < animation->mNumChannels; ++channelIndex)
+        {
+            channels.Emplace(int32(animationIndex), int32(channelIndex));
+        }
+    }
+
+    ParallelFor(channels.Num(), [&](const int32 index)
+    {
+        const aiAnimation* animation = scene->mAnimations[channels[index].Get<0>()];
+        const aiNodeAnim* channel = animation->mChannels[channels[index].Get<1>()];
+        FRuntimeMeshImportAnimationTrack& track = outAnimations[channels[index].Get<0>()].tracks[channels[index].Get<1>()];
+
+        const FName nodeName(channel->mNodeName.C_Str());
+        const int32* boneIndex = boneIndices.Find(nodeName);
+        const int32* nodeIndex = nodeIndices.Find(nodeName);
+        if (!boneIndex && !nodeIndex)
+        {
+            return;
+        }
+        track.boneIndex = boneIndex ? *boneIndex : INDEX_NONE;
+        track.nodeIndex = nodeIndex ? *nodeIndex : INDEX_NONE;
+        ImportChannel(channel, GetTicksPerSecond(animation), keyTolerance, track);
+    });
+
+    // The skipped channels left empty tracks
+    for (FRuntimeMeshImportAnimation& animation : outAnimations)
+    {
+        animation.tracks.RemoveAll([](const FRuntimeMeshImportAnimationTrack& track) {
+            return track.boneIndex == INDEX_NONE && track.nodeIndex == INDEX_NONE;
+        });
+    }
+}
@@ -0,0 +1,61 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct aiScene;
+struct aiMesh;
+struct FRuntimeMeshImportBone;
+struct FRuntimeMeshImportAnimation;
+struct FRuntimeMeshImportSectionInfo;
+
+/**
+ *	Imports the skeleton, skin weights and animations of an Assimp scene.
+ *	The bone names are resolved once to a bone table, the sections and animation tracks only store indices into it.
+ */
+struct FAssimpSkinningImport
+{
+    /**
+     * Collects the bones of all meshes. The parent of a bone is the closest node above it that is a bone as well.
+     * Bones are in node order, so parents are stored before their children.
+     * @param outBoneIndices	Maps the bone names to 'outBones'
+     */
+    static void BuildSkeleton(const aiScene* scene, TArray<FRuntimeMeshImportBone>& outBones, TMap<FName, int32>& outBoneIndices);
+
+    /**
+     * Fills the bone influences of 'section' from the bones of 'mesh'. Only reads 'boneIndices', so it is safe to call for many meshes in parallel.
+     * Each vertex keeps its 'maxInfluences' largest weights, normalized and quantized to 8 bit.
+     */
+    static void ImportSkinWeights(const aiMesh* mesh, const TMap<FName, int32>& boneIndices, const int32 maxInfluences, FRuntimeMeshImportSectionInfo& section);
+
+    /**
+     * For sections whose vertices are baked into the space of the result instead of the space of their mesh.
+     * The inverse bind transforms are mesh space, each one is moved to the space of the result with the transform of the first mesh that uses the bone.
+     * The root bones get 'sceneToResult', so the bind pose of the skeleton matches the baked vertices.
+     * @param meshTransforms	The transform each mesh was baked with, the first entry of a mesh is used
+     */
+    static void MoveSkeletonToResultSpace(const TArray<TPair<const aiMesh*, FTransform>>& meshTransforms, const FTransform& sceneToResult, const TMap<FName, int32>& boneIndices
+        , TArray<FRuntimeMeshImportBone>& bones);
+
+    // Moves the keys of the root bones by 'sceneToResult', like MoveSkeletonToResultSpace moved their bind pose
+    static void MoveRootTracksToResultSpace(const FTransform& sceneToResult, const TArray<FRuntimeMeshImportBone>& bones, TArray<FRuntimeMeshImportAnimation>& animations);
+
+    /**
+     * Fills the morph targets of 'section' from the anim meshes of 'mesh'. 'section' must be converted from 'mesh' with 'transform' already.
+     * Only the vertices a target moves further than 'threshold' are stored, @see FRuntimeMeshImportMorphTarget.
+     * @param bParallel		Computes the targets on the task graph, for scenes with fewer meshes than worker threads
+     */
+    static void ImportMorphTargets(const aiMesh* mesh, const FTransform& transform, const float threshold, const bool bParallel, FRuntimeMeshImportSectionInfo& section);
+
+    /**
+     * Converts the animations of the bones and nodes. Channels of nodes that are in neither map are skipped.
+     * The channels of all animations are converted in parallel, animated machines have thousands of them.
+     * @param nodeIndices		Maps the node names to FRuntimeMeshImportResult::nodes, empty without a hierarchy
+     * @param keyTolerance		Keys that the interpolation of the kept keys around them reproduces within the tolerance are removed
+     */
+    static void ImportAnimations(const aiScene* scene, const TMap<FName, int32>& boneIndices, const TMap<FName, int32>& nodeIndices, const float keyTolerance
+        , TArray<FRuntimeMeshImportAnimation>& outAnimations);
+};
@@ -0,0 +1,249 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "LightmapUVGenerator.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+namespace
+{
+    template<typename T>
+    void SplitStream(TArray<T>& stream, const TArray<int32>& sourceVertices, const int32 numVertices, const int32 stride)
+    {
+        if (stride <= 0 || stream.Num() != numVertices * stride)
+        {
+            stream.Empty();
+            return;
+        }
+        TArray<T> split;
+        split.SetNumUninitialized(sourceVertices.Num() * stride);
+        for (int32 vertex = 0; vertex < sourceVertices.Num(); ++vertex)
+        {
+            for (int32 element = 0; element < stride; ++element)
+            {
+                split[vertex * stride + element] = stream[sourceVertices[vertex] * stride + element];
+            }
+        }
+        stream = MoveTemp(split);
+    }
+
+    // The face normal axis, with its sign: 0 is +X, 1 is -X, 2 is +Y and so on
+    int32 GetFaceAxis(const FVector& p0, const FVector& p1, const FVector& p2)
+    {
+        // The triangles are clockwise, as Unreal expects them
+        const FVector normal = FVector::CrossProduct(p2 - p0, p1 - p0);
+        const FVector absNormal = normal.GetAbs();
+        const int32 axis = absNormal.X >= absNormal.Y && absNormal.X >= absNormal.Z ? 0 : (absNormal.Y >= absNormal.Z ? 1 : 2);
+        return axis * 2 + (normal[axis] < 0.f ? 1 : 0);
+    }
+
+    FVector2D ProjectOntoAxis(const FVector& position, const int32 faceAxis)
+    {
+        switch (faceAxis / 2)
+        {
+        case 0:
+            return FVector2D(position.Y, position.Z);
+        case 1:
+            return FVector2D(position.X, position.Z);
+        default:
+            return FVector2D(position.X, position.Y);
+        }
+    }
+
+    uint64 GetEdgeKey(const int32 a, const int32 b)
+    {
+        return (uint64(FMath::Min(a, b)) << 32) | uint64(uint32(FMath::Max(a, b)));
+    }
+
+    /**
+     * Places the charts on shelves, sorted by their height, with 'gutter' around each of them.
+     * Returns the edge length of the square that holds them, in the units of the chart sizes.
+     */
+    float PackCharts(const TArray<FVector2D>& chartSizes, const TArray<int32>& chartOrder, const float gutter, TArray<FVector2D>& outOffsets)
+    {
+        float area = 0.f;
+        float maxWidth = 0.f;
+        for (const FVector2D& size : chartSizes)
+        {
+            area += (size.X + gutter) * (size.Y + gutter);
+            maxWidth = FMath::Max(maxWidth, size.X + gutter);
+        }
+        const float shelfWidth = FMath::Max(FMath::Sqrt(area), maxWidth);
+
+        outOffsets.SetNumUninitialized(chartSizes.Num());
+        float x = 0.f;
+        float y = 0.f;
+        float shelfHeight = 0.f;
+        float packedWidth = 0.f;
+        for (const int32 chart : chartOrder)
+        {
+            const FVector2D paddedSize = chartSizes[chart] + FVector2D(gutter, gutter);
+            if (x > 0.f && x + paddedSize.X > shelfWidth)
+            {
+                y += shelfHeight;
+                x = 0.f;
+                shelfHeight = 0.f;
+            }
+            outOffsets[chart] = FVector2D(x + gutter * 0.5f, y + gutter * 0.5f);
+            x += paddedSize.X;
+            shelfHeight = FMath::Max(shelfHeight, paddedSize.Y);
+            packedWidth = FMath::Max(packedWidth, x);
+        }
+        return FMath::Max(packedWidth, y + shelfHeight);
+    }
+}
+
+bool FLightmapUVGenerator::GenerateLightmapUVs(FRuntimeMeshImportSectionInfo& section, const int32 resolution, const float padding)
+{
+    const int32 numVertices = section.vertices.Num();
+    const int32 numTriangles = section.triangles.Num() / 3;
+    if (numTriangles == 0 || numVertices == 0)
+    {
+        return false;
+    }
+
+    // Charts connect across the seams of the other streams, so the adjacency uses the positions
+    TMap<FVector, int32> positionToId;
+    TArray<int32> positionIds;
+    positionIds.SetNumUninitialized(numVertices);
+    for (int32 vertex = 0; vertex < numVertices; ++vertex)
+    {
+        positionIds[vertex] = positionToId.FindOrAdd(section.vertices[vertex], positionToId.Num());
+    }
+
+    TArray<int32> faceAxes;
+    faceAxes.SetNumUninitialized(numTriangles);
+    TMap<uint64, TArray<int32, TInlineAllocator<2>>> edgeTriangles;
+    edgeTriangles.Reserve(numTriangles * 3 / 2);
+    for (int32 triangle = 0; triangle < numTriangles; ++triangle)
+    {
+        const int32* corners = &section.triangles[triangle * 3];
+        faceAxes[triangle] = GetFaceAxis(section.vertices[corners[0]], section.vertices[corners[1]], section.vertices[corners[2]]);
+        for (int32 corner = 0; corner < 3; ++corner)
+        {
+            edgeTriangles.FindOrAdd(GetEdgeKey(positionIds[corners[corner]], positionIds[corners[(corner + 1) % 3]])).Add(triangle);
+        }
+    }
+
+    // Flood fill the adjacent triangles that face the same axis
+    TArray<int32> triangleCharts;
+    triangleCharts.Init(INDEX_NONE, numTriangles);
+    TArray<int32> chartAxes;
+    TArray<int32> stack;
+    for (int32 seed = 0; seed < numTriangles; ++seed)
+    {
+        if (triangleCharts[seed] != INDEX_NONE)
+        {
+            continue;
+        }
+        const int32 chart = chartAxes.Add(faceAxes[seed]);
+        triangleCharts[seed] = chart;
+        stack.Add(seed);
+        while (stack.Num() > 0)
+        {
+            const int32 triangle = stack.Pop(false);
+            const int32* corners = &section.triangles[triangle * 3];
+            for (int32 corner = 0; corner < 3; ++corner)
+            {
+                const uint64 edgeKey = GetEdgeKey(positionIds[corners[corner]], positionIds[corners[(corner + 1) % 3]]);
+                for (const int32 neighbor : edgeTriangles.FindChecked(edgeKey))
+                {
+                    if (triangleCharts[neighbor] == INDEX_NONE && faceAxes[neighbor] == faceAxes[seed])
+                    {
+                        triangleCharts[neighbor] = chart;
+                        stack.Add(neighbor);
+                    }
+                }
+            }
+        }
+    }
+    const int32 numCharts = chartAxes.Num();
+
+    // One vertex per chart it is used in
+    TMap<uint64, int32> vertexChartToVertex;
+    vertexChartToVertex.Reserve(numVertices);
+    TArray<int32> sourceVertices;
+    sourceVertices.Reserve(numVertices);
+    TArray<int32> vertexCharts;
+    vertexCharts.Reserve(numVertices);
+    for (int32 triangle = 0; triangle < numTriangles; ++triangle)
+    {
+        const int32 chart = triangleCharts[triangle];
+        for (int32 corner = 0; corner < 3; ++corner)
+        {
+            int32& index = section.triangles[triangle * 3 + corner];
+            const uint64 key = (uint64(chart) << 32) | uint64(uint32(index));
+            if (const int32* splitVertex = vertexChartToVertex.Find(key))
+            {
+                index = *splitVertex;
+                continue;
+            }
+            const int32 splitVertex = sourceVertices.Add(index);
+            vertexCharts.Add(chart);
+            vertexChartToVertex.Add(key, splitVertex);
+            index = splitVertex;
+        }
+    }
+    // Vertices that no triangle uses are dropped
+    SplitStream(section.vertices, sourceVertices, numVertices, 1);
+    SplitStream(section.normals, sourceVertices, numVertices, 1);
+    SplitStream(section.tangents, sourceVertices, numVertices, 1);
+    SplitStream(section.uv0, sourceVertices, numVertices, 1);
+    SplitStream(section.vertexColors, sourceVertices, numVertices, 1);
+    SplitStream(section.boneIndices, sourceVertices, numVertices, section.numBoneInfluences);
+    SplitStream(section.boneWeights, sourceVertices, numVertices, section.numBoneInfluences);
+    section.numBoneInfluences = section.boneIndices.Num() > 0 ? section.numBoneInfluences : 0;
+    FRuntimeMeshImportMorphTarget::Remap(section.morphTargets, sourceVertices, numVertices);
+    const int32 numSplitVertices = sourceVertices.Num();
+
+    TArray<FVector2D> projected;
+    projected.SetNumUninitialized(numSplitVertices);
+    TArray<FBox2D> chartBounds;
+    chartBounds.Init(FBox2D(ForceInit), numCharts);
+    for (int32 vertex = 0; vertex < numSplitVertices; ++vertex)
+    {
+        const int32 chart = vertexCharts[vertex];
+        projected[vertex] = ProjectOntoAxis(section.vertices[vertex], chartAxes[chart]);
+        chartBounds[chart] += projected[vertex];
+    }
+
+    TArray<FVector2D> chartSizes;
+    chartSizes.SetNumUninitialized(numCharts);
+    TArray<int32> chartOrder;
+    chartOrder.SetNumUninitialized(numCharts);
+    for (int32 chart = 0; chart < numCharts; ++chart)
+    {
+        chartSizes[chart] = chartBounds[chart].GetSize();
+        chartOrder[chart] = chart;
+    }
+    chartOrder.Sort([&chartSizes](const int32 a, const int32 b) { return chartSizes[a].Y > chartSizes[b].Y; });
+
+    // The gutter is in texels, its size in mesh units depends on the packed size. Converges within a few passes.
+    TArray<FVector2D> chartOffsets;
+    float gutter = 0.f;
+    float packedSize = PackCharts(chartSizes, chartOrder, gutter, chartOffsets);
+    const float texels = float(FMath::Max(resolution, 1));
+    for (int32 pass = 0; pass < 8 && packedSize > 0.f && padding > 0.f; ++pass)
+    {
+        const float newGutter = padding * packedSize / texels;
+        if (FMath::IsNearlyEqual(newGutter, gutter, gutter * 0.01f))
+        {
+            break;
+        }
+        gutter = newGutter;
+        packedSize = PackCharts(chartSizes, chartOrder, gutter, chartOffsets);
+    }
+    if (packedSize <= 0.f)
+    {
+        // All triangles are degenerate
+        packedSize = 1.f;
+    }
+
+    section.uv1.SetNumUninitialized(numSplitVertices);
+    for (int32 vertex = 0; vertex < numSplitVertices; ++vertex)
+    {
+        const int32 chart = vertexCharts[vertex];
+        section.uv1[vertex] = (chartOffsets[chart] + projected[vertex] - chartBounds[chart].Min) / packedSize;
+    }
+    return true;
+}
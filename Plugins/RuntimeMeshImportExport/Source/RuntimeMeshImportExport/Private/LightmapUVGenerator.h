@@ -0,0 +1,23 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRuntimeMeshImportSectionInfo;
+
+/**
+ *	Generates the lightmap UVs of a section on the import threads, @see FRuntimeMeshImportParam::bGenerateLightmapUVs.
+ *	The engine only unwraps meshes in the editor, this is a box projection: adjacent triangles that face the same axis form a chart,
+ *	the charts are projected onto their axis plane and shelf packed into the unit square, with a gutter between them.
+ */
+struct FLightmapUVGenerator
+{
+    /**
+     * Writes 'uv1' of the section. The vertices that are shared by different charts are split, every other stream is duplicated with them.
+     * 'padding' is the gutter in texels of a lightmap with 'resolution' texels. Returns false when the section has no triangles.
+     */
+    static bool GenerateLightmapUVs(FRuntimeMeshImportSectionInfo& section, const int32 resolution, const float padding);
+};
@@ -0,0 +1,134 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "MeshCollisionBuilder.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportBVH.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+
+namespace
+{
+    // The positions and triangles of all sections as one section with welded positions, the other streams are not needed for collision
+    void MergeCollisionPositions(const FRuntimeMeshImportMeshInfo& meshInfo, FRuntimeMeshImportSectionInfo& outSection)
+    {
+        for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            const int32 vertexOffset = outSection.vertices.Num();
+            outSection.vertices.Append(section.vertices);
+            outSection.triangles.Reserve(outSection.triangles.Num() + section.triangles.Num());
+            for (const int32 index : section.triangles)
+            {
+                outSection.triangles.Add(index + vertexOffset);
+            }
+        }
+        const float weldTolerance = FMath::Max(0.001f, meshInfo.bounds.IsValid ? meshInfo.bounds.GetExtent().GetMax() * 1e-5f : 0.f);
+        FMeshOptimizer::WeldVertices(outSection, weldTolerance, 0.f, 0.f);
+    }
+}
+
+void FMeshCollisionBuilder::BuildSimplifiedTrimesh(const FRuntimeMeshImportMeshInfo& meshInfo, const float triangleRatio, FRuntimeMeshImportCollision& outCollision)
+{
+    FRuntimeMeshImportSectionInfo merged;
+    MergeCollisionPositions(meshInfo, merged);
+    const int32 numTriangles = merged.triangles.Num() / 3;
+    if (numTriangles == 0)
+    {
+        return;
+    }
+
+    if (triangleRatio < 1.f)
+    {
+        FRuntimeMeshImportSectionInfo simplified;
+        FMeshSimplifier::Simplify(merged, FMath::Max(1, FMath::RoundToInt(numTriangles * triangleRatio)), simplified);
+        merged = MoveTemp(simplified);
+    }
+    outCollision.trimeshVertices = MoveTemp(merged.vertices);
+    outCollision.trimeshTriangles = MoveTemp(merged.triangles);
+}
+
+void FMeshCollisionBuilder::BuildConvexDecomposition(const FRuntimeMeshImportMeshInfo& meshInfo, const int32 maxHulls, const int32 maxHullVertices, FRuntimeMeshImportCollision& outCollision)
+{
+    FRuntimeMeshImportSectionInfo merged;
+    MergeCollisionPositions(meshInfo, merged);
+    if (merged.triangles.Num() == 0)
+    {
+        return;
+    }
+
+    // Already running in parallel per mesh
+    const TSharedRef<FRuntimeMeshImportBVH, ESPMode::ThreadSafe> bvh = FRuntimeMeshImportBVH::Build(merged, 4, false);
+    TArray<int32> clusters;
+    bvh->GetFrontier(FMath::Max(1, maxHulls), clusters);
+
+    // Directions evenly spread over the sphere (Fibonacci lattice), the farthest point of a cluster in each one is kept
+    const int32 numDirections = FMath::Max(4, maxHullVertices);
+    TArray<FVector> directions;
+    directions.SetNumUninitialized(numDirections);
+    const float goldenAngle = PI * (3.f - FMath::Sqrt(5.f));
+    for (int32 index = 0; index < numDirections; ++index)
+    {
+        const float z = 1.f - (index + 0.5f) * 2.f / numDirections;
+        const float radius = FMath::Sqrt(1.f - z * z);
+        directions[index] = FVector(FMath::Cos(goldenAngle * index) * radius, FMath::Sin(goldenAngle * index) * radius, z);
+    }
+
+    // Marks the vertices already taken for the current cluster
+    TArray<int32> vertexCluster;
+    vertexCluster.Init(INDEX_NONE, merged.vertices.Num());
+    TArray<int32> clusterVertices;
+    outCollision.convexHulls.Reserve(clusters.Num());
+    for (int32 clusterIndex = 0; clusterIndex < clusters.Num(); ++clusterIndex)
+    {
+        int32 begin, end;
+        bvh->GetTriangleRange(clusters[clusterIndex], begin, end);
+        clusterVertices.Reset();
+        for (int32 i = begin; i < end; ++i)
+        {
+            for (int32 corner = 0; corner < 3; ++corner)
+            {
+                const int32 vertex = merged.triangles[bvh->triangles[i] * 3 + corner];
+                if (vertexCluster[vertex] != clusterIndex)
+                {
+                    vertexCluster[vertex] = clusterIndex;
+                    clusterVertices.Add(vertex);
+                }
+            }
+        }
+        if (clusterVertices.Num() < 4)
+        {
+            continue;
+        }
+
+        FRuntimeMeshImportConvexHull& hull = outCollision.convexHulls.AddDefaulted_GetRef();
+        if (clusterVertices.Num() <= numDirections)
+        {
+            for (const int32 vertex : clusterVertices)
+            {
+                hull.vertices.Add(merged.vertices[vertex]);
+            }
+            continue;
+        }
+        TArray<int32> extremeVertices;
+        for (const FVector& direction : directions)
+        {
+            int32 farthest = clusterVertices[0];
+            float farthestDistance = -MAX_flt;
+            for (const int32 vertex : clusterVertices)
+            {
+                const float distance = FVector::DotProduct(merged.vertices[vertex], direction);
+                if (distance > farthestDistance)
+                {
+                    farthestDistance = distance;
+                    farthest = vertex;
+                }
+            }
+            extremeVertices.AddUnique(farthest);
+        }
+        for (const int32 vertex : extremeVertices)
+        {
+            hull.vertices.Add(merged.vertices[vertex]);
+        }
+    }
+}
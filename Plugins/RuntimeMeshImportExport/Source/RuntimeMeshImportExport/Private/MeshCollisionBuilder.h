@@ -0,0 +1,23 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRuntimeMeshImportMeshInfo;
+struct FRuntimeMeshImportCollision;
+
+/**
+ *	Prepares the collision geometry of a mesh on a worker thread, so only the cooking is left.
+ *	The trimesh is the positions of all sections welded and simplified with FMeshSimplifier.
+ *	The convex decomposition clusters the triangles with a BVH cut and keeps the extreme points of each cluster,
+ *	the hulls themselves are computed by the cooking.
+ */
+struct FMeshCollisionBuilder
+{
+    static void BuildSimplifiedTrimesh(const FRuntimeMeshImportMeshInfo& meshInfo, const float triangleRatio, FRuntimeMeshImportCollision& outCollision);
+
+    static void BuildConvexDecomposition(const FRuntimeMeshImportMeshInfo& meshInfo, const int32 maxHulls, const int32 maxHullVertices, FRuntimeMeshImportCollision& outCollision);
+};
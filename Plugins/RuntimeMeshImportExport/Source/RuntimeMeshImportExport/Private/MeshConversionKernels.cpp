@@ -0,0 +1,566 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "MeshConversionKernels.h"
+#include "Math/VectorRegister.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    FORCEINLINE VectorRegister SafeNormalize3(const VectorRegister& vector)
+    {
+        const VectorRegister lengthSquared = VectorDot3(vector, vector);
+        const VectorRegister bIsValidMask = VectorCompareGT(lengthSquared, VectorSetFloat1(SMALL_NUMBER));
+        const VectorRegister normalized = VectorMultiply(vector, VectorReciprocalSqrtAccurate(lengthSquared));
+        return VectorSelect(bIsValidMask, normalized, VectorZero());
+    }
+
+    // The streams of a specialized ConvertMeshVertices loop, the compiler removes the branches of the missing streams
+    template<uint32 Streams>
+    struct TStaticVertexStreams
+    {
+        FORCEINLINE bool Has(const uint32 stream) const
+        {
+            return (Streams & stream) != 0;
+        }
+    };
+
+    // For the combinations without a specialized loop
+    struct FDynamicVertexStreams
+    {
+        uint32 streams;
+
+        FORCEINLINE bool Has(const uint32 stream) const
+        {
+            return (streams & stream) != 0;
+        }
+    };
+
+    // Steps of the sRGB tables over [0, 1]. Enough that the interpolated decode and the encode to 8 bit are within one step of the exact curves.
+    constexpr int32 SRGBTableSize = 4096;
+
+    float SRGBToLinear(const float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : FMath::Pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float LinearToSRGB(const float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : FMath::Pow(value, 1.f / 2.4f) * 1.055f - 0.055f;
+    }
+
+    // The linear values at the steps, one more for the interpolation at 1
+    const float* GetSRGBDecodeTable()
+    {
+        static const TArray<float> table = []()
+        {
+            TArray<float> values;
+            values.SetNumUninitialized(SRGBTableSize + 1);
+            for (int32 step = 0; step <= SRGBTableSize; ++step)
+            {
+                values[step] = SRGBToLinear(float(step) / SRGBTableSize);
+            }
+            return values;
+        }();
+        return table.GetData();
+    }
+
+    // The encoded byte of the center of each step, rounded like FLinearColor::ToFColor(true)
+    const uint8* GetSRGBEncodeTable()
+    {
+        static const TArray<uint8> table = []()
+        {
+            TArray<uint8> values;
+            values.SetNumUninitialized(SRGBTableSize);
+            for (int32 step = 0; step < SRGBTableSize; ++step)
+            {
+                values[step] = uint8(FMath::Clamp(FMath::FloorToInt(LinearToSRGB((float(step) + 0.5f) / SRGBTableSize) * 255.999f), 0, 255));
+            }
+            return values;
+        }();
+        return table.GetData();
+    }
+
+    FORCEINLINE float DecodeSRGB(const float* table, const float value)
+    {
+        const float position = FMath::Clamp(value, 0.f, 1.f) * SRGBTableSize;
+        const int32 step = FMath::Min(int32(position), SRGBTableSize - 1);
+        return FMath::Lerp(table[step], table[step + 1], position - float(step));
+    }
+
+    FORCEINLINE uint8 EncodeSRGB(const uint8* table, const float value)
+    {
+        return table[FMath::Clamp(int32(value * SRGBTableSize), 0, SRGBTableSize - 1)];
+    }
+
+    // The vertices each task of a parallel conversion converts, large enough that scheduling the task costs little against it
+    constexpr int32 ParallelVertexChunkSize = 1 << 16;
+
+    /**
+     *	Splits 'num' vertices into chunks for a ParallelFor and combines the bounds 'chunkPredicate' returns for every chunk.
+     *	Predicate signature: FBox(int32 first, int32 num)
+     */
+    template<typename Predicate>
+    FBox ForEachVertexChunk(const int32 num, const bool bParallel, Predicate chunkPredicate)
+    {
+        const int32 numChunks = bParallel ? FMath::DivideAndRoundUp(num, ParallelVertexChunkSize) : 1;
+        if (numChunks <= 1)
+        {
+            return chunkPredicate(0, num);
+        }
+
+        TArray<FBox> chunkBounds;
+        chunkBounds.SetNum(numChunks);
+        ParallelFor(numChunks, [&chunkBounds, &chunkPredicate, num](int32 chunk)
+        {
+            const int32 first = chunk * ParallelVertexChunkSize;
+            chunkBounds[chunk] = chunkPredicate(first, FMath::Min(ParallelVertexChunkSize, num - first));
+        });
+
+        FBox bounds(ForceInit);
+        for (const FBox& box : chunkBounds)
+        {
+            bounds += box;
+        }
+        return bounds;
+    }
+
+    template<typename StreamsType>
+    FBox ConvertMeshVerticesFused(const StreamsType streams, const aiMesh& mesh, const FMatrix& positionMatrix, const FMatrix& normalMatrix, const FMatrix& tangentMatrix
+                                  , const FMeshConversionKernels::FVertexOutputs& outputs, const int32 first, const int32 num)
+    {
+        static_assert(sizeof(aiColor4D) == sizeof(FLinearColor), "aiColor4D and FLinearColor must have the same layout");
+        const FVector* positions = FMeshConversionKernels::AsFVector(mesh.mVertices);
+        const FVector* normals = FMeshConversionKernels::AsFVector(mesh.mNormals);
+        const aiVector3D* uv0 = mesh.mTextureCoords[0];
+        const FVector* tangents = FMeshConversionKernels::AsFVector(mesh.mTangents);
+        const FLinearColor* colors = reinterpret_cast<const FLinearColor*>(mesh.mColors[0]);
+
+        VectorRegister boundsMin = VectorSetFloat1(MAX_flt);
+        VectorRegister boundsMax = VectorSetFloat1(-MAX_flt);
+        for (int32 index = first; index < first + num; ++index)
+        {
+            const VectorRegister position = VectorTransformVector(VectorLoadFloat3_W1(&positions[index]), &positionMatrix);
+            VectorStoreFloat3(position, &outputs.positions[index]);
+            boundsMin = VectorMin(boundsMin, position);
+            boundsMax = VectorMax(boundsMax, position);
+
+            if (streams.Has(FMeshConversionKernels::VertexStream_Normals))
+            {
+                VectorStoreFloat3(SafeNormalize3(VectorTransformVector(VectorLoadFloat3_W0(&normals[index]), &normalMatrix)), &outputs.normals[index]);
+            }
+            if (streams.Has(FMeshConversionKernels::VertexStream_UV0))
+            {
+                outputs.uv0[index] = FVector2D(uv0[index].x, -uv0[index].y);
+            }
+            if (streams.Has(FMeshConversionKernels::VertexStream_Tangents))
+            {
+                VectorStoreFloat3(SafeNormalize3(VectorTransformVector(VectorLoadFloat3_W0(&tangents[index]), &tangentMatrix)), &outputs.tangents[index]);
+            }
+            if (streams.Has(FMeshConversionKernels::VertexStream_Colors))
+            {
+                VectorStore(VectorLoad(&colors[index].R), &outputs.colors[index].R);
+            }
+        }
+
+        FBox bounds(ForceInit);
+        if (num > 0)
+        {
+            VectorStoreFloat3(boundsMin, &bounds.Min);
+            VectorStoreFloat3(boundsMax, &bounds.Max);
+            bounds.IsValid = 1;
+        }
+        return bounds;
+    }
+}
+
+void FMeshConversionKernels::TransformPositions(const FMatrix& matrix, const FVector* in, FVector* out, const int32 num, FBox* outBounds)
+{
+    VectorRegister boundsMin = VectorSetFloat1(MAX_flt);
+    VectorRegister boundsMax = VectorSetFloat1(-MAX_flt);
+    int32 index = 0;
+    // Four at a time to keep the pipeline busy
+    for (; index + 4 <= num; index += 4)
+    {
+        const VectorRegister v0 = VectorTransformVector(VectorLoadFloat3_W1(&in[index]), &matrix);
+        const VectorRegister v1 = VectorTransformVector(VectorLoadFloat3_W1(&in[index + 1]), &matrix);
+        const VectorRegister v2 = VectorTransformVector(VectorLoadFloat3_W1(&in[index + 2]), &matrix);
+        const VectorRegister v3 = VectorTransformVector(VectorLoadFloat3_W1(&in[index + 3]), &matrix);
+        VectorStoreFloat3(v0, &out[index]);
+        VectorStoreFloat3(v1, &out[index + 1]);
+        VectorStoreFloat3(v2, &out[index + 2]);
+        VectorStoreFloat3(v3, &out[index + 3]);
+        if (outBounds)
+        {
+            boundsMin = VectorMin(boundsMin, VectorMin(VectorMin(v0, v1), VectorMin(v2, v3)));
+            boundsMax = VectorMax(boundsMax, VectorMax(VectorMax(v0, v1), VectorMax(v2, v3)));
+        }
+    }
+    for (; index < num; ++index)
+    {
+        const VectorRegister v = VectorTransformVector(VectorLoadFloat3_W1(&in[index]), &matrix);
+        VectorStoreFloat3(v, &out[index]);
+        boundsMin = VectorMin(boundsMin, v);
+        boundsMax = VectorMax(boundsMax, v);
+    }
+
+    if (outBounds)
+    {
+        *outBounds = FBox(ForceInit);
+        if (num > 0)
+        {
+            VectorStoreFloat3(boundsMin, &outBounds->Min);
+            VectorStoreFloat3(boundsMax, &outBounds->Max);
+            outBounds->IsValid = 1;
+        }
+    }
+}
+
+FBox FMeshConversionKernels::ComputeTransformedBounds(const FMatrix& matrix, const FVector* in, const int32 num, const bool bParallel)
+{
+    if (bParallel)
+    {
+        return ForEachVertexChunk(num, true, [&matrix, in](const int32 first, const int32 chunkNum) -> FBox
+        {
+            return ComputeTransformedBounds(matrix, in + first, chunkNum, false);
+        });
+    }
+
+    VectorRegister boundsMin0 = VectorSetFloat1(MAX_flt);
+    VectorRegister boundsMax0 = VectorSetFloat1(-MAX_flt);
+    VectorRegister boundsMin1 = boundsMin0;
+    VectorRegister boundsMax1 = boundsMax0;
+    int32 index = 0;
+    // Two independent reductions, so the min and max do not wait for each other
+    for (; index + 2 <= num; index += 2)
+    {
+        const VectorRegister v0 = VectorTransformVector(VectorLoadFloat3_W1(&in[index]), &matrix);
+        const VectorRegister v1 = VectorTransformVector(VectorLoadFloat3_W1(&in[index + 1]), &matrix);
+        boundsMin0 = VectorMin(boundsMin0, v0);
+        boundsMax0 = VectorMax(boundsMax0, v0);
+        boundsMin1 = VectorMin(boundsMin1, v1);
+        boundsMax1 = VectorMax(boundsMax1, v1);
+    }
+    for (; index < num; ++index)
+    {
+        const VectorRegister v = VectorTransformVector(VectorLoadFloat3_W1(&in[index]), &matrix);
+        boundsMin0 = VectorMin(boundsMin0, v);
+        boundsMax0 = VectorMax(boundsMax0, v);
+    }
+
+    FBox bounds(ForceInit);
+    if (num > 0)
+    {
+        VectorStoreFloat3(VectorMin(boundsMin0, boundsMin1), &bounds.Min);
+        VectorStoreFloat3(VectorMax(boundsMax0, boundsMax1), &bounds.Max);
+        bounds.IsValid = 1;
+    }
+    return bounds;
+}
+
+FBox FMeshConversionKernels::ComputeBounds(const FVector* in, const int32 num)
+{
+    VectorRegister boundsMin = VectorSetFloat1(MAX_flt);
+    VectorRegister boundsMax = VectorSetFloat1(-MAX_flt);
+    for (int32 index = 0; index < num; ++index)
+    {
+        const VectorRegister v = VectorLoadFloat3(&in[index]);
+        boundsMin = VectorMin(boundsMin, v);
+        boundsMax = VectorMax(boundsMax, v);
+    }
+
+    FBox bounds(ForceInit);
+    if (num > 0)
+    {
+        VectorStoreFloat3(boundsMin, &bounds.Min);
+        VectorStoreFloat3(boundsMax, &bounds.Max);
+        bounds.IsValid = 1;
+    }
+    return bounds;
+}
+
+void FMeshConversionKernels::TransformDirections(const FMatrix& matrix, const FVector* in, FVector* out, const int32 num, const bool bNormalize)
+{
+    int32 index = 0;
+    if (bNormalize)
+    {
+        for (; index + 4 <= num; index += 4)
+        {
+            const VectorRegister v0 = SafeNormalize3(VectorTransformVector(VectorLoadFloat3_W0(&in[index]), &matrix));
+            const VectorRegister v1 = SafeNormalize3(VectorTransformVector(VectorLoadFloat3_W0(&in[index + 1]), &matrix));
+            const VectorRegister v2 = SafeNormalize3(VectorTransformVector(VectorLoadFloat3_W0(&in[index + 2]), &matrix));
+            const VectorRegister v3 = SafeNormalize3(VectorTransformVector(VectorLoadFloat3_W0(&in[index + 3]), &matrix));
+            VectorStoreFloat3(v0, &out[index]);
+            VectorStoreFloat3(v1, &out[index + 1]);
+            VectorStoreFloat3(v2, &out[index + 2]);
+            VectorStoreFloat3(v3, &out[index + 3]);
+        }
+        for (; index < num; ++index)
+        {
+            VectorStoreFloat3(SafeNormalize3(VectorTransformVector(VectorLoadFloat3_W0(&in[index]), &matrix)), &out[index]);
+        }
+    }
+    else
+    {
+        for (; index + 4 <= num; index += 4)
+        {
+            const VectorRegister v0 = VectorTransformVector(VectorLoadFloat3_W0(&in[index]), &matrix);
+            const VectorRegister v1 = VectorTransformVector(VectorLoadFloat3_W0(&in[index + 1]), &matrix);
+            const VectorRegister v2 = VectorTransformVector(VectorLoadFloat3_W0(&in[index + 2]), &matrix);
+            const VectorRegister v3 = VectorTransformVector(VectorLoadFloat3_W0(&in[index + 3]), &matrix);
+            VectorStoreFloat3(v0, &out[index]);
+            VectorStoreFloat3(v1, &out[index + 1]);
+            VectorStoreFloat3(v2, &out[index + 2]);
+            VectorStoreFloat3(v3, &out[index + 3]);
+        }
+        for (; index < num; ++index)
+        {
+            VectorStoreFloat3(VectorTransformVector(VectorLoadFloat3_W0(&in[index]), &matrix), &out[index]);
+        }
+    }
+}
+
+void FMeshConversionKernels::CopyTriangleFaces(const aiFace* faces, const int32 numFaces, int32* outTriangles, const bool bFlipWindingOrder, const bool bParallel)
+{
+    if (bParallel && numFaces > ParallelVertexChunkSize)
+    {
+        ParallelFor(FMath::DivideAndRoundUp(numFaces, ParallelVertexChunkSize), [faces, numFaces, outTriangles, bFlipWindingOrder](int32 chunk)
+        {
+            const int32 first = chunk * ParallelVertexChunkSize;
+            CopyTriangleFaces(faces + first, FMath::Min(ParallelVertexChunkSize, numFaces - first), outTriangles + first * 3, bFlipWindingOrder, false);
+        });
+        return;
+    }
+
+    // Assimp allocates the indices of every face separately, so there is no contiguous block to copy from
+    const int32 second = bFlipWindingOrder ? 2 : 1;
+    const int32 third = bFlipWindingOrder ? 1 : 2;
+    for (int32 faceIndex = 0; faceIndex < numFaces; ++faceIndex)
+    {
+        const unsigned int* indices = faces[faceIndex].mIndices;
+        int32* out = outTriangles + faceIndex * 3;
+        out[0] = indices[0];
+        out[1] = indices[second];
+        out[2] = indices[third];
+    }
+}
+
+int32 FMeshConversionKernels::CopyTriangleFacesChecked(const aiFace* faces, const int32 numFaces, int32* outTriangles, const bool bFlipWindingOrder)
+{
+    const int32 second = bFlipWindingOrder ? 2 : 1;
+    const int32 third = bFlipWindingOrder ? 1 : 2;
+    int32* out = outTriangles;
+    for (int32 faceIndex = 0; faceIndex < numFaces; ++faceIndex)
+    {
+        const aiFace& face = faces[faceIndex];
+        if (face.mNumIndices != 3)
+        {
+            continue;
+        }
+        out[0] = face.mIndices[0];
+        out[1] = face.mIndices[second];
+        out[2] = face.mIndices[third];
+        out += 3;
+    }
+    return out - outTriangles;
+}
+
+void FMeshConversionKernels::BuildTriangleFaces(const int32* triangles, const int32 numIndices, uint32* outIndexBuffer, aiFace* outFaces)
+{
+    check(numIndices % 3 == 0);
+    static_assert(sizeof(int32) == sizeof(unsigned int), "Indices are copied bitwise");
+    FMemory::Memcpy(outIndexBuffer, triangles, numIndices * sizeof(int32));
+
+    const int32 numFaces = numIndices / 3;
+    for (int32 faceIndex = 0; faceIndex < numFaces; ++faceIndex)
+    {
+        outFaces[faceIndex].mNumIndices = 3;
+        outFaces[faceIndex].mIndices = outIndexBuffer + faceIndex * 3;
+    }
+}
+
+void FMeshConversionKernels::OffsetIndices(const int32* in, int32* out, const int32 num, const int32 offset)
+{
+    const VectorRegisterInt offsetRegister = VectorIntSet1(offset);
+    int32 index = 0;
+    for (; index + 4 <= num; index += 4)
+    {
+        VectorIntStore(VectorIntAdd(VectorIntLoad(&in[index]), offsetRegister), &out[index]);
+    }
+    for (; index < num; ++index)
+    {
+        out[index] = in[index] + offset;
+    }
+}
+
+void FMeshConversionKernels::ReinterpretColorsAsLinear(const FColor* in, FLinearColor* out, const int32 num)
+{
+    static_assert(sizeof(FColor) == 4, "FColor must be 4 bytes");
+    const VectorRegister scale = VectorSetFloat1(1.f / 255.f);
+    for (int32 index = 0; index < num; ++index)
+    {
+        // FColor is stored as BGRA
+        const VectorRegister bgra = VectorLoadByte4(&in[index]);
+        VectorStore(VectorMultiply(VectorSwizzle(bgra, 2, 1, 0, 3), scale), &out[index].R);
+    }
+}
+
+void FMeshConversionKernels::SRGBColorsToLinear(const FColor* in, FLinearColor* out, const int32 num)
+{
+    const float* table = FLinearColor::sRGBToLinearTable;
+    for (int32 index = 0; index < num; ++index)
+    {
+        const FColor color = in[index];
+        out[index] = FLinearColor(table[color.R], table[color.G], table[color.B], float(color.A) * (1.f / 255.f));
+    }
+}
+
+void FMeshConversionKernels::DecodeSRGBColors(FLinearColor* colors, const int32 num, const bool bParallel)
+{
+    const float* table = GetSRGBDecodeTable();
+    ForEachVertexChunk(num, bParallel, [colors, table](const int32 first, const int32 chunkNum) -> FBox
+    {
+        for (int32 index = first; index < first + chunkNum; ++index)
+        {
+            FLinearColor& color = colors[index];
+            color.R = DecodeSRGB(table, color.R);
+            color.G = DecodeSRGB(table, color.G);
+            color.B = DecodeSRGB(table, color.B);
+        }
+        return FBox(ForceInit);
+    });
+}
+
+void FMeshConversionKernels::QuantizeColors(const FLinearColor* in, FColor* out, const int32 num, const bool bSRGB)
+{
+    static_assert(sizeof(FColor) == 4, "FColor must be 4 bytes");
+    if (bSRGB)
+    {
+        const uint8* table = GetSRGBEncodeTable();
+        for (int32 index = 0; index < num; ++index)
+        {
+            const FLinearColor& color = in[index];
+            out[index] = FColor(EncodeSRGB(table, color.R), EncodeSRGB(table, color.G), EncodeSRGB(table, color.B)
+                                , uint8(FMath::Clamp(FMath::TruncToInt(color.A * 255.999f), 0, 255)));
+        }
+        return;
+    }
+
+    const VectorRegister scale = VectorSetFloat1(255.999f);
+    for (int32 index = 0; index < num; ++index)
+    {
+        // Truncated like FLinearColor::ToFColor(false), FColor is stored as BGRA
+        const VectorRegister rgba = VectorMin(VectorMax(VectorLoad(&in[index].R), VectorZero()), VectorOne());
+        VectorStoreByte4(VectorMultiply(VectorSwizzle(rgba, 2, 1, 0, 3), scale), &out[index]);
+    }
+}
+
+bool FMeshConversionKernels::HasOnlyDefaultColors(const FColor* colors, const int32 num)
+{
+    if (num <= 0)
+    {
+        return true;
+    }
+    const FColor first = colors[0];
+    if (first != FColor::White && first.DWColor() != 0)
+    {
+        return false;
+    }
+    for (int32 index = 1; index < num; ++index)
+    {
+        if (colors[index] != first)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FMeshConversionKernels::ExpandUVs(const FVector2D* in, FVector* out, const int32 num)
+{
+    // Two UVs per load, the Z of each is masked to zero
+    const VectorRegister xyMask = MakeVectorRegister(uint32(0xFFFFFFFF), uint32(0xFFFFFFFF), uint32(0), uint32(0));
+    int32 index = 0;
+    for (; index + 2 <= num; index += 2)
+    {
+        const VectorRegister uvs = VectorLoad(&in[index].X);
+        VectorStoreFloat3(VectorBitwiseAnd(uvs, xyMask), &out[index]);
+        VectorStoreFloat3(VectorBitwiseAnd(VectorSwizzle(uvs, 2, 3, 0, 1), xyMask), &out[index + 1]);
+    }
+    for (; index < num; ++index)
+    {
+        out[index] = FVector(in[index].X, in[index].Y, 0.f);
+    }
+}
+
+void FMeshConversionKernels::ComputeBitangents(const FVector* normals, const FVector* tangents, FVector* out, const int32 num)
+{
+    for (int32 index = 0; index < num; ++index)
+    {
+        const VectorRegister bitangent = VectorCross(VectorLoadFloat3(&normals[index]), VectorLoadFloat3(&tangents[index]));
+        VectorStoreFloat3(bitangent, &out[index]);
+    }
+}
+
+uint32 FMeshConversionKernels::GetVertexStreams(const aiMesh& mesh)
+{
+    uint32 streams = 0;
+    streams |= mesh.HasNormals() ? VertexStream_Normals : 0;
+    streams |= mesh.HasTextureCoords(0) ? VertexStream_UV0 : 0;
+    streams |= mesh.HasTangentsAndBitangents() ? VertexStream_Tangents : 0;
+    streams |= mesh.HasVertexColors(0) ? VertexStream_Colors : 0;
+    return streams;
+}
+
+FBox FMeshConversionKernels::ConvertMeshVertices(const aiMesh& mesh, const uint32 streams, const FMatrix& positionMatrix, const FMatrix& tangentMatrix, const FVertexOutputs& outputs, const bool bParallel)
+{
+    checkSlow((streams & ~GetVertexStreams(mesh)) == 0);
+    const FMatrix normalMatrix = (streams & VertexStream_Normals) ? GetNormalMatrix(positionMatrix) : FMatrix::Identity;
+    return ForEachVertexChunk(mesh.mNumVertices, bParallel, [&](const int32 first, const int32 num) -> FBox
+    {
+        switch (streams)
+        {
+        case 0:
+            return ConvertMeshVerticesFused(TStaticVertexStreams<0>(), mesh, positionMatrix, normalMatrix, tangentMatrix, outputs, first, num);
+        case VertexStream_Normals:
+            return ConvertMeshVerticesFused(TStaticVertexStreams<VertexStream_Normals>(), mesh, positionMatrix, normalMatrix, tangentMatrix, outputs, first, num);
+        case VertexStream_Normals | VertexStream_UV0:
+            return ConvertMeshVerticesFused(TStaticVertexStreams<VertexStream_Normals | VertexStream_UV0>(), mesh, positionMatrix, normalMatrix, tangentMatrix, outputs, first, num);
+        case VertexStream_Normals | VertexStream_UV0 | VertexStream_Tangents:
+            return ConvertMeshVerticesFused(TStaticVertexStreams<VertexStream_Normals | VertexStream_UV0 | VertexStream_Tangents>(), mesh, positionMatrix, normalMatrix, tangentMatrix, outputs, first, num);
+        case VertexStream_Normals | VertexStream_UV0 | VertexStream_Colors:
+            return ConvertMeshVerticesFused(TStaticVertexStreams<VertexStream_Normals | VertexStream_UV0 | VertexStream_Colors>(), mesh, positionMatrix, normalMatrix, tangentMatrix, outputs, first, num);
+        case VertexStream_Normals | VertexStream_UV0 | VertexStream_Tangents | VertexStream_Colors:
+            return ConvertMeshVerticesFused(TStaticVertexStreams<VertexStream_Normals | VertexStream_UV0 | VertexStream_Tangents | VertexStream_Colors>(), mesh, positionMatrix, normalMatrix, tangentMatrix, outputs, first, num);
+        default:
+            return ConvertMeshVerticesFused(FDynamicVertexStreams{ streams }, mesh, positionMatrix, normalMatrix, tangentMatrix, outputs, first, num);
+        }
+    });
+}
+
+FBox FMeshConversionKernels::TransformVertices(const FMatrix& positionMatrix, const FVector* inPositions, const FVector* inNormals, const FVector* inTangents
+    , FVector* outPositions, FVector* outNormals, FVector* outTangents, const int32 num, const bool bParallel)
+{
+    // Once for all chunks
+    const FMatrix normalMatrix = GetNormalMatrix(positionMatrix);
+    return ForEachVertexChunk(num, bParallel, [&](const int32 first, const int32 chunkNum) -> FBox
+    {
+        FBox bounds;
+        TransformPositions(positionMatrix, inPositions + first, outPositions + first, chunkNum, &bounds);
+        TransformDirections(normalMatrix, inNormals + first, outNormals + first, chunkNum, true);
+        TransformDirections(positionMatrix, inTangents + first, outTangents + first, chunkNum, true);
+        return bounds;
+    });
+}
+
+FMatrix FMeshConversionKernels::GetNormalMatrix(const FMatrix& positionMatrix)
+{
+    //https://www.scratchapixel.com/lessons/mathematics-physics-for-computer-graphics/geometry/transforming-normals
+    FMatrix normalMatrix = positionMatrix.Inverse().GetTransposed();
+    // Only the rotational part is relevant for directions
+    normalMatrix.SetOrigin(FVector::ZeroVector);
+    normalMatrix.M[0][3] = normalMatrix.M[1][3] = normalMatrix.M[2][3] = 0.f;
+    normalMatrix.M[3][3] = 1.f;
+    return normalMatrix;
+}
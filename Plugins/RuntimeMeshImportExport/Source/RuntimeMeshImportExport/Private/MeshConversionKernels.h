@@ -0,0 +1,135 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "assimp/vector3.h"
+#include "assimp/mesh.h"
+
+/**
+ *	Bulk conversion kernels that are shared between import and export.
+ *	The kernels work on plain arrays with a precomputed FMatrix and use the VectorRegister
+ *	intrinsics of the engine (SSE/NEON) for the math.
+ *	Input and output may point to the same memory to transform in place.
+ */
+struct FMeshConversionKernels
+{
+    // Transforms positions by 'matrix', including the translation. When 'outBounds' is set, it gets the bounds of the transformed positions.
+    static void TransformPositions(const FMatrix& matrix, const FVector* in, FVector* out, const int32 num, FBox* outBounds = nullptr);
+
+    // The bounds of the positions transformed by 'matrix', without writing them. When 'bParallel', large arrays are reduced in chunks on the task graph.
+    static FBox ComputeTransformedBounds(const FMatrix& matrix, const FVector* in, const int32 num, const bool bParallel = false);
+
+    static FBox ComputeBounds(const FVector* in, const int32 num);
+
+    // Transforms directions by 'matrix', without the translation.
+    // When 'bNormalize', the result is normalized. Too small vectors become zero like with FVector::GetSafeNormal
+    static void TransformDirections(const FMatrix& matrix, const FVector* in, FVector* out, const int32 num, const bool bNormalize);
+
+    // Matrix to transform normals with. Inverse transpose of the position matrix, keeps normals perpendicular under non uniform scale.
+    static FMatrix GetNormalMatrix(const FMatrix& positionMatrix);
+
+    /**
+     *	Transforms the positions by 'positionMatrix', the normals by its normal matrix and the tangents by the matrix itself, both normalized.
+     *	All three arrays have 'num' elements. When 'bParallel', large arrays are transformed in chunks on the task graph.
+     *	Returns the bounds of the transformed positions.
+     */
+    static FBox TransformVertices(const FMatrix& positionMatrix, const FVector* inPositions, const FVector* inNormals, const FVector* inTangents
+                                  , FVector* outPositions, FVector* outNormals, FVector* outTangents, const int32 num, const bool bParallel = false);
+
+    // The streams of an aiMesh that ConvertMeshVertices converts besides the positions
+    enum EVertexStream : uint32
+    {
+        VertexStream_Normals = 1 << 0,
+        VertexStream_UV0 = 1 << 1,
+        VertexStream_Tangents = 1 << 2,
+        VertexStream_Colors = 1 << 3,
+    };
+
+    // The VertexStream_ flags of the streams 'mesh' has
+    static uint32 GetVertexStreams(const aiMesh& mesh);
+
+    // The outputs of ConvertMeshVertices, each with space for all vertices. The outputs of the streams the mesh does not have are not written and may be null.
+    struct FVertexOutputs
+    {
+        FVector* positions = nullptr;
+        FVector* normals = nullptr;
+        FVector2D* uv0 = nullptr;
+        FVector* tangents = nullptr;
+        FLinearColor* colors = nullptr;
+    };
+
+    /**
+     *	Converts the positions and the normals, first UVs, tangents and first colors of 'mesh' in a single pass over the vertices,
+     *	instead of one pass per stream. The loop is specialized at compile time for the common combinations of streams.
+     *	The positions are transformed by 'positionMatrix', the normals by its normal matrix and the tangents by 'tangentMatrix', both normalized.
+     *	The V of the UVs is flipped.
+     *	@param streams		The VertexStream_ flags to convert, only of streams the mesh has, @see GetVertexStreams
+     *	@param bParallel	Splits large meshes into chunks of vertices that are converted on the task graph, for meshes like scans
+     *						that would otherwise keep a single thread busy while the others are idle
+     *	@returns The bounds of the transformed positions
+     */
+    static FBox ConvertMeshVertices(const aiMesh& mesh, const uint32 streams, const FMatrix& positionMatrix, const FMatrix& tangentMatrix, const FVertexOutputs& outputs
+                                    , const bool bParallel = false);
+
+    /**
+     *	Copies the indices of triangle faces to 'outTriangles' which must have space for numFaces * 3 indices.
+     *	All faces must be triangles, check it once per mesh with aiMesh::mPrimitiveTypes before calling.
+     *	@param bFlipWindingOrder	Writes the triangles as 0, 2, 1
+     *	@param bParallel			Copies large face arrays in chunks on the task graph
+     */
+    static void CopyTriangleFaces(const aiFace* faces, const int32 numFaces, int32* outTriangles, const bool bFlipWindingOrder, const bool bParallel = false);
+
+    /**
+     *	Same as CopyTriangleFaces, but skips every face that is no triangle.
+     *	Returns the number of indices written to 'outTriangles'.
+     */
+    static int32 CopyTriangleFacesChecked(const aiFace* faces, const int32 numFaces, int32* outTriangles, const bool bFlipWindingOrder);
+
+    /**
+     *	Creates triangle faces from a triangle index list. All indices are copied to 'outIndexBuffer', which must have space for 'numIndices'.
+     *	The faces point into 'outIndexBuffer', they do not own their indices.
+     */
+    static void BuildTriangleFaces(const int32* triangles, const int32 numIndices, uint32* outIndexBuffer, aiFace* outFaces);
+
+    // Writes each index of 'in' plus 'offset' to 'out'. Is used to append the triangles of one section to another.
+    static void OffsetIndices(const int32* in, int32* out, const int32 num, const int32 offset);
+
+    // Converts colors to linear colors without gamma correction, like FColor::ReinterpretAsLinear
+    static void ReinterpretColorsAsLinear(const FColor* in, FLinearColor* out, const int32 num);
+
+    // Decodes sRGB encoded colors to linear colors with the lookup table of FLinearColor(FColor). The alpha is not encoded.
+    static void SRGBColorsToLinear(const FColor* in, FLinearColor* out, const int32 num);
+
+    /**
+     *	Decodes the RGB of sRGB encoded float colors to linear in place, through a lookup table with linear interpolation.
+     *	The values are clamped to [0, 1] first, the alpha is kept.
+     *	@param bParallel	Decodes large arrays in chunks on the task graph
+     */
+    static void DecodeSRGBColors(FLinearColor* colors, const int32 num, const bool bParallel = false);
+
+    /**
+     *	Converts linear colors to FColor, clamped to [0, 1].
+     *	@param bSRGB	Encodes the RGB through a lookup table, within one step of FLinearColor::ToFColor(true).
+     *					Otherwise the same as FLinearColor::ToFColor(false).
+     */
+    static void QuantizeColors(const FLinearColor* in, FColor* out, const int32 num, const bool bSRGB);
+
+    // True for the colors exportables fill in when the mesh has none: all white or all zero. Also for no colors.
+    static bool HasOnlyDefaultColors(const FColor* colors, const int32 num);
+
+    // Writes the UVs as vectors with a zero Z, the layout of Assimp texture coordinates
+    static void ExpandUVs(const FVector2D* in, FVector* out, const int32 num);
+
+    // Writes normal x tangent of each vertex, the bitangent of the Unreal tangent basis without the sign
+    static void ComputeBitangents(const FVector* normals, const FVector* tangents, FVector* out, const int32 num);
+
+    // Assimp and Unreal vectors share the same memory layout, so Assimp arrays can be passed to the kernels directly.
+    static const FVector* AsFVector(const aiVector3D* vectors)
+    {
+        static_assert(sizeof(aiVector3D) == sizeof(FVector), "aiVector3D and FVector must have the same layout");
+        return reinterpret_cast<const FVector*>(vectors);
+    }
+};
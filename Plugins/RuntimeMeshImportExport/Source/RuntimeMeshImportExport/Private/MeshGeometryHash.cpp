@@ -0,0 +1,113 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "MeshGeometryHash.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "Hash/CityHash.h"
+
+namespace
+{
+    // Quantizes the streams in blocks, so the hash is chained over few large calls without a copy of the whole section
+    class FGeometryHasher
+    {
+    public:
+        explicit FGeometryHasher(const float precision)
+            : positionScale(1.f / FMath::Max(precision, KINDA_SMALL_NUMBER))
+        {
+        }
+
+        void AddSection(const FRuntimeMeshImportSectionInfo& section)
+        {
+            AddValue(section.vertices.Num());
+            AddValue(section.triangles.Num());
+            AddValue(section.uv0.Num());
+            for (const FVector& vertex : section.vertices)
+            {
+                AddValue(FMath::RoundToInt(vertex.X * positionScale));
+                AddValue(FMath::RoundToInt(vertex.Y * positionScale));
+                AddValue(FMath::RoundToInt(vertex.Z * positionScale));
+            }
+            for (const FVector2D& uv : section.uv0)
+            {
+                AddValue(FMath::RoundToInt(uv.X * uvScale));
+                AddValue(FMath::RoundToInt(uv.Y * uvScale));
+            }
+            for (const int32 index : section.triangles)
+            {
+                AddValue(index);
+            }
+        }
+
+        void AddValue(const int32 value)
+        {
+            block[numValues++] = value;
+            if (numValues == blockSize)
+            {
+                Flush();
+            }
+        }
+
+        int64 Finish()
+        {
+            Flush();
+            // 0 is the mesh without a hash
+            return hash != 0 ? int64(hash) : 1;
+        }
+
+    private:
+        void Flush()
+        {
+            if (numValues > 0)
+            {
+                hash = CityHash64WithSeed(reinterpret_cast<const char*>(block), numValues * sizeof(int32), hash);
+                numValues = 0;
+            }
+        }
+
+        static const int32 blockSize = 4096;
+        // 1/8192 of a texture
+        static constexpr float uvScale = 8192.f;
+
+        const float positionScale;
+        int32 block[blockSize];
+        int32 numValues = 0;
+        uint64 hash = 0;
+    };
+}
+
+int64 FMeshGeometryHash::HashMeshInfo(const FRuntimeMeshImportMeshInfo& meshInfo, const float precision)
+{
+    FGeometryHasher hasher(precision);
+    hasher.AddValue(meshInfo.sections.Num());
+    for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+    {
+        hasher.AddSection(section);
+    }
+    hasher.AddValue(meshInfo.lods.Num());
+    for (const FRuntimeMeshImportMeshLOD& lod : meshInfo.lods)
+    {
+        hasher.AddValue(lod.sections.Num());
+        for (const FRuntimeMeshImportSectionInfo& section : lod.sections)
+        {
+            hasher.AddSection(section);
+        }
+    }
+    return hasher.Finish();
+}
+
+bool FMeshGeometryHash::HasSameMaterials(const FRuntimeMeshImportMeshInfo& meshInfo, const FRuntimeMeshImportMeshInfo& otherMeshInfo)
+{
+    if (meshInfo.sections.Num() != otherMeshInfo.sections.Num())
+    {
+        return false;
+    }
+    for (int32 sectionIndex = 0; sectionIndex < meshInfo.sections.Num(); ++sectionIndex)
+    {
+        if (meshInfo.sections[sectionIndex].materialIndex != otherMeshInfo.sections[sectionIndex].materialIndex)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,27 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRuntimeMeshImportMeshInfo;
+
+/**
+ *	Content hashes of the geometry of meshes, so identical parts of different files or nodes can share one mesh.
+ *	The positions are rounded to a grid first, so the float noise of different exporters does not change the hash.
+ *	The vertices are hashed in the space they are in, only meshes in their own space, e.g. of an instanced import, match at other places.
+ */
+struct FMeshGeometryHash
+{
+    /**
+     * CityHash64 over the quantized positions, the quantized UV0 and the triangles of all sections and LODs, never 0.
+     * The materials are not part of it, the same part can use other materials in other files.
+     * @param precision		The grid the positions are rounded to
+     */
+    static int64 HashMeshInfo(const FRuntimeMeshImportMeshInfo& meshInfo, const float precision);
+
+    // Whether the sections of both meshes use the same materials, so one can be drawn as an instance of the other
+    static bool HasSameMaterials(const FRuntimeMeshImportMeshInfo& meshInfo, const FRuntimeMeshImportMeshInfo& otherMeshInfo);
+};
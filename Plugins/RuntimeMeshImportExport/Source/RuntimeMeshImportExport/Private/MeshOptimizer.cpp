@@ -0,0 +1,423 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "MeshOptimizer.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+namespace
+{
+    template<typename T>
+    void RemapStream(TArray<T>& stream, const TArray<int32>& usedVertices, const int32 numVertices, const int32 stride)
+    {
+        if (stride <= 0 || stream.Num() != numVertices * stride)
+        {
+            stream.Empty();
+            return;
+        }
+        TArray<T> remapped;
+        remapped.SetNumUninitialized(usedVertices.Num() * stride);
+        for (int32 vertex = 0; vertex < usedVertices.Num(); ++vertex)
+        {
+            for (int32 element = 0; element < stride; ++element)
+            {
+                remapped[vertex * stride + element] = stream[usedVertices[vertex] * stride + element];
+            }
+        }
+        stream = MoveTemp(remapped);
+    }
+
+    void RemapAllStreams(FRuntimeMeshImportSectionInfo& section, const TArray<int32>& usedVertices)
+    {
+        const int32 numVertices = section.vertices.Num();
+        RemapStream(section.vertices, usedVertices, numVertices, 1);
+        RemapStream(section.normals, usedVertices, numVertices, 1);
+        RemapStream(section.tangents, usedVertices, numVertices, 1);
+        RemapStream(section.uv0, usedVertices, numVertices, 1);
+        RemapStream(section.uv1, usedVertices, numVertices, 1);
+        RemapStream(section.vertexColors, usedVertices, numVertices, 1);
+        RemapStream(section.boneIndices, usedVertices, numVertices, section.numBoneInfluences);
+        RemapStream(section.boneWeights, usedVertices, numVertices, section.numBoneInfluences);
+        section.numBoneInfluences = section.boneIndices.Num() > 0 ? section.numBoneInfluences : 0;
+        FRuntimeMeshImportMorphTarget::Remap(section.morphTargets, usedVertices, numVertices);
+    }
+
+    // Cells of the weld grid. Clamped, so far away coordinates share the outer cells instead of overflowing.
+    FIntVector GetWeldCell(const FVector& position, const float cellSize)
+    {
+        const float maxCell = float(1 << 30);
+        return FIntVector(
+            FMath::FloorToInt(FMath::Clamp(position.X / cellSize, -maxCell, maxCell)),
+            FMath::FloorToInt(FMath::Clamp(position.Y / cellSize, -maxCell, maxCell)),
+            FMath::FloorToInt(FMath::Clamp(position.Z / cellSize, -maxCell, maxCell)));
+    }
+}
+
+void FMeshOptimizer::OptimizeVertexCache(TArray<int32>& indices, const int32 numVertices, const int32 cacheSize, TArray<int32>* outClusterStarts)
+{
+    const int32 numTriangles = indices.Num() / 3;
+    if (outClusterStarts)
+    {
+        outClusterStarts->Reset();
+    }
+    if (numTriangles == 0)
+    {
+        return;
+    }
+
+    // The triangles of each vertex in one array
+    TArray<int32> triangleOffsets;
+    triangleOffsets.SetNumZeroed(numVertices + 1);
+    for (int32 index = 0; index < numTriangles * 3; ++index)
+    {
+        ++triangleOffsets[indices[index] + 1];
+    }
+    for (int32 vertex = 0; vertex < numVertices; ++vertex)
+    {
+        triangleOffsets[vertex + 1] += triangleOffsets[vertex];
+    }
+    TArray<int32> vertexTriangles;
+    vertexTriangles.SetNumUninitialized(numTriangles * 3);
+    {
+        TArray<int32> nextSlot(triangleOffsets.GetData(), numVertices);
+        for (int32 index = 0; index < numTriangles * 3; ++index)
+        {
+            vertexTriangles[nextSlot[indices[index]]++] = index / 3;
+        }
+    }
+
+    // Not emitted triangles per vertex
+    TArray<int32> liveTriangles;
+    liveTriangles.SetNumUninitialized(numVertices);
+    for (int32 vertex = 0; vertex < numVertices; ++vertex)
+    {
+        liveTriangles[vertex] = triangleOffsets[vertex + 1] - triangleOffsets[vertex];
+    }
+
+    TArray<int32> cacheTimes;
+    cacheTimes.SetNumZeroed(numVertices);
+    TArray<uint8> emitted;
+    emitted.SetNumZeroed(numTriangles);
+    TArray<int32> deadEnds;
+    TArray<int32> candidates;
+    TArray<int32> optimized;
+    optimized.Reserve(numTriangles * 3);
+
+    int32 time = cacheSize + 1;
+    int32 cursor = 0;
+    int32 fanningVertex = 0;
+    // The first fan starts a cluster
+    bool bNewCluster = true;
+    while (fanningVertex >= 0)
+    {
+        candidates.Reset();
+        for (int32 slot = triangleOffsets[fanningVertex]; slot < triangleOffsets[fanningVertex + 1]; ++slot)
+        {
+            const int32 triangle = vertexTriangles[slot];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            if (bNewCluster && outClusterStarts)
+            {
+                outClusterStarts->Add(optimized.Num() / 3);
+            }
+            bNewCluster = false;
+
+            for (int32 corner = 0; corner < 3; ++corner)
+            {
+                const int32 vertex = indices[triangle * 3 + corner];
+                optimized.Add(vertex);
+                deadEnds.Add(vertex);
+                candidates.Add(vertex);
+                --liveTriangles[vertex];
+                if (time - cacheTimes[vertex] > cacheSize)
+                {
+                    cacheTimes[vertex] = time++;
+                }
+            }
+            emitted[triangle] = 1;
+        }
+
+        // The candidate that is still in the cache after its remaining triangles are emitted, the oldest one first
+        int32 nextVertex = INDEX_NONE;
+        int32 bestPriority = -1;
+        for (const int32 vertex : candidates)
+        {
+            if (liveTriangles[vertex] <= 0)
+            {
+                continue;
+            }
+            int32 priority = 0;
+            if (time - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+            {
+                priority = time - cacheTimes[vertex];
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVertex = vertex;
+            }
+        }
+
+        if (nextVertex == INDEX_NONE)
+        {
+            // Dead end, continue with a recently used vertex or the next vertex in input order
+            while (deadEnds.Num() > 0 && nextVertex == INDEX_NONE)
+            {
+                const int32 vertex = deadEnds.Pop(false);
+                nextVertex = liveTriangles[vertex] > 0 ? vertex : INDEX_NONE;
+            }
+            while (nextVertex == INDEX_NONE && cursor < numVertices)
+            {
+                nextVertex = liveTriangles[cursor] > 0 ? cursor : INDEX_NONE;
+                ++cursor;
+            }
+            bNewCluster = true;
+        }
+        fanningVertex = nextVertex;
+    }
+
+    check(optimized.Num() == numTriangles * 3);
+    FMemory::Memcpy(indices.GetData(), optimized.GetData(), optimized.Num() * sizeof(int32));
+}
+
+void FMeshOptimizer::OptimizeOverdraw(TArray<int32>& indices, const TArray<FVector>& vertices, const TArray<int32>& clusterStarts)
+{
+    const int32 numTriangles = indices.Num() / 3;
+    const int32 numClusters = clusterStarts.Num();
+    if (numClusters < 2)
+    {
+        return;
+    }
+
+    // The area weighted centroid and normal of each cluster
+    TArray<FVector> clusterCentroids;
+    TArray<FVector> clusterNormals;
+    clusterCentroids.SetNumZeroed(numClusters);
+    clusterNormals.SetNumZeroed(numClusters);
+    FVector meshCentroid = FVector::ZeroVector;
+    float meshArea = 0.f;
+    for (int32 cluster = 0; cluster < numClusters; ++cluster)
+    {
+        const int32 lastTriangle = cluster + 1 < numClusters ? clusterStarts[cluster + 1] : numTriangles;
+        float clusterArea = 0.f;
+        for (int32 triangle = clusterStarts[cluster]; triangle < lastTriangle; ++triangle)
+        {
+            const FVector& p0 = vertices[indices[triangle * 3]];
+            const FVector& p1 = vertices[indices[triangle * 3 + 1]];
+            const FVector& p2 = vertices[indices[triangle * 3 + 2]];
+            const FVector cross = FVector::CrossProduct(p1 - p0, p2 - p0);
+            const float area = cross.Size();
+            clusterCentroids[cluster] += (p0 + p1 + p2) * (area / 3.f);
+            clusterNormals[cluster] += cross;
+            clusterArea += area;
+        }
+        meshCentroid += clusterCentroids[cluster];
+        meshArea += clusterArea;
+        clusterCentroids[cluster] = clusterArea > 0.f ? clusterCentroids[cluster] / clusterArea : vertices[indices[clusterStarts[cluster] * 3]];
+    }
+    meshCentroid = meshArea > 0.f ? meshCentroid / meshArea : FVector::ZeroVector;
+
+    // The winding of the import decides if the cross products point outwards. Over the whole mesh most of them face away from the center.
+    TArray<float> clusterSort;
+    clusterSort.SetNumUninitialized(numClusters);
+    float totalFacing = 0.f;
+    for (int32 cluster = 0; cluster < numClusters; ++cluster)
+    {
+        clusterSort[cluster] = FVector::DotProduct(clusterCentroids[cluster] - meshCentroid, clusterNormals[cluster]);
+        totalFacing += clusterSort[cluster];
+    }
+    const float facingSign = totalFacing < 0.f ? -1.f : 1.f;
+
+    TArray<int32> clusterOrder;
+    clusterOrder.SetNumUninitialized(numClusters);
+    for (int32 cluster = 0; cluster < numClusters; ++cluster)
+    {
+        clusterOrder[cluster] = cluster;
+    }
+    // Stable, so clusters that face the same way keep their cache friendly order
+    clusterOrder.StableSort([&clusterSort, facingSign](const int32 a, const int32 b)
+    {
+        return clusterSort[a] * facingSign > clusterSort[b] * facingSign;
+    });
+
+    TArray<int32> sorted;
+    sorted.Reserve(indices.Num());
+    for (const int32 cluster : clusterOrder)
+    {
+        const int32 lastTriangle = cluster + 1 < numClusters ? clusterStarts[cluster + 1] : numTriangles;
+        sorted.Append(indices.GetData() + clusterStarts[cluster] * 3, (lastTriangle - clusterStarts[cluster]) * 3);
+    }
+    indices = MoveTemp(sorted);
+}
+
+int32 FMeshOptimizer::WeldVertices(FRuntimeMeshImportSectionInfo& section, const float positionTolerance, const float normalTolerance, const float uvTolerance)
+{
+    const int32 numVertices = section.vertices.Num();
+    if (numVertices < 2)
+    {
+        return 0;
+    }
+
+    const bool bHasNormals = section.normals.Num() == numVertices;
+    const bool bHasTangents = section.tangents.Num() == numVertices;
+    const bool bHasUVs = section.uv0.Num() == numVertices;
+    const bool bHasLightmapUVs = section.uv1.Num() == numVertices;
+    const bool bHasColors = section.vertexColors.Num() == numVertices;
+    const int32 numBoneInfluences = section.boneIndices.Num() == numVertices * section.numBoneInfluences ? section.numBoneInfluences : 0;
+    // The vertices a morph target moves are kept apart, their welded copies could move differently
+    TBitArray<> morphedVertices(false, section.morphTargets.Num() > 0 ? numVertices : 0);
+    for (const FRuntimeMeshImportMorphTarget& target : section.morphTargets)
+    {
+        for (const int32 vertex : target.vertexIndices)
+        {
+            morphedVertices[vertex] = true;
+        }
+    }
+    const auto canWeld = [&](const int32 a, const int32 b)
+    {
+        return (morphedVertices.Num() == 0 || (!morphedVertices[a] && !morphedVertices[b]))
+            && FVector::DistSquared(section.vertices[a], section.vertices[b]) <= positionTolerance * positionTolerance
+            && (!bHasNormals || FVector::DistSquared(section.normals[a], section.normals[b]) <= normalTolerance * normalTolerance)
+            && (!bHasTangents || FVector::DistSquared(section.tangents[a], section.tangents[b]) <= normalTolerance * normalTolerance)
+            && (!bHasUVs || FVector2D::DistSquared(section.uv0[a], section.uv0[b]) <= uvTolerance * uvTolerance)
+            && (!bHasLightmapUVs || FVector2D::DistSquared(section.uv1[a], section.uv1[b]) <= uvTolerance * uvTolerance)
+            && (!bHasColors || section.vertexColors[a] == section.vertexColors[b])
+            && (numBoneInfluences == 0
+                || (FMemory::Memcmp(&section.boneIndices[a * numBoneInfluences], &section.boneIndices[b * numBoneInfluences], numBoneInfluences * sizeof(uint16)) == 0
+                    && FMemory::Memcmp(&section.boneWeights[a * numBoneInfluences], &section.boneWeights[b * numBoneInfluences], numBoneInfluences) == 0));
+    };
+
+    // The kept vertices of each cell as a linked list. A vertex within the tolerance is at most one cell away.
+    const float cellSize = FMath::Max(positionTolerance, 0.001f);
+    TMap<FIntVector, int32> cellHeads;
+    cellHeads.Reserve(numVertices);
+    TArray<int32> nextInCell;
+    nextInCell.SetNumUninitialized(numVertices);
+    TArray<int32> newVertexIndices;
+    newVertexIndices.SetNumUninitialized(numVertices);
+    TArray<int32> usedVertices;
+    usedVertices.Reserve(numVertices);
+    for (int32 vertex = 0; vertex < numVertices; ++vertex)
+    {
+        const FIntVector cell = GetWeldCell(section.vertices[vertex], cellSize);
+        int32 weldedTo = INDEX_NONE;
+        for (int32 neighbour = 0; neighbour < 27 && weldedTo == INDEX_NONE; ++neighbour)
+        {
+            const FIntVector neighbourCell = cell + FIntVector(neighbour % 3 - 1, neighbour / 3 % 3 - 1, neighbour / 9 - 1);
+            const int32* head = cellHeads.Find(neighbourCell);
+            for (int32 candidate = head ? *head : INDEX_NONE; candidate != INDEX_NONE; candidate = nextInCell[candidate])
+            {
+                if (canWeld(vertex, candidate))
+                {
+                    weldedTo = candidate;
+                    break;
+                }
+            }
+        }
+
+        if (weldedTo != INDEX_NONE)
+        {
+            newVertexIndices[vertex] = newVertexIndices[weldedTo];
+            continue;
+        }
+        newVertexIndices[vertex] = usedVertices.Add(vertex);
+        int32& head = cellHeads.FindOrAdd(cell, INDEX_NONE);
+        nextInCell[vertex] = head;
+        head = vertex;
+    }
+
+    const int32 numWelded = numVertices - usedVertices.Num();
+    if (numWelded == 0)
+    {
+        return 0;
+    }
+
+    // With a tolerance the corners of small triangles can weld together
+    int32 numKept = 0;
+    const int32 numTriangles = section.triangles.Num() / 3;
+    for (int32 triangle = 0; triangle < numTriangles; ++triangle)
+    {
+        const int32 a = newVertexIndices[section.triangles[triangle * 3]];
+        const int32 b = newVertexIndices[section.triangles[triangle * 3 + 1]];
+        const int32 c = newVertexIndices[section.triangles[triangle * 3 + 2]];
+        if (a == b || b == c || a == c)
+        {
+            continue;
+        }
+        section.triangles[numKept * 3] = a;
+        section.triangles[numKept * 3 + 1] = b;
+        section.triangles[numKept * 3 + 2] = c;
+        ++numKept;
+    }
+    section.triangles.SetNum(numKept * 3);
+
+    RemapAllStreams(section, usedVertices);
+    return numWelded;
+}
+
+int32 FMeshOptimizer::RemoveDegenerateTriangles(FRuntimeMeshImportSectionInfo& section, const float areaTolerance)
+{
+    // The cross product is twice the area
+    const float crossTolerance = 2.f * areaTolerance;
+    int32 numKept = 0;
+    const int32 numTriangles = section.triangles.Num() / 3;
+    for (int32 triangle = 0; triangle < numTriangles; ++triangle)
+    {
+        const int32 a = section.triangles[triangle * 3];
+        const int32 b = section.triangles[triangle * 3 + 1];
+        const int32 c = section.triangles[triangle * 3 + 2];
+        if (a == b || b == c || a == c)
+        {
+            continue;
+        }
+        const FVector cross = (section.vertices[b] - section.vertices[a]) ^ (section.vertices[c] - section.vertices[a]);
+        if (cross.SizeSquared() <= crossTolerance * crossTolerance)
+        {
+            continue;
+        }
+        section.triangles[numKept * 3] = a;
+        section.triangles[numKept * 3 + 1] = b;
+        section.triangles[numKept * 3 + 2] = c;
+        ++numKept;
+    }
+    section.triangles.SetNum(numKept * 3);
+    return numTriangles - numKept;
+}
+
+void FMeshOptimizer::OptimizeVertexFetch(FRuntimeMeshImportSectionInfo& section)
+{
+    TArray<int32> newVertexIndices;
+    newVertexIndices.Init(INDEX_NONE, section.vertices.Num());
+    TArray<int32> usedVertices;
+    usedVertices.Reserve(section.vertices.Num());
+    for (int32& index : section.triangles)
+    {
+        int32& newVertexIndex = newVertexIndices[index];
+        if (newVertexIndex == INDEX_NONE)
+        {
+            newVertexIndex = usedVertices.Add(index);
+        }
+        index = newVertexIndex;
+    }
+
+    RemapAllStreams(section, usedVertices);
+}
+
+void FMeshOptimizer::OptimizeSection(FRuntimeMeshImportSectionInfo& section, const int32 cacheSize, const bool bOptimizeOverdraw)
+{
+    if (section.triangles.Num() < 3)
+    {
+        return;
+    }
+    section.triangles.SetNum(section.triangles.Num() - section.triangles.Num() % 3);
+
+    TArray<int32> clusterStarts;
+    OptimizeVertexCache(section.triangles, section.vertices.Num(), FMath::Max(cacheSize, 3), bOptimizeOverdraw ? &clusterStarts : nullptr);
+    if (bOptimizeOverdraw)
+    {
+        OptimizeOverdraw(section.triangles, section.vertices, clusterStarts);
+    }
+    OptimizeVertexFetch(section);
+}
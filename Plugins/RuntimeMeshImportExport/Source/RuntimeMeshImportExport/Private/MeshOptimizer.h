@@ -0,0 +1,42 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRuntimeMeshImportSectionInfo;
+
+/**
+ *	Welds the vertices of a section and reorders its triangles and vertices for the GPU.
+ *	The vertex cache order is Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"),
+ *	the overdraw pass sorts its triangle clusters so that the ones facing outwards are drawn first.
+ */
+struct FMeshOptimizer
+{
+    /**
+     * Reorders the triangles of 'indices' for a post transform cache with 'cacheSize' entries.
+     * @param outClusterStarts	Optional, the first triangle of each cluster that the overdraw pass can move as a whole
+     */
+    static void OptimizeVertexCache(TArray<int32>& indices, const int32 numVertices, const int32 cacheSize, TArray<int32>* outClusterStarts = nullptr);
+
+    // Sorts the clusters of OptimizeVertexCache by how much they face away from the center of the section
+    static void OptimizeOverdraw(TArray<int32>& indices, const TArray<FVector>& vertices, const TArray<int32>& clusterStarts);
+
+    // Orders the vertices by their first use in the triangles and removes unused ones. All vertex streams are remapped.
+    static void OptimizeVertexFetch(FRuntimeMeshImportSectionInfo& section);
+
+    /**
+     * Merges vertices whose positions, normals, tangents and UVs are within the tolerances and whose colors and bone influences are equal.
+     * Candidates are found with a spatial hash grid of the position tolerance. Triangles that collapse are removed.
+     * Returns the number of removed vertices.
+     */
+    static int32 WeldVertices(FRuntimeMeshImportSectionInfo& section, const float positionTolerance, const float normalTolerance, const float uvTolerance);
+
+    // Removes the triangles with repeated corners or an area of at most 'areaTolerance'. Returns the number of removed triangles.
+    static int32 RemoveDegenerateTriangles(FRuntimeMeshImportSectionInfo& section, const float areaTolerance);
+
+    // The three ordering passes in order
+    static void OptimizeSection(FRuntimeMeshImportSectionInfo& section, const int32 cacheSize, const bool bOptimizeOverdraw);
+};
@@ -0,0 +1,263 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "MeshSectionSplitter.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "MeshConversionKernels.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // Triangle centers computed per work item
+    const int32 centerBlockSize = 16384;
+
+    // A range of the triangle order, the triangles of a chunk once the range is within the limits
+    struct FSplitRange
+    {
+        int32 begin = 0;
+        int32 end = 0;
+    };
+
+    struct FSplitChunk
+    {
+        FSplitRange range;
+        // The vertices of the section the triangles use, ascending
+        TArray<int32> usedVertices;
+    };
+
+    struct FSplitContext
+    {
+        const FRuntimeMeshImportSectionInfo& section;
+        int32 maxVertices;
+        int32 maxTriangles;
+        TArray<FVector> centers;
+        TArray<int32> order;
+
+        FSplitContext(const FRuntimeMeshImportSectionInfo& inSection, const int32 inMaxVertices, const int32 inMaxTriangles)
+            : section(inSection)
+            , maxVertices(inMaxVertices)
+            , maxTriangles(inMaxTriangles)
+        {
+        }
+    };
+
+    void GetUsedVertices(const FSplitContext& context, const FSplitRange& range, TArray<int32>& outVertices)
+    {
+        const TArray<int32>& triangles = context.section.triangles;
+        outVertices.Reset((range.end - range.begin) * 3);
+        for (int32 i = range.begin; i < range.end; ++i)
+        {
+            const int32 triangle = context.order[i];
+            outVertices.Add(triangles[triangle * 3]);
+            outVertices.Add(triangles[triangle * 3 + 1]);
+            outVertices.Add(triangles[triangle * 3 + 2]);
+        }
+        Algo::Sort(outVertices);
+
+        int32 numUnique = 0;
+        for (int32 i = 0; i < outVertices.Num(); ++i)
+        {
+            if (numUnique == 0 || outVertices[numUnique - 1] != outVertices[i])
+            {
+                outVertices[numUnique++] = outVertices[i];
+            }
+        }
+        outVertices.SetNum(numUnique, false);
+    }
+
+    /**
+     * Sorts the range by the triangle centers along the longest axis of their bounds and returns the first triangle of the right side.
+     * Both sides get whole chunks worth of triangles, so a range of 2.5 times the limit ends in three chunks, not four small ones.
+     */
+    int32 SplitRange(FSplitContext& context, const FSplitRange& range)
+    {
+        FBox centerBounds(ForceInit);
+        for (int32 i = range.begin; i < range.end; ++i)
+        {
+            centerBounds += context.centers[context.order[i]];
+        }
+        const FVector size = centerBounds.GetSize();
+        const int32 axis = size.X >= size.Y && size.X >= size.Z ? 0 : (size.Y >= size.Z ? 1 : 2);
+
+        const TArray<FVector>& centers = context.centers;
+        TArrayView<int32> triangles(context.order.GetData() + range.begin, range.end - range.begin);
+        Algo::Sort(triangles, [&centers, axis](const int32 a, const int32 b) {
+            return centers[a][axis] < centers[b][axis];
+        });
+
+        const int32 numTriangles = range.end - range.begin;
+        const int32 numChunks = FMath::DivideAndRoundUp(numTriangles, context.maxTriangles);
+        // A range that is only over the vertex limit is halved
+        const int32 numLeft = numChunks > 1 ? int32(int64(numTriangles) * (numChunks / 2) / numChunks) : numTriangles / 2;
+        return range.begin + FMath::Clamp(numLeft, 1, numTriangles - 1);
+    }
+
+    template<typename T>
+    void GatherStream(const TArray<T>& source, const TArray<int32>& usedVertices, const int32 numVertices, const int32 stride, TArray<T>& outStream)
+    {
+        outStream.Empty();
+        if (stride <= 0 || source.Num() != numVertices * stride)
+        {
+            return;
+        }
+        outStream.SetNumUninitialized(usedVertices.Num() * stride);
+        for (int32 vertex = 0; vertex < usedVertices.Num(); ++vertex)
+        {
+            for (int32 element = 0; element < stride; ++element)
+            {
+                outStream[vertex * stride + element] = source[usedVertices[vertex] * stride + element];
+            }
+        }
+    }
+
+    // The deltas of the used vertices. Unlike FRuntimeMeshImportMorphTarget::Remap no source vertex is split, so a binary search is enough.
+    void GatherMorphTargets(const TArray<FRuntimeMeshImportMorphTarget>& targets, const TArray<int32>& usedVertices, TArray<FRuntimeMeshImportMorphTarget>& outTargets)
+    {
+        outTargets.Empty();
+        for (const FRuntimeMeshImportMorphTarget& target : targets)
+        {
+            const bool bNormals = target.normalDeltas.Num() > 0;
+            FRuntimeMeshImportMorphTarget chunkTarget;
+            for (int32 delta = 0; delta < target.vertexIndices.Num(); ++delta)
+            {
+                const int32 vertex = Algo::BinarySearch(usedVertices, target.vertexIndices[delta]);
+                if (vertex == INDEX_NONE)
+                {
+                    continue;
+                }
+                chunkTarget.vertexIndices.Add(vertex);
+                chunkTarget.positionDeltas.Add(target.positionDeltas[delta]);
+                if (bNormals)
+                {
+                    chunkTarget.normalDeltas.Add(target.normalDeltas[delta]);
+                }
+            }
+            if (chunkTarget.vertexIndices.Num() > 0)
+            {
+                chunkTarget.name = target.name;
+                outTargets.Add(MoveTemp(chunkTarget));
+            }
+        }
+    }
+
+    void GatherChunk(const FSplitContext& context, const FSplitChunk& chunk, FRuntimeMeshImportSectionInfo& outSection)
+    {
+        const FRuntimeMeshImportSectionInfo& section = context.section;
+        const TArray<int32>& usedVertices = chunk.usedVertices;
+        const int32 numVertices = section.vertices.Num();
+
+        outSection.materialName = section.materialName;
+        outSection.materialIndex = section.materialIndex;
+        outSection.triangles.SetNumUninitialized((chunk.range.end - chunk.range.begin) * 3);
+        int32* outIndex = outSection.triangles.GetData();
+        for (int32 i = chunk.range.begin; i < chunk.range.end; ++i)
+        {
+            const int32 triangle = context.order[i];
+            for (int32 corner = 0; corner < 3; ++corner)
+            {
+                *outIndex++ = Algo::LowerBound(usedVertices, section.triangles[triangle * 3 + corner]);
+            }
+        }
+
+        GatherStream(section.vertices, usedVertices, numVertices, 1, outSection.vertices);
+        outSection.bounds = FMeshConversionKernels::ComputeBounds(outSection.vertices.GetData(), outSection.vertices.Num());
+        GatherStream(section.normals, usedVertices, numVertices, 1, outSection.normals);
+        GatherStream(section.tangents, usedVertices, numVertices, 1, outSection.tangents);
+        GatherStream(section.uv0, usedVertices, numVertices, 1, outSection.uv0);
+        GatherStream(section.uv1, usedVertices, numVertices, 1, outSection.uv1);
+        GatherStream(section.vertexColors, usedVertices, numVertices, 1, outSection.vertexColors);
+        GatherStream(section.boneIndices, usedVertices, numVertices, section.numBoneInfluences, outSection.boneIndices);
+        GatherStream(section.boneWeights, usedVertices, numVertices, section.numBoneInfluences, outSection.boneWeights);
+        outSection.numBoneInfluences = outSection.boneIndices.Num() > 0 ? section.numBoneInfluences : 0;
+        GatherMorphTargets(section.morphTargets, usedVertices, outSection.morphTargets);
+    }
+}
+
+bool FMeshSectionSplitter::NeedsSplit(const FRuntimeMeshImportSectionInfo& section, const int32 maxVertices, const int32 maxTriangles)
+{
+    return section.triangles.Num() >= 6 && (section.vertices.Num() > maxVertices || section.triangles.Num() / 3 > maxTriangles);
+}
+
+void FMeshSectionSplitter::Split(const FRuntimeMeshImportSectionInfo& section, const int32 maxVertices, const int32 maxTriangles, const bool bParallel
+    , TArray<FRuntimeMeshImportSectionInfo>& outChunks)
+{
+    // A single triangle has to fit into a chunk
+    FSplitContext context(section, FMath::Max(maxVertices, 3), FMath::Max(maxTriangles, 1));
+    const int32 numTriangles = section.triangles.Num() / 3;
+    if (numTriangles == 0)
+    {
+        return;
+    }
+
+    context.centers.SetNumUninitialized(numTriangles);
+    context.order.SetNumUninitialized(numTriangles);
+    ParallelFor(FMath::DivideAndRoundUp(numTriangles, centerBlockSize), [&context, &section, numTriangles](int32 block)
+    {
+        const int32 end = FMath::Min((block + 1) * centerBlockSize, numTriangles);
+        for (int32 triangle = block * centerBlockSize; triangle < end; ++triangle)
+        {
+            const FVector& a = section.vertices[section.triangles[triangle * 3]];
+            const FVector& b = section.vertices[section.triangles[triangle * 3 + 1]];
+            const FVector& c = section.vertices[section.triangles[triangle * 3 + 2]];
+            context.centers[triangle] = (a + b + c) * (1.f / 3.f);
+            context.order[triangle] = triangle;
+        }
+    }, !bParallel);
+
+    // The ranges of a level are disjoint parts of the order, so they are decided and split in parallel
+    TArray<FSplitChunk> chunks;
+    TArray<FSplitRange> pending;
+    pending.Add(FSplitRange{ 0, numTriangles });
+    while (pending.Num() > 0)
+    {
+        TArray<FSplitChunk> levelChunks;
+        levelChunks.SetNum(pending.Num());
+        TArray<int32> splitIndices;
+        splitIndices.Init(INDEX_NONE, pending.Num());
+        ParallelFor(pending.Num(), [&context, &pending, &levelChunks, &splitIndices](int32 index)
+        {
+            const FSplitRange& range = pending[index];
+            const int32 rangeTriangles = range.end - range.begin;
+            if (rangeTriangles <= context.maxTriangles)
+            {
+                TArray<int32>& usedVertices = levelChunks[index].usedVertices;
+                GetUsedVertices(context, range, usedVertices);
+                if (usedVertices.Num() <= context.maxVertices || rangeTriangles == 1)
+                {
+                    levelChunks[index].range = range;
+                    return;
+                }
+                usedVertices.Empty();
+            }
+            splitIndices[index] = SplitRange(context, range);
+        }, !bParallel || pending.Num() == 1);
+
+        TArray<FSplitRange> nextPending;
+        for (int32 index = 0; index < pending.Num(); ++index)
+        {
+            if (splitIndices[index] == INDEX_NONE)
+            {
+                chunks.Add(MoveTemp(levelChunks[index]));
+            }
+            else
+            {
+                nextPending.Add(FSplitRange{ pending[index].begin, splitIndices[index] });
+                nextPending.Add(FSplitRange{ splitIndices[index], pending[index].end });
+            }
+        }
+        pending = MoveTemp(nextPending);
+    }
+
+    // In the order of the partition, neighboring chunks are close to each other
+    Algo::SortBy(chunks, [](const FSplitChunk& chunk) { return chunk.range.begin; });
+
+    const int32 firstChunk = outChunks.Num();
+    outChunks.SetNum(firstChunk + chunks.Num());
+    ParallelFor(chunks.Num(), [&context, &chunks, &outChunks, firstChunk](int32 index)
+    {
+        GatherChunk(context, chunks[index], outChunks[firstChunk + index]);
+    }, !bParallel);
+}
@@ -0,0 +1,26 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRuntimeMeshImportSectionInfo;
+
+/**
+ *	Splits large sections into spatially coherent chunks, @see FRuntimeMeshImportParam::bSplitLargeSections.
+ *	The triangles are partitioned by their centers along the longest axis until every chunk is within the limits.
+ *	The partitions of a level and the chunks are built in parallel. The vertices along the cuts are duplicated into both chunks.
+ */
+struct FMeshSectionSplitter
+{
+    static bool NeedsSplit(const FRuntimeMeshImportSectionInfo& section, const int32 maxVertices, const int32 maxTriangles);
+
+    /**
+     * Appends the chunks of 'section' to 'outChunks', in the order of the partition. They keep the material of 'section'.
+     * A chunk only gets the vertices its triangles use, in the order of 'section'. Only reads 'section'.
+     */
+    static void Split(const FRuntimeMeshImportSectionInfo& section, const int32 maxVertices, const int32 maxTriangles, const bool bParallel
+        , TArray<FRuntimeMeshImportSectionInfo>& outChunks);
+};
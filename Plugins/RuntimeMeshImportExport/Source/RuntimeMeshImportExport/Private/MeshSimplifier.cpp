@@ -0,0 +1,430 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "MeshSimplifier.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "MeshConversionKernels.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    // Symmetric 4x4 error matrix, the sum of the weighted squared distances to a set of planes
+    struct FQuadric
+    {
+        float a2 = 0.f, ab = 0.f, ac = 0.f, ad = 0.f;
+        float b2 = 0.f, bc = 0.f, bd = 0.f;
+        float c2 = 0.f, cd = 0.f;
+        float d2 = 0.f;
+
+        void AddPlane(const FVector& normal, const float distance, const float weight)
+        {
+            a2 += weight * normal.X * normal.X;
+            ab += weight * normal.X * normal.Y;
+            ac += weight * normal.X * normal.Z;
+            ad += weight * normal.X * distance;
+            b2 += weight * normal.Y * normal.Y;
+            bc += weight * normal.Y * normal.Z;
+            bd += weight * normal.Y * distance;
+            c2 += weight * normal.Z * normal.Z;
+            cd += weight * normal.Z * distance;
+            d2 += weight * distance * distance;
+        }
+
+        void operator+=(const FQuadric& other)
+        {
+            a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+            b2 += other.b2; bc += other.bc; bd += other.bd;
+            c2 += other.c2; cd += other.cd;
+            d2 += other.d2;
+        }
+
+        float Evaluate(const FVector& p) const
+        {
+            const float error = a2 * p.X * p.X + b2 * p.Y * p.Y + c2 * p.Z * p.Z
+                + 2.f * (ab * p.X * p.Y + ac * p.X * p.Z + bc * p.Y * p.Z + ad * p.X + bd * p.Y + cd * p.Z) + d2;
+            // Slightly negative from float rounding
+            return FMath::Abs(error);
+        }
+    };
+
+    enum class EVertexKind : uint8
+    {
+        Manifold,
+        // On an open edge, only collapses along it
+        Border,
+        // Seams, non manifold edges. Never removed.
+        Locked
+    };
+
+    struct FCollapse
+    {
+        int32 from;
+        int32 to;
+        float cost;
+    };
+
+    // The triangles of each vertex in one array
+    struct FVertexTriangles
+    {
+        TArray<int32> offsets;
+        TArray<int32> triangles;
+
+        void Build(const TArray<int32>& indices, const int32 numVertices)
+        {
+            offsets.Reset();
+            offsets.SetNumZeroed(numVertices + 1);
+            for (const int32 index : indices)
+            {
+                ++offsets[index + 1];
+            }
+            for (int32 vertex = 0; vertex < numVertices; ++vertex)
+            {
+                offsets[vertex + 1] += offsets[vertex];
+            }
+
+            TArray<int32> nextSlot(offsets.GetData(), numVertices);
+            triangles.SetNumUninitialized(indices.Num());
+            for (int32 index = 0; index < indices.Num(); ++index)
+            {
+                triangles[nextSlot[indices[index]]++] = index / 3;
+            }
+        }
+
+        TArrayView<const int32> Get(const int32 vertex) const
+        {
+            return MakeArrayView(triangles.GetData() + offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+        }
+    };
+
+    int32 CountTrianglesWithEdge(const FVertexTriangles& adjacency, const TArray<int32>& indices, const int32 a, const int32 b)
+    {
+        int32 count = 0;
+        for (const int32 triangle : adjacency.Get(a))
+        {
+            const int32* corners = &indices[triangle * 3];
+            count += (corners[0] == b || corners[1] == b || corners[2] == b) ? 1 : 0;
+        }
+        return count;
+    }
+
+    void ClassifyVertices(const TArray<int32>& indices, const FVertexTriangles& adjacency, const TArray<uint8>& seams, TArray<EVertexKind>& outKinds)
+    {
+        outKinds.SetNumUninitialized(seams.Num());
+        for (int32 vertex = 0; vertex < seams.Num(); ++vertex)
+        {
+            outKinds[vertex] = seams[vertex] ? EVertexKind::Locked : EVertexKind::Manifold;
+        }
+
+        for (int32 index = 0; index < indices.Num(); ++index)
+        {
+            const int32 a = indices[index];
+            const int32 b = indices[index - index % 3 + (index % 3 + 1) % 3];
+            const int32 numTriangles = CountTrianglesWithEdge(adjacency, indices, a, b);
+            if (numTriangles > 2)
+            {
+                outKinds[a] = EVertexKind::Locked;
+                outKinds[b] = EVertexKind::Locked;
+            }
+            else if (numTriangles == 1)
+            {
+                outKinds[a] = outKinds[a] == EVertexKind::Locked ? EVertexKind::Locked : EVertexKind::Border;
+                outKinds[b] = outKinds[b] == EVertexKind::Locked ? EVertexKind::Locked : EVertexKind::Border;
+            }
+        }
+    }
+
+    bool CanCollapse(const EVertexKind from, const EVertexKind to, const bool bBorderEdge)
+    {
+        switch (from)
+        {
+        case EVertexKind::Manifold:
+            return true;
+        case EVertexKind::Border:
+            return bBorderEdge && to != EVertexKind::Manifold;
+        default:
+            return false;
+        }
+    }
+
+    // The direction of the edge a, b that adds less error. 'from' is INDEX_NONE when the edge can not be collapsed.
+    FCollapse GetCheapestCollapse(const int32 a, const int32 b, const TArray<EVertexKind>& kinds, const TArray<FQuadric>& quadrics, const TArray<FVector>& positions
+        , const FVertexTriangles& adjacency, const TArray<int32>& indices)
+    {
+        FCollapse best = { INDEX_NONE, INDEX_NONE, MAX_flt };
+        const bool bBorderEdge = (kinds[a] == EVertexKind::Border || kinds[b] == EVertexKind::Border) && CountTrianglesWithEdge(adjacency, indices, a, b) == 1;
+        const int32 ends[2] = { a, b };
+        for (int32 direction = 0; direction < 2; ++direction)
+        {
+            const int32 from = ends[direction];
+            const int32 to = ends[1 - direction];
+            if (!CanCollapse(kinds[from], kinds[to], bBorderEdge))
+            {
+                continue;
+            }
+            const float cost = quadrics[from].Evaluate(positions[to]) + quadrics[to].Evaluate(positions[to]);
+            if (cost < best.cost)
+            {
+                best = { from, to, cost };
+            }
+        }
+        return best;
+    }
+
+    // True when moving 'from' onto 'to' turns one of the remaining triangles of 'from' by more than about 75 degrees
+    bool FlipsTriangles(const FVertexTriangles& adjacency, const TArray<int32>& indices, const TArray<int32>& remap, const TArray<FVector>& positions
+        , const int32 from, const int32 to)
+    {
+        for (const int32 triangle : adjacency.Get(from))
+        {
+            int32 corners[3];
+            for (int32 corner = 0; corner < 3; ++corner)
+            {
+                corners[corner] = remap[indices[triangle * 3 + corner]];
+            }
+            if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2])
+            {
+                // Already removed by an earlier collapse of this pass
+                continue;
+            }
+            if (corners[0] == to || corners[1] == to || corners[2] == to)
+            {
+                // Removed by this collapse
+                continue;
+            }
+
+            const FVector normal = FVector::CrossProduct(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+            if (normal.IsNearlyZero(0.f))
+            {
+                continue;
+            }
+            for (int32& corner : corners)
+            {
+                corner = corner == from ? to : corner;
+            }
+            const FVector collapsedNormal = FVector::CrossProduct(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+            if (FVector::DotProduct(normal, collapsedNormal) <= 0.25f * normal.Size() * collapsedNormal.Size())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template<typename T>
+    void GatherStream(const TArray<T>& source, const TArray<int32>& usedVertices, const int32 numVertices, const int32 stride, TArray<T>& outStream)
+    {
+        outStream.Empty();
+        if (stride <= 0 || source.Num() != numVertices * stride)
+        {
+            return;
+        }
+        outStream.SetNumUninitialized(usedVertices.Num() * stride);
+        for (int32 vertex = 0; vertex < usedVertices.Num(); ++vertex)
+        {
+            for (int32 element = 0; element < stride; ++element)
+            {
+                outStream[vertex * stride + element] = source[usedVertices[vertex] * stride + element];
+            }
+        }
+    }
+}
+
+void FMeshSimplifier::Simplify(const FRuntimeMeshImportSectionInfo& section, const int32 targetTriangles, FRuntimeMeshImportSectionInfo& outSection)
+{
+    check(&section != &outSection);
+    const int32 numVertices = section.vertices.Num();
+    if (numVertices == 0 || section.triangles.Num() / 3 <= targetTriangles)
+    {
+        outSection = section;
+        return;
+    }
+
+    TArray<int32> indices = section.triangles;
+    indices.SetNum(indices.Num() - indices.Num() % 3);
+    const int32 targetIndices = FMath::Max(targetTriangles, 0) * 3;
+
+    // In a unit box, so the errors of small and large meshes are in the same float range
+    const FBox bounds(section.vertices);
+    const float scale = 1.f / FMath::Max(bounds.GetSize().GetMax(), SMALL_NUMBER);
+    TArray<FVector> positions;
+    positions.SetNumUninitialized(numVertices);
+    for (int32 vertex = 0; vertex < numVertices; ++vertex)
+    {
+        positions[vertex] = (section.vertices[vertex] - bounds.Min) * scale;
+    }
+
+    // Vertices that share their position with another vertex split the attributes, the section would tear open when they move
+    TArray<uint8> seams;
+    seams.SetNumZeroed(numVertices);
+    {
+        TMap<FVector, int32> firstVertexAtPosition;
+        firstVertexAtPosition.Reserve(numVertices);
+        for (int32 vertex = 0; vertex < numVertices; ++vertex)
+        {
+            if (const int32* firstVertex = firstVertexAtPosition.Find(section.vertices[vertex]))
+            {
+                seams[*firstVertex] = 1;
+                seams[vertex] = 1;
+            }
+            else
+            {
+                firstVertexAtPosition.Add(section.vertices[vertex], vertex);
+            }
+        }
+    }
+
+    FVertexTriangles adjacency;
+    adjacency.Build(indices, numVertices);
+    TArray<EVertexKind> kinds;
+    ClassifyVertices(indices, adjacency, seams, kinds);
+
+    // The planes of the triangles around each vertex, weighted by area. Open edges add a perpendicular plane, so borders keep their shape.
+    TArray<FQuadric> quadrics;
+    quadrics.SetNum(numVertices);
+    for (int32 triangle = 0; triangle < indices.Num() / 3; ++triangle)
+    {
+        const int32* corners = &indices[triangle * 3];
+        const FVector cross = FVector::CrossProduct(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+        const float doubleArea = cross.Size();
+        if (doubleArea <= 0.f)
+        {
+            continue;
+        }
+        const FVector normal = cross / doubleArea;
+        const float distance = -FVector::DotProduct(normal, positions[corners[0]]);
+        for (int32 corner = 0; corner < 3; ++corner)
+        {
+            quadrics[corners[corner]].AddPlane(normal, distance, doubleArea * 0.5f);
+        }
+
+        for (int32 corner = 0; corner < 3; ++corner)
+        {
+            const int32 a = corners[corner];
+            const int32 b = corners[(corner + 1) % 3];
+            if (CountTrianglesWithEdge(adjacency, indices, a, b) != 1)
+            {
+                continue;
+            }
+            const FVector edge = positions[b] - positions[a];
+            const FVector borderNormal = FVector::CrossProduct(edge, normal).GetSafeNormal();
+            const float borderDistance = -FVector::DotProduct(borderNormal, positions[a]);
+            const float borderWeight = 10.f * edge.SizeSquared();
+            quadrics[a].AddPlane(borderNormal, borderDistance, borderWeight);
+            quadrics[b].AddPlane(borderNormal, borderDistance, borderWeight);
+        }
+    }
+
+    TArray<FCollapse> collapses;
+    TArray<int32> remap;
+    TArray<uint8> collapsedInPass;
+    for (int32 pass = 0; indices.Num() > targetIndices; ++pass)
+    {
+        if (pass > 0)
+        {
+            adjacency.Build(indices, numVertices);
+            ClassifyVertices(indices, adjacency, seams, kinds);
+        }
+
+        // The cost of every triangle edge, shared edges are evaluated twice
+        const int32 numTriangles = indices.Num() / 3;
+        collapses.SetNumUninitialized(indices.Num());
+        ParallelFor(numTriangles, [&](int32 triangle)
+        {
+            for (int32 corner = 0; corner < 3; ++corner)
+            {
+                const int32 a = indices[triangle * 3 + corner];
+                const int32 b = indices[triangle * 3 + (corner + 1) % 3];
+                collapses[triangle * 3 + corner] = GetCheapestCollapse(a, b, kinds, quadrics, positions, adjacency, indices);
+            }
+        });
+        collapses.RemoveAllSwap([](const FCollapse& collapse) { return collapse.from == INDEX_NONE; }, false);
+        if (collapses.Num() == 0)
+        {
+            break;
+        }
+        collapses.Sort([](const FCollapse& a, const FCollapse& b) { return a.cost < b.cost; });
+
+        // Each vertex takes part in one collapse per pass, so the adjacency stays valid during the pass.
+        // Only the cheaper half of the edges is collapsed, the others wait for the quadrics of the next pass.
+        remap.SetNumUninitialized(numVertices);
+        for (int32 vertex = 0; vertex < numVertices; ++vertex)
+        {
+            remap[vertex] = vertex;
+        }
+        collapsedInPass.Reset();
+        collapsedInPass.SetNumZeroed(numVertices);
+        const int32 trianglesToRemove = numTriangles - targetIndices / 3;
+        const int32 maxCollapses = FMath::Max(collapses.Num() / 2, 1);
+        int32 numRemoved = 0;
+        int32 numCollapsed = 0;
+        for (int32 collapseIndex = 0; collapseIndex < maxCollapses && numRemoved < trianglesToRemove; ++collapseIndex)
+        {
+            const FCollapse& collapse = collapses[collapseIndex];
+            if (collapsedInPass[collapse.from] || collapsedInPass[collapse.to]
+                || FlipsTriangles(adjacency, indices, remap, positions, collapse.from, collapse.to))
+            {
+                continue;
+            }
+            remap[collapse.from] = collapse.to;
+            collapsedInPass[collapse.from] = 1;
+            collapsedInPass[collapse.to] = 1;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            numRemoved += CountTrianglesWithEdge(adjacency, indices, collapse.from, collapse.to);
+            ++numCollapsed;
+        }
+        if (numCollapsed == 0)
+        {
+            break;
+        }
+
+        // Triangles that had a collapsed edge are degenerate now
+        int32 numKept = 0;
+        for (int32 triangle = 0; triangle < numTriangles; ++triangle)
+        {
+            const int32 a = remap[indices[triangle * 3]];
+            const int32 b = remap[indices[triangle * 3 + 1]];
+            const int32 c = remap[indices[triangle * 3 + 2]];
+            if (a == b || b == c || a == c)
+            {
+                continue;
+            }
+            indices[numKept * 3] = a;
+            indices[numKept * 3 + 1] = b;
+            indices[numKept * 3 + 2] = c;
+            ++numKept;
+        }
+        indices.SetNum(numKept * 3, false);
+    }
+
+    // Keep only the used vertices, in the order of their first use
+    TArray<int32> newVertexIndices;
+    newVertexIndices.Init(INDEX_NONE, numVertices);
+    TArray<int32> usedVertices;
+    outSection.triangles.SetNumUninitialized(indices.Num());
+    for (int32 index = 0; index < indices.Num(); ++index)
+    {
+        int32& newVertexIndex = newVertexIndices[indices[index]];
+        if (newVertexIndex == INDEX_NONE)
+        {
+            newVertexIndex = usedVertices.Add(indices[index]);
+        }
+        outSection.triangles[index] = newVertexIndex;
+    }
+
+    outSection.materialName = section.materialName;
+    outSection.materialIndex = section.materialIndex;
+    outSection.BoneInfo.Empty();
+    GatherStream(section.vertices, usedVertices, numVertices, 1, outSection.vertices);
+    outSection.bounds = FMeshConversionKernels::ComputeBounds(outSection.vertices.GetData(), outSection.vertices.Num());
+    GatherStream(section.normals, usedVertices, numVertices, 1, outSection.normals);
+    GatherStream(section.tangents, usedVertices, numVertices, 1, outSection.tangents);
+    GatherStream(section.uv0, usedVertices, numVertices, 1, outSection.uv0);
+    GatherStream(section.uv1, usedVertices, numVertices, 1, outSection.uv1);
+    GatherStream(section.vertexColors, usedVertices, numVertices, 1, outSection.vertexColors);
+    GatherStream(section.boneIndices, usedVertices, numVertices, section.numBoneInfluences, outSection.boneIndices);
+    GatherStream(section.boneWeights, usedVertices, numVertices, section.numBoneInfluences, outSection.boneWeights);
+    outSection.numBoneInfluences = outSection.boneIndices.Num() > 0 ? section.numBoneInfluences : 0;
+    outSection.morphTargets = section.morphTargets;
+    FRuntimeMeshImportMorphTarget::Remap(outSection.morphTargets, usedVertices, numVertices);
+}
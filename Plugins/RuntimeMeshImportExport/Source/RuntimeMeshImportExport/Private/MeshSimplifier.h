@@ -0,0 +1,24 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRuntimeMeshImportSectionInfo;
+
+/**
+ *	Simplifies sections by quadric edge collapse (Garland and Heckbert).
+ *	Vertices are only removed, never moved, so the remaining vertices keep all their attributes.
+ *	Borders only collapse along themselves, and vertices on UV or normal seams are kept, so the section does not tear open.
+ *	The collapses are done in passes over the cheapest independent edges, the edge costs of a pass are evaluated in parallel.
+ */
+struct FMeshSimplifier
+{
+    /**
+     * Simplifies 'section' towards 'targetTriangles'. Stops earlier when no edge can be collapsed anymore.
+     * 'outSection' only gets the vertices that are still used, in the order of their first use.
+     */
+    static void Simplify(const FRuntimeMeshImportSectionInfo& section, const int32 targetTriangles, FRuntimeMeshImportSectionInfo& outSection);
+};
@@ -0,0 +1,145 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "MeshTangentGenerator.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "mikktspace.h"
+
+namespace
+{
+    FRuntimeMeshImportSectionInfo& GetSection(const SMikkTSpaceContext* context)
+    {
+        return *static_cast<FRuntimeMeshImportSectionInfo*>(context->m_pUserData);
+    }
+
+    int32 GetCornerVertex(const SMikkTSpaceContext* context, const int32 face, const int32 corner)
+    {
+        return GetSection(context).triangles[face * 3 + corner];
+    }
+
+    int MikkGetNumFaces(const SMikkTSpaceContext* context)
+    {
+        return GetSection(context).triangles.Num() / 3;
+    }
+
+    int MikkGetNumVerticesOfFace(const SMikkTSpaceContext* context, const int face)
+    {
+        return 3;
+    }
+
+    void MikkGetPosition(const SMikkTSpaceContext* context, float outPosition[], const int face, const int corner)
+    {
+        const FVector& position = GetSection(context).vertices[GetCornerVertex(context, face, corner)];
+        outPosition[0] = position.X;
+        outPosition[1] = position.Y;
+        outPosition[2] = position.Z;
+    }
+
+    void MikkGetNormal(const SMikkTSpaceContext* context, float outNormal[], const int face, const int corner)
+    {
+        const FVector& normal = GetSection(context).normals[GetCornerVertex(context, face, corner)];
+        outNormal[0] = normal.X;
+        outNormal[1] = normal.Y;
+        outNormal[2] = normal.Z;
+    }
+
+    void MikkGetTexCoord(const SMikkTSpaceContext* context, float outUV[], const int face, const int corner)
+    {
+        const FVector2D& uv = GetSection(context).uv0[GetCornerVertex(context, face, corner)];
+        outUV[0] = uv.X;
+        outUV[1] = uv.Y;
+    }
+
+    void MikkSetTSpaceBasic(const SMikkTSpaceContext* context, const float tangent[], const float sign, const int face, const int corner)
+    {
+        GetSection(context).tangents[GetCornerVertex(context, face, corner)] = FVector(tangent[0], tangent[1], tangent[2]);
+    }
+}
+
+void FMeshTangentGenerator::GenerateSmoothNormals(FRuntimeMeshImportSectionInfo& section, const float smoothingAngle)
+{
+    const int32 numVertices = section.vertices.Num();
+    const int32 numTriangles = section.triangles.Num() / 3;
+
+    // The cross product is twice the area, so the sums are area weighted
+    TArray<FVector> faceNormals;
+    faceNormals.SetNumUninitialized(numTriangles);
+    TArray<FVector> vertexFaceNormals;
+    vertexFaceNormals.SetNumZeroed(numVertices);
+    for (int32 triangle = 0; triangle < numTriangles; ++triangle)
+    {
+        const int32* corners = &section.triangles[triangle * 3];
+        const FVector& p0 = section.vertices[corners[0]];
+        // The triangles are clockwise, as Unreal expects them
+        faceNormals[triangle] = FVector::CrossProduct(section.vertices[corners[2]] - p0, section.vertices[corners[1]] - p0);
+        for (int32 corner = 0; corner < 3; ++corner)
+        {
+            vertexFaceNormals[corners[corner]] += faceNormals[triangle];
+        }
+    }
+
+    // The vertices at the same position share the triangles around them
+    TMap<FVector, int32> positionToGroup;
+    TArray<int32> vertexGroups;
+    vertexGroups.SetNumUninitialized(numVertices);
+    for (int32 vertex = 0; vertex < numVertices; ++vertex)
+    {
+        vertexGroups[vertex] = positionToGroup.FindOrAdd(section.vertices[vertex], positionToGroup.Num());
+    }
+    TArray<TArray<int32, TInlineAllocator<8>>> groupTriangles;
+    groupTriangles.SetNum(positionToGroup.Num());
+    for (int32 triangle = 0; triangle < numTriangles; ++triangle)
+    {
+        for (int32 corner = 0; corner < 3; ++corner)
+        {
+            groupTriangles[vertexGroups[section.triangles[triangle * 3 + corner]]].AddUnique(triangle);
+        }
+    }
+
+    const float cosSmoothingAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(smoothingAngle, 0.f, 180.f)));
+    section.normals.SetNumUninitialized(numVertices);
+    for (int32 vertex = 0; vertex < numVertices; ++vertex)
+    {
+        const FVector ownNormal = vertexFaceNormals[vertex].GetSafeNormal();
+        FVector normal = FVector::ZeroVector;
+        for (const int32 triangle : groupTriangles[vertexGroups[vertex]])
+        {
+            if (FVector::DotProduct(faceNormals[triangle].GetSafeNormal(), ownNormal) >= cosSmoothingAngle)
+            {
+                normal += faceNormals[triangle];
+            }
+        }
+        section.normals[vertex] = normal.IsNearlyZero() ? ownNormal : normal.GetSafeNormal();
+    }
+}
+
+bool FMeshTangentGenerator::GenerateMikkTSpaceTangents(FRuntimeMeshImportSectionInfo& section)
+{
+    const int32 numVertices = section.vertices.Num();
+    if (section.normals.Num() != numVertices || section.uv0.Num() != numVertices || section.triangles.Num() < 3)
+    {
+        return false;
+    }
+
+    SMikkTSpaceInterface mikkInterface;
+    mikkInterface.m_getNumFaces = MikkGetNumFaces;
+    mikkInterface.m_getNumVerticesOfFace = MikkGetNumVerticesOfFace;
+    mikkInterface.m_getPosition = MikkGetPosition;
+    mikkInterface.m_getNormal = MikkGetNormal;
+    mikkInterface.m_getTexCoord = MikkGetTexCoord;
+    mikkInterface.m_setTSpaceBasic = MikkSetTSpaceBasic;
+    mikkInterface.m_setTSpace = nullptr;
+
+    SMikkTSpaceContext mikkContext;
+    mikkContext.m_pInterface = &mikkInterface;
+    mikkContext.m_pUserData = &section;
+
+    section.tangents.SetNumZeroed(numVertices);
+    if (!genTangSpaceDefault(&mikkContext))
+    {
+        section.tangents.Empty();
+        return false;
+    }
+    return true;
+}
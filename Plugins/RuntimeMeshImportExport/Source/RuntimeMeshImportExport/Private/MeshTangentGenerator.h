@@ -0,0 +1,28 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRuntimeMeshImportSectionInfo;
+
+/**
+ *	Generates the normals and tangents of a section after the import, instead of aiProcess_GenSmoothNormals and aiProcess_CalcTangentSpace.
+ *	The tangents are MikkTSpace, like the ones the engine builds for its meshes. @see FRuntimeMeshImportParam::bMikkTSpaceTangents
+ */
+struct FMeshTangentGenerator
+{
+    /**
+     * Sets the normal of each vertex to the area weighted normals of the triangles at its position,
+     * of those that are within 'smoothingAngle' degree of the triangles of the vertex itself. Overwrites existing normals.
+     */
+    static void GenerateSmoothNormals(FRuntimeMeshImportSectionInfo& section, const float smoothingAngle);
+
+    /**
+     * Generates the MikkTSpace tangents from the normals and UV0. Returns false when the section has neither.
+     * The sections store no bitangent sign, a vertex that is shared by triangles with a different basis keeps the tangent of its last corner.
+     */
+    static bool GenerateMikkTSpaceTangents(FRuntimeMeshImportSectionInfo& section);
+};
@@ -0,0 +1,240 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ *	Scanning of ASCII model and point files, shared by FRuntimeMeshTextScene and FRuntimeMeshImportPointCloudImporter.
+ *	Works on the bytes of a memory mapped file without allocating or copying, nothing reads past 'end'.
+ *	The files are split into chunks that start at a line, so the chunks can be parsed in parallel.
+ */
+struct FMeshTextParsing
+{
+    // The chunks are about this large
+    static const int32 defaultChunkSize = 4 * 1024 * 1024;
+
+    static bool IsBlank(const uint8 character)
+    {
+        return character == ' ' || character == '\t' || character == '\r';
+    }
+
+    static bool IsLineEnd(const uint8 character)
+    {
+        return character == '\n';
+    }
+
+    static bool IsDigit(const uint8 character)
+    {
+        return character >= '0' && character <= '9';
+    }
+
+    static void SkipBlanks(const uint8*& cursor, const uint8* end)
+    {
+        while (cursor < end && IsBlank(*cursor))
+        {
+            ++cursor;
+        }
+    }
+
+    // To the first character after the line break
+    static void SkipLine(const uint8*& cursor, const uint8* end)
+    {
+        while (cursor < end && !IsLineEnd(*cursor))
+        {
+            ++cursor;
+        }
+        if (cursor < end)
+        {
+            ++cursor;
+        }
+    }
+
+    static void SkipToken(const uint8*& cursor, const uint8* end)
+    {
+        while (cursor < end && !IsBlank(*cursor) && !IsLineEnd(*cursor))
+        {
+            ++cursor;
+        }
+    }
+
+    // Whether the token at 'cursor' is 'keyword', advances past it when it is
+    static bool MatchToken(const uint8*& cursor, const uint8* end, const ANSICHAR* keyword)
+    {
+        const uint8* read = cursor;
+        while (*keyword)
+        {
+            if (read >= end || *read != uint8(*keyword))
+            {
+                return false;
+            }
+            ++read;
+            ++keyword;
+        }
+        if (read < end && !IsBlank(*read) && !IsLineEnd(*read))
+        {
+            return false;
+        }
+        cursor = read;
+        return true;
+    }
+
+    // The rest of the line without the blanks around it
+    static FString ReadRestOfLine(const uint8*& cursor, const uint8* end)
+    {
+        SkipBlanks(cursor, end);
+        const uint8* start = cursor;
+        while (cursor < end && !IsLineEnd(*cursor))
+        {
+            ++cursor;
+        }
+        const uint8* last = cursor;
+        while (last > start && IsBlank(last[-1]))
+        {
+            --last;
+        }
+        const FUTF8ToTCHAR converted(reinterpret_cast<const ANSICHAR*>(start), int32(last - start));
+        return FString(converted.Length(), converted.Get());
+    }
+
+    // The token at 'cursor', after the blanks before it
+    static FString ReadToken(const uint8*& cursor, const uint8* end)
+    {
+        SkipBlanks(cursor, end);
+        const uint8* start = cursor;
+        SkipToken(cursor, end);
+        const FUTF8ToTCHAR converted(reinterpret_cast<const ANSICHAR*>(start), int32(cursor - start));
+        return FString(converted.Length(), converted.Get());
+    }
+
+    static bool ParseInt(const uint8*& cursor, const uint8* end, int64& outValue)
+    {
+        bool bNegative = false;
+        if (cursor < end && (*cursor == '-' || *cursor == '+'))
+        {
+            bNegative = *cursor == '-';
+            ++cursor;
+        }
+        if (cursor >= end || !IsDigit(*cursor))
+        {
+            return false;
+        }
+        int64 value = 0;
+        while (cursor < end && IsDigit(*cursor))
+        {
+            value = value * 10 + int64(*cursor - '0');
+            ++cursor;
+        }
+        outValue = bNegative ? -value : value;
+        return true;
+    }
+
+    /**
+     * Parses a decimal number, optionally with a fraction and an exponent. The digits are collected into one integer mantissa
+     * that is scaled by a single power of ten, so there is one multiplication per number instead of one per digit.
+     * Digits after the 19th only shift the exponent. Returns false, without advancing past the token, when there is no number.
+     */
+    static bool ParseFloat(const uint8*& cursor, const uint8* end, double& outValue)
+    {
+        const uint8* read = cursor;
+        bool bNegative = false;
+        if (read < end && (*read == '-' || *read == '+'))
+        {
+            bNegative = *read == '-';
+            ++read;
+        }
+        uint64 mantissa = 0;
+        int32 numDigits = 0;
+        int32 exponent = 0;
+        bool bHasDigits = false;
+        while (read < end && IsDigit(*read))
+        {
+            if (numDigits < 19)
+            {
+                mantissa = mantissa * 10 + uint64(*read - '0');
+                numDigits += mantissa > 0 ? 1 : 0;
+            }
+            else
+            {
+                ++exponent;
+            }
+            bHasDigits = true;
+            ++read;
+        }
+        if (read < end && *read == '.')
+        {
+            ++read;
+            while (read < end && IsDigit(*read))
+            {
+                if (numDigits < 19)
+                {
+                    mantissa = mantissa * 10 + uint64(*read - '0');
+                    numDigits += mantissa > 0 ? 1 : 0;
+                    --exponent;
+                }
+                bHasDigits = true;
+                ++read;
+            }
+        }
+        if (!bHasDigits)
+        {
+            return false;
+        }
+        if (read < end && (*read == 'e' || *read == 'E'))
+        {
+            const uint8* exponentStart = read;
+            ++read;
+            int64 fileExponent = 0;
+            if (ParseInt(read, end, fileExponent))
+            {
+                exponent += int32(FMath::Clamp<int64>(fileExponent, -400, 400));
+            }
+            else
+            {
+                read = exponentStart;
+            }
+        }
+        cursor = read;
+        const double value = double(mantissa) * PowerOfTen(exponent);
+        outValue = bNegative ? -value : value;
+        return true;
+    }
+
+    /**
+     * Splits 'data' into chunks of about 'chunkSize' bytes that end after a line break.
+     * 'outStarts' gets the start of each chunk followed by the end of the data.
+     */
+    static void SplitIntoLineChunks(TArrayView<const uint8> data, const int32 chunkSize, TArray<const uint8*>& outStarts)
+    {
+        outStarts.Reset();
+        const uint8* dataEnd = data.GetData() + data.Num();
+        for (const uint8* chunkStart = data.GetData(); chunkStart < dataEnd;)
+        {
+            outStarts.Add(chunkStart);
+            const uint8* chunkEnd = chunkStart + FMath::Min<int64>(chunkSize, dataEnd - chunkStart);
+            while (chunkEnd < dataEnd && !IsLineEnd(chunkEnd[-1]))
+            {
+                ++chunkEnd;
+            }
+            chunkStart = chunkEnd;
+        }
+        outStarts.Add(dataEnd);
+    }
+
+private:
+    static double PowerOfTen(const int32 exponent)
+    {
+        static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        if (exponent >= 0 && exponent < int32(UE_ARRAY_COUNT(powers)))
+        {
+            return powers[exponent];
+        }
+        if (exponent < 0 && -exponent < int32(UE_ARRAY_COUNT(powers)))
+        {
+            return 1.0 / powers[-exponent];
+        }
+        return FMath::Pow(10.0, double(exponent));
+    }
+};
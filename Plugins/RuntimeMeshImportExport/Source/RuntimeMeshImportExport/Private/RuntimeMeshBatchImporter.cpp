@@ -0,0 +1,196 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshBatchImporter.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshDeferredRelease.h"
+#include "Async/Async.h"
+#include "Misc/QueuedThreadPool.h"
+#include "HAL/FileManager.h"
+
+// Assimp uses a lot of stack for some formats
+const uint32 batchImportThreadStackSize = 1024 * 1024;
+
+void URuntimeMeshBatchImporter::BeginDestroy()
+{
+    // Waits for the running imports. Their results are dropped as the importer is gone.
+    DestroyThreadPool();
+    bIsImporting = false;
+
+    Super::BeginDestroy();
+}
+
+bool URuntimeMeshBatchImporter::ImportBatch_Async_Cpp(const TArray<FRuntimeMeshImportParam>& params, const FRuntimeMeshBatchImportParam& inBatchParam
+        , FRuntimeBatchImportFileFinished callbackFileFinished
+        , FRuntimeMeshImportExportProgressUpdate callbackProgress
+        , FRuntimeBatchImportFinished callbackFinished)
+{
+    check(IsInGameThread());
+
+    if (bIsImporting)
+    {
+        RMIE_LOG(Warning, "Already importing a batch!");
+        return false;
+    }
+
+    if (params.Num() == 0)
+    {
+        callbackFinished.ExecuteIfBound();
+        return true;
+    }
+
+    batchParam = inBatchParam;
+    batchParam.maxConcurrentImports = FMath::Max(batchParam.maxConcurrentImports, 1);
+    delegateFileFinished = callbackFileFinished;
+    delegateProgress = callbackProgress;
+    delegateFinished = callbackFinished;
+
+    pendingFiles.Reset(params.Num());
+    for (int32 fileIndex = 0; fileIndex < params.Num(); ++fileIndex)
+    {
+        FPendingFile& pendingFile = pendingFiles.AddDefaulted_GetRef();
+        pendingFile.fileIndex = fileIndex;
+        pendingFile.param = params[fileIndex];
+        if (batchParam.memoryBudgetMB > 0)
+        {
+            const FString filePath = URuntimeMeshImportExportLibrary::ResolveImportFilePath(params[fileIndex].file, params[fileIndex].pathType);
+            pendingFile.estimatedBytes = FMath::Max<int64>(IFileManager::Get().FileSize(*filePath), 0);
+        }
+    }
+    nextPendingIndex = 0;
+    numInFlight = 0;
+    bytesInFlight = 0;
+    numFinished = 0;
+    numTotal = params.Num();
+
+    threadPool = FQueuedThreadPool::Allocate();
+    const int32 numThreads = FMath::Min(batchParam.maxConcurrentImports, numTotal);
+    if (!threadPool->Create(numThreads, batchImportThreadStackSize, batchParam.bLowPriority ? TPri_BelowNormal : TPri_Normal))
+    {
+        RMIE_LOG(Error, "Failed to create the thread pool for the batch import.");
+        delete threadPool;
+        threadPool = nullptr;
+        return false;
+    }
+
+    bIsImporting = true;
+    delegateProgress.ExecuteIfBound(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ImportingFiles, 0, numTotal));
+    StartPendingImports();
+    return true;
+}
+
+bool URuntimeMeshBatchImporter::ImportBatch_Async(const TArray<FRuntimeMeshImportParam>& params, const FRuntimeMeshBatchImportParam& inBatchParam
+        , FRuntimeBatchImportFileFinishedDyn fileFinishedDelegate
+        , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
+        , FRuntimeBatchImportFinishedDyn finishedDelegate)
+{
+    FRuntimeBatchImportFileFinished fileFinishedDelegateRaw;
+    fileFinishedDelegateRaw.BindLambda([fileFinishedDelegate](const int32 fileIndex, FRuntimeMeshImportResultRef result) {
+        fileFinishedDelegate.ExecuteIfBound(fileIndex, *result);
+    });
+
+    FRuntimeMeshImportExportProgressUpdate progressDelegateRaw;
+    progressDelegateRaw.BindLambda([progressDelegate](const FRuntimeMeshImportExportProgress& progress) {
+        progressDelegate.ExecuteIfBound(progress);
+    });
+
+    FRuntimeBatchImportFinished finishedDelegateRaw;
+    finishedDelegateRaw.BindLambda([finishedDelegate]() {
+        finishedDelegate.ExecuteIfBound();
+    });
+
+    return ImportBatch_Async_Cpp(params, inBatchParam, fileFinishedDelegateRaw, progressDelegateRaw, finishedDelegateRaw);
+}
+
+bool URuntimeMeshBatchImporter::GetIsImporting() const
+{
+    return bIsImporting;
+}
+
+void URuntimeMeshBatchImporter::StartPendingImports()
+{
+    check(IsInGameThread());
+
+    const int64 memoryBudget = int64(batchParam.memoryBudgetMB) * 1024 * 1024;
+    while (nextPendingIndex < pendingFiles.Num() && numInFlight < batchParam.maxConcurrentImports)
+    {
+        FPendingFile& pendingFile = pendingFiles[nextPendingIndex];
+        // Always let one file through, even if it alone exceeds the budget
+        if (memoryBudget > 0 && numInFlight > 0 && bytesInFlight + pendingFile.estimatedBytes > memoryBudget)
+        {
+            break;
+        }
+
+        ++nextPendingIndex;
+        ++numInFlight;
+        bytesInFlight += pendingFile.estimatedBytes;
+
+        TWeakObjectPtr<URuntimeMeshBatchImporter> weakThis(this);
+        const int32 fileIndex = pendingFile.fileIndex;
+        const int64 estimatedBytes = pendingFile.estimatedBytes;
+        AsyncPool(*threadPool, [weakThis, fileIndex, estimatedBytes, param = MoveTemp(pendingFile.param)]()
+        {
+            FRuntimeMeshImportResultRef result = FRuntimeMeshDeferredRelease::MakeImportResult();
+            URuntimeMeshImportExportLibrary::ImportSceneWithParam(param, *result);
+            AsyncTask(ENamedThreads::GameThread, [weakThis, fileIndex, estimatedBytes, result]()
+            {
+                if (URuntimeMeshBatchImporter* importer = weakThis.Get())
+                {
+                    importer->OnFileFinished(fileIndex, estimatedBytes, result);
+                }
+            });
+        });
+    }
+}
+
+void URuntimeMeshBatchImporter::OnFileFinished(const int32 fileIndex, const int64 estimatedBytes, FRuntimeMeshImportResultRef result)
+{
+    check(IsInGameThread());
+
+    if (!bIsImporting)
+    {
+        return;
+    }
+
+    --numInFlight;
+    bytesInFlight -= estimatedBytes;
+    ++numFinished;
+
+    delegateFileFinished.ExecuteIfBound(fileIndex, result);
+    delegateProgress.ExecuteIfBound(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ImportingFiles, numFinished, numTotal));
+
+    if (numFinished == numTotal)
+    {
+        FinishBatch();
+    }
+    else
+    {
+        StartPendingImports();
+    }
+}
+
+void URuntimeMeshBatchImporter::FinishBatch()
+{
+    // Reset everything before the callback, so a new batch can be started from within it
+    FRuntimeBatchImportFinished callbackFinished = delegateFinished;
+    delegateFileFinished.Unbind();
+    delegateProgress.Unbind();
+    delegateFinished.Unbind();
+    pendingFiles.Empty();
+    DestroyThreadPool();
+    bIsImporting = false;
+
+    callbackFinished.ExecuteIfBound();
+}
+
+void URuntimeMeshBatchImporter::DestroyThreadPool()
+{
+    if (threadPool)
+    {
+        threadPool->Destroy();
+        delete threadPool;
+        threadPool = nullptr;
+    }
+}
@@ -0,0 +1,469 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshComponentExportables.h"
+#include "RuntimeMeshImportExport.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "ProceduralMeshComponent.h"
+#include "GameFramework/Actor.h"
+#include "RenderingThread.h"
+#include "RHI.h"
+#include "Misc/App.h"
+#include "UObject/ObjectKey.h"
+#include "Hash/CityHash.h"
+
+namespace
+{
+    // The streams of a section in the layout of FExportableMeshSectionView
+    struct FExtractedSection
+    {
+        int32 materialIndex = 0;
+        TArray<FVector> vertices;
+        TArray<FVector> normals;
+        TArray<FVector> tangents;
+        TArray<FVector2D> textureCoordinates;
+        // Empty when the mesh has no colors
+        TArray<FColor> vertexColors;
+        TArray<int32> triangles;
+    };
+    using FExtractedMesh = TArray<FExtractedSection>;
+    using FExtractedMeshPtr = TSharedPtr<const FExtractedMesh, ESPMode::ThreadSafe>;
+
+    // The vertex and index buffers of a static mesh LOD in their own layout, from the CPU copy or read back from the GPU
+    struct FStaticMeshLodBuffers
+    {
+        int32 numVertices = 0;
+        const uint8* positions = nullptr;
+        const uint8* tangents = nullptr;
+        const uint8* texCoords = nullptr;
+        // Null when the LOD has no colors
+        const uint8* colors = nullptr;
+        bool bHighPrecisionTangents = false;
+        bool bFullPrecisionUVs = false;
+        int32 numTexCoords = 0;
+        TArray<uint32> indices;
+        // The positions, tangents, texture coordinates and colors of a readback
+        TArray<uint8> readBack[4];
+    };
+
+    bool HasCpuCopy(const UStaticMesh& mesh, FStaticMeshLODResources& lod)
+    {
+        // The editor keeps the CPU copy of every mesh for its tools
+        return (WITH_EDITOR || mesh.bAllowCPUAccess) && lod.VertexBuffers.PositionVertexBuffer.GetVertexData()
+            && lod.VertexBuffers.StaticMeshVertexBuffer.GetTangentData() && lod.IndexBuffer.GetArrayView().Num() > 0;
+    }
+
+    void GetCpuBuffers(FStaticMeshLODResources& lod, FStaticMeshLodBuffers& outBuffers)
+    {
+        FStaticMeshVertexBuffer& vertexBuffer = lod.VertexBuffers.StaticMeshVertexBuffer;
+        outBuffers.positions = static_cast<const uint8*>(lod.VertexBuffers.PositionVertexBuffer.GetVertexData());
+        outBuffers.tangents = static_cast<const uint8*>(vertexBuffer.GetTangentData());
+        outBuffers.texCoords = static_cast<const uint8*>(vertexBuffer.GetTexCoordData());
+        outBuffers.colors = lod.VertexBuffers.ColorVertexBuffer.GetNumVertices() > 0 ? static_cast<const uint8*>(lod.VertexBuffers.ColorVertexBuffer.GetVertexData()) : nullptr;
+        lod.IndexBuffer.GetCopy(outBuffers.indices);
+    }
+
+    // Locks the buffers on the render thread and waits for the copy. Fails without an RHI, e.g. in a commandlet.
+    bool ReadBackGpuBuffers(FStaticMeshLODResources& lod, FStaticMeshLodBuffers& outBuffers)
+    {
+        if (!FApp::CanEverRender() || !GIsRHIInitialized)
+        {
+            return false;
+        }
+
+        FStaticMeshVertexBuffer& vertexBuffer = lod.VertexBuffers.StaticMeshVertexBuffer;
+        const uint32 numVertices = uint32(outBuffers.numVertices);
+        FVertexBuffer* buffers[4] = { &lod.VertexBuffers.PositionVertexBuffer, &vertexBuffer.TangentsVertexBuffer, &vertexBuffer.TexCoordVertexBuffer, &lod.VertexBuffers.ColorVertexBuffer };
+        const uint32 sizes[4] = {
+            numVertices * uint32(sizeof(FVector)),
+            numVertices * uint32(outBuffers.bHighPrecisionTangents ? sizeof(FPackedRGBA16N) : sizeof(FPackedNormal)) * 2,
+            numVertices * uint32(outBuffers.numTexCoords * (outBuffers.bFullPrecisionUVs ? sizeof(FVector2D) : sizeof(FVector2DHalf))),
+            lod.VertexBuffers.ColorVertexBuffer.GetNumVertices() > 0 ? numVertices * uint32(sizeof(FColor)) : 0u };
+        const uint32 numIndices = uint32(lod.IndexBuffer.GetNumIndices());
+        const bool b32BitIndices = lod.IndexBuffer.Is32Bit();
+        FRHIIndexBuffer* indexBufferRHI = lod.IndexBuffer.IndexBufferRHI;
+
+        ENQUEUE_RENDER_COMMAND(RuntimeMeshReadBackStaticMesh)([&](FRHICommandListImmediate& RHICmdList)
+        {
+            for (int32 bufferIndex = 0; bufferIndex < 4; ++bufferIndex)
+            {
+                FRHIVertexBuffer* bufferRHI = buffers[bufferIndex]->VertexBufferRHI;
+                if (bufferRHI && sizes[bufferIndex] > 0)
+                {
+                    outBuffers.readBack[bufferIndex].SetNumUninitialized(sizes[bufferIndex]);
+                    FMemory::Memcpy(outBuffers.readBack[bufferIndex].GetData(), RHILockVertexBuffer(bufferRHI, 0, sizes[bufferIndex], RLM_ReadOnly), sizes[bufferIndex]);
+                    RHIUnlockVertexBuffer(bufferRHI);
+                }
+            }
+            if (indexBufferRHI && numIndices > 0)
+            {
+                outBuffers.indices.SetNumUninitialized(numIndices);
+                const void* indexData = RHILockIndexBuffer(indexBufferRHI, 0, numIndices * (b32BitIndices ? 4 : 2), RLM_ReadOnly);
+                if (b32BitIndices)
+                {
+                    FMemory::Memcpy(outBuffers.indices.GetData(), indexData, numIndices * sizeof(uint32));
+                }
+                else
+                {
+                    for (uint32 index = 0; index < numIndices; ++index)
+                    {
+                        outBuffers.indices[index] = static_cast<const uint16*>(indexData)[index];
+                    }
+                }
+                RHIUnlockIndexBuffer(indexBufferRHI);
+            }
+        });
+        FRenderCommandFence fence;
+        fence.BeginFence();
+        fence.Wait();
+
+        outBuffers.positions = outBuffers.readBack[0].GetData();
+        outBuffers.tangents = outBuffers.readBack[1].GetData();
+        outBuffers.texCoords = outBuffers.readBack[2].GetData();
+        outBuffers.colors = outBuffers.readBack[3].Num() > 0 ? outBuffers.readBack[3].GetData() : nullptr;
+        return outBuffers.readBack[0].Num() == int32(sizes[0]) && outBuffers.readBack[1].Num() == int32(sizes[1]) && outBuffers.indices.Num() > 0;
+    }
+
+    // A section per FStaticMeshSection, with the vertices of its range
+    void ExtractSections(const FStaticMeshLODResources& lod, const FStaticMeshLodBuffers& buffers, FExtractedMesh& outMesh)
+    {
+        const int32 tangentSize = buffers.bHighPrecisionTangents ? sizeof(FPackedRGBA16N) : sizeof(FPackedNormal);
+        const int32 texCoordStride = buffers.numTexCoords * (buffers.bFullPrecisionUVs ? sizeof(FVector2D) : sizeof(FVector2DHalf));
+        for (const FStaticMeshSection& lodSection : lod.Sections)
+        {
+            const int32 firstVertex = int32(lodSection.MinVertexIndex);
+            const int32 numVertices = int32(lodSection.MaxVertexIndex) - firstVertex + 1;
+            const int32 numIndices = int32(lodSection.NumTriangles) * 3;
+            if (numIndices == 0 || numVertices <= 0 || firstVertex + numVertices > buffers.numVertices
+                || int32(lodSection.FirstIndex) + numIndices > buffers.indices.Num())
+            {
+                continue;
+            }
+
+            FExtractedSection& section = outMesh.AddDefaulted_GetRef();
+            section.materialIndex = lodSection.MaterialIndex;
+            section.vertices.SetNumUninitialized(numVertices);
+            FMemory::Memcpy(section.vertices.GetData(), buffers.positions + firstVertex * sizeof(FVector), numVertices * sizeof(FVector));
+            section.normals.SetNumUninitialized(numVertices);
+            section.tangents.SetNumUninitialized(numVertices);
+            section.textureCoordinates.SetNumZeroed(numVertices);
+            for (int32 index = 0; index < numVertices; ++index)
+            {
+                const int32 vertex = firstVertex + index;
+                // TangentX followed by TangentZ, the normal
+                const uint8* tangent = buffers.tangents + vertex * tangentSize * 2;
+                if (buffers.bHighPrecisionTangents)
+                {
+                    section.tangents[index] = reinterpret_cast<const FPackedRGBA16N*>(tangent)->ToFVector();
+                    section.normals[index] = reinterpret_cast<const FPackedRGBA16N*>(tangent + tangentSize)->ToFVector();
+                }
+                else
+                {
+                    section.tangents[index] = reinterpret_cast<const FPackedNormal*>(tangent)->ToFVector();
+                    section.normals[index] = reinterpret_cast<const FPackedNormal*>(tangent + tangentSize)->ToFVector();
+                }
+                if (buffers.numTexCoords > 0)
+                {
+                    const uint8* texCoord = buffers.texCoords + vertex * texCoordStride;
+                    section.textureCoordinates[index] = buffers.bFullPrecisionUVs ? *reinterpret_cast<const FVector2D*>(texCoord)
+                        : FVector2D(*reinterpret_cast<const FVector2DHalf*>(texCoord));
+                }
+            }
+            if (buffers.colors)
+            {
+                section.vertexColors.SetNumUninitialized(numVertices);
+                FMemory::Memcpy(section.vertexColors.GetData(), buffers.colors + firstVertex * sizeof(FColor), numVertices * sizeof(FColor));
+            }
+
+            section.triangles.SetNumUninitialized(numIndices);
+            const uint32* indices = buffers.indices.GetData() + lodSection.FirstIndex;
+            for (int32 index = 0; index < numIndices; ++index)
+            {
+                section.triangles[index] = int32(indices[index]) - firstVertex;
+            }
+        }
+    }
+
+    struct FCachedStaticMeshLod
+    {
+        // A rebuilt mesh has new render data
+        const FStaticMeshRenderData* renderData = nullptr;
+        FExtractedMeshPtr mesh;
+    };
+
+    // Only used on the GameThread
+    TMap<TPair<FObjectKey, int32>, FCachedStaticMeshLod>& GetStaticMeshCache()
+    {
+        static TMap<TPair<FObjectKey, int32>, FCachedStaticMeshLod> cache;
+        return cache;
+    }
+
+    FExtractedMeshPtr FindOrExtractStaticMeshLod(UStaticMesh& mesh, const int32 lodIndex)
+    {
+        check(IsInGameThread());
+        TMap<TPair<FObjectKey, int32>, FCachedStaticMeshLod>& cache = GetStaticMeshCache();
+        const TPair<FObjectKey, int32> key(FObjectKey(&mesh), lodIndex);
+        FStaticMeshRenderData* renderData = mesh.RenderData.Get();
+        if (const FCachedStaticMeshLod* cached = cache.Find(key))
+        {
+            if (cached->renderData == renderData)
+            {
+                return cached->mesh;
+            }
+        }
+        else
+        {
+            // Forget the meshes that were destroyed since
+            for (auto it = cache.CreateIterator(); it; ++it)
+            {
+                if (!it.Key().Key.ResolveObjectPtr())
+                {
+                    it.RemoveCurrent();
+                }
+            }
+        }
+
+        FStaticMeshLODResources& lod = renderData->LODResources[lodIndex];
+        FStaticMeshLodBuffers buffers;
+        buffers.numVertices = int32(lod.VertexBuffers.PositionVertexBuffer.GetNumVertices());
+        buffers.bHighPrecisionTangents = lod.VertexBuffers.StaticMeshVertexBuffer.GetUseHighPrecisionTangentBasis();
+        buffers.bFullPrecisionUVs = lod.VertexBuffers.StaticMeshVertexBuffer.GetUseFullPrecisionUVs();
+        buffers.numTexCoords = int32(lod.VertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords());
+        if (HasCpuCopy(mesh, lod))
+        {
+            GetCpuBuffers(lod, buffers);
+        }
+        else if (!ReadBackGpuBuffers(lod, buffers))
+        {
+            RMIE_LOG(Warning, "Could not read the buffers of LOD %d of %s, it has no CPU access and its GPU buffers can not be read back.", lodIndex, *mesh.GetName());
+            cache.Remove(key);
+            return nullptr;
+        }
+
+        TSharedRef<FExtractedMesh, ESPMode::ThreadSafe> extracted = MakeShared<FExtractedMesh, ESPMode::ThreadSafe>();
+        ExtractSections(lod, buffers, extracted.Get());
+        FCachedStaticMeshLod& cached = cache.FindOrAdd(key);
+        cached.renderData = renderData;
+        cached.mesh = extracted;
+        return cached.mesh;
+    }
+
+    bool GetStaticMeshLod(const UStaticMesh* mesh, const int32 forLod, const bool bSkipLodNotValid, int32& outLodIndex)
+    {
+        if (!mesh || !mesh->RenderData || mesh->RenderData->LODResources.Num() == 0)
+        {
+            return false;
+        }
+        const int32 numLods = mesh->RenderData->LODResources.Num();
+        if (forLod >= numLods && bSkipLodNotValid)
+        {
+            return false;
+        }
+        outLodIndex = FMath::Clamp(forLod, 0, numLods - 1);
+        return true;
+    }
+
+    // The mesh, its render data and the materials of the component
+    uint64 HashStaticMeshState(const UStaticMeshComponent& meshComponent, const int32 lodIndex)
+    {
+        const UStaticMesh* mesh = meshComponent.GetStaticMesh();
+        TArray<uint64> state;
+        state.Add(uint64(UPTRINT(mesh)));
+        state.Add(uint64(UPTRINT(mesh ? mesh->RenderData.Get() : nullptr)));
+        state.Add(uint64(lodIndex));
+        for (int32 materialIndex = 0; materialIndex < meshComponent.GetNumMaterials(); ++materialIndex)
+        {
+            state.Add(uint64(UPTRINT(meshComponent.GetMaterial(materialIndex))));
+        }
+        return CityHash64(reinterpret_cast<const char*>(state.GetData()), state.Num() * sizeof(uint64));
+    }
+
+    template<typename GetMaterialType>
+    void AddSectionViews(const FExtractedMeshPtr& mesh, const FTransform& meshToWorld, GetMaterialType GetMaterial, TArray<FExportableMeshSectionView>& outSectionViews)
+    {
+        for (const FExtractedSection& section : *mesh)
+        {
+            FExportableMeshSectionView& view = outSectionViews.AddDefaulted_GetRef();
+            view.meshToWorld = meshToWorld;
+            view.material = GetMaterial(section.materialIndex);
+            view.vertices = section.vertices;
+            view.normals = section.normals;
+            view.tangents = section.tangents;
+            view.textureCoordinates = section.textureCoordinates;
+            view.vertexColors = section.vertexColors;
+            view.triangles = section.triangles;
+            view.owner = mesh;
+        }
+    }
+}
+
+UObject* URuntimeMeshComponentExportable::CreateForComponent(UPrimitiveComponent* inComponent, UObject* outer)
+{
+    URuntimeMeshComponentExportable* exportable = nullptr;
+    if (Cast<UStaticMeshComponent>(inComponent))
+    {
+        exportable = NewObject<URuntimeMeshStaticMeshExportable>(outer);
+    }
+    else if (Cast<UProceduralMeshComponent>(inComponent))
+    {
+        exportable = NewObject<URuntimeMeshProceduralMeshExportable>(outer);
+    }
+    if (exportable)
+    {
+        exportable->component = inComponent;
+    }
+    return exportable;
+}
+
+FString URuntimeMeshComponentExportable::GetHierarchicalNodeName_Implementation() const
+{
+    const UPrimitiveComponent* meshComponent = component.Get();
+    if (!meshComponent)
+    {
+        return FString();
+    }
+    const AActor* owner = meshComponent->GetOwner();
+    return owner ? owner->GetName() + TEXT(".") + meshComponent->GetName() : meshComponent->GetName();
+}
+
+bool URuntimeMeshComponentExportable::GetMeshData_Implementation(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSection>& outSectionData) const
+{
+    TArray<FExportableMeshSectionView> views;
+    if (!GetMeshDataViews(forLod, bSkipLodNotValid, views))
+    {
+        return false;
+    }
+    for (const FExportableMeshSectionView& view : views)
+    {
+        FExportableMeshSection& section = outSectionData.AddDefaulted_GetRef();
+        section.meshToWorld = view.meshToWorld;
+        section.material = view.material;
+        section.vertices = TArray<FVector>(view.vertices.GetData(), view.vertices.Num());
+        section.normals = TArray<FVector>(view.normals.GetData(), view.normals.Num());
+        section.tangents = TArray<FVector>(view.tangents.GetData(), view.tangents.Num());
+        section.textureCoordinates = TArray<FVector2D>(view.textureCoordinates.GetData(), view.textureCoordinates.Num());
+        section.vertexColors = TArray<FColor>(view.vertexColors.GetData(), view.vertexColors.Num());
+        section.triangles = TArray<int32>(view.triangles.GetData(), view.triangles.Num());
+    }
+    return true;
+}
+
+void URuntimeMeshStaticMeshExportable::EmptyStaticMeshCache()
+{
+    check(IsInGameThread());
+    GetStaticMeshCache().Empty();
+}
+
+bool URuntimeMeshStaticMeshExportable::GetMeshDataViews(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSectionView>& outSectionViews) const
+{
+    UStaticMeshComponent* meshComponent = Cast<UStaticMeshComponent>(component.Get());
+    UStaticMesh* mesh = meshComponent ? meshComponent->GetStaticMesh() : nullptr;
+    int32 lodIndex = 0;
+    if (!GetStaticMeshLod(mesh, forLod, bSkipLodNotValid, lodIndex))
+    {
+        return false;
+    }
+
+    // The instances place the mesh, @see GetInstanceTransforms. Without instances nothing is shown.
+    const UInstancedStaticMeshComponent* instancedComponent = Cast<UInstancedStaticMeshComponent>(meshComponent);
+    if (instancedComponent && instancedComponent->GetInstanceCount() == 0)
+    {
+        return false;
+    }
+    const FExtractedMeshPtr extracted = FindOrExtractStaticMeshLod(*mesh, lodIndex);
+    if (!extracted)
+    {
+        return false;
+    }
+    AddSectionViews(extracted, instancedComponent ? FTransform::Identity : meshComponent->GetComponentTransform()
+        , [meshComponent](const int32 materialIndex) { return meshComponent->GetMaterial(materialIndex); }, outSectionViews);
+    return true;
+}
+
+int64 URuntimeMeshStaticMeshExportable::GetMeshDataVersion() const
+{
+    const UStaticMeshComponent* meshComponent = Cast<UStaticMeshComponent>(component.Get());
+    if (!meshComponent || !meshComponent->GetStaticMesh())
+    {
+        return 0;
+    }
+    const FMatrix meshToWorld = meshComponent->GetComponentTransform().ToMatrixWithScale();
+    const uint64 version = CityHash64WithSeed(reinterpret_cast<const char*>(&meshToWorld), sizeof(FMatrix), HashStaticMeshState(*meshComponent, INDEX_NONE));
+    return version == 0 ? 1 : int64(version);
+}
+
+uint64 URuntimeMeshStaticMeshExportable::GetSharedMeshKey(const int32 forLod, FTransform& outMeshToWorld) const
+{
+    const UStaticMeshComponent* meshComponent = Cast<UStaticMeshComponent>(component.Get());
+    int32 lodIndex = 0;
+    if (!meshComponent || !GetStaticMeshLod(meshComponent->GetStaticMesh(), forLod, false, lodIndex))
+    {
+        return 0;
+    }
+    outMeshToWorld = meshComponent->GetComponentTransform();
+    const uint64 key = HashStaticMeshState(*meshComponent, lodIndex);
+    return key == 0 ? 1 : key;
+}
+
+bool URuntimeMeshStaticMeshExportable::GetInstanceTransforms(const int32 forLod, TArray<FTransform>& outInstanceToWorld) const
+{
+    const UInstancedStaticMeshComponent* instancedComponent = Cast<UInstancedStaticMeshComponent>(component.Get());
+    if (!instancedComponent || instancedComponent->PerInstanceSMData.Num() == 0)
+    {
+        return false;
+    }
+    const FTransform& componentToWorld = instancedComponent->GetComponentTransform();
+    outInstanceToWorld.Reset(instancedComponent->PerInstanceSMData.Num());
+    for (const FInstancedStaticMeshInstanceData& instance : instancedComponent->PerInstanceSMData)
+    {
+        outInstanceToWorld.Add(FTransform(instance.Transform) * componentToWorld);
+    }
+    return true;
+}
+
+bool URuntimeMeshProceduralMeshExportable::GetMeshDataViews(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSectionView>& outSectionViews) const
+{
+    UProceduralMeshComponent* meshComponent = Cast<UProceduralMeshComponent>(component.Get());
+    if (!meshComponent)
+    {
+        return false;
+    }
+
+    // Converted from the vertex structs of the sections into streams
+    TSharedRef<FExtractedMesh, ESPMode::ThreadSafe> extracted = MakeShared<FExtractedMesh, ESPMode::ThreadSafe>();
+    for (int32 sectionIndex = 0; sectionIndex < meshComponent->GetNumSections(); ++sectionIndex)
+    {
+        const FProcMeshSection* procSection = meshComponent->GetProcMeshSection(sectionIndex);
+        if (!procSection || !procSection->bSectionVisible || procSection->ProcIndexBuffer.Num() == 0)
+        {
+            continue;
+        }
+
+        FExtractedSection& section = extracted->AddDefaulted_GetRef();
+        section.materialIndex = sectionIndex;
+        const int32 numVertices = procSection->ProcVertexBuffer.Num();
+        section.vertices.SetNumUninitialized(numVertices);
+        section.normals.SetNumUninitialized(numVertices);
+        section.tangents.SetNumUninitialized(numVertices);
+        section.textureCoordinates.SetNumUninitialized(numVertices);
+        section.vertexColors.SetNumUninitialized(numVertices);
+        for (int32 index = 0; index < numVertices; ++index)
+        {
+            const FProcMeshVertex& vertex = procSection->ProcVertexBuffer[index];
+            section.vertices[index] = vertex.Position;
+            section.normals[index] = vertex.Normal;
+            section.tangents[index] = vertex.Tangent.TangentX;
+            section.textureCoordinates[index] = vertex.UV0;
+            section.vertexColors[index] = vertex.Color;
+        }
+        section.triangles.SetNumUninitialized(procSection->ProcIndexBuffer.Num());
+        FMemory::Memcpy(section.triangles.GetData(), procSection->ProcIndexBuffer.GetData(), procSection->ProcIndexBuffer.Num() * sizeof(uint32));
+    }
+    AddSectionViews(extracted, meshComponent->GetComponentTransform()
+        , [meshComponent](const int32 materialIndex) { return meshComponent->GetMaterial(materialIndex); }, outSectionViews);
+    return true;
+}
@@ -0,0 +1,319 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshConvertCommandlet.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshExporter.h"
+#include "MeshConversionKernels.h"
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace
+{
+    enum class EConvertJobType : uint8
+    {
+        Convert,
+        Import,
+        Export,
+    };
+
+    struct FConvertJob
+    {
+        EConvertJobType type = EConvertJobType::Convert;
+        FRuntimeMeshConvertParam convertParam;
+        FRuntimeMeshImportParam importParam;
+        FRuntimeMeshExportParam exportParam;
+        // Of the import step of an export job, exported on the main thread
+        FRuntimeMeshImportResult importResult;
+        FRuntimeMeshConvertJobMetrics metrics;
+    };
+
+    bool ParseJob(const TSharedPtr<FJsonObject>& jobObject, FConvertJob& outJob)
+    {
+        const TSharedPtr<FJsonObject>* paramObject = nullptr;
+        if (!jobObject.IsValid() || !jobObject->TryGetObjectField(TEXT("param"), paramObject))
+        {
+            outJob.metrics.error = TEXT("The job has no param.");
+            return false;
+        }
+
+        outJob.metrics.type = jobObject->GetStringField(TEXT("type"));
+        if (outJob.metrics.type == TEXT("convert"))
+        {
+            outJob.type = EConvertJobType::Convert;
+            if (!FJsonObjectConverter::JsonObjectToUStruct(paramObject->ToSharedRef(), &outJob.convertParam))
+            {
+                outJob.metrics.error = TEXT("The param is no FRuntimeMeshConvertParam.");
+                return false;
+            }
+            outJob.metrics.file = outJob.convertParam.file;
+            return true;
+        }
+
+        if (outJob.metrics.type != TEXT("import") && outJob.metrics.type != TEXT("export"))
+        {
+            outJob.metrics.error = FString::Printf(TEXT("Unknown job type %s."), *outJob.metrics.type);
+            return false;
+        }
+        outJob.type = outJob.metrics.type == TEXT("import") ? EConvertJobType::Import : EConvertJobType::Export;
+        if (!FJsonObjectConverter::JsonObjectToUStruct(paramObject->ToSharedRef(), &outJob.importParam))
+        {
+            outJob.metrics.error = TEXT("The param is no FRuntimeMeshImportParam.");
+            return false;
+        }
+        outJob.metrics.file = outJob.importParam.file;
+
+        if (outJob.type == EConvertJobType::Export)
+        {
+            const TSharedPtr<FJsonObject>* exportParamObject = nullptr;
+            if (!jobObject->TryGetObjectField(TEXT("exportParam"), exportParamObject)
+                || !FJsonObjectConverter::JsonObjectToUStruct(exportParamObject->ToSharedRef(), &outJob.exportParam))
+            {
+                outJob.metrics.error = TEXT("The export job has no FRuntimeMeshExportParam.");
+                return false;
+            }
+            // The export runs synchronous, nothing is left for later ticks
+            outJob.exportParam.bExportToMemory = false;
+        }
+        return true;
+    }
+
+    // The jobs and the import step of the export jobs, on any thread
+    void RunJob_AnyThread(FConvertJob& job)
+    {
+        const double startTime = FPlatformTime::Seconds();
+        FRuntimeMeshConvertJobMetrics& metrics = job.metrics;
+        if (job.type == EConvertJobType::Convert)
+        {
+            URuntimeMeshImportExportLibrary::ConvertScene(job.convertParam, metrics.convert);
+            metrics.bSuccess = metrics.convert.bSuccess;
+            metrics.error = metrics.convert.error;
+        }
+        else
+        {
+            URuntimeMeshImportExportLibrary::ImportSceneWithParam(job.importParam, job.importResult);
+            metrics.importTimings = job.importResult.timings;
+            metrics.importMetrics = job.importResult.metrics;
+            metrics.bSuccess = job.importResult.bSuccess;
+            if (!metrics.bSuccess)
+            {
+                metrics.error = TEXT("The import failed, the log has the reason.");
+            }
+            // Only the export needs the meshes
+            if (job.type == EConvertJobType::Import)
+            {
+                job.importResult = FRuntimeMeshImportResult();
+            }
+        }
+        metrics.seconds = float(FPlatformTime::Seconds() - startTime);
+    }
+
+    // The export step of an export job. Creates UObjects, so it runs on the main thread.
+    void RunExport_GameThread(FConvertJob& job)
+    {
+        check(IsInGameThread());
+        const double startTime = FPlatformTime::Seconds();
+        URuntimeMeshExporter* exporter = NewObject<URuntimeMeshExporter>();
+        TArray<FRuntimeMeshImportMeshInfo>& meshInfos = job.importResult.meshInfos;
+        for (int32 meshInfoIndex = 0; meshInfoIndex < meshInfos.Num(); ++meshInfoIndex)
+        {
+            // Unique node names, the meshes of a merged import have no name
+            const FString meshName = meshInfos[meshInfoIndex].meshName.IsNone() ? TEXT("Mesh") : meshInfos[meshInfoIndex].meshName.ToString();
+            URuntimeMeshImportResultExportable* exportable = NewObject<URuntimeMeshImportResultExportable>(exporter);
+            exportable->SetMeshInfo(FString::Printf(TEXT("%s_%d"), *meshName, meshInfoIndex), MoveTemp(meshInfos[meshInfoIndex]), job.exportParam.vertexColorSpace);
+            exporter->AddExportObject(TScriptInterface<IMeshExportable>(exportable), false, FString());
+        }
+        job.importResult = FRuntimeMeshImportResult();
+
+        FRuntimeMeshExportResult exportResult;
+        exporter->Export(job.exportParam, exportResult);
+        FRuntimeMeshConvertJobMetrics& metrics = job.metrics;
+        metrics.exportTimings = exportResult.timings;
+        metrics.exportMetrics = exportResult.metrics;
+        metrics.bSuccess = exportResult.bSuccess;
+        metrics.error = exportResult.error;
+        metrics.seconds += float(FPlatformTime::Seconds() - startTime);
+    }
+}
+
+void URuntimeMeshImportResultExportable::SetMeshInfo(const FString& inNodeName, FRuntimeMeshImportMeshInfo&& inMeshInfo, const ERuntimeMeshVertexColorSpace inVertexColorSpace)
+{
+    nodeName = inNodeName;
+    meshInfo = MoveTemp(inMeshInfo);
+    vertexColorSpace = inVertexColorSpace;
+}
+
+FString URuntimeMeshImportResultExportable::GetHierarchicalNodeName_Implementation() const
+{
+    return nodeName;
+}
+
+bool URuntimeMeshImportResultExportable::GetMeshData_Implementation(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSection>& outSectionData) const
+{
+    // LOD 0 is 'sections', a missing LOD falls back to the last one
+    if (forLod > meshInfo.lods.Num() && bSkipLodNotValid)
+    {
+        return false;
+    }
+    const int32 lod = FMath::Min(forLod, meshInfo.lods.Num());
+    const TArray<FRuntimeMeshImportSectionInfo>& sections = lod == 0 ? meshInfo.sections : meshInfo.lods[lod - 1].sections;
+
+    // Without instances the vertices are in world space
+    static const TArray<FTransform> identity = { FTransform::Identity };
+    const bool bSRGBColors = vertexColorSpace == ERuntimeMeshVertexColorSpace::SRGB;
+    for (const FTransform& instanceTransform : meshInfo.instanceTransforms.Num() > 0 ? meshInfo.instanceTransforms : identity)
+    {
+        for (const FRuntimeMeshImportSectionInfo& section : sections)
+        {
+            FExportableMeshSection& exportSection = outSectionData.AddDefaulted_GetRef();
+            exportSection.meshToWorld = instanceTransform;
+            exportSection.material = nullptr;
+            exportSection.vertices = section.vertices;
+            exportSection.normals = section.normals;
+            exportSection.tangents = section.tangents;
+            exportSection.textureCoordinates = section.uv0;
+            exportSection.triangles = section.triangles;
+            exportSection.vertexColors.SetNumUninitialized(section.vertexColors.Num());
+            FMeshConversionKernels::QuantizeColors(section.vertexColors.GetData(), exportSection.vertexColors.GetData(), section.vertexColors.Num(), bSRGBColors);
+        }
+    }
+    return true;
+}
+
+URuntimeMeshConvertCommandlet::URuntimeMeshConvertCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 URuntimeMeshConvertCommandlet::Main(const FString& params)
+{
+    FString manifestFile;
+    if (!FParse::Value(*params, TEXT("Manifest="), manifestFile))
+    {
+        RMIE_LOG(Error, "Usage: -run=RuntimeMeshConvert -Manifest=<file> [-Threads=<n>] [-Shard=<i> -NumShards=<n>] [-Metrics=<file>]");
+        return 1;
+    }
+
+    FString manifestText;
+    TSharedPtr<FJsonObject> manifest;
+    if (!FFileHelper::LoadFileToString(manifestText, *manifestFile)
+        || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(manifestText), manifest) || !manifest.IsValid())
+    {
+        RMIE_LOG(Error, "Could not read the manifest %s", *manifestFile);
+        return 1;
+    }
+
+    // The command line overrides the manifest
+    int32 numThreads = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+    manifest->TryGetNumberField(TEXT("numThreads"), numThreads);
+    FParse::Value(*params, TEXT("Threads="), numThreads);
+    FString metricsFile;
+    manifest->TryGetStringField(TEXT("metricsFile"), metricsFile);
+    FParse::Value(*params, TEXT("Metrics="), metricsFile);
+    int32 shard = 0;
+    int32 numShards = 1;
+    FParse::Value(*params, TEXT("Shard="), shard);
+    FParse::Value(*params, TEXT("NumShards="), numShards);
+    numShards = FMath::Max(numShards, 1);
+
+    const TArray<TSharedPtr<FJsonValue>>* jobValues = nullptr;
+    if (!manifest->TryGetArrayField(TEXT("jobs"), jobValues))
+    {
+        RMIE_LOG(Error, "The manifest %s has no jobs", *manifestFile);
+        return 1;
+    }
+
+    // This process runs the jobs of its shard
+    TArray<FConvertJob> jobs;
+    TArray<int32> runnableJobs;
+    for (int32 jobIndex = shard; jobIndex < jobValues->Num(); jobIndex += numShards)
+    {
+        FConvertJob& job = jobs.AddDefaulted_GetRef();
+        job.metrics.jobIndex = jobIndex;
+        if (ParseJob((*jobValues)[jobIndex]->AsObject(), job))
+        {
+            runnableJobs.Add(jobs.Num() - 1);
+        }
+        else
+        {
+            RMIE_LOG(Error, "Job %d of the manifest is invalid: %s", jobIndex, *job.metrics.error);
+        }
+    }
+    RMIE_LOG(Display, "Running %d of %d jobs on %d threads, shard %d of %d.", runnableJobs.Num(), jobValues->Num(), numThreads, shard, numShards);
+
+    const double startTime = FPlatformTime::Seconds();
+    // Each thread takes the next job, the imports and conversions use the task graph for their parallel steps as well
+    FThreadSafeCounter nextJob;
+    TArray<TFuture<void>> workers;
+    for (int32 thread = 0; thread < FMath::Clamp(numThreads, 1, FMath::Max(runnableJobs.Num(), 1)); ++thread)
+    {
+        workers.Add(Async(EAsyncExecution::Thread, [&jobs, &runnableJobs, &nextJob]() {
+            for (int32 next = nextJob.Increment() - 1; next < runnableJobs.Num(); next = nextJob.Increment() - 1)
+            {
+                FConvertJob& job = jobs[runnableJobs[next]];
+                RunJob_AnyThread(job);
+                RMIE_LOG(Display, "Job %d (%s %s) finished in %.2fs%s", job.metrics.jobIndex, *job.metrics.type, *job.metrics.file, job.metrics.seconds
+                    , job.metrics.bSuccess || job.type == EConvertJobType::Export ? TEXT("") : TEXT(", it failed"));
+            }
+        }));
+    }
+    // The imports send their progress to the GameThread, which is this thread in a commandlet
+    while (workers.ContainsByPredicate([](const TFuture<void>& worker) { return !worker.IsReady(); }))
+    {
+        FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+        FPlatformProcess::Sleep(0.01f);
+    }
+    FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+
+    for (const int32 jobIndex : runnableJobs)
+    {
+        FConvertJob& job = jobs[jobIndex];
+        if (job.type == EConvertJobType::Export && job.metrics.bSuccess)
+        {
+            RunExport_GameThread(job);
+            RMIE_LOG(Display, "Job %d (export %s) exported in %.2fs%s", job.metrics.jobIndex, *job.metrics.file, job.metrics.seconds
+                , job.metrics.bSuccess ? TEXT("") : TEXT(", it failed"));
+            // The exporter and the exportables of the job
+            CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+        }
+    }
+
+    int32 numFailed = 0;
+    TArray<TSharedPtr<FJsonValue>> metricValues;
+    for (const FConvertJob& job : jobs)
+    {
+        numFailed += job.metrics.bSuccess ? 0 : 1;
+        TSharedRef<FJsonObject> metricObject = MakeShared<FJsonObject>();
+        FJsonObjectConverter::UStructToJsonObject(FRuntimeMeshConvertJobMetrics::StaticStruct(), &job.metrics, metricObject, 0, 0);
+        metricValues.Add(MakeShared<FJsonValueObject>(metricObject));
+    }
+    if (!metricsFile.IsEmpty())
+    {
+        FString metricsText;
+        const TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&metricsText);
+        if (!FJsonSerializer::Serialize(metricValues, writer) || !FFileHelper::SaveStringToFile(metricsText, *metricsFile))
+        {
+            RMIE_LOG(Error, "Could not write the metrics to %s", *metricsFile);
+        }
+    }
+
+    RMIE_LOG(Display, "%d jobs finished in %.2fs, %d failed.", jobs.Num(), float(FPlatformTime::Seconds() - startTime), numFailed);
+    return numFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshDeferredRelease.h"
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformProcess.h"
+
+FThreadSafeCounter FRuntimeMeshDeferredRelease::numPending;
+
+namespace
+{
+    // Frees a result through FRuntimeMeshDeferredRelease
+    struct FImportResultDeleter
+    {
+        void operator()(FRuntimeMeshImportResult* result) const
+        {
+            const SIZE_T numBytes = FRuntimeMeshDeferredRelease::GetAllocatedSize(*result);
+            FRuntimeMeshDeferredRelease::Release(TUniquePtr<FRuntimeMeshImportResult>(result), numBytes);
+        }
+    };
+
+    SIZE_T GetSectionsSize(const TArray<FRuntimeMeshImportSectionInfo>& sections)
+    {
+        SIZE_T numBytes = sections.GetAllocatedSize();
+        for (const FRuntimeMeshImportSectionInfo& section : sections)
+        {
+            numBytes += section.vertices.GetAllocatedSize() + section.normals.GetAllocatedSize() + section.tangents.GetAllocatedSize()
+                + section.uv0.GetAllocatedSize() + section.uv1.GetAllocatedSize() + section.vertexColors.GetAllocatedSize()
+                + section.triangles.GetAllocatedSize() + section.boneIndices.GetAllocatedSize() + section.boneWeights.GetAllocatedSize()
+                + section.linesAndPoints.GetAllocatedSize();
+            for (const FRuntimeMeshImportMorphTarget& target : section.morphTargets)
+            {
+                numBytes += target.GetAllocatedSize();
+            }
+        }
+        return numBytes;
+    }
+}
+
+void FRuntimeMeshDeferredRelease::Release(FBatch&& batch)
+{
+    // Without the task graph, e.g. late in the shutdown, there is no thread to hand the data to
+    if (batch.GetBytes() < minDeferredBytes || !FTaskGraphInterface::IsRunning())
+    {
+        FBatch released(MoveTemp(batch));
+        return;
+    }
+
+    numPending.Increment();
+    TUniquePtr<FBatch> pendingBatch = MakeUnique<FBatch>(MoveTemp(batch));
+    AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [pendingBatch = MoveTemp(pendingBatch)]() mutable
+    {
+        pendingBatch.Reset();
+        numPending.Decrement();
+    });
+}
+
+FRuntimeMeshImportResultRef FRuntimeMeshDeferredRelease::MakeImportResult()
+{
+    return FRuntimeMeshImportResultRef(new FRuntimeMeshImportResult(), FImportResultDeleter());
+}
+
+FRuntimeMeshImportResultRef FRuntimeMeshDeferredRelease::MakeImportResult(FRuntimeMeshImportResult&& result)
+{
+    return FRuntimeMeshImportResultRef(new FRuntimeMeshImportResult(MoveTemp(result)), FImportResultDeleter());
+}
+
+SIZE_T FRuntimeMeshDeferredRelease::GetAllocatedSize(const FRuntimeMeshImportResult& result)
+{
+    SIZE_T numBytes = 0;
+    for (const FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+    {
+        numBytes += GetSectionsSize(meshInfo.sections) + meshInfo.instanceTransforms.GetAllocatedSize();
+        for (const FRuntimeMeshImportMeshLOD& lod : meshInfo.lods)
+        {
+            numBytes += GetSectionsSize(lod.sections);
+        }
+    }
+    return numBytes;
+}
+
+void FRuntimeMeshDeferredRelease::Flush()
+{
+    while (numPending.GetValue() > 0)
+    {
+        FPlatformProcess::Sleep(0.f);
+    }
+}
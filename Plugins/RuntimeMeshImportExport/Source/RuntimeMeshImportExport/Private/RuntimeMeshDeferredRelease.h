@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+/**
+ *	Frees large import and export data on a background thread, so the game thread does not stall on the free of gigabytes of arrays.
+ *	The data is moved into the release, it must not need any game thread object in its destructor.
+ *	Data smaller than 'minDeferredBytes' is freed right away, the task would cost more than the free.
+ */
+class FRuntimeMeshDeferredRelease
+{
+public:
+    static const SIZE_T minDeferredBytes = 1024 * 1024;
+
+    // The buffers of one teardown, they are released together
+    class FBatch
+    {
+    public:
+        // 'numBytes' is the memory 'data' frees
+        template<typename T>
+        void Add(T&& data, const SIZE_T numBytes)
+        {
+            holders.Add(MakeUnique<THolder<typename TDecay<T>::Type>>(MoveTemp(data)));
+            bytes += numBytes;
+        }
+
+        template<typename ElementType, typename AllocatorType>
+        void Add(TArray<ElementType, AllocatorType>&& data)
+        {
+            const SIZE_T numBytes = data.GetAllocatedSize();
+            Add(MoveTemp(data), numBytes);
+        }
+
+        SIZE_T GetBytes() const
+        {
+            return bytes;
+        }
+
+    private:
+        struct FHolderBase
+        {
+            virtual ~FHolderBase() {}
+        };
+
+        template<typename T>
+        struct THolder : public FHolderBase
+        {
+            explicit THolder(T&& inData) : data(MoveTemp(inData))
+            {}
+            T data;
+        };
+
+        TArray<TUniquePtr<FHolderBase>> holders;
+        SIZE_T bytes = 0;
+    };
+
+    // Frees 'batch' on a background thread when it is large enough. Any thread.
+    static void Release(FBatch&& batch);
+
+    template<typename T>
+    static void Release(T&& data, const SIZE_T numBytes)
+    {
+        FBatch batch;
+        batch.Add(MoveTemp(data), numBytes);
+        Release(MoveTemp(batch));
+    }
+
+    // A result that is released like a batch when its last reference is gone, so it does not matter which thread drops it
+    static FRuntimeMeshImportResultRef MakeImportResult();
+    static FRuntimeMeshImportResultRef MakeImportResult(FRuntimeMeshImportResult&& result);
+    // The memory of the vertex data of the meshes, the bulk of a result
+    static SIZE_T GetAllocatedSize(const FRuntimeMeshImportResult& result);
+
+    // Waits for the pending releases, at module shutdown
+    static void Flush();
+
+private:
+    static FThreadSafeCounter numPending;
+};
@@ -0,0 +1,228 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshExportBenchmark.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshExporter.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "Engine/Texture2D.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformFile.h"
+#include "Math/RandomStream.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    // A BGRA8 texture with the pixels on the CPU, it is never uploaded
+    UTexture2D* CreateBenchmarkTexture(const int32 size, FRandomStream& random)
+    {
+        UTexture2D* texture = UTexture2D::CreateTransient(size, size, PF_B8G8R8A8);
+        if (!texture || !texture->PlatformData || texture->PlatformData->Mips.Num() == 0)
+        {
+            return nullptr;
+        }
+
+        // Noise, so the encoders of the texture formats do not get an easy case
+        FTexture2DMipMap& mip = texture->PlatformData->Mips[0];
+        FColor* pixels = static_cast<FColor*>(mip.BulkData.Lock(LOCK_READ_WRITE));
+        for (int32 pixelIndex = 0; pixelIndex < size * size; ++pixelIndex)
+        {
+            pixels[pixelIndex] = FColor(uint8(random.RandHelper(256)), uint8(random.RandHelper(256)), uint8(random.RandHelper(256)), 255);
+        }
+        mip.BulkData.Unlock();
+        return texture;
+    }
+
+    FString GetFileExtension(const TArray<FAssimpExportFormat>& formats, const FString& formatId)
+    {
+        const FAssimpExportFormat* format = formats.FindByPredicate([&formatId](const FAssimpExportFormat& candidate) {
+            return candidate.id == formatId;
+        });
+        return format ? format->fileExtension : formatId;
+    }
+}
+
+void URuntimeMeshSyntheticExportable::Generate(const FString& inNodeName, const int32 numVertices, UMaterialInterface* material, const FTransform& meshToWorld, const int32 seed)
+{
+    nodeName = inNodeName;
+
+    FRandomStream random(seed);
+    const int32 gridSize = FMath::Max(2, FMath::CeilToInt(FMath::Sqrt(float(FMath::Max(numVertices, 4)))));
+    const float spacing = 10.f;
+
+    section = FExportableMeshSection();
+    section.meshToWorld = meshToWorld;
+    section.material = material;
+    const int32 numGridVertices = gridSize * gridSize;
+    section.vertices.Reserve(numGridVertices);
+    section.normals.Reserve(numGridVertices);
+    section.tangents.Reserve(numGridVertices);
+    section.textureCoordinates.Reserve(numGridVertices);
+    section.vertexColors.Reserve(numGridVertices);
+    for (int32 y = 0; y < gridSize; ++y)
+    {
+        for (int32 x = 0; x < gridSize; ++x)
+        {
+            section.vertices.Add(FVector(x * spacing, y * spacing, random.FRandRange(0.f, spacing)));
+            // Random, so the vertices do not weld or quantize better than real meshes
+            section.normals.Add(FVector(random.FRandRange(-0.2f, 0.2f), random.FRandRange(-0.2f, 0.2f), 1.f).GetSafeNormal());
+            section.tangents.Add(FVector::ForwardVector);
+            section.textureCoordinates.Add(FVector2D(float(x) / (gridSize - 1), float(y) / (gridSize - 1)));
+            section.vertexColors.Add(FColor(uint8(random.RandHelper(256)), uint8(random.RandHelper(256)), uint8(random.RandHelper(256)), 255));
+        }
+    }
+
+    section.triangles.Reserve((gridSize - 1) * (gridSize - 1) * 6);
+    for (int32 y = 0; y < gridSize - 1; ++y)
+    {
+        for (int32 x = 0; x < gridSize - 1; ++x)
+        {
+            const int32 corner = y * gridSize + x;
+            section.triangles.Append({ corner, corner + gridSize, corner + 1 });
+            section.triangles.Append({ corner + 1, corner + gridSize, corner + gridSize + 1 });
+        }
+    }
+}
+
+FString URuntimeMeshSyntheticExportable::GetHierarchicalNodeName_Implementation() const
+{
+    return nodeName;
+}
+
+bool URuntimeMeshSyntheticExportable::GetMeshData_Implementation(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSection>& outSectionData) const
+{
+    if (forLod != 0 && bSkipLodNotValid)
+    {
+        return false;
+    }
+    outSectionData.Add(section);
+    return true;
+}
+
+void URuntimeMeshExportBenchmark::RunExportBenchmark(const FRuntimeMeshExportBenchmarkParam& param, TArray<FRuntimeMeshExportBenchmarkSample>& outSamples)
+{
+    outSamples.Reset();
+
+    if (param.directory.IsEmpty())
+    {
+        RMIE_LOG(Error, "The benchmark needs a directory to export to.");
+        return;
+    }
+
+    UMaterialInterface* parentMaterial = param.sourceMaterial ? param.sourceMaterial : UMaterial::GetDefaultMaterial(MD_Surface);
+    TArray<FAssimpExportFormat> formats;
+    URuntimeMeshImportExportLibrary::GetSupportedExtensionsExport(formats);
+
+    for (const int32 numNodes : param.nodeCounts)
+    {
+        for (const int32 numVertices : param.verticesPerMesh)
+        {
+            for (const int32 numMaterials : param.materialCounts)
+            {
+                for (const int32 numTexturesWanted : param.textureCounts)
+                {
+                    // The same seed and counts generate the same scene
+                    FRandomStream random(param.seed);
+                    const int32 numMaterialsUsed = FMath::Max(numMaterials, 1);
+                    const int32 numTextures = FMath::Clamp(numTexturesWanted, 0, numMaterialsUsed);
+
+                    TArray<UTexture2D*> textures;
+                    for (int32 textureIndex = 0; textureIndex < numTextures; ++textureIndex)
+                    {
+                        if (UTexture2D* texture = CreateBenchmarkTexture(FMath::Max(param.textureSize, 1), random))
+                        {
+                            textures.Add(texture);
+                        }
+                    }
+
+                    TArray<UMaterialInstanceDynamic*> materials;
+                    for (int32 materialIndex = 0; materialIndex < numMaterialsUsed; ++materialIndex)
+                    {
+                        UMaterialInstanceDynamic* material = UMaterialInstanceDynamic::Create(parentMaterial, GetTransientPackage());
+                        if (textures.Num() > 0)
+                        {
+                            material->SetTextureParameterValue(FName("DiffuseMap"), textures[materialIndex % textures.Num()]);
+                        }
+                        materials.Add(material);
+                    }
+
+                    // Not rooted, nothing collects garbage until the synchronous exports are done
+                    URuntimeMeshExporter* exporter = NewObject<URuntimeMeshExporter>();
+                    for (int32 nodeIndex = 0; nodeIndex < FMath::Max(numNodes, 1); ++nodeIndex)
+                    {
+                        URuntimeMeshSyntheticExportable* exportable = NewObject<URuntimeMeshSyntheticExportable>();
+                        const FString nodeName = FString::Printf(TEXT("Benchmark.Node_%d"), nodeIndex);
+                        const FTransform meshToWorld(FVector(nodeIndex * 1000.f, 0.f, 0.f));
+                        exportable->Generate(nodeName, numVertices, materials[nodeIndex % materials.Num()], meshToWorld, random.RandHelper(MAX_int32));
+                        exporter->AddExportObject(exportable, false, FString());
+                    }
+
+                    for (const FString& formatId : param.formatIds)
+                    {
+                        FRuntimeMeshExportParam exportParam = param.exportParam;
+                        exportParam.formatId = formatId;
+                        exportParam.bOverrideExisting = true;
+                        exportParam.file = FPaths::Combine(param.directory, FString::Printf(TEXT("Benchmark_n%d_v%d_m%d_t%d.%s")
+                            , numNodes, numVertices, numMaterials, numTextures, *GetFileExtension(formats, formatId)));
+
+                        for (int32 repetition = 0; repetition < FMath::Max(param.numRepetitions, 1); ++repetition)
+                        {
+                            FRuntimeMeshExportResult result;
+                            exporter->Export(exportParam, result);
+
+                            FRuntimeMeshExportBenchmarkSample& sample = outSamples.AddDefaulted_GetRef();
+                            sample.formatId = formatId;
+                            sample.numNodes = numNodes;
+                            sample.numVerticesPerMesh = numVertices;
+                            sample.numMaterials = numMaterials;
+                            sample.numTextures = numTextures;
+                            sample.repetition = repetition;
+                            sample.bSuccess = result.bSuccess;
+                            sample.timings = result.timings;
+                            sample.fileSize = exportParam.bExportToMemory
+                                ? (result.files.Num() > 0 ? result.files[0].data.Num() : 0)
+                                : FMath::Max<int64>(FPlatformFileManager::Get().GetPlatformFile().FileSize(*exportParam.file), 0);
+                            if (!result.bSuccess)
+                            {
+                                RMIE_LOG(Warning, "Benchmark export of %s failed: %s", *exportParam.file, *result.error);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+FString URuntimeMeshExportBenchmark::SamplesToCsv(const TArray<FRuntimeMeshExportBenchmarkSample>& samples)
+{
+    FString csv = TEXT("formatId,numNodes,numVerticesPerMesh,numMaterials,numTextures,repetition,bSuccess,gatherSeconds,processSeconds,textureSeconds,writeSeconds,textureWaitSeconds,totalSeconds,fileSize\n");
+    for (const FRuntimeMeshExportBenchmarkSample& sample : samples)
+    {
+        const FRuntimeMeshExportStageTimings& timings = sample.timings;
+        csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%d,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%lld\n")
+            , *sample.formatId, sample.numNodes, sample.numVerticesPerMesh, sample.numMaterials, sample.numTextures, sample.repetition, sample.bSuccess ? 1 : 0
+            , timings.gatherSeconds, timings.processSeconds, timings.textureSeconds, timings.writeSeconds, timings.textureWaitSeconds, timings.totalSeconds
+            , sample.fileSize);
+    }
+    return csv;
+}
+
+FString URuntimeMeshExportBenchmark::SamplesToJson(const TArray<FRuntimeMeshExportBenchmarkSample>& samples)
+{
+    TArray<FString> objects;
+    for (const FRuntimeMeshExportBenchmarkSample& sample : samples)
+    {
+        const FRuntimeMeshExportStageTimings& timings = sample.timings;
+        objects.Add(FString::Printf(TEXT("{\"formatId\":\"%s\",\"numNodes\":%d,\"numVerticesPerMesh\":%d,\"numMaterials\":%d,\"numTextures\":%d,\"repetition\":%d,\"bSuccess\":%s")
+            TEXT(",\"gatherSeconds\":%.6f,\"processSeconds\":%.6f,\"textureSeconds\":%.6f,\"writeSeconds\":%.6f,\"textureWaitSeconds\":%.6f,\"totalSeconds\":%.6f,\"fileSize\":%lld}")
+            , *sample.formatId.ReplaceCharWithEscapedChar(), sample.numNodes, sample.numVerticesPerMesh, sample.numMaterials, sample.numTextures, sample.repetition
+            , sample.bSuccess ? TEXT("true") : TEXT("false")
+            , timings.gatherSeconds, timings.processSeconds, timings.textureSeconds, timings.writeSeconds, timings.textureWaitSeconds, timings.totalSeconds
+            , sample.fileSize));
+    }
+    return TEXT("[") + FString::Join(objects, TEXT(",\n")) + TEXT("]\n");
+}
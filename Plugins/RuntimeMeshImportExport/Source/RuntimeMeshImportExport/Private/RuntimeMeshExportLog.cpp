@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshExportLog.h"
+#include "RuntimeMeshImportExport.h"
+
+FRuntimeMeshExportLog::FRuntimeMeshExportLog()
+{
+    for (TAtomic<FChunk*>& chunk : chunks)
+    {
+        chunk = nullptr;
+    }
+}
+
+FRuntimeMeshExportLog::~FRuntimeMeshExportLog()
+{
+    Reset(minSeverity, bLogToUnreal);
+}
+
+void FRuntimeMeshExportLog::Reset(const ERuntimeMeshExportLogSeverity inMinSeverity, const bool bInLogToUnreal)
+{
+    for (TAtomic<FChunk*>& chunk : chunks)
+    {
+        delete chunk.Exchange(nullptr);
+    }
+    numClaimed = 0;
+    minSeverity = inMinSeverity;
+    bLogToUnreal = bInLogToUnreal;
+}
+
+void FRuntimeMeshExportLog::Add(const ERuntimeMeshExportLogSeverity severity, FString&& text)
+{
+    if (!IsLogged(severity))
+    {
+        return;
+    }
+
+    if (bLogToUnreal)
+    {
+        switch (severity)
+        {
+        case ERuntimeMeshExportLogSeverity::Error:
+            RMIE_LOG(Error, "%s", *text);
+            break;
+        case ERuntimeMeshExportLogSeverity::Warning:
+            RMIE_LOG(Warning, "%s", *text);
+            break;
+        default:
+            RMIE_LOG(Log, "%s", *text);
+        }
+    }
+
+    const int32 index = numClaimed++;
+    if (index >= maxChunks * entriesPerChunk)
+    {
+        return;
+    }
+    FEntry& entry = GetOrCreateChunk(index / entriesPerChunk)->entries[index % entriesPerChunk];
+    entry.text = MoveTemp(text);
+    entry.severity = severity;
+}
+
+FRuntimeMeshExportLog::FChunk* FRuntimeMeshExportLog::GetOrCreateChunk(const int32 chunkIndex)
+{
+    FChunk* chunk = chunks[chunkIndex].Load();
+    if (chunk)
+    {
+        return chunk;
+    }
+
+    // The slots of a chunk are claimed by several threads at once, the first one that gets to install it wins
+    FChunk* newChunk = new FChunk();
+    FChunk* expected = nullptr;
+    if (chunks[chunkIndex].CompareExchange(expected, newChunk))
+    {
+        return newChunk;
+    }
+    delete newChunk;
+    return expected;
+}
+
+FString FRuntimeMeshExportLog::ToString() const
+{
+    const int32 numClaimedNow = numClaimed.Load();
+    const int32 numEntries = FMath::Min(numClaimedNow, maxChunks * entriesPerChunk);
+
+    int32 length = 0;
+    for (int32 index = 0; index < numEntries; ++index)
+    {
+        length += chunks[index / entriesPerChunk].Load()->entries[index % entriesPerChunk].text.Len() + 10;
+    }
+
+    FString log;
+    log.Reserve(length + 64);
+    for (int32 index = 0; index < numEntries; ++index)
+    {
+        const FEntry& entry = chunks[index / entriesPerChunk].Load()->entries[index % entriesPerChunk];
+        if (index > 0)
+        {
+            log += TEXT("\n");
+        }
+        if (entry.severity == ERuntimeMeshExportLogSeverity::Error)
+        {
+            log += TEXT("Error: ");
+        }
+        else if (entry.severity == ERuntimeMeshExportLogSeverity::Warning)
+        {
+            log += TEXT("Warning: ");
+        }
+        log += entry.text;
+    }
+    if (numClaimedNow > numEntries)
+    {
+        log += FString::Printf(TEXT("\n%d more lines were dropped."), numClaimedNow - numEntries);
+    }
+    return log;
+}
@@ -0,0 +1,65 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+/**
+ *	The log of an export. Any thread can add lines without a lock, each one claims the next slot of a chunked buffer.
+ *	The lines are only joined into a string when the result wants them, in the order their slots were claimed.
+ *	Lines below the severity of Reset are dropped before they are formatted, @see FAssimpScene::WriteToLog.
+ */
+class FRuntimeMeshExportLog
+{
+public:
+    FRuntimeMeshExportLog();
+    ~FRuntimeMeshExportLog();
+    FRuntimeMeshExportLog(const FRuntimeMeshExportLog&) = delete;
+    FRuntimeMeshExportLog& operator=(const FRuntimeMeshExportLog&) = delete;
+
+    // Drops all lines. Not thread safe, only call it while nothing is logged.
+    void Reset(const ERuntimeMeshExportLogSeverity inMinSeverity, const bool bInLogToUnreal);
+
+    ERuntimeMeshExportLogSeverity GetMinSeverity() const
+    {
+        return minSeverity;
+    }
+
+    bool IsLogged(const ERuntimeMeshExportLogSeverity severity) const
+    {
+        return minSeverity != ERuntimeMeshExportLogSeverity::Off && severity >= minSeverity;
+    }
+
+    // Thread safe and lock free. Lines beyond the capacity are counted but not kept.
+    void Add(const ERuntimeMeshExportLogSeverity severity, FString&& text);
+
+    // One line per entry, warnings and errors are prefixed. Only call it when no thread adds anymore.
+    FString ToString() const;
+
+private:
+    struct FEntry
+    {
+        FString text;
+        ERuntimeMeshExportLogSeverity severity = ERuntimeMeshExportLogSeverity::Log;
+    };
+
+    static constexpr int32 entriesPerChunk = 512;
+    // More than a million lines, the chunks are only allocated when they are used
+    static constexpr int32 maxChunks = 2048;
+
+    struct FChunk
+    {
+        FEntry entries[entriesPerChunk];
+    };
+
+    FChunk* GetOrCreateChunk(const int32 chunkIndex);
+
+    TAtomic<FChunk*> chunks[maxChunks];
+    TAtomic<int32> numClaimed{ 0 };
+    ERuntimeMeshExportLogSeverity minSeverity = ERuntimeMeshExportLogSeverity::Log;
+    bool bLogToUnreal = false;
+};
@@ -0,0 +1,255 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshExportQueue.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshExporter.h"
+#include "Misc/QueuedThreadPool.h"
+#include "HAL/PlatformTime.h"
+
+// Assimp uses a lot of stack for some formats
+const uint32 exportQueueThreadStackSize = 1024 * 1024;
+
+void URuntimeMeshExportQueue::Deinitialize()
+{
+    FRuntimeMeshExportResultRef cancelledResult = MakeShared<FRuntimeMeshExportResult, ESPMode::ThreadSafe>();
+    cancelledResult->bSuccess = false;
+    cancelledResult->error = FString(TEXT("Export cancelled."));
+
+    // Running jobs are cancelled and finish on their own, their exporters stay rooted until then
+    TArray<FExportJob> cancelledJobs = MoveTemp(runningJobs);
+    runningJobs.Empty();
+    for (FExportJob& job : cancelledJobs)
+    {
+        job.param.param.cancellationToken.Cancel();
+        // The exporter falls back to the thread pool of the plugin when it is still gathering
+        job.exporter->SetExportThreadPool(nullptr);
+    }
+
+    for (FExportJob& job : queuedJobs)
+    {
+        job.exporter->RemoveFromRoot();
+    }
+    cancelledJobs.Append(MoveTemp(queuedJobs));
+    queuedJobs.Empty();
+
+    // The queue does not see the jobs finish anymore
+    for (FExportJob& job : cancelledJobs)
+    {
+        job.delegateFinished.ExecuteIfBound(job.id, cancelledResult);
+    }
+
+    // Waits for the work that already runs on the pool, the queued work moves to the thread pool of the plugin
+    DestroyThreadPool();
+
+    Super::Deinitialize();
+}
+
+int32 URuntimeMeshExportQueue::EnqueueExport_Cpp(URuntimeMeshExporter* exporter, const FRuntimeMeshExportAsyncParam& param, const ERuntimeMeshExportJobPriority priority
+        , FRuntimeMeshImportExportProgressUpdate callbackProgress
+        , FRuntimeImportExportGameThreadDone callbackGatherDone
+        , FRuntimeExportJobFinished callbackFinished)
+{
+    check(IsInGameThread());
+
+    if (!exporter || exporter->GetIsExporting() || IsQueuedOrRunning(exporter))
+    {
+        RMIE_LOG(Warning, "The exporter is not valid or already exporting!");
+        return INDEX_NONE;
+    }
+
+    FExportJob job;
+    job.id = nextJobId++;
+    job.exporter = exporter;
+    job.param = param;
+    job.priority = priority;
+    job.enqueueTime = FPlatformTime::Seconds();
+    job.delegateProgress = callbackProgress;
+    job.delegateGatherDone = callbackGatherDone;
+    job.delegateFinished = callbackFinished;
+    // CancelJob needs a token to cancel a running job with
+    if (!job.param.param.cancellationToken.IsValid())
+    {
+        job.param.param.cancellationToken = FRuntimeMeshImportExportCancellationToken::Create();
+    }
+
+    // Kept alive until the job is done, the export tasks point to it
+    exporter->AddToRoot();
+
+    // Behind the jobs of the same or a higher priority
+    const int32 insertIndex = queuedJobs.IndexOfByPredicate([priority](const FExportJob& queuedJob) {
+        return queuedJob.priority > priority;
+    });
+    const int32 jobId = job.id;
+    queuedJobs.Insert(MoveTemp(job), insertIndex == INDEX_NONE ? queuedJobs.Num() : insertIndex);
+
+    StartQueuedJobs();
+    return jobId;
+}
+
+int32 URuntimeMeshExportQueue::EnqueueExport(URuntimeMeshExporter* exporter, const FRuntimeMeshExportAsyncParam& param, const ERuntimeMeshExportJobPriority priority
+        , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate, FRuntimeExportJobFinishedDyn finishedDelegate)
+{
+    FRuntimeMeshImportExportProgressUpdate progressDelegateRaw;
+    progressDelegateRaw.BindLambda([progressDelegate](const FRuntimeMeshImportExportProgress& progress) {
+        progressDelegate.ExecuteIfBound(progress);
+    });
+
+    FRuntimeExportJobFinished finishedDelegateRaw;
+    finishedDelegateRaw.BindLambda([finishedDelegate](const int32 jobId, FRuntimeMeshExportResultRef result) {
+        finishedDelegate.ExecuteIfBound(jobId, *result);
+    });
+
+    return EnqueueExport_Cpp(exporter, param, priority, progressDelegateRaw, FRuntimeImportExportGameThreadDone(), finishedDelegateRaw);
+}
+
+bool URuntimeMeshExportQueue::CancelJob(const int32 jobId)
+{
+    check(IsInGameThread());
+
+    const int32 queuedIndex = queuedJobs.IndexOfByPredicate([jobId](const FExportJob& job) { return job.id == jobId; });
+    if (queuedIndex != INDEX_NONE)
+    {
+        FExportJob job = MoveTemp(queuedJobs[queuedIndex]);
+        queuedJobs.RemoveAt(queuedIndex);
+        job.exporter->RemoveFromRoot();
+
+        FRuntimeMeshExportResultRef result = MakeShared<FRuntimeMeshExportResult, ESPMode::ThreadSafe>();
+        result->bSuccess = false;
+        result->error = FString(TEXT("Export cancelled."));
+        job.delegateFinished.ExecuteIfBound(jobId, result);
+        return true;
+    }
+
+    const FExportJob* runningJob = runningJobs.FindByPredicate([jobId](const FExportJob& job) { return job.id == jobId; });
+    if (runningJob)
+    {
+        runningJob->param.param.cancellationToken.Cancel();
+        return true;
+    }
+    return false;
+}
+
+void URuntimeMeshExportQueue::SetMaxConcurrentExports(const int32 inMaxConcurrentExports)
+{
+    maxConcurrentExports = FMath::Max(inMaxConcurrentExports, 1);
+}
+
+FRuntimeMeshExportQueueStats URuntimeMeshExportQueue::GetStats() const
+{
+    FRuntimeMeshExportQueueStats stats;
+    stats.numQueued = queuedJobs.Num();
+    stats.numRunning = runningJobs.Num();
+    stats.numFinished = numFinished;
+    stats.averageWaitSeconds = numStarted > 0 ? float(totalWaitSeconds / numStarted) : 0.f;
+    stats.averageLatencySeconds = numFinished > 0 ? float(totalLatencySeconds / numFinished) : 0.f;
+    stats.lastLatencySeconds = float(lastLatencySeconds);
+    return stats;
+}
+
+void URuntimeMeshExportQueue::StartQueuedJobs()
+{
+    check(IsInGameThread());
+
+    // A job can finish right away, it does not start the next jobs from within this loop
+    if (bStartingJobs)
+    {
+        return;
+    }
+    TGuardValue<bool> startingGuard(bStartingJobs, true);
+
+    while (queuedJobs.Num() > 0 && runningJobs.Num() < maxConcurrentExports)
+    {
+        // One slot stays free for High jobs
+        const int32 numReservedSlots = maxConcurrentExports > 1 ? 1 : 0;
+        const int32 numRunningLower = runningJobs.FilterByPredicate([](const FExportJob& job) {
+            return job.priority != ERuntimeMeshExportJobPriority::High;
+        }).Num();
+        // The queue is sorted, so the first job is the one to start
+        if (queuedJobs[0].priority != ERuntimeMeshExportJobPriority::High && numRunningLower >= maxConcurrentExports - numReservedSlots)
+        {
+            break;
+        }
+
+        // Changes of the size apply once the pool is idle
+        if (threadPool && threadPoolSize != maxConcurrentExports && runningJobs.Num() == 0)
+        {
+            DestroyThreadPool();
+        }
+        if (!threadPool)
+        {
+            threadPool = FQueuedThreadPool::Allocate();
+            if (!threadPool->Create(maxConcurrentExports, exportQueueThreadStackSize, TPri_BelowNormal))
+            {
+                RMIE_LOG(Error, "Failed to create the thread pool for the export queue.");
+                delete threadPool;
+                threadPool = nullptr;
+                return;
+            }
+            threadPoolSize = maxConcurrentExports;
+        }
+
+        FExportJob& job = runningJobs.Add_GetRef(MoveTemp(queuedJobs[0]));
+        queuedJobs.RemoveAt(0);
+        ++numStarted;
+        totalWaitSeconds += FPlatformTime::Seconds() - job.enqueueTime;
+
+        TWeakObjectPtr<URuntimeMeshExportQueue> weakThis(this);
+        URuntimeMeshExporter* exporter = job.exporter;
+        const int32 jobId = job.id;
+        FRuntimeExportFinished finishedDelegate;
+        finishedDelegate.BindLambda([weakThis, exporter, jobId](FRuntimeMeshExportResultRef result) {
+            exporter->SetExportThreadPool(nullptr);
+            exporter->RemoveFromRoot();
+            if (URuntimeMeshExportQueue* queue = weakThis.Get())
+            {
+                queue->OnJobFinished(jobId, result);
+            }
+        });
+
+        exporter->SetExportThreadPool(threadPool);
+        // Copies, the job can be moved by the jobs that finish during the call
+        const FRuntimeMeshExportAsyncParam param = job.param;
+        const FRuntimeMeshImportExportProgressUpdate progressDelegate = job.delegateProgress;
+        const FRuntimeImportExportGameThreadDone gatherDoneDelegate = job.delegateGatherDone;
+        exporter->Export_Async_Cpp(param, progressDelegate, gatherDoneDelegate, finishedDelegate);
+    }
+}
+
+void URuntimeMeshExportQueue::OnJobFinished(const int32 jobId, FRuntimeMeshExportResultRef result)
+{
+    check(IsInGameThread());
+
+    const int32 runningIndex = runningJobs.IndexOfByPredicate([jobId](const FExportJob& job) { return job.id == jobId; });
+    if (runningIndex == INDEX_NONE)
+    {
+        return;
+    }
+
+    FExportJob job = MoveTemp(runningJobs[runningIndex]);
+    runningJobs.RemoveAt(runningIndex);
+    ++numFinished;
+    lastLatencySeconds = FPlatformTime::Seconds() - job.enqueueTime;
+    totalLatencySeconds += lastLatencySeconds;
+
+    job.delegateFinished.ExecuteIfBound(jobId, result);
+    StartQueuedJobs();
+}
+
+bool URuntimeMeshExportQueue::IsQueuedOrRunning(const URuntimeMeshExporter* exporter) const
+{
+    auto usesExporter = [exporter](const FExportJob& job) { return job.exporter == exporter; };
+    return queuedJobs.ContainsByPredicate(usesExporter) || runningJobs.ContainsByPredicate(usesExporter);
+}
+
+void URuntimeMeshExportQueue::DestroyThreadPool()
+{
+    if (threadPool)
+    {
+        threadPool->Destroy();
+        delete threadPool;
+        threadPool = nullptr;
+        threadPoolSize = 0;
+    }
+}
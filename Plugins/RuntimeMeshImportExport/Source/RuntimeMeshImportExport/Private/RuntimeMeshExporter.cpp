@@ -4,24 +4,139 @@
 
 #include "RuntimeMeshExporter.h"
 #include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportThreadPool.h"
 #include "assimp/scene.h"
 #include "assimp/Exporter.hpp"
-#include "assimp/DefaultLogger.hpp"
 #include "assimp/postprocess.h"
 #include "Engine/Engine.h"
-#include "assimp/LogStream.hpp"
 #include "RuntimeMeshImportExportLibrary.h"
 #include "HAL/PlatformFileManager.h"
 #include "HAL/PlatformFile.h"
+#include "HAL/PlatformTime.h"
 #include "Vector"
 #include "ProfilingDebugging/ScopedTimers.h"
 #include "Async/Async.h"
+#include "Misc/QueuedThreadPool.h"
 #include "Misc/Paths.h"
 #include "string.h"
 #include "AssimpProgressHandler.h"
+#include "RuntimeMeshTextureBuilder.h"
+#include "RuntimeMeshStreamWriter.h"
+#include "AssimpLogRouter.h"
+#include "AssimpIOSystem.h"
+#include "RuntimeMeshImportExportStats.h"
+#include "RuntimeMeshComponentExportables.h"
 
 const unsigned int exportFlags = aiPostProcessSteps::aiProcess_MakeLeftHanded;
 
+namespace
+{
+    // Within the text of these formats the other files are referenced by the placeholder name of the blob export
+    bool ReferencesBlobFiles(const FString& formatId)
+    {
+        return formatId == TEXT("obj") || formatId == TEXT("gltf") || formatId == TEXT("gltf2");
+    }
+
+    void ReplaceBlobFileName(TArray<uint8>& data, const FString& baseName)
+    {
+        // AI_BLOBIO_MAGIC of BlobIOSystem.h
+        const ANSICHAR* placeholder = "$blobfile";
+        const int32 placeholderLength = FCStringAnsi::Strlen(placeholder);
+        const FTCHARToUTF8 replacement(*baseName);
+        TArray<uint8> replaced;
+        replaced.Reserve(data.Num());
+        for (int32 index = 0; index < data.Num(); ++index)
+        {
+            if (data[index] == placeholder[0] && index + placeholderLength <= data.Num()
+                && FMemory::Memcmp(&data[index], placeholder, placeholderLength) == 0)
+            {
+                replaced.Append(reinterpret_cast<const uint8*>(replacement.Get()), replacement.Length());
+                index += placeholderLength - 1;
+                continue;
+            }
+            replaced.Add(data[index]);
+        }
+        data = MoveTemp(replaced);
+    }
+
+    // Exports to 'param.file', or with 'param.bExportToMemory' into the exported files of 'scene'.
+    // 'outWriteError' gets the failed writes of the buffered file writes.
+    aiReturn ExportWithAssimp(Assimp::Exporter& exporter, FAssimpScene& scene, const FRuntimeMeshExportParam& param, FString& outWriteError)
+    {
+        SCOPE_CYCLE_COUNTER(STAT_RMIE_ExportAssimpWrite);
+        RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+        if (!param.bExportToMemory)
+        {
+            if (!param.bBufferedFileWrites)
+            {
+                const aiReturn exportReturn = exporter.Export(&scene, TCHAR_TO_ANSI(*param.formatId), TCHAR_TO_ANSI(*param.file), exportFlags);
+                scene.metricsBytesWritten.Add(FMath::Max<int64>(FPlatformFileManager::Get().GetPlatformFile().FileSize(*param.file), 0));
+                return exportReturn;
+            }
+
+            // Owned by 'exporter', the writers close their files before Export returns
+            FAssimpExportIOSystem* ioSystem = new FAssimpExportIOSystem(param.fileWriteBufferSizeKB * 1024);
+            exporter.SetIOHandler(ioSystem);
+            aiReturn exportReturn = exporter.Export(&scene, TCHAR_TO_ANSI(*param.formatId), TCHAR_TO_UTF8(*param.file), exportFlags);
+            outWriteError = ioSystem->GetWriteError();
+            scene.metricsBytesWritten.Add(ioSystem->GetBytesWritten());
+            if (!outWriteError.IsEmpty() && exportReturn == aiReturn_SUCCESS)
+            {
+                exportReturn = aiReturn_FAILURE;
+            }
+            return exportReturn;
+        }
+
+        // Owned by 'exporter'
+        const aiExportDataBlob* blob = exporter.ExportToBlob(&scene, TCHAR_TO_ANSI(*param.formatId), exportFlags);
+        if (!blob)
+        {
+            return aiReturn_FAILURE;
+        }
+
+        // The first blob is the exported file, the others are named by what Assimp appended to the file name, e.g. "mtl" or "bin"
+        const FString baseName = FPaths::GetBaseFilename(param.file);
+        for (const aiExportDataBlob* fileBlob = blob; fileBlob; fileBlob = fileBlob->next)
+        {
+            FRuntimeMeshExportedFile file;
+            file.name = fileBlob == blob ? FPaths::GetCleanFilename(param.file) : baseName + TEXT(".") + UTF8_TO_TCHAR(fileBlob->name.C_Str());
+            file.data.Append(static_cast<const uint8*>(fileBlob->data), int32(fileBlob->size));
+            if (fileBlob == blob && ReferencesBlobFiles(param.formatId))
+            {
+                ReplaceBlobFileName(file.data, baseName);
+            }
+            scene.AddExportedFile(param, MoveTemp(file));
+        }
+        return aiReturn_SUCCESS;
+    }
+
+    // Unlike the work of AsyncPool, abandoned work still runs, so the exporter leaves the root set and calls its callbacks
+    class FExportWork : public IQueuedWork
+    {
+    public:
+        FExportWork(TUniqueFunction<void()>&& inWork)
+            : work(MoveTemp(inWork))
+        {
+        }
+
+        virtual void DoThreadedWork() override
+        {
+            work();
+            delete this;
+        }
+
+        // The pool is destroyed on the GameThread, the export must not run there, so it moves to the thread pool of the plugin
+        virtual void Abandon() override
+        {
+            FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread(MoveTemp(work));
+            delete this;
+        }
+
+    private:
+        TUniqueFunction<void()> work;
+    };
+}
+
 URuntimeMeshExporter::URuntimeMeshExporter()
 {
     // Make sure Assimp does not use double precision
@@ -48,10 +163,7 @@ void URuntimeMeshExporter::AddNode(const FString& hierarchicalName, const FTrans
     }
 
     check(scene && scene->rootNode);
-    TArray<FString> nodeList;
-    hierarchicalName.ParseIntoArray(nodeList, TEXT("."), true);
-
-    FAssimpNode* foundNode = scene->rootNode->FindOrCreateNode(nodeList);
+    FAssimpNode* foundNode = scene->FindOrCreateNode(hierarchicalName);
 
     foundNode->worldTransform = nodeTransformWS;
 }
@@ -65,9 +177,7 @@ void URuntimeMeshExporter::AddExportObject(const TScriptInterface<IMeshExportabl
     }
 
     check(scene && scene->rootNode);
-    TArray<FString> nodeList;
-    (bOverrideNode ? hierarchicalNodeName : exportable->Execute_GetHierarchicalNodeName(exportable.GetObject())).ParseIntoArray(nodeList, TEXT("."), true);
-    scene->rootNode->FindOrCreateNode(nodeList)->exportObjects.Add(exportable);
+    scene->FindOrCreateNode(bOverrideNode ? hierarchicalNodeName : exportable->Execute_GetHierarchicalNodeName(exportable.GetObject()))->exportObjects.Add(exportable);
 }
 
 void URuntimeMeshExporter::AddExportObjects(const TArray<TScriptInterface<IMeshExportable>>& exportables, const bool bOverrideNode, const FString& hierarchicalNodeName)
@@ -78,9 +188,25 @@ void URuntimeMeshExporter::AddExportObjects(const TArray<TScriptInterface<IMeshE
         return;
     }
 
+    check(scene && scene->rootNode);
+    if (bOverrideNode)
+    {
+        scene->FindOrCreateNode(hierarchicalNodeName)->exportObjects.Append(exportables);
+        return;
+    }
+
+    // Exportables of the same node usually follow each other, the node is only looked up when the name changes
+    FString lastNodeName;
+    FAssimpNode* lastNode = nullptr;
     for (const TScriptInterface<IMeshExportable>& object : exportables)
     {
-        AddExportObject(object, bOverrideNode, hierarchicalNodeName);
+        FString nodeName = object->Execute_GetHierarchicalNodeName(object.GetObject());
+        if (!lastNode || nodeName != lastNodeName)
+        {
+            lastNode = scene->FindOrCreateNode(nodeName);
+            lastNodeName = MoveTemp(nodeName);
+        }
+        lastNode->exportObjects.Add(object);
     }
 }
 
@@ -119,6 +245,42 @@ void URuntimeMeshExporter::AddObjectsIfExportable(UPARAM(ref) TArray<UObject*>&
     }
 }
 
+bool URuntimeMeshExporter::AddComponent(UPrimitiveComponent* component, const bool bOverrideNode, const FString& hierarchicalNodeName)
+{
+    if (bIsExporting)
+    {
+        RMIE_LOG(Warning, "Currently exporting, you should not call functions on the exporter!");
+        return false;
+    }
+
+    UObject* exportable = URuntimeMeshComponentExportable::CreateForComponent(component, this);
+    if (!exportable)
+    {
+        return false;
+    }
+    componentExportables.Add(exportable);
+    AddExportObject(TScriptInterface<IMeshExportable>(exportable), bOverrideNode, hierarchicalNodeName);
+    return true;
+}
+
+void URuntimeMeshExporter::AddComponents(UPARAM(ref) TArray<UPrimitiveComponent*>& components, const bool bOverrideNode, const FString& hierarchicalNodeName
+    , TArray<UPrimitiveComponent*>& notExportable)
+{
+    if (bIsExporting)
+    {
+        RMIE_LOG(Warning, "Currently exporting, you should not call functions on the exporter!");
+        return;
+    }
+
+    for (UPrimitiveComponent* component : components)
+    {
+        if (!AddComponent(component, bOverrideNode, hierarchicalNodeName))
+        {
+            notExportable.Add(component);
+        }
+    }
+}
+
 void URuntimeMeshExporter::Export(const FRuntimeMeshExportParam& param, FRuntimeMeshExportResult& result)
 {
     if (!PreExportWork(param, result))
@@ -129,31 +291,59 @@ void URuntimeMeshExporter::Export(const FRuntimeMeshExportParam& param, FRuntime
 
     FAssimpScene& sceneRef = *scene;
 
+    if (FAssimpScene::UsesStreamWriter(param, false))
+    {
+        FString writerError;
+        const double startTimeWrite = FPlatformTime::Seconds();
+        aiExporterReturn = sceneRef.ExportWithStreamWriter(param, false, writerError) ? aiReturn_SUCCESS : aiReturn_FAILURE;
+        sceneRef.stageTimings.writeSeconds = float(FPlatformTime::Seconds() - startTimeWrite);
+        aiExporterError = writerError;
+        result.bSuccess = PostExportWork(result);
+        return;
+    }
+    else if (param.bExportToMemory && (param.bStreamingExport || param.bNativeGltfExport))
+    {
+        sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("The export to memory uses the regular export."));
+    }
+    else if (param.bStreamingExport)
+    {
+        sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Warning, TEXT("Format %s can not be exported streaming, using the regular export."), *param.formatId);
+    }
+
     // Prepare the scene
     sceneRef.PrepareSceneForExport(param);
-    sceneRef.WriteToLogWithNewLine(FString::Printf(TEXT("Scene does contain %d meshes."), sceneRef.mNumMeshes));
-    sceneRef.WriteToLogWithNewLine(FString::Printf(TEXT("Scene does contain %d materials."), sceneRef.mNumMaterials));
+    sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Scene does contain %d meshes."), sceneRef.mNumMeshes);
+    sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Scene does contain %d materials."), sceneRef.mNumMaterials);
 
     // Do the export
     Assimp::Exporter exporter;
+    FString writeError;
+    FAssimpLogRouter::FScopedTarget logTarget(sceneRef);
     try
     {
-    sceneRef.WriteToLogWithNewLine(FString(TEXT("Begin export scene.")));
+    sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Begin export scene."));
     double duration = 0.f;
     {
         FScopedDurationTimer timer(duration);
-        aiExporterReturn = exporter.Export(&sceneRef, TCHAR_TO_ANSI(*param.formatId), TCHAR_TO_ANSI(*param.file), exportFlags);
+        const double startTimeWrite = FPlatformTime::Seconds();
+        aiExporterReturn = ExportWithAssimp(exporter, sceneRef, param, writeError);
+        sceneRef.stageTimings.writeSeconds = float(FPlatformTime::Seconds() - startTimeWrite);
+        sceneRef.FinishTextureExport();
     }
-    sceneRef.WriteToLogWithNewLine(FString::Printf(TEXT("End export scene. Duration: %.3fs"), duration));
+    sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("End export scene. Duration: %.3fs"), duration);
     }
     catch (const std::exception& e)
     {
     	FString exceptionString = FString::Printf(TEXT("Exception thrown during export: %s"), ANSI_TO_TCHAR(e.what()));
-    	sceneRef.WriteToLogWithNewLine(exceptionString);
+    	sceneRef.WriteTextToLog(ERuntimeMeshExportLogSeverity::Error, exceptionString);
     	URuntimeMeshImportExportLibrary::NewLineAndAppend(result.error, exceptionString);
     	RMIE_LOG(Error, "%s", *exceptionString);
     }
     aiExporterError = FString(exporter.GetErrorString());
+    if (!writeError.IsEmpty())
+    {
+        URuntimeMeshImportExportLibrary::NewLineAndAppend(aiExporterError, writeError);
+    }
 
     result.bSuccess = PostExportWork(result);
     return;
@@ -166,7 +356,7 @@ void URuntimeMeshExporter::Export_Async_Cpp(const FRuntimeMeshExportAsyncParam p
     if (!PreExportWork(param.param, asyncResult))
     {
         asyncResult.bSuccess = false;
-        callbackFinished.ExecuteIfBound(asyncResult);
+        callbackFinished.ExecuteIfBound(MakeShared<FRuntimeMeshExportResult, ESPMode::ThreadSafe>(asyncResult));
         return;
     }
 
@@ -174,12 +364,40 @@ void URuntimeMeshExporter::Export_Async_Cpp(const FRuntimeMeshExportAsyncParam p
     delegateGatherDone = callbackGatherDone;
     delegateFinished = callbackFinished;
 
+    if (param.param.bStreamingExport && !param.param.bExportToMemory && !FAssimpScene::UsesStreamWriter(param.param, true))
+    {
+        scene->WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("The streaming export is only available for the synchronous export, using the regular export."));
+    }
+
     scene->PrepareSceneForExport_Async_Start(param, callbackProgress, [this, param]() {
         delegateGatherDone.ExecuteIfBound();
-        AsyncTask(ENamedThreads::AnyThread, [this, param]() {
-            this->Export_Async_AnyThread(param.param);
-        });
+        if (exportThreadPool)
+        {
+            exportThreadPool->AddQueuedWork(new FExportWork([this, param]() {
+                this->Export_Async_AnyThread(param.param);
+            }));
+        }
+        else
+        {
+            FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([this, param]() {
+                this->Export_Async_AnyThread(param.param);
+            });
+        }
+    });
+}
+
+TFuture<FRuntimeMeshExportResultPtr> URuntimeMeshExporter::Export_Future(const FRuntimeMeshExportAsyncParam& param, FRuntimeMeshImportExportProgressUpdate callbackProgress
+        , FRuntimeImportExportGameThreadDone callbackGatherDone)
+{
+    // A delegate copies its lambda, the promise cannot be copied
+    TSharedRef<TPromise<FRuntimeMeshExportResultPtr>, ESPMode::ThreadSafe> promise = MakeShared<TPromise<FRuntimeMeshExportResultPtr>, ESPMode::ThreadSafe>();
+    FRuntimeExportFinished callbackFinished;
+    callbackFinished.BindLambda([promise](FRuntimeMeshExportResultRef result) {
+        promise->SetValue(result);
     });
+    TFuture<FRuntimeMeshExportResultPtr> future = promise->GetFuture();
+    Export_Async_Cpp(param, callbackProgress, callbackGatherDone, callbackFinished);
+    return future;
 }
 
 
@@ -207,9 +425,9 @@ public:
         });
 
         FRuntimeExportFinished finishedDelegateRaw;
-        finishedDelegateRaw.BindLambda([this](FRuntimeMeshExportResult delegateResult) {
+        finishedDelegateRaw.BindLambda([this](FRuntimeMeshExportResultRef delegateResult) {
             check(IsInGameThread());
-            result = MoveTemp(delegateResult);
+            result = MoveTemp(*delegateResult);
             bExportFinished = true;
         });
 
@@ -261,40 +479,81 @@ bool URuntimeMeshExporter::GetIsExporting()
     return bIsExporting;
 }
 
+void URuntimeMeshExporter::SetExportThreadPool(FQueuedThreadPool* pool)
+{
+    exportThreadPool = pool;
+}
+
 void URuntimeMeshExporter::Export_Async_AnyThread(const FRuntimeMeshExportParam param)
 {
     check(!IsInGameThread());
 
     FAssimpScene& sceneRef = *scene;
+    if (FAssimpScene::UsesStreamWriter(param, true))
+    {
+        FString writerError;
+        const double startTimeWrite = FPlatformTime::Seconds();
+        aiExporterReturn = sceneRef.ExportWithStreamWriter(param, true, writerError) ? aiReturn_SUCCESS : aiReturn_FAILURE;
+        sceneRef.stageTimings.writeSeconds = float(FPlatformTime::Seconds() - startTimeWrite);
+        aiExporterError = writerError;
+        sceneRef.ClearSceneExportData();
+        AsyncTask(ENamedThreads::GameThread, [this]() {
+            Export_Async_Finish();
+        });
+        return;
+    }
     sceneRef.PrepareSceneForExport_Async_Finish(param);
-    sceneRef.WriteToLogWithNewLine(FString::Printf(TEXT("Scene does contain %d meshes."), sceneRef.mNumMeshes));
-    sceneRef.WriteToLogWithNewLine(FString::Printf(TEXT("Scene does contain %d materials."), sceneRef.mNumMaterials));
+
+    // Cancelled during gathering or processing, the scene is incomplete
+    if (param.cancellationToken.IsCancelled())
+    {
+        sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Export cancelled."));
+        aiExporterError = FString(TEXT("Export cancelled."));
+        sceneRef.ClearSceneExportData();
+        AsyncTask(ENamedThreads::GameThread, [this]() {
+            Export_Async_Finish();
+        });
+        return;
+    }
+
+    sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Scene does contain %d meshes."), sceneRef.mNumMeshes);
+    sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Scene does contain %d materials."), sceneRef.mNumMaterials);
     
-    //for debuging
-    for (unsigned int i = 0; i < sceneRef.mNumMaterials; i++)
+    if (sceneRef.IsLogged(ERuntimeMeshExportLogSeverity::Verbose))
     {
-        
-        sceneRef.WriteToLogWithNewLine(FString::Printf(TEXT(" oooo material name = %s"), *sceneRef.mMaterials[i]->GetName().C_Str()));
+        for (unsigned int i = 0; i < sceneRef.mNumMaterials; i++)
+        {
+            sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Verbose, TEXT("Material name = %s"), UTF8_TO_TCHAR(sceneRef.mMaterials[i]->GetName().C_Str()));
+        }
     }
 
     Assimp::Exporter exporter;
-	FAssimpProgressHandler progressHandler(delegateProgress);
+    FString writeError;
+    FAssimpLogRouter::FScopedTarget logTarget(sceneRef);
+	FAssimpProgressHandler progressHandler(FRuntimeMeshImportExportProgressCoalescer::Create(delegateProgress), param.cancellationToken);
     exporter.SetProgressHandler(&progressHandler);
 
     //AsyncTask(ENamedThreads::GameThread, [this]() {
     //    delegateStatus.ExecuteIfBound(FString(TEXT("Exporting scene with Assimp.")));
     //});
 
-    sceneRef.WriteToLogWithNewLine(FString(TEXT("Begin export scene.")));
+    sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("Begin export scene."));
     double duration = 0.f;
     {
         FScopedDurationTimer timer(duration);
-        aiExporterReturn = exporter.Export(scene, TCHAR_TO_ANSI(*param.formatId), TCHAR_TO_ANSI(*param.file), exportFlags);
+        const double startTimeWrite = FPlatformTime::Seconds();
+        aiExporterReturn = ExportWithAssimp(exporter, sceneRef, param, writeError);
+        sceneRef.stageTimings.writeSeconds = float(FPlatformTime::Seconds() - startTimeWrite);
+        sceneRef.FinishTextureExport();
     }
     exporter.SetProgressHandler(nullptr);
-    sceneRef.WriteToLogWithNewLine(FString::Printf(TEXT("End export scene. Duration: %.3fs"), duration));
+    sceneRef.WriteToLog(ERuntimeMeshExportLogSeverity::Log, TEXT("End export scene. Duration: %.3fs"), duration);
 
     aiExporterError = FString(exporter.GetErrorString());
+    if (!writeError.IsEmpty())
+    {
+        URuntimeMeshImportExportLibrary::NewLineAndAppend(aiExporterError, writeError);
+    }
 
     /*AsyncTask(ENamedThreads::GameThread, [this]() {
         delegateProgress.ExecuteIfBound(FString(TEXT("Clearing export data.")));
@@ -312,13 +571,15 @@ void URuntimeMeshExporter::Export_Async_Finish()
     check(IsInGameThread());
     asyncResult.bSuccess = PostExportWork(asyncResult);
 
-    delegateFinished.ExecuteIfBound(asyncResult);
+    // The exported files are moved, not copied
+    delegateFinished.ExecuteIfBound(MakeShared<FRuntimeMeshExportResult, ESPMode::ThreadSafe>(MoveTemp(asyncResult)));
     delegateProgress.Unbind();
     delegateGatherDone.Unbind();
     delegateFinished.Unbind();
     asyncResult.error.Empty();
     asyncResult.exportLog.Empty();
     asyncResult.numObjectsSkipped = 0;
+    asyncResult.files.Empty();
 }
 
 bool URuntimeMeshExporter::PreExportWork(const FRuntimeMeshExportParam& param, FRuntimeMeshExportResult& result)
@@ -336,31 +597,43 @@ bool URuntimeMeshExporter::PreExportWork(const FRuntimeMeshExportParam& param, F
     aiExporterReturn = aiReturn_FAILURE;
     aiExporterError.Empty();
 
-    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
-
-    if (!param.bOverrideExisting)
+    // Nothing is written to 'param.file' when exporting to memory
+    if (!param.bExportToMemory)
     {
-        if (platformFile.FileExists(*param.file))
+        IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+        if (!param.bOverrideExisting)
         {
-            URuntimeMeshImportExportLibrary::NewLineAndAppend(result.error, FString::Printf(TEXT("File %s does already exist!"), *param.file));
-            return false;
+            if (platformFile.FileExists(*param.file))
+            {
+                URuntimeMeshImportExportLibrary::NewLineAndAppend(result.error, FString::Printf(TEXT("File %s does already exist!"), *param.file));
+                return false;
+            }
         }
-    }
 
-    // Assimp can only write to a directory that exists.
-    // Make sure it does.
-    if (!platformFile.CreateDirectoryTree(*FPaths::GetPath(param.file)))
-    {
-        URuntimeMeshImportExportLibrary::NewLineAndAppend(result.error, FString::Printf(TEXT("Could not create directory: %s"), *FPaths::GetPath(param.file)));
-        return false;
+        // Assimp can only write to a directory that exists.
+        // Make sure it does.
+        if (!platformFile.CreateDirectoryTree(*FPaths::GetPath(param.file)))
+        {
+            URuntimeMeshImportExportLibrary::NewLineAndAppend(result.error, FString::Printf(TEXT("Could not create directory: %s"), *FPaths::GetPath(param.file)));
+            return false;
+        }
     }
 
-    // Create log stuff
-    scene->bLogToUnreal = param.bLogToUnreal;
-    scene->exportLog = &result.exportLog;
-    assimpLogger = Assimp::DefaultLogger::create("", Assimp::Logger::NORMAL);
-    exportLogger = new FExportLogger(*scene);
-    assimpLogger->attachStream(exportLogger);
+    // The textures are encoded on worker threads
+    FRuntimeMeshTextureBuilder::LoadModules_GameThread();
+
+    // Create log stuff. The messages of Assimp reach the scene through FAssimpLogRouter::FScopedTarget around the export.
+    scene->log.Reset(param.exportLogSeverity, param.bLogToUnreal);
+    result.files.Empty();
+    scene->exportedFiles = &result.files;
+    scene->stageTimings = FRuntimeMeshExportStageTimings();
+    scene->metrics = FRuntimeMeshExportMetrics();
+    scene->metricsBytesWritten.Reset();
+    scene->metricsThreadCycles.Reset();
+    exportStartTime = FPlatformTime::Seconds();
+    exportStartUsedPhysical = FRuntimeMeshMetrics::GetUsedPhysical();
+    FAssimpLogRouter::Startup();
 
     bIsExporting = true;
 
@@ -402,12 +675,15 @@ bool URuntimeMeshExporter::PostExportWork(FRuntimeMeshExportResult& result)
     }
 
     // Get rid of log stuff
-    scene->exportLog = nullptr;
-    assimpLogger->detatchStream(exportLogger);
-    delete exportLogger;
-    exportLogger = nullptr;
-    assimpLogger = nullptr;
-    Assimp::DefaultLogger::kill(); // kill assimpLogger instance.
+    result.exportLog = scene->log.ToString();
+    scene->log.Reset(scene->log.GetMinSeverity(), false);
+    scene->exportedFiles = nullptr;
+    scene->stageTimings.totalSeconds = float(FPlatformTime::Seconds() - exportStartTime);
+    result.timings = scene->stageTimings;
+    scene->metrics.bytesWritten = scene->metricsBytesWritten.GetValue();
+    scene->metrics.threadSeconds = FRuntimeMeshMetrics::CyclesToSeconds(scene->metricsThreadCycles);
+    FRuntimeMeshMetrics::SetMemory(scene->metrics, exportStartUsedPhysical);
+    result.metrics = scene->metrics;
 
     // Cleanup
     result.numObjectsSkipped = scene->numObjectsSkipped;
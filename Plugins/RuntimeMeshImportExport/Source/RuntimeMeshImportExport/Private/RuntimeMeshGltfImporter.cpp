@@ -0,0 +1,1099 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshGltfImporter.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "AssimpIOSystem.h"
+#include "MeshConversionKernels.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/Base64.h"
+#include "Misc/Paths.h"
+#include "Misc/Parse.h"
+
+namespace
+{
+    enum EGltfComponentType : int32
+    {
+        ComponentByte = 5120,
+        ComponentUnsignedByte = 5121,
+        ComponentShort = 5122,
+        ComponentUnsignedShort = 5123,
+        ComponentUnsignedInt = 5125,
+        ComponentFloat = 5126,
+    };
+
+    enum EGltfMode : int32
+    {
+        ModeTriangles = 4,
+        ModeTriangleStrip = 5,
+        ModeTriangleFan = 6,
+    };
+
+    const uint32 glbMagic = 0x46546C67;
+    const uint32 glbChunkJson = 0x4E4F534A;
+    const uint32 glbChunkBin = 0x004E4942;
+
+    // The extensions that do not change how the file has to be read
+    const TCHAR* const supportedRequiredExtensions[] = {
+        TEXT("KHR_mesh_quantization"),
+        TEXT("KHR_materials_pbrSpecularGlossiness"),
+        TEXT("KHR_materials_unlit"),
+        TEXT("KHR_texture_transform"),
+    };
+
+    const TArray<TSharedPtr<FJsonValue>>& GetArray(const FJsonObject& object, const TCHAR* field)
+    {
+        static const TArray<TSharedPtr<FJsonValue>> empty;
+        const TArray<TSharedPtr<FJsonValue>>* values = nullptr;
+        return object.TryGetArrayField(field, values) ? *values : empty;
+    }
+
+    const FJsonObject* GetObject(const FJsonObject& object, const TCHAR* field)
+    {
+        const TSharedPtr<FJsonObject>* value = nullptr;
+        return object.TryGetObjectField(field, value) && value->IsValid() ? value->Get() : nullptr;
+    }
+
+    // nullptr when the element is not an object, the file is then not valid
+    const FJsonObject* GetElementObject(const TArray<TSharedPtr<FJsonValue>>& values, const int32 index)
+    {
+        const TSharedPtr<FJsonObject>* value = nullptr;
+        return values.IsValidIndex(index) && values[index].IsValid() && values[index]->TryGetObject(value) && value->IsValid() ? value->Get() : nullptr;
+    }
+
+    int32 GetInt(const FJsonObject& object, const TCHAR* field, const int32 defaultValue)
+    {
+        double value;
+        return object.TryGetNumberField(field, value) ? static_cast<int32>(value) : defaultValue;
+    }
+
+    // Offsets and lengths of buffers can be larger than an int32
+    int64 GetInt64(const FJsonObject& object, const TCHAR* field, const int64 defaultValue)
+    {
+        double value;
+        return object.TryGetNumberField(field, value) ? static_cast<int64>(value) : defaultValue;
+    }
+
+    float GetFloat(const FJsonObject& object, const TCHAR* field, const float defaultValue)
+    {
+        double value;
+        return object.TryGetNumberField(field, value) ? static_cast<float>(value) : defaultValue;
+    }
+
+    // Reads 3 or 4 numbers, the missing ones are taken from 'defaultValue'
+    FLinearColor GetColor(const FJsonObject& object, const TCHAR* field, const FLinearColor& defaultValue)
+    {
+        FLinearColor color = defaultValue;
+        const TArray<TSharedPtr<FJsonValue>>& values = GetArray(object, field);
+        float* components = &color.R;
+        for (int32 index = 0; index < FMath::Min(values.Num(), 4); ++index)
+        {
+            components[index] = static_cast<float>(values[index]->AsNumber());
+        }
+        return color;
+    }
+
+    // The index of a textureInfo object, INDEX_NONE when there is none
+    int32 GetTextureIndex(const FJsonObject* object, const TCHAR* field)
+    {
+        const FJsonObject* textureInfo = object ? GetObject(*object, field) : nullptr;
+        return textureInfo ? GetInt(*textureInfo, TEXT("index"), INDEX_NONE) : INDEX_NONE;
+    }
+
+    int32 GetComponentSize(const int32 componentType)
+    {
+        switch (componentType)
+        {
+        case ComponentByte:
+        case ComponentUnsignedByte:
+            return 1;
+        case ComponentShort:
+        case ComponentUnsignedShort:
+            return 2;
+        case ComponentUnsignedInt:
+        case ComponentFloat:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    int32 GetNumComponents(const FString& type)
+    {
+        if (type == TEXT("SCALAR")) return 1;
+        if (type == TEXT("VEC2")) return 2;
+        if (type == TEXT("VEC3")) return 3;
+        if (type == TEXT("VEC4")) return 4;
+        // Matrices are not used by the streams of a primitive
+        return 0;
+    }
+
+    // Uris can contain escaped characters, e.g. %20 for a space
+    FString DecodeUri(const FString& uri)
+    {
+        FString decoded;
+        decoded.Reserve(uri.Len());
+        for (int32 index = 0; index < uri.Len(); ++index)
+        {
+            if (uri[index] == TEXT('%') && index + 2 < uri.Len() && FChar::IsHexDigit(uri[index + 1]) && FChar::IsHexDigit(uri[index + 2]))
+            {
+                decoded.AppendChar(static_cast<TCHAR>(FParse::HexDigit(uri[index + 1]) * 16 + FParse::HexDigit(uri[index + 2])));
+                index += 2;
+            }
+            else
+            {
+                decoded.AppendChar(uri[index]);
+            }
+        }
+        return decoded;
+    }
+
+    // Decodes a data uri with base64 content, 'outMimeType' gets the type in front of it
+    bool DecodeDataUri(const FString& uri, TArray<uint8>& outData, FString& outMimeType)
+    {
+        const int32 base64Index = uri.Find(TEXT(";base64,"), ESearchCase::IgnoreCase);
+        if (!uri.StartsWith(TEXT("data:")) || base64Index == INDEX_NONE)
+        {
+            return false;
+        }
+        outMimeType = uri.Mid(5, base64Index - 5);
+        return FBase64::Decode(uri.Mid(base64Index + 8), outData);
+    }
+
+    // The 3 character format Assimp writes to aiTexture::achFormatHint
+    FString GetFormatHint(const FString& mimeType)
+    {
+        FString format = mimeType;
+        format.RemoveFromStart(TEXT("image/"));
+        format = format.ToLower();
+        if (format == TEXT("jpeg"))
+        {
+            return TEXT("jpg");
+        }
+        return format.Len() <= 3 ? format : FString();
+    }
+
+    template<typename T>
+    void ConvertComponents(const uint8* data, const int32 stride, const int32 count, const int32 numComponents, const bool bNormalized, float* out, const int32 outStride)
+    {
+        // The spec defines a normalized value as c / max, clamped to -1 for the signed types
+        const float scale = bNormalized ? 1.f / static_cast<float>(TNumericLimits<T>::Max()) : 1.f;
+        const float minValue = bNormalized ? -1.f : -MAX_flt;
+        for (int32 element = 0; element < count; ++element)
+        {
+            const uint8* elementData = data + static_cast<int64>(element) * stride;
+            float* outElement = out + static_cast<int64>(element) * outStride;
+            for (int32 component = 0; component < numComponents; ++component)
+            {
+                T value;
+                FMemory::Memcpy(&value, elementData + component * sizeof(T), sizeof(T));
+                outElement[component] = FMath::Max(static_cast<float>(value) * scale, minValue);
+            }
+        }
+    }
+
+    template<typename T>
+    void ConvertIndices(const uint8* data, const int32 count, int32* out)
+    {
+        for (int32 index = 0; index < count; ++index)
+        {
+            T value;
+            FMemory::Memcpy(&value, data + index * sizeof(T), sizeof(T));
+            out[index] = static_cast<int32>(value);
+        }
+    }
+
+    /**
+     * Accumulates the tangent of each triangle at its vertices and makes the sums perpendicular to the normals.
+     * The tangent follows U, so it does not depend on the direction of V.
+     */
+    void CalcTangents(const FVector* positions, const FVector* normals, const FVector2D* uvs, const TArray<int32>& triangles, const int32 numVertices, FVector* outTangents)
+    {
+        FMemory::Memzero(outTangents, numVertices * sizeof(FVector));
+        for (int32 index = 0; index + 2 < triangles.Num(); index += 3)
+        {
+            const int32 v0 = triangles[index];
+            const int32 v1 = triangles[index + 1];
+            const int32 v2 = triangles[index + 2];
+            const FVector edge1 = positions[v1] - positions[v0];
+            const FVector edge2 = positions[v2] - positions[v0];
+            const FVector2D uvEdge1 = uvs[v1] - uvs[v0];
+            const FVector2D uvEdge2 = uvs[v2] - uvs[v0];
+            const float determinant = uvEdge1.X * uvEdge2.Y - uvEdge2.X * uvEdge1.Y;
+            if (FMath::Abs(determinant) < SMALL_NUMBER)
+            {
+                continue;
+            }
+            const FVector tangent = (edge1 * uvEdge2.Y - edge2 * uvEdge1.Y) / determinant;
+            outTangents[v0] += tangent;
+            outTangents[v1] += tangent;
+            outTangents[v2] += tangent;
+        }
+        for (int32 vertex = 0; vertex < numVertices; ++vertex)
+        {
+            const FVector& normal = normals[vertex];
+            outTangents[vertex] = (outTangents[vertex] - normal * FVector::DotProduct(normal, outTangents[vertex])).GetSafeNormal();
+        }
+    }
+}
+
+FRuntimeMeshGltfScene::FRuntimeMeshGltfScene()
+{
+}
+
+// Here, where Assimp::IOStream is complete
+FRuntimeMeshGltfScene::~FRuntimeMeshGltfScene()
+{
+}
+
+bool FRuntimeMeshGltfScene::IsGltfFile(const FString& file)
+{
+    const FString extension = FPaths::GetExtension(file);
+    return extension.Equals(TEXT("gltf"), ESearchCase::IgnoreCase) || extension.Equals(TEXT("glb"), ESearchCase::IgnoreCase);
+}
+
+bool FRuntimeMeshGltfScene::Load(const FString& file, FAssimpIOSystem& ioSystem)
+{
+    TArrayView<const uint8> fileData;
+    Assimp::IOStream* stream = ioSystem.OpenView(TCHAR_TO_UTF8(*file), fileStorage, fileData);
+    if (!stream)
+    {
+        error = FString::Printf(TEXT("Failed to open the file %s"), *file);
+        return false;
+    }
+    streams.Emplace(stream);
+    return Parse(fileData, ioSystem);
+}
+
+bool FRuntimeMeshGltfScene::LoadFromMemory(TArrayView<const uint8> data, FAssimpIOSystem& ioSystem)
+{
+    return Parse(data, ioSystem);
+}
+
+bool FRuntimeMeshGltfScene::Parse(TArrayView<const uint8> fileData, FAssimpIOSystem& ioSystem)
+{
+    // A GLB holds the json and the first buffer in chunks after the header, a .gltf is only the json
+    TArrayView<const uint8> jsonChunk = fileData;
+    TArrayView<const uint8> binChunk;
+    uint32 magic = 0;
+    if (fileData.Num() >= 12)
+    {
+        FMemory::Memcpy(&magic, fileData.GetData(), sizeof(uint32));
+    }
+    if (magic == glbMagic)
+    {
+        uint32 header[3];
+        FMemory::Memcpy(header, fileData.GetData(), sizeof(header));
+        if (header[1] != 2)
+        {
+            error = FString::Printf(TEXT("GLB version %u is not supported"), header[1]);
+            return false;
+        }
+
+        jsonChunk = TArrayView<const uint8>();
+        int64 chunkOffset = 12;
+        const int64 fileLength = FMath::Min<int64>(header[2], fileData.Num());
+        while (chunkOffset + 8 <= fileLength)
+        {
+            uint32 chunkHeader[2];
+            FMemory::Memcpy(chunkHeader, fileData.GetData() + chunkOffset, sizeof(chunkHeader));
+            chunkOffset += 8;
+            if (chunkOffset + chunkHeader[0] > fileLength)
+            {
+                error = TEXT("A GLB chunk is larger than the file");
+                return false;
+            }
+            const TArrayView<const uint8> chunk(fileData.GetData() + chunkOffset, chunkHeader[0]);
+            if (chunkHeader[1] == glbChunkJson && jsonChunk.Num() == 0)
+            {
+                jsonChunk = chunk;
+            }
+            else if (chunkHeader[1] == glbChunkBin && binChunk.Num() == 0)
+            {
+                binChunk = chunk;
+            }
+            // Chunks are 4 byte aligned
+            chunkOffset += Align(chunkHeader[0], 4);
+        }
+    }
+
+    // A .gltf may start with a byte order mark
+    if (jsonChunk.Num() >= 3 && jsonChunk[0] == 0xEF && jsonChunk[1] == 0xBB && jsonChunk[2] == 0xBF)
+    {
+        jsonChunk = jsonChunk.Slice(3, jsonChunk.Num() - 3);
+    }
+    const FUTF8ToTCHAR jsonConverter(reinterpret_cast<const ANSICHAR*>(jsonChunk.GetData()), jsonChunk.Num());
+    const FString json(jsonConverter.Length(), jsonConverter.Get());
+    TSharedPtr<FJsonObject> root;
+    if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(json), root) || !root.IsValid())
+    {
+        error = TEXT("Failed to parse the json");
+        return false;
+    }
+
+    const FJsonObject* asset = GetObject(*root, TEXT("asset"));
+    FString version;
+    if (!asset || !asset->TryGetStringField(TEXT("version"), version) || !version.StartsWith(TEXT("2")))
+    {
+        error = FString::Printf(TEXT("glTF version %s is not supported"), *version);
+        return false;
+    }
+
+    for (const TSharedPtr<FJsonValue>& extension : GetArray(*root, TEXT("extensionsRequired")))
+    {
+        const FString extensionName = extension->AsString();
+        bool bSupported = false;
+        for (const TCHAR* supportedExtension : supportedRequiredExtensions)
+        {
+            bSupported |= extensionName == supportedExtension;
+        }
+        if (!bSupported)
+        {
+            error = FString::Printf(TEXT("The required extension %s is not supported"), *extensionName);
+            return false;
+        }
+    }
+
+    return ParseBuffers(*root, binChunk, ioSystem)
+        && ParseAccessors(*root)
+        && ParseMaterials(*root)
+        && ParseMeshes(*root)
+        && ParseNodes(*root);
+}
+
+bool FRuntimeMeshGltfScene::ParseBuffers(const FJsonObject& root, TArrayView<const uint8> binChunk, FAssimpIOSystem& ioSystem)
+{
+    const TArray<TSharedPtr<FJsonValue>>& jsonBuffers = GetArray(root, TEXT("buffers"));
+    buffers.SetNum(jsonBuffers.Num());
+    bufferStorage.SetNum(jsonBuffers.Num());
+    for (int32 bufferIndex = 0; bufferIndex < jsonBuffers.Num(); ++bufferIndex)
+    {
+        const FJsonObject* jsonBufferObject = GetElementObject(jsonBuffers, bufferIndex);
+        if (!jsonBufferObject)
+        {
+            error = FString::Printf(TEXT("Buffer %d is not an object"), bufferIndex);
+            return false;
+        }
+        const FJsonObject& jsonBuffer = *jsonBufferObject;
+        FString uri;
+        if (!jsonBuffer.TryGetStringField(TEXT("uri"), uri))
+        {
+            // The binary chunk of a GLB. Other buffers without a uri have no data, like the fallback buffer of EXT_meshopt_compression.
+            if (bufferIndex == 0)
+            {
+                buffers[bufferIndex] = binChunk;
+            }
+            continue;
+        }
+
+        FString mimeType;
+        if (uri.StartsWith(TEXT("data:")))
+        {
+            if (!DecodeDataUri(uri, bufferStorage[bufferIndex], mimeType))
+            {
+                error = FString::Printf(TEXT("Failed to decode the data uri of buffer %d"), bufferIndex);
+                return false;
+            }
+            buffers[bufferIndex] = bufferStorage[bufferIndex];
+            continue;
+        }
+
+        Assimp::IOStream* stream = ioSystem.OpenView(TCHAR_TO_UTF8(*DecodeUri(uri)), bufferStorage[bufferIndex], buffers[bufferIndex]);
+        if (!stream)
+        {
+            error = FString::Printf(TEXT("Failed to open buffer %s"), *uri);
+            return false;
+        }
+        streams.Emplace(stream);
+    }
+
+    const TArray<TSharedPtr<FJsonValue>>& jsonBufferViews = GetArray(root, TEXT("bufferViews"));
+    bufferViews.SetNum(jsonBufferViews.Num());
+    for (int32 viewIndex = 0; viewIndex < jsonBufferViews.Num(); ++viewIndex)
+    {
+        const FJsonObject* jsonViewObject = GetElementObject(jsonBufferViews, viewIndex);
+        if (!jsonViewObject)
+        {
+            error = FString::Printf(TEXT("Buffer view %d is not an object"), viewIndex);
+            return false;
+        }
+        const FJsonObject& jsonView = *jsonViewObject;
+        FBufferView& view = bufferViews[viewIndex];
+        view.buffer = GetInt(jsonView, TEXT("buffer"), INDEX_NONE);
+        view.offset = GetInt64(jsonView, TEXT("byteOffset"), 0);
+        view.length = GetInt64(jsonView, TEXT("byteLength"), 0);
+        view.stride = GetInt(jsonView, TEXT("byteStride"), 0);
+        if (!buffers.IsValidIndex(view.buffer) || view.offset < 0 || view.length < 0 || view.offset + view.length > buffers[view.buffer].Num())
+        {
+            const FJsonObject* extensions = GetObject(jsonView, TEXT("extensions"));
+            if (extensions && (extensions->HasField(TEXT("EXT_meshopt_compression")) || extensions->HasField(TEXT("KHR_meshopt_compression"))))
+            {
+                error = TEXT("Buffers compressed with EXT_meshopt_compression can not be decoded");
+            }
+            else
+            {
+                error = FString::Printf(TEXT("Buffer view %d is outside of its buffer"), viewIndex);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FRuntimeMeshGltfScene::ParseAccessors(const FJsonObject& root)
+{
+    const TArray<TSharedPtr<FJsonValue>>& jsonAccessors = GetArray(root, TEXT("accessors"));
+    accessors.SetNum(jsonAccessors.Num());
+    for (int32 accessorIndex = 0; accessorIndex < jsonAccessors.Num(); ++accessorIndex)
+    {
+        const FJsonObject* jsonAccessorObject = GetElementObject(jsonAccessors, accessorIndex);
+        if (!jsonAccessorObject)
+        {
+            error = FString::Printf(TEXT("Accessor %d is not an object"), accessorIndex);
+            return false;
+        }
+        const FJsonObject& jsonAccessor = *jsonAccessorObject;
+        FAccessor& accessor = accessors[accessorIndex];
+        accessor.bufferView = GetInt(jsonAccessor, TEXT("bufferView"), INDEX_NONE);
+        accessor.offset = GetInt64(jsonAccessor, TEXT("byteOffset"), 0);
+        accessor.componentType = GetInt(jsonAccessor, TEXT("componentType"), 0);
+        accessor.count = GetInt(jsonAccessor, TEXT("count"), 0);
+        FString type;
+        jsonAccessor.TryGetStringField(TEXT("type"), type);
+        accessor.numComponents = GetNumComponents(type);
+        bool bNormalized = false;
+        jsonAccessor.TryGetBoolField(TEXT("normalized"), bNormalized);
+        // Only integers are normalized
+        accessor.bNormalized = bNormalized && accessor.componentType != ComponentFloat;
+        accessor.bSparse = jsonAccessor.HasField(TEXT("sparse"));
+    }
+    return true;
+}
+
+bool FRuntimeMeshGltfScene::ValidateAccessor(const int32 accessorIndex, const TCHAR* stream, const int32 minComponents, const int32 maxComponents, const int32 expectedCount, const bool bIndices)
+{
+    if (!accessors.IsValidIndex(accessorIndex))
+    {
+        error = FString::Printf(TEXT("The %s accessor %d does not exist"), stream, accessorIndex);
+        return false;
+    }
+
+    const FAccessor& accessor = accessors[accessorIndex];
+    if (accessor.bSparse)
+    {
+        error = FString::Printf(TEXT("The %s accessor %d is sparse"), stream, accessorIndex);
+        return false;
+    }
+    const bool bValidComponentType = bIndices
+        ? accessor.componentType == ComponentUnsignedByte || accessor.componentType == ComponentUnsignedShort || accessor.componentType == ComponentUnsignedInt
+        : GetComponentSize(accessor.componentType) > 0 && accessor.componentType != ComponentUnsignedInt;
+    if (!bValidComponentType || accessor.numComponents < minComponents || accessor.numComponents > maxComponents)
+    {
+        error = FString::Printf(TEXT("The %s accessor %d has an unsupported type"), stream, accessorIndex);
+        return false;
+    }
+    if (accessor.count <= 0 || (expectedCount != INDEX_NONE && accessor.count != expectedCount))
+    {
+        error = FString::Printf(TEXT("The %s accessor %d has %d elements, expected %d"), stream, accessorIndex, accessor.count, expectedCount);
+        return false;
+    }
+    if (accessor.bufferView == INDEX_NONE)
+    {
+        return true;
+    }
+    if (!bufferViews.IsValidIndex(accessor.bufferView))
+    {
+        error = FString::Printf(TEXT("The buffer view of the %s accessor %d does not exist"), stream, accessorIndex);
+        return false;
+    }
+
+    const FBufferView& view = bufferViews[accessor.bufferView];
+    const int32 elementSize = GetComponentSize(accessor.componentType) * accessor.numComponents;
+    const int32 stride = GetAccessorStride(accessor);
+    if (stride < elementSize || accessor.offset < 0 || accessor.offset + static_cast<int64>(stride) * (accessor.count - 1) + elementSize > view.length)
+    {
+        error = FString::Printf(TEXT("The %s accessor %d is outside of its buffer view"), stream, accessorIndex);
+        return false;
+    }
+    return true;
+}
+
+bool FRuntimeMeshGltfScene::ParseMaterials(const FJsonObject& root)
+{
+    const TArray<TSharedPtr<FJsonValue>>& jsonImages = GetArray(root, TEXT("images"));
+    images.SetNum(jsonImages.Num());
+    for (int32 imageIndex = 0; imageIndex < jsonImages.Num(); ++imageIndex)
+    {
+        const FJsonObject* jsonImageObject = GetElementObject(jsonImages, imageIndex);
+        if (!jsonImageObject)
+        {
+            error = FString::Printf(TEXT("Image %d is not an object"), imageIndex);
+            return false;
+        }
+        const FJsonObject& jsonImage = *jsonImageObject;
+        FImage& image = images[imageIndex];
+        jsonImage.TryGetStringField(TEXT("mimeType"), image.mimeType);
+        image.bufferView = GetInt(jsonImage, TEXT("bufferView"), INDEX_NONE);
+        if (!bufferViews.IsValidIndex(image.bufferView))
+        {
+            image.bufferView = INDEX_NONE;
+        }
+
+        FString uri;
+        if (jsonImage.TryGetStringField(TEXT("uri"), uri))
+        {
+            if (!uri.StartsWith(TEXT("data:")))
+            {
+                image.uri = DecodeUri(uri);
+            }
+            else if (!DecodeDataUri(uri, image.data, image.mimeType))
+            {
+                RMIE_LOG(Warning, "Failed to decode the data uri of image %d", imageIndex);
+            }
+        }
+    }
+
+    const TArray<TSharedPtr<FJsonValue>>& jsonTextures = GetArray(root, TEXT("textures"));
+    for (int32 textureIndex = 0; textureIndex < jsonTextures.Num(); ++textureIndex)
+    {
+        const FJsonObject* jsonTexture = GetElementObject(jsonTextures, textureIndex);
+        if (!jsonTexture)
+        {
+            error = FString::Printf(TEXT("Texture %d is not an object"), textureIndex);
+            return false;
+        }
+        const int32 imageIndex = GetInt(*jsonTexture, TEXT("source"), INDEX_NONE);
+        textures.Add(images.IsValidIndex(imageIndex) ? imageIndex : INDEX_NONE);
+    }
+
+    const TArray<TSharedPtr<FJsonValue>>& jsonMaterials = GetArray(root, TEXT("materials"));
+    // The last one is the default material of the primitives without a material, like Assimp adds it
+    materials.SetNum(jsonMaterials.Num() + 1);
+    for (int32 materialIndex = 0; materialIndex < jsonMaterials.Num(); ++materialIndex)
+    {
+        const FJsonObject* jsonMaterialObject = GetElementObject(jsonMaterials, materialIndex);
+        if (!jsonMaterialObject)
+        {
+            error = FString::Printf(TEXT("Material %d is not an object"), materialIndex);
+            return false;
+        }
+        const FJsonObject& jsonMaterial = *jsonMaterialObject;
+        FMaterial& material = materials[materialIndex];
+        FString name;
+        if (jsonMaterial.TryGetStringField(TEXT("name"), name))
+        {
+            material.name = FName(*name);
+        }
+        jsonMaterial.TryGetBoolField(TEXT("doubleSided"), material.bTwoSided);
+        material.emissive = GetColor(jsonMaterial, TEXT("emissiveFactor"), FLinearColor::Black);
+        material.emissiveTexture = GetTextureIndex(&jsonMaterial, TEXT("emissiveTexture"));
+        material.normalTexture = GetTextureIndex(&jsonMaterial, TEXT("normalTexture"));
+        material.occlusionTexture = GetTextureIndex(&jsonMaterial, TEXT("occlusionTexture"));
+
+        const FJsonObject* pbr = GetObject(jsonMaterial, TEXT("pbrMetallicRoughness"));
+        material.diffuse = pbr ? GetColor(*pbr, TEXT("baseColorFactor"), FLinearColor::White) : FLinearColor::White;
+        material.diffuseTexture = GetTextureIndex(pbr, TEXT("baseColorTexture"));
+        // Like Assimp, the shininess is derived from the roughness
+        const float roughness = pbr ? GetFloat(*pbr, TEXT("roughnessFactor"), 1.f) : 1.f;
+        material.shininess = FMath::Square(1.f - roughness) * 1000.f;
+
+        const FJsonObject* extensions = GetObject(jsonMaterial, TEXT("extensions"));
+        const FJsonObject* specularGlossiness = extensions ? GetObject(*extensions, TEXT("KHR_materials_pbrSpecularGlossiness")) : nullptr;
+        if (specularGlossiness)
+        {
+            material.bSpecular = true;
+            material.diffuse = GetColor(*specularGlossiness, TEXT("diffuseFactor"), FLinearColor::White);
+            material.specular = GetColor(*specularGlossiness, TEXT("specularFactor"), FLinearColor::White);
+            material.shininess = GetFloat(*specularGlossiness, TEXT("glossinessFactor"), 1.f) * 1000.f;
+            material.diffuseTexture = GetTextureIndex(specularGlossiness, TEXT("diffuseTexture"));
+            material.specularTexture = GetTextureIndex(specularGlossiness, TEXT("specularGlossinessTexture"));
+        }
+    }
+    return true;
+}
+
+bool FRuntimeMeshGltfScene::ParseMeshes(const FJsonObject& root)
+{
+    const int32 defaultMaterial = materials.Num() - 1;
+    const TArray<TSharedPtr<FJsonValue>>& jsonMeshes = GetArray(root, TEXT("meshes"));
+    meshPrimitives.SetNum(jsonMeshes.Num());
+    for (int32 meshIndex = 0; meshIndex < jsonMeshes.Num(); ++meshIndex)
+    {
+        const FJsonObject* jsonMesh = GetElementObject(jsonMeshes, meshIndex);
+        if (!jsonMesh)
+        {
+            error = FString::Printf(TEXT("Mesh %d is not an object"), meshIndex);
+            return false;
+        }
+        const TArray<TSharedPtr<FJsonValue>>& jsonPrimitives = GetArray(*jsonMesh, TEXT("primitives"));
+        for (int32 primitiveIndex = 0; primitiveIndex < jsonPrimitives.Num(); ++primitiveIndex)
+        {
+            const FJsonObject* jsonPrimitiveObject = GetElementObject(jsonPrimitives, primitiveIndex);
+            if (!jsonPrimitiveObject)
+            {
+                error = FString::Printf(TEXT("Primitive %d of mesh %d is not an object"), primitiveIndex, meshIndex);
+                return false;
+            }
+            const FJsonObject& jsonPrimitive = *jsonPrimitiveObject;
+            const FJsonObject* extensions = GetObject(jsonPrimitive, TEXT("extensions"));
+            if (extensions && extensions->HasField(TEXT("KHR_draco_mesh_compression")))
+            {
+                error = TEXT("Meshes compressed with KHR_draco_mesh_compression can not be decoded");
+                return false;
+            }
+
+            FPrimitive primitive;
+            primitive.mode = GetInt(jsonPrimitive, TEXT("mode"), ModeTriangles);
+            if (primitive.mode != ModeTriangles && primitive.mode != ModeTriangleStrip && primitive.mode != ModeTriangleFan)
+            {
+                error = TEXT("Points and lines are not supported");
+                return false;
+            }
+            primitive.indices = GetInt(jsonPrimitive, TEXT("indices"), INDEX_NONE);
+            primitive.material = GetInt(jsonPrimitive, TEXT("material"), INDEX_NONE);
+            if (primitive.material < 0 || primitive.material >= defaultMaterial)
+            {
+                primitive.material = defaultMaterial;
+            }
+
+            const FJsonObject* attributes = GetObject(jsonPrimitive, TEXT("attributes"));
+            if (!attributes)
+            {
+                error = TEXT("A primitive has no attributes");
+                return false;
+            }
+            primitive.position = GetInt(*attributes, TEXT("POSITION"), INDEX_NONE);
+            primitive.normal = GetInt(*attributes, TEXT("NORMAL"), INDEX_NONE);
+            primitive.tangent = GetInt(*attributes, TEXT("TANGENT"), INDEX_NONE);
+            primitive.uv0 = GetInt(*attributes, TEXT("TEXCOORD_0"), INDEX_NONE);
+            primitive.color0 = GetInt(*attributes, TEXT("COLOR_0"), INDEX_NONE);
+
+            if (!ValidateAccessor(primitive.position, TEXT("POSITION"), 3, 3, INDEX_NONE))
+            {
+                return false;
+            }
+            const int32 numVertices = accessors[primitive.position].count;
+            if ((primitive.normal != INDEX_NONE && !ValidateAccessor(primitive.normal, TEXT("NORMAL"), 3, 3, numVertices))
+                || (primitive.tangent != INDEX_NONE && !ValidateAccessor(primitive.tangent, TEXT("TANGENT"), 4, 4, numVertices))
+                || (primitive.uv0 != INDEX_NONE && !ValidateAccessor(primitive.uv0, TEXT("TEXCOORD_0"), 2, 2, numVertices))
+                || (primitive.color0 != INDEX_NONE && !ValidateAccessor(primitive.color0, TEXT("COLOR_0"), 3, 4, numVertices))
+                || (primitive.indices != INDEX_NONE && !ValidateAccessor(primitive.indices, TEXT("indices"), 1, 1, INDEX_NONE, true)))
+            {
+                return false;
+            }
+
+            meshPrimitives[meshIndex].Add(primitives.Add(primitive));
+        }
+    }
+    return true;
+}
+
+bool FRuntimeMeshGltfScene::ParseNodes(const FJsonObject& root)
+{
+    const TArray<TSharedPtr<FJsonValue>>& jsonScenes = GetArray(root, TEXT("scenes"));
+    const int32 sceneIndex = GetInt(root, TEXT("scene"), 0);
+    const FJsonObject* jsonScene = GetElementObject(jsonScenes, sceneIndex);
+    if (!jsonScene)
+    {
+        error = TEXT("The file has no scene");
+        return false;
+    }
+
+    const TArray<TSharedPtr<FJsonValue>>& jsonNodes = GetArray(root, TEXT("nodes"));
+    const TArray<TSharedPtr<FJsonValue>>& rootNodes = GetArray(*jsonScene, TEXT("nodes"));
+    addedJsonNodes.Init(false, jsonNodes.Num());
+    if (rootNodes.Num() == 1)
+    {
+        return AddNode(jsonNodes, static_cast<int32>(rootNodes[0]->AsNumber()), INDEX_NONE, 0);
+    }
+
+    // Like Assimp, several root nodes get a common parent
+    FNode& sceneRoot = nodes.AddDefaulted_GetRef();
+    sceneRoot.name = FName(TEXT("ROOT"));
+    for (const TSharedPtr<FJsonValue>& rootNode : rootNodes)
+    {
+        if (!AddNode(jsonNodes, static_cast<int32>(rootNode->AsNumber()), 0, 1))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FRuntimeMeshGltfScene::AddNode(const TArray<TSharedPtr<FJsonValue>>& jsonNodes, const int32 jsonNodeIndex, const int32 parentIndex, const int32 depth)
+{
+    // A cycle would never end and a node that is the child of several nodes is walked once per path, so each node may only be added once.
+    // The depth limit keeps the recursion off the end of the stack.
+    const FJsonObject* jsonNodeObject = GetElementObject(jsonNodes, jsonNodeIndex);
+    if (!jsonNodeObject || addedJsonNodes[jsonNodeIndex] || depth > 256)
+    {
+        error = TEXT("The node tree is not valid");
+        return false;
+    }
+    addedJsonNodes[jsonNodeIndex] = true;
+
+    const FJsonObject& jsonNode = *jsonNodeObject;
+    FNode node;
+    FString name;
+    // Named by their id like Assimp does when they have no name
+    node.name = FName(jsonNode.TryGetStringField(TEXT("name"), name) && !name.IsEmpty() ? *name : *FString::Printf(TEXT("nodes_%d"), jsonNodeIndex));
+    node.parentIndex = parentIndex;
+
+    FMatrix matrix = FMatrix::Identity;
+    const TArray<TSharedPtr<FJsonValue>>& jsonMatrix = GetArray(jsonNode, TEXT("matrix"));
+    if (jsonMatrix.Num() == 16)
+    {
+        // The column major matrix of glTF has the memory layout of an FMatrix
+        float* elements = &matrix.M[0][0];
+        for (int32 index = 0; index < 16; ++index)
+        {
+            elements[index] = static_cast<float>(jsonMatrix[index]->AsNumber());
+        }
+    }
+    else
+    {
+        const FLinearColor translation = GetColor(jsonNode, TEXT("translation"), FLinearColor(0.f, 0.f, 0.f, 0.f));
+        const FLinearColor rotation = GetColor(jsonNode, TEXT("rotation"), FLinearColor(0.f, 0.f, 0.f, 1.f));
+        const FLinearColor scale = GetColor(jsonNode, TEXT("scale"), FLinearColor(1.f, 1.f, 1.f, 0.f));
+        matrix = FTransform(FQuat(rotation.R, rotation.G, rotation.B, rotation.A).GetNormalized(), FVector(translation.R, translation.G, translation.B)
+            , FVector(scale.R, scale.G, scale.B)).ToMatrixWithScale();
+    }
+    // Mirrored at z on both sides, like aiProcess_MakeLeftHanded does
+    const FMatrix mirror = FScaleMatrix(FVector(1.f, 1.f, -1.f));
+    node.localTransform = FTransform(mirror * matrix * mirror);
+
+    const int32 meshIndex = GetInt(jsonNode, TEXT("mesh"), INDEX_NONE);
+    if (meshPrimitives.IsValidIndex(meshIndex))
+    {
+        node.primitives = meshPrimitives[meshIndex];
+    }
+
+    const int32 nodeIndex = nodes.Add(MoveTemp(node));
+    for (const TSharedPtr<FJsonValue>& child : GetArray(jsonNode, TEXT("children")))
+    {
+        if (!AddNode(jsonNodes, static_cast<int32>(child->AsNumber()), nodeIndex, depth + 1))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FRuntimeMeshGltfScene::HasAllNormals() const
+{
+    for (const FPrimitive& primitive : primitives)
+    {
+        if (primitive.normal == INDEX_NONE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const uint8* FRuntimeMeshGltfScene::GetAccessorData(const FAccessor& accessor) const
+{
+    const FBufferView& view = bufferViews[accessor.bufferView];
+    return buffers[view.buffer].GetData() + view.offset + accessor.offset;
+}
+
+int32 FRuntimeMeshGltfScene::GetAccessorStride(const FAccessor& accessor) const
+{
+    const int32 stride = accessor.bufferView != INDEX_NONE ? bufferViews[accessor.bufferView].stride : 0;
+    return stride > 0 ? stride : GetComponentSize(accessor.componentType) * accessor.numComponents;
+}
+
+void FRuntimeMeshGltfScene::ReadFloats(const int32 accessorIndex, const int32 numComponents, float* out, const int32 outStride) const
+{
+    const FAccessor& accessor = accessors[accessorIndex];
+    const int32 numRead = FMath::Min(numComponents, accessor.numComponents);
+    if (accessor.bufferView == INDEX_NONE)
+    {
+        for (int32 element = 0; element < accessor.count; ++element)
+        {
+            FMemory::Memzero(out + static_cast<int64>(element) * outStride, numRead * sizeof(float));
+        }
+        return;
+    }
+
+    const uint8* data = GetAccessorData(accessor);
+    const int32 stride = GetAccessorStride(accessor);
+    switch (accessor.componentType)
+    {
+    case ComponentFloat:
+        ConvertComponents<float>(data, stride, accessor.count, numRead, false, out, outStride);
+        break;
+    case ComponentByte:
+        ConvertComponents<int8>(data, stride, accessor.count, numRead, accessor.bNormalized, out, outStride);
+        break;
+    case ComponentUnsignedByte:
+        ConvertComponents<uint8>(data, stride, accessor.count, numRead, accessor.bNormalized, out, outStride);
+        break;
+    case ComponentShort:
+        ConvertComponents<int16>(data, stride, accessor.count, numRead, accessor.bNormalized, out, outStride);
+        break;
+    case ComponentUnsignedShort:
+        ConvertComponents<uint16>(data, stride, accessor.count, numRead, accessor.bNormalized, out, outStride);
+        break;
+    default:
+        checkNoEntry();
+    }
+}
+
+template<typename T>
+const T* FRuntimeMeshGltfScene::GetFloats(const int32 accessorIndex, TArray<T>& converted) const
+{
+    const int32 numComponents = sizeof(T) / sizeof(float);
+    const FAccessor& accessor = accessors[accessorIndex];
+    if (accessor.bufferView != INDEX_NONE && accessor.componentType == ComponentFloat && accessor.numComponents == numComponents && GetAccessorStride(accessor) == sizeof(T))
+    {
+        // glTF aligns float streams to 4 bytes
+        return reinterpret_cast<const T*>(GetAccessorData(accessor));
+    }
+    converted.SetNumUninitialized(accessor.count);
+    ReadFloats(accessorIndex, numComponents, reinterpret_cast<float*>(converted.GetData()), numComponents);
+    return converted.GetData();
+}
+
+void FRuntimeMeshGltfScene::ReadTriangles(const FPrimitive& primitive, const int32 numVertices, TArray<int32>& outTriangles) const
+{
+    // Lists are read straight into the result, strips and fans go through 'indices'
+    TArray<int32> stripIndices;
+    TArray<int32>& indices = primitive.mode == ModeTriangles ? outTriangles : stripIndices;
+    if (primitive.indices != INDEX_NONE)
+    {
+        const FAccessor& accessor = accessors[primitive.indices];
+        indices.SetNumUninitialized(accessor.count);
+        if (accessor.bufferView == INDEX_NONE)
+        {
+            FMemory::Memzero(indices.GetData(), accessor.count * sizeof(int32));
+        }
+        else if (accessor.componentType == ComponentUnsignedInt)
+        {
+            ConvertIndices<uint32>(GetAccessorData(accessor), accessor.count, indices.GetData());
+        }
+        else if (accessor.componentType == ComponentUnsignedShort)
+        {
+            ConvertIndices<uint16>(GetAccessorData(accessor), accessor.count, indices.GetData());
+        }
+        else
+        {
+            ConvertIndices<uint8>(GetAccessorData(accessor), accessor.count, indices.GetData());
+        }
+    }
+    else
+    {
+        indices.SetNumUninitialized(numVertices);
+        for (int32 vertex = 0; vertex < numVertices; ++vertex)
+        {
+            indices[vertex] = vertex;
+        }
+    }
+
+    if (primitive.mode == ModeTriangleStrip || primitive.mode == ModeTriangleFan)
+    {
+        const int32 numTriangles = FMath::Max(indices.Num() - 2, 0);
+        outTriangles.SetNumUninitialized(numTriangles * 3);
+        for (int32 triangle = 0; triangle < numTriangles; ++triangle)
+        {
+            int32* outTriangle = &outTriangles[triangle * 3];
+            if (primitive.mode == ModeTriangleStrip)
+            {
+                // Every second triangle of a strip is flipped to keep the winding order
+                outTriangle[0] = indices[triangle];
+                outTriangle[1] = indices[triangle + 1 + triangle % 2];
+                outTriangle[2] = indices[triangle + 2 - triangle % 2];
+            }
+            else
+            {
+                outTriangle[0] = indices[triangle + 1];
+                outTriangle[1] = indices[triangle + 2];
+                outTriangle[2] = indices[0];
+            }
+        }
+    }
+    outTriangles.SetNum(outTriangles.Num() / 3 * 3, false);
+
+    // The indices come from the file, the triangles that point outside of the vertices are dropped
+    int32 numValid = 0;
+    for (int32 index = 0; index < outTriangles.Num(); index += 3)
+    {
+        const int32* triangle = &outTriangles[index];
+        if (static_cast<uint32>(triangle[0]) < static_cast<uint32>(numVertices) && static_cast<uint32>(triangle[1]) < static_cast<uint32>(numVertices)
+            && static_cast<uint32>(triangle[2]) < static_cast<uint32>(numVertices))
+        {
+            FMemory::Memmove(&outTriangles[numValid], triangle, 3 * sizeof(int32));
+            numValid += 3;
+        }
+    }
+    if (numValid < outTriangles.Num())
+    {
+        RMIE_LOG(Warning, "Skipped %d triangles with indices outside of the %d vertices of the primitive.", (outTriangles.Num() - numValid) / 3, numVertices);
+        outTriangles.SetNum(numValid, false);
+    }
+}
+
+FBox FRuntimeMeshGltfScene::ComputePrimitiveBounds(const uint32 primitiveIndex, const FMatrix& matrix) const
+{
+    const FAccessor& positionAccessor = accessors[primitives[primitiveIndex].position];
+    TArray<FVector> converted;
+    const FVector* positions = GetFloats(primitives[primitiveIndex].position, converted);
+    return FMeshConversionKernels::ComputeTransformedBounds(FScaleMatrix(FVector(1.f, 1.f, -1.f)) * matrix, positions, positionAccessor.count);
+}
+
+void FRuntimeMeshGltfScene::GetPrimitiveCounts(const uint32 primitiveIndex, int64& outVertices, int64& outTriangles) const
+{
+    const FPrimitive& primitive = primitives[primitiveIndex];
+    outVertices = accessors[primitive.position].count;
+    const int64 numIndices = primitive.indices != INDEX_NONE ? accessors[primitive.indices].count : outVertices;
+    outTriangles = primitive.mode == ModeTriangles ? numIndices / 3 : FMath::Max<int64>(numIndices - 2, 0);
+}
+
+void FRuntimeMeshGltfScene::ConvertPrimitive(const uint32 primitiveIndex, const FTransform& transform, const bool bCalcTangents, FRuntimeMeshImportSectionInfo& outSection) const
+{
+    const FPrimitive& primitive = primitives[primitiveIndex];
+    outSection.materialIndex = primitive.material;
+    outSection.materialName = materials[primitive.material].name;
+
+    const int32 numVertices = accessors[primitive.position].count;
+    // The mirror of aiProcess_MakeLeftHanded is folded into the matrices, the streams are read in the space of the file
+    const FMatrix mirror = FScaleMatrix(FVector(1.f, 1.f, -1.f));
+    const FMatrix positionMatrix = mirror * transform.ToMatrixWithScale();
+
+    // Tightly packed floats are transformed straight from the buffer, everything else is converted into the section first
+    const FVector* positions = GetFloats(primitive.position, outSection.vertices);
+    const FVector* normals = primitive.normal != INDEX_NONE ? GetFloats(primitive.normal, outSection.normals) : nullptr;
+    const FVector2D* uvs = primitive.uv0 != INDEX_NONE ? GetFloats(primitive.uv0, outSection.uv0) : nullptr;
+    ReadTriangles(primitive, numVertices, outSection.triangles);
+
+    // Before the positions are transformed in place
+    if (primitive.tangent != INDEX_NONE || (bCalcTangents && normals && uvs))
+    {
+        if (primitive.tangent != INDEX_NONE)
+        {
+            // The handedness in w is not kept
+            outSection.tangents.SetNumUninitialized(numVertices);
+            ReadFloats(primitive.tangent, 3, reinterpret_cast<float*>(outSection.tangents.GetData()), 3);
+        }
+        else
+        {
+            outSection.tangents.SetNumUninitialized(numVertices);
+            CalcTangents(positions, normals, uvs, outSection.triangles, numVertices, outSection.tangents.GetData());
+        }
+        FMeshConversionKernels::TransformDirections(mirror * transform.ToMatrixNoScale(), outSection.tangents.GetData(), outSection.tangents.GetData(), numVertices, true);
+    }
+
+    outSection.vertices.SetNumUninitialized(numVertices);
+    FMeshConversionKernels::TransformPositions(positionMatrix, positions, outSection.vertices.GetData(), numVertices, &outSection.bounds);
+
+    if (normals)
+    {
+        outSection.normals.SetNumUninitialized(numVertices);
+        FMeshConversionKernels::TransformDirections(FMeshConversionKernels::GetNormalMatrix(positionMatrix), normals, outSection.normals.GetData(), numVertices, true);
+    }
+    else
+    {
+        outSection.normals.SetNumZeroed(numVertices);
+    }
+
+    if (uvs)
+    {
+        // The glTF importer of Assimp flips V to 1 - v and the Assimp conversion negates it
+        outSection.uv0.SetNumUninitialized(numVertices);
+        for (int32 vertex = 0; vertex < numVertices; ++vertex)
+        {
+            outSection.uv0[vertex] = FVector2D(uvs[vertex].X, uvs[vertex].Y - 1.f);
+        }
+    }
+
+    if (primitive.color0 != INDEX_NONE)
+    {
+        if (accessors[primitive.color0].numComponents == 3)
+        {
+            outSection.vertexColors.Init(FLinearColor::Black, numVertices);
+            ReadFloats(primitive.color0, 4, reinterpret_cast<float*>(outSection.vertexColors.GetData()), 4);
+        }
+        else
+        {
+            const FLinearColor* colors = GetFloats(primitive.color0, outSection.vertexColors);
+            if (colors != outSection.vertexColors.GetData())
+            {
+                outSection.vertexColors = TArray<FLinearColor>(colors, numVertices);
+            }
+        }
+    }
+
+    // When the mesh is inside out cause of the scale, flip the winding order of the triangles
+    const FVector scale = transform.GetScale3D();
+    if (scale.X * scale.Y * scale.Z < 0)
+    {
+        for (int32 index = 0; index < outSection.triangles.Num(); index += 3)
+        {
+            Swap(outSection.triangles[index + 1], outSection.triangles[index + 2]);
+        }
+    }
+}
+
+void FRuntimeMeshGltfScene::AddTexture(const int32 textureIndex, const FName stackName, FRuntimeMeshImportMaterialInfo& materialInfo, TArray<TPair<int32, FString>>& outTextureUris) const
+{
+    if (!textures.IsValidIndex(textureIndex) || textures[textureIndex] == INDEX_NONE)
+    {
+        return;
+    }
+
+    const FImage& image = images[textures[textureIndex]];
+    if (!image.uri.IsEmpty())
+    {
+        outTextureUris.Add(TPair<int32, FString>(materialInfo.textures.Add(FRuntimeMeshImportExportMaterialParamTexture(stackName)), image.uri));
+        return;
+    }
+
+    TArrayView<const uint8> bytes = image.data;
+    if (image.bufferView != INDEX_NONE)
+    {
+        const FBufferView& view = bufferViews[image.bufferView];
+        bytes = TArrayView<const uint8>(buffers[view.buffer].GetData() + view.offset, view.length);
+    }
+    if (bytes.Num() == 0)
+    {
+        RMIE_LOG(Error, "Failed to import Texture %s for Material %s, the image has no data", *stackName.ToString(), *materialInfo.name.ToString());
+        return;
+    }
+
+    // Like an embedded texture of Assimp, the width is the size in bytes
+    FRuntimeMeshImportExportMaterialParamTexture& texture = materialInfo.textures[materialInfo.textures.Add(FRuntimeMeshImportExportMaterialParamTexture(stackName))];
+    texture.byteData = TArray<uint8>(bytes.GetData(), bytes.Num());
+    texture.width = bytes.Num();
+    texture.height = 0;
+    texture.byteDescription = GetFormatHint(image.mimeType);
+}
+
+void FRuntimeMeshGltfScene::ImportMaterial(const int32 materialIndex, FRuntimeMeshImportMaterialInfo& materialInfo, TArray<TPair<int32, FString>>& outTextureUris) const
+{
+    const FMaterial& material = materials[materialIndex];
+    materialInfo.name = material.name;
+    materialInfo.bTwoSided = material.bTwoSided;
+    materialInfo.shadingMode = ERuntimeMeshImportExportMaterialShadingMode::Unknown;
+    materialInfo.shadingModeInt = -1;
+    materialInfo.blendMode = ERuntimeMeshImportExportMaterialBlendMode::Unknown;
+    materialInfo.blendModeInt = -1;
+
+    // The params and texture stacks in the order the Assimp import adds them
+    materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Diffuse"), FLinearColor(material.diffuse.R, material.diffuse.G, material.diffuse.B)));
+    if (material.bSpecular)
+    {
+        materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Specular"), FLinearColor(material.specular.R, material.specular.G, material.specular.B)));
+    }
+    materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Emissive"), FLinearColor(material.emissive.R, material.emissive.G, material.emissive.B)));
+    materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Shininess"), material.shininess));
+
+    AddTexture(material.diffuseTexture, TEXT("TexDiffuse"), materialInfo, outTextureUris);
+    AddTexture(material.specularTexture, TEXT("TexSpecular"), materialInfo, outTextureUris);
+    AddTexture(material.emissiveTexture, TEXT("TexEmissive"), materialInfo, outTextureUris);
+    AddTexture(material.normalTexture, TEXT("TexNormal"), materialInfo, outTextureUris);
+    AddTexture(material.occlusionTexture, TEXT("TexLightmap"), materialInfo, outTextureUris);
+}
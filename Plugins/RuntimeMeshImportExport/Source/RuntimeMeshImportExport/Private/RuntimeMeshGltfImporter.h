@@ -0,0 +1,201 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FAssimpIOSystem;
+class FJsonObject;
+class FJsonValue;
+struct FRuntimeMeshImportSectionInfo;
+struct FRuntimeMeshImportMaterialInfo;
+namespace Assimp
+{
+    class IOStream;
+}
+
+/**
+ *	Reads glTF 2.0 and GLB files without Assimp, for the common case of static meshes.
+ *	The json is parsed once and the accessors are converted straight from the buffers into the sections.
+ *	The binary chunk of a GLB and the .bin files are read through FAssimpIOSystem and not copied when they are memory mapped.
+ *	Quantized streams of KHR_mesh_quantization are dequantized while they are converted.
+ *
+ *	The scene is the one Assimp with aiProcess_MakeLeftHanded makes of the file: the same node tree, the vertices mirrored at z,
+ *	the UVs flipped like the glTF importer of Assimp does and the materials with the same params, followed by a default material.
+ *	Load fails, with the reason in GetError, for everything that is not covered: compressed buffers (KHR_draco_mesh_compression,
+ *	EXT_meshopt_compression) that can not be decoded without their libraries, sparse accessors, points and lines
+ *	and unknown required extensions. The import falls back to Assimp then.
+ *	After Load the scene is only read, so the primitives and materials can be converted in parallel.
+ */
+class FRuntimeMeshGltfScene
+{
+public:
+    struct FNode
+    {
+        FName name;
+        // Parents are stored before their children
+        int32 parentIndex = INDEX_NONE;
+        // Relative to the parent, left handed
+        FTransform localTransform;
+        // Index of each primitive of the mesh of the node, in the order of the file
+        TArray<uint32> primitives;
+    };
+
+    FRuntimeMeshGltfScene();
+    ~FRuntimeMeshGltfScene();
+
+    // By the extension of 'file', .gltf or .glb
+    static bool IsGltfFile(const FString& file);
+
+    // Relative buffers and images are resolved by 'ioSystem', which must outlive the scene
+    bool Load(const FString& file, FAssimpIOSystem& ioSystem);
+    // 'data' must outlive the scene, it is not copied
+    bool LoadFromMemory(TArrayView<const uint8> data, FAssimpIOSystem& ioSystem);
+
+    const FString& GetError() const
+    {
+        return error;
+    }
+
+    const TArray<FNode>& GetNodes() const
+    {
+        return nodes;
+    }
+
+    // False when a primitive has no normals, Assimp would generate them
+    bool HasAllNormals() const;
+
+    // The bounds of the vertices of a primitive transformed by 'matrix', without converting the other streams
+    FBox ComputePrimitiveBounds(const uint32 primitiveIndex, const FMatrix& matrix) const;
+
+    // The vertices and triangles of a primitive by the counts of its accessors, without reading them
+    void GetPrimitiveCounts(const uint32 primitiveIndex, int64& outVertices, int64& outTriangles) const;
+
+    /**
+     * Converts one primitive to a section, transformed by 'transform'. Only writes to 'outSection'.
+     * @param bCalcTangents		Calculates the tangents of a primitive that has none from its normals and UVs, like aiProcess_CalcTangentSpace
+     */
+    void ConvertPrimitive(const uint32 primitiveIndex, const FTransform& transform, const bool bCalcTangents, FRuntimeMeshImportSectionInfo& outSection) const;
+
+    // The materials of the file and the default material of the primitives without one
+    int32 NumMaterials() const
+    {
+        return materials.Num();
+    }
+
+    /**
+     * Extracts the params and textures of a material. Embedded images are copied into the textures,
+     * the uris of external images are added to 'outTextureUris' with the index of their texture in 'materialInfo'.
+     */
+    void ImportMaterial(const int32 materialIndex, FRuntimeMeshImportMaterialInfo& materialInfo, TArray<TPair<int32, FString>>& outTextureUris) const;
+
+private:
+    struct FBufferView
+    {
+        int32 buffer = INDEX_NONE;
+        int64 offset = 0;
+        int64 length = 0;
+        // 0 when the elements are tightly packed
+        int32 stride = 0;
+    };
+
+    struct FAccessor
+    {
+        // INDEX_NONE when the accessor only contains zeros
+        int32 bufferView = INDEX_NONE;
+        int64 offset = 0;
+        int32 componentType = 0;
+        int32 numComponents = 0;
+        int32 count = 0;
+        bool bNormalized = false;
+        bool bSparse = false;
+    };
+
+    struct FPrimitive
+    {
+        int32 position = INDEX_NONE;
+        int32 normal = INDEX_NONE;
+        int32 tangent = INDEX_NONE;
+        int32 uv0 = INDEX_NONE;
+        int32 color0 = INDEX_NONE;
+        int32 indices = INDEX_NONE;
+        int32 material = INDEX_NONE;
+        int32 mode = 4;
+    };
+
+    struct FMaterial
+    {
+        FName name;
+        FLinearColor diffuse = FLinearColor::White;
+        FLinearColor emissive = FLinearColor::Black;
+        float shininess = 0.f;
+        bool bTwoSided = false;
+        // With KHR_materials_pbrSpecularGlossiness
+        bool bSpecular = false;
+        FLinearColor specular = FLinearColor::White;
+        // Indices in 'textures'
+        int32 diffuseTexture = INDEX_NONE;
+        int32 specularTexture = INDEX_NONE;
+        int32 emissiveTexture = INDEX_NONE;
+        int32 normalTexture = INDEX_NONE;
+        int32 occlusionTexture = INDEX_NONE;
+    };
+
+    struct FImage
+    {
+        FString uri;
+        int32 bufferView = INDEX_NONE;
+        // Embedded data of a data uri
+        TArray<uint8> data;
+        FString mimeType;
+    };
+
+    bool Parse(TArrayView<const uint8> fileData, FAssimpIOSystem& ioSystem);
+    bool ParseBuffers(const FJsonObject& root, TArrayView<const uint8> binChunk, FAssimpIOSystem& ioSystem);
+    bool ParseAccessors(const FJsonObject& root);
+    bool ParseMeshes(const FJsonObject& root);
+    bool ParseMaterials(const FJsonObject& root);
+    bool ParseNodes(const FJsonObject& root);
+    bool AddNode(const TArray<TSharedPtr<FJsonValue>>& jsonNodes, const int32 jsonNodeIndex, const int32 parentIndex, const int32 depth);
+    /**
+     * Checks that the accessor of a primitive stream can be converted and that all its elements are inside of its buffer view.
+     * @param expectedCount		The number of vertices, INDEX_NONE for the positions and the indices
+     */
+    bool ValidateAccessor(const int32 accessorIndex, const TCHAR* stream, const int32 minComponents, const int32 maxComponents, const int32 expectedCount, const bool bIndices = false);
+
+    const uint8* GetAccessorData(const FAccessor& accessor) const;
+    int32 GetAccessorStride(const FAccessor& accessor) const;
+    // Converts the first 'numComponents' components of each element to float, as the spec defines it for normalized integers
+    void ReadFloats(const int32 accessorIndex, const int32 numComponents, float* out, const int32 outStride) const;
+    // Points to the elements in the buffer when they are tightly packed floats, otherwise converts them into 'converted'
+    template<typename T>
+    const T* GetFloats(const int32 accessorIndex, TArray<T>& converted) const;
+    // Triangle list in the winding order of the file, strips and fans are converted
+    void ReadTriangles(const FPrimitive& primitive, const int32 numVertices, TArray<int32>& outTriangles) const;
+
+    void AddTexture(const int32 textureIndex, const FName stackName, FRuntimeMeshImportMaterialInfo& materialInfo, TArray<TPair<int32, FString>>& outTextureUris) const;
+
+    FString error;
+
+    // The file when it is not in memory or mapped
+    TArray<uint8> fileStorage;
+    // The views of the buffers point into the file, a mapped .bin or 'bufferStorage'
+    TArray<TArrayView<const uint8>> buffers;
+    TArray<TArray<uint8>> bufferStorage;
+    TArray<TUniquePtr<Assimp::IOStream>> streams;
+
+    TArray<FBufferView> bufferViews;
+    TArray<FAccessor> accessors;
+    // The primitives of all meshes
+    TArray<FPrimitive> primitives;
+    TArray<TArray<uint32>> meshPrimitives;
+    TArray<FMaterial> materials;
+    TArray<FImage> images;
+    // The image of each texture
+    TArray<int32> textures;
+    TArray<FNode> nodes;
+    // The json nodes that were added, each one may have only one parent
+    TBitArray<> addedJsonNodes;
+};
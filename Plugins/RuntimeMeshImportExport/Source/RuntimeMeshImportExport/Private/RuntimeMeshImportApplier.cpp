@@ -0,0 +1,416 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportApplier.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshImportExportStats.h"
+#include "RuntimeMeshImportExportTextureCache.h"
+#include "Async/Async.h"
+#include "Algo/Reverse.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Kismet/KismetMaterialLibrary.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "HAL/PlatformTime.h"
+
+void URuntimeMeshImportApplier::BeginDestroy()
+{
+    // The callbacks of the running conversion and textures are dropped as the applier is gone
+    Reset();
+
+    Super::BeginDestroy();
+}
+
+bool URuntimeMeshImportApplier::ApplyImportResult_Async_Cpp(UProceduralMeshComponent* component, FRuntimeMeshImportResult&& result, UMaterialInterface* inSourceMaterial
+        , const FRuntimeMeshImportApplyParam& inParam
+        , FRuntimeMeshImportExportProgressUpdate callbackProgress
+        , FRuntimeImportExportGameThreadDone callbackFinished)
+{
+    check(IsInGameThread());
+
+    if (bIsApplying)
+    {
+        RMIE_LOG(Warning, "Already applying an import result!");
+        return false;
+    }
+
+    if (!component)
+    {
+        RMIE_LOG(Error, "No component to apply the import result to.");
+        return false;
+    }
+
+    Reset();
+    bIsApplying = true;
+    weakComponent = component;
+    sourceMaterial = inSourceMaterial;
+    param = inParam;
+    delegateProgress = callbackProgress;
+    delegateFinished = callbackFinished;
+    materialInfos = MoveTemp(result.materialInfos);
+    materials.SetNumZeroed(materialInfos.Num());
+    materialInfoHashes.SetNumZeroed(materialInfos.Num());
+    materialRemainingTextures.SetNumZeroed(materialInfos.Num());
+
+    TWeakObjectPtr<URuntimeMeshImportApplier> weakThis(this);
+    const int32 currentRequestId = requestId;
+    const bool bCreateCollision = param.bCreateCollision;
+    const bool bFlipTangentY = param.bFlipTangentY;
+    AsyncTask(ENamedThreads::AnyThread, [weakThis, currentRequestId, result = MoveTemp(result), bCreateCollision, bFlipTangentY]() mutable
+    {
+        TArray<FProcMeshSection> builtSections;
+        TArray<int32> builtMaterialIndices;
+        URuntimeMeshImportExportLibrary::ImportResultToProcMeshSections(result, true, bCreateCollision, bFlipTangentY, builtSections, builtMaterialIndices);
+        result = FRuntimeMeshImportResult();
+
+        AsyncTask(ENamedThreads::GameThread, [weakThis, currentRequestId, builtSections = MoveTemp(builtSections), builtMaterialIndices = MoveTemp(builtMaterialIndices)]() mutable
+        {
+            URuntimeMeshImportApplier* applier = weakThis.Get();
+            if (applier && applier->bIsApplying && applier->requestId == currentRequestId)
+            {
+                applier->OnSectionsBuilt(MoveTemp(builtSections), MoveTemp(builtMaterialIndices));
+            }
+        });
+    });
+    return true;
+}
+
+bool URuntimeMeshImportApplier::ApplyImportResult_Async(UProceduralMeshComponent* component, const FRuntimeMeshImportResult& result, UMaterialInterface* inSourceMaterial
+        , const FRuntimeMeshImportApplyParam& inParam
+        , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
+        , FRuntimeImportExportGameThreadDoneDyn finishedDelegate)
+{
+    FRuntimeMeshImportExportProgressUpdate progressDelegateRaw;
+    progressDelegateRaw.BindLambda([progressDelegate](const FRuntimeMeshImportExportProgress& progress) {
+        progressDelegate.ExecuteIfBound(progress);
+    });
+    FRuntimeImportExportGameThreadDone finishedDelegateRaw;
+    finishedDelegateRaw.BindLambda([finishedDelegate]() {
+        finishedDelegate.ExecuteIfBound();
+    });
+
+    FRuntimeMeshImportResult resultCopy = result;
+    return ApplyImportResult_Async_Cpp(component, MoveTemp(resultCopy), inSourceMaterial, inParam, progressDelegateRaw, finishedDelegateRaw);
+}
+
+void URuntimeMeshImportApplier::Cancel()
+{
+    Reset();
+}
+
+bool URuntimeMeshImportApplier::GetIsApplying() const
+{
+    return bIsApplying;
+}
+
+bool URuntimeMeshImportApplier::IsTickable() const
+{
+    return bIsApplying && bSectionsBuilt && !IsTemplate();
+}
+
+TStatId URuntimeMeshImportApplier::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(URuntimeMeshImportApplier, STATGROUP_RuntimeMeshImportExport);
+}
+
+void URuntimeMeshImportApplier::OnSectionsBuilt(TArray<FProcMeshSection>&& inSections, TArray<int32>&& inSectionMaterialIndices)
+{
+    UProceduralMeshComponent* component = weakComponent.Get();
+    if (!component)
+    {
+        FinishIfDone();
+        return;
+    }
+
+    sections = MoveTemp(inSections);
+    sectionMaterialIndices = MoveTemp(inSectionMaterialIndices);
+    sectionApplied.SetNumZeroed(sections.Num());
+    pendingSections.Reserve(sections.Num());
+    for (int32 sectionIndex = 0; sectionIndex < sections.Num(); ++sectionIndex)
+    {
+        pendingSections.Add(sectionIndex);
+    }
+    // Popped from the back
+    Algo::Reverse(pendingSections);
+
+    // Only the materials and textures that a section uses are created
+    numTotal = sections.Num();
+    if (sourceMaterial)
+    {
+        TSet<int32> usedMaterials;
+        for (const int32 materialIndex : sectionMaterialIndices)
+        {
+            if (materialInfos.IsValidIndex(materialIndex) && !usedMaterials.Contains(materialIndex))
+            {
+                usedMaterials.Add(materialIndex);
+                numTotal += 1 + materialInfos[materialIndex].textures.Num();
+            }
+        }
+    }
+
+    component->ClearAllMeshSections();
+    bSectionsBuilt = true;
+    FinishIfDone();
+}
+
+void URuntimeMeshImportApplier::Tick(float DeltaTime)
+{
+    UProceduralMeshComponent* component = weakComponent.Get();
+    if (!component)
+    {
+        RMIE_LOG(Warning, "The component was destroyed while the import result was applied.");
+        pendingSections.Empty();
+        pendingMaterials.Empty();
+        pendingTextures.Empty();
+        FinishIfDone();
+        return;
+    }
+
+    const double deadline = param.budgetMs > 0.f ? FPlatformTime::Seconds() + param.budgetMs / 1000.0 : 0.0;
+    auto isWithinBudget = [this, deadline, numAppliedBefore = numApplied]() {
+        // At least one, so every tick makes progress
+        return numApplied == numAppliedBefore || deadline == 0.0 || FPlatformTime::Seconds() < deadline;
+    };
+
+    if (param.bPrioritizeByCameraDistance && pendingSections.Num() > 1)
+    {
+        SortPendingSections(*component);
+    }
+
+    for (int32 count = 0; count < param.maxSectionsPerTick && pendingSections.Num() > 0 && isWithinBudget(); ++count)
+    {
+        ApplySection(*component, pendingSections.Pop(false));
+    }
+
+    // In the order their first section was applied, so the closest sections get their materials first
+    int32 numMaterialsDone = 0;
+    for (; numMaterialsDone < pendingMaterials.Num() && numMaterialsDone < param.maxMaterialsPerTick && isWithinBudget(); ++numMaterialsDone)
+    {
+        CreateMaterial(*component, pendingMaterials[numMaterialsDone]);
+    }
+    pendingMaterials.RemoveAt(0, numMaterialsDone, false);
+
+    int32 numTexturesStarted = 0;
+    for (; numTexturesStarted < pendingTextures.Num() && numTexturesStarted < param.maxTexturesPerTick && isWithinBudget(); ++numTexturesStarted)
+    {
+        StartTexture(pendingTextures[numTexturesStarted]);
+    }
+    pendingTextures.RemoveAt(0, numTexturesStarted, false);
+
+    delegateProgress.ExecuteIfBound(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ApplyingImportResult, numApplied, numTotal));
+    FinishIfDone();
+}
+
+void URuntimeMeshImportApplier::SortPendingSections(const UProceduralMeshComponent& component)
+{
+    const UWorld* world = component.GetWorld();
+    const APlayerCameraManager* cameraManager = world ? UGameplayStatics::GetPlayerCameraManager(world, 0) : nullptr;
+    if (!cameraManager)
+    {
+        return;
+    }
+
+    // Once per tick, the camera moves while the result is applied
+    const FVector cameraLocation = cameraManager->GetCameraLocation();
+    const FTransform& componentToWorld = component.GetComponentTransform();
+    TArray<float> distancesSquared;
+    distancesSquared.SetNumUninitialized(sections.Num());
+    for (const int32 sectionIndex : pendingSections)
+    {
+        const FVector center = componentToWorld.TransformPosition(sections[sectionIndex].SectionLocalBox.GetCenter());
+        distancesSquared[sectionIndex] = FVector::DistSquared(center, cameraLocation);
+    }
+    pendingSections.Sort([&distancesSquared](const int32 a, const int32 b) {
+        return distancesSquared[a] > distancesSquared[b];
+    });
+}
+
+void URuntimeMeshImportApplier::ApplySection(UProceduralMeshComponent& component, const int32 sectionIndex)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportApplySection);
+
+    // Copies the section and updates the bounds, the collision and the render state
+    component.SetProcMeshSection(sectionIndex, sections[sectionIndex]);
+    sections[sectionIndex] = FProcMeshSection();
+    sectionApplied[sectionIndex] = true;
+    ++numApplied;
+
+    const int32 materialIndex = sectionMaterialIndices[sectionIndex];
+    if (!sourceMaterial || !materialInfos.IsValidIndex(materialIndex))
+    {
+        return;
+    }
+
+    if (materials[materialIndex])
+    {
+        component.SetMaterial(sectionIndex, materials[materialIndex]);
+    }
+    else if (!queuedMaterials.Contains(materialIndex))
+    {
+        queuedMaterials.Add(materialIndex);
+        pendingMaterials.Add(materialIndex);
+    }
+}
+
+void URuntimeMeshImportApplier::CreateMaterial(UProceduralMeshComponent& component, const int32 materialIndex)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportApplyMaterial);
+
+    // Like MaterialInfoToDynamicMaterial_Async_Cpp, the textures are queued instead of started right away
+    const FRuntimeMeshImportMaterialInfo& materialInfo = materialInfos[materialIndex];
+    UMaterialInstanceDynamic* dynamic = nullptr;
+    if (param.bUseMaterialCache)
+    {
+        materialInfoHashes[materialIndex] = FRuntimeMeshImportExportTextureCache::HashMaterialInfo(materialInfo);
+        dynamic = FRuntimeMeshImportExportTextureCache::Get().FindMaterial(sourceMaterial, materialInfoHashes[materialIndex]);
+    }
+
+    if (dynamic)
+    {
+        // Shared with all its textures
+        numApplied += 1 + materialInfo.textures.Num();
+        materials[materialIndex] = dynamic;
+        SetMaterialOfAppliedSections(component, materialIndex);
+        return;
+    }
+
+    // !!! THE NAME GIVEN TO THE MATERIAL MUST BE NONE, OTHERWISE WHEN CALLED 2x AND THE MATERIAL IS SET TO A UMG IMAGE, IT WILL CRASH !!!
+    dynamic = UKismetMaterialLibrary::CreateDynamicMaterialInstance(&component, sourceMaterial, FName());
+    materials[materialIndex] = dynamic;
+    ++numApplied;
+
+    for (const FRuntimeMeshImportExportMaterialParamScalar& scalarParam : materialInfo.scalars)
+    {
+        dynamic->SetScalarParameterValue(scalarParam.name, scalarParam.value);
+    }
+
+    for (const FRuntimeMeshImportExportMaterialParamVector& vectorParam : materialInfo.vectors)
+    {
+        dynamic->SetVectorParameterValue(vectorParam.name, vectorParam.value);
+    }
+
+    // Only convert the textureParam to a Texture2D if the parameter is present in the material!
+    for (int32 textureIndex = 0; textureIndex < materialInfo.textures.Num(); ++textureIndex)
+    {
+        UTexture* existingTexture = NULL;
+        if (dynamic->GetTextureParameterValue(FMaterialParameterInfo(materialInfo.textures[textureIndex].name), existingTexture))
+        {
+            pendingTextures.Add({ materialIndex, textureIndex });
+            ++materialRemainingTextures[materialIndex];
+        }
+        else
+        {
+            ++numApplied;
+        }
+    }
+
+    if (materialRemainingTextures[materialIndex] == 0)
+    {
+        AddMaterialToCache(materialIndex);
+    }
+    SetMaterialOfAppliedSections(component, materialIndex);
+}
+
+void URuntimeMeshImportApplier::SetMaterialOfAppliedSections(UProceduralMeshComponent& component, const int32 materialIndex)
+{
+    for (int32 sectionIndex = 0; sectionIndex < sectionMaterialIndices.Num(); ++sectionIndex)
+    {
+        if (sectionApplied[sectionIndex] && sectionMaterialIndices[sectionIndex] == materialIndex)
+        {
+            component.SetMaterial(sectionIndex, materials[materialIndex]);
+        }
+    }
+}
+
+void URuntimeMeshImportApplier::AddMaterialToCache(const int32 materialIndex)
+{
+    // Only complete materials are shared
+    if (param.bUseMaterialCache)
+    {
+        FRuntimeMeshImportExportTextureCache::Get().AddMaterial(sourceMaterial, materialInfoHashes[materialIndex], materials[materialIndex]);
+    }
+}
+
+void URuntimeMeshImportApplier::StartTexture(const FPendingTexture& pendingTexture)
+{
+    ++numTexturesInFlight;
+
+    TWeakObjectPtr<URuntimeMeshImportApplier> weakThis(this);
+    const int32 currentRequestId = requestId;
+    const int32 materialIndex = pendingTexture.materialIndex;
+    const FRuntimeMeshImportExportMaterialParamTexture& textureParam = materialInfos[materialIndex].textures[pendingTexture.textureIndex];
+    const FName parameterName = textureParam.name;
+    FRuntimeTextureCreated callbackCreated;
+    callbackCreated.BindLambda([weakThis, currentRequestId, materialIndex, parameterName](UTexture2D* texture) {
+        if (URuntimeMeshImportApplier* applier = weakThis.Get())
+        {
+            applier->OnTextureCreated(currentRequestId, materialIndex, parameterName, texture);
+        }
+    });
+    URuntimeMeshImportExportLibrary::MaterialParamTextureToTexture2D_Async_Cpp(textureParam, callbackCreated, param.bGenerateMips);
+}
+
+void URuntimeMeshImportApplier::OnTextureCreated(const int32 inRequestId, const int32 materialIndex, const FName parameterName, UTexture2D* texture)
+{
+    if (!bIsApplying || inRequestId != requestId)
+    {
+        return;
+    }
+
+    --numTexturesInFlight;
+    ++numApplied;
+    if (--materialRemainingTextures[materialIndex] == 0)
+    {
+        AddMaterialToCache(materialIndex);
+    }
+    if (texture && materials[materialIndex])
+    {
+        materials[materialIndex]->SetTextureParameterValue(parameterName, texture);
+    }
+    else if (!texture)
+    {
+        RMIE_LOG(Error, "Could not convert TextureParam %s from to UTexture2D for MaterialInfo %s", *parameterName.ToString(), *materialInfos[materialIndex].name.ToString());
+    }
+    FinishIfDone();
+}
+
+void URuntimeMeshImportApplier::FinishIfDone()
+{
+    if (!bIsApplying || pendingSections.Num() > 0 || pendingMaterials.Num() > 0 || pendingTextures.Num() > 0 || numTexturesInFlight > 0)
+    {
+        return;
+    }
+
+    // Reset everything before the callback, so a new result can be applied from within it
+    FRuntimeImportExportGameThreadDone callbackFinished = delegateFinished;
+    Reset();
+
+    callbackFinished.ExecuteIfBound();
+}
+
+void URuntimeMeshImportApplier::Reset()
+{
+    ++requestId;
+    bIsApplying = false;
+    bSectionsBuilt = false;
+    weakComponent.Reset();
+    sourceMaterial = nullptr;
+    materials.Empty();
+    materialInfos.Empty();
+    materialInfoHashes.Empty();
+    materialRemainingTextures.Empty();
+    sections.Empty();
+    sectionMaterialIndices.Empty();
+    sectionApplied.Empty();
+    pendingSections.Empty();
+    pendingMaterials.Empty();
+    pendingTextures.Empty();
+    queuedMaterials.Empty();
+    numTexturesInFlight = 0;
+    numApplied = 0;
+    numTotal = 0;
+    delegateProgress.Unbind();
+    delegateFinished.Unbind();
+}
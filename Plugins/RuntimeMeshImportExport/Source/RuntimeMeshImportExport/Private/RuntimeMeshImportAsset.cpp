@@ -0,0 +1,392 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportAsset.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshDeferredRelease.h"
+#include "Async/Async.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Engine/Texture.h"
+
+static int64 GetSectionAllocatedSize(const FRuntimeMeshImportSectionInfo& section)
+{
+    int64 size = section.vertices.GetAllocatedSize() + section.triangles.GetAllocatedSize() + section.normals.GetAllocatedSize() + section.uv0.GetAllocatedSize() + section.uv1.GetAllocatedSize()
+        + section.vertexColors.GetAllocatedSize() + section.tangents.GetAllocatedSize() + section.boneIndices.GetAllocatedSize() + section.boneWeights.GetAllocatedSize()
+        + section.linesAndPoints.GetAllocatedSize();
+    for (const FRuntimeMeshImportMorphTarget& target : section.morphTargets)
+    {
+        size += target.GetAllocatedSize();
+    }
+    return size;
+}
+
+static int64 GetGeometryAllocatedSize(const FRuntimeMeshImportResult& result)
+{
+    int64 size = result.meshInfos.GetAllocatedSize();
+    for (const FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+    {
+        size += meshInfo.sections.GetAllocatedSize() + meshInfo.instanceTransforms.GetAllocatedSize() + meshInfo.lods.GetAllocatedSize()
+            + meshInfo.collision.trimeshVertices.GetAllocatedSize() + meshInfo.collision.trimeshTriangles.GetAllocatedSize();
+        for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            size += GetSectionAllocatedSize(section);
+        }
+        for (const FRuntimeMeshImportMeshLOD& lod : meshInfo.lods)
+        {
+            for (const FRuntimeMeshImportSectionInfo& section : lod.sections)
+            {
+                size += GetSectionAllocatedSize(section);
+            }
+        }
+        for (const FRuntimeMeshImportConvexHull& hull : meshInfo.collision.convexHulls)
+        {
+            size += hull.vertices.GetAllocatedSize();
+        }
+    }
+    return size;
+}
+
+URuntimeMeshImportAsset* URuntimeMeshImportAsset::Create(FRuntimeMeshImportResultRef inResult)
+{
+    check(IsInGameThread());
+    URuntimeMeshImportAsset* asset = NewObject<URuntimeMeshImportAsset>();
+    asset->result = inResult;
+    asset->geometryBytes = GetGeometryAllocatedSize(*inResult);
+    for (const FRuntimeMeshImportMaterialInfo& materialInfo : inResult->materialInfos)
+    {
+        for (const FRuntimeMeshImportExportMaterialParamTexture& texture : materialInfo.textures)
+        {
+            asset->textureFileBytes += texture.byteData.GetAllocatedSize();
+        }
+    }
+    asset->sharedGeometries.SetNumZeroed(inResult->meshInfos.Num());
+    asset->bodySetups.SetNumZeroed(inResult->meshInfos.Num());
+    asset->bodySetupEntries.SetNum(inResult->meshInfos.Num());
+    return asset;
+}
+
+URuntimeMeshImportAsset* URuntimeMeshImportAsset::CreateImportAsset(const FRuntimeMeshImportResult& inResult)
+{
+    return Create(FRuntimeMeshDeferredRelease::MakeImportResult(FRuntimeMeshImportResult(inResult)));
+}
+
+const FRuntimeMeshImportMeshInfo& URuntimeMeshImportAsset::GetMeshGeometry(const int32 meshIndex) const
+{
+    const URuntimeMeshImportAsset* geometry = sharedGeometries[meshIndex];
+    return geometry ? geometry->result->meshInfos[0] : result->meshInfos[meshIndex];
+}
+
+URuntimeMeshImportAsset* URuntimeMeshImportAsset::GetSharedGeometry(const int32 meshIndex) const
+{
+    return sharedGeometries.IsValidIndex(meshIndex) ? sharedGeometries[meshIndex] : nullptr;
+}
+
+void URuntimeMeshImportAsset::SetSharedGeometry(const int32 meshIndex, URuntimeMeshImportAsset* geometry)
+{
+    check(IsInGameThread());
+    check(!geometry || geometry->GetNumMeshes() == 1);
+    sharedGeometries[meshIndex] = geometry;
+}
+
+int32 URuntimeMeshImportAsset::GetNumMeshes() const
+{
+    return result->meshInfos.Num();
+}
+
+int32 URuntimeMeshImportAsset::GetNumMaterials() const
+{
+    return result->materialInfos.Num();
+}
+
+void URuntimeMeshImportAsset::ApplyToProceduralMesh_Async_Cpp(UProceduralMeshComponent* component, const TArray<UMaterialInterface*>& materials
+        , FRuntimeImportExportGameThreadDone callbackDone, const bool bCreateCollision, const bool bFlipTangentY)
+{
+    check(IsInGameThread());
+    if (!component)
+    {
+        RMIE_LOG(Error, "No component to apply the import asset to.");
+        return;
+    }
+
+    // Neither the component nor the materials are kept alive while the sections are converted
+    FPendingApply pendingApply;
+    pendingApply.component = component;
+    pendingApply.callbackDone = callbackDone;
+    for (UMaterialInterface* material : materials)
+    {
+        pendingApply.materials.Add(material);
+    }
+
+    const int32 entryIndex = (bCreateCollision ? 1 : 0) | (bFlipTangentY ? 2 : 0);
+    FSectionsEntry& entry = sectionsEntries[entryIndex];
+    if (entry.sections.IsValid())
+    {
+        ApplySections(*entry.sections, pendingApply);
+        return;
+    }
+
+    entry.pendingApplies.Add(MoveTemp(pendingApply));
+    if (entry.bIsBuilding)
+    {
+        return;
+    }
+    entry.bIsBuilding = true;
+
+    TWeakObjectPtr<URuntimeMeshImportAsset> weakThis(this);
+    TSharedRef<const FRuntimeMeshImportResult, ESPMode::ThreadSafe> sourceResult = result;
+    // The results of the shared geometries, by the mesh that uses them
+    TMap<int32, TSharedRef<const FRuntimeMeshImportResult, ESPMode::ThreadSafe>> geometryResults;
+    for (int32 meshIndex = 0; meshIndex < sharedGeometries.Num(); ++meshIndex)
+    {
+        if (sharedGeometries[meshIndex])
+        {
+            geometryResults.Add(meshIndex, sharedGeometries[meshIndex]->result);
+        }
+    }
+    AsyncTask(ENamedThreads::AnyThread, [weakThis, entryIndex, sourceResult, geometryResults, bCreateCollision, bFlipTangentY]() -> void
+    {
+        TSharedRef<FProcMeshSections, ESPMode::ThreadSafe> builtSections = MakeShared<FProcMeshSections, ESPMode::ThreadSafe>();
+        if (geometryResults.Num() == 0)
+        {
+            // Only read, the result is shared
+            URuntimeMeshImportExportLibrary::ImportResultToProcMeshSections(const_cast<FRuntimeMeshImportResult&>(*sourceResult), false, bCreateCollision, bFlipTangentY
+                                                                            , builtSections->sections, builtSections->materialIndices);
+        }
+        else
+        {
+            // A copy with the shared geometries in place of the empty sections, released by the conversion
+            FRuntimeMeshImportResult composedResult;
+            composedResult.meshInfos = sourceResult->meshInfos;
+            for (const TPair<int32, TSharedRef<const FRuntimeMeshImportResult, ESPMode::ThreadSafe>>& geometryResult : geometryResults)
+            {
+                FRuntimeMeshImportMeshInfo& meshInfo = composedResult.meshInfos[geometryResult.Key];
+                const FRuntimeMeshImportMeshInfo& geometry = geometryResult.Value->meshInfos[0];
+                for (int32 sectionIndex = 0; sectionIndex < meshInfo.sections.Num() && sectionIndex < geometry.sections.Num(); ++sectionIndex)
+                {
+                    const int32 materialIndex = meshInfo.sections[sectionIndex].materialIndex;
+                    meshInfo.sections[sectionIndex] = geometry.sections[sectionIndex];
+                    meshInfo.sections[sectionIndex].materialIndex = materialIndex;
+                }
+            }
+            URuntimeMeshImportExportLibrary::ImportResultToProcMeshSections(composedResult, true, bCreateCollision, bFlipTangentY
+                                                                            , builtSections->sections, builtSections->materialIndices);
+        }
+
+        AsyncTask(ENamedThreads::GameThread, [weakThis, entryIndex, builtSections]() -> void
+        {
+            if (URuntimeMeshImportAsset* asset = weakThis.Get())
+            {
+                asset->OnSectionsBuilt(entryIndex, builtSections);
+            }
+        });
+    });
+}
+
+void URuntimeMeshImportAsset::ApplyToProceduralMesh_Async(UProceduralMeshComponent* component, const TArray<UMaterialInterface*>& materials
+        , FRuntimeImportExportGameThreadDoneDyn callbackDone, const bool bCreateCollision, const bool bFlipTangentY)
+{
+    FRuntimeImportExportGameThreadDone callbackDoneRaw;
+    callbackDoneRaw.BindLambda([callbackDone]() {
+        callbackDone.ExecuteIfBound();
+    });
+    ApplyToProceduralMesh_Async_Cpp(component, materials, callbackDoneRaw, bCreateCollision, bFlipTangentY);
+}
+
+void URuntimeMeshImportAsset::GetDynamicMaterials(UObject* worldContextObject, UMaterialInterface* sourceMaterial, TArray<UMaterialInterface*>& outMaterials)
+{
+    check(IsInGameThread());
+    outMaterials.Empty();
+    if (!sourceMaterial)
+    {
+        RMIE_LOG(Error, "No source material to create the materials of the import asset from.");
+        return;
+    }
+
+    FRuntimeMeshImportAssetMaterials* materialSet = materialSets.FindByPredicate([sourceMaterial](const FRuntimeMeshImportAssetMaterials& set) {
+        return set.sourceMaterial == sourceMaterial;
+    });
+    if (!materialSet)
+    {
+        materialSet = &materialSets.AddDefaulted_GetRef();
+        materialSet->sourceMaterial = sourceMaterial;
+        for (const FRuntimeMeshImportMaterialInfo& materialInfo : result->materialInfos)
+        {
+            materialSet->materials.Add(URuntimeMeshImportExportLibrary::MaterialInfoToDynamicMaterial(worldContextObject, materialInfo, sourceMaterial));
+        }
+    }
+
+    outMaterials.Append(materialSet->materials);
+}
+
+void URuntimeMeshImportAsset::GetBodySetup_Async_Cpp(const int32 meshIndex, FRuntimeBodySetupCreated callbackCreated)
+{
+    check(IsInGameThread());
+    if (!bodySetupEntries.IsValidIndex(meshIndex))
+    {
+        RMIE_LOG(Error, "The import asset has no mesh %d.", meshIndex);
+        callbackCreated.ExecuteIfBound(nullptr);
+        return;
+    }
+
+    // Cooked once for all assets that share the geometry
+    if (URuntimeMeshImportAsset* geometry = sharedGeometries[meshIndex])
+    {
+        geometry->GetBodySetup_Async_Cpp(0, callbackCreated);
+        return;
+    }
+
+    FBodySetupEntry& entry = bodySetupEntries[meshIndex];
+    if (entry.bIsCreated)
+    {
+        callbackCreated.ExecuteIfBound(bodySetups[meshIndex]);
+        return;
+    }
+
+    entry.pendingCallbacks.Add(callbackCreated);
+    if (entry.bIsCooking)
+    {
+        return;
+    }
+    entry.bIsCooking = true;
+
+    TWeakObjectPtr<URuntimeMeshImportAsset> weakThis(this);
+    FRuntimeBodySetupCreated callbackCooked;
+    callbackCooked.BindLambda([weakThis, meshIndex](UBodySetup* bodySetup) {
+        if (URuntimeMeshImportAsset* asset = weakThis.Get())
+        {
+            asset->OnBodySetupCreated(meshIndex, bodySetup);
+        }
+    });
+    // Can call back right away, when the mesh has no collision
+    URuntimeMeshImportExportLibrary::MeshInfoToBodySetup_Async_Cpp(result->meshInfos[meshIndex], callbackCooked);
+}
+
+void URuntimeMeshImportAsset::GetBodySetup_Async(const int32 meshIndex, FRuntimeBodySetupCreatedDyn callbackCreated)
+{
+    FRuntimeBodySetupCreated callbackCreatedRaw;
+    callbackCreatedRaw.BindLambda([callbackCreated](UBodySetup* bodySetup) {
+        callbackCreated.ExecuteIfBound(bodySetup);
+    });
+    GetBodySetup_Async_Cpp(meshIndex, callbackCreatedRaw);
+}
+
+FRuntimeMeshImportAssetMemory URuntimeMeshImportAsset::GetMemoryUsage() const
+{
+    FRuntimeMeshImportAssetMemory memory;
+    memory.geometryBytes = geometryBytes;
+    memory.textureBytes = textureFileBytes;
+
+    TSet<const UTexture*> textures;
+    for (const FRuntimeMeshImportAssetMaterials& materialSet : materialSets)
+    {
+        for (const UMaterialInstanceDynamic* material : materialSet.materials)
+        {
+            if (!material)
+            {
+                continue;
+            }
+            for (const FTextureParameterValue& parameter : material->TextureParameterValues)
+            {
+                if (parameter.ParameterValue)
+                {
+                    textures.Add(parameter.ParameterValue);
+                }
+            }
+        }
+    }
+    for (const UTexture* texture : textures)
+    {
+        memory.textureBytes += texture->CalcTextureMemorySizeEnum(TMC_ResidentMips);
+    }
+
+    for (const FSectionsEntry& entry : sectionsEntries)
+    {
+        if (entry.sections.IsValid())
+        {
+            for (const FProcMeshSection& section : entry.sections->sections)
+            {
+                memory.derivedBytes += section.ProcVertexBuffer.GetAllocatedSize() + section.ProcIndexBuffer.GetAllocatedSize();
+            }
+        }
+    }
+    return memory;
+}
+
+void URuntimeMeshImportAsset::EmptyDerivedData()
+{
+    check(IsInGameThread());
+    // The built sections can be large, the last reference to them is dropped on a background thread
+    FRuntimeMeshDeferredRelease::FBatch released;
+    for (FSectionsEntry& entry : sectionsEntries)
+    {
+        SIZE_T numBytes = 0;
+        for (int32 sectionIndex = 0; entry.sections.IsValid() && sectionIndex < entry.sections->sections.Num(); ++sectionIndex)
+        {
+            const FProcMeshSection& section = entry.sections->sections[sectionIndex];
+            numBytes += section.ProcVertexBuffer.GetAllocatedSize() + section.ProcIndexBuffer.GetAllocatedSize();
+        }
+        released.Add(MoveTemp(entry.sections), numBytes);
+        entry.sections.Reset();
+    }
+    FRuntimeMeshDeferredRelease::Release(MoveTemp(released));
+    materialSets.Empty();
+    for (int32 meshIndex = 0; meshIndex < bodySetupEntries.Num(); ++meshIndex)
+    {
+        if (!bodySetupEntries[meshIndex].bIsCooking)
+        {
+            bodySetupEntries[meshIndex].bIsCreated = false;
+            bodySetups[meshIndex] = nullptr;
+        }
+    }
+}
+
+void URuntimeMeshImportAsset::ApplySections(const FProcMeshSections& sections, const FPendingApply& pendingApply)
+{
+    UProceduralMeshComponent* component = pendingApply.component.Get();
+    if (!component)
+    {
+        return;
+    }
+
+    TArray<UMaterialInterface*> materials;
+    for (const TWeakObjectPtr<UMaterialInterface>& material : pendingApply.materials)
+    {
+        materials.Add(material.Get());
+    }
+    URuntimeMeshImportExportLibrary::SetProcMeshSections(*component, sections.sections, sections.materialIndices, materials);
+    pendingApply.callbackDone.ExecuteIfBound();
+}
+
+void URuntimeMeshImportAsset::OnSectionsBuilt(const int32 entryIndex, TSharedRef<const FProcMeshSections, ESPMode::ThreadSafe> builtSections)
+{
+    check(IsInGameThread());
+    FSectionsEntry& entry = sectionsEntries[entryIndex];
+    entry.sections = builtSections;
+    entry.bIsBuilding = false;
+
+    // Moved out first, a callback can request the sections again or empty them
+    TArray<FPendingApply> pendingApplies = MoveTemp(entry.pendingApplies);
+    for (const FPendingApply& pendingApply : pendingApplies)
+    {
+        ApplySections(*builtSections, pendingApply);
+    }
+}
+
+void URuntimeMeshImportAsset::OnBodySetupCreated(const int32 meshIndex, UBodySetup* bodySetup)
+{
+    check(IsInGameThread());
+    FBodySetupEntry& entry = bodySetupEntries[meshIndex];
+    entry.bIsCooking = false;
+    entry.bIsCreated = true;
+    bodySetups[meshIndex] = bodySetup;
+
+    // Moved out first, a callback can request the body setup again or empty it
+    TArray<FRuntimeBodySetupCreated> pendingCallbacks = MoveTemp(entry.pendingCallbacks);
+    for (const FRuntimeBodySetupCreated& callback : pendingCallbacks)
+    {
+        callback.ExecuteIfBound(bodySetup);
+    }
+}
@@ -0,0 +1,325 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportAssetManager.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshDeferredRelease.h"
+#include "RuntimeMeshImportResultCache.h"
+
+void URuntimeMeshImportAssetManager::Deinitialize()
+{
+    // The running imports find the manager gone and drop their result
+    pendingLoads.Empty();
+    for (const TPair<FString, URuntimeMeshImportAsset*>& asset : residentAssets)
+    {
+        if (asset.Value)
+        {
+            asset.Value->EmptyDerivedData();
+        }
+    }
+    residentAssets.Empty();
+    usageOrder.Empty();
+    sharedGeometries.Empty();
+
+    Super::Deinitialize();
+}
+
+void URuntimeMeshImportAssetManager::LoadAsset_Async_Cpp(const FRuntimeMeshImportParam& param, FRuntimeImportAssetLoaded callbackLoaded)
+{
+    check(IsInGameThread());
+
+    const FString key = GetAssetKey(param);
+    if (URuntimeMeshImportAsset** asset = residentAssets.Find(key))
+    {
+        TouchAsset(key);
+        callbackLoaded.ExecuteIfBound(*asset);
+        return;
+    }
+
+    if (TArray<FRuntimeImportAssetLoaded>* callbacks = pendingLoads.Find(key))
+    {
+        callbacks->Add(callbackLoaded);
+        return;
+    }
+    pendingLoads.Add(key).Add(callbackLoaded);
+
+    FRuntimeMeshImportParam importParam = param;
+    if (importParam.resultCacheDirectory.IsEmpty())
+    {
+        importParam.resultCacheDirectory = resultCacheDirectory;
+    }
+
+    TWeakObjectPtr<URuntimeMeshImportAssetManager> weakThis(this);
+    FRuntimeImportFinished callbackImported;
+    callbackImported.BindLambda([weakThis, key](FRuntimeMeshImportResultRef result) {
+        if (URuntimeMeshImportAssetManager* manager = weakThis.Get())
+        {
+            manager->OnAssetImported(key, result);
+        }
+    });
+    URuntimeMeshImportExportLibrary::ImportSceneWithParam_Async_Cpp(importParam, callbackImported, FRuntimeMeshImportExportProgressUpdate());
+}
+
+void URuntimeMeshImportAssetManager::LoadAsset_Async(const FRuntimeMeshImportParam& param, FRuntimeImportAssetLoadedDyn loadedDelegate)
+{
+    FRuntimeImportAssetLoaded callbackLoadedRaw;
+    callbackLoadedRaw.BindLambda([loadedDelegate](URuntimeMeshImportAsset* asset) {
+        loadedDelegate.ExecuteIfBound(asset);
+    });
+    LoadAsset_Async_Cpp(param, callbackLoadedRaw);
+}
+
+URuntimeMeshImportAsset* URuntimeMeshImportAssetManager::FindAsset(const FRuntimeMeshImportParam& param)
+{
+    check(IsInGameThread());
+    const FString key = GetAssetKey(param);
+    URuntimeMeshImportAsset** asset = residentAssets.Find(key);
+    if (!asset)
+    {
+        return nullptr;
+    }
+    TouchAsset(key);
+    return *asset;
+}
+
+void URuntimeMeshImportAssetManager::ReleaseAsset(URuntimeMeshImportAsset* asset)
+{
+    check(IsInGameThread());
+    if (!asset)
+    {
+        return;
+    }
+    if (const FString* key = residentAssets.FindKey(asset))
+    {
+        EvictAsset(FString(*key));
+    }
+}
+
+void URuntimeMeshImportAssetManager::SetMemoryBudget(const int32 budgetMB)
+{
+    memoryBudgetBytes = int64(FMath::Max(budgetMB, 0)) * 1024 * 1024;
+    EnforceMemoryBudget();
+}
+
+void URuntimeMeshImportAssetManager::SetResultCacheDirectory(const FString& directory)
+{
+    resultCacheDirectory = directory;
+}
+
+void URuntimeMeshImportAssetManager::EnforceMemoryBudget()
+{
+    check(IsInGameThread());
+    if (memoryBudgetBytes <= 0)
+    {
+        return;
+    }
+
+    TArray<int64> assetBytes;
+    int64 totalBytes = 0;
+    for (const FString& key : usageOrder)
+    {
+        URuntimeMeshImportAsset* asset = residentAssets.FindRef(key);
+        assetBytes.Add(asset ? asset->GetMemoryUsage().GetTotalBytes() : 0);
+        totalBytes += assetBytes.Last();
+    }
+
+    int32 numEvict = 0;
+    while (totalBytes > memoryBudgetBytes && numEvict < usageOrder.Num() - 1)
+    {
+        totalBytes -= assetBytes[numEvict];
+        ++numEvict;
+    }
+    if (numEvict == 0)
+    {
+        return;
+    }
+
+    RMIE_LOG(Log, "Evicting %d import assets to stay within the budget of %lld MB.", numEvict, memoryBudgetBytes / (1024 * 1024));
+    const TArray<FString> evictedKeys(usageOrder.GetData(), numEvict);
+    for (const FString& key : evictedKeys)
+    {
+        EvictAsset(key);
+    }
+}
+
+FRuntimeMeshImportAssetMemory URuntimeMeshImportAssetManager::GetMemoryUsage() const
+{
+    FRuntimeMeshImportAssetMemory memory;
+    for (const TPair<FString, URuntimeMeshImportAsset*>& asset : residentAssets)
+    {
+        if (asset.Value)
+        {
+            const FRuntimeMeshImportAssetMemory assetMemory = asset.Value->GetMemoryUsage();
+            memory.geometryBytes += assetMemory.geometryBytes;
+            memory.textureBytes += assetMemory.textureBytes;
+            memory.derivedBytes += assetMemory.derivedBytes;
+        }
+    }
+    // Once, however many assets use them
+    for (const TPair<int64, TWeakObjectPtr<URuntimeMeshImportAsset>>& geometry : sharedGeometries)
+    {
+        if (const URuntimeMeshImportAsset* geometryAsset = geometry.Value.Get())
+        {
+            const FRuntimeMeshImportAssetMemory assetMemory = geometryAsset->GetMemoryUsage();
+            memory.geometryBytes += assetMemory.geometryBytes;
+            memory.derivedBytes += assetMemory.derivedBytes;
+        }
+    }
+    return memory;
+}
+
+int32 URuntimeMeshImportAssetManager::GetNumResidentAssets() const
+{
+    return residentAssets.Num();
+}
+
+int32 URuntimeMeshImportAssetManager::GetNumSharedGeometries() const
+{
+    int32 numGeometries = 0;
+    for (const TPair<int64, TWeakObjectPtr<URuntimeMeshImportAsset>>& geometry : sharedGeometries)
+    {
+        numGeometries += geometry.Value.IsValid() ? 1 : 0;
+    }
+    return numGeometries;
+}
+
+FString URuntimeMeshImportAssetManager::GetAssetKey(const FRuntimeMeshImportParam& param)
+{
+    const FString file = URuntimeMeshImportExportLibrary::ResolveImportFilePath(param.file, param.pathType);
+    return FString::Printf(TEXT("%s|%016llx"), *file.ToLower(), FRuntimeMeshImportResultCache::HashParam(param));
+}
+
+void URuntimeMeshImportAssetManager::OnAssetImported(const FString& key, FRuntimeMeshImportResultRef result)
+{
+    check(IsInGameThread());
+
+    TArray<FRuntimeImportAssetLoaded> callbacks;
+    if (!pendingLoads.RemoveAndCopyValue(key, callbacks))
+    {
+        return;
+    }
+
+    URuntimeMeshImportAsset* asset = nullptr;
+    if (result->bSuccess)
+    {
+        TArray<URuntimeMeshImportAsset*> geometries;
+        ShareGeometry(*result, geometries);
+        asset = URuntimeMeshImportAsset::Create(result);
+        for (int32 meshIndex = 0; meshIndex < geometries.Num(); ++meshIndex)
+        {
+            asset->SetSharedGeometry(meshIndex, geometries[meshIndex]);
+        }
+        residentAssets.Add(key, asset);
+        usageOrder.Add(key);
+        EnforceMemoryBudget();
+    }
+    else
+    {
+        RMIE_LOG(Warning, "The import of the asset %s failed.", *key);
+    }
+
+    for (const FRuntimeImportAssetLoaded& callback : callbacks)
+    {
+        callback.ExecuteIfBound(asset);
+    }
+}
+
+void URuntimeMeshImportAssetManager::TouchAsset(const FString& key)
+{
+    usageOrder.Remove(key);
+    usageOrder.Add(key);
+}
+
+void URuntimeMeshImportAssetManager::EvictAsset(const FString& key)
+{
+    URuntimeMeshImportAsset* asset = nullptr;
+    if (residentAssets.RemoveAndCopyValue(key, asset) && asset)
+    {
+        asset->EmptyDerivedData();
+    }
+    usageOrder.Remove(key);
+}
+
+void URuntimeMeshImportAssetManager::ShareGeometry(FRuntimeMeshImportResult& result, TArray<URuntimeMeshImportAsset*>& outGeometries)
+{
+    outGeometries.SetNumZeroed(result.meshInfos.Num());
+    if (!result.meshInfos.ContainsByPredicate([](const FRuntimeMeshImportMeshInfo& meshInfo) { return meshInfo.geometryHash != 0; }))
+    {
+        return;
+    }
+
+    // The geometries no asset references anymore were collected
+    for (auto geometry = sharedGeometries.CreateIterator(); geometry; ++geometry)
+    {
+        if (!geometry.Value().IsValid())
+        {
+            geometry.RemoveCurrent();
+        }
+    }
+
+    int32 numShared = 0;
+    for (int32 meshIndex = 0; meshIndex < result.meshInfos.Num(); ++meshIndex)
+    {
+        FRuntimeMeshImportMeshInfo& meshInfo = result.meshInfos[meshIndex];
+        if (meshInfo.geometryHash == 0)
+        {
+            continue;
+        }
+
+        URuntimeMeshImportAsset* geometry = sharedGeometries.FindRef(meshInfo.geometryHash).Get();
+        if (geometry)
+        {
+            // Guards against a collision of the hashes, only the same layout is shared
+            const FRuntimeMeshImportMeshInfo& sharedMeshInfo = geometry->GetResult().meshInfos[0];
+            bool bSameLayout = sharedMeshInfo.sections.Num() == meshInfo.sections.Num() && sharedMeshInfo.lods.Num() == meshInfo.lods.Num();
+            for (int32 sectionIndex = 0; bSameLayout && sectionIndex < meshInfo.sections.Num(); ++sectionIndex)
+            {
+                bSameLayout = sharedMeshInfo.sections[sectionIndex].vertices.Num() == meshInfo.sections[sectionIndex].vertices.Num()
+                    && sharedMeshInfo.sections[sectionIndex].triangles.Num() == meshInfo.sections[sectionIndex].triangles.Num();
+            }
+            if (!bSameLayout)
+            {
+                RMIE_LOG(Warning, "The geometry of the mesh %s has the hash of another geometry, it is not shared.", *meshInfo.meshName.ToString());
+                continue;
+            }
+            ++numShared;
+        }
+        else
+        {
+            // The first mesh with the geometry becomes the shared one, without its instances
+            FRuntimeMeshImportResultRef geometryResult = FRuntimeMeshDeferredRelease::MakeImportResult();
+            geometryResult->bSuccess = true;
+            FRuntimeMeshImportMeshInfo& geometryMeshInfo = geometryResult->meshInfos.AddDefaulted_GetRef();
+            geometryMeshInfo.meshName = meshInfo.meshName;
+            geometryMeshInfo.sections = MoveTemp(meshInfo.sections);
+            geometryMeshInfo.bounds = meshInfo.bounds;
+            geometryMeshInfo.lods = MoveTemp(meshInfo.lods);
+            geometryMeshInfo.collision = MoveTemp(meshInfo.collision);
+            geometryMeshInfo.geometryHash = meshInfo.geometryHash;
+            // The sections are left with their materials
+            meshInfo.sections.SetNum(geometryMeshInfo.sections.Num());
+            for (int32 sectionIndex = 0; sectionIndex < meshInfo.sections.Num(); ++sectionIndex)
+            {
+                meshInfo.sections[sectionIndex].materialIndex = geometryMeshInfo.sections[sectionIndex].materialIndex;
+                meshInfo.sections[sectionIndex].materialName = geometryMeshInfo.sections[sectionIndex].materialName;
+            }
+            geometry = URuntimeMeshImportAsset::Create(geometryResult);
+            sharedGeometries.Add(meshInfo.geometryHash, geometry);
+        }
+
+        // Only the materials of the sections are left, the geometry is the shared one
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            FRuntimeMeshImportSectionInfo materialSection;
+            materialSection.materialName = section.materialName;
+            materialSection.materialIndex = section.materialIndex;
+            section = MoveTemp(materialSection);
+        }
+        meshInfo.lods.Empty();
+        meshInfo.collision = FRuntimeMeshImportCollision();
+        outGeometries[meshIndex] = geometry;
+    }
+    RMIE_LOG(Log, "%d of %d meshes share the geometry of an earlier import.", numShared, result.meshInfos.Num());
+}
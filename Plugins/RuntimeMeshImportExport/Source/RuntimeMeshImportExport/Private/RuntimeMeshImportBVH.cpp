@@ -0,0 +1,570 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportBVH.h"
+#include "Async/ParallelFor.h"
+#include "PhysicsEngine/BoxElem.h"
+
+namespace
+{
+    constexpr int32 NumSAHBins = 12;
+
+    using FNodeStack = TArray<int32, TInlineAllocator<64>>;
+
+    struct FBVHBuildContext
+    {
+        TArray<FBox> triangleBounds;
+        TArray<FVector> centroids;
+        TArray<int32>& triangles;
+        int32 maxLeafTriangles;
+
+        FBVHBuildContext(TArray<int32>& inTriangles, const int32 inMaxLeafTriangles)
+            : triangles(inTriangles)
+            , maxLeafTriangles(inMaxLeafTriangles)
+        {}
+    };
+
+    // A node whose triangle range is built later, in parallel with the others
+    struct FPendingSubtree
+    {
+        int32 node;
+        int32 begin;
+        int32 end;
+    };
+
+    // Half the surface area, the SAH only compares them
+    float GetHalfArea(const FBox& box)
+    {
+        if (!box.IsValid)
+        {
+            return 0.f;
+        }
+        const FVector size = box.Max - box.Min;
+        return size.X * size.Y + size.Y * size.Z + size.Z * size.X;
+    }
+
+    float GetVolume(const FRuntimeMeshImportBVHNode& node)
+    {
+        const FVector size = node.boundsMax - node.boundsMin;
+        return size.X * size.Y * size.Z;
+    }
+
+    // Binned SAH split of the centroids in [begin, end). Partitions the range and returns the first triangle of the right side.
+    int32 SplitRange(FBVHBuildContext& context, const int32 begin, const int32 end)
+    {
+        FBox centroidBounds(ForceInit);
+        for (int32 i = begin; i < end; ++i)
+        {
+            centroidBounds += context.centroids[context.triangles[i]];
+        }
+        const FVector extent = centroidBounds.Max - centroidBounds.Min;
+
+        int32 bestAxis = INDEX_NONE;
+        int32 bestBin = 0;
+        float bestCost = TNumericLimits<float>::Max();
+        for (int32 axis = 0; axis < 3; ++axis)
+        {
+            if (extent[axis] <= KINDA_SMALL_NUMBER)
+            {
+                continue;
+            }
+            const float binScale = NumSAHBins / extent[axis];
+            int32 binCounts[NumSAHBins] = {};
+            FBox binBounds[NumSAHBins];
+            for (FBox& box : binBounds)
+            {
+                box.Init();
+            }
+            for (int32 i = begin; i < end; ++i)
+            {
+                const int32 triangle = context.triangles[i];
+                const int32 bin = FMath::Min(int32((context.centroids[triangle][axis] - centroidBounds.Min[axis]) * binScale), NumSAHBins - 1);
+                ++binCounts[bin];
+                binBounds[bin] += context.triangleBounds[triangle];
+            }
+
+            // Cost of the right side for a split before each bin, swept from the right
+            float rightCosts[NumSAHBins];
+            FBox rightBounds(ForceInit);
+            int32 rightCount = 0;
+            for (int32 bin = NumSAHBins - 1; bin > 0; --bin)
+            {
+                rightBounds += binBounds[bin];
+                rightCount += binCounts[bin];
+                rightCosts[bin] = rightCount * GetHalfArea(rightBounds);
+            }
+            FBox leftBounds(ForceInit);
+            int32 leftCount = 0;
+            for (int32 bin = 1; bin < NumSAHBins; ++bin)
+            {
+                leftBounds += binBounds[bin - 1];
+                leftCount += binCounts[bin - 1];
+                const float cost = leftCount * GetHalfArea(leftBounds) + rightCosts[bin];
+                if (leftCount > 0 && leftCount < end - begin && cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = bin;
+                }
+            }
+        }
+
+        if (bestAxis == INDEX_NONE)
+        {
+            // All centroids are at the same place, any split is as good as the other
+            return begin + (end - begin) / 2;
+        }
+
+        const float binScale = NumSAHBins / extent[bestAxis];
+        int32 left = begin;
+        int32 right = end - 1;
+        while (left <= right)
+        {
+            const int32 triangle = context.triangles[left];
+            const int32 bin = FMath::Min(int32((context.centroids[triangle][bestAxis] - centroidBounds.Min[bestAxis]) * binScale), NumSAHBins - 1);
+            if (bin < bestBin)
+            {
+                ++left;
+            }
+            else
+            {
+                Swap(context.triangles[left], context.triangles[right]);
+                --right;
+            }
+        }
+        return left;
+    }
+
+    /**
+     * Builds the subtree of the triangles in [begin, end) below 'root', which must already be in 'nodes'.
+     * With 'outPending', ranges with less than 'deferBelow' triangles are not built but added to it.
+     */
+    void BuildNodes(FBVHBuildContext& context, TArray<FRuntimeMeshImportBVHNode>& nodes, const int32 root, const int32 begin, const int32 end,
+        const int32 deferBelow, TArray<FPendingSubtree>* outPending)
+    {
+        TArray<FPendingSubtree, TInlineAllocator<64>> stack;
+        stack.Add({ root, begin, end });
+        while (stack.Num() > 0)
+        {
+            const FPendingSubtree range = stack.Pop(false);
+
+            FBox bounds(ForceInit);
+            for (int32 i = range.begin; i < range.end; ++i)
+            {
+                bounds += context.triangleBounds[context.triangles[i]];
+            }
+            FRuntimeMeshImportBVHNode& node = nodes[range.node];
+            node.boundsMin = bounds.Min;
+            node.boundsMax = bounds.Max;
+
+            const int32 numTriangles = range.end - range.begin;
+            if (numTriangles <= context.maxLeafTriangles)
+            {
+                node.firstIndex = range.begin;
+                node.numTriangles = numTriangles;
+                continue;
+            }
+            if (outPending && numTriangles < deferBelow)
+            {
+                outPending->Add(range);
+                continue;
+            }
+
+            const int32 mid = SplitRange(context, range.begin, range.end);
+            const int32 firstChild = nodes.AddUninitialized(2);
+            nodes[range.node].firstIndex = firstChild;
+            nodes[range.node].numTriangles = 0;
+            stack.Add({ firstChild, range.begin, mid });
+            stack.Add({ firstChild + 1, mid, range.end });
+        }
+    }
+
+    bool IntersectRayBox(const FRuntimeMeshImportBVHNode& node, const FVector& start, const FVector& invDirection, const float maxTime, float& outTime)
+    {
+        float tMin = 0.f;
+        float tMax = maxTime;
+        for (int32 axis = 0; axis < 3; ++axis)
+        {
+            float t0 = (node.boundsMin[axis] - start[axis]) * invDirection[axis];
+            float t1 = (node.boundsMax[axis] - start[axis]) * invDirection[axis];
+            if (t0 > t1)
+            {
+                Swap(t0, t1);
+            }
+            tMin = FMath::Max(tMin, t0);
+            tMax = FMath::Min(tMax, t1);
+            if (tMin > tMax)
+            {
+                return false;
+            }
+        }
+        outTime = tMin;
+        return true;
+    }
+
+    // Möller–Trumbore, both faces. 'outTime' is in units of 'direction'.
+    bool IntersectRayTriangle(const FVector& start, const FVector& direction, const FVector& a, const FVector& b, const FVector& c, float& outTime)
+    {
+        const FVector edge1 = b - a;
+        const FVector edge2 = c - a;
+        const FVector p = FVector::CrossProduct(direction, edge2);
+        const float determinant = FVector::DotProduct(edge1, p);
+        if (FMath::Abs(determinant) < SMALL_NUMBER)
+        {
+            return false;
+        }
+        const float invDeterminant = 1.f / determinant;
+        const FVector s = start - a;
+        const float u = FVector::DotProduct(s, p) * invDeterminant;
+        if (u < 0.f || u > 1.f)
+        {
+            return false;
+        }
+        const FVector q = FVector::CrossProduct(s, edge1);
+        const float v = FVector::DotProduct(direction, q) * invDeterminant;
+        if (v < 0.f || u + v > 1.f)
+        {
+            return false;
+        }
+        outTime = FVector::DotProduct(edge2, q) * invDeterminant;
+        return true;
+    }
+
+    // Separating axis test of the triangle against the 3 box axes, the triangle normal and the 9 edge cross products
+    bool IntersectTriangleBox(const FVector& a, const FVector& b, const FVector& c, const FVector& boxCenter, const FVector& boxExtent)
+    {
+        const FVector points[3] = { a - boxCenter, b - boxCenter, c - boxCenter };
+        const FVector edges[3] = { points[1] - points[0], points[2] - points[1], points[0] - points[2] };
+
+        auto IsSeparating = [&](const FVector& axis)
+        {
+            const float p0 = FVector::DotProduct(points[0], axis);
+            const float p1 = FVector::DotProduct(points[1], axis);
+            const float p2 = FVector::DotProduct(points[2], axis);
+            const float radius = boxExtent.X * FMath::Abs(axis.X) + boxExtent.Y * FMath::Abs(axis.Y) + boxExtent.Z * FMath::Abs(axis.Z);
+            return FMath::Min3(p0, p1, p2) > radius || FMath::Max3(p0, p1, p2) < -radius;
+        };
+
+        const FVector boxAxes[3] = { FVector(1.f, 0.f, 0.f), FVector(0.f, 1.f, 0.f), FVector(0.f, 0.f, 1.f) };
+        for (const FVector& axis : boxAxes)
+        {
+            if (IsSeparating(axis))
+            {
+                return false;
+            }
+        }
+        if (IsSeparating(FVector::CrossProduct(edges[0], edges[1])))
+        {
+            return false;
+        }
+        for (const FVector& edge : edges)
+        {
+            for (const FVector& axis : boxAxes)
+            {
+                if (IsSeparating(FVector::CrossProduct(edge, axis)))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    float GetSquaredDistanceToNode(const FRuntimeMeshImportBVHNode& node, const FVector& point)
+    {
+        const FVector closest(
+            FMath::Clamp(point.X, node.boundsMin.X, node.boundsMax.X),
+            FMath::Clamp(point.Y, node.boundsMin.Y, node.boundsMax.Y),
+            FMath::Clamp(point.Z, node.boundsMin.Z, node.boundsMax.Z));
+        return FVector::DistSquared(closest, point);
+    }
+
+    // Calls 'visitTriangle' for the triangles of all leaves whose node passes 'testNode'
+    template<typename TestNodeType, typename VisitTriangleType>
+    void TraverseBVH(const FRuntimeMeshImportBVH& bvh, TestNodeType testNode, VisitTriangleType visitTriangle)
+    {
+        if (bvh.nodes.Num() == 0)
+        {
+            return;
+        }
+        FNodeStack stack;
+        stack.Add(0);
+        while (stack.Num() > 0)
+        {
+            const FRuntimeMeshImportBVHNode& node = bvh.nodes[stack.Pop(false)];
+            if (!testNode(node))
+            {
+                continue;
+            }
+            if (node.IsLeaf())
+            {
+                for (int32 i = node.firstIndex; i < node.firstIndex + node.numTriangles; ++i)
+                {
+                    visitTriangle(bvh.triangles[i]);
+                }
+            }
+            else
+            {
+                stack.Add(node.firstIndex);
+                stack.Add(node.firstIndex + 1);
+            }
+        }
+    }
+}
+
+TSharedRef<FRuntimeMeshImportBVH, ESPMode::ThreadSafe> FRuntimeMeshImportBVH::Build(const FRuntimeMeshImportSectionInfo& section, const int32 maxLeafTriangles, const bool bParallel)
+{
+    TSharedRef<FRuntimeMeshImportBVH, ESPMode::ThreadSafe> bvh = MakeShared<FRuntimeMeshImportBVH, ESPMode::ThreadSafe>();
+    const int32 numTriangles = section.triangles.Num() / 3;
+    if (numTriangles == 0)
+    {
+        return bvh;
+    }
+
+    bvh->triangles.SetNumUninitialized(numTriangles);
+    FBVHBuildContext context(bvh->triangles, FMath::Max(1, maxLeafTriangles));
+    context.triangleBounds.SetNumUninitialized(numTriangles);
+    context.centroids.SetNumUninitialized(numTriangles);
+    const TArray<FVector>& vertices = section.vertices;
+    const TArray<int32>& indices = section.triangles;
+    ParallelFor(numTriangles, [&](int32 triangle)
+    {
+        bvh->triangles[triangle] = triangle;
+        FBox& bounds = context.triangleBounds[triangle];
+        bounds.Init();
+        bounds += vertices[indices[triangle * 3]];
+        bounds += vertices[indices[triangle * 3 + 1]];
+        bounds += vertices[indices[triangle * 3 + 2]];
+        context.centroids[triangle] = bounds.GetCenter();
+    }, !bParallel);
+
+    // The upper levels split the whole range and run here, the subtrees below this size are independent and built in parallel
+    const int32 deferBelow = FMath::Max(1024, numTriangles / 64);
+    TArray<FPendingSubtree> pending;
+    bvh->nodes.Reserve(2 * numTriangles / context.maxLeafTriangles + 1);
+    bvh->nodes.AddUninitialized(1);
+    BuildNodes(context, bvh->nodes, 0, 0, numTriangles, deferBelow, bParallel ? &pending : nullptr);
+    if (pending.Num() == 0)
+    {
+        return bvh;
+    }
+
+    TArray<TArray<FRuntimeMeshImportBVHNode>> subtrees;
+    subtrees.SetNum(pending.Num());
+    ParallelFor(pending.Num(), [&](int32 index)
+    {
+        const FPendingSubtree& range = pending[index];
+        TArray<FRuntimeMeshImportBVHNode>& subtree = subtrees[index];
+        subtree.Reserve(2 * (range.end - range.begin) / context.maxLeafTriangles + 1);
+        subtree.AddUninitialized(1);
+        BuildNodes(context, subtree, 0, range.begin, range.end, 0, nullptr);
+    });
+
+    // The root of a subtree replaces its placeholder, the other nodes are appended and their child indices moved along
+    for (int32 index = 0; index < pending.Num(); ++index)
+    {
+        const TArray<FRuntimeMeshImportBVHNode>& subtree = subtrees[index];
+        const int32 offset = bvh->nodes.Num() - 1;
+        for (int32 local = 0; local < subtree.Num(); ++local)
+        {
+            FRuntimeMeshImportBVHNode node = subtree[local];
+            if (!node.IsLeaf())
+            {
+                node.firstIndex += offset;
+            }
+            if (local == 0)
+            {
+                bvh->nodes[pending[index].node] = node;
+            }
+            else
+            {
+                bvh->nodes.Add(node);
+            }
+        }
+    }
+    return bvh;
+}
+
+bool FRuntimeMeshImportBVH::Raycast(const FRuntimeMeshImportSectionInfo& section, const FVector& start, const FVector& end, FRuntimeMeshImportRaycastHit& outHit) const
+{
+    const FVector direction = end - start;
+    if (nodes.Num() == 0 || direction.IsNearlyZero())
+    {
+        return false;
+    }
+    // Divisions by 0 give infinities, which the slab test handles
+    const FVector invDirection(1.f / direction.X, 1.f / direction.Y, 1.f / direction.Z);
+
+    float closestTime = 1.f;
+    int32 closestTriangle = INDEX_NONE;
+    float nodeTime;
+    FNodeStack stack;
+    if (IntersectRayBox(nodes[0], start, invDirection, closestTime, nodeTime))
+    {
+        stack.Add(0);
+    }
+    while (stack.Num() > 0)
+    {
+        const FRuntimeMeshImportBVHNode& node = nodes[stack.Pop(false)];
+        if (node.IsLeaf())
+        {
+            for (int32 i = node.firstIndex; i < node.firstIndex + node.numTriangles; ++i)
+            {
+                const int32 triangle = triangles[i];
+                float time;
+                if (IntersectRayTriangle(start, direction, section.vertices[section.triangles[triangle * 3]],
+                    section.vertices[section.triangles[triangle * 3 + 1]], section.vertices[section.triangles[triangle * 3 + 2]], time)
+                    && time >= 0.f && time <= closestTime)
+                {
+                    closestTime = time;
+                    closestTriangle = triangle;
+                }
+            }
+            continue;
+        }
+
+        // The nearer child is pushed last, so it is visited first and can cull the other one
+        float times[2];
+        const bool bHits[2] = {
+            IntersectRayBox(nodes[node.firstIndex], start, invDirection, closestTime, times[0]),
+            IntersectRayBox(nodes[node.firstIndex + 1], start, invDirection, closestTime, times[1]) };
+        const int32 nearChild = bHits[0] && bHits[1] && times[1] < times[0] ? 1 : 0;
+        if (bHits[1 - nearChild])
+        {
+            stack.Add(node.firstIndex + 1 - nearChild);
+        }
+        if (bHits[nearChild])
+        {
+            stack.Add(node.firstIndex + nearChild);
+        }
+    }
+
+    if (closestTriangle == INDEX_NONE)
+    {
+        return false;
+    }
+    const FVector& a = section.vertices[section.triangles[closestTriangle * 3]];
+    const FVector& b = section.vertices[section.triangles[closestTriangle * 3 + 1]];
+    const FVector& c = section.vertices[section.triangles[closestTriangle * 3 + 2]];
+    FVector normal = FVector::CrossProduct(c - a, b - a).GetSafeNormal();
+    if (FVector::DotProduct(normal, direction) > 0.f)
+    {
+        normal = -normal;
+    }
+    outHit.distance = closestTime * direction.Size();
+    outHit.location = start + direction * closestTime;
+    outHit.normal = normal;
+    outHit.triangleIndex = closestTriangle;
+    return true;
+}
+
+void FRuntimeMeshImportBVH::OverlapBox(const FRuntimeMeshImportSectionInfo& section, const FBox& box, TArray<int32>& outTriangles) const
+{
+    if (!box.IsValid)
+    {
+        return;
+    }
+    const FVector boxCenter = box.GetCenter();
+    const FVector boxExtent = box.GetExtent();
+    TraverseBVH(*this,
+        [&](const FRuntimeMeshImportBVHNode& node)
+        {
+            return node.boundsMin.X <= box.Max.X && node.boundsMax.X >= box.Min.X
+                && node.boundsMin.Y <= box.Max.Y && node.boundsMax.Y >= box.Min.Y
+                && node.boundsMin.Z <= box.Max.Z && node.boundsMax.Z >= box.Min.Z;
+        },
+        [&](const int32 triangle)
+        {
+            if (IntersectTriangleBox(section.vertices[section.triangles[triangle * 3]], section.vertices[section.triangles[triangle * 3 + 1]],
+                section.vertices[section.triangles[triangle * 3 + 2]], boxCenter, boxExtent))
+            {
+                outTriangles.Add(triangle);
+            }
+        });
+}
+
+void FRuntimeMeshImportBVH::OverlapSphere(const FRuntimeMeshImportSectionInfo& section, const FVector& center, const float radius, TArray<int32>& outTriangles) const
+{
+    const float radiusSquared = radius * radius;
+    TraverseBVH(*this,
+        [&](const FRuntimeMeshImportBVHNode& node)
+        {
+            return GetSquaredDistanceToNode(node, center) <= radiusSquared;
+        },
+        [&](const int32 triangle)
+        {
+            const FVector closest = FMath::ClosestPointOnTriangleToPoint(center, section.vertices[section.triangles[triangle * 3]],
+                section.vertices[section.triangles[triangle * 3 + 1]], section.vertices[section.triangles[triangle * 3 + 2]]);
+            if (FVector::DistSquared(closest, center) <= radiusSquared)
+            {
+                outTriangles.Add(triangle);
+            }
+        });
+}
+
+void FRuntimeMeshImportBVH::GetFrontier(const int32 maxNodes, TArray<int32>& outNodes) const
+{
+    if (nodes.Num() == 0)
+    {
+        return;
+    }
+
+    // The inner nodes of the frontier as a heap with the largest volume on top
+    auto IsLarger = [this](const int32 a, const int32 b)
+    {
+        return GetVolume(nodes[a]) > GetVolume(nodes[b]);
+    };
+    TArray<int32> innerNodes;
+    TArray<int32> leafNodes;
+    (nodes[0].IsLeaf() ? leafNodes : innerNodes).Add(0);
+    while (innerNodes.Num() > 0 && innerNodes.Num() + leafNodes.Num() < maxNodes)
+    {
+        int32 split;
+        innerNodes.HeapPop(split, IsLarger, false);
+        for (int32 child = nodes[split].firstIndex; child < nodes[split].firstIndex + 2; ++child)
+        {
+            if (nodes[child].IsLeaf())
+            {
+                leafNodes.Add(child);
+            }
+            else
+            {
+                innerNodes.HeapPush(child, IsLarger);
+            }
+        }
+    }
+    outNodes.Append(innerNodes);
+    outNodes.Append(leafNodes);
+}
+
+void FRuntimeMeshImportBVH::GetTriangleRange(const int32 nodeIndex, int32& outBegin, int32& outEnd) const
+{
+    // The build partitions the triangles in place, so the first child's leaves come before the second child's
+    int32 first = nodeIndex;
+    while (!nodes[first].IsLeaf())
+    {
+        first = nodes[first].firstIndex;
+    }
+    int32 last = nodeIndex;
+    while (!nodes[last].IsLeaf())
+    {
+        last = nodes[last].firstIndex + 1;
+    }
+    outBegin = nodes[first].firstIndex;
+    outEnd = nodes[last].firstIndex + nodes[last].numTriangles;
+}
+
+void FRuntimeMeshImportBVH::GetCollisionBoxes(const int32 maxBoxes, TArray<FKBoxElem>& outBoxes) const
+{
+    TArray<int32> frontier;
+    GetFrontier(maxBoxes, frontier);
+    outBoxes.Reserve(outBoxes.Num() + frontier.Num());
+    for (const int32 index : frontier)
+    {
+        const FRuntimeMeshImportBVHNode& node = nodes[index];
+        const FVector size = node.boundsMax - node.boundsMin;
+        FKBoxElem& box = outBoxes[outBoxes.Emplace(size.X, size.Y, size.Z)];
+        box.Center = (node.boundsMin + node.boundsMax) * 0.5f;
+    }
+}
@@ -0,0 +1,254 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportBenchmark.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "Async/Async.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformFile.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+    // Samples the used physical memory on its own thread until it is stopped
+    class FPeakMemorySampler
+    {
+    public:
+        FPeakMemorySampler(const float intervalSeconds)
+        {
+            startMemory = FPlatformMemory::GetStats().UsedPhysical;
+            peakMemory = startMemory;
+            sampler = Async(EAsyncExecution::Thread, [this, intervalSeconds]() {
+                while (!bStop)
+                {
+                    Sample();
+                    FPlatformProcess::Sleep(intervalSeconds);
+                }
+            });
+        }
+
+        // Returns the peak above the memory at the start in bytes
+        uint64 Stop()
+        {
+            bStop = true;
+            sampler.Wait();
+            Sample();
+            return peakMemory > startMemory ? peakMemory - startMemory : 0;
+        }
+
+    private:
+        void Sample()
+        {
+            peakMemory = FMath::Max<uint64>(peakMemory, FPlatformMemory::GetStats().UsedPhysical);
+        }
+
+        uint64 startMemory = 0;
+        // Only written by the sampler until it is stopped
+        uint64 peakMemory = 0;
+        FThreadSafeBool bStop;
+        TFuture<void> sampler;
+    };
+
+    int32 CountVertices(const FRuntimeMeshImportResult& result)
+    {
+        int32 numVertices = 0;
+        for (const FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+        {
+            for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+            {
+                numVertices += section.vertices.Num();
+            }
+        }
+        return numVertices;
+    }
+
+    FString GetCombinationKey(const FRuntimeMeshImportBenchmarkSample& sample)
+    {
+        return FString::Printf(TEXT("%s %s %s"), *FPaths::GetCleanFilename(sample.file)
+            , *StaticEnum<EImportMethodMesh>()->GetNameStringByValue(int64(sample.importMethodMesh))
+            , *StaticEnum<EImportMethodSection>()->GetNameStringByValue(int64(sample.importMethodSection)));
+    }
+
+    // The median of the total seconds of the successful samples per combination
+    TMap<FString, float> GetMedianTotalSeconds(const TArray<FRuntimeMeshImportBenchmarkSample>& samples)
+    {
+        TMap<FString, TArray<float>> secondsByCombination;
+        for (const FRuntimeMeshImportBenchmarkSample& sample : samples)
+        {
+            if (sample.bSuccess)
+            {
+                secondsByCombination.FindOrAdd(GetCombinationKey(sample)).Add(sample.timings.totalSeconds);
+            }
+        }
+
+        TMap<FString, float> medians;
+        for (TPair<FString, TArray<float>>& combination : secondsByCombination)
+        {
+            combination.Value.Sort();
+            medians.Add(combination.Key, combination.Value[combination.Value.Num() / 2]);
+        }
+        return medians;
+    }
+}
+
+void URuntimeMeshImportBenchmark::RunImportBenchmark(const FRuntimeMeshImportBenchmarkParam& param, TArray<FRuntimeMeshImportBenchmarkSample>& outSamples)
+{
+    outSamples.Reset();
+    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+    for (const FString& file : param.files)
+    {
+        const int64 fileSize = platformFile.FileSize(*file);
+        if (fileSize < 0)
+        {
+            RMIE_LOG(Warning, "Benchmark file does not exist: %s", *file);
+            continue;
+        }
+
+        for (const EImportMethodMesh importMethodMesh : param.importMethodsMesh)
+        {
+            for (const EImportMethodSection importMethodSection : param.importMethodsSection)
+            {
+                FRuntimeMeshImportParam importParam = param.importParam;
+                importParam.file = file;
+                importParam.pathType = EPathType::Absolute;
+                importParam.importMethodMesh = importMethodMesh;
+                importParam.importMethodSection = importMethodSection;
+
+                for (int32 repetition = 0; repetition < FMath::Max(param.numRepetitions, 1); ++repetition)
+                {
+                    FRuntimeMeshImportResult result;
+                    FPeakMemorySampler memorySampler(FMath::Max(param.memorySampleIntervalMs, 1.f) / 1000.f);
+                    URuntimeMeshImportExportLibrary::ImportScene_AnyThread(importParam, FRuntimeMeshImportExportProgressUpdate(), result);
+                    const uint64 peakMemory = memorySampler.Stop();
+
+                    FRuntimeMeshImportBenchmarkSample& sample = outSamples.AddDefaulted_GetRef();
+                    sample.file = file;
+                    sample.fileSize = fileSize;
+                    sample.importMethodMesh = importMethodMesh;
+                    sample.importMethodSection = importMethodSection;
+                    sample.repetition = repetition;
+                    sample.bSuccess = result.bSuccess;
+                    sample.timings = result.timings;
+                    sample.numVertices = CountVertices(result);
+                    sample.verticesPerSecond = result.timings.totalSeconds > 0.f ? sample.numVertices / result.timings.totalSeconds : 0.f;
+                    sample.peakMemoryMB = float(double(peakMemory) / (1024.0 * 1024.0));
+                    if (!result.bSuccess)
+                    {
+                        RMIE_LOG(Warning, "Benchmark import of %s failed.", *file);
+                    }
+                }
+            }
+        }
+    }
+}
+
+FString URuntimeMeshImportBenchmark::SamplesToCsv(const TArray<FRuntimeMeshImportBenchmarkSample>& samples)
+{
+    FString csv = TEXT("file,fileSize,importMethodMesh,importMethodSection,repetition,bSuccess,readSeconds,conversionSeconds,mergeSeconds,normalizeSeconds")
+        TEXT(",materialSeconds,textureSeconds,postProcessSeconds,totalSeconds,numVertices,verticesPerSecond,peakMemoryMB\n");
+    for (const FRuntimeMeshImportBenchmarkSample& sample : samples)
+    {
+        const FRuntimeMeshImportStageTimings& timings = sample.timings;
+        csv += FString::Printf(TEXT("%s,%lld,%s,%s,%d,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%d,%.1f,%.2f\n")
+            , *FPaths::GetCleanFilename(sample.file), sample.fileSize
+            , *StaticEnum<EImportMethodMesh>()->GetNameStringByValue(int64(sample.importMethodMesh))
+            , *StaticEnum<EImportMethodSection>()->GetNameStringByValue(int64(sample.importMethodSection))
+            , sample.repetition, sample.bSuccess ? 1 : 0
+            , timings.readSeconds, timings.conversionSeconds, timings.mergeSeconds, timings.normalizeSeconds
+            , timings.materialSeconds, timings.textureSeconds, timings.postProcessSeconds, timings.totalSeconds
+            , sample.numVertices, sample.verticesPerSecond, sample.peakMemoryMB);
+    }
+    return csv;
+}
+
+FString URuntimeMeshImportBenchmark::SamplesToJson(const TArray<FRuntimeMeshImportBenchmarkSample>& samples)
+{
+    TArray<FString> objects;
+    for (const FRuntimeMeshImportBenchmarkSample& sample : samples)
+    {
+        const FRuntimeMeshImportStageTimings& timings = sample.timings;
+        objects.Add(FString::Printf(TEXT("{\"file\":\"%s\",\"fileSize\":%lld,\"importMethodMesh\":\"%s\",\"importMethodSection\":\"%s\",\"repetition\":%d,\"bSuccess\":%s")
+            TEXT(",\"readSeconds\":%.6f,\"conversionSeconds\":%.6f,\"mergeSeconds\":%.6f,\"normalizeSeconds\":%.6f,\"materialSeconds\":%.6f")
+            TEXT(",\"textureSeconds\":%.6f,\"postProcessSeconds\":%.6f,\"totalSeconds\":%.6f,\"numVertices\":%d,\"verticesPerSecond\":%.1f,\"peakMemoryMB\":%.2f}")
+            , *sample.file.ReplaceCharWithEscapedChar(), sample.fileSize
+            , *StaticEnum<EImportMethodMesh>()->GetNameStringByValue(int64(sample.importMethodMesh))
+            , *StaticEnum<EImportMethodSection>()->GetNameStringByValue(int64(sample.importMethodSection))
+            , sample.repetition, sample.bSuccess ? TEXT("true") : TEXT("false")
+            , timings.readSeconds, timings.conversionSeconds, timings.mergeSeconds, timings.normalizeSeconds, timings.materialSeconds
+            , timings.textureSeconds, timings.postProcessSeconds, timings.totalSeconds
+            , sample.numVertices, sample.verticesPerSecond, sample.peakMemoryMB));
+    }
+    return TEXT("[") + FString::Join(objects, TEXT(",\n")) + TEXT("]\n");
+}
+
+bool URuntimeMeshImportBenchmark::SamplesFromJson(const FString& json, TArray<FRuntimeMeshImportBenchmarkSample>& outSamples)
+{
+    outSamples.Reset();
+    TArray<TSharedPtr<FJsonValue>> values;
+    const TSharedRef<TJsonReader<>> reader = TJsonReaderFactory<>::Create(json);
+    if (!FJsonSerializer::Deserialize(reader, values))
+    {
+        RMIE_LOG(Error, "Failed to read the benchmark samples: %s", *reader->GetErrorMessage());
+        return false;
+    }
+
+    for (const TSharedPtr<FJsonValue>& value : values)
+    {
+        const TSharedPtr<FJsonObject>* object = nullptr;
+        if (!value.IsValid() || !value->TryGetObject(object))
+        {
+            continue;
+        }
+
+        FRuntimeMeshImportBenchmarkSample& sample = outSamples.AddDefaulted_GetRef();
+        const FJsonObject& sampleObject = **object;
+        sample.file = sampleObject.GetStringField(TEXT("file"));
+        sample.fileSize = int64(sampleObject.GetNumberField(TEXT("fileSize")));
+        const int64 importMethodMesh = StaticEnum<EImportMethodMesh>()->GetValueByNameString(sampleObject.GetStringField(TEXT("importMethodMesh")));
+        const int64 importMethodSection = StaticEnum<EImportMethodSection>()->GetValueByNameString(sampleObject.GetStringField(TEXT("importMethodSection")));
+        sample.importMethodMesh = importMethodMesh == INDEX_NONE ? EImportMethodMesh::Keep : EImportMethodMesh(importMethodMesh);
+        sample.importMethodSection = importMethodSection == INDEX_NONE ? EImportMethodSection::Keep : EImportMethodSection(importMethodSection);
+        sample.repetition = int32(sampleObject.GetNumberField(TEXT("repetition")));
+        sample.bSuccess = sampleObject.GetBoolField(TEXT("bSuccess"));
+        sample.timings.readSeconds = float(sampleObject.GetNumberField(TEXT("readSeconds")));
+        sample.timings.conversionSeconds = float(sampleObject.GetNumberField(TEXT("conversionSeconds")));
+        sample.timings.mergeSeconds = float(sampleObject.GetNumberField(TEXT("mergeSeconds")));
+        sample.timings.normalizeSeconds = float(sampleObject.GetNumberField(TEXT("normalizeSeconds")));
+        sample.timings.materialSeconds = float(sampleObject.GetNumberField(TEXT("materialSeconds")));
+        sample.timings.textureSeconds = float(sampleObject.GetNumberField(TEXT("textureSeconds")));
+        sample.timings.postProcessSeconds = float(sampleObject.GetNumberField(TEXT("postProcessSeconds")));
+        sample.timings.totalSeconds = float(sampleObject.GetNumberField(TEXT("totalSeconds")));
+        sample.numVertices = int32(sampleObject.GetNumberField(TEXT("numVertices")));
+        sample.verticesPerSecond = float(sampleObject.GetNumberField(TEXT("verticesPerSecond")));
+        sample.peakMemoryMB = float(sampleObject.GetNumberField(TEXT("peakMemoryMB")));
+    }
+    return true;
+}
+
+bool URuntimeMeshImportBenchmark::CompareToBaseline(const TArray<FRuntimeMeshImportBenchmarkSample>& samples, const TArray<FRuntimeMeshImportBenchmarkSample>& baseline
+        , const float tolerance, TArray<FString>& outRegressions)
+{
+    outRegressions.Reset();
+    const TMap<FString, float> currentMedians = GetMedianTotalSeconds(samples);
+    const TMap<FString, float> baselineMedians = GetMedianTotalSeconds(baseline);
+    for (const TPair<FString, float>& current : currentMedians)
+    {
+        const float* baselineSeconds = baselineMedians.Find(current.Key);
+        if (baselineSeconds && current.Value > *baselineSeconds * (1.f + FMath::Max(tolerance, 0.f)))
+        {
+            outRegressions.Add(FString::Printf(TEXT("%s: %.3fs, baseline %.3fs (+%.0f%%)"), *current.Key, current.Value, *baselineSeconds
+                , *baselineSeconds > 0.f ? (current.Value / *baselineSeconds - 1.f) * 100.f : 0.f));
+        }
+    }
+    return outRegressions.Num() == 0;
+}
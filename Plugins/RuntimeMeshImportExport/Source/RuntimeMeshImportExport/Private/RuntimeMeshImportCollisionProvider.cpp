@@ -0,0 +1,33 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportCollisionProvider.h"
+
+bool URuntimeMeshImportCollisionProvider::GetPhysicsTriMeshData(FTriMeshCollisionData* collisionData, bool bInUseAllTriData)
+{
+    if (trimeshTriangles.Num() == 0)
+    {
+        return false;
+    }
+
+    collisionData->Vertices = trimeshVertices;
+    const int32 numTriangles = trimeshTriangles.Num() / 3;
+    collisionData->Indices.SetNumUninitialized(numTriangles);
+    for (int32 triangle = 0; triangle < numTriangles; ++triangle)
+    {
+        FTriIndices& indices = collisionData->Indices[triangle];
+        indices.v0 = trimeshTriangles[triangle * 3];
+        indices.v1 = trimeshTriangles[triangle * 3 + 1];
+        indices.v2 = trimeshTriangles[triangle * 3 + 2];
+    }
+    collisionData->MaterialIndices.SetNumZeroed(numTriangles);
+    collisionData->bFlipNormals = true;
+    collisionData->bFastCook = true;
+    return true;
+}
+
+bool URuntimeMeshImportCollisionProvider::ContainsPhysicsTriMeshData(bool bInUseAllTriData) const
+{
+    return trimeshTriangles.Num() > 0;
+}
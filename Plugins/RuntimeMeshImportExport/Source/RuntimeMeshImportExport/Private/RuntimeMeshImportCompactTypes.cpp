@@ -0,0 +1,540 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportCompactTypes.h"
+#include "AnimationKeySampling.h"
+#include "MeshConversionKernels.h"
+#include "ProceduralMeshComponent.h"
+#include "StaticMeshResources.h"
+
+SIZE_T FRuntimeMeshImportCompactSection::GetAllocatedSize() const
+{
+    SIZE_T size = vertices.GetAllocatedSize() + normals.GetAllocatedSize() + tangents.GetAllocatedSize() + uv0Half.GetAllocatedSize() + uv0.GetAllocatedSize() + uv1.GetAllocatedSize()
+        + vertexColors.GetAllocatedSize() + indices16.GetAllocatedSize() + indices32.GetAllocatedSize() + boneIndices.GetAllocatedSize() + boneWeights.GetAllocatedSize()
+        + morphTargets.GetAllocatedSize() + linesAndPoints.GetAllocatedSize();
+    for (const FRuntimeMeshImportCompactMorphTarget& target : morphTargets)
+    {
+        size += target.GetAllocatedSize();
+    }
+    return size;
+}
+
+SIZE_T FRuntimeMeshImportCompactMeshInfo::GetAllocatedSize() const
+{
+    SIZE_T size = sections.GetAllocatedSize() + instanceTransforms.GetAllocatedSize() + lods.GetAllocatedSize()
+        + collision.trimeshVertices.GetAllocatedSize() + collision.trimeshTriangles.GetAllocatedSize() + collision.convexHulls.GetAllocatedSize();
+    for (const FRuntimeMeshImportConvexHull& hull : collision.convexHulls)
+    {
+        size += hull.vertices.GetAllocatedSize();
+    }
+    for (const FRuntimeMeshImportCompactSection& section : sections)
+    {
+        size += section.GetAllocatedSize();
+    }
+    for (const FRuntimeMeshImportCompactMeshLOD& lod : lods)
+    {
+        size += lod.sections.GetAllocatedSize();
+        for (const FRuntimeMeshImportCompactSection& section : lod.sections)
+        {
+            size += section.GetAllocatedSize();
+        }
+    }
+    return size;
+}
+
+SIZE_T FRuntimeMeshImportCompactResult::GetAllocatedSize() const
+{
+    SIZE_T size = meshInfos.GetAllocatedSize() + animations.GetAllocatedSize();
+    for (const FRuntimeMeshImportCompactMeshInfo& meshInfo : meshInfos)
+    {
+        size += meshInfo.GetAllocatedSize();
+    }
+    for (const FRuntimeMeshImportCompactAnimation& animation : animations)
+    {
+        size += animation.GetAllocatedSize();
+    }
+    return size;
+}
+
+namespace
+{
+    // The three smaller components of a unit quaternion are within this
+    const float quantizedQuatRange = HALF_SQRT_2;
+    const float quantizedQuatSteps = 32767.f;
+}
+
+FRuntimeMeshImportQuantizedQuat::FRuntimeMeshImportQuantizedQuat(const FQuat& rotation)
+{
+    const FQuat normalized = rotation.GetNormalized();
+    float components[4] = { normalized.X, normalized.Y, normalized.Z, normalized.W };
+    int32 largest = 0;
+    for (int32 component = 1; component < 4; ++component)
+    {
+        largest = FMath::Abs(components[component]) > FMath::Abs(components[largest]) ? component : largest;
+    }
+    // q and -q are the same rotation, the dropped component is rebuilt positive
+    const float sign = components[largest] < 0.f ? -1.f : 1.f;
+
+    int32 slot = 0;
+    for (int32 component = 0; component < 4; ++component)
+    {
+        if (component == largest)
+        {
+            continue;
+        }
+        const float unit = FMath::Clamp(components[component] * sign / quantizedQuatRange * 0.5f + 0.5f, 0.f, 1.f);
+        data[slot++] = uint16(FMath::RoundToInt(unit * quantizedQuatSteps));
+    }
+    data[0] |= uint16((largest & 1) << 15);
+    data[1] |= uint16((largest >> 1) << 15);
+}
+
+FQuat FRuntimeMeshImportQuantizedQuat::ToQuat() const
+{
+    const int32 largest = (data[0] >> 15) | ((data[1] >> 15) << 1);
+    float components[4];
+    float sumSquared = 0.f;
+    int32 slot = 0;
+    for (int32 component = 0; component < 4; ++component)
+    {
+        if (component == largest)
+        {
+            continue;
+        }
+        const float unit = float(data[slot++] & 0x7FFF) / quantizedQuatSteps;
+        components[component] = (unit * 2.f - 1.f) * quantizedQuatRange;
+        sumSquared += components[component] * components[component];
+    }
+    components[largest] = FMath::Sqrt(FMath::Max(0.f, 1.f - sumSquared));
+    return FQuat(components[0], components[1], components[2], components[3]).GetNormalized();
+}
+
+FTransform FRuntimeMeshImportCompactAnimationTrack::Sample(const float time, const FTransform& restTransform) const
+{
+    return FAnimationKeySampling::SampleTrack(*this, time, restTransform, [this](const int32 key) { return rotations[key].ToQuat(); });
+}
+
+void FRuntimeMeshImportCompactAnimation::SampleBones(const float time, const TArray<FRuntimeMeshImportBone>& bones, TArray<FTransform>& outLocalTransforms) const
+{
+    outLocalTransforms.SetNumUninitialized(bones.Num());
+    for (int32 boneIndex = 0; boneIndex < bones.Num(); ++boneIndex)
+    {
+        outLocalTransforms[boneIndex] = bones[boneIndex].localTransform;
+    }
+    FAnimationKeySampling::SampleTracks(tracks, time, false, outLocalTransforms);
+}
+
+void FRuntimeMeshImportCompactAnimation::SampleNodes(const float time, const TArray<FRuntimeMeshImportNode>& nodes, TArray<FTransform>& outLocalTransforms) const
+{
+    outLocalTransforms.SetNumUninitialized(nodes.Num());
+    for (int32 nodeIndex = 0; nodeIndex < nodes.Num(); ++nodeIndex)
+    {
+        outLocalTransforms[nodeIndex] = nodes[nodeIndex].localTransform;
+    }
+    FAnimationKeySampling::SampleTracks(tracks, time, true, outLocalTransforms);
+}
+
+SIZE_T FRuntimeMeshImportCompactAnimation::GetAllocatedSize() const
+{
+    SIZE_T size = tracks.GetAllocatedSize();
+    for (const FRuntimeMeshImportCompactAnimationTrack& track : tracks)
+    {
+        size += track.GetAllocatedSize();
+    }
+    return size;
+}
+
+void FRuntimeMeshImportCompactConversion::ToCompact(const FRuntimeMeshImportAnimation& animation, FRuntimeMeshImportCompactAnimation& outAnimation)
+{
+    FRuntimeMeshImportAnimation copy = animation;
+    ToCompact(MoveTemp(copy), outAnimation);
+}
+
+void FRuntimeMeshImportCompactConversion::ToCompact(FRuntimeMeshImportAnimation&& animation, FRuntimeMeshImportCompactAnimation& outAnimation)
+{
+    outAnimation.name = animation.name;
+    outAnimation.duration = animation.duration;
+    outAnimation.tracks.SetNum(animation.tracks.Num());
+    for (int32 trackIndex = 0; trackIndex < animation.tracks.Num(); ++trackIndex)
+    {
+        FRuntimeMeshImportAnimationTrack& track = animation.tracks[trackIndex];
+        FRuntimeMeshImportCompactAnimationTrack& outTrack = outAnimation.tracks[trackIndex];
+        outTrack.boneIndex = track.boneIndex;
+        outTrack.nodeIndex = track.nodeIndex;
+        outTrack.positionTimes = MoveTemp(track.positionTimes);
+        outTrack.positions = MoveTemp(track.positions);
+        outTrack.rotationTimes = MoveTemp(track.rotationTimes);
+        outTrack.rotations.SetNumUninitialized(track.rotations.Num());
+        for (int32 key = 0; key < track.rotations.Num(); ++key)
+        {
+            outTrack.rotations[key] = FRuntimeMeshImportQuantizedQuat(track.rotations[key]);
+        }
+        outTrack.scaleTimes = MoveTemp(track.scaleTimes);
+        outTrack.scales = MoveTemp(track.scales);
+    }
+}
+
+void FRuntimeMeshImportCompactConversion::ToAnimation(const FRuntimeMeshImportCompactAnimation& animation, FRuntimeMeshImportAnimation& outAnimation)
+{
+    outAnimation.name = animation.name;
+    outAnimation.duration = animation.duration;
+    outAnimation.tracks.SetNum(animation.tracks.Num());
+    for (int32 trackIndex = 0; trackIndex < animation.tracks.Num(); ++trackIndex)
+    {
+        const FRuntimeMeshImportCompactAnimationTrack& track = animation.tracks[trackIndex];
+        FRuntimeMeshImportAnimationTrack& outTrack = outAnimation.tracks[trackIndex];
+        outTrack.boneIndex = track.boneIndex;
+        outTrack.nodeIndex = track.nodeIndex;
+        outTrack.positionTimes = track.positionTimes;
+        outTrack.positions = track.positions;
+        outTrack.rotationTimes = track.rotationTimes;
+        outTrack.rotations.SetNumUninitialized(track.rotations.Num());
+        for (int32 key = 0; key < track.rotations.Num(); ++key)
+        {
+            outTrack.rotations[key] = track.rotations[key].ToQuat();
+        }
+        outTrack.scaleTimes = track.scaleTimes;
+        outTrack.scales = track.scales;
+    }
+}
+
+namespace
+{
+    // The streams that change their type, the others are copied or moved by the caller
+    void PackSectionStreams(const FRuntimeMeshImportSectionInfo& section, const FRuntimeMeshImportCompactOptions& options, FRuntimeMeshImportCompactSection& outSection)
+    {
+        check(outSection.morphTargets.Num() == section.morphTargets.Num());
+        for (int32 targetIndex = 0; targetIndex < section.morphTargets.Num(); ++targetIndex)
+        {
+            const TArray<FVector>& normalDeltas = section.morphTargets[targetIndex].normalDeltas;
+            TArray<FFloat16>& outNormalDeltas = outSection.morphTargets[targetIndex].normalDeltas;
+            outNormalDeltas.SetNumUninitialized(normalDeltas.Num() * 3);
+            for (int32 index = 0; index < normalDeltas.Num(); ++index)
+            {
+                outNormalDeltas[index * 3] = normalDeltas[index].X;
+                outNormalDeltas[index * 3 + 1] = normalDeltas[index].Y;
+                outNormalDeltas[index * 3 + 2] = normalDeltas[index].Z;
+            }
+        }
+
+        outSection.normals.SetNumUninitialized(section.normals.Num());
+        for (int32 index = 0; index < section.normals.Num(); ++index)
+        {
+            outSection.normals[index] = FPackedNormal(section.normals[index]);
+        }
+
+        outSection.tangents.SetNumUninitialized(section.tangents.Num());
+        for (int32 index = 0; index < section.tangents.Num(); ++index)
+        {
+            outSection.tangents[index] = FPackedNormal(FVector4(section.tangents[index], 1.f));
+        }
+
+        outSection.uv0Half.Empty();
+        if (options.bHalfUVs)
+        {
+            outSection.uv0.Empty();
+            outSection.uv0Half.SetNumUninitialized(section.uv0.Num());
+            for (int32 index = 0; index < section.uv0.Num(); ++index)
+            {
+                outSection.uv0Half[index] = FVector2DHalf(section.uv0[index]);
+            }
+        }
+
+        // Not sRGB, ToSectionInfo reinterprets the bytes as linear and the colors convert back to the same values
+        outSection.vertexColors.SetNumUninitialized(section.vertexColors.Num());
+        FMeshConversionKernels::QuantizeColors(section.vertexColors.GetData(), outSection.vertexColors.GetData(), section.vertexColors.Num(), false);
+
+        outSection.indices16.Empty();
+        outSection.indices32.Empty();
+        if (options.b16BitIndices && outSection.vertices.Num() <= MAX_uint16 + 1)
+        {
+            outSection.indices16.SetNumUninitialized(section.triangles.Num());
+            for (int32 index = 0; index < section.triangles.Num(); ++index)
+            {
+                outSection.indices16[index] = uint16(section.triangles[index]);
+            }
+        }
+        else
+        {
+            outSection.indices32.SetNumUninitialized(section.triangles.Num());
+            FMemory::Memcpy(outSection.indices32.GetData(), section.triangles.GetData(), section.triangles.Num() * sizeof(uint32));
+        }
+    }
+}
+
+void FRuntimeMeshImportCompactConversion::ToCompact(const FRuntimeMeshImportSectionInfo& section, const FRuntimeMeshImportCompactOptions& options, FRuntimeMeshImportCompactSection& outSection)
+{
+    outSection.materialName = section.materialName;
+    outSection.materialIndex = section.materialIndex;
+    outSection.vertices = section.vertices;
+    outSection.BoneInfo = section.BoneInfo;
+    outSection.numBoneInfluences = section.numBoneInfluences;
+    outSection.boneIndices = section.boneIndices;
+    outSection.boneWeights = section.boneWeights;
+    outSection.bounds = section.bounds;
+    outSection.bvh = section.bvh;
+    outSection.linesAndPoints = section.linesAndPoints;
+    outSection.uv0 = options.bHalfUVs ? TArray<FVector2D>() : section.uv0;
+    outSection.uv1 = section.uv1;
+
+    outSection.morphTargets.SetNum(section.morphTargets.Num());
+    for (int32 targetIndex = 0; targetIndex < section.morphTargets.Num(); ++targetIndex)
+    {
+        const FRuntimeMeshImportMorphTarget& target = section.morphTargets[targetIndex];
+        FRuntimeMeshImportCompactMorphTarget& outTarget = outSection.morphTargets[targetIndex];
+        outTarget.name = target.name;
+        outTarget.vertexIndices = target.vertexIndices;
+        outTarget.positionDeltas = target.positionDeltas;
+    }
+
+    PackSectionStreams(section, options, outSection);
+}
+
+void FRuntimeMeshImportCompactConversion::ToCompact(FRuntimeMeshImportSectionInfo&& section, const FRuntimeMeshImportCompactOptions& options, FRuntimeMeshImportCompactSection& outSection)
+{
+    // The streams that keep their type are moved, only the packed ones are converted
+    outSection.materialName = section.materialName;
+    outSection.materialIndex = section.materialIndex;
+    outSection.vertices = MoveTemp(section.vertices);
+    outSection.BoneInfo = MoveTemp(section.BoneInfo);
+    outSection.numBoneInfluences = section.numBoneInfluences;
+    outSection.boneIndices = MoveTemp(section.boneIndices);
+    outSection.boneWeights = MoveTemp(section.boneWeights);
+    outSection.bounds = section.bounds;
+    outSection.bvh = MoveTemp(section.bvh);
+    outSection.linesAndPoints = MoveTemp(section.linesAndPoints);
+    outSection.uv0 = options.bHalfUVs ? TArray<FVector2D>() : MoveTemp(section.uv0);
+    outSection.uv1 = MoveTemp(section.uv1);
+
+    outSection.morphTargets.SetNum(section.morphTargets.Num());
+    for (int32 targetIndex = 0; targetIndex < section.morphTargets.Num(); ++targetIndex)
+    {
+        FRuntimeMeshImportMorphTarget& target = section.morphTargets[targetIndex];
+        FRuntimeMeshImportCompactMorphTarget& outTarget = outSection.morphTargets[targetIndex];
+        outTarget.name = target.name;
+        outTarget.vertexIndices = MoveTemp(target.vertexIndices);
+        outTarget.positionDeltas = MoveTemp(target.positionDeltas);
+    }
+
+    PackSectionStreams(section, options, outSection);
+}
+
+void FRuntimeMeshImportCompactConversion::ToCompact(FRuntimeMeshImportResult&& result, const FRuntimeMeshImportCompactOptions& options, FRuntimeMeshImportCompactResult& outResult)
+{
+    outResult.bSuccess = result.bSuccess;
+    outResult.materialInfos = MoveTemp(result.materialInfos);
+    outResult.nodes = MoveTemp(result.nodes);
+    outResult.bones = MoveTemp(result.bones);
+    outResult.animations.SetNum(result.animations.Num());
+    for (int32 animationIndex = 0; animationIndex < result.animations.Num(); ++animationIndex)
+    {
+        ToCompact(MoveTemp(result.animations[animationIndex]), outResult.animations[animationIndex]);
+    }
+    result.animations.Empty();
+    outResult.meshInfos.SetNum(result.meshInfos.Num());
+    for (int32 meshIndex = 0; meshIndex < result.meshInfos.Num(); ++meshIndex)
+    {
+        FRuntimeMeshImportMeshInfo& meshInfo = result.meshInfos[meshIndex];
+        FRuntimeMeshImportCompactMeshInfo& outMeshInfo = outResult.meshInfos[meshIndex];
+        outMeshInfo.meshName = meshInfo.meshName;
+        outMeshInfo.instanceTransforms = MoveTemp(meshInfo.instanceTransforms);
+        outMeshInfo.bounds = meshInfo.bounds;
+        outMeshInfo.collision = MoveTemp(meshInfo.collision);
+        outMeshInfo.geometryHash = meshInfo.geometryHash;
+        outMeshInfo.sections.SetNum(meshInfo.sections.Num());
+        for (int32 sectionIndex = 0; sectionIndex < meshInfo.sections.Num(); ++sectionIndex)
+        {
+            ToCompact(MoveTemp(meshInfo.sections[sectionIndex]), options, outMeshInfo.sections[sectionIndex]);
+            // Freed right away, so the full precision and the compact result are never in memory at the same time
+            meshInfo.sections[sectionIndex] = FRuntimeMeshImportSectionInfo();
+        }
+        outMeshInfo.lods.SetNum(meshInfo.lods.Num());
+        for (int32 lodIndex = 0; lodIndex < meshInfo.lods.Num(); ++lodIndex)
+        {
+            FRuntimeMeshImportMeshLOD& lod = meshInfo.lods[lodIndex];
+            FRuntimeMeshImportCompactMeshLOD& outLod = outMeshInfo.lods[lodIndex];
+            outLod.screenSize = lod.screenSize;
+            outLod.sections.SetNum(lod.sections.Num());
+            for (int32 sectionIndex = 0; sectionIndex < lod.sections.Num(); ++sectionIndex)
+            {
+                ToCompact(MoveTemp(lod.sections[sectionIndex]), options, outLod.sections[sectionIndex]);
+                lod.sections[sectionIndex] = FRuntimeMeshImportSectionInfo();
+            }
+        }
+    }
+    result.meshInfos.Empty();
+}
+
+void FRuntimeMeshImportCompactConversion::ToSectionInfo(const FRuntimeMeshImportCompactSection& section, FRuntimeMeshImportSectionInfo& outSection)
+{
+    outSection.materialName = section.materialName;
+    outSection.materialIndex = section.materialIndex;
+    outSection.vertices = section.vertices;
+    outSection.BoneInfo = section.BoneInfo;
+    outSection.numBoneInfluences = section.numBoneInfluences;
+    outSection.boneIndices = section.boneIndices;
+    outSection.boneWeights = section.boneWeights;
+    outSection.bounds = section.bounds;
+    outSection.bvh = section.bvh;
+    outSection.linesAndPoints = section.linesAndPoints;
+
+    outSection.morphTargets.SetNum(section.morphTargets.Num());
+    for (int32 targetIndex = 0; targetIndex < section.morphTargets.Num(); ++targetIndex)
+    {
+        const FRuntimeMeshImportCompactMorphTarget& target = section.morphTargets[targetIndex];
+        FRuntimeMeshImportMorphTarget& outTarget = outSection.morphTargets[targetIndex];
+        outTarget.name = target.name;
+        outTarget.vertexIndices = target.vertexIndices;
+        outTarget.positionDeltas = target.positionDeltas;
+        outTarget.normalDeltas.SetNumUninitialized(target.normalDeltas.Num() / 3);
+        for (int32 index = 0; index < outTarget.normalDeltas.Num(); ++index)
+        {
+            outTarget.normalDeltas[index] = FVector(target.normalDeltas[index * 3], target.normalDeltas[index * 3 + 1], target.normalDeltas[index * 3 + 2]);
+        }
+    }
+
+    outSection.normals.SetNumUninitialized(section.normals.Num());
+    for (int32 index = 0; index < section.normals.Num(); ++index)
+    {
+        outSection.normals[index] = section.normals[index].ToFVector();
+    }
+
+    outSection.tangents.SetNumUninitialized(section.tangents.Num());
+    for (int32 index = 0; index < section.tangents.Num(); ++index)
+    {
+        outSection.tangents[index] = section.tangents[index].ToFVector();
+    }
+
+    outSection.uv0.SetNumUninitialized(section.GetNumUVs());
+    for (int32 index = 0; index < outSection.uv0.Num(); ++index)
+    {
+        outSection.uv0[index] = section.GetUV(index);
+    }
+    outSection.uv1 = section.uv1;
+
+    outSection.vertexColors.SetNumUninitialized(section.vertexColors.Num());
+    for (int32 index = 0; index < section.vertexColors.Num(); ++index)
+    {
+        outSection.vertexColors[index] = section.vertexColors[index].ReinterpretAsLinear();
+    }
+
+    outSection.triangles.SetNumUninitialized(section.GetNumIndices());
+    for (int32 index = 0; index < outSection.triangles.Num(); ++index)
+    {
+        outSection.triangles[index] = section.GetIndex(index);
+    }
+}
+
+void FRuntimeMeshImportCompactConversion::ToResult(FRuntimeMeshImportCompactResult&& result, FRuntimeMeshImportResult& outResult)
+{
+    outResult.bSuccess = result.bSuccess;
+    outResult.materialInfos = MoveTemp(result.materialInfos);
+    outResult.nodes = MoveTemp(result.nodes);
+    outResult.bones = MoveTemp(result.bones);
+    outResult.animations.SetNum(result.animations.Num());
+    for (int32 animationIndex = 0; animationIndex < result.animations.Num(); ++animationIndex)
+    {
+        ToAnimation(result.animations[animationIndex], outResult.animations[animationIndex]);
+    }
+    result.animations.Empty();
+    outResult.meshInfos.SetNum(result.meshInfos.Num());
+    for (int32 meshIndex = 0; meshIndex < result.meshInfos.Num(); ++meshIndex)
+    {
+        FRuntimeMeshImportCompactMeshInfo& meshInfo = result.meshInfos[meshIndex];
+        FRuntimeMeshImportMeshInfo& outMeshInfo = outResult.meshInfos[meshIndex];
+        outMeshInfo.meshName = meshInfo.meshName;
+        outMeshInfo.instanceTransforms = MoveTemp(meshInfo.instanceTransforms);
+        outMeshInfo.bounds = meshInfo.bounds;
+        outMeshInfo.collision = MoveTemp(meshInfo.collision);
+        outMeshInfo.geometryHash = meshInfo.geometryHash;
+        outMeshInfo.sections.SetNum(meshInfo.sections.Num());
+        for (int32 sectionIndex = 0; sectionIndex < meshInfo.sections.Num(); ++sectionIndex)
+        {
+            ToSectionInfo(meshInfo.sections[sectionIndex], outMeshInfo.sections[sectionIndex]);
+            meshInfo.sections[sectionIndex] = FRuntimeMeshImportCompactSection();
+        }
+        outMeshInfo.lods.SetNum(meshInfo.lods.Num());
+        for (int32 lodIndex = 0; lodIndex < meshInfo.lods.Num(); ++lodIndex)
+        {
+            FRuntimeMeshImportCompactMeshLOD& lod = meshInfo.lods[lodIndex];
+            FRuntimeMeshImportMeshLOD& outLod = outMeshInfo.lods[lodIndex];
+            outLod.screenSize = lod.screenSize;
+            outLod.sections.SetNum(lod.sections.Num());
+            for (int32 sectionIndex = 0; sectionIndex < lod.sections.Num(); ++sectionIndex)
+            {
+                ToSectionInfo(lod.sections[sectionIndex], outLod.sections[sectionIndex]);
+                lod.sections[sectionIndex] = FRuntimeMeshImportCompactSection();
+            }
+        }
+    }
+    result.meshInfos.Empty();
+}
+
+void FRuntimeMeshImportCompactConversion::ToProceduralMeshSection(const FRuntimeMeshImportCompactSection& section, TArray<FVector>& outVertices, TArray<int32>& outTriangles
+        , TArray<FVector>& outNormals, TArray<FVector2D>& outUV0, TArray<FColor>& outVertexColors, TArray<FProcMeshTangent>& outTangents)
+{
+    outVertices = section.vertices;
+    outVertexColors = section.vertexColors;
+
+    outTriangles.SetNumUninitialized(section.GetNumIndices());
+    for (int32 index = 0; index < outTriangles.Num(); ++index)
+    {
+        outTriangles[index] = section.GetIndex(index);
+    }
+
+    outNormals.SetNumUninitialized(section.normals.Num());
+    for (int32 index = 0; index < section.normals.Num(); ++index)
+    {
+        outNormals[index] = section.normals[index].ToFVector();
+    }
+
+    outUV0.SetNumUninitialized(section.GetNumUVs());
+    for (int32 index = 0; index < outUV0.Num(); ++index)
+    {
+        outUV0[index] = section.GetUV(index);
+    }
+
+    outTangents.SetNumUninitialized(section.tangents.Num());
+    for (int32 index = 0; index < section.tangents.Num(); ++index)
+    {
+        outTangents[index] = FProcMeshTangent(section.tangents[index].ToFVector(), false);
+    }
+}
+
+void FRuntimeMeshImportCompactConversion::ToStaticMeshBuildVertices(const FRuntimeMeshImportCompactSection& section, TArray<FStaticMeshBuildVertex>& outVertices, TArray<uint32>& outIndices)
+{
+    const int32 numVertices = section.vertices.Num();
+    const bool bHasNormals = section.normals.Num() == numVertices;
+    const bool bHasTangents = section.tangents.Num() == numVertices;
+    const bool bHasUVs = section.GetNumUVs() == numVertices;
+    const bool bHasLightmapUVs = section.uv1.Num() == numVertices;
+    const bool bHasColors = section.vertexColors.Num() == numVertices;
+
+    outVertices.SetNumZeroed(numVertices);
+    for (int32 index = 0; index < numVertices; ++index)
+    {
+        FStaticMeshBuildVertex& vertex = outVertices[index];
+        vertex.Position = section.vertices[index];
+        vertex.TangentZ = bHasNormals ? section.normals[index].ToFVector() : FVector::ZeroVector;
+        vertex.TangentX = bHasTangents ? section.tangents[index].ToFVector() : FVector::ZeroVector;
+        // The binormal of a right handed basis, like the engine builds it from a positive W
+        vertex.TangentY = FVector::CrossProduct(vertex.TangentZ, vertex.TangentX);
+        vertex.UVs[0] = bHasUVs ? section.GetUV(index) : FVector2D::ZeroVector;
+        vertex.UVs[1] = bHasLightmapUVs ? section.uv1[index] : FVector2D::ZeroVector;
+        vertex.Color = bHasColors ? section.vertexColors[index] : FColor::White;
+    }
+
+    if (section.indices32.Num() > 0)
+    {
+        outIndices = section.indices32;
+    }
+    else
+    {
+        outIndices.SetNumUninitialized(section.indices16.Num());
+        for (int32 index = 0; index < section.indices16.Num(); ++index)
+        {
+            outIndices[index] = section.indices16[index];
+        }
+    }
+}
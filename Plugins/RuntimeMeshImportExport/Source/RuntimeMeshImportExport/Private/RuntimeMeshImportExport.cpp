@@ -3,50 +3,94 @@
 // Copyright (c) 2019 Lucid Layers
 
 #include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportTextureCache.h"
+#include "RuntimeMeshImportExportFormats.h"
+#include "AssimpImporterPool.h"
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "AssimpLogRouter.h"
+#include "RuntimeMeshDeferredRelease.h"
+#include "RuntimeMeshTextureStreamer.h"
 #include "Interfaces/IPluginManager.h"
 #include "Misc/Paths.h"
 #include "HAL/PlatformFilemanager.h"
 #include "HAL/PlatformFile.h"
 #include "HAL/PlatformProcess.h"
+#include "RuntimeMeshImportExportStats.h"
+
+DEFINE_STAT(STAT_RMIE_ImportRead);
+DEFINE_STAT(STAT_RMIE_ImportConvertScene);
+DEFINE_STAT(STAT_RMIE_ImportConvertMesh);
+DEFINE_STAT(STAT_RMIE_ImportMerge);
+DEFINE_STAT(STAT_RMIE_ImportMaterials);
+DEFINE_STAT(STAT_RMIE_ImportTextures);
+DEFINE_STAT(STAT_RMIE_ImportPostProcess);
+DEFINE_STAT(STAT_RMIE_ImportProbe);
+DEFINE_STAT(STAT_RMIE_ConvertScene);
+DEFINE_STAT(STAT_RMIE_ImportApplySection);
+DEFINE_STAT(STAT_RMIE_ImportApplyMaterial);
+DEFINE_STAT(STAT_RMIE_ImportedVertices);
+DEFINE_STAT(STAT_RMIE_ImportedTriangles);
+DEFINE_STAT(STAT_RMIE_ImportedTextureBytes);
+DEFINE_STAT(STAT_RMIE_ExportGather);
+DEFINE_STAT(STAT_RMIE_ExportProcess);
+DEFINE_STAT(STAT_RMIE_ExportCreateMeshes);
+DEFINE_STAT(STAT_RMIE_ExportTexture);
+DEFINE_STAT(STAT_RMIE_ExportWriteTextures);
+DEFINE_STAT(STAT_RMIE_ExportAssimpWrite);
+DEFINE_STAT(STAT_RMIE_ExportedVertices);
+DEFINE_STAT(STAT_RMIE_ExportedTriangles);
+DEFINE_STAT(STAT_RMIE_ExportedFileBytes);
+DEFINE_STAT(STAT_RMIE_ExportSceneMemory);
+DEFINE_STAT(STAT_RMIE_LLM_AssimpRead);
+DEFINE_STAT(STAT_RMIE_LLM_ImportConversion);
+DEFINE_STAT(STAT_RMIE_LLM_TextureImport);
+DEFINE_STAT(STAT_RMIE_LLM_DecodedTextures);
+DEFINE_STAT(STAT_RMIE_LLM_ExportStaging);
 
 #define LOCTEXT_NAMESPACE "FRuntimeMeshImportExportModule"
 
 void FRuntimeMeshImportExportModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+#if PLATFORM_WINDOWS && !RMIE_ASSIMP_STATIC
+	// The build of Assimp the module rules chose, see AssimpBuild in RuntimeMeshImportExport.Build.cs
 	FString PluginBaseDir = IPluginManager::Get().FindPlugin("RuntimeMeshImportExport")->GetBaseDir();
-	FString configString;
-#if UE_BUILD_SHIPPING
-	configString = "Release";
-#else 
-	configString = "Debug";
-#endif
-
-#if PLATFORM_WINDOWS
-#if PLATFORM_32BITS
-	FString platformString = "Win32";
-#elif PLATFORM_64BITS
-	FString platformString = "x64";
-#endif
-#elif PLATFORM_MAC
-	FString platformString = "Mac";
-#endif
-
-	FString dllFileName = FString(TEXT("assimp-vc141-mt")) + (UE_BUILD_SHIPPING ? TEXT("") : TEXT("d")) + TEXT(".dll");
-	FString dllFile = FPaths::Combine(PluginBaseDir, FString("Source/ThirdParty/assimp/bin"), platformString, configString, dllFileName);
+	FString dllFile = FPaths::Combine(PluginBaseDir, FString("Source/ThirdParty/assimp/bin"), FString(TEXT(RMIE_ASSIMP_DLL_PATH)));
 	if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*dllFile))
 	{
 		RMIE_LOG(Fatal, "Missing file: %s", *dllFile);
 	}
 		
 	dllHandle_assimp = FPlatformProcess::GetDllHandle(*dllFile);
+#endif
+	// On Linux the module links libassimp.so, which is found by the rpath of the module. The static build needs no dll.
+
+	// Needs the Assimp dll
+	FRuntimeMeshImportExportFormats::Startup();
+	FAssimpImporterPool::Startup();
+	FRuntimeMeshImportExportThreadPool::Startup();
+	FRuntimeMeshImportExportTextureCache::Startup();
+	FRuntimeMeshTextureStreamer::Startup();
 }
 
 void FRuntimeMeshImportExportModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
-	FPlatformProcess::FreeDllHandle(dllHandle_assimp);
+	FRuntimeMeshTextureStreamer::Shutdown();
+	FRuntimeMeshImportExportTextureCache::Shutdown();
+	// Waits for the running imports and exports, before the importers are deleted
+	FRuntimeMeshImportExportThreadPool::Shutdown();
+	// The results the imports dropped last are freed before the module is gone
+	FRuntimeMeshDeferredRelease::Flush();
+	FRuntimeMeshImportExportFormats::Shutdown();
+	FAssimpImporterPool::Shutdown();
+	// Before the Assimp dll is released
+	FAssimpLogRouter::Shutdown();
+	if (dllHandle_assimp)
+	{
+		FPlatformProcess::FreeDllHandle(dllHandle_assimp);
+	}
 }
 
 #undef LOCTEXT_NAMESPACE
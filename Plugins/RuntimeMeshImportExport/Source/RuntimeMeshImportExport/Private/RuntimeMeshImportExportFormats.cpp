@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportExportFormats.h"
+#include <assimp/Importer.hpp>
+#include <assimp/Exporter.hpp>
+
+static TUniquePtr<FRuntimeMeshImportExportFormats> formatsInstance;
+
+const FRuntimeMeshImportExportFormats& FRuntimeMeshImportExportFormats::Get()
+{
+    check(formatsInstance.IsValid());
+    return *formatsInstance;
+}
+
+void FRuntimeMeshImportExportFormats::Startup()
+{
+    formatsInstance = MakeUnique<FRuntimeMeshImportExportFormats>();
+    FRuntimeMeshImportExportFormats& formats = *formatsInstance;
+
+    // Registers every importer and post process step, too slow for each query
+    std::string extensionList;
+    {
+        Assimp::Importer importer;
+        importer.GetExtensionList(extensionList);
+    }
+    FString extensionsString(extensionList.c_str());
+    extensionsString = extensionsString.Replace(TEXT("*"), TEXT(""));
+    extensionsString.ParseIntoArray(formats.extensionsImport, TEXT(";"), true);
+    for (const FString& extension : formats.extensionsImport)
+    {
+        formats.normalizedImport.Add(NormalizeExtension(extension));
+    }
+
+    Assimp::Exporter exporter;
+    const int32 formatCount = exporter.GetExportFormatCount();
+    for (int32 i = 0; i < formatCount; ++i)
+    {
+        const FAssimpExportFormat& format = formats.formatsExport.Add_GetRef(FAssimpExportFormat(exporter.GetExportFormatDescription(i)));
+        formats.normalizedExport.Add(NormalizeExtension(format.fileExtension));
+    }
+}
+
+void FRuntimeMeshImportExportFormats::Shutdown()
+{
+    formatsInstance.Reset();
+}
+
+bool FRuntimeMeshImportExportFormats::IsExtensionSupportedImport(const FString& extension) const
+{
+    return normalizedImport.Contains(NormalizeExtension(extension));
+}
+
+bool FRuntimeMeshImportExportFormats::IsExtensionSupportedExport(const FString& extension) const
+{
+    return normalizedExport.Contains(NormalizeExtension(extension));
+}
+
+FString FRuntimeMeshImportExportFormats::NormalizeExtension(const FString& extension)
+{
+    // Assimp compares the extensions in lower case as well
+    FString normalized = extension.StartsWith(TEXT(".")) ? extension.RightChop(1) : extension;
+    normalized.ToLowerInline();
+    return normalized;
+}
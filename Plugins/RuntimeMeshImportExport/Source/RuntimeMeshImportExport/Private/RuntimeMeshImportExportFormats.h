@@ -0,0 +1,45 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+/**
+ *	The file extensions Assimp can import and the formats it can export, queried once when the module starts.
+ *	Never changes afterwards, so it is read from any thread without a lock.
+ */
+class FRuntimeMeshImportExportFormats
+{
+public:
+    // Is created and destroyed with the module
+    static const FRuntimeMeshImportExportFormats& Get();
+    static void Startup();
+    static void Shutdown();
+
+    // With or without the leading dot, case insensitive
+    bool IsExtensionSupportedImport(const FString& extension) const;
+    bool IsExtensionSupportedExport(const FString& extension) const;
+
+    // With the leading dot, in the order of Assimp
+    const TArray<FString>& GetExtensionsImport() const
+    {
+        return extensionsImport;
+    }
+
+    const TArray<FAssimpExportFormat>& GetFormatsExport() const
+    {
+        return formatsExport;
+    }
+
+private:
+    // Lower case, without the dot
+    static FString NormalizeExtension(const FString& extension);
+
+    TArray<FString> extensionsImport;
+    TArray<FAssimpExportFormat> formatsExport;
+    TSet<FString> normalizedImport;
+    TSet<FString> normalizedExport;
+};
@@ -10,16 +10,55 @@
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 #include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Async/AsyncFileHandle.h"
 #include <assimp/Importer.hpp>  // C++ importer interface
 #include <assimp/Exporter.hpp>  // C++ exporter interface
 #include <assimp/IOSystem.hpp>
 #include <assimp/ProgressHandler.hpp>
 #include <assimp/scene.h>       // Output data structure
 #include <assimp/postprocess.h> // Post processing flags
+#include <assimp/config.h>
 #include "ImageUtils.h"
 #include "Kismet/KismetMaterialLibrary.h"
 #include "Materials/MaterialInstanceDynamic.h"
+#include "Engine/StaticMesh.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "StaticMeshResources.h"
 #include "AssimpProgressHandler.h"
+#include "MeshConversionKernels.h"
+#include "RuntimeMeshImportExportTextureCache.h"
+#include "RuntimeMeshImportExportFormats.h"
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "RuntimeMeshDeferredRelease.h"
+#include "RuntimeMeshImportResultCache.h"
+#include "RuntimeMeshMaterialAtlasBuilder.h"
+#include "RuntimeMeshSkeletalMeshBuilder.h"
+#include "RuntimeMeshStaticMeshBuilder.h"
+#include "RuntimeMeshTextureBuilder.h"
+#include "RuntimeMeshTextureStreamer.h"
+#include "UObject/StrongObjectPtr.h"
+#include "AssimpIOSystem.h"
+#include "AssimpImporterPool.h"
+#include "RuntimeMeshGltfImporter.h"
+#include "RuntimeMeshTextImporter.h"
+#include "AssimpSkinningImport.h"
+#include "MeshOptimizer.h"
+#include "MeshTangentGenerator.h"
+#include "LightmapUVGenerator.h"
+#include "MeshSimplifier.h"
+#include "MeshSectionSplitter.h"
+#include "RuntimeMeshImportBVH.h"
+#include "KismetProceduralMeshLibrary.h"
+#include "RuntimeMeshImportCollisionProvider.h"
+#include "MeshCollisionBuilder.h"
+#include "MeshGeometryHash.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "RuntimeMeshImportExportStats.h"
 
 class FLoadMeshAsyncAction : public FPendingLatentAction
 {
@@ -29,11 +68,9 @@ public:
     FWeakObjectPtr callbackTarget;
     FString file;
 
-    FLoadMeshAsyncAction(const FLatentActionInfo& latentInfo, const FString inFile, const FTransform& transform
+    FLoadMeshAsyncAction(const FLatentActionInfo& latentInfo, const FRuntimeMeshImportParam& param
                          , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
-                         , FRuntimeMeshImportResult& result
-                         , const EPathType pathType, const EImportMethodMesh importMethodMesh
-                         , const EImportMethodSection importMethodSection, const bool bNormalizeMesh);
+                         , FRuntimeMeshImportResult& result);
 
     virtual void UpdateOperation(FLatentResponse& response) override
     {
@@ -57,159 +94,242 @@ private:
     bool bTaskDone = false;
 };
 
-void ImportMeshesOfNode(const aiScene* scene, aiNode* node, FRuntimeMeshImportResult& result, const FTransform& nodeTransform)
+/**
+ * Returns the aiPostProcessSteps for the import and sets the matching config properties on 'importer'.
+ */
+unsigned int SetupPostProcessing(Assimp::Importer& importer, const FRuntimeMeshImportPostProcessParam& postProcess)
 {
-    if (node->mNumMeshes == 0)
+    // The conversion of the meshes relies on these
+    unsigned int flags = aiProcess_Triangulate | aiProcess_MakeLeftHanded;
+
+    switch (postProcess.preset)
     {
-        RMIE_LOG(Log, "Mesh has no sections, not adding it as mesh to the result. Node: %s", *FString(node->mName.C_Str()));
-        return;
+    case ERuntimeMeshImportPostProcessPreset::Quality:
+        flags |= aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals | aiProcess_OptimizeMeshes;
+        break;
+    case ERuntimeMeshImportPostProcessPreset::Fast:
+        flags |= aiProcess_GenNormals;
+        break;
+    case ERuntimeMeshImportPostProcessPreset::Custom:
+        flags |= postProcess.bCalcTangentSpace ? aiProcess_CalcTangentSpace : 0;
+        flags |= postProcess.bGenSmoothNormals ? aiProcess_GenSmoothNormals : 0;
+        flags |= postProcess.bOptimizeMeshes ? aiProcess_OptimizeMeshes : 0;
+        flags |= postProcess.bJoinIdenticalVertices ? aiProcess_JoinIdenticalVertices : 0;
+        flags |= postProcess.bImproveCacheLocality ? aiProcess_ImproveCacheLocality : 0;
+        flags |= postProcess.bSplitLargeMeshes ? aiProcess_SplitLargeMeshes : 0;
+        flags |= postProcess.bFindInstances ? aiProcess_FindInstances : 0;
+        break;
+    default:
+        checkNoEntry();
     }
 
-    RMIE_LOG(Log, "Importing %d sections for mesh: %s", node->mNumMeshes, *FString(node->mName.C_Str()));
+    importer.SetPropertyFloat(AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE, FMath::Clamp(postProcess.smoothingAngle, 0.f, 175.f));
+    importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT, FMath::Max(postProcess.splitLargeMeshesVertexLimit, 3));
+    importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, FMath::Max(postProcess.splitLargeMeshesTriangleLimit, 1));
+    importer.SetPropertyInteger(AI_CONFIG_PP_ICL_PTCACHE_SIZE, FMath::Max(postProcess.vertexCacheSize, 3));
 
-    FRuntimeMeshImportMeshInfo& meshInfoRef = result.meshInfos.Add_GetRef(FRuntimeMeshImportMeshInfo());
-    meshInfoRef.meshName = FName(node->mName.C_Str());
-    meshInfoRef.sections.SetNum(node->mNumMeshes);
-
-    for (uint32 nodeMeshIndex = 0; nodeMeshIndex < node->mNumMeshes; nodeMeshIndex++)
-    {
-        int sceneMeshIndex = node->mMeshes[nodeMeshIndex];
-        aiMesh *mesh = scene->mMeshes[sceneMeshIndex];
+    return flags;
+}
 
-        FRuntimeMeshImportSectionInfo &sectionInfoRef = meshInfoRef.sections[nodeMeshIndex];
+static_assert(uint32(ERuntimeMeshImportVertexAttributes::Normals) == FMeshConversionKernels::VertexStream_Normals
+              && uint32(ERuntimeMeshImportVertexAttributes::UV0) == FMeshConversionKernels::VertexStream_UV0
+              && uint32(ERuntimeMeshImportVertexAttributes::Tangents) == FMeshConversionKernels::VertexStream_Tangents
+              && uint32(ERuntimeMeshImportVertexAttributes::VertexColors) == FMeshConversionKernels::VertexStream_Colors
+              , "The vertex attributes are passed to the conversion kernels as they are");
 
-        // Transform
-        //FTransform transform = URuntimeMeshImportExportLibrary::AiTransformToFTransform(node->mTransformation);
-        FTransform transform = nodeTransform;
- /*       transform = transform * composedParentTransform;*/
+// Whether the meshes of the node pass FRuntimeMeshImportParam::nodeIncludeFilters and nodeExcludeFilters
+bool IsNodeImported(const FRuntimeMeshImportParam& param, const FName nodeName)
+{
+    if (param.nodeIncludeFilters.Num() == 0 && param.nodeExcludeFilters.Num() == 0)
+    {
+        return true;
+    }
 
-        sectionInfoRef.materialName = FName(scene->mMaterials[mesh->mMaterialIndex]->GetName().C_Str());
-        sectionInfoRef.materialIndex = mesh->mMaterialIndex;
+    const FString name = nodeName.ToString();
+    auto matchesAny = [&name](const TArray<FString>& filters) {
+        return filters.ContainsByPredicate([&name](const FString& filter) {
+            return name.MatchesWildcard(filter);
+        });
+    };
+    return (param.nodeIncludeFilters.Num() == 0 || matchesAny(param.nodeIncludeFilters)) && !matchesAny(param.nodeExcludeFilters);
+}
 
-        // Vertices
-        sectionInfoRef.vertices.Reserve(mesh->mNumVertices);
-        sectionInfoRef.normals.Reserve(mesh->mNumVertices);
-        sectionInfoRef.uv0.Reserve(mesh->mNumVertices);
-        sectionInfoRef.tangents.Reserve(mesh->mNumVertices);
-        sectionInfoRef.vertexColors.Reserve(mesh->mNumVertices);
-        for (uint32 vertexIndex = 0; vertexIndex < mesh->mNumVertices; ++vertexIndex)
+/**
+ * Copies the faces of 'mesh' with one or two indices and the vertices they use to 'outLinesAndPoints'.
+ * The vertices are in the order of their first use.
+ */
+void ImportLinesAndPoints(const aiMesh* mesh, const FMatrix& positionMatrix, FRuntimeMeshImportLinesAndPoints& outLinesAndPoints)
+{
+    const bool bColors = mesh->HasVertexColors(0);
+    TArray<int32> newVertexIndices;
+    newVertexIndices.Init(INDEX_NONE, mesh->mNumVertices);
+    for (uint32 faceIndex = 0; faceIndex < mesh->mNumFaces; ++faceIndex)
+    {
+        const aiFace& face = mesh->mFaces[faceIndex];
+        if (face.mNumIndices != 1 && face.mNumIndices != 2)
         {
-            sectionInfoRef.vertices.Push(transform.TransformPosition(FVector(
-                                             mesh->mVertices[vertexIndex].x,
-                                             mesh->mVertices[vertexIndex].y,
-                                             mesh->mVertices[vertexIndex].z)));
+            continue;
         }
-
-        //https://www.scratchapixel.com/lessons/mathematics-physics-for-computer-graphics/geometry/transforming-normals
-        FTransform transformForNormal = FTransform(transform.ToMatrixWithScale().Inverse().GetTransposed());
-
-        // Normal
-        if (mesh->HasNormals())
+        TArray<int32>& indices = face.mNumIndices == 1 ? outLinesAndPoints.pointIndices : outLinesAndPoints.lineIndices;
+        for (uint32 corner = 0; corner < face.mNumIndices; ++corner)
         {
-			FVector normal;
-            for (uint32 normalIndex = 0; normalIndex < mesh->mNumVertices; ++normalIndex)
+            const uint32 sourceVertex = face.mIndices[corner];
+            int32& newVertex = newVertexIndices[sourceVertex];
+            if (newVertex == INDEX_NONE)
             {
-				sectionInfoRef.normals.Push(transformForNormal.TransformVector(FVector(
-					mesh->mNormals[normalIndex].x,
-					mesh->mNormals[normalIndex].y,
-					mesh->mNormals[normalIndex].z)).GetSafeNormal());
+                const FVector position = positionMatrix.TransformPosition(FVector(mesh->mVertices[sourceVertex].x, mesh->mVertices[sourceVertex].y, mesh->mVertices[sourceVertex].z));
+                newVertex = outLinesAndPoints.vertices.Add(position);
+                outLinesAndPoints.bounds += position;
+                if (bColors)
+                {
+                    const aiColor4D& color = mesh->mColors[0][sourceVertex];
+                    outLinesAndPoints.colors.Add(FLinearColor(color.r, color.g, color.b, color.a).ToFColor(false));
+                }
             }
+            indices.Add(newVertex);
         }
-        else
-        {
-            sectionInfoRef.normals.SetNumZeroed(mesh->mNumVertices);
-        }
+    }
+}
 
-        // UV Coordinates
-        if (mesh->HasTextureCoords(0))
-        {
-            for (uint32 textureCoordinateIndex = 0; textureCoordinateIndex < mesh->mNumVertices; ++textureCoordinateIndex)
-            {
-                sectionInfoRef.uv0.Add(FVector2D(mesh->mTextureCoords[0][textureCoordinateIndex].x
-                                                 , -mesh->mTextureCoords[0][textureCoordinateIndex].y));
-            }
-        }
+/**
+ * Converts a single aiMesh of a node to a section. Does only write to 'sectionInfoRef',
+ * so it is save to call it for multiple sections in parallel.
+ * @param vertexAttributes		The ERuntimeMeshImportVertexAttributes to import
+ * @param bParallelVertices		Converts the vertices and faces of a large mesh in chunks on the task graph
+ * @param bLinesAndPoints		Imports the lines and points to FRuntimeMeshImportSectionInfo::linesAndPoints
+ */
+void ImportMeshOfNode(const aiScene* scene, const aiNode* node, const uint32 nodeMeshIndex, const FTransform& nodeTransform, const uint32 vertexAttributes
+                      , const bool bParallelVertices, const bool bLinesAndPoints, FRuntimeMeshImportSectionInfo& sectionInfoRef)
+{
+    int sceneMeshIndex = node->mMeshes[nodeMeshIndex];
+    aiMesh *mesh = scene->mMeshes[sceneMeshIndex];
 
-        // Tangent
-        if (mesh->HasTangentsAndBitangents())
-        {
-            for (uint32 tangentIndex = 0; tangentIndex < mesh->mNumVertices; ++tangentIndex)
-            {
-                sectionInfoRef.tangents.Push(transform.TransformVectorNoScale(FVector(
-                                                 mesh->mTangents[tangentIndex].x,
-                                                 mesh->mTangents[tangentIndex].y,
-                                                 mesh->mTangents[tangentIndex].z
-                                             )).GetSafeNormal());
-            }
-        }
+    // Transform
+    const FTransform& transform = nodeTransform;
+
+    sectionInfoRef.materialName = FName(scene->mMaterials[mesh->mMaterialIndex]->GetName().C_Str());
+    sectionInfoRef.materialIndex = mesh->mMaterialIndex;
+
+    const FMatrix positionMatrix = transform.ToMatrixWithScale();
+    const bool bHasLinesOrPoints = (mesh->mPrimitiveTypes & (aiPrimitiveType_POINT | aiPrimitiveType_LINE)) != 0;
+    if (bLinesAndPoints && bHasLinesOrPoints)
+    {
+        ImportLinesAndPoints(mesh, positionMatrix, sectionInfoRef.linesAndPoints);
+    }
 
-        // Vertex color
-        if (mesh->HasVertexColors(0))
+    // Points and lines only, e.g. a scan. The section stays empty instead of holding the streams of vertices no triangle uses.
+    if (!(mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE))
+    {
+        if (!bLinesAndPoints)
         {
-            for (uint32 vertexColorIndex = 0; vertexColorIndex < mesh->mNumVertices; ++vertexColorIndex)
-            {
-                sectionInfoRef.vertexColors.Push(FLinearColor(
-                                                     mesh->mColors[0][vertexColorIndex].r,
-                                                     mesh->mColors[0][vertexColorIndex].g,
-                                                     mesh->mColors[0][vertexColorIndex].b,
-                                                     mesh->mColors[0][vertexColorIndex].a
-                                                 ));
-            }
+            RMIE_LOG(Warning, "Mesh %s has no triangles, skipped its %d vertices. Lines and points are imported with FRuntimeMeshImportParam::bImportLinesAndPoints"
+                ", point clouds with FRuntimeMeshImportPointCloudImporter.", *FString(mesh->mName.C_Str()), mesh->mNumVertices);
         }
+        return;
+    }
 
+    const int32 numVertices = mesh->mNumVertices;
 
-        // Triangles
-        // When the mesh is inside out cause of the scale, flip the winding order of the triangles
-        sectionInfoRef.triangles.Reserve(mesh->mNumFaces * 3);
-        const bool bFlipTriangleWindingOrder = (transform.GetScale3D().X * transform.GetScale3D().Y * transform.GetScale3D().Z) < 0;
-        const int32 numFaces = mesh->mNumFaces;
-		if (bFlipTriangleWindingOrder)
-		{
-			for (int32 faceIndex = 0; faceIndex < numFaces; ++faceIndex)
-			{
-				aiFace& face = mesh->mFaces[faceIndex];
-				const int32 numIndices = face.mNumIndices;
-				check(numIndices == 3);
-				sectionInfoRef.triangles.Push(face.mIndices[0]);
-				sectionInfoRef.triangles.Push(face.mIndices[2]);
-				sectionInfoRef.triangles.Push(face.mIndices[1]);
-			}
-		}
-		else
-		{
-			for (int32 faceIndex = 0; faceIndex < numFaces; ++faceIndex)
-			{
-				aiFace& face = mesh->mFaces[faceIndex];
-				const int32 numIndices = face.mNumIndices;
-				check(numIndices == 3);
-				sectionInfoRef.triangles.Push(face.mIndices[0]);
-				sectionInfoRef.triangles.Push(face.mIndices[1]);
-				sectionInfoRef.triangles.Push(face.mIndices[2]);
-			}
-		}
+    // All streams in one pass over the vertices
+    const uint32 streams = FMeshConversionKernels::GetVertexStreams(*mesh) & vertexAttributes;
+    FMeshConversionKernels::FVertexOutputs outputs;
+    sectionInfoRef.vertices.SetNumUninitialized(numVertices);
+    outputs.positions = sectionInfoRef.vertices.GetData();
+    if (streams & FMeshConversionKernels::VertexStream_Normals)
+    {
+        sectionInfoRef.normals.SetNumUninitialized(numVertices);
+        outputs.normals = sectionInfoRef.normals.GetData();
+    }
+    else if (vertexAttributes & FMeshConversionKernels::VertexStream_Normals)
+    {
+        sectionInfoRef.normals.SetNumZeroed(numVertices);
+    }
+    if (streams & FMeshConversionKernels::VertexStream_UV0)
+    {
+        sectionInfoRef.uv0.SetNumUninitialized(numVertices);
+        outputs.uv0 = sectionInfoRef.uv0.GetData();
+    }
+    if (streams & FMeshConversionKernels::VertexStream_Tangents)
+    {
+        sectionInfoRef.tangents.SetNumUninitialized(numVertices);
+        outputs.tangents = sectionInfoRef.tangents.GetData();
+    }
+    if (streams & FMeshConversionKernels::VertexStream_Colors)
+    {
+        sectionInfoRef.vertexColors.SetNumUninitialized(numVertices);
+        outputs.colors = sectionInfoRef.vertexColors.GetData();
+    }
+    sectionInfoRef.bounds = FMeshConversionKernels::ConvertMeshVertices(*mesh, streams, positionMatrix, transform.ToMatrixNoScale(), outputs, bParallelVertices);
+
+    // Triangles
+    // When the mesh is inside out cause of the scale, flip the winding order of the triangles
+    const bool bFlipTriangleWindingOrder = (transform.GetScale3D().X * transform.GetScale3D().Y * transform.GetScale3D().Z) < 0;
+    const int32 numFaces = mesh->mNumFaces;
+    sectionInfoRef.triangles.SetNumUninitialized(numFaces * 3);
+    if (mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE)
+    {
+        FMeshConversionKernels::CopyTriangleFaces(mesh->mFaces, numFaces, sectionInfoRef.triangles.GetData(), bFlipTriangleWindingOrder, bParallelVertices);
+    }
+    else
+    {
+        // Only without aiProcess_SortByPType
+        const int32 numIndices = FMeshConversionKernels::CopyTriangleFacesChecked(mesh->mFaces, numFaces, sectionInfoRef.triangles.GetData(), bFlipTriangleWindingOrder);
+        if (!bLinesAndPoints)
+        {
+            RMIE_LOG(Warning, "Mesh %s contains faces that are no triangles. Skipped %d faces.", *FString(mesh->mName.C_Str()), numFaces - numIndices / 3);
+        }
+        sectionInfoRef.triangles.SetNum(numIndices, false);
     }
 }
 
+/**
+ * Iterates the nodes depth first. The composed transform of each node is built top down from
+ * the transform of its parent, so every node transform is only calculated once.
+ * Predicate signature: void(aiNode* node, const FTransform& composedNodeTransform)
+ */
 template<typename Predicate>
-void IterateSceneNodes(aiNode* node, Predicate predicate)
+void IterateSceneNodes(aiNode* node, const FTransform& parentTransform, Predicate predicate)
 {
-    predicate(node);
+    const FTransform composedNodeTransform = URuntimeMeshImportExportLibrary::AiTransformToFTransform(node->mTransformation) * parentTransform;
+    predicate(node, composedNodeTransform);
 
     for (uint32 m = 0; m < node->mNumChildren; ++m)
     {
-        IterateSceneNodes(node->mChildren[m], predicate);
+        IterateSceneNodes(node->mChildren[m], composedNodeTransform, predicate);
     }
 }
 
-void BuildComposedNodeTransform(aiNode* node, FTransform& transform)
+/**
+ * Flat list of all scene nodes in depth first order, parents are always stored before their children.
+ * Holds the composed transform of every node, so it can be reused by all steps of the import.
+ */
+struct FAssimpSceneNodeCache
 {
-	if (node->mParent)
-	{
-		BuildComposedNodeTransform(node->mParent, transform);
-	}
+    TArray<aiNode*> nodes;
+    TArray<int32> parentIndices;
+    TArray<FTransform> composedTransforms;
 
-	transform = FTransform(URuntimeMeshImportExportLibrary::AiTransformToFTransform(node->mTransformation)) * transform;
-}
+    void Build(aiNode* rootNode, const FTransform& sceneTransform)
+    {
+        nodes.Reset();
+        parentIndices.Reset();
+        composedTransforms.Reset();
+
+        // Only needed to find the indices of the parents
+        TMap<const aiNode*, int32> nodeToIndex;
+        IterateSceneNodes(rootNode, sceneTransform, [this, &nodeToIndex](aiNode* node, const FTransform& composedNodeTransform) {
+            const int32* parentIndex = node->mParent ? nodeToIndex.Find(node->mParent) : nullptr;
+            nodeToIndex.Add(node, nodes.Add(node));
+            parentIndices.Add(parentIndex ? *parentIndex : INDEX_NONE);
+            composedTransforms.Add(composedNodeTransform);
+        });
+    }
+
+    int32 Num() const
+    {
+        return nodes.Num();
+    }
+};
 
 /**
  * Assumes that path starts with '*'
@@ -247,21 +367,22 @@ bool ReadTextureFromSceneByMaterialParamPath(const aiScene* scene, FString path,
 }
 
 /**
+ * Returns the absolute path of an external texture, or an empty string when it can not be resolved.
  * @param importFile					Scene description file that is being imported
  * @param texturefileRelativePath		The path to the texture file relative to the imported file.
  */
-bool ImportTextureFromFile(const FString& importFile, const FString& relativeTexturePath, FRuntimeMeshImportExportMaterialParamTexture& texture)
+FString ResolveTextureFile(const FString& importFile, const FString& relativeTexturePath)
 {
     if (importFile.IsEmpty())
     {
         RMIE_LOG(Error, "Parameter importFile is empty!");
-        return false;
+        return FString();
     }
 
     if (relativeTexturePath.IsEmpty())
     {
         RMIE_LOG(Error, "Parameter relativeTexturePath is empty!");
-        return false;
+        return FString();
     }
 
     // SANITIZE
@@ -282,30 +403,120 @@ bool ImportTextureFromFile(const FString& importFile, const FString& relativeTex
     }
 
     FString absolutTextureFilePath = FPaths::Combine(FPaths::GetPath(importFile), relativeTexturePathSanitized);
-
     if (absolutTextureFilePath.IsEmpty())
     {
         RMIE_LOG(Error, "Combined file path is empty!");
+        return FString();
+    }
+
+    // Materials refer to the same file with different relative paths, collapse them so the file is only read once
+    FPaths::NormalizeFilename(absolutTextureFilePath);
+    FPaths::CollapseRelativeDirectories(absolutTextureFilePath);
+    return absolutTextureFilePath;
+}
+
+// An external texture of a material, it is read after all materials were extracted
+struct FPendingTextureRead
+{
+    // Index in FRuntimeMeshImportMaterialInfo::textures
+    int32 textureIndex;
+    FString file;
+};
+
+/**
+ * Adds the texture at 'textureIndex' to 'pendingReads', its file is 'path' relative to 'importFile'.
+ * Returns false when the path can not be resolved.
+ */
+bool AddPendingTextureRead(const FString& importFile, const FString& path, const int32 textureIndex, FRuntimeMeshImportMaterialInfo& materialInfo, TArray<FPendingTextureRead>& pendingReads)
+{
+    const FString textureFile = ResolveTextureFile(importFile, path);
+    if (textureFile.IsEmpty())
+    {
         return false;
     }
-    else
+
+    FRuntimeMeshImportExportMaterialParamTexture& texture = materialInfo.textures[textureIndex];
+    texture.byteDescription = FPaths::GetExtension(textureFile).ToLower();
+    // To stay in sync with Assimp, byteDescription should only be 3 characters long when it contains a file format!
+    if (texture.byteDescription.Equals(TEXT("jpeg"), ESearchCase::IgnoreCase))
+    {
+        texture.byteDescription = FString(TEXT("jpg"));
+    }
+    check(texture.byteDescription.Len() <= 3 && "Only file formats with 3 characters are allowed");
+    pendingReads.Add({ textureIndex, textureFile });
+    return true;
+}
+
+/**
+ * Reads 'files' through the async file IO of the platform, the requests of all files are in flight at the same time.
+ * The data of a file that can not be read is empty.
+ */
+void ReadFilesAsync(const TArray<FString>& files, TArray<TArray<uint8>>& outData)
+{
+    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const int32 numFiles = files.Num();
+    outData.Reset();
+    outData.SetNum(numFiles);
+
+    TArray<IAsyncReadFileHandle*> handles;
+    TArray<IAsyncReadRequest*> requests;
+    handles.SetNumZeroed(numFiles);
+    requests.SetNumZeroed(numFiles);
+
+    for (int32 fileIndex = 0; fileIndex < numFiles; ++fileIndex)
     {
-        texture.byteDescription = FPaths::GetExtension(absolutTextureFilePath).ToLower();
-        // To stay in sync with Assimp, byteDescription should only be 3 characters long when it contains a file format!
-        if (texture.byteDescription.Equals(TEXT("jpeg"), ESearchCase::IgnoreCase))
+        handles[fileIndex] = platformFile.OpenAsyncRead(*files[fileIndex]);
+        if (handles[fileIndex])
         {
-            texture.byteDescription = FString(TEXT("jpg"));
+            requests[fileIndex] = handles[fileIndex]->SizeRequest();
         }
-        check(texture.byteDescription.Len() <= 3 && "Only file formats with 3 characters are allowed");
-        FFileHelper::LoadFileToArray(texture.byteData, *absolutTextureFilePath);
-        texture.width = texture.byteData.Num();
-        return true;
     }
 
-    return false;
+    // The read requests write directly to the result arrays
+    for (int32 fileIndex = 0; fileIndex < numFiles; ++fileIndex)
+    {
+        if (!requests[fileIndex])
+        {
+            continue;
+        }
+        requests[fileIndex]->WaitCompletion();
+        const int64 fileSize = requests[fileIndex]->GetSizeResults();
+        delete requests[fileIndex];
+        requests[fileIndex] = nullptr;
+
+        if (fileSize <= 0 || fileSize > MAX_int32)
+        {
+            continue;
+        }
+        outData[fileIndex].SetNumUninitialized(fileSize);
+        requests[fileIndex] = handles[fileIndex]->ReadRequest(0, fileSize, AIOP_Normal, nullptr, outData[fileIndex].GetData());
+    }
+
+    for (int32 fileIndex = 0; fileIndex < numFiles; ++fileIndex)
+    {
+        if (requests[fileIndex])
+        {
+            requests[fileIndex]->WaitCompletion();
+            if (!requests[fileIndex]->GetReadResults())
+            {
+                outData[fileIndex].Empty();
+            }
+            // Requests have to be deleted before their handle
+            delete requests[fileIndex];
+        }
+        else
+        {
+            outData[fileIndex].Empty();
+        }
+        delete handles[fileIndex];
+    }
 }
 
-bool ImportTextureStackFromMaterial(const FString& importFile, const aiScene *const scene, const aiMaterial *const material, aiTextureType textureType, const FName stackName, FRuntimeMeshImportMaterialInfo& materialInfo)
+/**
+ * Embedded textures are read right away, external textures are added to 'pendingReads' without data.
+ */
+bool ImportTextureStackFromMaterial(const FString& importFile, const aiScene *const scene, const aiMaterial *const material, aiTextureType textureType, const FName stackName
+                                    , FRuntimeMeshImportMaterialInfo& materialInfo, TArray<FPendingTextureRead>& pendingReads)
 {
     uint32 textureStackSize = material->GetTextureCount(textureType);
     if (textureStackSize == 0)
@@ -336,7 +547,7 @@ bool ImportTextureStackFromMaterial(const FString& importFile, const aiScene *co
             }
             else
             {
-                bKillTexture |= !ImportTextureFromFile(importFile, path, materialInfo.textures[materialInfoTextureIndex]);
+                bKillTexture |= !AddPendingTextureRead(importFile, path, materialInfoTextureIndex, materialInfo, pendingReads);
             }
 
         }
@@ -357,144 +568,317 @@ bool ImportTextureStackFromMaterial(const FString& importFile, const aiScene *co
     return true;
 }
 
-void ImportSceneMaterials(const FString& importFile, const aiScene* scene, FRuntimeMeshImportResult& result, FRuntimeMeshImportExportProgressUpdate callbackProgress)
+/**
+ * Extracts the parameters and textures of one material. Does only write to 'materialInfo' and 'pendingReads',
+ * so it is save to call it for multiple materials in parallel.
+ */
+void ImportMaterial(const FString& importFile, const aiScene* scene, const aiMaterial* aiMaterial, FRuntimeMeshImportMaterialInfo& materialInfo, TArray<FPendingTextureRead>& pendingReads)
 {
-    if (!scene || !scene->HasMaterials())
+    materialInfo.name = FName(aiMaterial->GetName().C_Str());
+
+    // Params that are reused
+    int intParam;
+    float floatParam;
+    aiColor3D vectorParam;
+    auto IntParamToBool = [&intParam]() -> bool { return intParam != 0 ? true : false; };
+    auto VectorParamToLinearColor = [&vectorParam]() -> FLinearColor { return FLinearColor(vectorParam.r, vectorParam.g, vectorParam.b); };
+
+    if (aiMaterial->Get(AI_MATKEY_TWOSIDED, intParam) == AI_SUCCESS)
     {
-        return;
+        materialInfo.bTwoSided = IntParamToBool();
     }
 
-    for (uint32 sceneMaterialIndex = 0; sceneMaterialIndex < scene->mNumMaterials; ++sceneMaterialIndex)
+    if (aiMaterial->Get(AI_MATKEY_ENABLE_WIREFRAME, intParam) == AI_SUCCESS)
     {
-        aiMaterial* aiMaterial = scene->mMaterials[sceneMaterialIndex];
-        FRuntimeMeshImportMaterialInfo& materialInfo = result.materialInfos.Add_GetRef(FRuntimeMeshImportMaterialInfo());
+        materialInfo.bWireFrame = IntParamToBool();
+    }
 
-        materialInfo.name = FName(aiMaterial->GetName().C_Str());
+    if (aiMaterial->Get(AI_MATKEY_SHADING_MODEL, intParam) == AI_SUCCESS)
+    {
+        materialInfo.shadingMode = MaterialShadingModeFromInt(intParam);
+        materialInfo.shadingModeInt = intParam;
+    }
+    else
+    {
+        materialInfo.shadingMode = ERuntimeMeshImportExportMaterialShadingMode::Unknown;
+        materialInfo.shadingModeInt = -1;
+    }
 
-        // Params that are reused
-        int intParam;
-        float floatParam;
-        aiColor3D vectorParam;
-        auto IntParamToBool = [&intParam]() -> bool { return intParam != 0 ? true : false; };
-        auto VectorParamToLinearColor = [&vectorParam]() -> FLinearColor { return FLinearColor(vectorParam.r, vectorParam.g, vectorParam.b); };
+    if (aiMaterial->Get(AI_MATKEY_BLEND_FUNC, intParam) == AI_SUCCESS)
+    {
+        materialInfo.blendMode = MaterialBlendModeFromInt(intParam);
+        materialInfo.blendModeInt = intParam;
+    }
+    else
+    {
+        materialInfo.blendMode = ERuntimeMeshImportExportMaterialBlendMode::Unknown;
+        materialInfo.blendModeInt = -1;
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_TWOSIDED, intParam) == AI_SUCCESS)
-        {
-            materialInfo.bTwoSided = IntParamToBool();
-        }
+    if (aiMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, vectorParam) == AI_SUCCESS)
+    {
+        materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Diffuse"), VectorParamToLinearColor()));
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_ENABLE_WIREFRAME, intParam) == AI_SUCCESS)
-        {
-            materialInfo.bWireFrame = IntParamToBool();
-        }
+    //if (aiMaterial->Get(AI_MATKEY_COLOR_AMBIENT, vectorParam) == AI_SUCCESS) // Removed as it seems to be same as diffuse
+    //{
+    //    materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Ambient"), VectorParamToLinearColor()));
+    //}
 
-        if (aiMaterial->Get(AI_MATKEY_SHADING_MODEL, intParam) == AI_SUCCESS)
-        {
-            materialInfo.shadingMode = MaterialShadingModeFromInt(intParam);
-            materialInfo.shadingModeInt = intParam;
-        }
-        else
-        {
-            materialInfo.shadingMode = ERuntimeMeshImportExportMaterialShadingMode::Unknown;
-            materialInfo.shadingModeInt = -1;
-        }
+    if (aiMaterial->Get(AI_MATKEY_COLOR_SPECULAR, vectorParam) == AI_SUCCESS)
+    {
+        materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Specular"), VectorParamToLinearColor()));
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_BLEND_FUNC, intParam) == AI_SUCCESS)
-        {
-            materialInfo.blendMode = MaterialBlendModeFromInt(intParam);
-            materialInfo.blendModeInt = intParam;
-        }
-        else
-        {
-            materialInfo.blendMode = ERuntimeMeshImportExportMaterialBlendMode::Unknown;
-            materialInfo.blendModeInt = -1;
-        }
+    if (aiMaterial->Get(AI_MATKEY_COLOR_EMISSIVE, vectorParam) == AI_SUCCESS)
+    {
+        materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Emissive"), VectorParamToLinearColor()));
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, vectorParam) == AI_SUCCESS)
-        {
-            materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Diffuse"), VectorParamToLinearColor()));
-        }
+    if (aiMaterial->Get(AI_MATKEY_COLOR_TRANSPARENT, vectorParam) == AI_SUCCESS)
+    {
+        materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Transparent"), VectorParamToLinearColor()));
+    }
 
-        //if (aiMaterial->Get(AI_MATKEY_COLOR_AMBIENT, vectorParam) == AI_SUCCESS) // Removed as it seems to be same as diffuse
-        //{
-        //    materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Ambient"), VectorParamToLinearColor()));
-        //}
+    if (aiMaterial->Get(AI_MATKEY_COLOR_REFLECTIVE, vectorParam) == AI_SUCCESS)
+    {
+        materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Reflective"), VectorParamToLinearColor()));
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_COLOR_SPECULAR, vectorParam) == AI_SUCCESS)
-        {
-            materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Specular"), VectorParamToLinearColor()));
-        }
+    if (aiMaterial->Get(AI_MATKEY_OPACITY, floatParam) == AI_SUCCESS)
+    {
+        materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Opacity"), floatParam));
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_COLOR_EMISSIVE, vectorParam) == AI_SUCCESS)
-        {
-            materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Emissive"), VectorParamToLinearColor()));
-        }
+    if (aiMaterial->Get(AI_MATKEY_TRANSPARENCYFACTOR, floatParam) == AI_SUCCESS)
+    {
+        materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Transparency"), floatParam));
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_COLOR_TRANSPARENT, vectorParam) == AI_SUCCESS)
-        {
-            materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Transparent"), VectorParamToLinearColor()));
-        }
+    if (aiMaterial->Get(AI_MATKEY_BUMPSCALING, floatParam) == AI_SUCCESS)
+    {
+        materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("BumpScaling"), floatParam));
+    }
+
+    if (aiMaterial->Get(AI_MATKEY_SHININESS, floatParam) == AI_SUCCESS)
+    {
+        materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Shininess"), floatParam));
+    }
+
+    if (aiMaterial->Get(AI_MATKEY_SHININESS_STRENGTH, floatParam) == AI_SUCCESS)
+    {
+        materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("ShininessStrength"), floatParam));
+    }
+
+    if (aiMaterial->Get(AI_MATKEY_REFLECTIVITY, floatParam) == AI_SUCCESS)
+    {
+        materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Reflectivity"), floatParam));
+    }
+
+    if (aiMaterial->Get(AI_MATKEY_REFRACTI, floatParam) == AI_SUCCESS)
+    {
+        materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Refraction"), floatParam));
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_COLOR_REFLECTIVE, vectorParam) == AI_SUCCESS)
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_DIFFUSE, TEXT("TexDiffuse"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_SPECULAR, TEXT("TexSpecular"), materialInfo, pendingReads);
+    //ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_AMBIENT, TEXT("TexAmbient"), materialInfo, pendingReads); // Removed as it seems to be same as diffuse
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_EMISSIVE, TEXT("TexEmissive"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_HEIGHT, TEXT("TexHeight"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_NORMALS, TEXT("TexNormal"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_SHININESS, TEXT("TexShininess"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_OPACITY, TEXT("TexOpacity"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_DISPLACEMENT, TEXT("TexDisplacement"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_LIGHTMAP, TEXT("TexLightmap"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_REFLECTION, TEXT("TexReflection"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_BASE_COLOR, TEXT("TexBaseColor"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_NORMAL_CAMERA, TEXT("TexNormalCamera"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_EMISSION_COLOR, TEXT("TexEmissive"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_METALNESS, TEXT("TexMetallic"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_DIFFUSE_ROUGHNESS, TEXT("TexRoughness"), materialInfo, pendingReads);
+    ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_AMBIENT_OCCLUSION, TEXT("TexAmbientOcclusion"), materialInfo, pendingReads);
+}
+
+// The compression that fits the content of a texture stack. Data textures do not need the color channels of BC1 and BC3.
+ERuntimeMeshImportTextureCompression GetDefaultTextureStackCompression(const FName stackName)
+{
+    static const FName normalStacks[] = { TEXT("TexNormal"), TEXT("TexNormalCamera") };
+    static const FName singleChannelStacks[] = { TEXT("TexRoughness"), TEXT("TexMetallic"), TEXT("TexAmbientOcclusion"), TEXT("TexShininess")
+        , TEXT("TexHeight"), TEXT("TexDisplacement"), TEXT("TexOpacity") };
+
+    for (const FName& normalStack : normalStacks)
+    {
+        if (stackName == normalStack)
         {
-            materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Reflective"), VectorParamToLinearColor()));
+            return ERuntimeMeshImportTextureCompression::BC5;
         }
-
-        if (aiMaterial->Get(AI_MATKEY_OPACITY, floatParam) == AI_SUCCESS)
+    }
+    for (const FName& singleChannelStack : singleChannelStacks)
+    {
+        if (stackName == singleChannelStack)
         {
-            materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Opacity"), floatParam));
+            return ERuntimeMeshImportTextureCompression::BC4;
         }
+    }
+    return ERuntimeMeshImportTextureCompression::Auto;
+}
+
+void SetTextureCompression(const FRuntimeMeshImportParam& param, FRuntimeMeshImportMaterialInfo& materialInfo)
+{
+    if (!param.bCompressTextures)
+    {
+        return;
+    }
+
+    for (FRuntimeMeshImportExportMaterialParamTexture& texture : materialInfo.textures)
+    {
+        const ERuntimeMeshImportTextureCompression* compression = param.textureStackCompression.Find(texture.name);
+        texture.compression = compression ? *compression : GetDefaultTextureStackCompression(texture.name);
+    }
+}
 
-        if (aiMaterial->Get(AI_MATKEY_TRANSPARENCYFACTOR, floatParam) == AI_SUCCESS)
+/**
+ * Reads the external textures of the materials, 'pendingReads' holds the reads of each material in 'materialInfos'.
+ * Textures whose file can not be read are removed.
+ * @param param		'bUseTextureCache': Take unchanged texture files from the texture cache and add the files that are read to it.
+ * @param metrics	Gets the bytes of the files that are read added to 'bytesRead'
+ */
+void ReadPendingTextures(const FRuntimeMeshImportParam& param, const TArray<TArray<FPendingTextureRead>>& pendingReads, TArray<FRuntimeMeshImportMaterialInfo>& materialInfos
+    , FRuntimeMeshImportMetrics& metrics)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportTextures);
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_TextureImport);
+    const bool bUseTextureCache = param.bUseTextureCache;
+
+    // Each file is read once, no matter how many materials use it
+    TArray<FString> files;
+    TMap<FString, int32> fileToIndex;
+    TArray<int32> fileUses;
+    for (const TArray<FPendingTextureRead>& materialReads : pendingReads)
+    {
+        for (const FPendingTextureRead& pendingRead : materialReads)
         {
-            materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Transparency"), floatParam));
+            int32& fileIndex = fileToIndex.FindOrAdd(pendingRead.file, INDEX_NONE);
+            if (fileIndex == INDEX_NONE)
+            {
+                fileIndex = files.Add(pendingRead.file);
+                fileUses.Add(0);
+            }
+            ++fileUses[fileIndex];
         }
+    }
+
+    if (files.Num() == 0)
+    {
+        return;
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_BUMPSCALING, floatParam) == AI_SUCCESS)
+    if (param.bDeferTextureReads)
+    {
+        // Only the identity of each file is taken, it is read when its texture is converted
+        TArray<uint64> fileIdentities;
+        for (const FString& file : files)
         {
-            materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("BumpScaling"), floatParam));
+            fileIdentities.Add(FRuntimeMeshImportExportTextureCache::HashFileIdentity(file));
         }
-
-        if (aiMaterial->Get(AI_MATKEY_SHININESS, floatParam) == AI_SUCCESS)
+        for (int32 materialIndex = 0; materialIndex < materialInfos.Num(); ++materialIndex)
         {
-            materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Shininess"), floatParam));
+            FRuntimeMeshImportMaterialInfo& materialInfo = materialInfos[materialIndex];
+            const TArray<FPendingTextureRead>& materialReads = pendingReads[materialIndex];
+            for (int32 readIndex = materialReads.Num() - 1; readIndex >= 0; --readIndex)
+            {
+                const FPendingTextureRead& pendingRead = materialReads[readIndex];
+                const uint64 fileIdentity = fileIdentities[fileToIndex.FindChecked(pendingRead.file)];
+                FRuntimeMeshImportExportMaterialParamTexture& texture = materialInfo.textures[pendingRead.textureIndex];
+                if (fileIdentity == 0)
+                {
+                    RMIE_LOG(Error, "Texture %s for Material %s does not exist. File: %s", *texture.name.ToString(), *materialInfo.name.ToString(), *pendingRead.file);
+                    materialInfo.textures.RemoveAt(pendingRead.textureIndex);
+                    continue;
+                }
+                texture.sourceFile = pendingRead.file;
+            }
         }
+        return;
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_SHININESS_STRENGTH, floatParam) == AI_SUCCESS)
+    TArray<TArray<uint8>> fileData;
+    fileData.SetNum(files.Num());
+    TArray<FString> filesToRead;
+    TArray<int32> filesToReadIndices;
+    for (int32 fileIndex = 0; fileIndex < files.Num(); ++fileIndex)
+    {
+        if (!bUseTextureCache || !FRuntimeMeshImportExportTextureCache::Get().FindFile_AnyThread(files[fileIndex], fileData[fileIndex]))
         {
-            materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("ShininessStrength"), floatParam));
+            filesToRead.Add(files[fileIndex]);
+            filesToReadIndices.Add(fileIndex);
         }
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_REFLECTIVITY, floatParam) == AI_SUCCESS)
+    TArray<TArray<uint8>> readData;
+    ReadFilesAsync(filesToRead, readData);
+    for (int32 readIndex = 0; readIndex < filesToRead.Num(); ++readIndex)
+    {
+        INC_DWORD_STAT_BY(STAT_RMIE_ImportedTextureBytes, readData[readIndex].Num());
+        metrics.bytesRead += readData[readIndex].Num();
+        if (bUseTextureCache && readData[readIndex].Num() > 0)
         {
-            materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Reflectivity"), floatParam));
+            FRuntimeMeshImportExportTextureCache::Get().AddFile_AnyThread(filesToRead[readIndex], readData[readIndex]);
         }
+        fileData[filesToReadIndices[readIndex]] = MoveTemp(readData[readIndex]);
+    }
 
-        if (aiMaterial->Get(AI_MATKEY_REFRACTI, floatParam) == AI_SUCCESS)
+    for (int32 materialIndex = 0; materialIndex < materialInfos.Num(); ++materialIndex)
+    {
+        FRuntimeMeshImportMaterialInfo& materialInfo = materialInfos[materialIndex];
+        const TArray<FPendingTextureRead>& materialReads = pendingReads[materialIndex];
+        // Backwards, so removing a texture does not shift the indices of the reads before it
+        for (int32 readIndex = materialReads.Num() - 1; readIndex >= 0; --readIndex)
         {
-            materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Refraction"), floatParam));
-        }
+            const FPendingTextureRead& pendingRead = materialReads[readIndex];
+            const int32 fileIndex = fileToIndex.FindChecked(pendingRead.file);
+            FRuntimeMeshImportExportMaterialParamTexture& texture = materialInfo.textures[pendingRead.textureIndex];
+            if (fileData[fileIndex].Num() == 0)
+            {
+                RMIE_LOG(Error, "Failed to read Texture %s for Material %s. File: %s", *texture.name.ToString(), *materialInfo.name.ToString(), *pendingRead.file);
+                materialInfo.textures.RemoveAt(pendingRead.textureIndex);
+                continue;
+            }
 
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_DIFFUSE, TEXT("TexDiffuse"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_SPECULAR, TEXT("TexSpecular"), materialInfo);
-        //ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_AMBIENT, TEXT("TexAmbient"), materialInfo); // Removed as it seems to be same as diffuse
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_EMISSIVE, TEXT("TexEmissive"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_HEIGHT, TEXT("TexHeight"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_NORMALS, TEXT("TexNormal"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_SHININESS, TEXT("TexShininess"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_OPACITY, TEXT("TexOpacity"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_DISPLACEMENT, TEXT("TexDisplacement"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_LIGHTMAP, TEXT("TexLightmap"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_REFLECTION, TEXT("TexReflection"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_BASE_COLOR, TEXT("TexBaseColor"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_NORMAL_CAMERA, TEXT("TexNormalCamera"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_EMISSION_COLOR, TEXT("TexEmissive"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_METALNESS, TEXT("TexMetallic"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_DIFFUSE_ROUGHNESS, TEXT("TexRoughness"), materialInfo);
-        ImportTextureStackFromMaterial(importFile, scene, aiMaterial, aiTextureType_AMBIENT_OCCLUSION, TEXT("TexAmbientOcclusion"), materialInfo);
+            // The last material that uses the file gets the data, the others a copy
+            texture.byteData = --fileUses[fileIndex] == 0 ? MoveTemp(fileData[fileIndex]) : fileData[fileIndex];
+            texture.width = texture.byteData.Num();
+        }
+    }
+}
 
-        URuntimeMeshImportExportLibrary::SendProgress_AnyThread(callbackProgress, FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ImportingMaterials, sceneMaterialIndex+1, scene->mNumMaterials));
+/**
+ * @param param		'bUseTextureCache': Take unchanged texture files from the texture cache and add the files that are read to it.
+ *					'bCompressTextures': Set the compression of the textures.
+ */
+void ImportSceneMaterials(const FString& importFile, const aiScene* scene, const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& result, const FRuntimeMeshImportExportProgressCoalescerRef& progress)
+{
+    if (!scene || !scene->HasMaterials())
+    {
+        return;
     }
+
+    // Extract the materials in parallel, external textures are only collected
+    const int32 numMaterials = scene->mNumMaterials;
+    result.materialInfos.SetNum(numMaterials);
+    TArray<TArray<FPendingTextureRead>> pendingReads;
+    pendingReads.SetNum(numMaterials);
+    FThreadSafeCounter materialCounter;
+    ParallelFor(numMaterials, [&importFile, scene, &param, &result, &pendingReads, &materialCounter, numMaterials, &progress](int32 sceneMaterialIndex)
+    {
+        ImportMaterial(importFile, scene, scene->mMaterials[sceneMaterialIndex], result.materialInfos[sceneMaterialIndex], pendingReads[sceneMaterialIndex]);
+        SetTextureCompression(param, result.materialInfos[sceneMaterialIndex]);
+        progress->Send_AnyThread(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ImportingMaterials, materialCounter.Increment(), numMaterials));
+    });
+
+    const double startTimeTextures = FPlatformTime::Seconds();
+    ReadPendingTextures(param, pendingReads, result.materialInfos, result.metrics);
+    result.timings.textureSeconds = float(FPlatformTime::Seconds() - startTimeTextures);
 }
 
 void MergeMeshes(TArray<FRuntimeMeshImportMeshInfo>& meshInfos)
@@ -509,69 +893,322 @@ void MergeMeshes(TArray<FRuntimeMeshImportMeshInfo>& meshInfos)
     for (int32 meshIndex = 1; meshIndex < meshInfos.Num(); ++meshIndex)
     {
         meshInfos[0].sections.Append(MoveTemp(meshInfos[meshIndex].sections));
+        meshInfos[0].bounds += meshInfos[meshIndex].bounds;
     }
 
     // Get rid of merged meshes
     meshInfos.SetNum(1);
 }
 
-void MergeAllSections(TArray<FRuntimeMeshImportSectionInfo>& sectionInfos)
+// Copies a vertex stream of a section to the merged stream. Zero fills when the section does not have the stream.
+template<typename T>
+void CopyVertexStream(const TArray<T>& source, T* dest, const int32 numVertices)
 {
-    if (sectionInfos.Num() < 2) return;
-
-    // Merge
-    for (int32 sectionIndex = 1; sectionIndex < sectionInfos.Num(); ++sectionIndex)
+    if (source.Num() == numVertices)
     {
-        sectionInfos[0].Append_Move(MoveTemp(sectionInfos[sectionIndex]));
+        FMemory::Memcpy(dest, source.GetData(), numVertices * sizeof(T));
     }
-
-    // Get rid of merged sections
-    sectionInfos.SetNum(1);
+    else
+    {
+        FMemory::Memzero(dest, numVertices * sizeof(T));
+    }
+}
+
+/**
+ * Merges 'sections' in their order with a single allocation and one copy per stream. The merged sections are emptied.
+ * A stream that only some of the sections have is zero filled for the others, so all streams stay aligned with the vertices.
+ */
+FRuntimeMeshImportSectionInfo MergeSections(TArrayView<FRuntimeMeshImportSectionInfo* const> sections)
+{
+    check(sections.Num() > 0);
+
+    FRuntimeMeshImportSectionInfo merged;
+    merged.materialName = sections[0]->materialName;
+    merged.materialIndex = sections[0]->materialIndex;
+
+    int32 numVertices = 0;
+    int32 numIndices = 0;
+    bool bHasNormals = false;
+    bool bHasTangents = false;
+    bool bHasUv0 = false;
+    bool bHasUv1 = false;
+    bool bHasVertexColors = false;
+    int32 numBoneInfluences = 0;
+    for (const FRuntimeMeshImportSectionInfo* section : sections)
+    {
+        numBoneInfluences = FMath::Max(numBoneInfluences, section->numBoneInfluences);
+        numVertices += section->vertices.Num();
+        numIndices += section->triangles.Num();
+        bHasNormals |= section->normals.Num() > 0;
+        bHasTangents |= section->tangents.Num() > 0;
+        bHasUv0 |= section->uv0.Num() > 0;
+        bHasUv1 |= section->uv1.Num() > 0;
+        bHasVertexColors |= section->vertexColors.Num() > 0;
+
+        merged.bounds += section->bounds;
+
+        // Retain the material data if it is the same
+        merged.materialName = merged.materialName == section->materialName ? merged.materialName : FName();
+        merged.materialIndex = merged.materialIndex == section->materialIndex ? merged.materialIndex : INDEX_NONE;
+    }
+
+    merged.vertices.SetNumUninitialized(numVertices);
+    merged.triangles.SetNumUninitialized(numIndices);
+    merged.normals.SetNumUninitialized(bHasNormals ? numVertices : 0);
+    merged.tangents.SetNumUninitialized(bHasTangents ? numVertices : 0);
+    merged.uv0.SetNumUninitialized(bHasUv0 ? numVertices : 0);
+    merged.uv1.SetNumUninitialized(bHasUv1 ? numVertices : 0);
+    merged.vertexColors.SetNumUninitialized(bHasVertexColors ? numVertices : 0);
+    // Sections with fewer influences are padded with zero weights
+    merged.numBoneInfluences = numBoneInfluences;
+    merged.boneIndices.SetNumZeroed(numVertices * numBoneInfluences);
+    merged.boneWeights.SetNumZeroed(numVertices * numBoneInfluences);
+
+    int32 vertexOffset = 0;
+    int32 indexOffset = 0;
+    for (FRuntimeMeshImportSectionInfo* section : sections)
+    {
+        const int32 numSectionVertices = section->vertices.Num();
+        FMemory::Memcpy(merged.vertices.GetData() + vertexOffset, section->vertices.GetData(), numSectionVertices * sizeof(FVector));
+        FMeshConversionKernels::OffsetIndices(section->triangles.GetData(), merged.triangles.GetData() + indexOffset, section->triangles.Num(), vertexOffset);
+        if (bHasNormals)
+        {
+            CopyVertexStream(section->normals, merged.normals.GetData() + vertexOffset, numSectionVertices);
+        }
+        if (bHasTangents)
+        {
+            CopyVertexStream(section->tangents, merged.tangents.GetData() + vertexOffset, numSectionVertices);
+        }
+        if (bHasUv0)
+        {
+            CopyVertexStream(section->uv0, merged.uv0.GetData() + vertexOffset, numSectionVertices);
+        }
+        if (bHasUv1)
+        {
+            CopyVertexStream(section->uv1, merged.uv1.GetData() + vertexOffset, numSectionVertices);
+        }
+        if (bHasVertexColors)
+        {
+            CopyVertexStream(section->vertexColors, merged.vertexColors.GetData() + vertexOffset, numSectionVertices);
+        }
+        if (section->numBoneInfluences == numBoneInfluences && numBoneInfluences > 0)
+        {
+            FMemory::Memcpy(merged.boneIndices.GetData() + vertexOffset * numBoneInfluences, section->boneIndices.GetData(), section->boneIndices.Num() * sizeof(uint16));
+            FMemory::Memcpy(merged.boneWeights.GetData() + vertexOffset * numBoneInfluences, section->boneWeights.GetData(), section->boneWeights.Num());
+        }
+        else if (section->numBoneInfluences > 0)
+        {
+            for (int32 vertex = 0; vertex < numSectionVertices; ++vertex)
+            {
+                const int32 source = vertex * section->numBoneInfluences;
+                const int32 dest = (vertexOffset + vertex) * numBoneInfluences;
+                FMemory::Memcpy(merged.boneIndices.GetData() + dest, section->boneIndices.GetData() + source, section->numBoneInfluences * sizeof(uint16));
+                FMemory::Memcpy(merged.boneWeights.GetData() + dest, section->boneWeights.GetData() + source, section->numBoneInfluences);
+            }
+        }
+        FRuntimeMeshImportMorphTarget::Append(merged.morphTargets, MoveTemp(section->morphTargets), vertexOffset);
+        merged.linesAndPoints.Append(MoveTemp(section->linesAndPoints));
+
+        vertexOffset += numSectionVertices;
+        indexOffset += section->triangles.Num();
+
+        // Free the section right away, so the merge does not hold everything twice
+        *section = FRuntimeMeshImportSectionInfo();
+    }
+
+    return merged;
 }
 
+void MergeAllSections(TArray<FRuntimeMeshImportSectionInfo>& sectionInfos)
+{
+    if (sectionInfos.Num() < 2) return;
+
+    TArray<FRuntimeMeshImportSectionInfo*> sections;
+    sections.Reserve(sectionInfos.Num());
+    for (FRuntimeMeshImportSectionInfo& section : sectionInfos)
+    {
+        sections.Add(&section);
+    }
+
+    FRuntimeMeshImportSectionInfo merged = MergeSections(sections);
+    sectionInfos.Empty(1);
+    sectionInfos.Add(MoveTemp(merged));
+}
+
+/**
+ * The merged sections are ordered by the first appearance of their material,
+ * the sections of a material are merged in their order.
+ */
 void MergeSectionsSameMaterial(TArray<FRuntimeMeshImportSectionInfo>& sectionInfos)
 {
-    TMap<FName, FRuntimeMeshImportSectionInfo> map_MatName_Mesh;
-    for (int32 i = sectionInfos.Num() - 1; i>=0; --i)
+    if (sectionInfos.Num() < 2) return;
+
+    // Group the sections by material without moving them
+    TArray<TArray<FRuntimeMeshImportSectionInfo*, TInlineAllocator<4>>> groups;
+    TMap<FName, int32> materialToGroup;
+    for (FRuntimeMeshImportSectionInfo& section : sectionInfos)
+    {
+        const int32* groupIndex = materialToGroup.Find(section.materialName);
+        if (!groupIndex)
+        {
+            groupIndex = &materialToGroup.Add(section.materialName, groups.AddDefaulted());
+        }
+        groups[*groupIndex].Add(&section);
+    }
+
+    if (groups.Num() == sectionInfos.Num())
+    {
+        // Every material is used once, nothing to merge
+        return;
+    }
+
+    TArray<FRuntimeMeshImportSectionInfo> mergedSections;
+    mergedSections.Reserve(groups.Num());
+    for (const TArray<FRuntimeMeshImportSectionInfo*, TInlineAllocator<4>>& group : groups)
     {
-        FRuntimeMeshImportSectionInfo& meshInfoRef = map_MatName_Mesh.FindOrAdd(sectionInfos[i].materialName);
-        if (meshInfoRef.vertices.Num() == 0)
+        if (group.Num() == 1)
         {
-            // Key was just added
-            meshInfoRef = MoveTemp(sectionInfos[i]);
+            mergedSections.Add(MoveTemp(*group[0]));
         }
         else
         {
-            // Already existing data on that key
-            meshInfoRef.Append_Move(MoveTemp(sectionInfos[i]));
+            mergedSections.Add(MergeSections(group));
+        }
+    }
+    sectionInfos = MoveTemp(mergedSections);
+}
+
+int32 CountClusterTriangles(TArrayView<FRuntimeMeshImportSectionInfo* const> sections)
+{
+    int32 numTriangles = 0;
+    for (const FRuntimeMeshImportSectionInfo* section : sections)
+    {
+        numTriangles += section->triangles.Num() / 3;
+    }
+    return numTriangles;
+}
+
+/**
+ * Splits 'sections' at the triangle median of their centers along the longest axis of the centers,
+ * until a cluster has no more than 'targetTriangles' or a single section.
+ */
+void SplitCluster(TArrayView<FRuntimeMeshImportSectionInfo*> sections, const int32 targetTriangles, TArray<TArray<FRuntimeMeshImportSectionInfo*>>& clusters)
+{
+    const int32 numTriangles = CountClusterTriangles(sections);
+    if (sections.Num() == 1 || numTriangles <= targetTriangles)
+    {
+        clusters.Emplace(sections.GetData(), sections.Num());
+        return;
+    }
+
+    FBox centerBounds(ForceInit);
+    for (const FRuntimeMeshImportSectionInfo* section : sections)
+    {
+        centerBounds += section->bounds.GetCenter();
+    }
+    const FVector size = centerBounds.GetSize();
+    const int32 axis = size.X >= size.Y && size.X >= size.Z ? 0 : (size.Y >= size.Z ? 1 : 2);
+    Algo::Sort(sections, [axis](const FRuntimeMeshImportSectionInfo* a, const FRuntimeMeshImportSectionInfo* b) {
+        return a->bounds.GetCenter()[axis] < b->bounds.GetCenter()[axis];
+    });
+
+    // Both halves get about the same number of triangles and at least one section
+    int32 splitIndex = 1;
+    int32 numLowerTriangles = sections[0]->triangles.Num() / 3;
+    while (splitIndex < sections.Num() - 1 && numLowerTriangles * 2 < numTriangles)
+    {
+        numLowerTriangles += sections[splitIndex]->triangles.Num() / 3;
+        ++splitIndex;
+    }
+    SplitCluster(sections.Slice(0, splitIndex), targetTriangles, clusters);
+    SplitCluster(sections.Slice(splitIndex, sections.Num() - splitIndex), targetTriangles, clusters);
+}
+
+/**
+ * Replaces the meshes with one mesh per cluster of sections. The sections are grouped by material,
+ * the sections of a material are split into spatial clusters of about 'targetTriangles' each.
+ * So the clusters reduce the draw calls and still can be culled. The materials are clustered in parallel.
+ */
+void MergeMeshesByCluster(const int32 targetTriangles, TArray<FRuntimeMeshImportMeshInfo>& meshInfos)
+{
+    // Group the sections by material without moving them
+    TArray<TArray<FRuntimeMeshImportSectionInfo*>> groups;
+    TMap<FName, int32> materialToGroup;
+    for (FRuntimeMeshImportMeshInfo& meshInfo : meshInfos)
+    {
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            if (section.triangles.Num() == 0 && section.linesAndPoints.IsEmpty())
+            {
+                continue;
+            }
+            const int32* groupIndex = materialToGroup.Find(section.materialName);
+            if (!groupIndex)
+            {
+                groupIndex = &materialToGroup.Add(section.materialName, groups.AddDefaulted());
+            }
+            groups[*groupIndex].Add(&section);
         }
     }
 
-    // Copy over the combined meshes from the map into the result
-    sectionInfos.Empty();
-    map_MatName_Mesh.GenerateValueArray(sectionInfos);
+    TArray<TArray<FRuntimeMeshImportSectionInfo>> groupClusters;
+    groupClusters.SetNum(groups.Num());
+    ParallelFor(groups.Num(), [&groups, &groupClusters, targetTriangles](int32 groupIndex)
+    {
+        TArray<TArray<FRuntimeMeshImportSectionInfo*>> clusters;
+        SplitCluster(groups[groupIndex], FMath::Max(targetTriangles, 1), clusters);
+        groupClusters[groupIndex].Reserve(clusters.Num());
+        for (const TArray<FRuntimeMeshImportSectionInfo*>& cluster : clusters)
+        {
+            groupClusters[groupIndex].Add(cluster.Num() == 1 ? MoveTemp(*cluster[0]) : MergeSections(cluster));
+        }
+    });
+
+    meshInfos.Empty();
+    for (TArray<FRuntimeMeshImportSectionInfo>& clusters : groupClusters)
+    {
+        for (FRuntimeMeshImportSectionInfo& cluster : clusters)
+        {
+            FRuntimeMeshImportMeshInfo& meshInfo = meshInfos.AddDefaulted_GetRef();
+            // Numbered in the order of the materials
+            meshInfo.meshName = FName(TEXT("Cluster"), meshInfos.Num());
+            meshInfo.bounds = cluster.bounds;
+            meshInfo.sections.Add(MoveTemp(cluster));
+        }
+    }
 }
 
 void URuntimeMeshImportExportLibrary::ImportScene(const FString file, const FTransform& transform, FRuntimeMeshImportResult& result
         , const EPathType pathType, const EImportMethodMesh importMethodMesh, const EImportMethodSection importMethodSection, const bool bNormalizeScene)
+{
+    FRuntimeMeshImportParam param;
+    param.file = file;
+    param.transform = transform;
+    param.pathType = pathType;
+    param.importMethodMesh = importMethodMesh;
+    param.importMethodSection = importMethodSection;
+    param.bNormalizeScene = bNormalizeScene;
+    ImportSceneWithParam(param, result);
+}
+
+void URuntimeMeshImportExportLibrary::ImportSceneWithParam(const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& result)
 {
     FRuntimeMeshImportExportProgressUpdate progDelegate;
-    ImportScene_AnyThread(file, transform, progDelegate, result, pathType, importMethodMesh, importMethodSection, bNormalizeScene);
+    ImportScene_AnyThread(param, progDelegate, result);
 }
 
-FLoadMeshAsyncAction::FLoadMeshAsyncAction(const FLatentActionInfo& latentInfo, const FString inFile, const FTransform& transform
+FLoadMeshAsyncAction::FLoadMeshAsyncAction(const FLatentActionInfo& latentInfo, const FRuntimeMeshImportParam& param
         , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
-        , FRuntimeMeshImportResult& result, const EPathType pathType, const EImportMethodMesh importMethodMesh
-        , const EImportMethodSection importMethodSection, const bool bNormalizeMesh)
+        , FRuntimeMeshImportResult& result)
     : executionFunction(latentInfo.ExecutionFunction)
     , outputLink(latentInfo.Linkage)
     , callbackTarget(latentInfo.CallbackTarget)
-    , file(inFile)
+    , file(param.file)
     , resultRef(result)
 {
     FRuntimeImportFinished callbackFinishedRaw;
-    callbackFinishedRaw.BindLambda([this](FRuntimeMeshImportResult result) ->void {
-        resultRef = MoveTemp(result);
+    callbackFinishedRaw.BindLambda([this](FRuntimeMeshImportResultRef result) ->void {
+        resultRef = MoveTemp(*result);
         bTaskDone = true;
     });
 
@@ -580,8 +1217,7 @@ FLoadMeshAsyncAction::FLoadMeshAsyncAction(const FLatentActionInfo& latentInfo,
         progressDelegate.ExecuteIfBound(progress);
     });
 
-    URuntimeMeshImportExportLibrary::ImportScene_Async_Cpp(inFile, transform, callbackFinishedRaw, callbackProgressRaw, pathType, importMethodMesh
-            , importMethodSection, bNormalizeMesh);
+    URuntimeMeshImportExportLibrary::ImportSceneWithParam_Async_Cpp(param, callbackFinishedRaw, callbackProgressRaw);
 }
 
 void URuntimeMeshImportExportLibrary::ImportScene_Async(UObject* worldContextObject, FLatentActionInfo latentInfo
@@ -593,6 +1229,21 @@ void URuntimeMeshImportExportLibrary::ImportScene_Async(UObject* worldContextObj
         , const EImportMethodMesh importMethodMesh
         , const EImportMethodSection importMethodSection
         , const bool bNormalizeScene)
+{
+    FRuntimeMeshImportParam param;
+    param.file = file;
+    param.transform = transform;
+    param.pathType = pathType;
+    param.importMethodMesh = importMethodMesh;
+    param.importMethodSection = importMethodSection;
+    param.bNormalizeScene = bNormalizeScene;
+    ImportSceneWithParam_Async(worldContextObject, latentInfo, param, progressDelegate, result);
+}
+
+void URuntimeMeshImportExportLibrary::ImportSceneWithParam_Async(UObject* worldContextObject, FLatentActionInfo latentInfo
+        , const FRuntimeMeshImportParam& param
+        , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
+        , FRuntimeMeshImportResult& result)
 {
     if (UWorld* world = GEngine->GetWorldFromContextObject(worldContextObject, EGetWorldErrorMode::LogAndReturnNull))
     {
@@ -600,69 +1251,142 @@ void URuntimeMeshImportExportLibrary::ImportScene_Async(UObject* worldContextObj
         if (latentActionManager.FindExistingAction<FLoadMeshAsyncAction>(latentInfo.CallbackTarget, latentInfo.UUID) == NULL)
         {
             latentActionManager.AddNewAction(latentInfo.CallbackTarget, latentInfo.UUID
-                                             , new FLoadMeshAsyncAction(latentInfo, file, transform, progressDelegate, result, pathType, importMethodMesh, importMethodSection, bNormalizeScene));
+                                             , new FLoadMeshAsyncAction(latentInfo, param, progressDelegate, result));
         }
     }
 }
 
 void URuntimeMeshImportExportLibrary::ImportScene_Async_Cpp(const FString file, const FTransform& transform, FRuntimeImportFinished callbackFinished
         , FRuntimeMeshImportExportProgressUpdate callbackProgress, const EPathType pathType, const EImportMethodMesh importMethodMesh
-        , const EImportMethodSection importMethodSection, bool bNormalizeMesh)
+        , const EImportMethodSection importMethodSection, bool bNormalizeMesh, const FRuntimeMeshImportExportCancellationToken& cancellationToken)
+{
+    FRuntimeMeshImportParam param;
+    param.file = file;
+    param.transform = transform;
+    param.pathType = pathType;
+    param.importMethodMesh = importMethodMesh;
+    param.importMethodSection = importMethodSection;
+    param.bNormalizeScene = bNormalizeMesh;
+    param.cancellationToken = cancellationToken;
+    ImportSceneWithParam_Async_Cpp(param, callbackFinished, callbackProgress);
+}
+
+void URuntimeMeshImportExportLibrary::ImportSceneWithParam_Async_Cpp(const FRuntimeMeshImportParam& param, FRuntimeImportFinished callbackFinished
+        , FRuntimeMeshImportExportProgressUpdate callbackProgress)
 {
-    AsyncTask(ENamedThreads::AnyThread, [=]()-> void
+    if (param.bAtlasMaterials && IsInGameThread())
+    {
+        // The atlases decode the textures on the worker
+        FRuntimeMeshTextureBuilder::LoadModules_GameThread();
+    }
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([=]()-> void
     {
-        FRuntimeMeshImportResult* result = new FRuntimeMeshImportResult();
-        URuntimeMeshImportExportLibrary::ImportScene_AnyThread(file, transform, callbackProgress, *result, pathType, importMethodMesh, importMethodSection, bNormalizeMesh);
+        FRuntimeMeshImportResultRef result = FRuntimeMeshDeferredRelease::MakeImportResult();
+        URuntimeMeshImportExportLibrary::ImportScene_AnyThread(param, callbackProgress, *result);
         AsyncTask(ENamedThreads::GameThread, [=]() -> void
         {
-            callbackFinished.ExecuteIfBound(MoveTemp(*result));
-            check(result->meshInfos.Num() == 0);
-            delete result;
+            callbackFinished.ExecuteIfBound(result);
         });
     });
 }
 
-bool URuntimeMeshImportExportLibrary::GetIsExtensionSupportedImport(FString extension)
+void URuntimeMeshImportExportLibrary::ImportSceneWithParam_Streaming_Async_Cpp(const FRuntimeMeshImportParam& param, FRuntimeImportMeshReady callbackMeshReady
+        , FRuntimeImportFinished callbackFinished, FRuntimeMeshImportExportProgressUpdate callbackProgress)
+{
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([=]()-> void
+    {
+        FRuntimeMeshImportResultRef result = FRuntimeMeshDeferredRelease::MakeImportResult();
+        URuntimeMeshImportExportLibrary::ImportScene_AnyThread(param, callbackProgress, *result, callbackMeshReady);
+        // Queued after the tasks of the meshes, so it is called after the last mesh
+        AsyncTask(ENamedThreads::GameThread, [=]() -> void
+        {
+            callbackFinished.ExecuteIfBound(result);
+        });
+    });
+}
+
+TFuture<FRuntimeMeshImportResultPtr> URuntimeMeshImportExportLibrary::ImportSceneWithParam_Future(const FRuntimeMeshImportParam& param
+        , FRuntimeMeshImportExportProgressUpdate callbackProgress)
 {
-    if(!extension.StartsWith(TEXT(".")))
+    if (param.bAtlasMaterials && IsInGameThread())
     {
-        extension = FString(TEXT(".")).Append(extension);
+        // The atlases decode the textures on the worker
+        FRuntimeMeshTextureBuilder::LoadModules_GameThread();
     }
-    Assimp::Importer importer;
-    return importer.IsExtensionSupported(TCHAR_TO_ANSI(*extension));
+    TPromise<FRuntimeMeshImportResultPtr> promise;
+    TFuture<FRuntimeMeshImportResultPtr> future = promise.GetFuture();
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([param, callbackProgress, promise = MoveTemp(promise)]() mutable -> void
+    {
+        FRuntimeMeshImportResultRef result = FRuntimeMeshDeferredRelease::MakeImportResult();
+        URuntimeMeshImportExportLibrary::ImportScene_AnyThread(param, callbackProgress, *result);
+        // Runs the continuations on this worker
+        promise.SetValue(result);
+    });
+    return future;
+}
+
+void URuntimeMeshImportExportLibrary::ImportSceneFromMemory(const TArray<uint8>& buffer, const FString& formatHint, const FRuntimeMeshImportParam& param
+        , const TArray<FRuntimeMeshImportMemoryFile>& siblingFiles, FRuntimeMeshImportResult& result)
+{
+    ImportSceneFromMemory_Cpp(buffer, formatHint, param, siblingFiles, result);
+}
+
+void URuntimeMeshImportExportLibrary::ImportSceneFromMemory_Cpp(TArrayView<const uint8> buffer, const FString& formatHint, const FRuntimeMeshImportParam& param
+        , TArrayView<const FRuntimeMeshImportMemoryFile> siblingFiles, FRuntimeMeshImportResult& result)
+{
+    FRuntimeMeshImportExportProgressUpdate progDelegate;
+    ImportSceneFromMemory_AnyThread(buffer, formatHint, param, siblingFiles, progDelegate, result);
+}
+
+void URuntimeMeshImportExportLibrary::ImportSceneFromMemory_Async_Cpp(TArray<uint8> buffer, const FString& formatHint, const FRuntimeMeshImportParam& param
+        , TArray<FRuntimeMeshImportMemoryFile> siblingFiles
+        , FRuntimeImportFinished callbackFinished
+        , FRuntimeMeshImportExportProgressUpdate callbackProgress)
+{
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([buffer = MoveTemp(buffer), formatHint, param, siblingFiles = MoveTemp(siblingFiles), callbackFinished, callbackProgress]()-> void
+    {
+        FRuntimeMeshImportResultRef result = FRuntimeMeshDeferredRelease::MakeImportResult();
+        URuntimeMeshImportExportLibrary::ImportSceneFromMemory_AnyThread(buffer, formatHint, param, siblingFiles, callbackProgress, *result);
+        AsyncTask(ENamedThreads::GameThread, [=]() -> void
+        {
+            callbackFinished.ExecuteIfBound(result);
+        });
+    });
+}
+
+FRuntimeMeshImportExportCancellationToken URuntimeMeshImportExportLibrary::MakeCancellationToken()
+{
+    return FRuntimeMeshImportExportCancellationToken::Create();
+}
+
+void URuntimeMeshImportExportLibrary::CancelToken(const FRuntimeMeshImportExportCancellationToken& token)
+{
+    token.Cancel();
+}
+
+bool URuntimeMeshImportExportLibrary::IsTokenCancelled(const FRuntimeMeshImportExportCancellationToken& token)
+{
+    return token.IsCancelled();
+}
+
+bool URuntimeMeshImportExportLibrary::GetIsExtensionSupportedImport(FString extension)
+{
+    return FRuntimeMeshImportExportFormats::Get().IsExtensionSupportedImport(extension);
 }
 
 void URuntimeMeshImportExportLibrary::GetSupportedExtensionsImport(TArray<FString>& extensions)
 {
-    std::string string;
-    Assimp::Importer importer;
-    importer.GetExtensionList(string);
-    FString extensionsString(string.c_str());
-    extensionsString = extensionsString.Replace(TEXT("*"), TEXT(""));
-    extensionsString.ParseIntoArray(extensions, TEXT(";"), true);
+    extensions = FRuntimeMeshImportExportFormats::Get().GetExtensionsImport();
 }
 
 bool URuntimeMeshImportExportLibrary::GetIsExtensionSupportedExport(FString extension)
 {
-    extension.Replace(TEXT("."), TEXT("")); // Don't want a dot
-    TArray<FAssimpExportFormat> formats;
-    GetSupportedExtensionsExport(formats);
-    FAssimpExportFormat* foundFormat = formats.FindByPredicate([extension](const FAssimpExportFormat& format) -> bool {
-        return format.fileExtension == extension;
-    });
-    return foundFormat ? true : false;
+    return FRuntimeMeshImportExportFormats::Get().IsExtensionSupportedExport(extension);
 }
 
 void URuntimeMeshImportExportLibrary::GetSupportedExtensionsExport(TArray<FAssimpExportFormat>& formats)
 {
-    formats.Reset();
-    Assimp::Exporter exporter;
-
-    int32 formatCount = exporter.GetExportFormatCount();
-    for (int32 i = 0; i < formatCount; ++i)
-    {
-        formats.Add(FAssimpExportFormat(exporter.GetExportFormatDescription(i)));
-    }
+    formats = FRuntimeMeshImportExportFormats::Get().GetFormatsExport();
 }
 
 void URuntimeMeshImportExportLibrary::GetTransformCorrectionPresetsExport(TMap<FString, FTransformCorrection>& corrections)
@@ -695,10 +1419,10 @@ FTransform URuntimeMeshImportExportLibrary::TransformCorrectionToTransform(const
 
 void URuntimeMeshImportExportLibrary::ConvertVectorToProceduralMeshTangent(const TArray<FVector>& tangents, const bool bFlipTangentY, TArray<FProcMeshTangent>& procTangents)
 {
-    procTangents.Reset(tangents.Num());
-    for (const FVector& tan : tangents)
+    procTangents.SetNumUninitialized(tangents.Num());
+    for (int32 index = 0; index < tangents.Num(); ++index)
     {
-        procTangents.Add(FProcMeshTangent(tan, bFlipTangentY));
+        procTangents[index] = FProcMeshTangent(tangents[index], bFlipTangentY);
     }
 }
 
@@ -772,21 +1496,79 @@ FString URuntimeMeshImportExportLibrary::MaterialInfoToLogString(const FRuntimeM
     return out;
 }
 
-UTexture2D* URuntimeMeshImportExportLibrary::MaterialParamTextureToTexture2D(const FRuntimeMeshImportExportMaterialParamTexture& textureParam)
+// Reads the file of a texture whose read was deferred, through the texture cache when 'bUseTextureCache'
+static bool ReadDeferredTextureFile(const FString& file, const bool bUseTextureCache, TArray<uint8>& outData)
 {
-    if (textureParam.height == 0)
+    if (bUseTextureCache && FRuntimeMeshImportExportTextureCache::Get().FindFile_AnyThread(file, outData))
     {
-        // This is the easy case. The byte data is a image file. Just pass the data to the ImageWrapper.
-        return FImageUtils::ImportBufferAsTexture2D(textureParam.byteData);
+        return true;
     }
-    else
+    if (!FFileHelper::LoadFileToArray(outData, *file))
+    {
+        RMIE_LOG(Error, "Failed to read the deferred texture file %s", *file);
+        return false;
+    }
+    INC_DWORD_STAT_BY(STAT_RMIE_ImportedTextureBytes, outData.Num());
+    if (bUseTextureCache)
+    {
+        FRuntimeMeshImportExportTextureCache::Get().AddFile_AnyThread(file, outData);
+    }
+    return true;
+}
+
+bool URuntimeMeshImportExportLibrary::LoadTextureData_AnyThread(FRuntimeMeshImportExportMaterialParamTexture& texture, const bool bUseTextureCache)
+{
+    if (!texture.IsDataDeferred())
+    {
+        return texture.byteData.Num() > 0;
+    }
+    if (!ReadDeferredTextureFile(texture.sourceFile, bUseTextureCache, texture.byteData))
+    {
+        return false;
+    }
+    // The width of a texture file is its size in bytes
+    texture.width = texture.byteData.Num();
+    return true;
+}
+
+UTexture2D* URuntimeMeshImportExportLibrary::MaterialParamTextureToTexture2D(const FRuntimeMeshImportExportMaterialParamTexture& textureParam, const bool bUseTextureCache)
+{
+    // Hashed on every call, the bytes can have been changed since the import. Deferred textures are keyed by their file identity.
+    const uint64 contentHash = bUseTextureCache ? FRuntimeMeshImportExportTextureCache::HashContent(textureParam) : 0;
+    if (bUseTextureCache)
+    {
+        if (UTexture2D* cachedTexture = FRuntimeMeshImportExportTextureCache::Get().FindTexture(contentHash))
+        {
+            return cachedTexture;
+        }
+    }
+
+    FRuntimeMeshImportExportMaterialParamTexture loadedParam;
+    const FRuntimeMeshImportExportMaterialParamTexture* dataParam = &textureParam;
+    if (textureParam.IsDataDeferred())
+    {
+        loadedParam = textureParam;
+        if (!LoadTextureData_AnyThread(loadedParam, bUseTextureCache))
+        {
+            return nullptr;
+        }
+        dataParam = &loadedParam;
+    }
+
+    UTexture2D* texture = dataParam->height == 0
+        // This is the easy case. The byte data is a image file. Just pass the data to the ImageWrapper.
+        ? FImageUtils::ImportBufferAsTexture2D(dataParam->byteData)
+        // Raw aiTexel data is BGRA8 and goes to the texture as it is
+        : FRuntimeMeshTextureBuilder::CreateTextureFromTexels_GameThread(dataParam->byteData, dataParam->width, dataParam->height);
+    if (texture && bUseTextureCache)
     {
-        ensureAlwaysMsgf(0, TEXT("raw pixel data of Assimp Texture is not yet supported"));
+        FRuntimeMeshImportExportTextureCache::Get().AddTexture(contentHash, texture);
     }
-    return nullptr;
+    return texture;
 }
 
-UMaterialInstanceDynamic* URuntimeMeshImportExportLibrary::MaterialInfoToDynamicMaterial(UObject* worldContextObject, const FRuntimeMeshImportMaterialInfo& materialInfo, UMaterialInterface* sourceMaterial)
+UMaterialInstanceDynamic* URuntimeMeshImportExportLibrary::MaterialInfoToDynamicMaterial(UObject* worldContextObject, const FRuntimeMeshImportMaterialInfo& materialInfo, UMaterialInterface* sourceMaterial
+        , const bool bUseMaterialCache)
 {
     if (!sourceMaterial)
     {
@@ -794,6 +1576,15 @@ UMaterialInstanceDynamic* URuntimeMeshImportExportLibrary::MaterialInfoToDynamic
         return nullptr;
     }
 
+    const uint64 materialInfoHash = bUseMaterialCache ? FRuntimeMeshImportExportTextureCache::HashMaterialInfo(materialInfo) : 0;
+    if (bUseMaterialCache)
+    {
+        if (UMaterialInstanceDynamic* cached = FRuntimeMeshImportExportTextureCache::Get().FindMaterial(sourceMaterial, materialInfoHash))
+        {
+            return cached;
+        }
+    }
+
     // !!! THE NAME GIVEN TO THE MATERIAL MUST BE NONE, OTHERWISE WHEN CALLED 2x AND THE MATERIAL IS SET TO A UMG IMAGE, IT WILL CRASH !!!
     UMaterialInstanceDynamic* dynamic = UKismetMaterialLibrary::CreateDynamicMaterialInstance(worldContextObject, sourceMaterial, FName());
 
@@ -825,67 +1616,686 @@ UMaterialInstanceDynamic* URuntimeMeshImportExportLibrary::MaterialInfoToDynamic
         }
     }
 
+    if (bUseMaterialCache)
+    {
+        FRuntimeMeshImportExportTextureCache::Get().AddMaterial(sourceMaterial, materialInfoHash, dynamic);
+    }
     return dynamic;
 }
 
-float URuntimeMeshImportExportLibrary::RotationCorrectionToValue(const ERotationCorrection correction)
+void URuntimeMeshImportExportLibrary::MaterialParamTextureToTexture2D_Async_Cpp(const FRuntimeMeshImportExportMaterialParamTexture& textureParam, FRuntimeTextureCreated callbackCreated
+        , const bool bGenerateMips, const bool bUseTextureCache)
 {
-    switch (correction)
+    check(IsInGameThread());
+    // The same content compressed differently is a different texture
+    const ERuntimeMeshImportTextureCompression compression = textureParam.compression;
+    const uint64 contentHash = FRuntimeMeshImportExportTextureCache::HashContent(textureParam) + uint64(compression) * 0x9E3779B97F4A7C15ull;
+    if (bUseTextureCache)
     {
-    case ERotationCorrection::Minus_90:
-        return -90.f;
-    case ERotationCorrection::Zero:
-        return 0.f;
-    case ERotationCorrection::Plus_90:
-        return +90.f;
-    default:
-        checkNoEntry(); // Every case must be handled
+        if (UTexture2D* cachedTexture = FRuntimeMeshImportExportTextureCache::Get().FindTexture(contentHash))
+        {
+            callbackCreated.ExecuteIfBound(cachedTexture);
+            return;
+        }
     }
-    return 0.f;
+
+    FRuntimeMeshTextureBuilder::LoadModules_GameThread();
+    AsyncTask(ENamedThreads::AnyThread, [byteData = textureParam.byteData, sourceFile = textureParam.sourceFile, width = textureParam.width, height = textureParam.height
+        , callbackCreated, bGenerateMips, bUseTextureCache, contentHash, compression]() mutable -> void
+    {
+        // A deferred texture is read here, only when it is needed
+        const bool bHasData = byteData.Num() > 0 || (!sourceFile.IsEmpty() && ReadDeferredTextureFile(sourceFile, bUseTextureCache, byteData));
+        FRuntimeMeshTextureMips mips;
+        // With a height the bytes are raw aiTexel data, otherwise an image file
+        const bool bSuccess = bHasData && height != 0
+            ? FRuntimeMeshTextureBuilder::FromTexels_AnyThread(MoveTemp(byteData), width, height, mips)
+            : FRuntimeMeshTextureBuilder::DecodeImage_AnyThread(byteData, mips);
+        if (bSuccess && bGenerateMips)
+        {
+            FRuntimeMeshTextureBuilder::GenerateMips_AnyThread(mips);
+        }
+        FString mipFile;
+        if (bSuccess)
+        {
+            FRuntimeMeshTextureBuilder::Compress_AnyThread(mips, compression);
+            mipFile = FRuntimeMeshTextureStreamer::Get().PrepareMips_AnyThread(mips, contentHash);
+        }
+
+        AsyncTask(ENamedThreads::GameThread, [mips = MoveTemp(mips), mipFile = MoveTemp(mipFile), callbackCreated, bUseTextureCache, contentHash]() mutable -> void
+        {
+            UTexture2D* texture = FRuntimeMeshTextureBuilder::CreateTexture_GameThread(MoveTemp(mips));
+            FRuntimeMeshTextureStreamer::Get().Register_GameThread(texture, mipFile);
+            if (texture && bUseTextureCache)
+            {
+                FRuntimeMeshImportExportTextureCache::Get().AddTexture(contentHash, texture);
+            }
+            callbackCreated.ExecuteIfBound(texture);
+        });
+    });
 }
 
-void URuntimeMeshImportExportLibrary::NewLineAndAppend(FString& appendTo, const FString& append)
+void URuntimeMeshImportExportLibrary::MaterialParamTextureToTexture2D_Async(const FRuntimeMeshImportExportMaterialParamTexture& textureParam, FRuntimeTextureCreatedDyn callbackCreated
+        , const bool bGenerateMips, const bool bUseTextureCache)
 {
-    if (!appendTo.IsEmpty() && appendTo[appendTo.Len() - 1] != *TEXT("\n"))
-    {
-        appendTo += TEXT("\n");
-    }
-    appendTo.Append(append);
+    FRuntimeTextureCreated callbackCreatedRaw;
+    callbackCreatedRaw.BindLambda([callbackCreated](UTexture2D* texture) {
+        callbackCreated.ExecuteIfBound(texture);
+    });
+    MaterialParamTextureToTexture2D_Async_Cpp(textureParam, callbackCreatedRaw, bGenerateMips, bUseTextureCache);
 }
 
-void URuntimeMeshImportExportLibrary::OffsetTriangleArray(int32 offset, TArray<int32>& triangles)
+void URuntimeMeshImportExportLibrary::MaterialInfoToDynamicMaterial_Async_Cpp(UObject* worldContextObject, const FRuntimeMeshImportMaterialInfo& materialInfo, UMaterialInterface* sourceMaterial
+        , FRuntimeDynamicMaterialCreated callbackCreated, const bool bGenerateMips, const bool bUseMaterialCache)
 {
-    for (int32& index : triangles)
+    if (!sourceMaterial)
     {
-        index += offset;
+        RMIE_LOG(Error, "A source material must be specified!");
+        callbackCreated.ExecuteIfBound(nullptr);
+        return;
     }
-}
 
-FTransform URuntimeMeshImportExportLibrary::AiTransformToFTransform(const aiMatrix4x4& transform)
-{
-    FMatrix tempMatrix;
-    tempMatrix.M[0][0] = transform.a1;
-    tempMatrix.M[0][1] = transform.b1;
-    tempMatrix.M[0][2] = transform.c1;
-    tempMatrix.M[0][3] = transform.d1;
-    tempMatrix.M[1][0] = transform.a2;
-    tempMatrix.M[1][1] = transform.b2;
-    tempMatrix.M[1][2] = transform.c2;
-    tempMatrix.M[1][3] = transform.d2;
-    tempMatrix.M[2][0] = transform.a3;
-    tempMatrix.M[2][1] = transform.b3;
-    tempMatrix.M[2][2] = transform.c3;
-    tempMatrix.M[2][3] = transform.d3;
-    tempMatrix.M[3][0] = transform.a4;
-    tempMatrix.M[3][1] = transform.b4;
-    tempMatrix.M[3][2] = transform.c4;
-    tempMatrix.M[3][3] = transform.d4;
-    return FTransform(tempMatrix);
-}
+    const uint64 materialInfoHash = bUseMaterialCache ? FRuntimeMeshImportExportTextureCache::HashMaterialInfo(materialInfo) : 0;
+    if (bUseMaterialCache)
+    {
+        if (UMaterialInstanceDynamic* cached = FRuntimeMeshImportExportTextureCache::Get().FindMaterial(sourceMaterial, materialInfoHash))
+        {
+            callbackCreated.ExecuteIfBound(cached);
+            return;
+        }
+    }
 
-aiMatrix4x4 URuntimeMeshImportExportLibrary::FTransformToAiTransform(const FTransform& transform)
-{
-    FMatrix uMatrix = transform.ToMatrixWithScale();
+    // !!! THE NAME GIVEN TO THE MATERIAL MUST BE NONE, OTHERWISE WHEN CALLED 2x AND THE MATERIAL IS SET TO A UMG IMAGE, IT WILL CRASH !!!
+    UMaterialInstanceDynamic* dynamic = UKismetMaterialLibrary::CreateDynamicMaterialInstance(worldContextObject, sourceMaterial, FName());
+
+    for (const FRuntimeMeshImportExportMaterialParamScalar& scalarParam : materialInfo.scalars)
+    {
+        dynamic->SetScalarParameterValue(scalarParam.name, scalarParam.value);
+    }
+
+    for (const FRuntimeMeshImportExportMaterialParamVector& vectorParam : materialInfo.vectors)
+    {
+        dynamic->SetVectorParameterValue(vectorParam.name, vectorParam.value);
+    }
+
+    // Only convert the textureParam to a Texture2D if the parameter is present in the material!
+    TArray<const FRuntimeMeshImportExportMaterialParamTexture*> usedTextureParams;
+    for (const FRuntimeMeshImportExportMaterialParamTexture& textureParam : materialInfo.textures)
+    {
+        UTexture* existingTexture = NULL;
+        if (dynamic->GetTextureParameterValue(FMaterialParameterInfo(textureParam.name), existingTexture))
+        {
+            usedTextureParams.Add(&textureParam);
+        }
+    }
+
+    if (usedTextureParams.Num() == 0)
+    {
+        if (bUseMaterialCache)
+        {
+            FRuntimeMeshImportExportTextureCache::Get().AddMaterial(sourceMaterial, materialInfoHash, dynamic);
+        }
+        callbackCreated.ExecuteIfBound(dynamic);
+        return;
+    }
+
+    // Keeps the material alive until all textures are assigned
+    struct FPendingDynamicMaterial
+    {
+        TStrongObjectPtr<UMaterialInstanceDynamic> material;
+        int32 numRemainingTextures;
+        FRuntimeDynamicMaterialCreated callbackCreated;
+        // 0 when it is not shared
+        uint64 materialInfoHash;
+        TWeakObjectPtr<UMaterialInterface> sourceMaterial;
+    };
+    TSharedRef<FPendingDynamicMaterial> pending = MakeShareable(new FPendingDynamicMaterial{ TStrongObjectPtr<UMaterialInstanceDynamic>(dynamic), usedTextureParams.Num(), callbackCreated
+                                                                                            , materialInfoHash, sourceMaterial });
+
+    for (const FRuntimeMeshImportExportMaterialParamTexture* textureParam : usedTextureParams)
+    {
+        FRuntimeTextureCreated textureCreated;
+        textureCreated.BindLambda([pending, paramName = textureParam->name, materialName = materialInfo.name](UTexture2D* texture) {
+            if (texture)
+            {
+                pending->material->SetTextureParameterValue(paramName, texture);
+            }
+            else
+            {
+                RMIE_LOG(Error, "Could not convert TextureParam %s from to UTexture2D for MaterialInfo %s", *paramName.ToString(), *materialName.ToString());
+            }
+
+            if (--pending->numRemainingTextures == 0)
+            {
+                if (pending->materialInfoHash != 0)
+                {
+                    FRuntimeMeshImportExportTextureCache::Get().AddMaterial(pending->sourceMaterial.Get(), pending->materialInfoHash, pending->material.Get());
+                }
+                pending->callbackCreated.ExecuteIfBound(pending->material.Get());
+                pending->material.Reset();
+            }
+        });
+        MaterialParamTextureToTexture2D_Async_Cpp(*textureParam, textureCreated, bGenerateMips);
+    }
+}
+
+void URuntimeMeshImportExportLibrary::MaterialInfoToDynamicMaterial_Async(UObject* worldContextObject, const FRuntimeMeshImportMaterialInfo& materialInfo, UMaterialInterface* sourceMaterial
+        , FRuntimeDynamicMaterialCreatedDyn callbackCreated, const bool bGenerateMips, const bool bUseMaterialCache)
+{
+    FRuntimeDynamicMaterialCreated callbackCreatedRaw;
+    callbackCreatedRaw.BindLambda([callbackCreated](UMaterialInstanceDynamic* material) {
+        callbackCreated.ExecuteIfBound(material);
+    });
+    MaterialInfoToDynamicMaterial_Async_Cpp(worldContextObject, materialInfo, sourceMaterial, callbackCreatedRaw, bGenerateMips, bUseMaterialCache);
+}
+
+void URuntimeMeshImportExportLibrary::SetTextureCacheBudget(const int32 fileBudgetMB, const int32 textureBudgetMB)
+{
+    FRuntimeMeshImportExportTextureCache::Get().SetBudget(int64(fileBudgetMB) * 1024 * 1024, int64(textureBudgetMB) * 1024 * 1024);
+}
+
+void URuntimeMeshImportExportLibrary::EmptyTextureCache()
+{
+    FRuntimeMeshImportExportTextureCache::Get().Empty();
+}
+
+void URuntimeMeshImportExportLibrary::SetThreadPoolSettings(const FRuntimeMeshImportExportThreadPoolSettings& settings)
+{
+    FRuntimeMeshImportExportThreadPool::Get().Configure(settings);
+}
+
+FRuntimeMeshImportExportThreadPoolSettings URuntimeMeshImportExportLibrary::GetThreadPoolSettings()
+{
+    return FRuntimeMeshImportExportThreadPool::Get().GetSettings();
+}
+
+void URuntimeMeshImportExportLibrary::SetTextureStreamingSettings(const FRuntimeMeshImportTextureStreamingSettings& settings)
+{
+    FRuntimeMeshTextureStreamer::Get().SetSettings(settings);
+}
+
+FRuntimeMeshImportTextureStreamingSettings URuntimeMeshImportExportLibrary::GetTextureStreamingSettings()
+{
+    return FRuntimeMeshTextureStreamer::Get().GetSettings();
+}
+
+float URuntimeMeshImportExportLibrary::RotationCorrectionToValue(const ERotationCorrection correction)
+{
+    switch (correction)
+    {
+    case ERotationCorrection::Minus_90:
+        return -90.f;
+    case ERotationCorrection::Zero:
+        return 0.f;
+    case ERotationCorrection::Plus_90:
+        return +90.f;
+    default:
+        checkNoEntry(); // Every case must be handled
+    }
+    return 0.f;
+}
+
+void URuntimeMeshImportExportLibrary::MeshInfoToStaticMesh_Async_Cpp(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeStaticMeshCreated callbackCreated)
+{
+    check(IsInGameThread());
+    // The materials are not kept alive while the buffers are built, a destroyed material gets the default one
+    TArray<TWeakObjectPtr<UMaterialInterface>> weakMaterials;
+    for (UMaterialInterface* material : materials)
+    {
+        weakMaterials.Add(material);
+    }
+
+    AsyncTask(ENamedThreads::AnyThread, [meshInfo, weakMaterials = MoveTemp(weakMaterials), callbackCreated]() -> void
+    {
+        MeshInfoToStaticMesh_Future(meshInfo, weakMaterials).Next([callbackCreated](UStaticMesh* staticMesh) {
+            callbackCreated.ExecuteIfBound(staticMesh);
+        });
+    });
+}
+
+TFuture<UStaticMesh*> URuntimeMeshImportExportLibrary::MeshInfoToStaticMesh_Future(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<TWeakObjectPtr<UMaterialInterface>>& materials)
+{
+    TArray<FName> slotNames;
+    TUniquePtr<FStaticMeshRenderData> renderData = FRuntimeMeshStaticMeshBuilder::BuildRenderData_AnyThread(meshInfo, slotNames);
+    if (!renderData.IsValid())
+    {
+        RMIE_LOG(Warning, "Mesh %s has no triangles, no static mesh is created.", *meshInfo.meshName.ToString());
+    }
+
+    TPromise<UStaticMesh*> promise;
+    TFuture<UStaticMesh*> future = promise.GetFuture();
+    AsyncTask(ENamedThreads::GameThread, [renderData = MoveTemp(renderData), slotNames = MoveTemp(slotNames), weakMaterials = materials, promise = MoveTemp(promise)]() mutable -> void
+    {
+        TArray<UMaterialInterface*> materials;
+        for (const TWeakObjectPtr<UMaterialInterface>& material : weakMaterials)
+        {
+            materials.Add(material.Get());
+        }
+        promise.SetValue(FRuntimeMeshStaticMeshBuilder::CreateStaticMesh_GameThread(MoveTemp(renderData), slotNames, materials));
+    });
+    return future;
+}
+
+void URuntimeMeshImportExportLibrary::MeshInfoToStaticMesh_Async(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeStaticMeshCreatedDyn callbackCreated)
+{
+    FRuntimeStaticMeshCreated callbackCreatedRaw;
+    callbackCreatedRaw.BindLambda([callbackCreated](UStaticMesh* staticMesh) {
+        callbackCreated.ExecuteIfBound(staticMesh);
+    });
+    MeshInfoToStaticMesh_Async_Cpp(meshInfo, materials, callbackCreatedRaw);
+}
+
+void URuntimeMeshImportExportLibrary::MeshInfoToSkeletalMesh_Async_Cpp(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<FRuntimeMeshImportBone>& bones
+    , const TArray<UMaterialInterface*>& materials, FRuntimeSkeletalMeshCreated callbackCreated)
+{
+    check(IsInGameThread());
+    // The materials are not kept alive while the buffers are built, a destroyed material gets the default one
+    TArray<TWeakObjectPtr<UMaterialInterface>> weakMaterials;
+    for (UMaterialInterface* material : materials)
+    {
+        weakMaterials.Add(material);
+    }
+
+    AsyncTask(ENamedThreads::AnyThread, [meshInfo, bones, weakMaterials = MoveTemp(weakMaterials), callbackCreated]() -> void
+    {
+        MeshInfoToSkeletalMesh_Future(meshInfo, bones, weakMaterials).Next([callbackCreated](USkeletalMesh* skeletalMesh) {
+            callbackCreated.ExecuteIfBound(skeletalMesh);
+        });
+    });
+}
+
+TFuture<USkeletalMesh*> URuntimeMeshImportExportLibrary::MeshInfoToSkeletalMesh_Future(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<FRuntimeMeshImportBone>& bones
+    , const TArray<TWeakObjectPtr<UMaterialInterface>>& materials)
+{
+    TUniquePtr<FRuntimeMeshSkeletalMeshData> data = FRuntimeMeshSkeletalMeshBuilder::BuildRenderData_AnyThread(meshInfo, bones);
+    if (!data.IsValid())
+    {
+        RMIE_LOG(Warning, "No skeletal mesh is created for mesh %s.", *meshInfo.meshName.ToString());
+    }
+
+    TPromise<USkeletalMesh*> promise;
+    TFuture<USkeletalMesh*> future = promise.GetFuture();
+    AsyncTask(ENamedThreads::GameThread, [data = MoveTemp(data), weakMaterials = materials, promise = MoveTemp(promise)]() mutable -> void
+    {
+        TArray<UMaterialInterface*> materials;
+        for (const TWeakObjectPtr<UMaterialInterface>& material : weakMaterials)
+        {
+            materials.Add(material.Get());
+        }
+        promise.SetValue(FRuntimeMeshSkeletalMeshBuilder::CreateSkeletalMesh_GameThread(MoveTemp(data), materials));
+    });
+    return future;
+}
+
+void URuntimeMeshImportExportLibrary::MeshInfoToSkeletalMesh_Async(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<FRuntimeMeshImportBone>& bones
+    , const TArray<UMaterialInterface*>& materials, FRuntimeSkeletalMeshCreatedDyn callbackCreated)
+{
+    FRuntimeSkeletalMeshCreated callbackCreatedRaw;
+    callbackCreatedRaw.BindLambda([callbackCreated](USkeletalMesh* skeletalMesh) {
+        callbackCreated.ExecuteIfBound(skeletalMesh);
+    });
+    MeshInfoToSkeletalMesh_Async_Cpp(meshInfo, bones, materials, callbackCreatedRaw);
+}
+
+void URuntimeMeshImportExportLibrary::ImportResultToProcMeshSections(FRuntimeMeshImportResult& result, const bool bReleaseResult, const bool bCreateCollision, const bool bFlipTangentY
+    , TArray<FProcMeshSection>& outSections, TArray<int32>& outMaterialIndices)
+{
+    TArray<FRuntimeMeshImportSectionInfo*> sourceSections;
+    for (FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+    {
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            sourceSections.Add(&section);
+        }
+    }
+
+    outSections.SetNum(sourceSections.Num());
+    outMaterialIndices.SetNum(sourceSections.Num());
+    ParallelFor(sourceSections.Num(), [&sourceSections, &outSections, &outMaterialIndices, bReleaseResult, bCreateCollision, bFlipTangentY](int32 sectionIndex)
+    {
+        FRuntimeMeshImportSectionInfo& source = *sourceSections[sectionIndex];
+        FProcMeshSection& section = outSections[sectionIndex];
+        outMaterialIndices[sectionIndex] = source.materialIndex;
+        section.bEnableCollision = bCreateCollision;
+
+        // The defaults of UProceduralMeshComponent::CreateMeshSection for the missing streams
+        const int32 numVertices = source.vertices.Num();
+        const bool bHasNormals = source.normals.Num() == numVertices;
+        const bool bHasTangents = source.tangents.Num() == numVertices;
+        const bool bHasColors = source.vertexColors.Num() == numVertices;
+        const bool bHasUV0 = source.uv0.Num() == numVertices;
+        const bool bHasUV1 = source.uv1.Num() == numVertices;
+        section.ProcVertexBuffer.SetNumUninitialized(numVertices);
+        FBox bounds(ForceInit);
+        for (int32 vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+        {
+            FProcMeshVertex& vertex = section.ProcVertexBuffer[vertexIndex];
+            vertex.Position = source.vertices[vertexIndex];
+            vertex.Normal = bHasNormals ? source.normals[vertexIndex] : FVector(0.f, 0.f, 1.f);
+            vertex.Tangent = bHasTangents ? FProcMeshTangent(source.tangents[vertexIndex], bFlipTangentY) : FProcMeshTangent(FVector(1.f, 0.f, 0.f), false);
+            // Not sRGB, like UProceduralMeshComponent::CreateMeshSection_LinearColor
+            vertex.Color = bHasColors ? source.vertexColors[vertexIndex].ToFColor(false) : FColor(255, 255, 255);
+            vertex.UV0 = bHasUV0 ? source.uv0[vertexIndex] : FVector2D::ZeroVector;
+            vertex.UV1 = bHasUV1 ? source.uv1[vertexIndex] : FVector2D::ZeroVector;
+            vertex.UV2 = FVector2D::ZeroVector;
+            vertex.UV3 = FVector2D::ZeroVector;
+            bounds += vertex.Position;
+        }
+        section.SectionLocalBox = source.bounds.IsValid ? source.bounds : bounds;
+
+        // Same layout, the indices are never negative
+        section.ProcIndexBuffer.SetNumUninitialized(source.triangles.Num());
+        FMemory::Memcpy(section.ProcIndexBuffer.GetData(), source.triangles.GetData(), source.triangles.Num() * sizeof(int32));
+
+        if (bReleaseResult)
+        {
+            source = FRuntimeMeshImportSectionInfo();
+        }
+    });
+}
+
+// The sections are moved out of a non-const 'sections' and copied from a const one
+template <typename SectionsType>
+static void ApplyProcMeshSections_GameThread(UProceduralMeshComponent& component, SectionsType& sections, const TArray<int32>& materialIndices
+    , const TArray<UMaterialInterface*>& materials)
+{
+    check(IsInGameThread());
+    component.ClearAllMeshSections();
+    const int32 numSections = sections.Num();
+    if (numSections == 0)
+    {
+        return;
+    }
+
+    // SetProcMeshSection copies the section and updates the bounds, the collision and the render state.
+    // The first call creates the empty slots that the other sections are moved into, only the last section is copied.
+    component.SetProcMeshSection(numSections - 1, FProcMeshSection());
+    for (int32 sectionIndex = 0; sectionIndex < numSections - 1; ++sectionIndex)
+    {
+        *component.GetProcMeshSection(sectionIndex) = MoveTempIfPossible(sections[sectionIndex]);
+    }
+    component.SetProcMeshSection(numSections - 1, sections[numSections - 1]);
+
+    for (int32 sectionIndex = 0; sectionIndex < numSections; ++sectionIndex)
+    {
+        const int32 materialIndex = materialIndices[sectionIndex];
+        if (materials.IsValidIndex(materialIndex) && materials[materialIndex])
+        {
+            component.SetMaterial(sectionIndex, materials[materialIndex]);
+        }
+    }
+}
+
+void URuntimeMeshImportExportLibrary::SetProcMeshSections(UProceduralMeshComponent& component, const TArray<FProcMeshSection>& sections, const TArray<int32>& materialIndices
+    , const TArray<UMaterialInterface*>& materials)
+{
+    ApplyProcMeshSections_GameThread(component, sections, materialIndices, materials);
+}
+
+void URuntimeMeshImportExportLibrary::ApplyImportResultToProceduralMesh(UProceduralMeshComponent* component, const FRuntimeMeshImportResult& result, const TArray<UMaterialInterface*>& materials
+    , const bool bCreateCollision, const bool bFlipTangentY)
+{
+    if (!component)
+    {
+        RMIE_LOG(Error, "No component to apply the import result to.");
+        return;
+    }
+
+    TArray<FProcMeshSection> sections;
+    TArray<int32> materialIndices;
+    // Only read, the result stays as it is
+    ImportResultToProcMeshSections(const_cast<FRuntimeMeshImportResult&>(result), false, bCreateCollision, bFlipTangentY, sections, materialIndices);
+    ApplyProcMeshSections_GameThread(*component, sections, materialIndices, materials);
+}
+
+void URuntimeMeshImportExportLibrary::ApplyImportResultToProceduralMesh_Async_Cpp(UProceduralMeshComponent* component, FRuntimeMeshImportResult&& result, const TArray<UMaterialInterface*>& materials
+    , FRuntimeImportExportGameThreadDone callbackDone, const bool bCreateCollision, const bool bFlipTangentY)
+{
+    check(IsInGameThread());
+    if (!component)
+    {
+        RMIE_LOG(Error, "No component to apply the import result to.");
+        return;
+    }
+
+    // Neither the component nor the materials are kept alive while the sections are converted
+    TWeakObjectPtr<UProceduralMeshComponent> weakComponent = component;
+    TArray<TWeakObjectPtr<UMaterialInterface>> weakMaterials;
+    for (UMaterialInterface* material : materials)
+    {
+        weakMaterials.Add(material);
+    }
+
+    FRuntimeMeshImportResultPtr resultPtr = FRuntimeMeshDeferredRelease::MakeImportResult(MoveTemp(result));
+    AsyncTask(ENamedThreads::AnyThread, [weakComponent, resultPtr, weakMaterials = MoveTemp(weakMaterials), callbackDone, bCreateCollision, bFlipTangentY]() mutable -> void
+    {
+        // Only one reference is left, so the result is freed while converting
+        const FRuntimeMeshImportResultRef uniqueResult = resultPtr.ToSharedRef();
+        resultPtr.Reset();
+        ApplyImportResultToProceduralMesh_Future(weakComponent, uniqueResult, weakMaterials, bCreateCollision, bFlipTangentY).Next([callbackDone](bool bApplied) {
+            if (bApplied)
+            {
+                callbackDone.ExecuteIfBound();
+            }
+        });
+    });
+}
+
+TFuture<bool> URuntimeMeshImportExportLibrary::ApplyImportResultToProceduralMesh_Future(TWeakObjectPtr<UProceduralMeshComponent> component, const FRuntimeMeshImportResultRef& result
+    , const TArray<TWeakObjectPtr<UMaterialInterface>>& materials, const bool bCreateCollision, const bool bFlipTangentY)
+{
+    TArray<FProcMeshSection> sections;
+    TArray<int32> materialIndices;
+    const bool bReleaseResult = result.IsUnique();
+    ImportResultToProcMeshSections(*result, bReleaseResult, bCreateCollision, bFlipTangentY, sections, materialIndices);
+    if (bReleaseResult)
+    {
+        *result = FRuntimeMeshImportResult();
+    }
+
+    TPromise<bool> promise;
+    TFuture<bool> future = promise.GetFuture();
+    AsyncTask(ENamedThreads::GameThread, [component, sections = MoveTemp(sections), materialIndices = MoveTemp(materialIndices), weakMaterials = materials, promise = MoveTemp(promise)]() mutable -> void
+    {
+        UProceduralMeshComponent* componentPtr = component.Get();
+        if (!componentPtr)
+        {
+            promise.SetValue(false);
+            return;
+        }
+        TArray<UMaterialInterface*> materials;
+        for (const TWeakObjectPtr<UMaterialInterface>& material : weakMaterials)
+        {
+            materials.Add(material.Get());
+        }
+        ApplyProcMeshSections_GameThread(*componentPtr, sections, materialIndices, materials);
+        promise.SetValue(true);
+    });
+    return future;
+}
+
+void URuntimeMeshImportExportLibrary::ApplyImportResultToProceduralMesh_Async(UProceduralMeshComponent* component, const FRuntimeMeshImportResult& result, const TArray<UMaterialInterface*>& materials
+    , FRuntimeImportExportGameThreadDoneDyn callbackDone, const bool bCreateCollision, const bool bFlipTangentY)
+{
+    FRuntimeImportExportGameThreadDone callbackDoneRaw;
+    callbackDoneRaw.BindLambda([callbackDone]() {
+        callbackDone.ExecuteIfBound();
+    });
+    FRuntimeMeshImportResult resultCopy = result;
+    ApplyImportResultToProceduralMesh_Async_Cpp(component, MoveTemp(resultCopy), materials, callbackDoneRaw, bCreateCollision, bFlipTangentY);
+}
+
+int32 URuntimeMeshImportExportLibrary::AddMeshInfoInstances(UInstancedStaticMeshComponent* component, const FRuntimeMeshImportMeshInfo& meshInfo)
+{
+    if (!component)
+    {
+        RMIE_LOG(Error, "No component to add the instances to.");
+        return 0;
+    }
+
+    for (const FTransform& instanceTransform : meshInfo.instanceTransforms)
+    {
+        component->AddInstance(instanceTransform);
+    }
+    return meshInfo.instanceTransforms.Num();
+}
+
+bool URuntimeMeshImportExportLibrary::RaycastMeshInfo(const FRuntimeMeshImportMeshInfo& meshInfo, const FVector& start, const FVector& end, FRuntimeMeshImportRaycastHit& hit)
+{
+    bool bHit = false;
+    bool bHasBVH = false;
+    FVector segmentEnd = end;
+    for (int32 sectionIndex = 0; sectionIndex < meshInfo.sections.Num(); ++sectionIndex)
+    {
+        const FRuntimeMeshImportSectionInfo& section = meshInfo.sections[sectionIndex];
+        if (!section.bvh.IsValid())
+        {
+            continue;
+        }
+        bHasBVH = true;
+        // Later sections only need to beat the closest hit so far
+        FRuntimeMeshImportRaycastHit sectionHit;
+        if (section.bvh->Raycast(section, start, segmentEnd, sectionHit))
+        {
+            bHit = true;
+            hit = sectionHit;
+            hit.distance = FVector::Dist(start, hit.location);
+            hit.sectionIndex = sectionIndex;
+            segmentEnd = hit.location;
+        }
+    }
+    if (!bHasBVH)
+    {
+        RMIE_LOG(Warning, "Mesh %s has no BVH, import it with bBuildBVH.", *meshInfo.meshName.ToString());
+    }
+    return bHit;
+}
+
+UBodySetup* URuntimeMeshImportExportLibrary::CreateBodySetupFromBVH(UObject* outer, const FRuntimeMeshImportMeshInfo& meshInfo, const int32 maxBoxesPerSection)
+{
+    TArray<FKBoxElem> boxes;
+    for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+    {
+        if (section.bvh.IsValid())
+        {
+            section.bvh->GetCollisionBoxes(FMath::Max(1, maxBoxesPerSection), boxes);
+        }
+    }
+    if (boxes.Num() == 0)
+    {
+        RMIE_LOG(Warning, "Mesh %s has no BVH, no body setup is created.", *meshInfo.meshName.ToString());
+        return nullptr;
+    }
+
+    UBodySetup* bodySetup = NewObject<UBodySetup>(outer ? outer : GetTransientPackage());
+    bodySetup->CollisionTraceFlag = ECollisionTraceFlag::CTF_UseSimpleAsComplex;
+    bodySetup->AggGeom.BoxElems = MoveTemp(boxes);
+    bodySetup->bNeverNeedsCookedCollisionData = true;
+    bodySetup->CreatePhysicsMeshes();
+    return bodySetup;
+}
+
+void URuntimeMeshImportExportLibrary::MeshInfoToBodySetup_Async_Cpp(const FRuntimeMeshImportMeshInfo& meshInfo, FRuntimeBodySetupCreated callbackCreated)
+{
+    check(IsInGameThread());
+    const FRuntimeMeshImportCollision& collision = meshInfo.collision;
+    if (collision.IsEmpty())
+    {
+        RMIE_LOG(Warning, "Mesh %s has no collision, import it with a collision type.", *meshInfo.meshName.ToString());
+        callbackCreated.ExecuteIfBound(nullptr);
+        return;
+    }
+
+    // The provider hands the trimesh to the cooking and keeps it alive as the outer of the body setup
+    URuntimeMeshImportCollisionProvider* provider = NewObject<URuntimeMeshImportCollisionProvider>(GetTransientPackage());
+    provider->trimeshVertices = collision.trimeshVertices;
+    provider->trimeshTriangles = collision.trimeshTriangles;
+
+    UBodySetup* bodySetup = NewObject<UBodySetup>(provider);
+    bodySetup->bGenerateMirroredCollision = false;
+    bodySetup->CollisionTraceFlag = collision.trimeshTriangles.Num() > 0 ? ECollisionTraceFlag::CTF_UseComplexAsSimple : ECollisionTraceFlag::CTF_UseSimpleAsComplex;
+    for (const FRuntimeMeshImportConvexHull& hull : collision.convexHulls)
+    {
+        FKConvexElem& convexElem = bodySetup->AggGeom.ConvexElems.AddDefaulted_GetRef();
+        convexElem.VertexData = hull.vertices;
+        convexElem.UpdateElemBox();
+    }
+
+    // Held until the cooking is done, nothing else references the new objects yet
+    TSharedRef<TStrongObjectPtr<UBodySetup>> pendingBodySetup = MakeShared<TStrongObjectPtr<UBodySetup>>(bodySetup);
+    bodySetup->CreatePhysicsMeshesAsync(FOnAsyncPhysicsCookFinished::CreateLambda([pendingBodySetup, callbackCreated](bool bSuccess)
+    {
+        UBodySetup* cookedBodySetup = pendingBodySetup->Get();
+        if (!bSuccess)
+        {
+            RMIE_LOG(Warning, "The collision cooking failed, no body setup is created.");
+            cookedBodySetup = nullptr;
+        }
+        callbackCreated.ExecuteIfBound(cookedBodySetup);
+    }));
+}
+
+void URuntimeMeshImportExportLibrary::MeshInfoToBodySetup_Async(const FRuntimeMeshImportMeshInfo& meshInfo, FRuntimeBodySetupCreatedDyn callbackCreated)
+{
+    FRuntimeBodySetupCreated callbackCreatedRaw;
+    callbackCreatedRaw.BindLambda([callbackCreated](UBodySetup* bodySetup) {
+        callbackCreated.ExecuteIfBound(bodySetup);
+    });
+    MeshInfoToBodySetup_Async_Cpp(meshInfo, callbackCreatedRaw);
+}
+
+void URuntimeMeshImportExportLibrary::NewLineAndAppend(FString& appendTo, const FString& append)
+{
+    if (!appendTo.IsEmpty() && appendTo[appendTo.Len() - 1] != *TEXT("\n"))
+    {
+        appendTo += TEXT("\n");
+    }
+    appendTo.Append(append);
+}
+
+void URuntimeMeshImportExportLibrary::OffsetTriangleArray(int32 offset, TArray<int32>& triangles)
+{
+    FMeshConversionKernels::OffsetIndices(triangles.GetData(), triangles.GetData(), triangles.Num(), offset);
+}
+
+FString URuntimeMeshImportExportLibrary::ResolveImportFilePath(const FString& file, const EPathType pathType)
+{
+    switch (pathType)
+    {
+    case EPathType::ProjectRelative:
+        return FPaths::Combine(FPaths::ConvertRelativePathToFull(FPaths::ProjectDir()), file);
+    case EPathType::ContentRelative:
+        return FPaths::Combine(FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()), file);
+    case EPathType::Absolute:
+    default:
+        return file;
+    }
+}
+
+FTransform URuntimeMeshImportExportLibrary::AiTransformToFTransform(const aiMatrix4x4& transform)
+{
+    FMatrix tempMatrix;
+    tempMatrix.M[0][0] = transform.a1;
+    tempMatrix.M[0][1] = transform.b1;
+    tempMatrix.M[0][2] = transform.c1;
+    tempMatrix.M[0][3] = transform.d1;
+    tempMatrix.M[1][0] = transform.a2;
+    tempMatrix.M[1][1] = transform.b2;
+    tempMatrix.M[1][2] = transform.c2;
+    tempMatrix.M[1][3] = transform.d2;
+    tempMatrix.M[2][0] = transform.a3;
+    tempMatrix.M[2][1] = transform.b3;
+    tempMatrix.M[2][2] = transform.c3;
+    tempMatrix.M[2][3] = transform.d3;
+    tempMatrix.M[3][0] = transform.a4;
+    tempMatrix.M[3][1] = transform.b4;
+    tempMatrix.M[3][2] = transform.c4;
+    tempMatrix.M[3][3] = transform.d4;
+    return FTransform(tempMatrix);
+}
+
+aiMatrix4x4 URuntimeMeshImportExportLibrary::FTransformToAiTransform(const FTransform& transform)
+{
+    FMatrix uMatrix = transform.ToMatrixWithScale();
     aiMatrix4x4 outMatrix;
     outMatrix.a1 = uMatrix.M[0][0];
     outMatrix.b1 = uMatrix.M[0][1];
@@ -906,175 +2316,1842 @@ aiMatrix4x4 URuntimeMeshImportExportLibrary::FTransformToAiTransform(const FTran
     return outMatrix;
 }
 
-void URuntimeMeshImportExportLibrary::SendProgress_AnyThread(FRuntimeMeshImportExportProgressUpdate delegateProgress, FRuntimeMeshImportExportProgress progress)
+void URuntimeMeshImportExportLibrary::SendProgress_AnyThread(FRuntimeMeshImportExportProgressUpdate delegateProgress, FRuntimeMeshImportExportProgress progress)
+{
+    if (IsInGameThread())
+    {
+        delegateProgress.ExecuteIfBound(progress);
+    }
+    else
+    {
+        AsyncTask(ENamedThreads::GameThread, [delegateProgress, progress]() {
+            delegateProgress.ExecuteIfBound(progress);
+        });
+    }
+}
+
+void ApplyImportMethodSection(const EImportMethodSection importMethodSection, FRuntimeMeshImportMeshInfo& mesh)
+{
+    switch (importMethodSection)
+    {
+    case EImportMethodSection::Keep:
+        // Do Nothing
+        break;
+    case EImportMethodSection::Merge:
+        MergeAllSections(mesh.sections);
+        break;
+    case EImportMethodSection::MergeSameMaterial:
+        MergeSectionsSameMaterial(mesh.sections);
+        break;
+    default:
+        checkNoEntry();
+    }
+}
+
+/**
+ * Fills the LODs of 'meshInfos' by simplifying each section for every entry of 'lodSettings'.
+ * Each LOD is simplified from the LOD before. The sections of all meshes are simplified in parallel.
+ */
+void GenerateMeshLODs(const TArray<FRuntimeMeshImportLODSetting>& lodSettings, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos, const bool bParallel)
+{
+    if (lodSettings.Num() == 0)
+    {
+        return;
+    }
+
+    // The LOD sections are allocated up front, each work item only writes to its own sections
+    TArray<TPair<int32, int32>> workItems;
+    for (int32 meshInfoIndex = 0; meshInfoIndex < meshInfos.Num(); ++meshInfoIndex)
+    {
+        FRuntimeMeshImportMeshInfo& meshInfo = meshInfos[meshInfoIndex];
+        meshInfo.lods.SetNum(lodSettings.Num());
+        for (int32 lodIndex = 0; lodIndex < lodSettings.Num(); ++lodIndex)
+        {
+            meshInfo.lods[lodIndex].screenSize = lodSettings[lodIndex].screenSize;
+            meshInfo.lods[lodIndex].sections.SetNum(meshInfo.sections.Num());
+        }
+        for (int32 sectionIndex = 0; sectionIndex < meshInfo.sections.Num(); ++sectionIndex)
+        {
+            workItems.Emplace(meshInfoIndex, sectionIndex);
+        }
+    }
+
+    ParallelFor(workItems.Num(), [&lodSettings, &meshInfos, &workItems](int32 workIndex)
+    {
+        FRuntimeMeshImportMeshInfo& meshInfo = meshInfos[workItems[workIndex].Key];
+        const int32 sectionIndex = workItems[workIndex].Value;
+        const FRuntimeMeshImportSectionInfo* previousSection = &meshInfo.sections[sectionIndex];
+        const int32 numTriangles = previousSection->triangles.Num() / 3;
+        for (int32 lodIndex = 0; lodIndex < lodSettings.Num(); ++lodIndex)
+        {
+            const float triangleRatio = FMath::Clamp(lodSettings[lodIndex].triangleRatio, 0.f, 1.f);
+            const int32 targetTriangles = FMath::Max(FMath::RoundToInt(numTriangles * triangleRatio), 1);
+            FRuntimeMeshImportSectionInfo& lodSection = meshInfo.lods[lodIndex].sections[sectionIndex];
+            FMeshSimplifier::Simplify(*previousSection, targetTriangles, lodSection);
+            previousSection = &lodSection;
+        }
+    }, !bParallel);
+}
+
+// Splits the large sections of 'meshInfos' into chunks, when 'param' asks for it. Each section is partitioned in parallel.
+void SplitMeshSections(const FRuntimeMeshImportParam& param, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos)
+{
+    if (!param.bSplitLargeSections)
+    {
+        return;
+    }
+
+    int32 numSplit = 0;
+    int32 numChunks = 0;
+    for (FRuntimeMeshImportMeshInfo& meshInfo : meshInfos)
+    {
+        const bool bNeedsSplit = meshInfo.sections.ContainsByPredicate([&param](const FRuntimeMeshImportSectionInfo& section) {
+            return FMeshSectionSplitter::NeedsSplit(section, param.splitSectionVertexLimit, param.splitSectionTriangleLimit);
+        });
+        if (!bNeedsSplit)
+        {
+            continue;
+        }
+
+        // The chunks take the place of their section
+        TArray<FRuntimeMeshImportSectionInfo> sections;
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            if (FMeshSectionSplitter::NeedsSplit(section, param.splitSectionVertexLimit, param.splitSectionTriangleLimit))
+            {
+                const int32 firstChunk = sections.Num();
+                FMeshSectionSplitter::Split(section, param.splitSectionVertexLimit, param.splitSectionTriangleLimit, param.bParallelMeshConversion, sections);
+                // The lines and points are not split, they stay with the first chunk
+                if (sections.Num() > firstChunk)
+                {
+                    sections[firstChunk].linesAndPoints = MoveTemp(section.linesAndPoints);
+                }
+                section = FRuntimeMeshImportSectionInfo();
+                ++numSplit;
+                numChunks += sections.Num() - firstChunk;
+            }
+            else
+            {
+                sections.Add(MoveTemp(section));
+            }
+        }
+        meshInfo.sections = MoveTemp(sections);
+    }
+    if (numSplit > 0)
+    {
+        RMIE_LOG(Log, "Split %d sections into %d chunks.", numSplit, numChunks);
+    }
+}
+
+// Welds the vertices of every section of 'meshInfos' in parallel, when 'param' asks for it
+void WeldMeshSections(const FRuntimeMeshImportParam& param, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos)
+{
+    if (!param.bWeldVertices)
+    {
+        return;
+    }
+
+    TArray<FRuntimeMeshImportSectionInfo*> sections;
+    for (FRuntimeMeshImportMeshInfo& meshInfo : meshInfos)
+    {
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            sections.Add(&section);
+        }
+    }
+
+    FThreadSafeCounter numWelded;
+    ParallelFor(sections.Num(), [&param, &sections, &numWelded](int32 sectionIndex)
+    {
+        numWelded.Add(FMeshOptimizer::WeldVertices(*sections[sectionIndex], param.weldPositionTolerance, param.weldNormalTolerance, param.weldUVTolerance));
+    }, !param.bParallelMeshConversion);
+    RMIE_LOG(Log, "Welded %d vertices of %d sections.", numWelded.GetValue(), sections.Num());
+}
+
+// Generates the lightmap UVs of every section of 'meshInfos' in parallel, when 'param' asks for it. Before the LODs, they simplify UV1 along.
+void GenerateMeshLightmapUVs(const FRuntimeMeshImportParam& param, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos)
+{
+    if (!param.bGenerateLightmapUVs)
+    {
+        return;
+    }
+
+    TArray<FRuntimeMeshImportSectionInfo*> sections;
+    for (FRuntimeMeshImportMeshInfo& meshInfo : meshInfos)
+    {
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            sections.Add(&section);
+        }
+    }
+
+    ParallelFor(sections.Num(), [&param, &sections](int32 sectionIndex)
+    {
+        FLightmapUVGenerator::GenerateLightmapUVs(*sections[sectionIndex], param.lightmapResolution, param.lightmapPadding);
+    }, !param.bParallelMeshConversion);
+}
+
+// Whether the import generates the missing smooth normals itself, @see FRuntimeMeshImportParam::bMikkTSpaceTangents
+bool ShouldGenerateNormals(const FRuntimeMeshImportParam& param)
+{
+    const FRuntimeMeshImportPostProcessParam& postProcess = param.postProcess;
+    const bool bSmoothNormals = postProcess.preset == ERuntimeMeshImportPostProcessPreset::Quality
+        || (postProcess.preset == ERuntimeMeshImportPostProcessPreset::Custom && postProcess.bGenSmoothNormals);
+    return param.bMikkTSpaceTangents && bSmoothNormals
+        && (param.vertexAttributes & int32(ERuntimeMeshImportVertexAttributes::Normals | ERuntimeMeshImportVertexAttributes::Tangents)) != 0;
+}
+
+// Whether the import generates the missing tangents itself, @see FRuntimeMeshImportParam::bMikkTSpaceTangents
+bool ShouldGenerateTangents(const FRuntimeMeshImportParam& param)
+{
+    const FRuntimeMeshImportPostProcessParam& postProcess = param.postProcess;
+    const bool bCalcTangents = postProcess.preset == ERuntimeMeshImportPostProcessPreset::Quality
+        || (postProcess.preset == ERuntimeMeshImportPostProcessPreset::Custom && postProcess.bCalcTangentSpace);
+    return param.bMikkTSpaceTangents && bCalcTangents && (param.vertexAttributes & int32(ERuntimeMeshImportVertexAttributes::Tangents)) != 0;
+}
+
+/**
+ * Generates the normals and MikkTSpace tangents of the sections that have none, in parallel, instead of the Assimp post processing.
+ * Before the merge steps, a merged section zero fills the streams of the sections that do not have them.
+ */
+void GenerateMeshTangents(const FRuntimeMeshImportParam& param, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos)
+{
+    const bool bGenerateNormals = ShouldGenerateNormals(param);
+    const bool bGenerateTangents = ShouldGenerateTangents(param);
+    if (!bGenerateNormals && !bGenerateTangents)
+    {
+        return;
+    }
+
+    TArray<FRuntimeMeshImportSectionInfo*> sections;
+    for (FRuntimeMeshImportMeshInfo& meshInfo : meshInfos)
+    {
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            sections.Add(&section);
+        }
+    }
+
+    const bool bImportNormals = (param.vertexAttributes & int32(ERuntimeMeshImportVertexAttributes::Normals)) != 0;
+    ParallelFor(sections.Num(), [&param, &sections, bGenerateNormals, bGenerateTangents, bImportNormals](int32 sectionIndex)
+    {
+        FRuntimeMeshImportSectionInfo& section = *sections[sectionIndex];
+        // The conversions zero fill the normals of the meshes that have none
+        const bool bHasNormals = section.normals.Num() == section.vertices.Num() && section.vertices.Num() > 0
+            && section.normals.ContainsByPredicate([](const FVector& normal) { return !normal.IsNearlyZero(); });
+        if (bGenerateNormals && !bHasNormals)
+        {
+            FMeshTangentGenerator::GenerateSmoothNormals(section, param.postProcess.smoothingAngle);
+        }
+        if (bGenerateTangents && section.tangents.Num() != section.vertices.Num())
+        {
+            FMeshTangentGenerator::GenerateMikkTSpaceTangents(section);
+        }
+        // The normals were only generated for the tangents
+        if (!bImportNormals)
+        {
+            section.normals.Empty();
+        }
+    }, !param.bParallelMeshConversion);
+}
+
+// Runs FMeshOptimizer on every section and LOD section of 'meshInfos' in parallel, when 'param' asks for it
+void OptimizeMeshSections(const FRuntimeMeshImportParam& param, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos)
+{
+    if (!param.bOptimizeSections)
+    {
+        return;
+    }
+
+    TArray<FRuntimeMeshImportSectionInfo*> sections;
+    for (FRuntimeMeshImportMeshInfo& meshInfo : meshInfos)
+    {
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            sections.Add(&section);
+        }
+        for (FRuntimeMeshImportMeshLOD& lod : meshInfo.lods)
+        {
+            for (FRuntimeMeshImportSectionInfo& section : lod.sections)
+            {
+                sections.Add(&section);
+            }
+        }
+    }
+
+    ParallelFor(sections.Num(), [&param, &sections](int32 sectionIndex)
+    {
+        FMeshOptimizer::OptimizeSection(*sections[sectionIndex], param.vertexCacheSize, param.bOptimizeOverdraw);
+    }, !param.bParallelMeshConversion);
+}
+
+// Builds the BVHs of the sections of 'meshInfos' in parallel, when 'param' asks for it. LODs get none, they are for rendering only.
+void BuildMeshBVHs(const FRuntimeMeshImportParam& param, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos)
+{
+    if (!param.bBuildBVH)
+    {
+        return;
+    }
+
+    TArray<FRuntimeMeshImportSectionInfo*> sections;
+    for (FRuntimeMeshImportMeshInfo& meshInfo : meshInfos)
+    {
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            sections.Add(&section);
+        }
+    }
+
+    // The sections are built in parallel, so each build only splits its own subtrees further when there are few sections
+    const bool bParallelSubtrees = param.bParallelMeshConversion && sections.Num() < FTaskGraphInterface::Get().GetNumWorkerThreads();
+    ParallelFor(sections.Num(), [&param, &sections, bParallelSubtrees](int32 sectionIndex)
+    {
+        sections[sectionIndex]->bvh = FRuntimeMeshImportBVH::Build(*sections[sectionIndex], param.bvhMaxLeafTriangles, bParallelSubtrees);
+    }, !param.bParallelMeshConversion);
+}
+
+// Prepares FRuntimeMeshImportMeshInfo::collision for every mesh in parallel, when 'param' asks for it. Only the cooking is left then.
+void BuildMeshCollision(const FRuntimeMeshImportParam& param, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos)
+{
+    if (param.collision == ERuntimeMeshImportCollision::None)
+    {
+        return;
+    }
+
+    ParallelFor(meshInfos.Num(), [&param, &meshInfos](int32 meshIndex)
+    {
+        FRuntimeMeshImportMeshInfo& meshInfo = meshInfos[meshIndex];
+        meshInfo.collision = FRuntimeMeshImportCollision();
+        if (param.collision == ERuntimeMeshImportCollision::SimplifiedTrimesh)
+        {
+            FMeshCollisionBuilder::BuildSimplifiedTrimesh(meshInfo, param.collisionTriangleRatio, meshInfo.collision);
+        }
+        else
+        {
+            FMeshCollisionBuilder::BuildConvexDecomposition(meshInfo, param.maxConvexHulls, param.maxConvexHullVertices, meshInfo.collision);
+        }
+    }, !param.bParallelMeshConversion);
+}
+
+// Computes FRuntimeMeshImportMeshInfo::geometryHash for every mesh in parallel, when 'param' asks for it
+void HashMeshGeometry(const FRuntimeMeshImportParam& param, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos)
+{
+    if (!param.bHashGeometry)
+    {
+        return;
+    }
+
+    ParallelFor(meshInfos.Num(), [&param, &meshInfos](int32 meshIndex)
+    {
+        meshInfos[meshIndex].geometryHash = FMeshGeometryHash::HashMeshInfo(meshInfos[meshIndex], param.geometryHashPrecision);
+    }, !param.bParallelMeshConversion);
+}
+
+/**
+ * Merges the mesh infos of an instanced import with the same geometry hash and materials into the first of them,
+ * which gets the instance transforms of all. The nodes of a hierarchy import are pointed to the merged mesh info.
+ * The nodes share mesh infos already when they use the same meshes of the scene, this finds the copies of a part the file stores as different meshes.
+ */
+void DeduplicateMeshInfos(const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& result)
+{
+    if (!param.bHashGeometry || !param.bImportInstanced)
+    {
+        return;
+    }
+
+    TMultiMap<int64, int32> hashedMeshInfos;
+    TArray<int32> meshInfoRemap;
+    meshInfoRemap.SetNum(result.meshInfos.Num());
+    int32 numKept = 0;
+    for (int32 meshIndex = 0; meshIndex < result.meshInfos.Num(); ++meshIndex)
+    {
+        FRuntimeMeshImportMeshInfo& meshInfo = result.meshInfos[meshIndex];
+        TArray<int32, TInlineAllocator<4>> candidates;
+        hashedMeshInfos.MultiFind(meshInfo.geometryHash, candidates);
+        const int32* keptIndex = candidates.FindByPredicate([&result, &meshInfo](const int32 candidate) {
+            return FMeshGeometryHash::HasSameMaterials(result.meshInfos[candidate], meshInfo);
+        });
+        if (keptIndex)
+        {
+            // The kept mesh infos are moved to the front, the map has their new index
+            result.meshInfos[*keptIndex].instanceTransforms.Append(meshInfo.instanceTransforms);
+            meshInfoRemap[meshIndex] = *keptIndex;
+            continue;
+        }
+        if (numKept != meshIndex)
+        {
+            result.meshInfos[numKept] = MoveTemp(meshInfo);
+        }
+        hashedMeshInfos.Add(result.meshInfos[numKept].geometryHash, numKept);
+        meshInfoRemap[meshIndex] = numKept;
+        ++numKept;
+    }
+    if (numKept == result.meshInfos.Num())
+    {
+        return;
+    }
+
+    RMIE_LOG(Log, "Merged %d meshes with the same geometry into the instances of others.", result.meshInfos.Num() - numKept);
+    result.meshInfos.SetNum(numKept);
+    for (FRuntimeMeshImportNode& node : result.nodes)
+    {
+        if (node.meshInfoIndex != INDEX_NONE)
+        {
+            node.meshInfoIndex = meshInfoRemap[node.meshInfoIndex];
+        }
+    }
+}
+
+// Moves the center of 'bounds' to the origin and scales it to fit into a 100cm cube, @see FRuntimeMeshImportParam::bNormalizeScene
+FTransform GetNormalizeTransform(const FBox& bounds)
+{
+    const float scaleFactor = 50.f / FMath::Max(bounds.GetExtent().GetMax(), SMALL_NUMBER);
+    const FVector offset = -bounds.GetCenter();
+    return FTransform(offset) * FTransform(FQuat::Identity, FVector::ZeroVector, FVector(scaleFactor));
+}
+
+void ComposeMeshBounds(FRuntimeMeshImportMeshInfo& meshInfo)
+{
+    meshInfo.bounds = FBox(ForceInit);
+    for (const FRuntimeMeshImportSectionInfo& sectionInfo : meshInfo.sections)
+    {
+        meshInfo.bounds += sectionInfo.bounds;
+    }
+}
+
+/**
+ * The scene that Assimp imported, converted by ConvertSceneSource.
+ * The node tree is flattened, so the meshes of all nodes can be converted independent of each other.
+ */
+struct FAssimpSceneSource
+{
+    Assimp::Importer& importer;
+    const aiScene* scene;
+    const uint32 vertexAttributes;
+    const bool bLinesAndPoints;
+    const FTransform sceneTransform;
+    FAssimpSceneNodeCache nodeCache;
+
+    FAssimpSceneSource(Assimp::Importer& inImporter, const FTransform& inSceneTransform, const uint32 inVertexAttributes, const bool bInLinesAndPoints)
+        : importer(inImporter), scene(inImporter.GetScene()), vertexAttributes(inVertexAttributes), bLinesAndPoints(bInLinesAndPoints), sceneTransform(inSceneTransform)
+    {
+        // The user transform is applied to the root node, so all composed transforms contain it
+        nodeCache.Build(scene->mRootNode, sceneTransform);
+    }
+
+    bool HasMeshes() const
+    {
+        return scene->HasMeshes();
+    }
+
+    int32 NumNodes() const
+    {
+        return nodeCache.Num();
+    }
+
+    FName GetNodeName(const int32 nodeIndex) const
+    {
+        return FName(nodeCache.nodes[nodeIndex]->mName.C_Str());
+    }
+
+    int32 GetParentIndex(const int32 nodeIndex) const
+    {
+        return nodeCache.parentIndices[nodeIndex];
+    }
+
+    FTransform GetLocalTransform(const int32 nodeIndex) const
+    {
+        return URuntimeMeshImportExportLibrary::AiTransformToFTransform(nodeCache.nodes[nodeIndex]->mTransformation);
+    }
+
+    const TArray<FTransform>& GetComposedTransforms() const
+    {
+        return nodeCache.composedTransforms;
+    }
+
+    // The indices of the scene meshes of the node
+    TArrayView<const uint32> GetNodeMeshes(const int32 nodeIndex) const
+    {
+        const aiNode* node = nodeCache.nodes[nodeIndex];
+        return TArrayView<const uint32>(node->mMeshes, node->mNumMeshes);
+    }
+
+    // With 'bParallelVertices' a large mesh is split into chunks of vertices, for scenes with fewer meshes than worker threads
+    FBox ComputeMeshBounds(const int32 nodeIndex, const uint32 nodeMeshIndex, const FMatrix& matrix, const bool bParallelVertices) const
+    {
+        const aiMesh* mesh = scene->mMeshes[nodeCache.nodes[nodeIndex]->mMeshes[nodeMeshIndex]];
+        return FMeshConversionKernels::ComputeTransformedBounds(matrix, FMeshConversionKernels::AsFVector(mesh->mVertices), mesh->mNumVertices, bParallelVertices);
+    }
+
+    // The faces are sorted by primitive type, a mesh with triangles has no other faces
+    void GetMeshCounts(const int32 nodeIndex, const uint32 nodeMeshIndex, int64& outVertices, int64& outTriangles) const
+    {
+        const aiMesh* mesh = scene->mMeshes[nodeCache.nodes[nodeIndex]->mMeshes[nodeMeshIndex]];
+        outVertices = mesh->mNumVertices;
+        outTriangles = (mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) ? mesh->mNumFaces : 0;
+    }
+
+    int32 NumMaterials() const
+    {
+        return scene->mNumMaterials;
+    }
+
+    void ConvertMesh(const int32 nodeIndex, const uint32 nodeMeshIndex, const FTransform& transform, const bool bParallelVertices, FRuntimeMeshImportSectionInfo& sectionInfo) const
+    {
+        ImportMeshOfNode(scene, nodeCache.nodes[nodeIndex], nodeMeshIndex, transform, vertexAttributes, bParallelVertices, bLinesAndPoints, sectionInfo);
+    }
+
+    void BuildSkeleton(TArray<FRuntimeMeshImportBone>& outBones, TMap<FName, int32>& outBoneIndices) const
+    {
+        FAssimpSkinningImport::BuildSkeleton(scene, outBones, outBoneIndices);
+    }
+
+    void ImportSkinWeights(const int32 nodeIndex, const uint32 nodeMeshIndex, const TMap<FName, int32>& boneIndices, const int32 maxInfluences, FRuntimeMeshImportSectionInfo& sectionInfo) const
+    {
+        const aiMesh* mesh = scene->mMeshes[nodeCache.nodes[nodeIndex]->mMeshes[nodeMeshIndex]];
+        FAssimpSkinningImport::ImportSkinWeights(mesh, boneIndices, maxInfluences, sectionInfo);
+    }
+
+    // For vertices baked with the composed node transforms and 'normalizeTransform'. Returns the transform the root bones were moved by.
+    FTransform MoveSkeletonToResultSpace(const FTransform& normalizeTransform, const TMap<FName, int32>& boneIndices, TArray<FRuntimeMeshImportBone>& bones) const
+    {
+        TArray<TPair<const aiMesh*, FTransform>> meshTransforms;
+        for (int32 nodeIndex = 0; nodeIndex < nodeCache.Num(); ++nodeIndex)
+        {
+            const aiNode* node = nodeCache.nodes[nodeIndex];
+            for (uint32 nodeMeshIndex = 0; nodeMeshIndex < node->mNumMeshes; ++nodeMeshIndex)
+            {
+                meshTransforms.Emplace(scene->mMeshes[node->mMeshes[nodeMeshIndex]], nodeCache.composedTransforms[nodeIndex] * normalizeTransform);
+            }
+        }
+        const FTransform sceneToResult = sceneTransform * normalizeTransform;
+        FAssimpSkinningImport::MoveSkeletonToResultSpace(meshTransforms, sceneToResult, boneIndices, bones);
+        return sceneToResult;
+    }
+
+    void ImportMorphTargets(const int32 nodeIndex, const uint32 nodeMeshIndex, const FTransform& transform, const float threshold, const bool bParallelVertices
+        , FRuntimeMeshImportSectionInfo& sectionInfo) const
+    {
+        const aiMesh* mesh = scene->mMeshes[nodeCache.nodes[nodeIndex]->mMeshes[nodeMeshIndex]];
+        FAssimpSkinningImport::ImportMorphTargets(mesh, transform, threshold, bParallelVertices, sectionInfo);
+    }
+
+    void ImportAnimations(const TMap<FName, int32>& boneIndices, const TMap<FName, int32>& nodeIndices, const float keyTolerance, TArray<FRuntimeMeshImportAnimation>& outAnimations) const
+    {
+        if (scene->HasAnimations())
+        {
+            FAssimpSkinningImport::ImportAnimations(scene, boneIndices, nodeIndices, keyTolerance, outAnimations);
+        }
+    }
+
+    void ImportMaterials(const FString& sceneFile, const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& result, const FRuntimeMeshImportExportProgressCoalescerRef& progress) const
+    {
+        if (scene->HasMaterials())
+        {
+            ImportSceneMaterials(sceneFile, scene, param, result, progress);
+        }
+    }
+
+    // Nothing reads the scene anymore. Freed by Assimp, it has to be released by the heap that allocated it.
+    void Free()
+    {
+        importer.FreeScene();
+        scene = nullptr;
+    }
+};
+
+/**
+ * A scene read without Assimp, by FRuntimeMeshGltfScene or FRuntimeMeshTextScene, converted by ConvertSceneSource.
+ * The meshes of a node are its primitives. Skinning is not read, the import falls back to Assimp for it.
+ */
+template<typename NativeScene>
+struct TNativeSceneSource
+{
+    typedef typename NativeScene::FNode FNode;
+
+    const NativeScene& scene;
+    const bool bCalcTangents;
+    const uint32 vertexAttributes;
+    // Generates the normals of the primitives that have none, like aiProcess_GenSmoothNormals, otherwise they are zero filled
+    const bool bGenerateNormals;
+    const float smoothingAngle;
+    TArray<FTransform> composedTransforms;
+
+    TNativeSceneSource(const NativeScene& inScene, const FTransform& sceneTransform, const bool bInCalcTangents, const uint32 inVertexAttributes
+        , const bool bInGenerateNormals, const float inSmoothingAngle)
+        : scene(inScene), bCalcTangents(bInCalcTangents), vertexAttributes(inVertexAttributes), bGenerateNormals(bInGenerateNormals), smoothingAngle(inSmoothingAngle)
+    {
+        // Parents are stored before their children
+        const TArray<FNode>& nodes = scene.GetNodes();
+        composedTransforms.SetNum(nodes.Num());
+        for (int32 nodeIndex = 0; nodeIndex < nodes.Num(); ++nodeIndex)
+        {
+            const FNode& node = nodes[nodeIndex];
+            composedTransforms[nodeIndex] = node.localTransform * (node.parentIndex == INDEX_NONE ? sceneTransform : composedTransforms[node.parentIndex]);
+        }
+    }
+
+    bool HasMeshes() const
+    {
+        for (const FNode& node : scene.GetNodes())
+        {
+            if (node.primitives.Num() > 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int32 NumNodes() const
+    {
+        return scene.GetNodes().Num();
+    }
+
+    FName GetNodeName(const int32 nodeIndex) const
+    {
+        return scene.GetNodes()[nodeIndex].name;
+    }
+
+    int32 GetParentIndex(const int32 nodeIndex) const
+    {
+        return scene.GetNodes()[nodeIndex].parentIndex;
+    }
+
+    FTransform GetLocalTransform(const int32 nodeIndex) const
+    {
+        return scene.GetNodes()[nodeIndex].localTransform;
+    }
+
+    const TArray<FTransform>& GetComposedTransforms() const
+    {
+        return composedTransforms;
+    }
+
+    TArrayView<const uint32> GetNodeMeshes(const int32 nodeIndex) const
+    {
+        return scene.GetNodes()[nodeIndex].primitives;
+    }
+
+    // The primitives are converted whole, the format readers do not split them
+    FBox ComputeMeshBounds(const int32 nodeIndex, const uint32 nodeMeshIndex, const FMatrix& matrix, const bool bParallelVertices) const
+    {
+        return scene.ComputePrimitiveBounds(scene.GetNodes()[nodeIndex].primitives[nodeMeshIndex], matrix);
+    }
+
+    void GetMeshCounts(const int32 nodeIndex, const uint32 nodeMeshIndex, int64& outVertices, int64& outTriangles) const
+    {
+        scene.GetPrimitiveCounts(scene.GetNodes()[nodeIndex].primitives[nodeMeshIndex], outVertices, outTriangles);
+    }
+
+    int32 NumMaterials() const
+    {
+        return scene.NumMaterials();
+    }
+
+    void ConvertMesh(const int32 nodeIndex, const uint32 nodeMeshIndex, const FTransform& transform, const bool bParallelVertices, FRuntimeMeshImportSectionInfo& sectionInfo) const
+    {
+        const bool bImportTangents = (vertexAttributes & uint32(ERuntimeMeshImportVertexAttributes::Tangents)) != 0;
+        scene.ConvertPrimitive(scene.GetNodes()[nodeIndex].primitives[nodeMeshIndex], transform, bCalcTangents && bImportTangents, sectionInfo);
+        if (sectionInfo.normals.Num() != sectionInfo.vertices.Num())
+        {
+            if (bGenerateNormals)
+            {
+                FMeshTangentGenerator::GenerateSmoothNormals(sectionInfo, smoothingAngle);
+                // The primitive had no normals to calculate its tangents from
+                if (bCalcTangents && bImportTangents && sectionInfo.uv0.Num() == sectionInfo.vertices.Num())
+                {
+                    FMeshTangentGenerator::GenerateMikkTSpaceTangents(sectionInfo);
+                }
+            }
+            else
+            {
+                sectionInfo.normals.SetNumZeroed(sectionInfo.vertices.Num());
+            }
+        }
+        // The accessors are read as a whole, the streams that are not imported are dropped after
+        if (!(vertexAttributes & uint32(ERuntimeMeshImportVertexAttributes::Normals)))
+        {
+            sectionInfo.normals.Empty();
+        }
+        if (!(vertexAttributes & uint32(ERuntimeMeshImportVertexAttributes::UV0)))
+        {
+            sectionInfo.uv0.Empty();
+        }
+        if (!bImportTangents)
+        {
+            sectionInfo.tangents.Empty();
+        }
+        if (!(vertexAttributes & uint32(ERuntimeMeshImportVertexAttributes::VertexColors)))
+        {
+            sectionInfo.vertexColors.Empty();
+        }
+    }
+
+    void BuildSkeleton(TArray<FRuntimeMeshImportBone>& outBones, TMap<FName, int32>& outBoneIndices) const
+    {
+    }
+
+    void ImportSkinWeights(const int32 nodeIndex, const uint32 nodeMeshIndex, const TMap<FName, int32>& boneIndices, const int32 maxInfluences, FRuntimeMeshImportSectionInfo& sectionInfo) const
+    {
+    }
+
+    FTransform MoveSkeletonToResultSpace(const FTransform& normalizeTransform, const TMap<FName, int32>& boneIndices, TArray<FRuntimeMeshImportBone>& bones) const
+    {
+        return FTransform::Identity;
+    }
+
+    // The native formats have no blend shapes
+    void ImportMorphTargets(const int32 nodeIndex, const uint32 nodeMeshIndex, const FTransform& transform, const float threshold, const bool bParallelVertices
+        , FRuntimeMeshImportSectionInfo& sectionInfo) const
+    {
+    }
+
+    void ImportAnimations(const TMap<FName, int32>& boneIndices, const TMap<FName, int32>& nodeIndices, const float keyTolerance, TArray<FRuntimeMeshImportAnimation>& outAnimations) const
+    {
+    }
+
+    // Like ImportSceneMaterials, the external images are read after all materials were extracted
+    void ImportMaterials(const FString& sceneFile, const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& result, const FRuntimeMeshImportExportProgressCoalescerRef& progress) const
+    {
+        const int32 numMaterials = scene.NumMaterials();
+        result.materialInfos.SetNum(numMaterials);
+        TArray<TArray<FPendingTextureRead>> pendingReads;
+        pendingReads.SetNum(numMaterials);
+        FThreadSafeCounter materialCounter;
+        ParallelFor(numMaterials, [this, &sceneFile, &param, &result, &pendingReads, &materialCounter, numMaterials, &progress](int32 materialIndex)
+        {
+            FRuntimeMeshImportMaterialInfo& materialInfo = result.materialInfos[materialIndex];
+            TArray<TPair<int32, FString>> textureUris;
+            scene.ImportMaterial(materialIndex, materialInfo, textureUris);
+            // The uris are in the order of their textures, each texture that is removed shifts the ones after it
+            int32 numRemoved = 0;
+            for (const TPair<int32, FString>& textureUri : textureUris)
+            {
+                const int32 textureIndex = textureUri.Key - numRemoved;
+                if (!AddPendingTextureRead(sceneFile, textureUri.Value, textureIndex, materialInfo, pendingReads[materialIndex]))
+                {
+                    RMIE_LOG(Error, "Failed to import Texture %s for Material %s", *materialInfo.textures[textureIndex].name.ToString(), *materialInfo.name.ToString());
+                    materialInfo.textures.RemoveAt(textureIndex);
+                    ++numRemoved;
+                }
+            }
+            SetTextureCompression(param, materialInfo);
+            progress->Send_AnyThread(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ImportingMaterials, materialCounter.Increment(), numMaterials));
+        });
+
+        const double startTimeTextures = FPlatformTime::Seconds();
+        ReadPendingTextures(param, pendingReads, result.materialInfos, result.metrics);
+        result.timings.textureSeconds = float(FPlatformTime::Seconds() - startTimeTextures);
+    }
+
+    // The scene is owned by the caller
+    void Free()
+    {
+    }
+};
+
+/**
+ * Sends a box around each mesh of 'meshInfos' to 'callbackMeshReady', @see FRuntimeMeshImportParam::bStreamProxies.
+ * The bounds come from a read only pass over the source positions of 'workItems', in the space the meshes are converted to.
+ */
+template<typename SceneSource, typename WorkItem>
+void SendMeshProxies(const SceneSource& source, const FRuntimeMeshImportParam& param, const TArray<FTransform>& nodeTransforms, const bool bMeshSpace
+    , const TArray<FRuntimeMeshImportMeshInfo>& meshInfos, const TArray<WorkItem>& workItems, const FRuntimeImportMeshReady& callbackMeshReady)
+{
+    TArray<FBox> workItemBounds;
+    workItemBounds.SetNum(workItems.Num());
+    const bool bParallelVertices = param.bParallelMeshConversion && workItems.Num() < FTaskGraphInterface::Get().GetNumWorkerThreads();
+    ParallelFor(workItems.Num(), [&source, &nodeTransforms, &workItems, &workItemBounds, bMeshSpace, bParallelVertices](int32 workIndex)
+    {
+        const WorkItem& workItem = workItems[workIndex];
+        const FMatrix matrix = bMeshSpace ? FMatrix::Identity : nodeTransforms[workItem.nodeIndex].ToMatrixWithScale();
+        workItemBounds[workIndex] = source.ComputeMeshBounds(workItem.nodeIndex, workItem.nodeMeshIndex, matrix, bParallelVertices);
+    }, !param.bParallelMeshConversion);
+
+    TArray<FBox> meshBounds;
+    meshBounds.Init(FBox(ForceInit), meshInfos.Num());
+    for (int32 workIndex = 0; workIndex < workItems.Num(); ++workIndex)
+    {
+        meshBounds[workItems[workIndex].meshInfoIndex] += workItemBounds[workIndex];
+    }
+
+    for (int32 meshInfoIndex = 0; meshInfoIndex < meshInfos.Num(); ++meshInfoIndex)
+    {
+        const FBox& bounds = meshBounds[meshInfoIndex];
+        if (!bounds.IsValid)
+        {
+            continue;
+        }
+
+        FRuntimeMeshImportMeshInfo proxy;
+        proxy.meshName = meshInfos[meshInfoIndex].meshName;
+        proxy.instanceTransforms = meshInfos[meshInfoIndex].instanceTransforms;
+        proxy.bounds = bounds;
+        proxy.streamingIndex = meshInfoIndex;
+        proxy.bIsProxy = true;
+
+        FRuntimeMeshImportSectionInfo& section = proxy.sections.AddDefaulted_GetRef();
+        section.materialIndex = INDEX_NONE;
+        TArray<FProcMeshTangent> tangents;
+        UKismetProceduralMeshLibrary::GenerateBoxMesh(bounds.GetExtent(), section.vertices, section.triangles, section.normals, section.uv0, tangents);
+        const FVector center = bounds.GetCenter();
+        for (FVector& vertex : section.vertices)
+        {
+            vertex += center;
+        }
+        URuntimeMeshImportExportLibrary::ConvertProceduralMeshTangentToVector(tangents, section.tangents);
+        section.bounds = bounds;
+
+        AsyncTask(ENamedThreads::GameThread, [callbackMeshReady, proxy = MoveTemp(proxy)]() mutable -> void
+        {
+            callbackMeshReady.ExecuteIfBound(MoveTemp(proxy));
+        });
+    }
+}
+
+/**
+ * Chooses the params of ERuntimeMeshImportProfile::Auto from the counts of the scene, no vertex is read for it.
+ * Instancing pays off when the nodes reference the same meshes many times, merging when there are many meshes,
+ * clusters when the merged scene is large enough to be culled in parts.
+ */
+template<typename SceneSource>
+void ChooseAutoImportProfile(const SceneSource& source, const FString& sceneFile, const bool bStreaming, FRuntimeMeshImportParam& param, FRuntimeMeshImportMetrics& metrics)
+{
+    // The triangles of all instances per triangle of the distinct meshes from which instancing is chosen
+    const double instancingRatio = 2.0;
+    // More vertices per triangle are a triangle soup, e.g. STL, that welding shrinks to about a sixth
+    const double soupVerticesPerTriangle = 2.0;
+
+    const double startTime = FPlatformTime::Seconds();
+    param.importProfile = ERuntimeMeshImportProfile::Manual;
+
+    int32 numMeshInstances = 0;
+    int64 numVertices = 0;
+    int64 numTriangles = 0;
+    int64 numDistinctTriangles = 0;
+    int64 maxMeshVertices = 0;
+    // Nodes with the same meshes, like the instancing of the conversion
+    TSet<TArray<uint32>> distinctMeshes;
+    for (int32 nodeIndex = 0; nodeIndex < source.NumNodes(); ++nodeIndex)
+    {
+        const TArrayView<const uint32> nodeMeshes = source.GetNodeMeshes(nodeIndex);
+        if (nodeMeshes.Num() == 0 || !IsNodeImported(param, source.GetNodeName(nodeIndex)))
+        {
+            continue;
+        }
+        int64 nodeVertices = 0;
+        int64 nodeTriangles = 0;
+        for (int32 nodeMeshIndex = 0; nodeMeshIndex < nodeMeshes.Num(); ++nodeMeshIndex)
+        {
+            int64 meshVertices = 0;
+            int64 meshTriangles = 0;
+            source.GetMeshCounts(nodeIndex, uint32(nodeMeshIndex), meshVertices, meshTriangles);
+            nodeVertices += meshVertices;
+            nodeTriangles += meshTriangles;
+        }
+        ++numMeshInstances;
+        numVertices += nodeVertices;
+        numTriangles += nodeTriangles;
+
+        bool bAlreadyInSet = false;
+        distinctMeshes.Add(TArray<uint32>(nodeMeshes.GetData(), nodeMeshes.Num()), &bAlreadyInSet);
+        if (!bAlreadyInSet)
+        {
+            numDistinctTriangles += nodeTriangles;
+            maxMeshVertices = FMath::Max(maxMeshVertices, nodeVertices);
+        }
+    }
+    const int32 numMaterials = source.NumMaterials();
+
+    // Merging needs the meshes in scene space and the skinning and morph targets per mesh
+    const bool bKeepMeshes = bStreaming || param.bImportHierarchy || param.bImportSkinning || param.bImportMorphTargets;
+    param.bImportInstanced = !param.bImportSkinning && numDistinctTriangles > 0 && double(numTriangles) >= instancingRatio * double(numDistinctTriangles);
+    if (param.bImportInstanced || bKeepMeshes || numMeshInstances <= 1)
+    {
+        param.importMethodMesh = EImportMethodMesh::Keep;
+    }
+    else
+    {
+        param.importMethodMesh = numTriangles > int64(param.clusterTargetTriangles) * 4 ? EImportMethodMesh::MergeByCluster : EImportMethodMesh::Merge;
+    }
+    // Merge skips the materials, so it is only chosen when they are not wanted. A single material gives one section per mesh with MergeSameMaterial as well.
+    param.importMethodSection = param.bGeometryOnly ? EImportMethodSection::Merge : EImportMethodSection::MergeSameMaterial;
+    param.bWeldVertices = numTriangles > 0 && double(numVertices) > soupVerticesPerTriangle * double(numTriangles);
+    // The clusters are small already. Welded sections are estimated by the vertices they share.
+    const int64 weldedVertexFactor = param.bWeldVertices ? 6 : 1;
+    const int64 largestSectionVertices = (param.importMethodMesh == EImportMethodMesh::Merge ? numVertices / FMath::Max(numMaterials, 1) : maxMeshVertices) / weldedVertexFactor;
+    param.bSplitLargeSections = param.importMethodMesh != EImportMethodMesh::MergeByCluster && largestSectionVertices > param.splitSectionVertexLimit;
+
+    metrics.profileDecision = FString::Printf(TEXT("%d mesh instances of %d meshes, %lld triangles, %lld vertices, %d materials: importMethodMesh %s, importMethodSection %s, instanced %d, weld %d, split %d")
+        , numMeshInstances, distinctMeshes.Num(), numTriangles, numVertices, numMaterials
+        , *StaticEnum<EImportMethodMesh>()->GetNameStringByValue(int64(param.importMethodMesh))
+        , *StaticEnum<EImportMethodSection>()->GetNameStringByValue(int64(param.importMethodSection))
+        , int32(param.bImportInstanced), int32(param.bWeldVertices), int32(param.bSplitLargeSections));
+    metrics.profileSeconds = float(FPlatformTime::Seconds() - startTime);
+    RMIE_LOG(Log, "Auto import profile: %s. File: %s", *metrics.profileDecision, *sceneFile);
+}
+
+/**
+ * Converts the scene of 'source' to 'result', @see FAssimpSceneSource for the interface of a source.
+ * The source is freed as soon as everything is read from it, before the meshes are merged.
+ * Vertices in scene space are normalized while they are converted.
+ * @param sceneFile				The file of the scene, used to find external textures
+ * @param callbackMeshReady		When bound each mesh is moved to it on the GameThread as soon as its sections are converted
+ */
+template<typename SceneSource>
+void ConvertSceneSource(SceneSource& source, const FString& sceneFile, const FRuntimeMeshImportParam& param, const FRuntimeMeshImportExportProgressCoalescerRef& progress
+    , const FRuntimeImportMeshReady& callbackMeshReady, FRuntimeMeshImportResult& result)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportConvertScene);
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_ImportConversion);
+    const bool bStreaming = callbackMeshReady.IsBound();
+    if (param.importProfile == ERuntimeMeshImportProfile::Auto)
+    {
+        FRuntimeMeshImportParam autoParam = param;
+        ChooseAutoImportProfile(source, sceneFile, bStreaming, autoParam, result.metrics);
+        ConvertSceneSource(source, sceneFile, autoParam, progress, callbackMeshReady, result);
+        return;
+    }
+    if (bStreaming && (param.importMethodMesh != EImportMethodMesh::Keep || param.bNormalizeScene))
+    {
+        RMIE_LOG(Warning, "Merging meshes and normalizing the scene is not supported for a streaming import, ignoring it. File: %s", *sceneFile);
+    }
+    if (bStreaming && param.bAtlasMaterials)
+    {
+        RMIE_LOG(Warning, "Material atlases are not supported for a streaming import, the meshes are sent before the materials are imported. File: %s", *sceneFile);
+    }
+    // The meshes stay in their own space, placed by instance transforms or the node tree
+    const bool bMeshSpace = param.bImportInstanced || param.bImportHierarchy;
+    if (bMeshSpace && param.importMethodMesh != EImportMethodMesh::Keep)
+    {
+        RMIE_LOG(Warning, "Merging meshes is not supported for an instanced or hierarchy import, ignoring it. File: %s", *sceneFile);
+    }
+
+    bool bMeshImportSucces = false;
+    if (source.HasMeshes())
+    {
+        const int32 numNodes = source.NumNodes();
+        const TArray<FTransform>& nodeTransforms = source.GetComposedTransforms();
+
+        if (param.bImportHierarchy)
+        {
+            result.nodes.SetNum(numNodes);
+            for (int32 nodeIndex = 0; nodeIndex < numNodes; ++nodeIndex)
+            {
+                FRuntimeMeshImportNode& resultNode = result.nodes[nodeIndex];
+                resultNode.name = source.GetNodeName(nodeIndex);
+                resultNode.parentIndex = source.GetParentIndex(nodeIndex);
+                // The composed transform of a root contains the user transform
+                resultNode.localTransform = resultNode.parentIndex == INDEX_NONE
+                    ? nodeTransforms[nodeIndex]
+                    : source.GetLocalTransform(nodeIndex);
+            }
+        }
+
+        // Resolved once, the parallel conversion below only reads the bone indices
+        TMap<FName, int32> boneIndices;
+        if (param.bImportSkinning)
+        {
+            source.BuildSkeleton(result.bones, boneIndices);
+        }
+
+        // Allocate the slots in the result up front. Each node with meshes gets a mesh info,
+        // each mesh of the node a section. The work items point to the section to fill.
+        // With instancing, nodes with the same meshes share a mesh info that is converted once, in the space of the meshes.
+        struct FSectionWorkItem
+        {
+            int32 nodeIndex;
+            int32 meshInfoIndex;
+            uint32 nodeMeshIndex;
+        };
+        TArray<FSectionWorkItem> workItems;
+        TMap<TArray<uint32>, int32> instancedMeshInfos;
+        for (int32 nodeIndex = 0; nodeIndex < numNodes; ++nodeIndex)
+        {
+            const TArrayView<const uint32> nodeMeshes = source.GetNodeMeshes(nodeIndex);
+            const FName nodeName = source.GetNodeName(nodeIndex);
+            if (nodeMeshes.Num() == 0)
+            {
+                RMIE_LOG(Log, "Mesh has no sections, not adding it as mesh to the result. Node: %s", *nodeName.ToString());
+                continue;
+            }
+            if (!IsNodeImported(param, nodeName))
+            {
+                continue;
+            }
+
+            if (param.bImportInstanced)
+            {
+                TArray<uint32> sceneMeshIndices(nodeMeshes.GetData(), nodeMeshes.Num());
+                if (const int32* existingMeshInfoIndex = instancedMeshInfos.Find(sceneMeshIndices))
+                {
+                    result.meshInfos[*existingMeshInfoIndex].instanceTransforms.Add(nodeTransforms[nodeIndex]);
+                    if (param.bImportHierarchy)
+                    {
+                        result.nodes[nodeIndex].meshInfoIndex = *existingMeshInfoIndex;
+                    }
+                    continue;
+                }
+                instancedMeshInfos.Add(MoveTemp(sceneMeshIndices), result.meshInfos.Num());
+            }
+
+            RMIE_LOG(Log, "Importing %d sections for mesh: %s", nodeMeshes.Num(), *nodeName.ToString());
+
+            const int32 meshInfoIndex = result.meshInfos.AddDefaulted();
+            FRuntimeMeshImportMeshInfo& meshInfoRef = result.meshInfos[meshInfoIndex];
+            meshInfoRef.meshName = nodeName;
+            meshInfoRef.sections.SetNum(nodeMeshes.Num());
+            if (param.bImportInstanced)
+            {
+                meshInfoRef.instanceTransforms.Add(nodeTransforms[nodeIndex]);
+            }
+            if (param.bImportHierarchy)
+            {
+                result.nodes[nodeIndex].meshInfoIndex = meshInfoIndex;
+            }
+
+            for (int32 nodeMeshIndex = 0; nodeMeshIndex < nodeMeshes.Num(); ++nodeMeshIndex)
+            {
+                workItems.Add({ nodeIndex, meshInfoIndex, static_cast<uint32>(nodeMeshIndex) });
+            }
+        }
+
+        // For streaming, the section that finishes the mesh last hands the mesh over
+        TArray<FThreadSafeCounter> remainingSections;
+        if (bStreaming)
+        {
+            remainingSections.SetNum(result.meshInfos.Num());
+            for (int32 meshInfoIndex = 0; meshInfoIndex < result.meshInfos.Num(); ++meshInfoIndex)
+            {
+                remainingSections[meshInfoIndex].Set(result.meshInfos[meshInfoIndex].sections.Num());
+            }
+        }
+
+        if (bStreaming && param.bStreamProxies)
+        {
+            SendMeshProxies(source, param, nodeTransforms, bMeshSpace, result.meshInfos, workItems, callbackMeshReady);
+        }
+
+        // The sections are converted in parallel, so each section only splits its vertices further when there are few sections,
+        // e.g. a scan with a single mesh of many millions of vertices
+        const bool bParallelVertices = param.bParallelMeshConversion && workItems.Num() < FTaskGraphInterface::Get().GetNumWorkerThreads();
+
+        // With the vertices in scene space, the normalization is folded into the transforms of the conversion.
+        // Its bounds come from a read only pass over the source positions, so the vertices are only written once.
+        FTransform normalizeTransform = FTransform::Identity;
+        if (param.bNormalizeScene && !bStreaming && !bMeshSpace)
+        {
+            const double startTimeNormalize = FPlatformTime::Seconds();
+            TArray<FBox> workItemBounds;
+            workItemBounds.SetNum(workItems.Num());
+            ParallelFor(workItems.Num(), [&source, &nodeTransforms, &workItems, &workItemBounds, bParallelVertices](int32 workIndex)
+            {
+                const FSectionWorkItem& workItem = workItems[workIndex];
+                workItemBounds[workIndex] = source.ComputeMeshBounds(workItem.nodeIndex, workItem.nodeMeshIndex, nodeTransforms[workItem.nodeIndex].ToMatrixWithScale(), bParallelVertices);
+            }, !param.bParallelMeshConversion);
+
+            FBox totalBounds(ForceInit);
+            for (const FBox& bounds : workItemBounds)
+            {
+                totalBounds += bounds;
+            }
+            normalizeTransform = GetNormalizeTransform(totalBounds);
+            result.timings.normalizeSeconds = float(FPlatformTime::Seconds() - startTimeNormalize);
+        }
+
+        // The inverse bind transforms of Assimp are mesh space, they have to match the baked vertices
+        FTransform skeletonToResult = FTransform::Identity;
+        if (boneIndices.Num() > 0 && !bMeshSpace)
+        {
+            skeletonToResult = source.MoveSkeletonToResultSpace(normalizeTransform, boneIndices, result.bones);
+        }
+
+        // Import mesh data
+        const double startTimeConversion = FPlatformTime::Seconds();
+        FThreadSafeCounter sectionCounter;
+        FThreadSafeCounter64 numVertices;
+        FThreadSafeCounter64 numTriangles;
+        FThreadSafeCounter64 threadCycles;
+        const int32 numSections = workItems.Num();
+        const FRuntimeMeshImportExportCancellationToken& cancellationToken = param.cancellationToken;
+        ParallelFor(numSections, [&source, &nodeTransforms, &workItems, &result, &sectionCounter, numSections, &progress, &cancellationToken
+            , bStreaming, bMeshSpace, bParallelVertices, &normalizeTransform, &remainingSections, &param, &callbackMeshReady, &boneIndices
+            , &numVertices, &numTriangles, &threadCycles](int32 workIndex)
+        {
+            if (cancellationToken.IsCancelled())
+            {
+                return;
+            }
+            SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportConvertMesh);
+            RMIE_LLM_SCOPE(STAT_RMIE_LLM_ImportConversion);
+            FRuntimeMeshMetrics::FScopedThreadCycles scopedThreadCycles(threadCycles);
+            const FSectionWorkItem& workItem = workItems[workIndex];
+            FRuntimeMeshImportSectionInfo& sectionInfo = result.meshInfos[workItem.meshInfoIndex].sections[workItem.nodeMeshIndex];
+            const FTransform meshTransform = bMeshSpace ? FTransform::Identity : nodeTransforms[workItem.nodeIndex] * normalizeTransform;
+            source.ConvertMesh(workItem.nodeIndex, workItem.nodeMeshIndex, meshTransform, bParallelVertices, sectionInfo);
+            if (param.vertexColorSpace == ERuntimeMeshVertexColorSpace::SRGB)
+            {
+                FMeshConversionKernels::DecodeSRGBColors(sectionInfo.vertexColors.GetData(), sectionInfo.vertexColors.Num(), bParallelVertices);
+            }
+            INC_DWORD_STAT_BY(STAT_RMIE_ImportedVertices, sectionInfo.vertices.Num());
+            INC_DWORD_STAT_BY(STAT_RMIE_ImportedTriangles, sectionInfo.triangles.Num() / 3);
+            numVertices.Add(sectionInfo.vertices.Num());
+            numTriangles.Add(sectionInfo.triangles.Num() / 3);
+            if (boneIndices.Num() > 0)
+            {
+                source.ImportSkinWeights(workItem.nodeIndex, workItem.nodeMeshIndex, boneIndices, param.maxBoneInfluences, sectionInfo);
+            }
+            if (param.bImportMorphTargets)
+            {
+                source.ImportMorphTargets(workItem.nodeIndex, workItem.nodeMeshIndex, meshTransform, param.morphTargetThreshold, bParallelVertices, sectionInfo);
+            }
+            progress->Send_AnyThread(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ImportingMeshes, sectionCounter.Increment(), numSections));
+
+            if (bStreaming && remainingSections[workItem.meshInfoIndex].Decrement() == 0)
+            {
+                // Only this thread touches the mesh now, everything else writes to other meshes
+                FRuntimeMeshImportMeshInfo& meshInfo = result.meshInfos[workItem.meshInfoIndex];
+                meshInfo.streamingIndex = workItem.meshInfoIndex;
+                ComposeMeshBounds(meshInfo);
+                GenerateMeshTangents(param, MakeArrayView(&meshInfo, 1));
+                ApplyImportMethodSection(param.importMethodSection, meshInfo);
+                SplitMeshSections(param, MakeArrayView(&meshInfo, 1));
+                WeldMeshSections(param, MakeArrayView(&meshInfo, 1));
+                GenerateMeshLightmapUVs(param, MakeArrayView(&meshInfo, 1));
+                GenerateMeshLODs(param.lodSettings, MakeArrayView(&meshInfo, 1), param.bParallelMeshConversion);
+                OptimizeMeshSections(param, MakeArrayView(&meshInfo, 1));
+                BuildMeshBVHs(param, MakeArrayView(&meshInfo, 1));
+                BuildMeshCollision(param, MakeArrayView(&meshInfo, 1));
+                HashMeshGeometry(param, MakeArrayView(&meshInfo, 1));
+                AsyncTask(ENamedThreads::GameThread, [callbackMeshReady, meshInfo = MoveTemp(meshInfo)]() mutable -> void
+                {
+                    callbackMeshReady.ExecuteIfBound(MoveTemp(meshInfo));
+                });
+            }
+        }, !param.bParallelMeshConversion);
+        result.timings.conversionSeconds = float(FPlatformTime::Seconds() - startTimeConversion);
+        result.metrics.numMeshes = result.meshInfos.Num();
+        result.metrics.numSections = numSections;
+        result.metrics.numVertices = numVertices.GetValue();
+        result.metrics.numTriangles = numTriangles.GetValue();
+        result.metrics.threadSeconds = FRuntimeMeshMetrics::CyclesToSeconds(threadCycles);
+
+        if (cancellationToken.IsCancelled())
+        {
+            RMIE_LOG(Log, "Import cancelled. File: %s", *sceneFile);
+            result.meshInfos.Empty();
+            return;
+        }
+
+        if (bStreaming)
+        {
+            // All meshes were handed over, only the empty slots are left
+            result.meshInfos.Empty();
+        }
+        for (FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+        {
+            ComposeMeshBounds(meshInfo);
+        }
+
+        if (param.bImportAnimations && (boneIndices.Num() > 0 || result.nodes.Num() > 0))
+        {
+            // A name used by several nodes animates the first of them
+            TMap<FName, int32> nodeIndices;
+            nodeIndices.Reserve(result.nodes.Num());
+            for (int32 nodeIndex = 0; nodeIndex < result.nodes.Num(); ++nodeIndex)
+            {
+                if (!nodeIndices.Contains(result.nodes[nodeIndex].name))
+                {
+                    nodeIndices.Add(result.nodes[nodeIndex].name, nodeIndex);
+                }
+            }
+            source.ImportAnimations(boneIndices, nodeIndices, param.animationKeyTolerance, result.animations);
+            if (boneIndices.Num() > 0 && !bMeshSpace)
+            {
+                FAssimpSkinningImport::MoveRootTracksToResultSpace(skeletonToResult, result.bones, result.animations);
+            }
+        }
+
+        bMeshImportSucces = true;
+    }
+
+    if (param.cancellationToken.IsCancelled())
+    {
+        RMIE_LOG(Log, "Import cancelled. File: %s", *sceneFile);
+        result.meshInfos.Empty();
+        return;
+    }
+
+    bool bMaterialImportSuccess = false;
+    if (param.importMethodSection != EImportMethodSection::Merge && !param.bGeometryOnly)
+    {
+        const double startTimeMaterials = FPlatformTime::Seconds();
+        {
+            SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportMaterials);
+            RMIE_LLM_SCOPE(STAT_RMIE_LLM_TextureImport);
+            source.ImportMaterials(sceneFile, param, result, progress);
+        }
+        result.timings.materialSeconds = FMath::Max(0.f, float(FPlatformTime::Seconds() - startTimeMaterials) - result.timings.textureSeconds);
+        result.metrics.numMaterials = result.materialInfos.Num();
+        for (const FRuntimeMeshImportMaterialInfo& materialInfo : result.materialInfos)
+        {
+            result.metrics.numTextures += materialInfo.textures.Num();
+        }
+        bMaterialImportSuccess = true;
+
+        // Before the merge steps, so the sections of the merged materials merge as well
+        if (param.bAtlasMaterials && !bStreaming && bMeshImportSucces)
+        {
+            const double startTimeAtlas = FPlatformTime::Seconds();
+            FRuntimeMeshMaterialAtlasBuilder::AtlasMaterials_AnyThread(param, result.materialInfos, result.meshInfos);
+            result.timings.materialSeconds += float(FPlatformTime::Seconds() - startTimeAtlas);
+        }
+    }
+    else
+    {
+        bMaterialImportSuccess = true;
+    }
+
+    source.Free();
+
+    if (bMeshImportSucces && result.meshInfos.Num() > 0)
+    {
+        {
+            const double startTimeTangents = FPlatformTime::Seconds();
+            GenerateMeshTangents(param, result.meshInfos);
+            result.timings.conversionSeconds += float(FPlatformTime::Seconds() - startTimeTangents);
+        }
+
+        SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportMerge);
+        RMIE_LLM_SCOPE(STAT_RMIE_LLM_ImportConversion);
+        const double startTimeMerge = FPlatformTime::Seconds();
+        // The chunks of a large section become clusters of their own, so they are culled separately
+        const bool bSplitBeforeMerge = param.importMethodMesh == EImportMethodMesh::MergeByCluster && !bMeshSpace;
+        if (bSplitBeforeMerge)
+        {
+            SplitMeshSections(param, result.meshInfos);
+        }
+
+        // Handle Mesh Import Methode
+        switch (param.importMethodMesh)
+        {
+        case EImportMethodMesh::Keep:
+            // Do Nothing
+            break;
+        case EImportMethodMesh::Merge:
+            // Meshes in their own space can not be merged
+            if (!bMeshSpace)
+            {
+                MergeMeshes(result.meshInfos);
+            }
+            break;
+        case EImportMethodMesh::MergeByCluster:
+            if (!bMeshSpace)
+            {
+                MergeMeshesByCluster(param.clusterTargetTriangles, result.meshInfos);
+            }
+            break;
+
+        default:
+            checkNoEntry();
+        }
+
+        // Handle Section Import Methode
+        for (FRuntimeMeshImportMeshInfo& mesh : result.meshInfos)
+        {
+            ApplyImportMethodSection(param.importMethodSection, mesh);
+        }
+
+        if (!bSplitBeforeMerge)
+        {
+            // The merged sections may be the large ones
+            SplitMeshSections(param, result.meshInfos);
+        }
+        // After the merge steps, so the vertices along the former section borders weld as well
+        WeldMeshSections(param, result.meshInfos);
+        result.timings.mergeSeconds = float(FPlatformTime::Seconds() - startTimeMerge);
+    }
+
+    if (bMeshImportSucces && param.bNormalizeScene && !bStreaming && bMeshSpace)
+    {
+        // The vertices were normalized during the conversion. In mesh space the instances and root nodes are moved instead,
+        // the shared vertices stay as they are.
+        const double startTimeNormalize = FPlatformTime::Seconds();
+        FBox totalBounds(ForceInit);
+        if (param.bImportHierarchy)
+        {
+            // Parents are stored before their children
+            TArray<FTransform> composedTransforms;
+            composedTransforms.SetNum(result.nodes.Num());
+            for (int32 nodeIndex = 0; nodeIndex < result.nodes.Num(); ++nodeIndex)
+            {
+                const FRuntimeMeshImportNode& node = result.nodes[nodeIndex];
+                composedTransforms[nodeIndex] = node.parentIndex == INDEX_NONE ? node.localTransform : node.localTransform * composedTransforms[node.parentIndex];
+                if (node.meshInfoIndex != INDEX_NONE)
+                {
+                    totalBounds += result.meshInfos[node.meshInfoIndex].bounds.TransformBy(composedTransforms[nodeIndex]);
+                }
+            }
+        }
+        else
+        {
+            for (const FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+            {
+                for (const FTransform& instanceTransform : meshInfo.instanceTransforms)
+                {
+                    totalBounds += meshInfo.bounds.TransformBy(instanceTransform);
+                }
+            }
+        }
+
+        const FTransform normalizeTransform = GetNormalizeTransform(totalBounds);
+        for (FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+        {
+            for (FTransform& instanceTransform : meshInfo.instanceTransforms)
+            {
+                instanceTransform = instanceTransform * normalizeTransform;
+            }
+        }
+        for (FRuntimeMeshImportNode& node : result.nodes)
+        {
+            if (node.parentIndex == INDEX_NONE)
+            {
+                node.localTransform = node.localTransform * normalizeTransform;
+            }
+        }
+        result.timings.normalizeSeconds = float(FPlatformTime::Seconds() - startTimeNormalize);
+    }
+
+    if (bMeshImportSucces && !bStreaming)
+    {
+        // After the normalization, so the LODs are normalized as well. The LODs are optimized like LOD 0.
+        SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportPostProcess);
+        RMIE_LLM_SCOPE(STAT_RMIE_LLM_ImportConversion);
+        const double startTimePostProcess = FPlatformTime::Seconds();
+        GenerateMeshLightmapUVs(param, result.meshInfos);
+        GenerateMeshLODs(param.lodSettings, result.meshInfos, param.bParallelMeshConversion);
+        OptimizeMeshSections(param, result.meshInfos);
+        // Last, it references the final triangle order
+        BuildMeshBVHs(param, result.meshInfos);
+        BuildMeshCollision(param, result.meshInfos);
+        HashMeshGeometry(param, result.meshInfos);
+        DeduplicateMeshInfos(param, result);
+        result.timings.postProcessSeconds = float(FPlatformTime::Seconds() - startTimePostProcess);
+    }
+
+    result.bSuccess = bMeshImportSucces && bMaterialImportSuccess;
+    return;
+}
+
+// Whether 'param' lets NativeScene import the file, @see FRuntimeMeshImportParam::bNativeGltfImport and bNativeTextImport
+template<typename NativeScene>
+bool IsNativeImportEnabled(const FRuntimeMeshImportParam& param);
+
+template<>
+bool IsNativeImportEnabled<FRuntimeMeshGltfScene>(const FRuntimeMeshImportParam& param)
 {
-    if (IsInGameThread())
+    return param.bNativeGltfImport;
+}
+
+template<>
+bool IsNativeImportEnabled<FRuntimeMeshTextScene>(const FRuntimeMeshImportParam& param)
+{
+    return param.bNativeTextImport;
+}
+
+/**
+ * Imports a file with FRuntimeMeshGltfScene or FRuntimeMeshTextScene instead of Assimp, when the scene it reads is the one Assimp would make of the file.
+ * Returns false when the import has to fall back to Assimp, before anything was written to 'result'.
+ * @param loadScene		Loads the file into the scene
+ * @param bNativeNormals	Generates the missing normals itself instead of falling back to Assimp for them
+ */
+template<typename NativeScene>
+bool ImportSceneNatively(const FRuntimeMeshImportParam& param, const FString& sceneName, TFunctionRef<bool(NativeScene& scene)> loadScene, const bool bNativeNormals
+    , FRuntimeMeshImportExportProgressUpdate callbackProgress, FRuntimeMeshImportResult& result, FRuntimeImportMeshReady callbackMeshReady)
+{
+    if (!IsNativeImportEnabled<NativeScene>(param) || param.bImportSkinning)
     {
-        delegateProgress.ExecuteIfBound(progress);
+        return false;
     }
-    else
+
+    const FRuntimeMeshImportPostProcessParam& postProcess = param.postProcess;
+    const bool bCustom = postProcess.preset == ERuntimeMeshImportPostProcessPreset::Custom;
+    // Steps that change the topology of the meshes are only done by Assimp
+    if (bCustom && (postProcess.bJoinIdenticalVertices || postProcess.bImproveCacheLocality || postProcess.bSplitLargeMeshes))
     {
-        AsyncTask(ENamedThreads::GameThread, [delegateProgress, progress]() {
-            delegateProgress.ExecuteIfBound(progress);
-        });
+        return false;
+    }
+
+    NativeScene scene;
+    const double startTimeRead = FPlatformTime::Seconds();
+    bool bLoaded = false;
+    {
+        SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportRead);
+        RMIE_LLM_SCOPE(STAT_RMIE_LLM_AssimpRead);
+        bLoaded = loadScene(scene);
+    }
+    result.timings.readSeconds += float(FPlatformTime::Seconds() - startTimeRead);
+    if (!bLoaded)
+    {
+        RMIE_LOG(Log, "Importing the file with Assimp. File: %s, Reason: %s", *sceneName, *scene.GetError());
+        return false;
+    }
+
+    const bool bNeedsNormals = (param.vertexAttributes & int32(ERuntimeMeshImportVertexAttributes::Normals | ERuntimeMeshImportVertexAttributes::Tangents)) != 0;
+    const bool bGenNormals = (!bCustom || postProcess.bGenSmoothNormals) && bNeedsNormals;
+    // GenerateMeshTangents generates them after the conversion otherwise
+    const bool bGenerateNormals = bGenNormals && !ShouldGenerateNormals(param) && !scene.HasAllNormals();
+    if (bGenerateNormals && !bNativeNormals)
+    {
+        RMIE_LOG(Log, "Importing the file with Assimp, it generates the missing normals. File: %s", *sceneName);
+        return false;
     }
+
+    const bool bCalcTangents = !param.bMikkTSpaceTangents && (postProcess.preset == ERuntimeMeshImportPostProcessPreset::Quality || (bCustom && postProcess.bCalcTangentSpace));
+    const FRuntimeMeshImportExportProgressCoalescerRef progress = FRuntimeMeshImportExportProgressCoalescer::Create(callbackProgress);
+    TNativeSceneSource<NativeScene> source(scene, param.transform, bCalcTangents, uint32(param.vertexAttributes), bGenerateNormals, postProcess.smoothingAngle);
+    ConvertSceneSource(source, sceneName, param, progress, callbackMeshReady, result);
+    return true;
 }
 
-void URuntimeMeshImportExportLibrary::ImportScene_AnyThread(const FString file, const FTransform& transform, FRuntimeMeshImportExportProgressUpdate callbackProgress, FRuntimeMeshImportResult& result, const EPathType pathType /*= EPathType::Absolute */, const EImportMethodMesh importMethodMesh /*= EImportMethodMesh::Keep */, const EImportMethodSection importMethodSection /*= EImportMethodSection::MergeSameMaterial */, const bool bNormalizeScene /*= false */)
+void URuntimeMeshImportExportLibrary::PostProcessImportResult_AnyThread(const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& result)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportPostProcess);
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_ImportConversion);
+    const double startTimePostProcess = FPlatformTime::Seconds();
+    // In the order of the import
+    SplitMeshSections(param, result.meshInfos);
+    WeldMeshSections(param, result.meshInfos);
+    GenerateMeshLightmapUVs(param, result.meshInfos);
+    GenerateMeshLODs(param.lodSettings, result.meshInfos, param.bParallelMeshConversion);
+    OptimizeMeshSections(param, result.meshInfos);
+    BuildMeshBVHs(param, result.meshInfos);
+    BuildMeshCollision(param, result.meshInfos);
+    HashMeshGeometry(param, result.meshInfos);
+    DeduplicateMeshInfos(param, result);
+    result.timings.postProcessSeconds += float(FPlatformTime::Seconds() - startTimePostProcess);
+}
+
+void URuntimeMeshImportExportLibrary::ImportScene_AnyThread(const FRuntimeMeshImportParam& param, FRuntimeMeshImportExportProgressUpdate callbackProgress, FRuntimeMeshImportResult& result
+        , FRuntimeImportMeshReady callbackMeshReady)
 {
     result.bSuccess = false;
     result.meshInfos.Empty();
     result.materialInfos.Empty();
-
-    if (file.IsEmpty())
+    result.nodes.Empty();
+    result.bones.Empty();
+    result.animations.Empty();
+    result.timings = FRuntimeMeshImportStageTimings();
+    result.metrics = FRuntimeMeshImportMetrics();
+    const double startTimeImport = FPlatformTime::Seconds();
+    const uint64 usedPhysicalBefore = FRuntimeMeshMetrics::GetUsedPhysical();
+
+    if (param.file.IsEmpty())
     {
         RMIE_LOG(Warning, "No file specified.");
         return;
     }
 
-    FString fileFinal;
-    switch (pathType)
+    FString fileFinal = ResolveImportFilePath(param.file, param.pathType);
+    FPaths::NormalizeFilename(fileFinal);
+
+    const bool bUseResultCache = !param.resultCacheDirectory.IsEmpty();
+    if (bUseResultCache && FRuntimeMeshImportResultCache::Load_AnyThread(fileFinal, param, result))
     {
-    case EPathType::Absolute:
-        fileFinal = file;
-        break;
-    case EPathType::ProjectRelative:
-        fileFinal = FPaths::Combine(FPaths::ConvertRelativePathToFull(FPaths::ProjectDir()), file);
-        break;
-    case EPathType::ContentRelative:
-        fileFinal = FPaths::Combine(FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()), file);
-        break;
+        RMIE_LOG(Log, "Loaded the import result from the result cache. File: %s", *fileFinal);
+        result.timings.totalSeconds = float(FPlatformTime::Seconds() - startTimeImport);
+        FRuntimeMeshMetrics::SetMemory(result.metrics, usedPhysicalBefore);
+        if (callbackMeshReady.IsBound())
+        {
+            // Streams like an import would
+            for (int32 meshInfoIndex = 0; meshInfoIndex < result.meshInfos.Num(); ++meshInfoIndex)
+            {
+                FRuntimeMeshImportMeshInfo& meshInfo = result.meshInfos[meshInfoIndex];
+                meshInfo.streamingIndex = meshInfoIndex;
+                AsyncTask(ENamedThreads::GameThread, [callbackMeshReady, meshInfo = MoveTemp(meshInfo)]() mutable -> void
+                {
+                    callbackMeshReady.ExecuteIfBound(MoveTemp(meshInfo));
+                });
+            }
+            result.meshInfos.Empty();
+        }
+        return;
     }
 
-    FAssimpProgressHandler progressHandler(callbackProgress);
-    Assimp::Importer importer;
-    importer.SetProgressHandler(&progressHandler);
+    // Read through IPlatformFile, so files in paks can be imported as well
+    FAssimpIOSystem ioSystem(FPaths::GetPath(fileFinal), param.bMemoryMapFile);
+    const bool bNativeImport = (FRuntimeMeshGltfScene::IsGltfFile(fileFinal) && ImportSceneNatively<FRuntimeMeshGltfScene>(param, fileFinal, [&fileFinal, &ioSystem](FRuntimeMeshGltfScene& scene) {
+        return scene.Load(fileFinal, ioSystem);
+    }, false, callbackProgress, result, callbackMeshReady))
+        || (FRuntimeMeshTextScene::IsTextFile(fileFinal) && ImportSceneNatively<FRuntimeMeshTextScene>(param, fileFinal, [&fileFinal, &ioSystem](FRuntimeMeshTextScene& scene) {
+        return scene.Load(fileFinal, ioSystem);
+    }, true, callbackProgress, result, callbackMeshReady));
+    if (!bNativeImport)
+    {
+        ImportScene_Internal(param, fileFinal, ioSystem, [&fileFinal](Assimp::Importer& importer, const unsigned int postProcessFlags) {
+            return importer.ReadFile(TCHAR_TO_UTF8(*fileFinal), postProcessFlags);
+        }, callbackProgress, result, callbackMeshReady);
+    }
 
-    const aiScene* scene = importer.ReadFile(TCHAR_TO_UTF8(*fileFinal), aiProcess_Triangulate | aiProcess_MakeLeftHanded | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals | aiProcess_OptimizeMeshes);
-    importer.SetProgressHandler(nullptr);
-    FString importError = FString(importer.GetErrorString());
-    if (importError.Len() > 0)
+    // A streamed result does not hold the meshes anymore
+    if (bUseResultCache && result.bSuccess && !callbackMeshReady.IsBound() && !param.cancellationToken.IsCancelled())
     {
-        RMIE_LOG(Error, "Assimp failed to import file. File: %s, Error: %s", *fileFinal, *importError);
-        return;
+        FRuntimeMeshImportResultCache::Save_AnyThread(fileFinal, param, result);
     }
+    result.metrics.bytesRead += ioSystem.GetBytesOpened();
+    FRuntimeMeshMetrics::SetMemory(result.metrics, usedPhysicalBefore);
+    result.timings.totalSeconds = float(FPlatformTime::Seconds() - startTimeImport);
+}
 
-    if (scene == nullptr)
+void URuntimeMeshImportExportLibrary::ImportSceneFromMemory_AnyThread(TArrayView<const uint8> buffer, const FString& formatHint, const FRuntimeMeshImportParam& param
+        , TArrayView<const FRuntimeMeshImportMemoryFile> siblingFiles, FRuntimeMeshImportExportProgressUpdate callbackProgress, FRuntimeMeshImportResult& result)
+{
+    result.bSuccess = false;
+    result.meshInfos.Empty();
+    result.materialInfos.Empty();
+    result.nodes.Empty();
+    result.bones.Empty();
+    result.animations.Empty();
+    result.timings = FRuntimeMeshImportStageTimings();
+    result.metrics = FRuntimeMeshImportMetrics();
+    const double startTimeImport = FPlatformTime::Seconds();
+    const uint64 usedPhysicalBefore = FRuntimeMeshMetrics::GetUsedPhysical();
+
+    if (buffer.Num() == 0)
     {
-        RMIE_LOG(Error, "File was imported but scene pointer not valid. File: %s", *fileFinal);
+        RMIE_LOG(Warning, "The buffer is empty.");
         return;
     }
 
-    bool bMeshImportSucces = false;
-    if (scene->HasMeshes())
+    // 'param.file' is optional and only used to resolve sibling files that are not in memory
+    FString fileFinal = param.file.IsEmpty() ? FString() : ResolveImportFilePath(param.file, param.pathType);
+    FPaths::NormalizeFilename(fileFinal);
+    const FString sceneName = fileFinal.IsEmpty() ? FString::Printf(TEXT("memory.%s"), *formatHint) : fileFinal;
+
+    FAssimpIOSystem ioSystem(FPaths::GetPath(fileFinal), param.bMemoryMapFile);
+    for (const FRuntimeMeshImportMemoryFile& siblingFile : siblingFiles)
     {
-        // Count scene nodes for progress update
-        int32 numNodes = 0;
-        IterateSceneNodes(scene->mRootNode, [&numNodes](aiNode* node) {
-            numNodes++;
-        });
+        ioSystem.AddMemoryFile(siblingFile.name, siblingFile.data);
+    }
 
-        // Import mesh data
-        FTransform composedParentTransform = transform;
-        int32 nodeCounter = 0;
-        IterateSceneNodes(scene->mRootNode, [scene, &result, &composedParentTransform, &nodeCounter, &numNodes, &callbackProgress](aiNode* node)
-        {
-			FTransform composedNodeTransform;
-			BuildComposedNodeTransform(node, composedNodeTransform);
-            ImportMeshesOfNode(scene, node, result, composedNodeTransform);
-            //composedParentTransform = FTransform(URuntimeMeshImportExportLibrary::AiTransformToFTransform(node->mTransformation)) * composedParentTransform;
-            ++nodeCounter;
-            SendProgress_AnyThread(callbackProgress, FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ImportingMeshes, nodeCounter, numNodes));
+    // Assimp wants the hint without the dot
+    FString hint = formatHint;
+    hint.RemoveFromStart(TEXT("."));
+    const bool bNativeImport = (FRuntimeMeshGltfScene::IsGltfFile(TEXT(".") + hint) && ImportSceneNatively<FRuntimeMeshGltfScene>(param, sceneName, [&buffer, &ioSystem](FRuntimeMeshGltfScene& scene) {
+        return scene.LoadFromMemory(buffer, ioSystem);
+    }, false, callbackProgress, result, FRuntimeImportMeshReady()))
+        || (FRuntimeMeshTextScene::IsTextFile(TEXT(".") + hint) && ImportSceneNatively<FRuntimeMeshTextScene>(param, sceneName, [&buffer, &hint, &ioSystem](FRuntimeMeshTextScene& scene) {
+        return scene.LoadFromMemory(buffer, hint, ioSystem);
+    }, true, callbackProgress, result, FRuntimeImportMeshReady()));
+    if (!bNativeImport)
+    {
+        ImportScene_Internal(param, sceneName, ioSystem, [&buffer, &hint](Assimp::Importer& importer, const unsigned int postProcessFlags) {
+            return importer.ReadFileFromMemory(buffer.GetData(), buffer.Num(), postProcessFlags, TCHAR_TO_ANSI(*hint));
+        }, callbackProgress, result);
+    }
+    // The buffer does not go through 'ioSystem'
+    result.metrics.bytesRead += buffer.Num() + ioSystem.GetBytesOpened();
+    FRuntimeMeshMetrics::SetMemory(result.metrics, usedPhysicalBefore);
+    result.timings.totalSeconds = float(FPlatformTime::Seconds() - startTimeImport);
+}
+
+void URuntimeMeshImportExportLibrary::ProbeScenes(const TArray<FRuntimeMeshImportParam>& params, TArray<FRuntimeMeshImportSummary>& outSummaries)
+{
+    outSummaries.Reset(params.Num());
+    outSummaries.SetNum(params.Num());
+    // One file per task, the files differ too much in size to batch them
+    ParallelFor(params.Num(), [&params, &outSummaries](int32 index) {
+        ProbeScene_AnyThread(params[index], outSummaries[index]);
+    });
+}
+
+void URuntimeMeshImportExportLibrary::ProbeScenes_Async_Cpp(const TArray<FRuntimeMeshImportParam>& params, FRuntimeImportProbeFinished callbackFinished)
+{
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([params, callbackFinished]() {
+        TArray<FRuntimeMeshImportSummary> summaries;
+        ProbeScenes(params, summaries);
+        AsyncTask(ENamedThreads::GameThread, [callbackFinished, summaries = MoveTemp(summaries)]() {
+            callbackFinished.ExecuteIfBound(summaries);
         });
+    });
+}
 
-        if (result.meshInfos.Num() > 0)
-        {
-            // Handle Mesh Import Methode
-            switch (importMethodMesh)
-            {
-            case EImportMethodMesh::Keep:
-                // Do Nothing
-                break;
-            case EImportMethodMesh::Merge:
-                MergeMeshes(result.meshInfos);
-                break;
+void URuntimeMeshImportExportLibrary::ProbeScenes_Async(const TArray<FRuntimeMeshImportParam>& params, FRuntimeImportProbeFinishedDyn finishedDelegate)
+{
+    FRuntimeImportProbeFinished finishedDelegateRaw;
+    finishedDelegateRaw.BindLambda([finishedDelegate](const TArray<FRuntimeMeshImportSummary>& summaries) {
+        finishedDelegate.ExecuteIfBound(summaries);
+    });
+    ProbeScenes_Async_Cpp(params, finishedDelegateRaw);
+}
 
-            default:
-                checkNoEntry();
-            }
+void URuntimeMeshImportExportLibrary::ProbeScene_AnyThread(const FRuntimeMeshImportParam& param, FRuntimeMeshImportSummary& outSummary)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportProbe);
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_AssimpRead);
+    const double startTime = FPlatformTime::Seconds();
+    outSummary = FRuntimeMeshImportSummary();
+    if (param.file.IsEmpty())
+    {
+        RMIE_LOG(Warning, "No file specified.");
+        return;
+    }
 
-            // Handle Section Import Methode
-            switch (importMethodSection)
-            {
-            case EImportMethodSection::Keep:
-                // Do Nothing
-                break;
-            default:
-                for (FRuntimeMeshImportMeshInfo& mesh : result.meshInfos)
-                {
-                    switch (importMethodSection)
-                    {
-                    case EImportMethodSection::Merge:
-                        MergeAllSections(mesh.sections);
-                        break;
-                    case EImportMethodSection::MergeSameMaterial:
-                        MergeSectionsSameMaterial(mesh.sections);
-                        break;
-                    default:
-                        checkNoEntry();
+    FString fileFinal = ResolveImportFilePath(param.file, param.pathType);
+    FPaths::NormalizeFilename(fileFinal);
+    outSummary.file = fileFinal;
+
+    FAssimpIOSystem ioSystem(FPaths::GetPath(fileFinal), param.bMemoryMapFile);
+    FScopedAssimpImporter scopedImporter;
+    Assimp::Importer& importer = *scopedImporter;
+    importer.SetIOHandler(&ioSystem);
+    // Only the handedness, so the bounds match an import
+    const aiScene* scene = importer.ReadFile(TCHAR_TO_UTF8(*fileFinal), aiProcess_MakeLeftHanded);
+    importer.SetIOHandler(nullptr);
+    if (!scene)
+    {
+        RMIE_LOG(Warning, "Assimp failed to read file. File: %s, Error: %s", *fileFinal, *FString(importer.GetErrorString()));
+        return;
+    }
 
-                    }
-                }
-            }
+    outSummary.numMeshes = scene->mNumMeshes;
+    for (uint32 meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex)
+    {
+        const aiMesh* mesh = scene->mMeshes[meshIndex];
+        outSummary.numVertices += mesh->mNumVertices;
+        for (uint32 faceIndex = 0; faceIndex < mesh->mNumFaces; ++faceIndex)
+        {
+            // Points and lines are no triangles
+            outSummary.numTriangles += FMath::Max<int32>(int32(mesh->mFaces[faceIndex].mNumIndices) - 2, 0);
         }
+        outSummary.bHasBones |= mesh->HasBones();
+    }
 
-        if (bNormalizeScene)
-        {
-            // Get the total bounds of all mesh info
-            FBox totalBounds;
-            totalBounds.Min = FVector(0.f); // Should be initialized already to 0, but had trouble
-            totalBounds.Max = FVector(0.f); // Should be initialized already to 0, but had trouble
-            for (FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+    if (scene->mRootNode)
+    {
+        IterateSceneNodes(scene->mRootNode, param.transform, [scene, &outSummary](aiNode* node, const FTransform& composedNodeTransform) {
+            const FMatrix matrix = composedNodeTransform.ToMatrixWithScale();
+            for (uint32 nodeMeshIndex = 0; nodeMeshIndex < node->mNumMeshes; ++nodeMeshIndex)
             {
-                for (FRuntimeMeshImportSectionInfo& sectionInfo : meshInfo.sections)
-                {
-                    FBox currentBounds(sectionInfo.vertices);
-                    totalBounds += currentBounds;
-                }
+                const aiMesh* mesh = scene->mMeshes[node->mMeshes[nodeMeshIndex]];
+                outSummary.bounds += FMeshConversionKernels::ComputeTransformedBounds(matrix, FMeshConversionKernels::AsFVector(mesh->mVertices), mesh->mNumVertices);
+                ++outSummary.numMeshInstances;
             }
+        });
+    }
 
-            // Use the bounds to transform the scene
-            float scaleFactor = 50.f / totalBounds.GetExtent().GetMax();
-            FVector offset = -FBoxSphereBounds(totalBounds).Origin;
-            for (FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+    TSet<FString> textureReferences;
+    for (uint32 materialIndex = 0; materialIndex < scene->mNumMaterials; ++materialIndex)
+    {
+        const aiMaterial* material = scene->mMaterials[materialIndex];
+        outSummary.materialNames.Add(FName(material->GetName().C_Str()));
+        for (int32 textureType = aiTextureType_DIFFUSE; textureType <= aiTextureType_UNKNOWN; ++textureType)
+        {
+            const uint32 numTextures = material->GetTextureCount(aiTextureType(textureType));
+            for (uint32 textureIndex = 0; textureIndex < numTextures; ++textureIndex)
             {
-                for (FRuntimeMeshImportSectionInfo& sectionInfo : meshInfo.sections)
+                aiString texturePath;
+                if (material->GetTexture(aiTextureType(textureType), textureIndex, &texturePath) == AI_SUCCESS)
                 {
-                    for (FVector& vertex : sectionInfo.vertices)
+                    const FString reference(UTF8_TO_TCHAR(texturePath.C_Str()));
+                    if (!textureReferences.Contains(reference))
                     {
-                        vertex += offset;
-                        vertex *= scaleFactor;
+                        textureReferences.Add(reference);
+                        outSummary.textureReferences.Add(reference);
                     }
                 }
             }
         }
+    }
 
-        bMeshImportSucces = true;
+    outSummary.numAnimations = scene->mNumAnimations;
+    outSummary.bSuccess = true;
+    outSummary.seconds = float(FPlatformTime::Seconds() - startTime);
+}
+
+void URuntimeMeshImportExportLibrary::ConvertScene(const FRuntimeMeshConvertParam& param, FRuntimeMeshConvertResult& result)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RMIE_ConvertScene);
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_ImportConversion);
+    result = FRuntimeMeshConvertResult();
+    if (param.file.IsEmpty() || param.outputFile.IsEmpty() || param.formatId.IsEmpty())
+    {
+        result.error = TEXT("The file, the output file and the format id must be set.");
+        return;
     }
 
-    bool bMaterialImportSuccess = false;
-    if (importMethodSection != EImportMethodSection::Merge && scene->HasMaterials())
+    FString fileFinal = ResolveImportFilePath(param.file, param.pathType);
+    FPaths::NormalizeFilename(fileFinal);
+
+    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!param.bOverrideExisting && platformFile.FileExists(*param.outputFile))
     {
-        ImportSceneMaterials(fileFinal, scene, result, callbackProgress);
-        bMaterialImportSuccess = true;
+        result.error = FString::Printf(TEXT("File %s does already exist!"), *param.outputFile);
+        return;
     }
-    else
+    // Assimp can only write to a directory that exists
+    if (!platformFile.CreateDirectoryTree(*FPaths::GetPath(param.outputFile)))
     {
-        bMaterialImportSuccess = true;
+        result.error = FString::Printf(TEXT("Could not create directory: %s"), *FPaths::GetPath(param.outputFile));
+        return;
+    }
+
+    const double startTimeRead = FPlatformTime::Seconds();
+    FAssimpIOSystem ioSystem(FPaths::GetPath(fileFinal), param.bMemoryMapFile);
+    FAssimpProgressHandler progressHandler(FRuntimeMeshImportExportProgressCoalescer::Create(FRuntimeMeshImportExportProgressUpdate()), param.cancellationToken);
+    FScopedAssimpImporter scopedImporter;
+    Assimp::Importer& importer = *scopedImporter;
+    importer.SetProgressHandler(&progressHandler);
+    importer.SetIOHandler(&ioSystem);
+    // Both sides are in the coordinate system of the files, the import and the export only convert it for Unreal
+    const unsigned int postProcessFlags = param.bPostProcess ? SetupPostProcessing(importer, param.postProcess) & ~aiProcess_MakeLeftHanded : 0;
+    const aiScene* scene = importer.ReadFile(TCHAR_TO_UTF8(*fileFinal), postProcessFlags);
+    importer.SetProgressHandler(nullptr);
+    importer.SetIOHandler(nullptr);
+    result.bytesRead = ioSystem.GetBytesOpened();
+    result.readSeconds = float(FPlatformTime::Seconds() - startTimeRead);
+    if (!scene || !scene->mRootNode)
+    {
+        result.error = FString::Printf(TEXT("Assimp failed to read file. File: %s, Error: %s"), *fileFinal, UTF8_TO_TCHAR(importer.GetErrorString()));
+        return;
+    }
+    if (param.cancellationToken.IsCancelled())
+    {
+        result.error = TEXT("Conversion cancelled.");
+        return;
     }
+    result.numMeshes = scene->mNumMeshes;
+    result.numMaterials = scene->mNumMaterials;
 
+    // The importer owns the scene, it is only changed here before it is written
+    if (!param.transform.Equals(FTransform::Identity))
+    {
+        aiNode* root = const_cast<aiScene*>(scene)->mRootNode;
+        root->mTransformation = FTransformToAiTransform(param.transform) * root->mTransformation;
+    }
 
-    result.bSuccess = bMeshImportSucces && bMaterialImportSuccess;
-    return;
+    const double startTimeWrite = FPlatformTime::Seconds();
+    Assimp::Exporter exporter;
+    // Owned by 'exporter', the writers close their files before Export returns
+    FAssimpExportIOSystem* exportIoSystem = new FAssimpExportIOSystem(param.fileWriteBufferSizeKB * 1024);
+    exporter.SetIOHandler(exportIoSystem);
+    aiReturn exportReturn = aiReturn_FAILURE;
+    try
+    {
+        exportReturn = exporter.Export(scene, TCHAR_TO_ANSI(*param.formatId), TCHAR_TO_UTF8(*param.outputFile), 0);
+    }
+    catch (const std::exception& e)
+    {
+        result.error = FString::Printf(TEXT("Exception thrown during export: %s"), ANSI_TO_TCHAR(e.what()));
+    }
+    result.writeSeconds = float(FPlatformTime::Seconds() - startTimeWrite);
+    result.bytesWritten = exportIoSystem->GetBytesWritten();
+    const FString writeError = exportIoSystem->GetWriteError();
+    for (const FString& error : { FString(exporter.GetErrorString()), writeError })
+    {
+        if (!error.IsEmpty())
+        {
+            NewLineAndAppend(result.error, error);
+        }
+    }
+    result.bSuccess = exportReturn == aiReturn_SUCCESS && writeError.IsEmpty();
+    if (!result.bSuccess)
+    {
+        RMIE_LOG(Warning, "Failed to convert %s to %s. Error: %s", *fileFinal, *param.outputFile, *result.error);
+    }
+}
+
+void URuntimeMeshImportExportLibrary::ConvertScene_Async_Cpp(const FRuntimeMeshConvertParam& param, FRuntimeConvertFinished callbackFinished)
+{
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([param, callbackFinished]() {
+        FRuntimeMeshConvertResult result;
+        ConvertScene(param, result);
+        AsyncTask(ENamedThreads::GameThread, [callbackFinished, result = MoveTemp(result)]() {
+            callbackFinished.ExecuteIfBound(result);
+        });
+    });
+}
+
+void URuntimeMeshImportExportLibrary::ConvertScene_Async(const FRuntimeMeshConvertParam& param, FRuntimeConvertFinishedDyn finishedDelegate)
+{
+    FRuntimeConvertFinished finishedDelegateRaw;
+    finishedDelegateRaw.BindLambda([finishedDelegate](const FRuntimeMeshConvertResult& result) {
+        finishedDelegate.ExecuteIfBound(result);
+    });
+    ConvertScene_Async_Cpp(param, finishedDelegateRaw);
 }
 
+void URuntimeMeshImportExportLibrary::ImportScene_Internal(const FRuntimeMeshImportParam& param, const FString& sceneName, FAssimpIOSystem& ioSystem
+        , TFunctionRef<const aiScene*(Assimp::Importer& importer, const unsigned int postProcessFlags)> readScene
+        , FRuntimeMeshImportExportProgressUpdate callbackProgress, FRuntimeMeshImportResult& result, FRuntimeImportMeshReady callbackMeshReady)
+{
+    // All progress of this import goes through one coalescer, so the GameThread is not flooded with tasks
+    const FRuntimeMeshImportExportProgressCoalescerRef progress = FRuntimeMeshImportExportProgressCoalescer::Create(callbackProgress);
+    FAssimpProgressHandler progressHandler(progress, param.cancellationToken);
+    // Reused across imports, the properties of the previous import are overwritten by SetupPostProcessing
+    FScopedAssimpImporter scopedImporter;
+    Assimp::Importer& importer = *scopedImporter;
+    // The handlers are owned by us. Setting them to nullptr later makes sure that Assimp does not delete them.
+    importer.SetProgressHandler(&progressHandler);
+    importer.SetIOHandler(&ioSystem);
+
+    unsigned int postProcessFlags = SetupPostProcessing(importer, param.postProcess);
+    // Auto decides about instancing after the scene is read, from the meshes the nodes share, so the identical meshes have to be found before.
+    // It never instances skinned meshes.
+    const bool bMayImportInstanced = param.bImportInstanced || (param.importProfile == ERuntimeMeshImportProfile::Auto && !param.bImportSkinning);
+    if (bMayImportInstanced)
+    {
+        // Lets meshes that are identical but stored twice share one instance
+        postProcessFlags |= aiProcess_FindInstances;
+    }
+    // One primitive type per mesh, so the triangles of every mesh are copied in bulk and the lines and points come in meshes of their own
+    postProcessFlags |= aiProcess_SortByPType;
+    importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, 0);
+    // The import generates them itself after the conversion
+    if (param.bMikkTSpaceTangents)
+    {
+        postProcessFlags &= ~(aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals);
+    }
+    // Nothing is generated that is not imported, the tangents are generated from the normals
+    if (!(param.vertexAttributes & int32(ERuntimeMeshImportVertexAttributes::Tangents)))
+    {
+        postProcessFlags &= ~aiProcess_CalcTangentSpace;
+        if (!(param.vertexAttributes & int32(ERuntimeMeshImportVertexAttributes::Normals)))
+        {
+            postProcessFlags &= ~(aiProcess_GenNormals | aiProcess_GenSmoothNormals);
+        }
+    }
+    const double startTimeRead = FPlatformTime::Seconds();
+    const aiScene* scene = nullptr;
+    {
+        SCOPE_CYCLE_COUNTER(STAT_RMIE_ImportRead);
+        RMIE_LLM_SCOPE(STAT_RMIE_LLM_AssimpRead);
+        scene = readScene(importer, postProcessFlags);
+    }
+    // Adds to the load of a native glTF import that fell back to Assimp
+    result.timings.readSeconds += float(FPlatformTime::Seconds() - startTimeRead);
+    importer.SetProgressHandler(nullptr);
+    importer.SetIOHandler(nullptr);
+    if (param.cancellationToken.IsCancelled())
+    {
+        RMIE_LOG(Log, "Import cancelled. File: %s", *sceneName);
+        return;
+    }
+
+    FString importError = FString(importer.GetErrorString());
+    if (importError.Len() > 0)
+    {
+        RMIE_LOG(Error, "Assimp failed to import file. File: %s, Error: %s", *sceneName, *importError);
+        return;
+    }
+
+    if (scene == nullptr)
+    {
+        RMIE_LOG(Error, "File was imported but scene pointer not valid. File: %s", *sceneName);
+        return;
+    }
+
+    FAssimpSceneSource source(importer, param.transform, uint32(param.vertexAttributes), param.bImportLinesAndPoints);
+    ConvertSceneSource(source, sceneName, param, progress, callbackMeshReady, result);
+}
@@ -0,0 +1,95 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportExportProgressCoalescer.h"
+#include "Async/Async.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/PlatformTime.h"
+
+FRuntimeMeshImportExportProgressCoalescerRef FRuntimeMeshImportExportProgressCoalescer::Create(FRuntimeMeshImportExportProgressUpdate delegateProgress, const float minPercentageStep, const float minIntervalSeconds)
+{
+    return MakeShareable(new FRuntimeMeshImportExportProgressCoalescer(delegateProgress, minPercentageStep, minIntervalSeconds));
+}
+
+FRuntimeMeshImportExportProgressCoalescer::FRuntimeMeshImportExportProgressCoalescer(FRuntimeMeshImportExportProgressUpdate inDelegateProgress, const float inMinPercentageStep, const float inMinIntervalSeconds)
+    : delegateProgress(inDelegateProgress)
+    , minPercentageStep(inMinPercentageStep)
+    , minIntervalSeconds(inMinIntervalSeconds)
+{
+}
+
+void FRuntimeMeshImportExportProgressCoalescer::Send_AnyThread(const FRuntimeMeshImportExportProgress& progress)
+{
+    if (!delegateProgress.IsBound())
+    {
+        return;
+    }
+
+    if (IsInGameThread())
+    {
+        delegateProgress.Execute(progress);
+        return;
+    }
+
+    bool bQueueDelivery = false;
+    {
+        FScopeLock lock(&slotsLock);
+
+        FProgressSlot* slot = slots.FindByPredicate([&progress](const FProgressSlot& entry) { return entry.latest.type == progress.type; });
+        if (!slot)
+        {
+            slot = &slots.AddDefaulted_GetRef();
+        }
+        slot->latest = progress;
+        slot->bDirty = true;
+
+        const float percentage = progress.max > 0 ? 100.f * progress.current / progress.max : 100.f;
+        const double now = FPlatformTime::Seconds();
+        const bool bSignificant = slot->queuedPercentage < 0.f
+            || progress.current >= progress.max
+            || (FMath::Abs(percentage - slot->queuedPercentage) >= minPercentageStep && now - lastQueueTime >= minIntervalSeconds);
+
+        if (bSignificant && !bDeliveryQueued)
+        {
+            slot->queuedPercentage = percentage;
+            lastQueueTime = now;
+            bDeliveryQueued = true;
+            bQueueDelivery = true;
+        }
+    }
+
+    if (bQueueDelivery)
+    {
+        // Keeps the coalescer alive until the progress is delivered
+        FRuntimeMeshImportExportProgressCoalescerRef self = AsShared();
+        AsyncTask(ENamedThreads::GameThread, [self]() {
+            self->Deliver_GameThread();
+        });
+    }
+}
+
+void FRuntimeMeshImportExportProgressCoalescer::Deliver_GameThread()
+{
+    check(IsInGameThread());
+
+    TArray<FRuntimeMeshImportExportProgress, TInlineAllocator<8>> toDeliver;
+    {
+        FScopeLock lock(&slotsLock);
+        for (FProgressSlot& slot : slots)
+        {
+            if (slot.bDirty)
+            {
+                toDeliver.Add(slot.latest);
+                slot.bDirty = false;
+            }
+        }
+        bDeliveryQueued = false;
+    }
+
+    // Outside of the lock, the delegate might take a while
+    for (const FRuntimeMeshImportExportProgress& progress : toDeliver)
+    {
+        delegateProgress.ExecuteIfBound(progress);
+    }
+}
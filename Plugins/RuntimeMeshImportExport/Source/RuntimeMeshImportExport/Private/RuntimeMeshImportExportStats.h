@@ -0,0 +1,94 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/LowLevelMemTracker.h"
+
+// "stat RuntimeMeshImportExport" in the console. The cycle counters also show up in Unreal Insights with the stat named events.
+DECLARE_STATS_GROUP(TEXT("RuntimeMeshImportExport"), STATGROUP_RuntimeMeshImportExport, STATCAT_Advanced);
+
+// Import
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Read"), STAT_RMIE_ImportRead, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Convert Scene"), STAT_RMIE_ImportConvertScene, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Convert Mesh"), STAT_RMIE_ImportConvertMesh, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Merge"), STAT_RMIE_ImportMerge, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Materials"), STAT_RMIE_ImportMaterials, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Textures"), STAT_RMIE_ImportTextures, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Post Process"), STAT_RMIE_ImportPostProcess, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Probe"), STAT_RMIE_ImportProbe, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Convert Scene"), STAT_RMIE_ConvertScene, STATGROUP_RuntimeMeshImportExport, );
+// URuntimeMeshImportApplier on the GameThread
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Apply Section"), STAT_RMIE_ImportApplySection, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Import Apply Material"), STAT_RMIE_ImportApplyMaterial, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Imported Vertices"), STAT_RMIE_ImportedVertices, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Imported Triangles"), STAT_RMIE_ImportedTriangles, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Imported Texture Bytes"), STAT_RMIE_ImportedTextureBytes, STATGROUP_RuntimeMeshImportExport, );
+
+// Export
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Export Gather"), STAT_RMIE_ExportGather, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Export Process"), STAT_RMIE_ExportProcess, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Export Create Meshes"), STAT_RMIE_ExportCreateMeshes, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Export Texture"), STAT_RMIE_ExportTexture, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Export Write Textures"), STAT_RMIE_ExportWriteTextures, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Export Assimp Write"), STAT_RMIE_ExportAssimpWrite, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Exported Vertices"), STAT_RMIE_ExportedVertices, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Exported Triangles"), STAT_RMIE_ExportedTriangles, STATGROUP_RuntimeMeshImportExport, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Exported File Bytes"), STAT_RMIE_ExportedFileBytes, STATGROUP_RuntimeMeshImportExport, );
+// The Assimp scenes of the running exports
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Export Scene Memory"), STAT_RMIE_ExportSceneMemory, STATGROUP_RuntimeMeshImportExport, );
+
+// Low Level Memory tracker tags, "stat LLMFULL" with -LLM. Each scope tags what its thread allocates through FMemory, including
+// the file reads of FAssimpIOSystem. Assimp allocates its scenes with the runtime of its dll, which the tracker can not see.
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("RMIE Assimp Read"), STAT_RMIE_LLM_AssimpRead, STATGROUP_LLMFULL, );
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("RMIE Import Conversion"), STAT_RMIE_LLM_ImportConversion, STATGROUP_LLMFULL, );
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("RMIE Texture Import"), STAT_RMIE_LLM_TextureImport, STATGROUP_LLMFULL, );
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("RMIE Decoded Textures"), STAT_RMIE_LLM_DecodedTextures, STATGROUP_LLMFULL, );
+DECLARE_LLM_MEMORY_STAT_EXTERN(TEXT("RMIE Export Staging"), STAT_RMIE_LLM_ExportStaging, STATGROUP_LLMFULL, );
+// The tags are per thread, the bodies of ParallelFor need a scope of their own
+#define RMIE_LLM_SCOPE(Stat) LLM_SCOPED_TAG_WITH_STAT(Stat, ELLMTracker::Default)
+
+// The parts of FRuntimeMeshImportMetrics and FRuntimeMeshExportMetrics that are shared, always on unlike the stats
+struct FRuntimeMeshMetrics
+{
+    // Adds the cycles of its scope to 'counter', for the thread seconds of the parallel stages
+    class FScopedThreadCycles
+    {
+    public:
+        FScopedThreadCycles(FThreadSafeCounter64& inCounter) : counter(inCounter), startCycles(FPlatformTime::Cycles64()) {}
+        ~FScopedThreadCycles()
+        {
+            counter.Add(int64(FPlatformTime::Cycles64() - startCycles));
+        }
+
+    private:
+        FThreadSafeCounter64& counter;
+        const uint64 startCycles;
+    };
+
+    static float CyclesToSeconds(const FThreadSafeCounter64& cycles)
+    {
+        return float(FPlatformTime::ToSeconds64(uint64(cycles.GetValue())));
+    }
+
+    static uint64 GetUsedPhysical()
+    {
+        return FPlatformMemory::GetStats().UsedPhysical;
+    }
+
+    // Sets 'peakUsedPhysicalMB' and 'usedPhysicalGrowthMB' of 'metrics'
+    template<typename MetricsType>
+    static void SetMemory(MetricsType& metrics, const uint64 usedPhysicalBefore)
+    {
+        const FPlatformMemoryStats memoryStats = FPlatformMemory::GetStats();
+        metrics.peakUsedPhysicalMB = float(double(memoryStats.PeakUsedPhysical) / (1024.0 * 1024.0));
+        metrics.usedPhysicalGrowthMB = float(FMath::Max(double(memoryStats.UsedPhysical) - double(usedPhysicalBefore), 0.0) / (1024.0 * 1024.0));
+    }
+};
@@ -0,0 +1,340 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportExportTextureCache.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryWriter.h"
+
+static TUniquePtr<FRuntimeMeshImportExportTextureCache> textureCacheInstance;
+
+FRuntimeMeshImportExportTextureCache& FRuntimeMeshImportExportTextureCache::Get()
+{
+    check(textureCacheInstance.IsValid());
+    return *textureCacheInstance;
+}
+
+void FRuntimeMeshImportExportTextureCache::Startup()
+{
+    textureCacheInstance = MakeUnique<FRuntimeMeshImportExportTextureCache>();
+}
+
+void FRuntimeMeshImportExportTextureCache::Shutdown()
+{
+    textureCacheInstance.Reset();
+}
+
+template<typename KeyType, typename EntryType>
+void FRuntimeMeshImportExportTextureCache::Evict(TMap<KeyType, EntryType>& entries, int64& usedBytes, const int64 budget)
+{
+    while (usedBytes > budget && entries.Num() > 0)
+    {
+        // Linear search, evicting is rare compared to lookups and the cache holds at most a few hundred entries
+        const TPair<KeyType, EntryType>* leastRecent = nullptr;
+        for (const TPair<KeyType, EntryType>& entry : entries)
+        {
+            if (!leastRecent || entry.Value.lastUse < leastRecent->Value.lastUse)
+            {
+                leastRecent = &entry;
+            }
+        }
+        usedBytes -= leastRecent->Value.numBytes;
+        const KeyType key = leastRecent->Key;
+        entries.Remove(key);
+    }
+}
+
+void FRuntimeMeshImportExportTextureCache::SetBudget(const int64 inFileBudget, const int64 inTextureBudget)
+{
+    {
+        FScopeLock lock(&filesLock);
+        fileBudget = FMath::Max<int64>(inFileBudget, 0);
+        Evict(files, fileBytes, fileBudget);
+    }
+
+    check(IsInGameThread());
+    textureBudget = FMath::Max<int64>(inTextureBudget, 0);
+    Evict(textures, textureBytes, textureBudget);
+}
+
+void FRuntimeMeshImportExportTextureCache::Empty()
+{
+    {
+        FScopeLock lock(&filesLock);
+        files.Empty();
+        fileBytes = 0;
+        exportedTextures.Empty();
+    }
+
+    check(IsInGameThread());
+    textures.Empty();
+    textureBytes = 0;
+    materials.Empty();
+}
+
+bool FRuntimeMeshImportExportTextureCache::FindFile_AnyThread(const FString& file, TArray<uint8>& outData)
+{
+    const FFileStatData statData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*file);
+
+    FScopeLock lock(&filesLock);
+    FFileEntry* entry = files.Find(file);
+    if (!entry)
+    {
+        return false;
+    }
+
+    if (!statData.bIsValid || statData.FileSize != entry->fileSize || statData.ModificationTime != entry->modificationTime)
+    {
+        // Changed on disk
+        fileBytes -= entry->numBytes;
+        files.Remove(file);
+        return false;
+    }
+
+    entry->lastUse = ++fileUseCounter;
+    outData = entry->data;
+    return true;
+}
+
+void FRuntimeMeshImportExportTextureCache::AddFile_AnyThread(const FString& file, const TArray<uint8>& data)
+{
+    const FFileStatData statData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*file);
+    if (!statData.bIsValid)
+    {
+        return;
+    }
+
+    FScopeLock lock(&filesLock);
+    if (data.Num() == 0 || data.Num() > fileBudget)
+    {
+        return;
+    }
+
+    if (FFileEntry* existing = files.Find(file))
+    {
+        fileBytes -= existing->numBytes;
+    }
+
+    FFileEntry& entry = files.Add(file);
+    entry.data = data;
+    entry.numBytes = data.Num();
+    entry.fileSize = statData.FileSize;
+    entry.modificationTime = statData.ModificationTime;
+    entry.lastUse = ++fileUseCounter;
+    fileBytes += entry.numBytes;
+
+    Evict(files, fileBytes, fileBudget);
+}
+
+bool FRuntimeMeshImportExportTextureCache::FindExportedTexture_AnyThread(const FString& file, UTexture* texture)
+{
+    const FFileStatData statData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*file);
+
+    FScopeLock lock(&filesLock);
+    const FExportedTextureEntry* entry = exportedTextures.Find(file);
+    if (!entry)
+    {
+        return false;
+    }
+
+    if (!statData.bIsValid || statData.FileSize != entry->fileSize || statData.ModificationTime != entry->modificationTime
+        || entry->texture.Get() != texture || texture->GetLightingGuid() != entry->lightingGuid)
+    {
+        exportedTextures.Remove(file);
+        return false;
+    }
+    return true;
+}
+
+void FRuntimeMeshImportExportTextureCache::AddExportedTexture_AnyThread(const FString& file, UTexture* texture)
+{
+    const FFileStatData statData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*file);
+    if (!statData.bIsValid || !texture)
+    {
+        return;
+    }
+
+    FScopeLock lock(&filesLock);
+    FExportedTextureEntry& entry = exportedTextures.Add(file);
+    entry.texture = texture;
+    entry.lightingGuid = texture->GetLightingGuid();
+    entry.fileSize = statData.FileSize;
+    entry.modificationTime = statData.ModificationTime;
+}
+
+UTexture2D* FRuntimeMeshImportExportTextureCache::FindTexture(const uint64 contentHash)
+{
+    check(IsInGameThread());
+    FTextureEntry* entry = textures.Find(contentHash);
+    if (!entry)
+    {
+        return nullptr;
+    }
+
+    if (!IsValid(entry->texture))
+    {
+        textureBytes -= entry->numBytes;
+        textures.Remove(contentHash);
+        return nullptr;
+    }
+
+    entry->lastUse = ++textureUseCounter;
+    return entry->texture;
+}
+
+void FRuntimeMeshImportExportTextureCache::AddTexture(const uint64 contentHash, UTexture2D* texture)
+{
+    check(IsInGameThread());
+    if (!texture)
+    {
+        return;
+    }
+
+    const int64 numBytes = texture->CalcTextureMemorySizeEnum(TMC_AllMips);
+    if (numBytes > textureBudget)
+    {
+        return;
+    }
+
+    if (FTextureEntry* existing = textures.Find(contentHash))
+    {
+        textureBytes -= existing->numBytes;
+    }
+
+    FTextureEntry& entry = textures.Add(contentHash);
+    entry.texture = texture;
+    entry.numBytes = numBytes;
+    entry.lastUse = ++textureUseCounter;
+    textureBytes += numBytes;
+
+    Evict(textures, textureBytes, textureBudget);
+}
+
+uint64 FRuntimeMeshImportExportTextureCache::HashContent(const FRuntimeMeshImportExportMaterialParamTexture& texture)
+{
+    if (texture.IsDataDeferred())
+    {
+        const uint64 identity = HashFileIdentity(texture.sourceFile);
+        // A missing file must not share the key of unhashed content
+        return identity != 0 ? identity : 1;
+    }
+    return HashContent(texture.byteData, texture.width, texture.height);
+}
+
+uint64 FRuntimeMeshImportExportTextureCache::HashContent(TArrayView<const uint8> bytes, const int32 width, const int32 height)
+{
+    // The same bytes can be a file or raw texels, so the dimensions are part of the hash
+    const uint64 seed = (uint64(uint32(width)) << 32) | uint32(height);
+    const uint64 hash = CityHash64WithSeed(reinterpret_cast<const char*>(bytes.GetData()), bytes.Num(), seed);
+    // 0 is reserved for "not hashed yet"
+    return hash != 0 ? hash : 1;
+}
+
+uint64 FRuntimeMeshImportExportTextureCache::HashFileIdentity(const FString& file)
+{
+    const FFileStatData statData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*file);
+    if (!statData.bIsValid)
+    {
+        return 0;
+    }
+    const FString identity = FString::Printf(TEXT("%s|%lld|%lld"), *file, statData.FileSize, statData.ModificationTime.GetTicks());
+    const uint64 hash = CityHash64(reinterpret_cast<const char*>(*identity), identity.Len() * sizeof(TCHAR));
+    return hash != 0 ? hash : 1;
+}
+
+UMaterialInstanceDynamic* FRuntimeMeshImportExportTextureCache::FindMaterial(UMaterialInterface* sourceMaterial, const uint64 materialInfoHash)
+{
+    check(IsInGameThread());
+    const uint64 key = HashCombine(GetTypeHash(sourceMaterial), GetTypeHash(materialInfoHash));
+    UMaterialInstanceDynamic* found = nullptr;
+    bool bHasStaleEntries = false;
+    for (auto it = materials.CreateKeyIterator(key); it; ++it)
+    {
+        UMaterialInstanceDynamic* material = it.Value().material.Get();
+        if (!material || !it.Value().sourceMaterial.IsValid())
+        {
+            bHasStaleEntries = true;
+        }
+        else if (!found && it.Value().sourceMaterial.Get() == sourceMaterial && material->Parent == sourceMaterial)
+        {
+            found = material;
+        }
+    }
+
+    if (bHasStaleEntries)
+    {
+        for (auto it = materials.CreateKeyIterator(key); it; ++it)
+        {
+            if (!it.Value().material.IsValid() || !it.Value().sourceMaterial.IsValid())
+            {
+                it.RemoveCurrent();
+            }
+        }
+    }
+    return found;
+}
+
+void FRuntimeMeshImportExportTextureCache::AddMaterial(UMaterialInterface* sourceMaterial, const uint64 materialInfoHash, UMaterialInstanceDynamic* material)
+{
+    check(IsInGameThread());
+    if (!sourceMaterial || !material)
+    {
+        return;
+    }
+
+    const uint64 key = HashCombine(GetTypeHash(sourceMaterial), GetTypeHash(materialInfoHash));
+    materials.Add(key, FMaterialEntry{ sourceMaterial, material });
+}
+
+uint64 FRuntimeMeshImportExportTextureCache::HashMaterialInfo(const FRuntimeMeshImportMaterialInfo& materialInfo)
+{
+    // The params in their order, the same file always imports them in the same order
+    TArray<uint8> bytes;
+    FMemoryWriter writer(bytes);
+    uint8 bTwoSided = materialInfo.bTwoSided;
+    uint8 bWireFrame = materialInfo.bWireFrame;
+    uint8 shadingMode = uint8(materialInfo.shadingMode);
+    uint8 blendMode = uint8(materialInfo.blendMode);
+    writer << bTwoSided << bWireFrame << shadingMode << blendMode;
+    for (const FRuntimeMeshImportExportMaterialParamScalar& scalar : materialInfo.scalars)
+    {
+        FString name = scalar.name.ToString();
+        float value = scalar.value;
+        writer << name << value;
+    }
+    for (const FRuntimeMeshImportExportMaterialParamVector& vector : materialInfo.vectors)
+    {
+        FString name = vector.name.ToString();
+        FLinearColor value = vector.value;
+        writer << name << value;
+    }
+    for (const FRuntimeMeshImportExportMaterialParamTexture& texture : materialInfo.textures)
+    {
+        FString name = texture.name.ToString();
+        uint64 contentHash = HashContent(texture);
+        uint8 compression = uint8(texture.compression);
+        writer << name << contentHash << compression;
+    }
+
+    const uint64 hash = CityHash64(reinterpret_cast<const char*>(bytes.GetData()), bytes.Num());
+    return hash != 0 ? hash : 1;
+}
+
+void FRuntimeMeshImportExportTextureCache::AddReferencedObjects(FReferenceCollector& collector)
+{
+    for (TPair<uint64, FTextureEntry>& texture : textures)
+    {
+        collector.AddReferencedObject(texture.Value.texture);
+    }
+}
+
+FString FRuntimeMeshImportExportTextureCache::GetReferencerName() const
+{
+    return TEXT("FRuntimeMeshImportExportTextureCache");
+}
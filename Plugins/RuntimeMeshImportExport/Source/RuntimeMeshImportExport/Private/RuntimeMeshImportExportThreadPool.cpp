@@ -0,0 +1,179 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "RuntimeMeshImportExport.h"
+#include "Async/Async.h"
+#include "Misc/QueuedThreadPool.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Event.h"
+
+// Assimp uses a lot of stack for some formats
+const uint32 importExportThreadStackSize = 1024 * 1024;
+
+static TUniquePtr<FRuntimeMeshImportExportThreadPool> threadPoolInstance;
+
+namespace
+{
+    // Unlike the work of AsyncPool, abandoned work still runs, so the callbacks of the imports and exports are called
+    class FImportExportWork : public IQueuedWork
+    {
+    public:
+        FImportExportWork(TUniqueFunction<void()>&& inWork, FThreadSafeCounter& inNumWork)
+            : work(MoveTemp(inWork))
+            , numWork(inNumWork)
+        {
+        }
+
+        virtual void DoThreadedWork() override
+        {
+            work();
+            numWork.Decrement();
+            delete this;
+        }
+
+        // The pool is destroyed, the work runs on the thread that destroys it
+        virtual void Abandon() override
+        {
+            DoThreadedWork();
+        }
+
+    private:
+        TUniqueFunction<void()> work;
+        FThreadSafeCounter& numWork;
+    };
+}
+
+// Every thread of the pool waits in it until all of them have set their affinity mask
+struct FRuntimeMeshImportExportThreadPool::FAffinityBarrier
+{
+    FThreadSafeCounter numArrived;
+    FEvent* allArrived = FPlatformProcess::GetSynchEventFromPool(true);
+
+    ~FAffinityBarrier()
+    {
+        FPlatformProcess::ReturnSynchEventToPool(allArrived);
+    }
+};
+
+FRuntimeMeshImportExportThreadPool& FRuntimeMeshImportExportThreadPool::Get()
+{
+    check(threadPoolInstance.IsValid());
+    return *threadPoolInstance;
+}
+
+void FRuntimeMeshImportExportThreadPool::Startup()
+{
+    threadPoolInstance = MakeUnique<FRuntimeMeshImportExportThreadPool>();
+}
+
+void FRuntimeMeshImportExportThreadPool::Shutdown()
+{
+    // The abandoned work can start more work, so the instance has to exist until the pool is gone
+    if (threadPoolInstance.IsValid())
+    {
+        threadPoolInstance->DestroyPool();
+    }
+    threadPoolInstance.Reset();
+}
+
+FRuntimeMeshImportExportThreadPool::~FRuntimeMeshImportExportThreadPool()
+{
+    DestroyPool();
+}
+
+void FRuntimeMeshImportExportThreadPool::Run_AnyThread(TUniqueFunction<void()> work)
+{
+    FScopeLock scopeLock(&lock);
+    if (pool && bSettingsChanged && numWork.GetValue() == 0)
+    {
+        DestroyPool();
+    }
+    if (!pool)
+    {
+        CreatePool();
+    }
+
+    numWork.Increment();
+    pool->AddQueuedWork(new FImportExportWork(MoveTemp(work), numWork));
+}
+
+void FRuntimeMeshImportExportThreadPool::Configure(const FRuntimeMeshImportExportThreadPoolSettings& inSettings)
+{
+    FScopeLock scopeLock(&lock);
+    settings = inSettings;
+    bSettingsChanged = true;
+}
+
+FRuntimeMeshImportExportThreadPoolSettings FRuntimeMeshImportExportThreadPool::GetSettings() const
+{
+    FScopeLock scopeLock(&lock);
+    return settings;
+}
+
+void FRuntimeMeshImportExportThreadPool::CreatePool()
+{
+    bSettingsChanged = false;
+    const int32 numThreads = settings.numThreads > 0 ? settings.numThreads : FMath::Max(FPlatformMisc::NumberOfCores() / 2, 1);
+    EThreadPriority priority = TPri_BelowNormal;
+    switch (settings.priority)
+    {
+    case ERuntimeMeshImportExportThreadPriority::Normal:
+        priority = TPri_Normal;
+        break;
+    case ERuntimeMeshImportExportThreadPriority::BelowNormal:
+        priority = TPri_BelowNormal;
+        break;
+    case ERuntimeMeshImportExportThreadPriority::Lowest:
+        priority = TPri_Lowest;
+        break;
+    default:
+        checkNoEntry(); // Every case must be handled
+    }
+
+    pool = FQueuedThreadPool::Allocate();
+    if (!pool->Create(numThreads, importExportThreadStackSize, priority))
+    {
+        RMIE_LOG(Fatal, "Could not create the %d threads of the import and export thread pool.", numThreads);
+    }
+    RMIE_LOG(Log, "Created the import and export thread pool with %d threads.", numThreads);
+
+    if (settings.affinityMask != 0)
+    {
+        // The pool has no access to its threads. Each thread takes one task that waits for the others, so every thread sets its mask.
+        const uint64 affinityMask = uint64(settings.affinityMask);
+        TSharedRef<FAffinityBarrier, ESPMode::ThreadSafe> barrier = MakeShared<FAffinityBarrier, ESPMode::ThreadSafe>();
+        affinityBarrier = barrier;
+        for (int32 threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+        {
+            AsyncPool(*pool, [affinityMask, barrier, numThreads]() {
+                FPlatformProcess::SetThreadAffinityMask(affinityMask);
+                if (barrier->numArrived.Increment() == numThreads)
+                {
+                    barrier->allArrived->Trigger();
+                }
+                barrier->allArrived->Wait();
+            });
+        }
+    }
+}
+
+void FRuntimeMeshImportExportThreadPool::DestroyPool()
+{
+    if (pool)
+    {
+        // The threads that wait for the others to set their affinity mask are released, the other tasks might be abandoned
+        if (TSharedPtr<FAffinityBarrier, ESPMode::ThreadSafe> barrier = affinityBarrier.Pin())
+        {
+            barrier->allArrived->Trigger();
+        }
+        // Waits for the running work, the queued work runs on this thread, @see FImportExportWork::Abandon
+        pool->Destroy();
+        // Work that is started while the pool is destroyed is abandoned by it, so the pool stays until here
+        FScopeLock scopeLock(&lock);
+        delete pool;
+        pool = nullptr;
+    }
+}
@@ -0,0 +1,49 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+class FQueuedThreadPool;
+
+/**
+ *	The threads of the long running work of the async imports and exports, so Assimp does not block the TaskGraph workers
+ *	that the engine needs every frame. The pool is created on first use.
+ *	The short parallel passes within an import, e.g. the mesh conversion, still run on the TaskGraph.
+ */
+class FRuntimeMeshImportExportThreadPool
+{
+public:
+    // Is created and destroyed with the module
+    static FRuntimeMeshImportExportThreadPool& Get();
+    static void Startup();
+    static void Shutdown();
+
+    ~FRuntimeMeshImportExportThreadPool();
+
+    // Runs 'work' on a thread of the pool. Any thread.
+    void Run_AnyThread(TUniqueFunction<void()> work);
+
+    // The pool is created again with 'settings' as soon as no work runs on it anymore
+    void Configure(const FRuntimeMeshImportExportThreadPoolSettings& settings);
+    FRuntimeMeshImportExportThreadPoolSettings GetSettings() const;
+
+private:
+    struct FAffinityBarrier;
+
+    void CreatePool();
+    // Work that is still queued is not dropped, it runs before the pool is gone
+    void DestroyPool();
+
+    mutable FCriticalSection lock;
+    FQueuedThreadPool* pool = nullptr;
+    FRuntimeMeshImportExportThreadPoolSettings settings;
+    bool bSettingsChanged = false;
+    // Queued and running work
+    FThreadSafeCounter numWork;
+    TWeakPtr<FAffinityBarrier, ESPMode::ThreadSafe> affinityBarrier;
+};
@@ -5,37 +5,299 @@
 #include "RuntimeMeshImportExportTypes.h"
 #include "RuntimeMeshImportExportLibrary.h"
 #include "assimp/cexport.h"
+#include "MeshConversionKernels.h"
+#include "AnimationKeySampling.h"
+#include "Animation/MorphTarget.h"
+
+FRuntimeMeshImportExportCancellationToken FRuntimeMeshImportExportCancellationToken::Create()
+{
+    FRuntimeMeshImportExportCancellationToken token;
+    token.bCancelled = MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+    return token;
+}
+
+void FRuntimeMeshImportExportCancellationToken::Cancel() const
+{
+    if (bCancelled.IsValid())
+    {
+        bCancelled->AtomicSet(true);
+    }
+}
+
+bool FRuntimeMeshImportExportCancellationToken::IsCancelled() const
+{
+    return bCancelled.IsValid() && *bCancelled;
+}
+
+namespace
+{
+    /**
+     * Appends the stream 'other' of a section with 'numOtherVertices' to 'stream', whose section has 'numVertices'.
+     * A stream only one of the sections has is padded with 'fill', so the streams stay aligned with the vertices.
+     * 'other' is taken over when 'stream' has no memory yet, otherwise it is copied with one memcpy. 'other' is emptied.
+     */
+    template<typename T>
+    void AppendVertexStream(TArray<T>& stream, TArray<T>&& other, const int32 numVertices, const int32 numOtherVertices, const T& fill)
+    {
+        if (stream.Num() == 0 && other.Num() == 0)
+        {
+            return;
+        }
+        if (numVertices == 0 && stream.Max() == 0 && other.Num() == numOtherVertices)
+        {
+            stream = MoveTemp(other);
+            return;
+        }
+        stream.Reserve(numVertices + numOtherVertices);
+        for (int32 vertex = stream.Num(); vertex < numVertices; ++vertex)
+        {
+            stream.Add(fill);
+        }
+        if (other.Num() == numOtherVertices)
+        {
+            stream.Append(other.GetData(), numOtherVertices);
+        }
+        else
+        {
+            for (int32 vertex = 0; vertex < numOtherVertices; ++vertex)
+            {
+                stream.Add(fill);
+            }
+        }
+        other.Empty();
+    }
+
+    // Appends the indices of a section, offset by the vertices before it. 'other' is taken over when 'triangles' has no memory yet.
+    void AppendTriangles(TArray<int32>& triangles, TArray<int32>&& other, const int32 vertexOffset)
+    {
+        if (vertexOffset == 0 && triangles.Max() == 0)
+        {
+            triangles = MoveTemp(other);
+            return;
+        }
+        const int32 numTriangleIndices = triangles.Num();
+        triangles.AddUninitialized(other.Num());
+        FMeshConversionKernels::OffsetIndices(other.GetData(), triangles.GetData() + numTriangleIndices, other.Num(), vertexOffset);
+        other.Empty();
+    }
+}
 
 void FExportableMeshSection::Append(FExportableMeshSection&& other)
 {
-    check(material == other.material);
+    FExportableMeshSection* const others[] = { &other };
+    AppendAll(others);
+}
 
+void FExportableMeshSection::AppendAll(TArrayView<FExportableMeshSection* const> others)
+{
+    // Every stream is allocated once for all sections
+    int32 numVertices = vertices.Num();
+    int32 numIndices = triangles.Num();
+    bool bHasNormals = normals.Num() > 0;
+    bool bHasTangents = tangents.Num() > 0;
+    bool bHasTextureCoordinates = textureCoordinates.Num() > 0;
+    bool bHasVertexColors = vertexColors.Num() > 0;
+    for (const FExportableMeshSection* other : others)
+    {
+        check(material == other->material);
+        numVertices += other->vertices.Num();
+        numIndices += other->triangles.Num();
+        bHasNormals |= other->normals.Num() > 0;
+        bHasTangents |= other->tangents.Num() > 0;
+        bHasTextureCoordinates |= other->textureCoordinates.Num() > 0;
+        bHasVertexColors |= other->vertexColors.Num() > 0;
+    }
+    // A single section appended to an empty one is taken over instead
+    if (others.Num() > 1 || vertices.Num() > 0)
+    {
+        vertices.Reserve(numVertices);
+        triangles.Reserve(numIndices);
+        normals.Reserve(bHasNormals ? numVertices : 0);
+        tangents.Reserve(bHasTangents ? numVertices : 0);
+        textureCoordinates.Reserve(bHasTextureCoordinates ? numVertices : 0);
+        vertexColors.Reserve(bHasVertexColors ? numVertices : 0);
+    }
 
-    int32 triangleOffset = vertices.Num();
+    for (FExportableMeshSection* other : others)
+    {
+        const int32 vertexOffset = vertices.Num();
+        const int32 numOtherVertices = other->vertices.Num();
+        AppendTriangles(triangles, MoveTemp(other->triangles), vertexOffset);
+        AppendVertexStream(normals, MoveTemp(other->normals), vertexOffset, numOtherVertices, FVector::ZeroVector);
+        AppendVertexStream(tangents, MoveTemp(other->tangents), vertexOffset, numOtherVertices, FVector::ZeroVector);
+        AppendVertexStream(textureCoordinates, MoveTemp(other->textureCoordinates), vertexOffset, numOtherVertices, FVector2D::ZeroVector);
+        // The sections without colors are as white as the export writes them
+        AppendVertexStream(vertexColors, MoveTemp(other->vertexColors), vertexOffset, numOtherVertices, FColor::White);
+        AppendVertexStream(vertices, MoveTemp(other->vertices), vertexOffset, numOtherVertices, FVector::ZeroVector);
+    }
+}
 
-    vertices.Append(other.vertices);
-    normals.Append(other.normals);
-    tangents.Append(other.tangents);
-    textureCoordinates.Append(other.textureCoordinates);
-    vertexColors.Append(other.vertexColors);
+namespace
+{
+    // Pads the bone influences of every vertex with zero weights, so sections with different influence counts can be appended
+    void WidenBoneInfluences(FRuntimeMeshImportSectionInfo& section, const int32 numVertices, const int32 numBoneInfluences)
+    {
+        if (section.numBoneInfluences == numBoneInfluences)
+        {
+            return;
+        }
 
-    triangles.Reserve(triangles.Num() + other.triangles.Num());
+        TArray<uint16> boneIndices;
+        TArray<uint8> boneWeights;
+        boneIndices.SetNumZeroed(numVertices * numBoneInfluences);
+        boneWeights.SetNumZeroed(numVertices * numBoneInfluences);
+        for (int32 vertex = 0; vertex < numVertices && section.numBoneInfluences > 0; ++vertex)
+        {
+            FMemory::Memcpy(&boneIndices[vertex * numBoneInfluences], &section.boneIndices[vertex * section.numBoneInfluences], section.numBoneInfluences * sizeof(uint16));
+            FMemory::Memcpy(&boneWeights[vertex * numBoneInfluences], &section.boneWeights[vertex * section.numBoneInfluences], section.numBoneInfluences * sizeof(uint8));
+        }
+        section.numBoneInfluences = numBoneInfluences;
+        section.boneIndices = MoveTemp(boneIndices);
+        section.boneWeights = MoveTemp(boneWeights);
+    }
+}
 
-    for (int32& tri : other.triangles)
+SIZE_T FRuntimeMeshImportMorphTarget::GetAllocatedSize() const
+{
+    return vertexIndices.GetAllocatedSize() + positionDeltas.GetAllocatedSize() + normalDeltas.GetAllocatedSize();
+}
+
+void FRuntimeMeshImportMorphTarget::ToMorphTargetDeltas(const int32 vertexOffset, TArray<FMorphTargetDelta>& outDeltas) const
+{
+    outDeltas.SetNumUninitialized(vertexIndices.Num());
+    for (int32 index = 0; index < vertexIndices.Num(); ++index)
     {
-        triangles.Add(tri + triangleOffset);
+        FMorphTargetDelta& delta = outDeltas[index];
+        delta.PositionDelta = positionDeltas[index];
+        delta.TangentZDelta = normalDeltas.Num() > 0 ? normalDeltas[index] : FVector::ZeroVector;
+        delta.SourceIdx = uint32(vertexOffset + vertexIndices[index]);
+    }
+}
+
+void FRuntimeMeshImportMorphTarget::Append(TArray<FRuntimeMeshImportMorphTarget>& targets, TArray<FRuntimeMeshImportMorphTarget>&& other, const int32 vertexOffset)
+{
+    for (FRuntimeMeshImportMorphTarget& otherTarget : other)
+    {
+        for (int32& vertexIndex : otherTarget.vertexIndices)
+        {
+            vertexIndex += vertexOffset;
+        }
+
+        FRuntimeMeshImportMorphTarget* target = targets.FindByPredicate([&otherTarget](const FRuntimeMeshImportMorphTarget& existing) {
+            return existing.name == otherTarget.name;
+        });
+        if (!target)
+        {
+            targets.Add(MoveTemp(otherTarget));
+            continue;
+        }
+
+        // The appended vertices come after the existing ones, so the indices stay ascending
+        if (target->normalDeltas.Num() > 0 || otherTarget.normalDeltas.Num() > 0)
+        {
+            target->normalDeltas.SetNumZeroed(target->vertexIndices.Num());
+            otherTarget.normalDeltas.SetNumZeroed(otherTarget.vertexIndices.Num());
+            target->normalDeltas.Append(MoveTemp(otherTarget.normalDeltas));
+        }
+        target->vertexIndices.Append(MoveTemp(otherTarget.vertexIndices));
+        target->positionDeltas.Append(MoveTemp(otherTarget.positionDeltas));
+    }
+    other.Empty();
+}
+
+void FRuntimeMeshImportMorphTarget::Remap(TArray<FRuntimeMeshImportMorphTarget>& targets, TArrayView<const int32> sourceVertices, const int32 numSourceVertices)
+{
+    if (targets.Num() == 0)
+    {
+        return;
+    }
+
+    // For each source vertex the new vertices made from it, a source vertex can be split into several
+    TArray<int32> firstNewVertex;
+    TArray<int32> nextNewVertex;
+    firstNewVertex.Init(INDEX_NONE, numSourceVertices);
+    nextNewVertex.Init(INDEX_NONE, sourceVertices.Num());
+    for (int32 newVertex = sourceVertices.Num() - 1; newVertex >= 0; --newVertex)
+    {
+        const int32 sourceVertex = sourceVertices[newVertex];
+        nextNewVertex[newVertex] = firstNewVertex[sourceVertex];
+        firstNewVertex[sourceVertex] = newVertex;
+    }
+
+    for (int32 targetIndex = targets.Num() - 1; targetIndex >= 0; --targetIndex)
+    {
+        FRuntimeMeshImportMorphTarget& target = targets[targetIndex];
+        const bool bNormals = target.normalDeltas.Num() > 0;
+
+        // Gathered per new vertex and sorted afterwards, the new vertices of one source vertex are not consecutive
+        TArray<TTuple<int32, int32>> newToDelta;
+        newToDelta.Reserve(target.vertexIndices.Num());
+        for (int32 delta = 0; delta < target.vertexIndices.Num(); ++delta)
+        {
+            const int32 sourceVertex = target.vertexIndices[delta];
+            if (sourceVertex < numSourceVertices)
+            {
+                for (int32 newVertex = firstNewVertex[sourceVertex]; newVertex != INDEX_NONE; newVertex = nextNewVertex[newVertex])
+                {
+                    newToDelta.Emplace(newVertex, delta);
+                }
+            }
+        }
+        if (newToDelta.Num() == 0)
+        {
+            targets.RemoveAt(targetIndex);
+            continue;
+        }
+        newToDelta.Sort([](const TTuple<int32, int32>& a, const TTuple<int32, int32>& b) {
+            return a.Get<0>() < b.Get<0>();
+        });
+
+        FRuntimeMeshImportMorphTarget remapped;
+        remapped.name = target.name;
+        remapped.vertexIndices.SetNumUninitialized(newToDelta.Num());
+        remapped.positionDeltas.SetNumUninitialized(newToDelta.Num());
+        remapped.normalDeltas.SetNumUninitialized(bNormals ? newToDelta.Num() : 0);
+        for (int32 entry = 0; entry < newToDelta.Num(); ++entry)
+        {
+            const int32 delta = newToDelta[entry].Get<1>();
+            remapped.vertexIndices[entry] = newToDelta[entry].Get<0>();
+            remapped.positionDeltas[entry] = target.positionDeltas[delta];
+            if (bNormals)
+            {
+                remapped.normalDeltas[entry] = target.normalDeltas[delta];
+            }
+        }
+        target = MoveTemp(remapped);
     }
 }
 
 void FRuntimeMeshImportSectionInfo::Append_Move(FRuntimeMeshImportSectionInfo&& other)
 {
-    URuntimeMeshImportExportLibrary::OffsetTriangleArray(vertices.Num(), other.triangles);
-    vertices.Append(MoveTemp(other.vertices));
-    normals.Append(MoveTemp(other.normals));
-    tangents.Append(MoveTemp(other.tangents));
-    vertexColors.Append(MoveTemp(other.vertexColors));
-    uv0.Append(MoveTemp(other.uv0));
-    triangles.Append(MoveTemp(other.triangles));
+    if (numBoneInfluences > 0 || other.numBoneInfluences > 0)
+    {
+        const int32 mergedBoneInfluences = FMath::Max(numBoneInfluences, other.numBoneInfluences);
+        WidenBoneInfluences(*this, vertices.Num(), mergedBoneInfluences);
+        WidenBoneInfluences(other, other.vertices.Num(), mergedBoneInfluences);
+        boneIndices.Append(MoveTemp(other.boneIndices));
+        boneWeights.Append(MoveTemp(other.boneWeights));
+    }
+
+    // Zero filled like the streams merged by MergeSections of the library
+    const int32 vertexOffset = vertices.Num();
+    const int32 numOtherVertices = other.vertices.Num();
+    FRuntimeMeshImportMorphTarget::Append(morphTargets, MoveTemp(other.morphTargets), vertexOffset);
+    AppendTriangles(triangles, MoveTemp(other.triangles), vertexOffset);
+    AppendVertexStream(normals, MoveTemp(other.normals), vertexOffset, numOtherVertices, FVector::ZeroVector);
+    AppendVertexStream(tangents, MoveTemp(other.tangents), vertexOffset, numOtherVertices, FVector::ZeroVector);
+    AppendVertexStream(vertexColors, MoveTemp(other.vertexColors), vertexOffset, numOtherVertices, FLinearColor(0.f, 0.f, 0.f, 0.f));
+    AppendVertexStream(uv0, MoveTemp(other.uv0), vertexOffset, numOtherVertices, FVector2D::ZeroVector);
+    AppendVertexStream(uv1, MoveTemp(other.uv1), vertexOffset, numOtherVertices, FVector2D::ZeroVector);
+    AppendVertexStream(vertices, MoveTemp(other.vertices), vertexOffset, numOtherVertices, FVector::ZeroVector);
+    bounds += other.bounds;
+    linesAndPoints.Append(MoveTemp(other.linesAndPoints));
+    // The triangles changed
+    bvh.Reset();
+    other.bvh.Reset();
 
     // Retain the material data if it is the same
     materialName = materialName == other.materialName ? materialName : FName();
@@ -45,6 +307,43 @@ void FRuntimeMeshImportSectionInfo::Append_Move(FRuntimeMeshImportSectionInfo&&
     other.materialIndex = INDEX_NONE;
 }
 
+void FRuntimeMeshImportLinesAndPoints::Append(FRuntimeMeshImportLinesAndPoints&& other)
+{
+    const int32 vertexOffset = vertices.Num();
+    const int32 numOtherVertices = other.vertices.Num();
+    AppendTriangles(lineIndices, MoveTemp(other.lineIndices), vertexOffset);
+    AppendTriangles(pointIndices, MoveTemp(other.pointIndices), vertexOffset);
+    AppendVertexStream(colors, MoveTemp(other.colors), vertexOffset, numOtherVertices, FColor::White);
+    AppendVertexStream(vertices, MoveTemp(other.vertices), vertexOffset, numOtherVertices, FVector::ZeroVector);
+    bounds += other.bounds;
+    other.bounds.Init();
+}
+
+FTransform FRuntimeMeshImportAnimationTrack::Sample(const float time, const FTransform& restTransform) const
+{
+    return FAnimationKeySampling::SampleTrack(*this, time, restTransform, [this](const int32 key) { return rotations[key]; });
+}
+
+void FRuntimeMeshImportAnimation::SampleBones(const float time, const TArray<FRuntimeMeshImportBone>& bones, TArray<FTransform>& outLocalTransforms) const
+{
+    outLocalTransforms.SetNumUninitialized(bones.Num());
+    for (int32 boneIndex = 0; boneIndex < bones.Num(); ++boneIndex)
+    {
+        outLocalTransforms[boneIndex] = bones[boneIndex].localTransform;
+    }
+    FAnimationKeySampling::SampleTracks(tracks, time, false, outLocalTransforms);
+}
+
+void FRuntimeMeshImportAnimation::SampleNodes(const float time, const TArray<FRuntimeMeshImportNode>& nodes, TArray<FTransform>& outLocalTransforms) const
+{
+    outLocalTransforms.SetNumUninitialized(nodes.Num());
+    for (int32 nodeIndex = 0; nodeIndex < nodes.Num(); ++nodeIndex)
+    {
+        outLocalTransforms[nodeIndex] = nodes[nodeIndex].localTransform;
+    }
+    FAnimationKeySampling::SampleTracks(tracks, time, true, outLocalTransforms);
+}
+
 FAssimpExportFormat::FAssimpExportFormat(const aiExportFormatDesc* desc) : id(FString(desc->id)), description(FString(desc->description))
 , fileExtension(FString(desc->fileExtension))
 {
@@ -0,0 +1,424 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportHotReloadComponent.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshImportExportTextureCache.h"
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "ProceduralMeshComponent.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Misc/Paths.h"
+#if WITH_RMIE_DIRECTORY_WATCHER
+#include "DirectoryWatcherModule.h"
+#include "IDirectoryWatcher.h"
+#include "Modules/ModuleManager.h"
+#endif
+
+struct URuntimeMeshImportHotReloadComponent::FReloadedScene
+{
+    FRuntimeMeshImportResult result;
+    // One per mesh info, @see URuntimeMeshImportHotReloadComponent::meshes
+    TArray<FName> keys;
+    // One per material info
+    TArray<uint64> materialHashes;
+};
+
+URuntimeMeshImportHotReloadComponent::URuntimeMeshImportHotReloadComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = true;
+}
+
+void URuntimeMeshImportHotReloadComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    if (!bIsWatching)
+    {
+        return;
+    }
+
+    if (watcherHandle.IsValid())
+    {
+#if WITH_RMIE_DIRECTORY_WATCHER
+        // Outside the editor nothing else ticks the watcher
+        FDirectoryWatcherModule* watcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+        IDirectoryWatcher* watcher = watcherModule ? watcherModule->Get() : nullptr;
+        if (watcher && !GIsEditor)
+        {
+            watcher->Tick(DeltaTime);
+        }
+#endif
+    }
+    else
+    {
+        secondsSincePoll += DeltaTime;
+        if (secondsSincePoll >= pollInterval)
+        {
+            secondsSincePoll = 0.f;
+            const FDateTime timeStamp = IFileManager::Get().GetTimeStamp(*importParam.file);
+            if (timeStamp != lastTimeStamp)
+            {
+                lastTimeStamp = timeStamp;
+                secondsSinceChange = 0.f;
+            }
+        }
+    }
+
+    // A change during an import is imported after it
+    if (secondsSinceChange >= 0.f && !bIsImporting)
+    {
+        secondsSinceChange += DeltaTime;
+        if (secondsSinceChange >= debounceSeconds)
+        {
+            StartReload();
+        }
+    }
+}
+
+void URuntimeMeshImportHotReloadComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    StopWatching();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+bool URuntimeMeshImportHotReloadComponent::StartWatching_Cpp(const FRuntimeMeshImportParam& param, FRuntimeHotReloadFinished callbackReloaded)
+{
+    check(IsInGameThread());
+    StopWatching();
+    for (TPair<FName, FWatchedMesh>& mesh : meshes)
+    {
+        if (UProceduralMeshComponent* component = mesh.Value.component.Get())
+        {
+            component->DestroyComponent();
+        }
+    }
+    meshes.Empty();
+    materials.Empty();
+
+    const FString file = URuntimeMeshImportExportLibrary::ResolveImportFilePath(param.file, param.pathType);
+    if (!IFileManager::Get().FileExists(*file))
+    {
+        RMIE_LOG(Warning, "Hot reload: %s does not exist.", *file);
+        return false;
+    }
+
+    importParam = param;
+    importParam.file = file;
+    importParam.pathType = EPathType::Absolute;
+    // One mesh info per mesh in the space of the scene, so each can be diffed and applied on its own
+    importParam.importProfile = ERuntimeMeshImportProfile::Manual;
+    importParam.importMethodMesh = EImportMethodMesh::Keep;
+    importParam.bImportInstanced = false;
+    importParam.bHashGeometry = true;
+
+    delegateReloaded = callbackReloaded;
+    bIsWatching = true;
+    lastTimeStamp = IFileManager::Get().GetTimeStamp(*file);
+    secondsSincePoll = 0.f;
+    RegisterDirectoryWatcher();
+    StartReload();
+    return true;
+}
+
+bool URuntimeMeshImportHotReloadComponent::StartWatching(const FRuntimeMeshImportParam& param, FRuntimeHotReloadFinishedDyn reloadedDelegate)
+{
+    FRuntimeHotReloadFinished callbackReloaded;
+    callbackReloaded.BindLambda([reloadedDelegate](const int32 numChangedMeshes, const int32 numChangedMaterials) {
+        reloadedDelegate.ExecuteIfBound(numChangedMeshes, numChangedMaterials);
+    });
+    return StartWatching_Cpp(param, callbackReloaded);
+}
+
+void URuntimeMeshImportHotReloadComponent::StopWatching()
+{
+    UnregisterDirectoryWatcher();
+    bIsWatching = false;
+    bIsImporting = false;
+    secondsSinceChange = -1.f;
+    ++reloadId;
+}
+
+void URuntimeMeshImportHotReloadComponent::Reload()
+{
+    if (!bIsWatching)
+    {
+        return;
+    }
+
+    if (bIsImporting)
+    {
+        secondsSinceChange = debounceSeconds;
+    }
+    else
+    {
+        StartReload();
+    }
+}
+
+bool URuntimeMeshImportHotReloadComponent::GetIsWatching() const
+{
+    return bIsWatching;
+}
+
+UProceduralMeshComponent* URuntimeMeshImportHotReloadComponent::GetMeshComponent(const FName meshName) const
+{
+    const FWatchedMesh* mesh = meshes.Find(meshName);
+    return mesh ? mesh->component.Get() : nullptr;
+}
+
+void URuntimeMeshImportHotReloadComponent::StartReload()
+{
+    bIsImporting = true;
+    secondsSinceChange = -1.f;
+    const int32 id = ++reloadId;
+
+    TWeakObjectPtr<URuntimeMeshImportHotReloadComponent> weakThis(this);
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([weakThis, id, param = importParam]()
+    {
+        TSharedPtr<FReloadedScene, ESPMode::ThreadSafe> scene = MakeShared<FReloadedScene, ESPMode::ThreadSafe>();
+        URuntimeMeshImportExportLibrary::ImportSceneWithParam(param, scene->result);
+
+        TMap<FName, int32> numByName;
+        for (const FRuntimeMeshImportMeshInfo& meshInfo : scene->result.meshInfos)
+        {
+            int32& num = numByName.FindOrAdd(meshInfo.meshName);
+            scene->keys.Add(num == 0 ? meshInfo.meshName : FName(meshInfo.meshName, NAME_EXTERNAL_TO_INTERNAL(num)));
+            ++num;
+        }
+        // Hashes the bytes of the textures, so it is not done on the GameThread
+        for (const FRuntimeMeshImportMaterialInfo& materialInfo : scene->result.materialInfos)
+        {
+            scene->materialHashes.Add(FRuntimeMeshImportExportTextureCache::HashMaterialInfo(materialInfo));
+        }
+
+        AsyncTask(ENamedThreads::GameThread, [weakThis, id, scene]()
+        {
+            if (URuntimeMeshImportHotReloadComponent* hotReload = weakThis.Get())
+            {
+                hotReload->OnReloadImported(id, scene);
+            }
+        });
+    });
+}
+
+void URuntimeMeshImportHotReloadComponent::OnReloadImported(const int32 inReloadId, TSharedPtr<FReloadedScene, ESPMode::ThreadSafe> scene)
+{
+    if (inReloadId != reloadId)
+    {
+        return;
+    }
+    bIsImporting = false;
+
+    FRuntimeMeshImportResult& result = scene->result;
+    if (!result.bSuccess)
+    {
+        // E.g. the file is still written by a slow exporter, the next change imports it again
+        RMIE_LOG(Warning, "Hot reload: Failed to import %s, the meshes of the last import stay.", *importParam.file);
+        delegateReloaded.ExecuteIfBound(0, 0);
+        return;
+    }
+
+    // The materials that are new are created after the meshes point to them, the ones that are no longer used are dropped
+    TSet<uint64> usedMaterials;
+    TArray<int32> newMaterialIndices;
+    for (int32 materialIndex = 0; materialIndex < scene->materialHashes.Num(); ++materialIndex)
+    {
+        const uint64 materialHash = scene->materialHashes[materialIndex];
+        usedMaterials.Add(materialHash);
+        if (sourceMaterial && !materials.Contains(materialHash))
+        {
+            materials.Add(materialHash, nullptr);
+            newMaterialIndices.Add(materialIndex);
+        }
+    }
+    for (auto it = materials.CreateIterator(); it; ++it)
+    {
+        if (!usedMaterials.Contains(it.Key()))
+        {
+            it.RemoveCurrent();
+        }
+    }
+
+    int32 numChangedMeshes = 0;
+    TSet<FName> keys;
+    for (int32 meshIndex = 0; meshIndex < result.meshInfos.Num(); ++meshIndex)
+    {
+        const FName key = scene->keys[meshIndex];
+        FRuntimeMeshImportMeshInfo& meshInfo = result.meshInfos[meshIndex];
+        keys.Add(key);
+
+        TArray<uint64> sectionMaterialHashes;
+        for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            sectionMaterialHashes.Add(scene->materialHashes.IsValidIndex(section.materialIndex) ? scene->materialHashes[section.materialIndex] : 0);
+        }
+
+        FWatchedMesh* mesh = meshes.Find(key);
+        const bool bGeometryChanged = !mesh || !mesh->component.IsValid() || mesh->geometryHash != meshInfo.geometryHash;
+        if (!mesh)
+        {
+            mesh = &meshes.Add(key);
+        }
+
+        if (bGeometryChanged)
+        {
+            mesh->geometryHash = meshInfo.geometryHash;
+            mesh->sectionMaterialHashes = MoveTemp(sectionMaterialHashes);
+            ApplyMesh(key, *mesh, MoveTemp(meshInfo));
+            ++numChangedMeshes;
+        }
+        else if (mesh->sectionMaterialHashes != sectionMaterialHashes)
+        {
+            mesh->sectionMaterialHashes = MoveTemp(sectionMaterialHashes);
+            SetMeshMaterials(*mesh);
+        }
+    }
+
+    for (auto it = meshes.CreateIterator(); it; ++it)
+    {
+        if (!keys.Contains(it.Key()))
+        {
+            if (UProceduralMeshComponent* component = it.Value().component.Get())
+            {
+                component->DestroyComponent();
+            }
+            it.RemoveCurrent();
+            ++numChangedMeshes;
+        }
+    }
+
+    for (const int32 materialIndex : newMaterialIndices)
+    {
+        CreateMaterial(scene->materialHashes[materialIndex], result.materialInfos[materialIndex]);
+    }
+
+    RMIE_LOG(Log, "Hot reload: %s changed %d meshes and %d materials.", *importParam.file, numChangedMeshes, newMaterialIndices.Num());
+    delegateReloaded.ExecuteIfBound(numChangedMeshes, newMaterialIndices.Num());
+}
+
+void URuntimeMeshImportHotReloadComponent::ApplyMesh(const FName key, FWatchedMesh& mesh, FRuntimeMeshImportMeshInfo&& meshInfo)
+{
+    UProceduralMeshComponent* component = mesh.component.Get();
+    if (!component)
+    {
+        component = NewObject<UProceduralMeshComponent>(GetOwner(), NAME_None, RF_Transient);
+        component->SetupAttachment(this);
+        component->RegisterComponent();
+        mesh.component = component;
+    }
+
+    FRuntimeMeshImportResult meshResult;
+    meshResult.bSuccess = true;
+    meshResult.meshInfos.Add(MoveTemp(meshInfo));
+
+    TWeakObjectPtr<URuntimeMeshImportHotReloadComponent> weakThis(this);
+    FRuntimeImportExportGameThreadDone callbackApplied;
+    callbackApplied.BindLambda([weakThis, key, geometryHash = mesh.geometryHash]() {
+        URuntimeMeshImportHotReloadComponent* hotReload = weakThis.Get();
+        const FWatchedMesh* appliedMesh = hotReload ? hotReload->meshes.Find(key) : nullptr;
+        // The new sections have no materials yet. Skipped when a later import changed the mesh again.
+        if (appliedMesh && appliedMesh->geometryHash == geometryHash)
+        {
+            hotReload->SetMeshMaterials(*appliedMesh);
+        }
+    });
+    URuntimeMeshImportExportLibrary::ApplyImportResultToProceduralMesh_Async_Cpp(component, MoveTemp(meshResult), TArray<UMaterialInterface*>()
+                                                                                 , callbackApplied, bCreateCollision);
+}
+
+void URuntimeMeshImportHotReloadComponent::SetMeshMaterials(const FWatchedMesh& mesh) const
+{
+    UProceduralMeshComponent* component = mesh.component.Get();
+    if (!component)
+    {
+        return;
+    }
+
+    const int32 numSections = FMath::Min(mesh.sectionMaterialHashes.Num(), component->GetNumSections());
+    for (int32 sectionIndex = 0; sectionIndex < numSections; ++sectionIndex)
+    {
+        // A material that is still created is set when its textures are assigned, until then the section keeps the one it has
+        UMaterialInterface* const* material = materials.Find(mesh.sectionMaterialHashes[sectionIndex]);
+        if (material && *material)
+        {
+            component->SetMaterial(sectionIndex, *material);
+        }
+    }
+}
+
+void URuntimeMeshImportHotReloadComponent::CreateMaterial(const uint64 materialHash, const FRuntimeMeshImportMaterialInfo& materialInfo)
+{
+    TWeakObjectPtr<URuntimeMeshImportHotReloadComponent> weakThis(this);
+    FRuntimeDynamicMaterialCreated callbackCreated;
+    callbackCreated.BindLambda([weakThis, materialHash](UMaterialInstanceDynamic* material) {
+        URuntimeMeshImportHotReloadComponent* hotReload = weakThis.Get();
+        UMaterialInterface** entry = hotReload ? hotReload->materials.Find(materialHash) : nullptr;
+        // Dropped when a later import no longer uses it
+        if (!entry)
+        {
+            return;
+        }
+
+        *entry = material;
+        for (const TPair<FName, FWatchedMesh>& mesh : hotReload->meshes)
+        {
+            if (mesh.Value.sectionMaterialHashes.Contains(materialHash))
+            {
+                hotReload->SetMeshMaterials(mesh.Value);
+            }
+        }
+    });
+    // Calls back right away when the material is in the texture cache
+    URuntimeMeshImportExportLibrary::MaterialInfoToDynamicMaterial_Async_Cpp(this, materialInfo, sourceMaterial, callbackCreated);
+}
+
+void URuntimeMeshImportHotReloadComponent::OnDirectoryChanged(const TArray<FFileChangeData>& changes)
+{
+#if WITH_RMIE_DIRECTORY_WATCHER
+    for (const FFileChangeData& change : changes)
+    {
+        if (FPaths::IsSamePath(change.Filename, importParam.file))
+        {
+            secondsSinceChange = 0.f;
+            return;
+        }
+    }
+#endif
+}
+
+void URuntimeMeshImportHotReloadComponent::RegisterDirectoryWatcher()
+{
+#if WITH_RMIE_DIRECTORY_WATCHER
+    // Not every target that links the module can load it
+    FDirectoryWatcherModule* watcherModule = FModuleManager::LoadModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+    IDirectoryWatcher* watcher = watcherModule ? watcherModule->Get() : nullptr;
+    watchedDirectory = FPaths::GetPath(importParam.file);
+    if (!watcher || !watcher->RegisterDirectoryChangedCallback_Handle(watchedDirectory
+        , IDirectoryWatcher::FDirectoryChanged::CreateUObject(this, &URuntimeMeshImportHotReloadComponent::OnDirectoryChanged), watcherHandle))
+    {
+        RMIE_LOG(Log, "Hot reload: Can't watch %s, polling the timestamp of the file instead.", *watchedDirectory);
+        watcherHandle.Reset();
+    }
+#endif
+}
+
+void URuntimeMeshImportHotReloadComponent::UnregisterDirectoryWatcher()
+{
+#if WITH_RMIE_DIRECTORY_WATCHER
+    if (watcherHandle.IsValid())
+    {
+        FDirectoryWatcherModule* watcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+        if (IDirectoryWatcher* watcher = watcherModule ? watcherModule->Get() : nullptr)
+        {
+            watcher->UnregisterDirectoryChangedCallback_Handle(watchedDirectory, watcherHandle);
+        }
+    }
+#endif
+    watcherHandle.Reset();
+}
@@ -0,0 +1,125 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportMeshComponent.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "RuntimeMeshImportCompactTypes.h"
+#include "RuntimeMeshStaticMeshBuilder.h"
+#include "Async/Async.h"
+#include "Engine/StaticMesh.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "StaticMeshResources.h"
+
+void URuntimeMeshImportMeshComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // Drops the builds that are still running
+    ++buildId;
+    bBuildPending = false;
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void URuntimeMeshImportMeshComponent::SetCompactMesh(FRuntimeMeshImportCompactMeshInfo&& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeImportExportGameThreadDone callbackDone)
+{
+    BuildMesh(MoveTemp(meshInfo), materials, callbackDone);
+}
+
+void URuntimeMeshImportMeshComponent::SetMeshInfo(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeImportExportGameThreadDoneDyn callbackDone)
+{
+    FRuntimeImportExportGameThreadDone callbackDoneRaw;
+    callbackDoneRaw.BindLambda([callbackDone]() {
+        callbackDone.ExecuteIfBound();
+    });
+    SetMeshInfo_Cpp(FRuntimeMeshImportMeshInfo(meshInfo), materials, callbackDoneRaw);
+}
+
+void URuntimeMeshImportMeshComponent::SetMeshInfo_Cpp(FRuntimeMeshImportMeshInfo&& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeImportExportGameThreadDone callbackDone)
+{
+    BuildMesh(MoveTemp(meshInfo), materials, callbackDone);
+}
+
+template<typename MeshInfoType>
+void URuntimeMeshImportMeshComponent::BuildMesh(MeshInfoType&& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeImportExportGameThreadDone callbackDone)
+{
+    check(IsInGameThread());
+    const int32 thisBuildId = ++buildId;
+    bBuildPending = true;
+
+    // The materials are not kept alive while the buffers are built, a destroyed material gets the default one
+    TArray<TWeakObjectPtr<UMaterialInterface>> weakMaterials;
+    for (UMaterialInterface* material : materials)
+    {
+        weakMaterials.Add(material);
+    }
+
+    TWeakObjectPtr<URuntimeMeshImportMeshComponent> weakThis(this);
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([weakThis, thisBuildId, meshInfo = MoveTemp(meshInfo), weakMaterials = MoveTemp(weakMaterials)
+        , bKeepCollision = bCreateCollision, callbackDone]() mutable {
+        TArray<FName> slotNames;
+        TUniquePtr<FStaticMeshRenderData> renderData = FRuntimeMeshStaticMeshBuilder::BuildRenderData_AnyThread(meshInfo, slotNames);
+        if (!renderData.IsValid())
+        {
+            RMIE_LOG(Warning, "Mesh %s has no triangles, the component shows nothing.", *meshInfo.meshName.ToString());
+        }
+
+        FRuntimeMeshImportMeshInfo collisionMesh;
+        collisionMesh.meshName = meshInfo.meshName;
+        if (bKeepCollision)
+        {
+            collisionMesh.collision = MoveTemp(meshInfo.collision);
+        }
+        // The vertices are in the render data now, they are freed here instead of on the GameThread
+        meshInfo = MeshInfoType();
+
+        AsyncTask(ENamedThreads::GameThread, [weakThis, thisBuildId, renderData = MoveTemp(renderData), slotNames = MoveTemp(slotNames), weakMaterials = MoveTemp(weakMaterials)
+            , collisionMesh = MoveTemp(collisionMesh), callbackDone]() mutable {
+            if (URuntimeMeshImportMeshComponent* component = weakThis.Get())
+            {
+                component->OnRenderDataBuilt(thisBuildId, MoveTemp(renderData), slotNames, weakMaterials, MoveTemp(collisionMesh), callbackDone);
+            }
+        });
+    });
+}
+
+void URuntimeMeshImportMeshComponent::OnRenderDataBuilt(const int32 thisBuildId, TUniquePtr<FStaticMeshRenderData>&& renderData, const TArray<FName>& slotNames
+    , const TArray<TWeakObjectPtr<UMaterialInterface>>& materials, FRuntimeMeshImportMeshInfo&& collisionMesh, FRuntimeImportExportGameThreadDone callbackDone)
+{
+    check(IsInGameThread());
+    if (thisBuildId != buildId)
+    {
+        return;
+    }
+    bBuildPending = false;
+
+    TArray<UMaterialInterface*> slotMaterials;
+    for (const TWeakObjectPtr<UMaterialInterface>& material : materials)
+    {
+        slotMaterials.Add(material.Get());
+    }
+    // Starts the upload of the buffers on the render thread, the render data does not keep a CPU copy of them
+    UStaticMesh* staticMesh = FRuntimeMeshStaticMeshBuilder::CreateStaticMesh_GameThread(MoveTemp(renderData), slotNames, slotMaterials);
+    SetStaticMesh(staticMesh);
+    callbackDone.ExecuteIfBound();
+
+    if (!staticMesh || collisionMesh.collision.IsEmpty())
+    {
+        return;
+    }
+
+    TWeakObjectPtr<URuntimeMeshImportMeshComponent> weakThis(this);
+    TWeakObjectPtr<UStaticMesh> weakMesh(staticMesh);
+    FRuntimeBodySetupCreated callbackCooked;
+    callbackCooked.BindLambda([weakThis, weakMesh](UBodySetup* bodySetup) {
+        URuntimeMeshImportMeshComponent* component = weakThis.Get();
+        UStaticMesh* cookedMesh = weakMesh.Get();
+        if (bodySetup && component && cookedMesh && component->GetStaticMesh() == cookedMesh)
+        {
+            cookedMesh->BodySetup = bodySetup;
+            component->RecreatePhysicsState();
+        }
+    });
+    URuntimeMeshImportExportLibrary::MeshInfoToBodySetup_Async_Cpp(collisionMesh, callbackCooked);
+}
@@ -0,0 +1,369 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportPointCloud.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "AssimpImporterPool.h"
+#include "AssimpIOSystem.h"
+#include "MeshTextParsing.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Paths.h"
+#include "assimp/Importer.hpp"
+#include "assimp/scene.h"
+#include "assimp/postprocess.h"
+
+namespace
+{
+    bool IsSeparator(const uint8 character)
+    {
+        return FMeshTextParsing::IsBlank(character) || character == ',' || character == ';';
+    }
+
+    // The points of the lines in [begin, end)
+    void ParseTextPoints(const uint8* begin, const uint8* end, const FTransform& transform, TArray<FVector>& outPoints, TArray<FColor>& outColors, bool& bOutHasColors)
+    {
+        const uint8* cursor = begin;
+        double values[7];
+        while (cursor < end)
+        {
+            int32 numValues = 0;
+            bool bLineValid = true;
+            while (cursor < end && !FMeshTextParsing::IsLineEnd(*cursor))
+            {
+                if (IsSeparator(*cursor))
+                {
+                    ++cursor;
+                    continue;
+                }
+                double value;
+                if (!FMeshTextParsing::ParseFloat(cursor, end, value))
+                {
+                    bLineValid = false;
+                    while (cursor < end && !IsSeparator(*cursor) && !FMeshTextParsing::IsLineEnd(*cursor))
+                    {
+                        ++cursor;
+                    }
+                }
+                else if (numValues < int32(UE_ARRAY_COUNT(values)))
+                {
+                    values[numValues++] = value;
+                }
+            }
+            FMeshTextParsing::SkipLine(cursor, end);
+
+            if (!bLineValid || numValues < 3)
+            {
+                continue;
+            }
+            // Mirrored at z, like aiProcess_MakeLeftHanded
+            outPoints.Add(transform.TransformPosition(FVector(float(values[0]), float(values[1]), float(-values[2]))));
+            // "x y z r g b" or "x y z intensity r g b"
+            const int32 firstColor = numValues >= 7 ? 4 : (numValues == 6 ? 3 : INDEX_NONE);
+            if (firstColor != INDEX_NONE)
+            {
+                const double maxChannel = FMath::Max3(values[firstColor], values[firstColor + 1], values[firstColor + 2]);
+                // Some scanners write the colors from 0 to 1
+                const double colorScale = maxChannel <= 1.0 ? 255.0 : 1.0;
+                outColors.Add(FColor(
+                    uint8(FMath::Clamp(FMath::RoundToInt(values[firstColor] * colorScale), 0, 255)),
+                    uint8(FMath::Clamp(FMath::RoundToInt(values[firstColor + 1] * colorScale), 0, 255)),
+                    uint8(FMath::Clamp(FMath::RoundToInt(values[firstColor + 2] * colorScale), 0, 255))));
+                bOutHasColors = true;
+            }
+            else
+            {
+                outColors.Add(FColor::White);
+            }
+        }
+    }
+
+    bool ReadTextPoints(const FString& file, const FRuntimeMeshImportPointCloudParam& param, TArray<FVector>& outPoints, TArray<FColor>& outColors)
+    {
+        FAssimpIOSystem ioSystem(FPaths::GetPath(file), param.bMemoryMapFile);
+        TArray<uint8> buffer;
+        TArrayView<const uint8> view;
+        Assimp::IOStream* stream = ioSystem.OpenView(TCHAR_TO_UTF8(*file), buffer, view);
+        if (!stream)
+        {
+            RMIE_LOG(Warning, "Could not open the point cloud file %s", *file);
+            return false;
+        }
+
+        // Each chunk starts after a line break, so its lines are complete
+        TArray<const uint8*> chunkStarts;
+        FMeshTextParsing::SplitIntoLineChunks(view, FMeshTextParsing::defaultChunkSize, chunkStarts);
+        const int32 numChunks = chunkStarts.Num() - 1;
+        TArray<TArray<FVector>> chunkPoints;
+        TArray<TArray<FColor>> chunkColors;
+        TArray<bool> chunkHasColors;
+        chunkPoints.SetNum(numChunks);
+        chunkColors.SetNum(numChunks);
+        chunkHasColors.SetNumZeroed(numChunks);
+        ParallelFor(numChunks, [&](int32 chunk)
+        {
+            ParseTextPoints(chunkStarts[chunk], chunkStarts[chunk + 1], param.transform, chunkPoints[chunk], chunkColors[chunk], chunkHasColors[chunk]);
+        });
+        ioSystem.Close(stream);
+
+        int32 numPoints = 0;
+        for (const TArray<FVector>& points : chunkPoints)
+        {
+            numPoints += points.Num();
+        }
+        const bool bHasColors = chunkHasColors.Contains(true);
+        outPoints.Reserve(numPoints);
+        outColors.Reserve(bHasColors ? numPoints : 0);
+        for (int32 chunk = 0; chunk < numChunks; ++chunk)
+        {
+            outPoints.Append(MoveTemp(chunkPoints[chunk]));
+            if (bHasColors)
+            {
+                outColors.Append(MoveTemp(chunkColors[chunk]));
+            }
+        }
+        return true;
+    }
+
+    void GatherNodePoints(const aiScene* scene, const aiNode* node, const FTransform& parentTransform, TArray<FVector>& outPoints, TArray<FColor>& outColors, bool& bOutHasColors)
+    {
+        const FTransform transform = URuntimeMeshImportExportLibrary::AiTransformToFTransform(node->mTransformation) * parentTransform;
+        const FMatrix matrix = transform.ToMatrixWithScale();
+        for (uint32 nodeMeshIndex = 0; nodeMeshIndex < node->mNumMeshes; ++nodeMeshIndex)
+        {
+            const aiMesh* mesh = scene->mMeshes[node->mMeshes[nodeMeshIndex]];
+            const bool bMeshHasColors = mesh->HasVertexColors(0);
+            bOutHasColors |= bMeshHasColors;
+            for (uint32 vertex = 0; vertex < mesh->mNumVertices; ++vertex)
+            {
+                const aiVector3D& position = mesh->mVertices[vertex];
+                outPoints.Add(matrix.TransformPosition(FVector(position.x, position.y, position.z)));
+                if (bMeshHasColors)
+                {
+                    const aiColor4D& color = mesh->mColors[0][vertex];
+                    // The files store the colors as they are displayed
+                    outColors.Add(FLinearColor(color.r, color.g, color.b, color.a).ToFColor(false));
+                }
+                else
+                {
+                    outColors.Add(FColor::White);
+                }
+            }
+        }
+        for (uint32 child = 0; child < node->mNumChildren; ++child)
+        {
+            GatherNodePoints(scene, node->mChildren[child], transform, outPoints, outColors, bOutHasColors);
+        }
+    }
+
+    bool ReadAssimpPoints(const FString& file, const FRuntimeMeshImportPointCloudParam& param, TArray<FVector>& outPoints, TArray<FColor>& outColors)
+    {
+        FAssimpIOSystem ioSystem(FPaths::GetPath(file), param.bMemoryMapFile);
+        FScopedAssimpImporter scopedImporter;
+        Assimp::Importer& importer = *scopedImporter;
+        importer.SetIOHandler(&ioSystem);
+        const aiScene* scene = importer.ReadFile(TCHAR_TO_UTF8(*file), aiProcess_MakeLeftHanded);
+        importer.SetIOHandler(nullptr);
+        if (!scene || !scene->mRootNode)
+        {
+            RMIE_LOG(Warning, "Assimp failed to read file. File: %s, Error: %s", *file, *FString(importer.GetErrorString()));
+            return false;
+        }
+
+        bool bHasColors = false;
+        GatherNodePoints(scene, scene->mRootNode, param.transform, outPoints, outColors, bHasColors);
+        importer.FreeScene();
+        if (!bHasColors)
+        {
+            outColors.Empty();
+        }
+        return true;
+    }
+
+    // A node of the octree level that is being built, with the points that are not yet in a parent
+    struct FPendingNode
+    {
+        int32 nodeIndex = INDEX_NONE;
+        TArray<int32> points;
+    };
+
+    struct FSampledNode
+    {
+        TArray<int32> kept;
+        TArray<int32> children[8];
+    };
+
+    FRuntimeMeshImportPointCloudPosition QuantizePosition(const FVector& position, const FBox& bounds)
+    {
+        const FVector normalized = (position - bounds.Min) / bounds.GetSize();
+        FRuntimeMeshImportPointCloudPosition quantized;
+        quantized.x = uint16(FMath::Clamp(FMath::RoundToInt(normalized.X * 65535.f), 0, 65535));
+        quantized.y = uint16(FMath::Clamp(FMath::RoundToInt(normalized.Y * 65535.f), 0, 65535));
+        quantized.z = uint16(FMath::Clamp(FMath::RoundToInt(normalized.Z * 65535.f), 0, 65535));
+        return quantized;
+    }
+
+    int32 GetCell(const float coordinate, const float min, const float cellSize, const int32 numCells)
+    {
+        return FMath::Clamp(FMath::FloorToInt((coordinate - min) / cellSize), 0, numCells - 1);
+    }
+}
+
+SIZE_T FRuntimeMeshImportPointCloud::GetAllocatedSize() const
+{
+    return nodes.GetAllocatedSize() + positions.GetAllocatedSize() + colors.GetAllocatedSize();
+}
+
+bool FRuntimeMeshImportPointCloudImporter::IsTextPointFile(const FString& file)
+{
+    const FString extension = FPaths::GetExtension(file);
+    return extension.Equals(TEXT("xyz"), ESearchCase::IgnoreCase)
+        || extension.Equals(TEXT("pts"), ESearchCase::IgnoreCase)
+        || extension.Equals(TEXT("txt"), ESearchCase::IgnoreCase);
+}
+
+bool FRuntimeMeshImportPointCloudImporter::Import_AnyThread(const FRuntimeMeshImportPointCloudParam& param, FRuntimeMeshImportPointCloud& outPointCloud)
+{
+    FString file = URuntimeMeshImportExportLibrary::ResolveImportFilePath(param.file, param.pathType);
+    FPaths::NormalizeFilename(file);
+
+    const double startTime = FPlatformTime::Seconds();
+    TArray<FVector> points;
+    TArray<FColor> colors;
+    if (IsTextPointFile(file) ? !ReadTextPoints(file, param, points, colors) : !ReadAssimpPoints(file, param, points, colors))
+    {
+        return false;
+    }
+    if (points.Num() == 0)
+    {
+        RMIE_LOG(Warning, "The point cloud file %s has no points.", *file);
+        return false;
+    }
+
+    const double startTimeOctree = FPlatformTime::Seconds();
+    const int32 numPoints = points.Num();
+    BuildOctree(param, MoveTemp(points), MoveTemp(colors), outPointCloud);
+    RMIE_LOG(Log, "Imported %d points of %s in %.2f s, %d octree nodes built in %.2f s, %.1f MB."
+        , numPoints, *file, float(startTimeOctree - startTime), outPointCloud.nodes.Num(), float(FPlatformTime::Seconds() - startTimeOctree)
+        , float(double(outPointCloud.GetAllocatedSize()) / (1024.0 * 1024.0)));
+    return true;
+}
+
+void FRuntimeMeshImportPointCloudImporter::BuildOctree(const FRuntimeMeshImportPointCloudParam& param, TArray<FVector>&& points, TArray<FColor>&& colors, FRuntimeMeshImportPointCloud& outPointCloud)
+{
+    outPointCloud = FRuntimeMeshImportPointCloud();
+    if (points.Num() == 0)
+    {
+        return;
+    }
+
+    for (const FVector& point : points)
+    {
+        outPointCloud.bounds += point;
+    }
+    // Cubes, so the sampling cells are cubes as well
+    const FVector center = outPointCloud.bounds.GetCenter();
+    const float halfSize = FMath::Max(outPointCloud.bounds.GetExtent().GetMax(), 0.5f);
+
+    const bool bHasColors = colors.Num() == points.Num();
+    const int32 gridSize = FMath::Clamp(param.nodeGridSize, 4, 1024);
+    const int32 maxLeafPoints = FMath::Max(param.maxLeafPoints, 1);
+    outPointCloud.positions.Reserve(points.Num());
+    outPointCloud.colors.Reserve(bHasColors ? points.Num() : 0);
+
+    FRuntimeMeshImportPointCloudNode& root = outPointCloud.nodes.AddDefaulted_GetRef();
+    root.bounds = FBox(center - FVector(halfSize), center + FVector(halfSize));
+    TArray<FPendingNode> level;
+    FPendingNode& pendingRoot = level.AddDefaulted_GetRef();
+    pendingRoot.nodeIndex = 0;
+    pendingRoot.points.SetNumUninitialized(points.Num());
+    for (int32 point = 0; point < points.Num(); ++point)
+    {
+        pendingRoot.points[point] = point;
+    }
+
+    // Level by level, the nodes of a level do not share points
+    while (level.Num() > 0)
+    {
+        TArray<FSampledNode> sampled;
+        sampled.SetNum(level.Num());
+        ParallelFor(level.Num(), [&](int32 levelIndex)
+        {
+            const FPendingNode& pending = level[levelIndex];
+            const FRuntimeMeshImportPointCloudNode& node = outPointCloud.nodes[pending.nodeIndex];
+            FSampledNode& sample = sampled[levelIndex];
+            if (pending.points.Num() <= maxLeafPoints || node.depth >= param.maxDepth)
+            {
+                sample.kept = pending.points;
+                return;
+            }
+
+            // The first point of each cell stays in the node, in the order of the file
+            const float cellSize = node.bounds.GetSize().X / float(gridSize);
+            const FVector nodeCenter = node.bounds.GetCenter();
+            TSet<uint32> occupiedCells;
+            occupiedCells.Reserve(FMath::Min(pending.points.Num(), gridSize * gridSize * 4));
+            for (const int32 point : pending.points)
+            {
+                const FVector& position = points[point];
+                const uint32 cell = (uint32(GetCell(position.X, node.bounds.Min.X, cellSize, gridSize)) * uint32(gridSize)
+                    + uint32(GetCell(position.Y, node.bounds.Min.Y, cellSize, gridSize))) * uint32(gridSize)
+                    + uint32(GetCell(position.Z, node.bounds.Min.Z, cellSize, gridSize));
+                bool bAlreadyOccupied = false;
+                occupiedCells.Add(cell, &bAlreadyOccupied);
+                if (!bAlreadyOccupied)
+                {
+                    sample.kept.Add(point);
+                    continue;
+                }
+                const int32 octant = (position.X >= nodeCenter.X ? 1 : 0) | (position.Y >= nodeCenter.Y ? 2 : 0) | (position.Z >= nodeCenter.Z ? 4 : 0);
+                sample.children[octant].Add(point);
+            }
+        });
+
+        TArray<FPendingNode> nextLevel;
+        for (int32 levelIndex = 0; levelIndex < level.Num(); ++levelIndex)
+        {
+            const int32 nodeIndex = level[levelIndex].nodeIndex;
+            FSampledNode& sample = sampled[levelIndex];
+            {
+                FRuntimeMeshImportPointCloudNode& node = outPointCloud.nodes[nodeIndex];
+                node.firstPoint = outPointCloud.positions.Num();
+                node.numPoints = sample.kept.Num();
+                node.spacing = node.bounds.GetSize().X / float(gridSize);
+                for (const int32 point : sample.kept)
+                {
+                    outPointCloud.positions.Add(QuantizePosition(points[point], node.bounds));
+                    if (bHasColors)
+                    {
+                        outPointCloud.colors.Add(colors[point]);
+                    }
+                }
+            }
+            level[levelIndex].points.Empty();
+
+            for (int32 octant = 0; octant < 8; ++octant)
+            {
+                if (sample.children[octant].Num() == 0)
+                {
+                    continue;
+                }
+                const FRuntimeMeshImportPointCloudNode& parent = outPointCloud.nodes[nodeIndex];
+                const FVector parentCenter = parent.bounds.GetCenter();
+                FRuntimeMeshImportPointCloudNode child;
+                child.depth = parent.depth + 1;
+                child.bounds.Min = FVector(octant & 1 ? parentCenter.X : parent.bounds.Min.X, octant & 2 ? parentCenter.Y : parent.bounds.Min.Y, octant & 4 ? parentCenter.Z : parent.bounds.Min.Z);
+                child.bounds.Max = child.bounds.Min + parent.bounds.GetExtent();
+                child.bounds.IsValid = 1;
+                const int32 childIndex = outPointCloud.nodes.Add(child);
+                outPointCloud.nodes[nodeIndex].children[octant] = childIndex;
+
+                FPendingNode& pendingChild = nextLevel.AddDefaulted_GetRef();
+                pendingChild.nodeIndex = childIndex;
+                pendingChild.points = MoveTemp(sample.children[octant]);
+            }
+        }
+        level = MoveTemp(nextLevel);
+    }
+}
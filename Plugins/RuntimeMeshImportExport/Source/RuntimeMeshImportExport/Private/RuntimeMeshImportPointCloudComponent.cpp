@@ -0,0 +1,261 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportPointCloudComponent.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "ProceduralMeshComponent.h"
+#include "Async/Async.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Kismet/GameplayStatics.h"
+
+URuntimeMeshImportPointCloudComponent::URuntimeMeshImportPointCloudComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = true;
+}
+
+void URuntimeMeshImportPointCloudComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    secondsSinceUpdate += DeltaTime;
+    if (secondsSinceUpdate >= updateInterval)
+    {
+        secondsSinceUpdate = 0.f;
+        UpdateNodes();
+    }
+}
+
+void URuntimeMeshImportPointCloudComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    ClearNodes();
+    if (meshComponent)
+    {
+        meshComponent->DestroyComponent();
+        meshComponent = nullptr;
+    }
+    ++loadId;
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void URuntimeMeshImportPointCloudComponent::LoadPointCloud(const FRuntimeMeshImportPointCloudParam& param)
+{
+    const int32 thisLoadId = ++loadId;
+    TWeakObjectPtr<URuntimeMeshImportPointCloudComponent> weakThis(this);
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([param, weakThis, thisLoadId]() {
+        TSharedPtr<FRuntimeMeshImportPointCloud, ESPMode::ThreadSafe> loaded = MakeShared<FRuntimeMeshImportPointCloud, ESPMode::ThreadSafe>();
+        if (!FRuntimeMeshImportPointCloudImporter::Import_AnyThread(param, *loaded))
+        {
+            loaded.Reset();
+        }
+        AsyncTask(ENamedThreads::GameThread, [weakThis, thisLoadId, loaded]() {
+            URuntimeMeshImportPointCloudComponent* component = weakThis.Get();
+            if (component && component->loadId == thisLoadId)
+            {
+                component->SetPointCloud(loaded);
+            }
+        });
+    });
+}
+
+void URuntimeMeshImportPointCloudComponent::SetPointCloud(TSharedPtr<const FRuntimeMeshImportPointCloud, ESPMode::ThreadSafe> inPointCloud)
+{
+    ClearNodes();
+    pointCloud = inPointCloud;
+    // Shows the first nodes right away
+    secondsSinceUpdate = updateInterval;
+}
+
+int32 URuntimeMeshImportPointCloudComponent::GetNumPoints() const
+{
+    return pointCloud.IsValid() ? pointCloud->NumPoints() : 0;
+}
+
+void URuntimeMeshImportPointCloudComponent::SetViewerLocationOverride(const FVector& location)
+{
+    viewerLocationOverride = location;
+    bHasViewerLocationOverride = true;
+}
+
+void URuntimeMeshImportPointCloudComponent::ClearViewerLocationOverride()
+{
+    bHasViewerLocationOverride = false;
+}
+
+void URuntimeMeshImportPointCloudComponent::UpdateNodes()
+{
+    FVector viewerLocation;
+    if (!pointCloud.IsValid() || pointCloud->nodes.Num() == 0 || !GetViewerLocation(viewerLocation))
+    {
+        return;
+    }
+
+    // The nodes are relative to this component
+    const FVector localViewerLocation = GetComponentTransform().InverseTransformPosition(viewerLocation);
+    auto getPriority = [this, &localViewerLocation](const int32 nodeIndex) {
+        const FRuntimeMeshImportPointCloudNode& node = pointCloud->nodes[nodeIndex];
+        return node.spacing / FMath::Max(FMath::Sqrt(node.bounds.ComputeSquaredDistanceToPoint(localViewerLocation)), 1.f);
+    };
+    auto isHigherPriority = [](const TPair<float, int32>& a, const TPair<float, int32>& b) {
+        return a.Key > b.Key;
+    };
+
+    // The closest and coarsest nodes first. The points of the children add to those of their parent, so a node is only shown with its parent.
+    TArray<int32> wantedNodes;
+    TArray<TPair<float, int32>> candidates;
+    candidates.HeapPush(TPair<float, int32>(getPriority(0), 0), isHigherPriority);
+    int32 numWantedPoints = 0;
+    while (candidates.Num() > 0)
+    {
+        TPair<float, int32> candidate;
+        candidates.HeapPop(candidate, isHigherPriority, false);
+        const FRuntimeMeshImportPointCloudNode& node = pointCloud->nodes[candidate.Value];
+        if ((candidate.Value != 0 && candidate.Key < minSpacingPerDistance) || numWantedPoints + node.numPoints > pointBudget)
+        {
+            continue;
+        }
+        wantedNodes.Add(candidate.Value);
+        numWantedPoints += node.numPoints;
+        for (const int32 child : node.children)
+        {
+            if (child != INDEX_NONE)
+            {
+                candidates.HeapPush(TPair<float, int32>(getPriority(child), child), isHigherPriority);
+            }
+        }
+    }
+
+    const TSet<int32> wantedSet(wantedNodes);
+    TArray<int32> hiddenNodes;
+    for (const TPair<int32, int32>& shown : nodeSections)
+    {
+        if (!wantedSet.Contains(shown.Key))
+        {
+            hiddenNodes.Add(shown.Key);
+        }
+    }
+    for (const int32 nodeIndex : hiddenNodes)
+    {
+        HideNode(nodeIndex);
+    }
+
+    int32 numShownThisUpdate = 0;
+    for (int32 wantedIndex = 0; wantedIndex < wantedNodes.Num() && numShownThisUpdate < maxNodesPerUpdate; ++wantedIndex)
+    {
+        if (!nodeSections.Contains(wantedNodes[wantedIndex]))
+        {
+            ShowNode(wantedNodes[wantedIndex], localViewerLocation);
+            ++numShownThisUpdate;
+        }
+    }
+}
+
+bool URuntimeMeshImportPointCloudComponent::GetViewerLocation(FVector& outLocation) const
+{
+    if (bHasViewerLocationOverride)
+    {
+        outLocation = viewerLocationOverride;
+        return true;
+    }
+
+    if (APlayerCameraManager* cameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0))
+    {
+        outLocation = cameraManager->GetCameraLocation();
+        return true;
+    }
+    return false;
+}
+
+void URuntimeMeshImportPointCloudComponent::ShowNode(const int32 nodeIndex, const FVector& localViewerLocation)
+{
+    if (!meshComponent)
+    {
+        meshComponent = NewObject<UProceduralMeshComponent>(GetOwner(), NAME_None, RF_Transient);
+        meshComponent->SetupAttachment(this);
+        meshComponent->RegisterComponent();
+    }
+
+    const FRuntimeMeshImportPointCloudNode& node = pointCloud->nodes[nodeIndex];
+    // The quads of a node face the viewer as it was when the node was shown
+    const FVector facing = (localViewerLocation - node.bounds.GetCenter()).GetSafeNormal(SMALL_NUMBER, FVector::UpVector);
+    const FMatrix basis = FRotationMatrix::MakeFromX(facing);
+    const float halfSize = pointSize * 0.5f;
+    const FVector right = basis.GetScaledAxis(EAxis::Y) * halfSize;
+    const FVector up = basis.GetScaledAxis(EAxis::Z) * halfSize;
+
+    TArray<FVector> vertices;
+    TArray<int32> triangles;
+    TArray<FVector> normals;
+    TArray<FVector2D> uv0;
+    TArray<FColor> colors;
+    vertices.SetNumUninitialized(node.numPoints * 4);
+    triangles.SetNumUninitialized(node.numPoints * 6);
+    normals.Init(facing, node.numPoints * 4);
+    uv0.SetNumUninitialized(node.numPoints * 4);
+    colors.SetNumUninitialized(node.numPoints * 4);
+    for (int32 point = 0; point < node.numPoints; ++point)
+    {
+        const int32 pointIndex = node.firstPoint + point;
+        const FVector position = pointCloud->GetPosition(node, pointIndex);
+        const FColor color = pointCloud->GetColor(pointIndex);
+        const int32 firstVertex = point * 4;
+        vertices[firstVertex + 0] = position - right - up;
+        vertices[firstVertex + 1] = position - right + up;
+        vertices[firstVertex + 2] = position + right + up;
+        vertices[firstVertex + 3] = position + right - up;
+        uv0[firstVertex + 0] = FVector2D(0.f, 1.f);
+        uv0[firstVertex + 1] = FVector2D(0.f, 0.f);
+        uv0[firstVertex + 2] = FVector2D(1.f, 0.f);
+        uv0[firstVertex + 3] = FVector2D(1.f, 1.f);
+        for (int32 corner = 0; corner < 4; ++corner)
+        {
+            colors[firstVertex + corner] = color;
+        }
+        // Clockwise seen from the viewer
+        int32* quad = &triangles[point * 6];
+        quad[0] = firstVertex + 0;
+        quad[1] = firstVertex + 1;
+        quad[2] = firstVertex + 2;
+        quad[3] = firstVertex + 0;
+        quad[4] = firstVertex + 2;
+        quad[5] = firstVertex + 3;
+    }
+
+    const int32 sectionIndex = freeSections.Num() > 0 ? freeSections.Pop(false) : nodeSections.Num();
+    meshComponent->CreateMeshSection(sectionIndex, vertices, triangles, normals, uv0, colors, TArray<FProcMeshTangent>(), false);
+    if (pointMaterial)
+    {
+        meshComponent->SetMaterial(sectionIndex, pointMaterial);
+    }
+    nodeSections.Add(nodeIndex, sectionIndex);
+    numShownPoints += node.numPoints;
+}
+
+void URuntimeMeshImportPointCloudComponent::HideNode(const int32 nodeIndex)
+{
+    int32 sectionIndex;
+    if (!nodeSections.RemoveAndCopyValue(nodeIndex, sectionIndex))
+    {
+        return;
+    }
+    if (meshComponent)
+    {
+        meshComponent->ClearMeshSection(sectionIndex);
+    }
+    freeSections.Add(sectionIndex);
+    numShownPoints -= pointCloud.IsValid() ? pointCloud->nodes[nodeIndex].numPoints : 0;
+}
+
+void URuntimeMeshImportPointCloudComponent::ClearNodes()
+{
+    if (meshComponent)
+    {
+        meshComponent->ClearAllMeshSections();
+    }
+    nodeSections.Empty();
+    freeSections.Empty();
+    numShownPoints = 0;
+}
@@ -0,0 +1,576 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportReplication.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportStats.h"
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "RuntimeMeshImportSerialization.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "Misc/Compression.h"
+
+namespace
+{
+    // "RMIR"
+    const uint32 replicationMagic = 0x52494D52;
+    // Increase with every change of the layout, peers with another version reject the chunks
+    const uint32 replicationVersion = 2;
+
+    struct FReplicationChunkHeader
+    {
+        uint32 magic = replicationMagic;
+        uint32 version = replicationVersion;
+        uint64 transferId = 0;
+        int64 payloadSize = 0;
+        int32 chunkSize = 0;
+        int32 chunkIndex = 0;
+        int32 numChunks = 0;
+        // The bytes of the payload in this chunk
+        int32 rawSize = 0;
+        // 0 when the chunk did not compress and is stored raw
+        int32 compressedSize = 0;
+    };
+
+    // The fewest bytes an element of the payload can be written as, so a count can be rejected before it is allocated. A count or string length is 4 bytes.
+    const int64 minMorphTargetSize = 4 + 3 * 4;
+    // The fixed values and the counts of the streams, the indices, the skin weights and the morph targets
+    const int64 minSectionSize = 4 + sizeof(int32) + sizeof(FBox) + 1 + 4 + 6 * 4 + 1 + 4 + sizeof(int32) + 2 * 4 + 4;
+    const int64 minLODSize = sizeof(float) + 4;
+    // The fixed values, the section and LOD counts and the three counts of the collision
+    const int64 minMeshSize = 4 + 4 + sizeof(FBox) + sizeof(int64) + 4 + 4 + 3 * 4;
+    const int64 minMaterialSize = 4 + 2 * sizeof(uint8) + sizeof(ERuntimeMeshImportExportMaterialShadingMode) + sizeof(int32)
+        + sizeof(ERuntimeMeshImportExportMaterialBlendMode) + sizeof(int32) + 3 * 4;
+    const int64 minAnimationSize = 4 + sizeof(float) + 4;
+
+    int32 GetNumChunks(const int64 payloadSize, const int32 chunkSize)
+    {
+        return FMath::Max(1, int32((payloadSize + chunkSize - 1) / chunkSize));
+    }
+
+    uint32 ZigZag(const int32 value)
+    {
+        return (uint32(value) << 1) ^ uint32(value >> 31);
+    }
+
+    int32 UnZigZag(const uint32 value)
+    {
+        return int32(value >> 1) ^ -int32(value & 1);
+    }
+
+    // Neighbouring triangles share vertices, so the differences to the previous index are small and mostly take one byte
+    void WriteIndices(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportCompactSection& section)
+    {
+        const int32 numIndices = section.GetNumIndices();
+        writer.WriteValue<uint8>(section.indices16.Num() > 0);
+        writer.WriteValue<int32>(numIndices);
+        int32 previous = 0;
+        for (int32 index = 0; index < numIndices; ++index)
+        {
+            const int32 vertex = section.GetIndex(index);
+            writer.WriteVarUInt(ZigZag(vertex - previous));
+            previous = vertex;
+        }
+    }
+
+    bool ReadIndices(FRuntimeMeshByteReader& reader, const int32 numVertices, FRuntimeMeshImportCompactSection& section)
+    {
+        uint8 b16BitIndices = 0;
+        int32 numIndices = 0;
+        // Each index takes at least a byte
+        if (!reader.ReadValue(b16BitIndices) || !reader.ReadNum(numIndices, 1)
+            || (b16BitIndices && numVertices > MAX_uint16 + 1))
+        {
+            return false;
+        }
+        if (b16BitIndices)
+        {
+            section.indices16.SetNumUninitialized(numIndices);
+        }
+        else
+        {
+            section.indices32.SetNumUninitialized(numIndices);
+        }
+
+        int32 previous = 0;
+        for (int32 index = 0; index < numIndices; ++index)
+        {
+            uint32 delta = 0;
+            if (!reader.ReadVarUInt(delta))
+            {
+                return false;
+            }
+            const int32 vertex = previous + UnZigZag(delta);
+            if (vertex < 0 || vertex >= numVertices)
+            {
+                return false;
+            }
+            if (b16BitIndices)
+            {
+                section.indices16[index] = uint16(vertex);
+            }
+            else
+            {
+                section.indices32[index] = uint32(vertex);
+            }
+            previous = vertex;
+        }
+        return true;
+    }
+
+    // Quantized to 16 bits within the bounds of the vertices, each axis delta coded against the previous vertex
+    void WritePositions(FRuntimeMeshByteWriter& writer, const TArray<FVector>& vertices, const bool bQuantize)
+    {
+        writer.WriteValue<uint8>(bQuantize);
+        if (!bQuantize)
+        {
+            writer.WriteArray(vertices);
+            return;
+        }
+
+        const FBox box(vertices.GetData(), vertices.Num());
+        const FVector origin = vertices.Num() > 0 ? box.Min : FVector::ZeroVector;
+        const FVector extent = vertices.Num() > 0 ? box.Max - box.Min : FVector::ZeroVector;
+        writer.WriteValue<int32>(vertices.Num());
+        writer.WriteValue(origin);
+        writer.WriteValue(extent);
+        int32 previous[3] = { 0, 0, 0 };
+        for (const FVector& vertex : vertices)
+        {
+            for (int32 axis = 0; axis < 3; ++axis)
+            {
+                const float unit = extent[axis] > 0.f ? (vertex[axis] - origin[axis]) / extent[axis] : 0.f;
+                const int32 quantized = FMath::Clamp(FMath::RoundToInt(unit * float(MAX_uint16)), 0, int32(MAX_uint16));
+                writer.WriteVarUInt(ZigZag(quantized - previous[axis]));
+                previous[axis] = quantized;
+            }
+        }
+    }
+
+    bool ReadPositions(FRuntimeMeshByteReader& reader, TArray<FVector>& vertices)
+    {
+        uint8 bQuantized = 0;
+        if (!reader.ReadValue(bQuantized))
+        {
+            return false;
+        }
+        if (!bQuantized)
+        {
+            return reader.ReadArray(vertices);
+        }
+
+        int32 numVertices = 0;
+        FVector origin;
+        FVector extent;
+        // Each axis takes at least a byte
+        if (!reader.ReadNum(numVertices, 3)
+            || !reader.ReadValue(origin) || !reader.ReadValue(extent))
+        {
+            return false;
+        }
+        vertices.SetNumUninitialized(numVertices);
+        int32 previous[3] = { 0, 0, 0 };
+        for (FVector& vertex : vertices)
+        {
+            for (int32 axis = 0; axis < 3; ++axis)
+            {
+                uint32 delta = 0;
+                if (!reader.ReadVarUInt(delta))
+                {
+                    return false;
+                }
+                previous[axis] += UnZigZag(delta);
+                vertex[axis] = origin[axis] + float(previous[axis]) / float(MAX_uint16) * extent[axis];
+            }
+        }
+        return true;
+    }
+
+    void WriteSection(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportCompactSection& section, const FRuntimeMeshImportReplicationOptions& options)
+    {
+        writer.WriteName(section.materialName);
+        writer.WriteValue(section.materialIndex);
+        writer.WriteValue(section.bounds);
+        WritePositions(writer, section.vertices, options.bQuantizePositions);
+        writer.WriteArray(section.normals);
+        writer.WriteArray(section.tangents);
+        writer.WriteArray(section.uv0Half);
+        writer.WriteArray(section.uv0);
+        writer.WriteArray(section.uv1);
+        writer.WriteArray(section.vertexColors);
+        WriteIndices(writer, section);
+
+        writer.WriteValue(section.numBoneInfluences);
+        writer.WriteArray(section.boneIndices);
+        writer.WriteArray(section.boneWeights);
+
+        writer.WriteValue<int32>(section.morphTargets.Num());
+        for (const FRuntimeMeshImportCompactMorphTarget& target : section.morphTargets)
+        {
+            writer.WriteName(target.name);
+            writer.WriteArray(target.vertexIndices);
+            writer.WriteArray(target.positionDeltas);
+            writer.WriteArray(target.normalDeltas);
+        }
+    }
+
+    bool ReadSection(FRuntimeMeshByteReader& reader, FRuntimeMeshImportCompactSection& section)
+    {
+        if (!reader.ReadName(section.materialName) || !reader.ReadValue(section.materialIndex) || !reader.ReadValue(section.bounds)
+            || !ReadPositions(reader, section.vertices) || !reader.ReadArray(section.normals) || !reader.ReadArray(section.tangents)
+            || !reader.ReadArray(section.uv0Half) || !reader.ReadArray(section.uv0) || !reader.ReadArray(section.uv1) || !reader.ReadArray(section.vertexColors))
+        {
+            return false;
+        }
+
+        // The vertex streams are empty or have a value per vertex
+        const int32 numVertices = section.vertices.Num();
+        const auto isVertexStream = [numVertices](const int32 num) { return num == 0 || num == numVertices; };
+        if (!isVertexStream(section.normals.Num()) || !isVertexStream(section.tangents.Num()) || !isVertexStream(section.uv0Half.Num())
+            || !isVertexStream(section.uv0.Num()) || !isVertexStream(section.uv1.Num()) || !isVertexStream(section.vertexColors.Num())
+            || !ReadIndices(reader, numVertices, section))
+        {
+            return false;
+        }
+
+        if (!reader.ReadValue(section.numBoneInfluences) || section.numBoneInfluences < 0 || !reader.ReadArray(section.boneIndices) || !reader.ReadArray(section.boneWeights)
+            || section.boneIndices.Num() != numVertices * section.numBoneInfluences || section.boneWeights.Num() != section.boneIndices.Num())
+        {
+            return false;
+        }
+
+        int32 numMorphTargets = 0;
+        if (!reader.ReadNum(numMorphTargets, minMorphTargetSize))
+        {
+            return false;
+        }
+        section.morphTargets.SetNum(numMorphTargets);
+        for (FRuntimeMeshImportCompactMorphTarget& target : section.morphTargets)
+        {
+            if (!reader.ReadName(target.name) || !reader.ReadArray(target.vertexIndices) || !reader.ReadArray(target.positionDeltas) || !reader.ReadArray(target.normalDeltas)
+                || target.positionDeltas.Num() != target.vertexIndices.Num() || (target.normalDeltas.Num() > 0 && target.normalDeltas.Num() != target.vertexIndices.Num() * 3))
+            {
+                return false;
+            }
+            for (const int32 vertex : target.vertexIndices)
+            {
+                if (vertex < 0 || vertex >= numVertices)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void WriteSections(FRuntimeMeshByteWriter& writer, const TArray<FRuntimeMeshImportCompactSection>& sections, const FRuntimeMeshImportReplicationOptions& options)
+    {
+        writer.WriteValue<int32>(sections.Num());
+        for (const FRuntimeMeshImportCompactSection& section : sections)
+        {
+            WriteSection(writer, section, options);
+        }
+    }
+
+    bool ReadSections(FRuntimeMeshByteReader& reader, TArray<FRuntimeMeshImportCompactSection>& sections)
+    {
+        int32 numSections = 0;
+        if (!reader.ReadNum(numSections, minSectionSize))
+        {
+            return false;
+        }
+        sections.SetNum(numSections);
+        for (FRuntimeMeshImportCompactSection& section : sections)
+        {
+            if (!ReadSection(reader, section))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void WriteResult(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportCompactResult& result, const FRuntimeMeshImportReplicationOptions& options)
+    {
+        writer.WriteValue<uint8>(result.bSuccess);
+        writer.WriteValue<int32>(result.meshInfos.Num());
+        for (const FRuntimeMeshImportCompactMeshInfo& meshInfo : result.meshInfos)
+        {
+            writer.WriteName(meshInfo.meshName);
+            writer.WriteArray(meshInfo.instanceTransforms);
+            writer.WriteValue(meshInfo.bounds);
+            writer.WriteValue(meshInfo.geometryHash);
+            WriteSections(writer, meshInfo.sections, options);
+            writer.WriteValue<int32>(meshInfo.lods.Num());
+            for (const FRuntimeMeshImportCompactMeshLOD& lod : meshInfo.lods)
+            {
+                writer.WriteValue(lod.screenSize);
+                WriteSections(writer, lod.sections, options);
+            }
+            FRuntimeMeshImportSerialization::WriteCollision(writer, meshInfo.collision);
+        }
+        writer.WriteValue<int32>(result.materialInfos.Num());
+        for (const FRuntimeMeshImportMaterialInfo& material : result.materialInfos)
+        {
+            FRuntimeMeshImportSerialization::WriteMaterial(writer, material);
+        }
+        FRuntimeMeshImportSerialization::WriteNodes(writer, result.nodes);
+        FRuntimeMeshImportSerialization::WriteBones(writer, result.bones);
+        writer.WriteValue<int32>(result.animations.Num());
+        for (const FRuntimeMeshImportCompactAnimation& animation : result.animations)
+        {
+            FRuntimeMeshImportSerialization::WriteAnimation(writer, animation);
+        }
+    }
+
+    bool ReadResult(FRuntimeMeshByteReader& reader, FRuntimeMeshImportCompactResult& result)
+    {
+        uint8 bSuccess = 0;
+        int32 numMeshes = 0;
+        if (!reader.ReadValue(bSuccess) || !reader.ReadNum(numMeshes, minMeshSize))
+        {
+            return false;
+        }
+        result.bSuccess = bSuccess != 0;
+        result.meshInfos.SetNum(numMeshes);
+        for (FRuntimeMeshImportCompactMeshInfo& meshInfo : result.meshInfos)
+        {
+            int32 numLODs = 0;
+            if (!reader.ReadName(meshInfo.meshName) || !reader.ReadArray(meshInfo.instanceTransforms) || !reader.ReadValue(meshInfo.bounds)
+                || !reader.ReadValue(meshInfo.geometryHash) || !ReadSections(reader, meshInfo.sections) || !reader.ReadNum(numLODs, minLODSize))
+            {
+                return false;
+            }
+            meshInfo.lods.SetNum(numLODs);
+            for (FRuntimeMeshImportCompactMeshLOD& lod : meshInfo.lods)
+            {
+                if (!reader.ReadValue(lod.screenSize) || !ReadSections(reader, lod.sections))
+                {
+                    return false;
+                }
+            }
+            if (!FRuntimeMeshImportSerialization::ReadCollision(reader, meshInfo.collision))
+            {
+                return false;
+            }
+        }
+
+        int32 numMaterials = 0;
+        if (!reader.ReadNum(numMaterials, minMaterialSize))
+        {
+            return false;
+        }
+        result.materialInfos.SetNum(numMaterials);
+        for (FRuntimeMeshImportMaterialInfo& material : result.materialInfos)
+        {
+            if (!FRuntimeMeshImportSerialization::ReadMaterial(reader, material))
+            {
+                return false;
+            }
+        }
+
+        int32 numAnimations = 0;
+        if (!FRuntimeMeshImportSerialization::ReadNodes(reader, result.nodes, result.meshInfos.Num()) || !FRuntimeMeshImportSerialization::ReadBones(reader, result.bones)
+            || !reader.ReadNum(numAnimations, minAnimationSize))
+        {
+            return false;
+        }
+        for (const FRuntimeMeshImportCompactMeshInfo& meshInfo : result.meshInfos)
+        {
+            for (const FRuntimeMeshImportCompactSection& section : meshInfo.sections)
+            {
+                if (!FRuntimeMeshImportSerialization::AreBoneIndicesValid(section.boneIndices, result.bones.Num()))
+                {
+                    return false;
+                }
+            }
+            for (const FRuntimeMeshImportCompactMeshLOD& lod : meshInfo.lods)
+            {
+                for (const FRuntimeMeshImportCompactSection& section : lod.sections)
+                {
+                    if (!FRuntimeMeshImportSerialization::AreBoneIndicesValid(section.boneIndices, result.bones.Num()))
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        result.animations.SetNum(numAnimations);
+        for (FRuntimeMeshImportCompactAnimation& animation : result.animations)
+        {
+            if (!FRuntimeMeshImportSerialization::ReadAnimation(reader, animation, result.bones.Num(), result.nodes.Num()))
+            {
+                return false;
+            }
+        }
+        return reader.IsAtEnd();
+    }
+}
+
+const int32 FRuntimeMeshImportReplicationReceiver::maxChunkSize;
+
+int64 FRuntimeMeshImportReplicationPayload::GetNumBytes() const
+{
+    int64 numBytes = 0;
+    for (const TArray<uint8>& chunk : chunks)
+    {
+        numBytes += chunk.Num();
+    }
+    return numBytes;
+}
+
+bool FRuntimeMeshImportReplicationReceiver::AddChunk(TArrayView<const uint8> chunk)
+{
+    FReplicationChunkHeader header;
+    if (chunk.Num() < int32(sizeof(FReplicationChunkHeader)))
+    {
+        return false;
+    }
+    FMemory::Memcpy(&header, chunk.GetData(), sizeof(FReplicationChunkHeader));
+    const int32 numChunkBytes = chunk.Num() - int32(sizeof(FReplicationChunkHeader));
+    if (header.magic != replicationMagic || header.version != replicationVersion || header.payloadSize < 0 || header.payloadSize > FMath::Min<int64>(maxPayloadSize, MAX_int32)
+        || header.chunkSize <= 0 || header.chunkSize > maxChunkSize
+        || header.numChunks != GetNumChunks(header.payloadSize, header.chunkSize) || header.payloadSize > int64(header.numChunks) * maxChunkSize || header.chunkIndex < 0 || header.chunkIndex >= header.numChunks
+        || header.rawSize != int32(FMath::Min<int64>(header.chunkSize, header.payloadSize - int64(header.chunkIndex) * header.chunkSize))
+        || numChunkBytes != (header.compressedSize > 0 ? header.compressedSize : header.rawSize))
+    {
+        return false;
+    }
+
+    if (numChunks == 0)
+    {
+        transferId = header.transferId;
+        payloadSize = header.payloadSize;
+        chunkSize = header.chunkSize;
+        numChunks = header.numChunks;
+        payload.SetNumUninitialized(payloadSize);
+        receivedChunks.Init(false, numChunks);
+    }
+    else if (header.transferId != transferId || header.payloadSize != payloadSize || header.chunkSize != chunkSize)
+    {
+        return false;
+    }
+    if (receivedChunks[header.chunkIndex])
+    {
+        return true;
+    }
+
+    const uint8* chunkBytes = chunk.GetData() + sizeof(FReplicationChunkHeader);
+    uint8* dest = payload.GetData() + int64(header.chunkIndex) * chunkSize;
+    if (header.compressedSize > 0)
+    {
+        if (!FCompression::UncompressMemory(NAME_Zlib, dest, header.rawSize, chunkBytes, header.compressedSize))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        FMemory::Memcpy(dest, chunkBytes, header.rawSize);
+    }
+    receivedChunks[header.chunkIndex] = true;
+    ++numReceived;
+    return true;
+}
+
+void FRuntimeMeshImportReplicationReceiver::GetMissingChunks(TArray<int32>& outChunks) const
+{
+    outChunks.Reset();
+    for (int32 chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+    {
+        if (!receivedChunks[chunkIndex])
+        {
+            outChunks.Add(chunkIndex);
+        }
+    }
+}
+
+bool FRuntimeMeshImportReplicationReceiver::Finish_AnyThread(FRuntimeMeshImportCompactResult& outResult) const
+{
+    // The hash catches chunks of equal size from a sender that changed its result but not the transfer id
+    if (!IsComplete() || CityHash64(reinterpret_cast<const char*>(payload.GetData()), payload.Num()) != transferId)
+    {
+        return false;
+    }
+
+    FRuntimeMeshByteReader reader(payload.GetData(), payload.Num());
+    FRuntimeMeshImportCompactResult result;
+    if (!ReadResult(reader, result))
+    {
+        return false;
+    }
+    outResult = MoveTemp(result);
+    return true;
+}
+
+FRuntimeMeshImportReplicationPayloadRef FRuntimeMeshImportReplication::Serialize_AnyThread(const FRuntimeMeshImportCompactResult& result, const FRuntimeMeshImportReplicationOptions& options)
+{
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_ExportStaging);
+    FRuntimeMeshByteWriter writer;
+    WriteResult(writer, result, options);
+
+    TSharedRef<FRuntimeMeshImportReplicationPayload, ESPMode::ThreadSafe> payload = MakeShared<FRuntimeMeshImportReplicationPayload, ESPMode::ThreadSafe>();
+    payload->transferId = CityHash64(reinterpret_cast<const char*>(writer.bytes.GetData()), writer.bytes.Num());
+    const int32 chunkSize = FMath::Clamp(options.chunkSize, 1024, FRuntimeMeshImportReplicationReceiver::maxChunkSize);
+    const int32 numChunks = GetNumChunks(writer.bytes.Num(), chunkSize);
+    payload->chunks.SetNum(numChunks);
+    ParallelFor(numChunks, [&writer, &payload, chunkSize, numChunks](const int32 chunkIndex)
+    {
+        FReplicationChunkHeader header;
+        header.transferId = payload->transferId;
+        header.payloadSize = writer.bytes.Num();
+        header.chunkSize = chunkSize;
+        header.chunkIndex = chunkIndex;
+        header.numChunks = numChunks;
+        header.rawSize = FMath::Min(chunkSize, writer.bytes.Num() - chunkIndex * chunkSize);
+        const uint8* raw = writer.bytes.GetData() + chunkIndex * chunkSize;
+
+        TArray<uint8>& chunk = payload->chunks[chunkIndex];
+        int32 compressedSize = FCompression::CompressMemoryBound(NAME_Zlib, header.rawSize);
+        chunk.SetNumUninitialized(sizeof(FReplicationChunkHeader) + compressedSize);
+        if (FCompression::CompressMemory(NAME_Zlib, chunk.GetData() + sizeof(FReplicationChunkHeader), compressedSize, raw, header.rawSize)
+            && compressedSize < header.rawSize)
+        {
+            header.compressedSize = compressedSize;
+            chunk.SetNum(sizeof(FReplicationChunkHeader) + compressedSize, false);
+        }
+        else
+        {
+            chunk.SetNum(sizeof(FReplicationChunkHeader) + header.rawSize, false);
+            FMemory::Memcpy(chunk.GetData() + sizeof(FReplicationChunkHeader), raw, header.rawSize);
+        }
+        FMemory::Memcpy(chunk.GetData(), &header, sizeof(FReplicationChunkHeader));
+    });
+
+    RMIE_LOG(Log, "Serialized %d meshes into %d chunks, %lld bytes compressed from %d.", result.meshInfos.Num(), numChunks, payload->GetNumBytes(), writer.bytes.Num());
+    return payload;
+}
+
+void FRuntimeMeshImportReplication::Serialize_Async_Cpp(FRuntimeMeshImportCompactResultPtr result, const FRuntimeMeshImportReplicationOptions& options, FRuntimeReplicationSerialized callbackSerialized)
+{
+    check(result.IsValid());
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([result, options, callbackSerialized]() {
+        FRuntimeMeshImportReplicationPayloadRef payload = Serialize_AnyThread(*result, options);
+        AsyncTask(ENamedThreads::GameThread, [payload, callbackSerialized]() {
+            callbackSerialized.ExecuteIfBound(payload);
+        });
+    });
+}
+
+void FRuntimeMeshImportReplication::Deserialize_Async_Cpp(FRuntimeMeshImportReplicationReceiver&& receiver, FRuntimeReplicationDeserialized callbackDeserialized)
+{
+    FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([receiver = MoveTemp(receiver), callbackDeserialized]() {
+        RMIE_LLM_SCOPE(STAT_RMIE_LLM_ImportConversion);
+        FRuntimeMeshImportCompactResultPtr result = MakeShared<FRuntimeMeshImportCompactResult, ESPMode::ThreadSafe>();
+        if (!receiver.Finish_AnyThread(*result))
+        {
+            RMIE_LOG(Warning, "Failed to decode a replicated import result, %d of %d chunks received.", receiver.GetNumReceivedChunks(), receiver.GetNumChunks());
+            result.Reset();
+        }
+        AsyncTask(ENamedThreads::GameThread, [result, callbackDeserialized]() {
+            callbackDeserialized.ExecuteIfBound(result);
+        });
+    });
+}
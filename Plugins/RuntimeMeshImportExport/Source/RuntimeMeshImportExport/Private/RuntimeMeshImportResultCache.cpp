@@ -0,0 +1,610 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportResultCache.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportBVH.h"
+#include "RuntimeMeshImportSerialization.h"
+#include "Algo/AllOf.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    // "RMIC"
+    const uint32 cacheMagic = 0x43494D52;
+    // Increase with every change of the layout or of the conversion, old cache files are ignored then
+    const uint32 cacheVersion = 17;
+
+    struct FResultCacheHeader
+    {
+        uint32 magic = cacheMagic;
+        uint32 version = cacheVersion;
+        uint64 paramHash = 0;
+        int64 sourceSize = 0;
+        int64 sourceModificationTicks = 0;
+        // The size and the time miss edits within the timestamp resolution and copies that keep the time
+        uint64 sourceContentHash = 0;
+        // The bytes after the header
+        int64 payloadSize = 0;
+    };
+
+    void WriteSection(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportSectionInfo& section)
+    {
+        writer.WriteName(section.materialName);
+        writer.WriteValue(section.materialIndex);
+        writer.WriteArray(section.vertices);
+        writer.WriteArray(section.triangles);
+        writer.WriteArray(section.normals);
+        writer.WriteArray(section.uv0);
+        writer.WriteArray(section.vertexColors);
+        writer.WriteArray(section.tangents);
+        writer.WriteArray(section.uv1);
+        writer.WriteValue(section.bounds);
+
+        writer.WriteValue<int32>(section.BoneInfo.Num());
+        for (const TPair<FString, TArray<TTuple<int32, float>>>& bone : section.BoneInfo)
+        {
+            writer.WriteString(bone.Key);
+            writer.WriteValue<int32>(bone.Value.Num());
+            for (const TTuple<int32, float>& weight : bone.Value)
+            {
+                writer.WriteValue(weight.Get<0>());
+                writer.WriteValue(weight.Get<1>());
+            }
+        }
+
+        writer.WriteValue(section.numBoneInfluences);
+        writer.WriteArray(section.boneIndices);
+        writer.WriteArray(section.boneWeights);
+
+        writer.WriteValue<int32>(section.morphTargets.Num());
+        for (const FRuntimeMeshImportMorphTarget& target : section.morphTargets)
+        {
+            writer.WriteName(target.name);
+            writer.WriteArray(target.vertexIndices);
+            writer.WriteArray(target.positionDeltas);
+            writer.WriteArray(target.normalDeltas);
+        }
+
+        writer.WriteArray(section.linesAndPoints.vertices);
+        writer.WriteArray(section.linesAndPoints.colors);
+        writer.WriteArray(section.linesAndPoints.lineIndices);
+        writer.WriteArray(section.linesAndPoints.pointIndices);
+        writer.WriteValue(section.linesAndPoints.bounds);
+
+        writer.WriteValue<uint8>(section.bvh.IsValid());
+        if (section.bvh.IsValid())
+        {
+            writer.WriteArray(section.bvh->nodes);
+            writer.WriteArray(section.bvh->triangles);
+        }
+    }
+
+    // A broken BVH would make the queries read out of bounds
+    bool IsValidBVH(const FRuntimeMeshImportBVH& bvh, const FRuntimeMeshImportSectionInfo& section)
+    {
+        for (const FRuntimeMeshImportBVHNode& node : bvh.nodes)
+        {
+            if (node.IsLeaf() ? node.firstIndex < 0 || node.firstIndex + node.numTriangles > bvh.triangles.Num()
+                : node.numTriangles < 0 || node.firstIndex <= 0 || node.firstIndex + 1 >= bvh.nodes.Num())
+            {
+                return false;
+            }
+        }
+        const int32 numTriangles = section.triangles.Num() / 3;
+        for (const int32 triangle : bvh.triangles)
+        {
+            if (triangle < 0 || triangle >= numTriangles)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ReadSection(FRuntimeMeshByteReader& reader, FRuntimeMeshImportSectionInfo& section)
+    {
+        if (!reader.ReadName(section.materialName) || !reader.ReadValue(section.materialIndex)
+            || !reader.ReadArray(section.vertices) || !reader.ReadArray(section.triangles) || !reader.ReadArray(section.normals)
+            || !reader.ReadArray(section.uv0) || !reader.ReadArray(section.vertexColors) || !reader.ReadArray(section.tangents) || !reader.ReadArray(section.uv1)
+            || !reader.ReadValue(section.bounds))
+        {
+            return false;
+        }
+
+        int32 numBones = 0;
+        if (!reader.ReadValue(numBones) || numBones < 0)
+        {
+            return false;
+        }
+        for (int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+        {
+            FString boneName;
+            int32 numWeights = 0;
+            if (!reader.ReadString(boneName) || !reader.ReadValue(numWeights) || numWeights < 0)
+            {
+                return false;
+            }
+            TArray<TTuple<int32, float>>& weights = section.BoneInfo.Add(MoveTemp(boneName));
+            weights.SetNum(numWeights);
+            for (TTuple<int32, float>& weight : weights)
+            {
+                if (!reader.ReadValue(weight.Get<0>()) || !reader.ReadValue(weight.Get<1>()))
+                {
+                    return false;
+                }
+            }
+        }
+
+        if (!reader.ReadValue(section.numBoneInfluences) || !reader.ReadArray(section.boneIndices) || !reader.ReadArray(section.boneWeights)
+            || section.boneIndices.Num() != section.vertices.Num() * section.numBoneInfluences || section.boneWeights.Num() != section.boneIndices.Num())
+        {
+            return false;
+        }
+
+        int32 numMorphTargets = 0;
+        if (!reader.ReadValue(numMorphTargets) || numMorphTargets < 0)
+        {
+            return false;
+        }
+        section.morphTargets.SetNum(numMorphTargets);
+        for (FRuntimeMeshImportMorphTarget& target : section.morphTargets)
+        {
+            if (!reader.ReadName(target.name) || !reader.ReadArray(target.vertexIndices) || !reader.ReadArray(target.positionDeltas) || !reader.ReadArray(target.normalDeltas)
+                || target.positionDeltas.Num() != target.vertexIndices.Num() || (target.normalDeltas.Num() > 0 && target.normalDeltas.Num() != target.vertexIndices.Num()))
+            {
+                return false;
+            }
+            for (const int32 vertex : target.vertexIndices)
+            {
+                if (vertex < 0 || vertex >= section.vertices.Num())
+                {
+                    return false;
+                }
+            }
+        }
+
+        FRuntimeMeshImportLinesAndPoints& linesAndPoints = section.linesAndPoints;
+        if (!reader.ReadArray(linesAndPoints.vertices) || !reader.ReadArray(linesAndPoints.colors) || !reader.ReadArray(linesAndPoints.lineIndices)
+            || !reader.ReadArray(linesAndPoints.pointIndices) || !reader.ReadValue(linesAndPoints.bounds)
+            || (linesAndPoints.colors.Num() > 0 && linesAndPoints.colors.Num() != linesAndPoints.vertices.Num()) || linesAndPoints.lineIndices.Num() % 2 != 0)
+        {
+            return false;
+        }
+        const auto isValidIndex = [&linesAndPoints](const int32 vertex) {
+            return vertex >= 0 && vertex < linesAndPoints.vertices.Num();
+        };
+        if (!Algo::AllOf(linesAndPoints.lineIndices, isValidIndex) || !Algo::AllOf(linesAndPoints.pointIndices, isValidIndex))
+        {
+            return false;
+        }
+
+        uint8 bHasBVH = 0;
+        if (!reader.ReadValue(bHasBVH))
+        {
+            return false;
+        }
+        if (bHasBVH)
+        {
+            TSharedRef<FRuntimeMeshImportBVH, ESPMode::ThreadSafe> bvh = MakeShared<FRuntimeMeshImportBVH, ESPMode::ThreadSafe>();
+            if (!reader.ReadArray(bvh->nodes) || !reader.ReadArray(bvh->triangles) || !IsValidBVH(*bvh, section))
+            {
+                return false;
+            }
+            section.bvh = bvh;
+        }
+        return true;
+    }
+
+    bool ReadResult(FRuntimeMeshByteReader& reader, FRuntimeMeshImportResult& result)
+    {
+        int32 numMeshes = 0;
+        if (!reader.ReadValue(numMeshes) || numMeshes < 0)
+        {
+            return false;
+        }
+        result.meshInfos.SetNum(numMeshes);
+        for (FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+        {
+            int32 numSections = 0;
+            if (!reader.ReadName(meshInfo.meshName) || !reader.ReadArray(meshInfo.instanceTransforms) || !reader.ReadValue(meshInfo.bounds)
+                || !reader.ReadValue(meshInfo.geometryHash) || !reader.ReadValue(numSections) || numSections < 0)
+            {
+                return false;
+            }
+            meshInfo.sections.SetNum(numSections);
+            for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+            {
+                if (!ReadSection(reader, section))
+                {
+                    return false;
+                }
+            }
+
+            int32 numLODs = 0;
+            if (!reader.ReadValue(numLODs) || numLODs < 0)
+            {
+                return false;
+            }
+            meshInfo.lods.SetNum(numLODs);
+            for (FRuntimeMeshImportMeshLOD& lod : meshInfo.lods)
+            {
+                int32 numLODSections = 0;
+                if (!reader.ReadValue(lod.screenSize) || !reader.ReadValue(numLODSections) || numLODSections < 0)
+                {
+                    return false;
+                }
+                lod.sections.SetNum(numLODSections);
+                for (FRuntimeMeshImportSectionInfo& section : lod.sections)
+                {
+                    if (!ReadSection(reader, section))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            if (!FRuntimeMeshImportSerialization::ReadCollision(reader, meshInfo.collision))
+            {
+                return false;
+            }
+        }
+
+        int32 numMaterials = 0;
+        if (!reader.ReadValue(numMaterials) || numMaterials < 0)
+        {
+            return false;
+        }
+        result.materialInfos.SetNum(numMaterials);
+        for (FRuntimeMeshImportMaterialInfo& material : result.materialInfos)
+        {
+            if (!FRuntimeMeshImportSerialization::ReadMaterial(reader, material))
+            {
+                return false;
+            }
+        }
+
+        if (!FRuntimeMeshImportSerialization::ReadNodes(reader, result.nodes, result.meshInfos.Num()) || !FRuntimeMeshImportSerialization::ReadBones(reader, result.bones))
+        {
+            return false;
+        }
+        for (const FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+        {
+            for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+            {
+                if (!FRuntimeMeshImportSerialization::AreBoneIndicesValid(section.boneIndices, result.bones.Num()))
+                {
+                    return false;
+                }
+            }
+            for (const FRuntimeMeshImportMeshLOD& lod : meshInfo.lods)
+            {
+                for (const FRuntimeMeshImportSectionInfo& section : lod.sections)
+                {
+                    if (!FRuntimeMeshImportSerialization::AreBoneIndicesValid(section.boneIndices, result.bones.Num()))
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        int32 numAnimations = 0;
+        if (!reader.ReadValue(numAnimations) || numAnimations < 0)
+        {
+            return false;
+        }
+        result.animations.SetNum(numAnimations);
+        for (FRuntimeMeshImportAnimation& animation : result.animations)
+        {
+            if (!FRuntimeMeshImportSerialization::ReadAnimation(reader, animation, result.bones.Num(), result.nodes.Num()))
+            {
+                return false;
+            }
+        }
+        return reader.IsAtEnd();
+    }
+
+    // CityHash64 over the bytes of 'sourceFile', in blocks so files larger than 4 GB are hashed completely
+    bool HashSourceContent(const FString& sourceFile, uint64& outHash)
+    {
+        const int64 blockSize = 64 * 1024 * 1024;
+        TUniquePtr<IMappedFileHandle> mappedHandle(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*sourceFile));
+        TUniquePtr<IMappedFileRegion> mappedRegion;
+        TArray<uint8> fileBytes;
+        const uint8* data = nullptr;
+        int64 size = 0;
+        if (mappedHandle.IsValid() && mappedHandle->GetFileSize() > 0)
+        {
+            mappedRegion.Reset(mappedHandle->MapRegion(0, mappedHandle->GetFileSize()));
+        }
+        if (mappedRegion.IsValid())
+        {
+            data = mappedRegion->GetMappedPtr();
+            size = mappedRegion->GetMappedSize();
+        }
+        else if (FFileHelper::LoadFileToArray(fileBytes, *sourceFile))
+        {
+            data = fileBytes.GetData();
+            size = fileBytes.Num();
+        }
+        else
+        {
+            return false;
+        }
+
+        uint64 hash = uint64(size);
+        for (int64 offset = 0; offset < size; offset += blockSize)
+        {
+            hash = CityHash64WithSeed(reinterpret_cast<const char*>(data + offset), uint32(FMath::Min(blockSize, size - offset)), hash);
+        }
+        outHash = hash;
+        return true;
+    }
+
+    bool GetSourceIdentity(const FString& sourceFile, FResultCacheHeader& outHeader)
+    {
+        const FFileStatData statData = FPlatformFileManager::Get().GetPlatformFile().GetStatData(*sourceFile);
+        if (!statData.bIsValid || statData.bIsDirectory)
+        {
+            return false;
+        }
+        outHeader.sourceSize = statData.FileSize;
+        outHeader.sourceModificationTicks = statData.ModificationTime.GetTicks();
+        return HashSourceContent(sourceFile, outHeader.sourceContentHash);
+    }
+}
+
+bool FRuntimeMeshImportResultCache::Load_AnyThread(const FString& sourceFile, const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& outResult)
+{
+    FResultCacheHeader expected;
+    if (param.resultCacheDirectory.IsEmpty() || !GetSourceIdentity(sourceFile, expected))
+    {
+        return false;
+    }
+    expected.paramHash = HashParam(param);
+
+    const FString cacheFile = GetCacheFile(sourceFile, param);
+    IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!platformFile.FileExists(*cacheFile))
+    {
+        return false;
+    }
+
+    // Mapped, so the arrays are copied straight from the page cache. Read into memory where mapping is not supported.
+    TUniquePtr<IMappedFileHandle> mappedHandle(platformFile.OpenMapped(*cacheFile));
+    TUniquePtr<IMappedFileRegion> mappedRegion;
+    TArray<uint8> fileBytes;
+    const uint8* data = nullptr;
+    int64 size = 0;
+    if (mappedHandle.IsValid() && mappedHandle->GetFileSize() > 0)
+    {
+        mappedRegion.Reset(mappedHandle->MapRegion(0, mappedHandle->GetFileSize()));
+    }
+    if (mappedRegion.IsValid())
+    {
+        data = mappedRegion->GetMappedPtr();
+        size = mappedRegion->GetMappedSize();
+    }
+    else if (FFileHelper::LoadFileToArray(fileBytes, *cacheFile))
+    {
+        data = fileBytes.GetData();
+        size = fileBytes.Num();
+    }
+
+    FResultCacheHeader header;
+    if (size < int64(sizeof(FResultCacheHeader)))
+    {
+        return false;
+    }
+    FMemory::Memcpy(&header, data, sizeof(FResultCacheHeader));
+    if (header.magic != cacheMagic || header.version != cacheVersion || header.paramHash != expected.paramHash
+        || header.sourceSize != expected.sourceSize || header.sourceModificationTicks != expected.sourceModificationTicks
+        || header.sourceContentHash != expected.sourceContentHash
+        || header.payloadSize != size - int64(sizeof(FResultCacheHeader)))
+    {
+        RMIE_LOG(Log, "The result cache of %s is outdated. Cache file: %s", *sourceFile, *cacheFile);
+        return false;
+    }
+
+    FRuntimeMeshByteReader reader(data + sizeof(FResultCacheHeader), header.payloadSize);
+    FRuntimeMeshImportResult result;
+    if (!ReadResult(reader, result))
+    {
+        RMIE_LOG(Warning, "The result cache of %s is broken. Cache file: %s", *sourceFile, *cacheFile);
+        return false;
+    }
+
+    // The region has to be unmapped before the handle is closed
+    mappedRegion.Reset();
+    mappedHandle.Reset();
+
+    result.bSuccess = true;
+    outResult = MoveTemp(result);
+    return true;
+}
+
+bool FRuntimeMeshImportResultCache::Save_AnyThread(const FString& sourceFile, const FRuntimeMeshImportParam& param, const FRuntimeMeshImportResult& result)
+{
+    FResultCacheHeader header;
+    if (param.resultCacheDirectory.IsEmpty() || !result.bSuccess || !GetSourceIdentity(sourceFile, header))
+    {
+        return false;
+    }
+    header.paramHash = HashParam(param);
+
+    FRuntimeMeshByteWriter writer;
+    // The header is filled in at the end, when the size of the payload is known
+    writer.bytes.AddZeroed(sizeof(FResultCacheHeader));
+    writer.WriteValue<int32>(result.meshInfos.Num());
+    for (const FRuntimeMeshImportMeshInfo& meshInfo : result.meshInfos)
+    {
+        writer.WriteName(meshInfo.meshName);
+        writer.WriteArray(meshInfo.instanceTransforms);
+        writer.WriteValue(meshInfo.bounds);
+        writer.WriteValue(meshInfo.geometryHash);
+        writer.WriteValue<int32>(meshInfo.sections.Num());
+        for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            WriteSection(writer, section);
+        }
+        writer.WriteValue<int32>(meshInfo.lods.Num());
+        for (const FRuntimeMeshImportMeshLOD& lod : meshInfo.lods)
+        {
+            writer.WriteValue(lod.screenSize);
+            writer.WriteValue<int32>(lod.sections.Num());
+            for (const FRuntimeMeshImportSectionInfo& section : lod.sections)
+            {
+                WriteSection(writer, section);
+            }
+        }
+        FRuntimeMeshImportSerialization::WriteCollision(writer, meshInfo.collision);
+    }
+    writer.WriteValue<int32>(result.materialInfos.Num());
+    for (const FRuntimeMeshImportMaterialInfo& material : result.materialInfos)
+    {
+        FRuntimeMeshImportSerialization::WriteMaterial(writer, material);
+    }
+    FRuntimeMeshImportSerialization::WriteNodes(writer, result.nodes);
+    FRuntimeMeshImportSerialization::WriteBones(writer, result.bones);
+    writer.WriteValue<int32>(result.animations.Num());
+    for (const FRuntimeMeshImportAnimation& animation : result.animations)
+    {
+        FRuntimeMeshImportSerialization::WriteAnimation(writer, animation);
+    }
+    header.payloadSize = writer.bytes.Num() - int64(sizeof(FResultCacheHeader));
+    FMemory::Memcpy(writer.bytes.GetData(), &header, sizeof(FResultCacheHeader));
+
+    // Written next to the cache file and moved over it, so an import on another thread never reads a half written file
+    const FString cacheFile = GetCacheFile(sourceFile, param);
+    const FString tempFile = FString::Printf(TEXT("%s.%s.tmp"), *cacheFile, *FGuid::NewGuid().ToString());
+    if (!FFileHelper::SaveArrayToFile(writer.bytes, *tempFile) || !IFileManager::Get().Move(*cacheFile, *tempFile, true, true))
+    {
+        RMIE_LOG(Warning, "Failed to write the result cache of %s. Cache file: %s", *sourceFile, *cacheFile);
+        IFileManager::Get().Delete(*tempFile, false, true, true);
+        return false;
+    }
+    return true;
+}
+
+FString FRuntimeMeshImportResultCache::GetCacheFile(const FString& sourceFile, const FRuntimeMeshImportParam& param)
+{
+    FString directory = param.resultCacheDirectory;
+    if (FPaths::IsRelative(directory))
+    {
+        directory = FPaths::Combine(FPaths::ProjectSavedDir(), directory);
+    }
+
+    const FTCHARToUTF8 utf8(*sourceFile.ToLower());
+    const uint64 fileHash = CityHash64WithSeed(utf8.Get(), utf8.Length(), HashParam(param));
+    return FPaths::Combine(directory, FString::Printf(TEXT("%s_%016llx.rmic"), *FPaths::GetBaseFilename(sourceFile), fileHash));
+}
+
+uint64 FRuntimeMeshImportResultCache::HashParam(const FRuntimeMeshImportParam& param)
+{
+    // The params are written like a cache file and the bytes hashed
+    FRuntimeMeshByteWriter writer;
+    writer.WriteValue(param.transform.GetTranslation());
+    writer.WriteValue(param.transform.GetRotation());
+    writer.WriteValue(param.transform.GetScale3D());
+    writer.WriteValue(param.importProfile);
+    writer.WriteValue(param.vertexColorSpace);
+    writer.WriteValue(param.importMethodMesh);
+    writer.WriteValue(param.clusterTargetTriangles);
+    writer.WriteValue(param.importMethodSection);
+    writer.WriteValue<uint8>(param.bNormalizeScene);
+    writer.WriteValue<uint8>(param.bImportInstanced);
+    writer.WriteValue<uint8>(param.bImportHierarchy);
+    writer.WriteValue<uint8>(param.bImportLinesAndPoints);
+    writer.WriteValue<uint8>(param.bImportSkinning);
+    writer.WriteValue(param.maxBoneInfluences);
+    writer.WriteValue<uint8>(param.bImportAnimations);
+    writer.WriteValue(param.animationKeyTolerance);
+    writer.WriteValue(param.bImportMorphTargets);
+    writer.WriteValue(param.morphTargetThreshold);
+    writer.WriteValue<int32>(param.lodSettings.Num());
+    for (const FRuntimeMeshImportLODSetting& lodSetting : param.lodSettings)
+    {
+        writer.WriteValue(lodSetting.triangleRatio);
+        writer.WriteValue(lodSetting.screenSize);
+    }
+    writer.WriteValue<uint8>(param.bSplitLargeSections);
+    writer.WriteValue(param.splitSectionVertexLimit);
+    writer.WriteValue(param.splitSectionTriangleLimit);
+    writer.WriteValue<uint8>(param.bWeldVertices);
+    writer.WriteValue(param.weldPositionTolerance);
+    writer.WriteValue(param.weldNormalTolerance);
+    writer.WriteValue(param.weldUVTolerance);
+    writer.WriteValue<uint8>(param.bOptimizeSections);
+    writer.WriteValue(param.vertexCacheSize);
+    writer.WriteValue<uint8>(param.bOptimizeOverdraw);
+    writer.WriteValue<uint8>(param.bBuildBVH);
+    writer.WriteValue(param.bvhMaxLeafTriangles);
+    writer.WriteValue<uint8>(param.bHashGeometry);
+    writer.WriteValue(param.geometryHashPrecision);
+    writer.WriteValue(param.collision);
+    writer.WriteValue(param.collisionTriangleRatio);
+    writer.WriteValue(param.maxConvexHulls);
+    writer.WriteValue(param.maxConvexHullVertices);
+    writer.WriteValue<uint8>(param.bCompressTextures);
+    // The native glTF import does not run aiProcess_OptimizeMeshes, its sections can differ
+    writer.WriteValue<uint8>(param.bNativeGltfImport);
+    writer.WriteValue<uint8>(param.bNativeTextImport);
+    writer.WriteValue(param.vertexAttributes);
+    writer.WriteValue<uint8>(param.bGeometryOnly);
+    writer.WriteValue<uint8>(param.bDeferTextureReads);
+    writer.WriteValue<uint8>(param.bAtlasMaterials);
+    writer.WriteValue<uint8>(param.bMikkTSpaceTangents);
+    writer.WriteValue(param.atlasMaxSize);
+    writer.WriteValue<uint8>(param.bGenerateLightmapUVs);
+    writer.WriteValue(param.lightmapResolution);
+    writer.WriteValue(param.lightmapPadding);
+    writer.WriteValue<int32>(param.nodeIncludeFilters.Num());
+    for (const FString& filter : param.nodeIncludeFilters)
+    {
+        writer.WriteString(filter);
+    }
+    writer.WriteValue<int32>(param.nodeExcludeFilters.Num());
+    for (const FString& filter : param.nodeExcludeFilters)
+    {
+        writer.WriteString(filter);
+    }
+
+    // Sorted, the order of a TMap depends on how it was filled
+    TArray<TPair<FString, ERuntimeMeshImportTextureCompression>> stackCompressions;
+    for (const TPair<FName, ERuntimeMeshImportTextureCompression>& stackCompression : param.textureStackCompression)
+    {
+        stackCompressions.Emplace(stackCompression.Key.ToString(), stackCompression.Value);
+    }
+    stackCompressions.Sort([](const TPair<FString, ERuntimeMeshImportTextureCompression>& a, const TPair<FString, ERuntimeMeshImportTextureCompression>& b) {
+        return a.Key < b.Key;
+    });
+    for (const TPair<FString, ERuntimeMeshImportTextureCompression>& stackCompression : stackCompressions)
+    {
+        writer.WriteString(stackCompression.Key);
+        writer.WriteValue(stackCompression.Value);
+    }
+
+    const FRuntimeMeshImportPostProcessParam& postProcess = param.postProcess;
+    writer.WriteValue(postProcess.preset);
+    writer.WriteValue<uint8>(postProcess.bCalcTangentSpace);
+    writer.WriteValue<uint8>(postProcess.bGenSmoothNormals);
+    writer.WriteValue<uint8>(postProcess.bOptimizeMeshes);
+    writer.WriteValue<uint8>(postProcess.bJoinIdenticalVertices);
+    writer.WriteValue<uint8>(postProcess.bImproveCacheLocality);
+    writer.WriteValue<uint8>(postProcess.bSplitLargeMeshes);
+    writer.WriteValue<uint8>(postProcess.bFindInstances);
+    writer.WriteValue(postProcess.smoothingAngle);
+    writer.WriteValue(postProcess.splitLargeMeshesVertexLimit);
+    writer.WriteValue(postProcess.splitLargeMeshesTriangleLimit);
+    writer.WriteValue(postProcess.vertexCacheSize);
+
+    return CityHash64WithSeed(reinterpret_cast<const char*>(writer.bytes.GetData()), writer.bytes.Num(), cacheVersion);
+}
@@ -0,0 +1,33 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRuntimeMeshImportParam;
+struct FRuntimeMeshImportResult;
+
+/**
+ *	Cache of converted import results on disk, so a file that is imported every session is only parsed by Assimp once.
+ *
+ *	There is one cache file per imported file and params that change the result. A cache file is only used
+ *	while the imported file keeps its size, modification time and content hash and the format version did not change.
+ *	The file is a header followed by the raw arrays of the result, loading it is little more than a memcpy per array.
+ *	Cache files are written in the native byte order, they are not meant to be shared between platforms.
+ */
+struct FRuntimeMeshImportResultCache
+{
+    // Returns false when there is no valid cache file for 'sourceFile' and 'param'. 'outResult' is only modified on success.
+    static bool Load_AnyThread(const FString& sourceFile, const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& outResult);
+
+    // Writes 'result' to the cache file of 'sourceFile' and 'param'. An existing cache file is replaced.
+    static bool Save_AnyThread(const FString& sourceFile, const FRuntimeMeshImportParam& param, const FRuntimeMeshImportResult& result);
+
+    // The cache file of 'sourceFile' and 'param' in param.resultCacheDirectory
+    static FString GetCacheFile(const FString& sourceFile, const FRuntimeMeshImportParam& param);
+
+    // Hash of the params that change the result. Params like bParallelMeshConversion are not part of it.
+    static uint64 HashParam(const FRuntimeMeshImportParam& param);
+};
@@ -0,0 +1,291 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportSerialization.h"
+#include "RuntimeMeshImportCompactTypes.h"
+
+namespace
+{
+    // The fewest bytes an element can be serialized to, a count or string length is 4 bytes
+    const int64 minScalarSize = 4 + sizeof(float);
+    const int64 minVectorSize = 4 + sizeof(FLinearColor);
+    const int64 minTextureSize = 4 + 2 * sizeof(int32) + 4 + sizeof(ERuntimeMeshImportTextureCompression) + 4 + 4;
+    const int64 minNodeSize = 4 + sizeof(int32) + sizeof(FTransform) + sizeof(int32);
+    const int64 minBoneSize = 4 + sizeof(int32) + 2 * sizeof(FTransform);
+    const int64 minTrackSize = 2 * sizeof(int32) + 6 * 4;
+
+    template<typename TAnimation>
+    void WriteAnimationImpl(FRuntimeMeshByteWriter& writer, const TAnimation& animation)
+    {
+        writer.WriteName(animation.name);
+        writer.WriteValue(animation.duration);
+        writer.WriteValue<int32>(animation.tracks.Num());
+        for (const auto& track : animation.tracks)
+        {
+            writer.WriteValue(track.boneIndex);
+            writer.WriteValue(track.nodeIndex);
+            writer.WriteArray(track.positionTimes);
+            writer.WriteArray(track.positions);
+            writer.WriteArray(track.rotationTimes);
+            writer.WriteArray(track.rotations);
+            writer.WriteArray(track.scaleTimes);
+            writer.WriteArray(track.scales);
+        }
+    }
+
+    // INDEX_NONE or an index of the array of 'num' elements
+    bool IsValidIndexOrNone(const int32 index, const int32 num)
+    {
+        return index == INDEX_NONE || (index >= 0 && index < num);
+    }
+
+    template<typename TAnimation>
+    bool ReadAnimationImpl(FRuntimeMeshByteReader& reader, TAnimation& animation, const int32 numBones, const int32 numNodes)
+    {
+        int32 numTracks = 0;
+        if (!reader.ReadName(animation.name) || !reader.ReadValue(animation.duration) || !reader.ReadNum(numTracks, minTrackSize))
+        {
+            return false;
+        }
+        animation.tracks.SetNum(numTracks);
+        for (auto& track : animation.tracks)
+        {
+            if (!reader.ReadValue(track.boneIndex) || !reader.ReadValue(track.nodeIndex) || !reader.ReadArray(track.positionTimes) || !reader.ReadArray(track.positions)
+                || !reader.ReadArray(track.rotationTimes) || !reader.ReadArray(track.rotations) || !reader.ReadArray(track.scaleTimes) || !reader.ReadArray(track.scales)
+                || track.positions.Num() != track.positionTimes.Num() || track.rotations.Num() != track.rotationTimes.Num() || track.scales.Num() != track.scaleTimes.Num()
+                || !IsValidIndexOrNone(track.boneIndex, numBones) || !IsValidIndexOrNone(track.nodeIndex, numNodes))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+void FRuntimeMeshImportSerialization::WriteCollision(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportCollision& collision)
+{
+    writer.WriteArray(collision.trimeshVertices);
+    writer.WriteArray(collision.trimeshTriangles);
+    writer.WriteValue<int32>(collision.convexHulls.Num());
+    for (const FRuntimeMeshImportConvexHull& hull : collision.convexHulls)
+    {
+        writer.WriteArray(hull.vertices);
+    }
+}
+
+bool FRuntimeMeshImportSerialization::ReadCollision(FRuntimeMeshByteReader& reader, FRuntimeMeshImportCollision& collision)
+{
+    int32 numHulls = 0;
+    if (!reader.ReadArray(collision.trimeshVertices) || !reader.ReadArray(collision.trimeshTriangles) || !reader.ReadNum(numHulls, sizeof(int32)))
+    {
+        return false;
+    }
+    for (const int32 index : collision.trimeshTriangles)
+    {
+        if (index < 0 || index >= collision.trimeshVertices.Num())
+        {
+            return false;
+        }
+    }
+    collision.convexHulls.SetNum(numHulls);
+    for (FRuntimeMeshImportConvexHull& hull : collision.convexHulls)
+    {
+        if (!reader.ReadArray(hull.vertices))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FRuntimeMeshImportSerialization::WriteMaterial(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportMaterialInfo& material)
+{
+    writer.WriteName(material.name);
+    writer.WriteValue<uint8>(material.bTwoSided);
+    writer.WriteValue<uint8>(material.bWireFrame);
+    writer.WriteValue(material.shadingMode);
+    writer.WriteValue(material.shadingModeInt);
+    writer.WriteValue(material.blendMode);
+    writer.WriteValue(material.blendModeInt);
+
+    writer.WriteValue<int32>(material.scalars.Num());
+    for (const FRuntimeMeshImportExportMaterialParamScalar& scalar : material.scalars)
+    {
+        writer.WriteName(scalar.name);
+        writer.WriteValue(scalar.value);
+    }
+
+    writer.WriteValue<int32>(material.vectors.Num());
+    for (const FRuntimeMeshImportExportMaterialParamVector& vector : material.vectors)
+    {
+        writer.WriteName(vector.name);
+        writer.WriteValue(vector.value);
+    }
+
+    writer.WriteValue<int32>(material.textures.Num());
+    for (const FRuntimeMeshImportExportMaterialParamTexture& texture : material.textures)
+    {
+        writer.WriteName(texture.name);
+        writer.WriteValue(texture.width);
+        writer.WriteValue(texture.height);
+        writer.WriteString(texture.byteDescription);
+        writer.WriteValue(texture.compression);
+        writer.WriteArray(texture.byteData);
+        writer.WriteString(texture.sourceFile);
+    }
+}
+
+bool FRuntimeMeshImportSerialization::ReadMaterial(FRuntimeMeshByteReader& reader, FRuntimeMeshImportMaterialInfo& material)
+{
+    uint8 bTwoSided = 0;
+    uint8 bWireFrame = 0;
+    if (!reader.ReadName(material.name) || !reader.ReadValue(bTwoSided) || !reader.ReadValue(bWireFrame)
+        || !reader.ReadValue(material.shadingMode) || !reader.ReadValue(material.shadingModeInt)
+        || !reader.ReadValue(material.blendMode) || !reader.ReadValue(material.blendModeInt))
+    {
+        return false;
+    }
+    material.bTwoSided = bTwoSided != 0;
+    material.bWireFrame = bWireFrame != 0;
+
+    int32 num = 0;
+    if (!reader.ReadNum(num, minScalarSize))
+    {
+        return false;
+    }
+    material.scalars.SetNum(num);
+    for (FRuntimeMeshImportExportMaterialParamScalar& scalar : material.scalars)
+    {
+        if (!reader.ReadName(scalar.name) || !reader.ReadValue(scalar.value))
+        {
+            return false;
+        }
+    }
+
+    if (!reader.ReadNum(num, minVectorSize))
+    {
+        return false;
+    }
+    material.vectors.SetNum(num);
+    for (FRuntimeMeshImportExportMaterialParamVector& vector : material.vectors)
+    {
+        if (!reader.ReadName(vector.name) || !reader.ReadValue(vector.value))
+        {
+            return false;
+        }
+    }
+
+    if (!reader.ReadNum(num, minTextureSize))
+    {
+        return false;
+    }
+    material.textures.SetNum(num);
+    for (FRuntimeMeshImportExportMaterialParamTexture& texture : material.textures)
+    {
+        if (!reader.ReadName(texture.name) || !reader.ReadValue(texture.width) || !reader.ReadValue(texture.height)
+            || !reader.ReadString(texture.byteDescription)
+            || !reader.ReadValue(texture.compression) || !reader.ReadArray(texture.byteData) || !reader.ReadString(texture.sourceFile))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FRuntimeMeshImportSerialization::WriteNodes(FRuntimeMeshByteWriter& writer, const TArray<FRuntimeMeshImportNode>& nodes)
+{
+    writer.WriteValue<int32>(nodes.Num());
+    for (const FRuntimeMeshImportNode& node : nodes)
+    {
+        writer.WriteName(node.name);
+        writer.WriteValue(node.parentIndex);
+        writer.WriteValue(node.localTransform);
+        writer.WriteValue(node.meshInfoIndex);
+    }
+}
+
+bool FRuntimeMeshImportSerialization::ReadNodes(FRuntimeMeshByteReader& reader, TArray<FRuntimeMeshImportNode>& nodes, const int32 numMeshInfos)
+{
+    int32 numNodes = 0;
+    if (!reader.ReadNum(numNodes, minNodeSize))
+    {
+        return false;
+    }
+    nodes.SetNum(numNodes);
+    for (int32 nodeIndex = 0; nodeIndex < numNodes; ++nodeIndex)
+    {
+        FRuntimeMeshImportNode& node = nodes[nodeIndex];
+        // The parents are stored before their children
+        if (!reader.ReadName(node.name) || !reader.ReadValue(node.parentIndex) || !reader.ReadValue(node.localTransform) || !reader.ReadValue(node.meshInfoIndex)
+            || !IsValidIndexOrNone(node.parentIndex, nodeIndex) || !IsValidIndexOrNone(node.meshInfoIndex, numMeshInfos))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FRuntimeMeshImportSerialization::WriteBones(FRuntimeMeshByteWriter& writer, const TArray<FRuntimeMeshImportBone>& bones)
+{
+    writer.WriteValue<int32>(bones.Num());
+    for (const FRuntimeMeshImportBone& bone : bones)
+    {
+        writer.WriteName(bone.name);
+        writer.WriteValue(bone.parentIndex);
+        writer.WriteValue(bone.localTransform);
+        writer.WriteValue(bone.inverseBindTransform);
+    }
+}
+
+bool FRuntimeMeshImportSerialization::ReadBones(FRuntimeMeshByteReader& reader, TArray<FRuntimeMeshImportBone>& bones)
+{
+    int32 numBones = 0;
+    if (!reader.ReadNum(numBones, minBoneSize))
+    {
+        return false;
+    }
+    bones.SetNum(numBones);
+    for (int32 boneIndex = 0; boneIndex < numBones; ++boneIndex)
+    {
+        FRuntimeMeshImportBone& bone = bones[boneIndex];
+        if (!reader.ReadName(bone.name) || !reader.ReadValue(bone.parentIndex) || !reader.ReadValue(bone.localTransform) || !reader.ReadValue(bone.inverseBindTransform)
+            || !IsValidIndexOrNone(bone.parentIndex, boneIndex))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FRuntimeMeshImportSerialization::AreBoneIndicesValid(const TArray<uint16>& boneIndices, const int32 numBones)
+{
+    for (const uint16 boneIndex : boneIndices)
+    {
+        if (int32(boneIndex) >= numBones)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FRuntimeMeshImportSerialization::WriteAnimation(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportAnimation& animation)
+{
+    WriteAnimationImpl(writer, animation);
+}
+
+bool FRuntimeMeshImportSerialization::ReadAnimation(FRuntimeMeshByteReader& reader, FRuntimeMeshImportAnimation& animation, const int32 numBones, const int32 numNodes)
+{
+    return ReadAnimationImpl(reader, animation, numBones, numNodes);
+}
+
+void FRuntimeMeshImportSerialization::WriteAnimation(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportCompactAnimation& animation)
+{
+    WriteAnimationImpl(writer, animation);
+}
+
+bool FRuntimeMeshImportSerialization::ReadAnimation(FRuntimeMeshByteReader& reader, FRuntimeMeshImportCompactAnimation& animation, const int32 numBones, const int32 numNodes)
+{
+    return ReadAnimationImpl(reader, animation, numBones, numNodes);
+}
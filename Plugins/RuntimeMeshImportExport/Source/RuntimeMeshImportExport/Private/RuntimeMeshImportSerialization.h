@@ -0,0 +1,188 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+struct FRuntimeMeshImportCompactAnimation;
+
+// Appends raw values and arrays in the native byte order
+class FRuntimeMeshByteWriter
+{
+public:
+    TArray<uint8> bytes;
+
+    void Write(const void* data, const int32 numBytes)
+    {
+        bytes.Append(static_cast<const uint8*>(data), numBytes);
+    }
+
+    template<typename T>
+    void WriteValue(const T& value)
+    {
+        Write(&value, sizeof(T));
+    }
+
+    template<typename T>
+    void WriteArray(const TArray<T>& values)
+    {
+        WriteValue<int32>(values.Num());
+        Write(values.GetData(), values.Num() * sizeof(T));
+    }
+
+    void WriteString(const FString& value)
+    {
+        FTCHARToUTF8 utf8(*value);
+        WriteValue<int32>(utf8.Length());
+        Write(utf8.Get(), utf8.Length());
+    }
+
+    void WriteName(const FName value)
+    {
+        WriteString(value.ToString());
+    }
+
+    // 7 bits per byte, small values take a single byte
+    void WriteVarUInt(uint32 value)
+    {
+        while (value >= 0x80)
+        {
+            bytes.Add(uint8(value | 0x80));
+            value >>= 7;
+        }
+        bytes.Add(uint8(value));
+    }
+};
+
+// Reads what FRuntimeMeshByteWriter wrote. Every read is bounds checked, broken data fails instead of crashing.
+class FRuntimeMeshByteReader
+{
+public:
+    FRuntimeMeshByteReader(const uint8* inData, const int64 inSize) : data(inData), size(inSize) {}
+
+    bool Read(void* dest, const int64 numBytes)
+    {
+        if (numBytes < 0 || numBytes > size - position)
+        {
+            return false;
+        }
+        FMemory::Memcpy(dest, data + position, numBytes);
+        position += numBytes;
+        return true;
+    }
+
+    template<typename T>
+    bool ReadValue(T& value)
+    {
+        return Read(&value, sizeof(T));
+    }
+
+    // Reads the number of elements that follow. Fails before anything is allocated when the remaining bytes can not hold 'num' elements of at least 'minElementSize' bytes.
+    bool ReadNum(int32& num, const int64 minElementSize)
+    {
+        return ReadValue(num) && num >= 0 && int64(num) * minElementSize <= size - position;
+    }
+
+    template<typename T>
+    bool ReadArray(TArray<T>& values)
+    {
+        int32 num = 0;
+        if (!ReadNum(num, sizeof(T)))
+        {
+            return false;
+        }
+        values.SetNumUninitialized(num);
+        return Read(values.GetData(), int64(num) * sizeof(T));
+    }
+
+    bool ReadString(FString& value)
+    {
+        int32 numBytes = 0;
+        if (!ReadValue(numBytes) || numBytes < 0 || numBytes > size - position)
+        {
+            return false;
+        }
+        FUTF8ToTCHAR converted(reinterpret_cast<const ANSICHAR*>(data + position), numBytes);
+        value = FString(converted.Length(), converted.Get());
+        position += numBytes;
+        return true;
+    }
+
+    bool ReadName(FName& value)
+    {
+        FString name;
+        if (!ReadString(name))
+        {
+            return false;
+        }
+        value = FName(*name);
+        return true;
+    }
+
+    bool ReadVarUInt(uint32& value)
+    {
+        value = 0;
+        for (int32 shift = 0; shift < 35; shift += 7)
+        {
+            if (position >= size)
+            {
+                return false;
+            }
+            const uint8 byte = data[position++];
+            value |= uint32(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool IsAtEnd() const
+    {
+        return position == size;
+    }
+
+    int64 GetNumRemaining() const
+    {
+        return size - position;
+    }
+
+private:
+    const uint8* data;
+    int64 size;
+    int64 position = 0;
+};
+
+/**
+ *	The parts of an import result that the result cache and the replication format write the same way.
+ *	The readers validate the indices they read, so broken data fails instead of indexing out of bounds later.
+ */
+struct FRuntimeMeshImportSerialization
+{
+    static void WriteCollision(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportCollision& collision);
+    static bool ReadCollision(FRuntimeMeshByteReader& reader, FRuntimeMeshImportCollision& collision);
+
+    static void WriteMaterial(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportMaterialInfo& material);
+    static bool ReadMaterial(FRuntimeMeshByteReader& reader, FRuntimeMeshImportMaterialInfo& material);
+
+    static void WriteNodes(FRuntimeMeshByteWriter& writer, const TArray<FRuntimeMeshImportNode>& nodes);
+    // Fails unless each parent is stored before its child and each mesh index is one of the 'numMeshInfos' read before
+    static bool ReadNodes(FRuntimeMeshByteReader& reader, TArray<FRuntimeMeshImportNode>& nodes, const int32 numMeshInfos);
+
+    static void WriteBones(FRuntimeMeshByteWriter& writer, const TArray<FRuntimeMeshImportBone>& bones);
+    // Fails unless each parent is stored before its child
+    static bool ReadBones(FRuntimeMeshByteReader& reader, TArray<FRuntimeMeshImportBone>& bones);
+    // The skin weights of the sections are read before the bones, so they are checked against them afterwards
+    static bool AreBoneIndicesValid(const TArray<uint16>& boneIndices, const int32 numBones);
+
+    // The compact animation has the same layout, only its rotations are quantized
+    static void WriteAnimation(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportAnimation& animation);
+    // The bone and node of each track are checked against the 'numBones' and 'numNodes' read before
+    static bool ReadAnimation(FRuntimeMeshByteReader& reader, FRuntimeMeshImportAnimation& animation, const int32 numBones, const int32 numNodes);
+    static void WriteAnimation(FRuntimeMeshByteWriter& writer, const FRuntimeMeshImportCompactAnimation& animation);
+    static bool ReadAnimation(FRuntimeMeshByteReader& reader, FRuntimeMeshImportCompactAnimation& animation, const int32 numBones, const int32 numNodes);
+};
@@ -0,0 +1,232 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshImportStreamingComponent.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportAsset.h"
+#include "RuntimeMeshImportAssetManager.h"
+#include "ProceduralMeshComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+
+URuntimeMeshImportStreamingComponent::URuntimeMeshImportStreamingComponent()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = true;
+}
+
+void URuntimeMeshImportStreamingComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    secondsSinceUpdate += DeltaTime;
+    if (secondsSinceUpdate >= updateInterval)
+    {
+        secondsSinceUpdate = 0.f;
+        UpdateStreaming();
+    }
+}
+
+void URuntimeMeshImportStreamingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    for (TPair<int32, FStreamingFile>& file : files)
+    {
+        UnloadFile(file.Key, file.Value);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+int32 URuntimeMeshImportStreamingComponent::AddStreamingFile(const FRuntimeMeshImportParam& param, const FBox& bounds)
+{
+    const int32 fileId = nextFileId++;
+    FStreamingFile& file = files.Add(fileId);
+    file.param = param;
+    file.bounds = bounds;
+    return fileId;
+}
+
+void URuntimeMeshImportStreamingComponent::RemoveStreamingFile(const int32 fileId)
+{
+    if (FStreamingFile* file = files.Find(fileId))
+    {
+        UnloadFile(fileId, *file);
+        files.Remove(fileId);
+    }
+}
+
+ERuntimeMeshImportStreamingState URuntimeMeshImportStreamingComponent::GetFileState(const int32 fileId) const
+{
+    const FStreamingFile* file = files.Find(fileId);
+    return file ? file->state : ERuntimeMeshImportStreamingState::Unloaded;
+}
+
+UProceduralMeshComponent* URuntimeMeshImportStreamingComponent::GetFileComponent(const int32 fileId) const
+{
+    const FStreamingFile* file = files.Find(fileId);
+    return file && file->state == ERuntimeMeshImportStreamingState::Loaded ? file->component.Get() : nullptr;
+}
+
+void URuntimeMeshImportStreamingComponent::SetViewerLocationOverride(const FVector& location)
+{
+    viewerLocationOverride = location;
+    bHasViewerLocationOverride = true;
+}
+
+void URuntimeMeshImportStreamingComponent::ClearViewerLocationOverride()
+{
+    bHasViewerLocationOverride = false;
+}
+
+void URuntimeMeshImportStreamingComponent::UpdateStreaming()
+{
+    FVector viewerLocation;
+    if (!GetViewerLocation(viewerLocation))
+    {
+        return;
+    }
+
+    const FTransform& transform = GetComponentTransform();
+    const float unloadRadius = loadRadius + unloadHysteresis;
+    int32 numLoading = 0;
+    TArray<TPair<float, int32>> candidates;
+    for (TPair<int32, FStreamingFile>& entry : files)
+    {
+        FStreamingFile& file = entry.Value;
+        const float distanceSquared = file.bounds.TransformBy(transform).ComputeSquaredDistanceToPoint(viewerLocation);
+        if (file.state == ERuntimeMeshImportStreamingState::Unloaded)
+        {
+            if (!file.bLoadFailed && distanceSquared <= FMath::Square(loadRadius))
+            {
+                candidates.Emplace(distanceSquared, entry.Key);
+            }
+        }
+        else if (distanceSquared > FMath::Square(unloadRadius))
+        {
+            UnloadFile(entry.Key, file);
+        }
+        else if (file.state == ERuntimeMeshImportStreamingState::Loading)
+        {
+            ++numLoading;
+        }
+    }
+
+    // The closest files first
+    candidates.Sort([](const TPair<float, int32>& a, const TPair<float, int32>& b) {
+        return a.Key < b.Key;
+    });
+    for (int32 candidateIndex = 0; candidateIndex < candidates.Num() && numLoading < maxConcurrentLoads; ++candidateIndex)
+    {
+        const int32 fileId = candidates[candidateIndex].Value;
+        LoadFile(fileId, files[fileId]);
+        ++numLoading;
+    }
+}
+
+bool URuntimeMeshImportStreamingComponent::GetViewerLocation(FVector& outLocation) const
+{
+    if (bHasViewerLocationOverride)
+    {
+        outLocation = viewerLocationOverride;
+        return true;
+    }
+
+    if (APlayerCameraManager* cameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0))
+    {
+        outLocation = cameraManager->GetCameraLocation();
+        return true;
+    }
+    return false;
+}
+
+void URuntimeMeshImportStreamingComponent::LoadFile(const int32 fileId, FStreamingFile& file)
+{
+    UGameInstance* gameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+    URuntimeMeshImportAssetManager* manager = gameInstance ? gameInstance->GetSubsystem<URuntimeMeshImportAssetManager>() : nullptr;
+    if (!manager)
+    {
+        RMIE_LOG(Warning, "No asset manager to stream %s with, the world has no game instance.", *file.param.file);
+        file.bLoadFailed = true;
+        return;
+    }
+
+    file.state = ERuntimeMeshImportStreamingState::Loading;
+    const int32 loadId = ++file.loadId;
+
+    TWeakObjectPtr<URuntimeMeshImportStreamingComponent> weakThis(this);
+    FRuntimeImportAssetLoaded callbackLoaded;
+    callbackLoaded.BindLambda([weakThis, fileId, loadId](URuntimeMeshImportAsset* asset) {
+        if (URuntimeMeshImportStreamingComponent* streaming = weakThis.Get())
+        {
+            streaming->OnAssetLoaded(fileId, loadId, asset);
+        }
+    });
+    // Calls back right away when the asset is resident
+    manager->LoadAsset_Async_Cpp(file.param, callbackLoaded);
+}
+
+void URuntimeMeshImportStreamingComponent::UnloadFile(const int32 fileId, FStreamingFile& file)
+{
+    if (UProceduralMeshComponent* component = file.component.Get())
+    {
+        component->DestroyComponent();
+    }
+    file.component.Reset();
+    file.state = ERuntimeMeshImportStreamingState::Unloaded;
+    ++file.loadId;
+    applyingAssets.Remove(fileId);
+}
+
+void URuntimeMeshImportStreamingComponent::OnAssetLoaded(const int32 fileId, const int32 loadId, URuntimeMeshImportAsset* asset)
+{
+    FStreamingFile* file = files.Find(fileId);
+    if (!file || file->loadId != loadId)
+    {
+        return;
+    }
+
+    if (!asset)
+    {
+        RMIE_LOG(Warning, "Streaming of %s failed, it is not loaded again.", *file->param.file);
+        file->bLoadFailed = true;
+        file->state = ERuntimeMeshImportStreamingState::Unloaded;
+        return;
+    }
+
+    UProceduralMeshComponent* component = NewObject<UProceduralMeshComponent>(GetOwner(), NAME_None, RF_Transient);
+    component->SetupAttachment(this);
+    component->RegisterComponent();
+    file->component = component;
+
+    TArray<UMaterialInterface*> materials;
+    if (sourceMaterial)
+    {
+        asset->GetDynamicMaterials(this, sourceMaterial, materials);
+    }
+
+    applyingAssets.Add(fileId, asset);
+    TWeakObjectPtr<URuntimeMeshImportStreamingComponent> weakThis(this);
+    FRuntimeImportExportGameThreadDone callbackApplied;
+    callbackApplied.BindLambda([weakThis, fileId, loadId]() {
+        if (URuntimeMeshImportStreamingComponent* streaming = weakThis.Get())
+        {
+            streaming->OnFileApplied(fileId, loadId);
+        }
+    });
+    asset->ApplyToProceduralMesh_Async_Cpp(component, materials, callbackApplied, bCreateCollision);
+}
+
+void URuntimeMeshImportStreamingComponent::OnFileApplied(const int32 fileId, const int32 loadId)
+{
+    FStreamingFile* file = files.Find(fileId);
+    if (!file || file->loadId != loadId)
+    {
+        return;
+    }
+
+    file->state = ERuntimeMeshImportStreamingState::Loaded;
+    applyingAssets.Remove(fileId);
+}
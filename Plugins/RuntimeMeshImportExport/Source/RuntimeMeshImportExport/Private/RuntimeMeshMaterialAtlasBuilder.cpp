@@ -0,0 +1,507 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshMaterialAtlasBuilder.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshTextureBuilder.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+    const FName diffuseName(TEXT("Diffuse"));
+    const FName diffuseTextureName(TEXT("TexDiffuse"));
+    // The palette tile of a flat colored material
+    const int32 flatTileSize = 4;
+    // Texels around each tile that repeat its border, so filtering does not pick up the neighbours
+    const int32 tilePadding = 4;
+    const float uvTolerance = 0.001f;
+
+    struct FAtlasMember
+    {
+        int32 materialIndex = INDEX_NONE;
+        TArray<FRuntimeMeshImportSectionInfo*> sections;
+        // One texture per texture stack of the group, in the order of FAtlasGroup::textureNames. Empty for a flat material.
+        TArray<FRuntimeMeshTextureMips> textures;
+        FIntPoint tileSize = FIntPoint::ZeroValue;
+        // The position of the tile in its atlas, without the padding
+        FIntPoint tileOffset = FIntPoint::ZeroValue;
+    };
+
+    struct FAtlasGroup
+    {
+        bool bFlat = false;
+        TArray<FName> textureNames;
+        TArray<FAtlasMember> members;
+    };
+
+    struct FAtlas
+    {
+        int32 groupIndex = INDEX_NONE;
+        // Indices into FAtlasGroup::members
+        TArray<int32> members;
+        FIntPoint size = FIntPoint::ZeroValue;
+    };
+
+    // Materials with the same key can share an atlas
+    FString GetCompatibilityKey(const FRuntimeMeshImportMaterialInfo& material)
+    {
+        const bool bFlat = material.textures.Num() == 0;
+        FString key = FString::Printf(TEXT("%d|%d|%d|%d|%d"), bFlat, material.bTwoSided, material.bWireFrame, material.shadingModeInt, material.blendModeInt);
+        for (const FRuntimeMeshImportExportMaterialParamScalar& scalar : material.scalars)
+        {
+            key += FString::Printf(TEXT("|%s=%g"), *scalar.name.ToString(), scalar.value);
+        }
+        for (const FRuntimeMeshImportExportMaterialParamVector& vector : material.vectors)
+        {
+            // The palette holds the diffuse color of a flat material
+            if (!bFlat || vector.name != diffuseName)
+            {
+                key += FString::Printf(TEXT("|%s=%s"), *vector.name.ToString(), *vector.value.ToString());
+            }
+        }
+        TArray<FString> textures;
+        for (const FRuntimeMeshImportExportMaterialParamTexture& texture : material.textures)
+        {
+            textures.Add(FString::Printf(TEXT("|%s:%d"), *texture.name.ToString(), int32(texture.compression)));
+        }
+        textures.Sort();
+        for (const FString& texture : textures)
+        {
+            key += texture;
+        }
+        return key;
+    }
+
+    bool HasUnitUVs(const FRuntimeMeshImportSectionInfo& section)
+    {
+        if (section.uv0.Num() != section.vertices.Num())
+        {
+            return false;
+        }
+        for (const FVector2D& uv : section.uv0)
+        {
+            if (uv.X < -uvTolerance || uv.X > 1.f + uvTolerance || uv.Y < -uvTolerance || uv.Y > 1.f + uvTolerance)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DecodeTexture(const FRuntimeMeshImportExportMaterialParamTexture& texture, const bool bUseTextureCache, FRuntimeMeshTextureMips& outMips)
+    {
+        if (texture.IsDataDeferred())
+        {
+            FRuntimeMeshImportExportMaterialParamTexture loaded = texture;
+            return URuntimeMeshImportExportLibrary::LoadTextureData_AnyThread(loaded, bUseTextureCache) && DecodeTexture(loaded, bUseTextureCache, outMips);
+        }
+        // With a height the bytes are raw aiTexel data, otherwise an image file
+        return texture.height != 0
+            ? FRuntimeMeshTextureBuilder::FromTexels_AnyThread(TArray<uint8>(texture.byteData), texture.width, texture.height, outMips)
+            : FRuntimeMeshTextureBuilder::DecodeImage_AnyThread(texture.byteData, outMips);
+    }
+
+    // Bilinear lookup of BGRA8 texels at 'u', 'v' in 0 to 1, clamped at the borders
+    void SampleBilinear(const uint8* texels, const FIntPoint& size, const float u, const float v, uint8* outTexel)
+    {
+        const float x = FMath::Clamp(u * size.X - 0.5f, 0.f, float(size.X - 1));
+        const float y = FMath::Clamp(v * size.Y - 0.5f, 0.f, float(size.Y - 1));
+        const int32 x0 = FMath::FloorToInt(x);
+        const int32 y0 = FMath::FloorToInt(y);
+        const int32 x1 = FMath::Min(x0 + 1, size.X - 1);
+        const int32 y1 = FMath::Min(y0 + 1, size.Y - 1);
+        const float fractionX = x - x0;
+        const float fractionY = y - y0;
+        for (int32 channel = 0; channel < 4; ++channel)
+        {
+            auto Texel = [texels, &size, channel](const int32 texelX, const int32 texelY) {
+                return float(texels[(int64(texelY) * size.X + texelX) * 4 + channel]);
+            };
+            const float top = FMath::Lerp(Texel(x0, y0), Texel(x1, y0), fractionX);
+            const float bottom = FMath::Lerp(Texel(x0, y1), Texel(x1, y1), fractionX);
+            outTexel[channel] = uint8(FMath::Clamp(FMath::RoundToInt(FMath::Lerp(top, bottom, fractionY)), 0, 255));
+        }
+    }
+
+    // Copies 'texture' to its tile including the padding, resampled when it is smaller than the tile.
+    void BlitTile(const FRuntimeMeshTextureMips& texture, const FAtlasMember& member, const FIntPoint& atlasSize, uint8* atlasTexels)
+    {
+        const FIntPoint sourceSize = texture.sizes[0];
+        const uint8* sourceTexels = texture.mips[0].GetData();
+        const bool bSameSize = sourceSize == member.tileSize;
+        for (int32 y = -tilePadding; y < member.tileSize.Y + tilePadding; ++y)
+        {
+            const int32 tileY = FMath::Clamp(y, 0, member.tileSize.Y - 1);
+            uint8* destRow = atlasTexels + (int64(member.tileOffset.Y + y) * atlasSize.X + member.tileOffset.X) * 4;
+            for (int32 x = -tilePadding; x < member.tileSize.X + tilePadding; ++x)
+            {
+                const int32 tileX = FMath::Clamp(x, 0, member.tileSize.X - 1);
+                uint8* dest = destRow + x * 4;
+                if (bSameSize)
+                {
+                    FMemory::Memcpy(dest, sourceTexels + (int64(tileY) * sourceSize.X + tileX) * 4, 4);
+                }
+                else
+                {
+                    SampleBilinear(sourceTexels, sourceSize, (tileX + 0.5f) / member.tileSize.X, (tileY + 0.5f) / member.tileSize.Y, dest);
+                }
+            }
+        }
+    }
+
+    void FillTile(const FColor& color, const FAtlasMember& member, const FIntPoint& atlasSize, uint8* atlasTexels)
+    {
+        // FColor is laid out as BGRA
+        for (int32 y = -tilePadding; y < member.tileSize.Y + tilePadding; ++y)
+        {
+            FColor* destRow = reinterpret_cast<FColor*>(atlasTexels) + int64(member.tileOffset.Y + y) * atlasSize.X + member.tileOffset.X;
+            for (int32 x = -tilePadding; x < member.tileSize.X + tilePadding; ++x)
+            {
+                destRow[x] = color;
+            }
+        }
+    }
+
+    // Shelf packs the tiles of 'group' by decreasing height. A new atlas is started when a tile does not fit anymore.
+    void PackGroup(const int32 groupIndex, FAtlasGroup& group, const int32 maxAtlasSize, TArray<FAtlas>& outAtlases)
+    {
+        TArray<int32> order;
+        for (int32 memberIndex = 0; memberIndex < group.members.Num(); ++memberIndex)
+        {
+            const FIntPoint& tileSize = group.members[memberIndex].tileSize;
+            // Larger tiles keep their material
+            if (tileSize.X > 0 && tileSize.Y > 0 && tileSize.X + 2 * tilePadding <= maxAtlasSize && tileSize.Y + 2 * tilePadding <= maxAtlasSize)
+            {
+                order.Add(memberIndex);
+            }
+        }
+        Algo::Sort(order, [&group](const int32 a, const int32 b) {
+            const FIntPoint& sizeA = group.members[a].tileSize;
+            const FIntPoint& sizeB = group.members[b].tileSize;
+            return sizeA.Y != sizeB.Y ? sizeA.Y > sizeB.Y : sizeA.X > sizeB.X;
+        });
+
+        const int32 firstAtlas = outAtlases.Num();
+        int32 atlasIndex = INDEX_NONE;
+        int32 shelfX = 0;
+        int32 shelfY = 0;
+        int32 shelfHeight = 0;
+        for (const int32 memberIndex : order)
+        {
+            FAtlasMember& member = group.members[memberIndex];
+            const FIntPoint paddedSize = member.tileSize + FIntPoint(2 * tilePadding);
+            if (atlasIndex != INDEX_NONE && shelfX + paddedSize.X > maxAtlasSize)
+            {
+                shelfY += shelfHeight;
+                shelfX = 0;
+                shelfHeight = 0;
+            }
+            if (atlasIndex == INDEX_NONE || shelfY + paddedSize.Y > maxAtlasSize)
+            {
+                atlasIndex = outAtlases.AddDefaulted();
+                outAtlases[atlasIndex].groupIndex = groupIndex;
+                shelfX = 0;
+                shelfY = 0;
+                shelfHeight = 0;
+            }
+
+            FAtlas& atlas = outAtlases[atlasIndex];
+            member.tileOffset = FIntPoint(shelfX + tilePadding, shelfY + tilePadding);
+            atlas.members.Add(memberIndex);
+            atlas.size.X = FMath::Max(atlas.size.X, shelfX + paddedSize.X);
+            atlas.size.Y = FMath::Max(atlas.size.Y, shelfY + paddedSize.Y);
+            shelfX += paddedSize.X;
+            shelfHeight = FMath::Max(shelfHeight, paddedSize.Y);
+        }
+
+        for (int32 index = outAtlases.Num() - 1; index >= firstAtlas; --index)
+        {
+            // A single material gains nothing from an atlas
+            if (outAtlases[index].members.Num() < 2)
+            {
+                outAtlases.RemoveAt(index);
+                continue;
+            }
+            // A power of two, so the mips down to 1x1 can be generated
+            FIntPoint& size = outAtlases[index].size;
+            size = FIntPoint(int32(FMath::RoundUpToPowerOfTwo(uint32(size.X))), int32(FMath::RoundUpToPowerOfTwo(uint32(size.Y))));
+        }
+    }
+
+    FRuntimeMeshImportExportMaterialParamTexture MakeAtlasTexture(const FName name, const FIntPoint& size, TArray<uint8>&& texels, const ERuntimeMeshImportTextureCompression compression)
+    {
+        FRuntimeMeshImportExportMaterialParamTexture texture(name);
+        // Raw BGRA8 texels, like an uncompressed embedded texture
+        texture.width = size.X;
+        texture.height = size.Y;
+        texture.byteDescription = TEXT("bgra8888");
+        texture.byteData = MoveTemp(texels);
+        texture.compression = compression;
+        return texture;
+    }
+
+    void BuildAtlas(const FAtlas& atlas, const FAtlasGroup& group, const TArray<FRuntimeMeshImportMaterialInfo>& materialInfos, const int32 atlasMaterialIndex
+        , FRuntimeMeshImportMaterialInfo& outMaterial)
+    {
+        // The members are compatible, the first one gives the flags, scalars and vectors
+        const FRuntimeMeshImportMaterialInfo& first = materialInfos[group.members[atlas.members[0]].materialIndex];
+        outMaterial.name = FName(TEXT("Atlas"), atlasMaterialIndex + 1);
+        outMaterial.bTwoSided = first.bTwoSided;
+        outMaterial.bWireFrame = first.bWireFrame;
+        outMaterial.shadingMode = first.shadingMode;
+        outMaterial.shadingModeInt = first.shadingModeInt;
+        outMaterial.blendMode = first.blendMode;
+        outMaterial.blendModeInt = first.blendModeInt;
+        outMaterial.scalars = first.scalars;
+        outMaterial.vectors = first.vectors;
+        const int64 numAtlasBytes = int64(atlas.size.X) * atlas.size.Y * 4;
+
+        if (group.bFlat)
+        {
+            TArray<uint8> texels;
+            texels.SetNumZeroed(numAtlasBytes);
+            for (const int32 memberIndex : atlas.members)
+            {
+                const FAtlasMember& member = group.members[memberIndex];
+                const FRuntimeMeshImportExportMaterialParamVector* diffuse = materialInfos[member.materialIndex].vectors.FindByPredicate(
+                    [](const FRuntimeMeshImportExportMaterialParamVector& vector) { return vector.name == diffuseName; });
+                FillTile((diffuse ? diffuse->value : FLinearColor::White).ToFColor(true), member, atlas.size, texels.GetData());
+            }
+            // The palette holds the color, the material multiplies it with white
+            outMaterial.vectors.RemoveAll([](const FRuntimeMeshImportExportMaterialParamVector& vector) { return vector.name == diffuseName; });
+            outMaterial.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(FName(diffuseName), FLinearColor::White));
+            // The palette is small and flat, compression would only blur the colors together
+            outMaterial.textures.Add(MakeAtlasTexture(diffuseTextureName, atlas.size, MoveTemp(texels), ERuntimeMeshImportTextureCompression::None));
+        }
+        else
+        {
+            for (int32 textureIndex = 0; textureIndex < group.textureNames.Num(); ++textureIndex)
+            {
+                TArray<uint8> texels;
+                texels.SetNumZeroed(numAtlasBytes);
+                for (const int32 memberIndex : atlas.members)
+                {
+                    const FAtlasMember& member = group.members[memberIndex];
+                    BlitTile(member.textures[textureIndex], member, atlas.size, texels.GetData());
+                }
+                const FName textureName = group.textureNames[textureIndex];
+                const FRuntimeMeshImportExportMaterialParamTexture* firstTexture = first.textures.FindByPredicate(
+                    [textureName](const FRuntimeMeshImportExportMaterialParamTexture& texture) { return texture.name == textureName; });
+                outMaterial.textures.Add(MakeAtlasTexture(textureName, atlas.size, MoveTemp(texels), firstTexture->compression));
+            }
+        }
+
+        // Move the UVs into the tiles
+        const FVector2D atlasSize(atlas.size.X, atlas.size.Y);
+        for (const int32 memberIndex : atlas.members)
+        {
+            const FAtlasMember& member = group.members[memberIndex];
+            const FVector2D tileOffset(member.tileOffset.X, member.tileOffset.Y);
+            const FVector2D tileSize(member.tileSize.X, member.tileSize.Y);
+            for (FRuntimeMeshImportSectionInfo* section : member.sections)
+            {
+                if (group.bFlat)
+                {
+                    section->uv0.Init((tileOffset + tileSize * 0.5f) / atlasSize, section->vertices.Num());
+                }
+                else
+                {
+                    for (FVector2D& uv : section->uv0)
+                    {
+                        const FVector2D unitUV(FMath::Clamp(uv.X, 0.f, 1.f), FMath::Clamp(uv.Y, 0.f, 1.f));
+                        uv = (tileOffset + unitUV * tileSize) / atlasSize;
+                    }
+                }
+                section->materialIndex = atlasMaterialIndex;
+                section->materialName = outMaterial.name;
+            }
+        }
+    }
+}
+
+int32 FRuntimeMeshMaterialAtlasBuilder::AtlasMaterials_AnyThread(const FRuntimeMeshImportParam& param, TArray<FRuntimeMeshImportMaterialInfo>& materialInfos
+    , TArrayView<FRuntimeMeshImportMeshInfo> meshInfos)
+{
+    const int32 numMaterials = materialInfos.Num();
+    if (numMaterials < 2)
+    {
+        return 0;
+    }
+
+    // The sections of every material
+    TArray<TArray<FRuntimeMeshImportSectionInfo*>> materialSections;
+    materialSections.SetNum(numMaterials);
+    for (FRuntimeMeshImportMeshInfo& meshInfo : meshInfos)
+    {
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            if (materialInfos.IsValidIndex(section.materialIndex))
+            {
+                materialSections[section.materialIndex].Add(&section);
+            }
+        }
+    }
+
+    // Group the used materials that are compatible, a textured material needs UVs that stay within its tile
+    TArray<FAtlasGroup> groups;
+    TMap<FString, int32> keyToGroup;
+    for (int32 materialIndex = 0; materialIndex < numMaterials; ++materialIndex)
+    {
+        const FRuntimeMeshImportMaterialInfo& material = materialInfos[materialIndex];
+        const bool bFlat = material.textures.Num() == 0;
+        TArray<FRuntimeMeshImportSectionInfo*>& sections = materialSections[materialIndex];
+        if (sections.Num() == 0 || (!bFlat && sections.ContainsByPredicate([](const FRuntimeMeshImportSectionInfo* section) { return !HasUnitUVs(*section); })))
+        {
+            continue;
+        }
+
+        const FString key = GetCompatibilityKey(material);
+        int32* groupIndex = keyToGroup.Find(key);
+        if (!groupIndex)
+        {
+            groupIndex = &keyToGroup.Add(key, groups.AddDefaulted());
+            FAtlasGroup& group = groups[*groupIndex];
+            group.bFlat = bFlat;
+            for (const FRuntimeMeshImportExportMaterialParamTexture& texture : material.textures)
+            {
+                group.textureNames.AddUnique(texture.name);
+            }
+            group.textureNames.Sort(FNameLexicalLess());
+        }
+        FAtlasMember& member = groups[*groupIndex].members.AddDefaulted_GetRef();
+        member.materialIndex = materialIndex;
+        member.sections = MoveTemp(sections);
+    }
+    groups.RemoveAll([](const FAtlasGroup& group) { return group.members.Num() < 2; });
+    if (groups.Num() == 0)
+    {
+        return 0;
+    }
+
+    // A synchronous import on the GameThread can load the decoder itself
+    if (IsInGameThread())
+    {
+        FRuntimeMeshTextureBuilder::LoadModules_GameThread();
+    }
+
+    // Decode the textures of all members in parallel
+    struct FDecodeTask
+    {
+        FAtlasMember* member;
+        const FRuntimeMeshImportExportMaterialParamTexture* texture;
+        FRuntimeMeshTextureMips* mips;
+    };
+    TArray<FDecodeTask> decodeTasks;
+    for (FAtlasGroup& group : groups)
+    {
+        for (FAtlasMember& member : group.members)
+        {
+            if (group.bFlat)
+            {
+                member.tileSize = FIntPoint(flatTileSize);
+                continue;
+            }
+            const TArray<FRuntimeMeshImportExportMaterialParamTexture>& textures = materialInfos[member.materialIndex].textures;
+            member.textures.SetNum(group.textureNames.Num());
+            for (int32 textureIndex = 0; textureIndex < group.textureNames.Num(); ++textureIndex)
+            {
+                const FName textureName = group.textureNames[textureIndex];
+                const FRuntimeMeshImportExportMaterialParamTexture* texture = textures.FindByPredicate(
+                    [textureName](const FRuntimeMeshImportExportMaterialParamTexture& candidate) { return candidate.name == textureName; });
+                decodeTasks.Add({ &member, texture, &member.textures[textureIndex] });
+            }
+        }
+    }
+    ParallelFor(decodeTasks.Num(), [&decodeTasks, &param](int32 taskIndex)
+    {
+        const FDecodeTask& task = decodeTasks[taskIndex];
+        if (!DecodeTexture(*task.texture, param.bUseTextureCache, *task.mips))
+        {
+            RMIE_LOG(Warning, "Could not decode the texture %s for the atlas, its material is kept.", *task.texture->name.ToString());
+            *task.mips = FRuntimeMeshTextureMips();
+        }
+    });
+    for (FAtlasGroup& group : groups)
+    {
+        for (FAtlasMember& member : group.members)
+        {
+            // The tile fits the largest texture of the member, a member with a broken texture gets no tile
+            for (const FRuntimeMeshTextureMips& mips : member.textures)
+            {
+                if (!mips.IsValid())
+                {
+                    member.tileSize = FIntPoint::ZeroValue;
+                    break;
+                }
+                member.tileSize = member.tileSize.ComponentMax(mips.sizes[0]);
+            }
+        }
+    }
+
+    TArray<FAtlas> atlases;
+    const int32 maxAtlasSize = FMath::Max(param.atlasMaxSize, flatTileSize + 2 * tilePadding);
+    for (int32 groupIndex = 0; groupIndex < groups.Num(); ++groupIndex)
+    {
+        PackGroup(groupIndex, groups[groupIndex], maxAtlasSize, atlases);
+    }
+    if (atlases.Num() == 0)
+    {
+        return 0;
+    }
+
+    // The kept materials stay in their order, the atlas materials follow them
+    TArray<int32> materialRemap;
+    materialRemap.SetNumZeroed(numMaterials);
+    int32 numMerged = 0;
+    for (const FAtlas& atlas : atlases)
+    {
+        for (const int32 memberIndex : atlas.members)
+        {
+            materialRemap[groups[atlas.groupIndex].members[memberIndex].materialIndex] = INDEX_NONE;
+            ++numMerged;
+        }
+    }
+    int32 numKept = 0;
+    for (int32& newIndex : materialRemap)
+    {
+        newIndex = newIndex == INDEX_NONE ? INDEX_NONE : numKept++;
+    }
+    for (FRuntimeMeshImportMeshInfo& meshInfo : meshInfos)
+    {
+        for (FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            // The sections of merged materials are moved to their atlas material by BuildAtlas
+            if (materialRemap.IsValidIndex(section.materialIndex) && materialRemap[section.materialIndex] != INDEX_NONE)
+            {
+                section.materialIndex = materialRemap[section.materialIndex];
+            }
+        }
+    }
+
+    TArray<FRuntimeMeshImportMaterialInfo> atlasMaterials;
+    atlasMaterials.SetNum(atlases.Num());
+    ParallelFor(atlases.Num(), [&atlases, &groups, &materialInfos, &atlasMaterials, numKept](int32 atlasIndex)
+    {
+        const FAtlas& atlas = atlases[atlasIndex];
+        BuildAtlas(atlas, groups[atlas.groupIndex], materialInfos, numKept + atlasIndex, atlasMaterials[atlasIndex]);
+    });
+
+    TArray<FRuntimeMeshImportMaterialInfo> consolidated;
+    consolidated.Reserve(numKept + atlasMaterials.Num());
+    for (int32 materialIndex = 0; materialIndex < numMaterials; ++materialIndex)
+    {
+        if (materialRemap[materialIndex] != INDEX_NONE)
+        {
+            consolidated.Add(MoveTemp(materialInfos[materialIndex]));
+        }
+    }
+    consolidated.Append(MoveTemp(atlasMaterials));
+    materialInfos = MoveTemp(consolidated);
+
+    RMIE_LOG(Log, "Merged %d materials into %d atlas materials.", numMerged, atlases.Num());
+    return numMerged;
+}
@@ -0,0 +1,28 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRuntimeMeshImportParam;
+struct FRuntimeMeshImportMaterialInfo;
+struct FRuntimeMeshImportMeshInfo;
+
+/**
+ *	Consolidates the materials of an import, @see FRuntimeMeshImportParam::bAtlasMaterials.
+ *	Materials are compatible when their flags, scalars, vectors and texture stacks are equal. Flat colored materials may differ
+ *	in their "Diffuse" vector, it is baked into a "TexDiffuse" palette instead. The textures of compatible materials are shelf packed
+ *	into one atlas per texture stack, the UV0 of their sections is remapped to their tile and they are replaced by one material per atlas.
+ */
+struct FRuntimeMeshMaterialAtlasBuilder
+{
+    /**
+     * Runs on the calling thread, the textures are decoded and the atlases filled in parallel.
+     * A textured material is kept when one of its sections has UVs outside of 0 to 1, they would tile across the atlas.
+     * Decoding image files needs the ImageWrapper module, @see FRuntimeMeshTextureBuilder::LoadModules_GameThread.
+     * Returns the number of materials that were merged into atlas materials.
+     */
+    static int32 AtlasMaterials_AnyThread(const FRuntimeMeshImportParam& param, TArray<FRuntimeMeshImportMaterialInfo>& materialInfos, TArrayView<FRuntimeMeshImportMeshInfo> meshInfos);
+};
@@ -0,0 +1,260 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshSkeletalMeshBuilder.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "Algo/BinarySearch.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "GPUSkinVertexFactory.h"
+#include "Rendering/SkeletalMeshLODRenderData.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "StaticMeshResources.h"
+
+FRuntimeMeshSkeletalMeshData::FRuntimeMeshSkeletalMeshData() = default;
+FRuntimeMeshSkeletalMeshData::~FRuntimeMeshSkeletalMeshData() = default;
+
+namespace
+{
+    // The reference pose is the bind pose of the inverse bind transforms, relative to the parent bones
+    void BuildReferenceSkeleton(const TArray<FRuntimeMeshImportBone>& bones, FReferenceSkeleton& outRefSkeleton)
+    {
+        FReferenceSkeletonModifier modifier(outRefSkeleton, nullptr);
+        for (int32 boneIndex = 0; boneIndex < bones.Num(); ++boneIndex)
+        {
+            const FRuntimeMeshImportBone& bone = bones[boneIndex];
+            const FTransform bindTransform = bone.inverseBindTransform.Inverse();
+            const FTransform localTransform = bone.parentIndex == INDEX_NONE
+                ? bindTransform
+                : bindTransform.GetRelativeTransform(bones[bone.parentIndex].inverseBindTransform.Inverse());
+            modifier.Add(FMeshBoneInfo(bone.name, bone.name.ToString(), bone.parentIndex), localTransform);
+        }
+    }
+
+    // The parents are stored before their children and the skin weights reference the bones, like the import makes them
+    bool IsValidSkeleton(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<FRuntimeMeshImportBone>& bones)
+    {
+        for (int32 boneIndex = 0; boneIndex < bones.Num(); ++boneIndex)
+        {
+            const int32 parentIndex = bones[boneIndex].parentIndex;
+            if (parentIndex != INDEX_NONE && (parentIndex < 0 || parentIndex >= boneIndex))
+            {
+                return false;
+            }
+        }
+        for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+        {
+            for (const uint16 boneIndex : section.boneIndices)
+            {
+                if (int32(boneIndex) >= bones.Num())
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // The bones 'section' is weighted to, sorted. Empty when the section has no skin weights.
+    TArray<FBoneIndexType> GetSectionBoneMap(const FRuntimeMeshImportSectionInfo& section)
+    {
+        TArray<FBoneIndexType> boneMap;
+        for (int32 slot = 0; slot < section.boneIndices.Num(); ++slot)
+        {
+            if (section.boneWeights[slot] > 0)
+            {
+                boneMap.AddUnique(section.boneIndices[slot]);
+            }
+        }
+        boneMap.Sort();
+        return boneMap;
+    }
+}
+
+TUniquePtr<FRuntimeMeshSkeletalMeshData> FRuntimeMeshSkeletalMeshBuilder::BuildRenderData_AnyThread(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<FRuntimeMeshImportBone>& bones)
+{
+    if (bones.Num() == 0 || bones.Num() > MAX_uint16 + 1)
+    {
+        RMIE_LOG(Warning, "Mesh %s: a skeletal mesh needs between 1 and %d bones, the result has %d.", *meshInfo.meshName.ToString(), MAX_uint16 + 1, bones.Num());
+        return nullptr;
+    }
+    if (!IsValidSkeleton(meshInfo, bones))
+    {
+        RMIE_LOG(Warning, "Mesh %s: the bones are not the bones of its import. No skeletal mesh is created.", *meshInfo.meshName.ToString());
+        return nullptr;
+    }
+
+    int32 numVertices = 0;
+    int32 numIndices = 0;
+    for (const FRuntimeMeshImportSectionInfo& section : meshInfo.sections)
+    {
+        numVertices += section.vertices.Num();
+        numIndices += section.triangles.Num();
+    }
+    if (numIndices == 0)
+    {
+        return nullptr;
+    }
+
+    TUniquePtr<FRuntimeMeshSkeletalMeshData> data = MakeUnique<FRuntimeMeshSkeletalMeshData>();
+    BuildReferenceSkeleton(bones, data->refSkeleton);
+    data->lodRenderData = MakeUnique<FSkeletalMeshLODRenderData>();
+    FSkeletalMeshLODRenderData& lod = *data->lodRenderData;
+
+    TArray<FStaticMeshBuildVertex> vertices;
+    vertices.SetNumUninitialized(numVertices);
+    TArray<FSkinWeightInfo> weights;
+    weights.SetNumZeroed(numVertices);
+    TArray<uint32> indices;
+    indices.SetNumUninitialized(numIndices);
+
+    const bool bHasLightmapUVs = meshInfo.sections.ContainsByPredicate([](const FRuntimeMeshImportSectionInfo& section) {
+        return section.uv1.Num() > 0;
+    });
+    const int32 maxGPUSkinBones = FGPUBaseSkinVertexFactory::GetMaxGPUSkinBones();
+    int32 maxBoneInfluences = 1;
+    bool b16BitBoneIndices = false;
+
+    int32 firstVertex = 0;
+    int32 firstIndex = 0;
+    for (int32 sectionIndex = 0; sectionIndex < meshInfo.sections.Num(); ++sectionIndex)
+    {
+        const FRuntimeMeshImportSectionInfo& section = meshInfo.sections[sectionIndex];
+        const int32 numSectionVertices = section.vertices.Num();
+        const bool bHasNormals = section.normals.Num() == numSectionVertices;
+        const bool bHasTangents = section.tangents.Num() == numSectionVertices;
+        const bool bHasUVs = section.uv0.Num() == numSectionVertices;
+        const bool bHasSectionLightmapUVs = section.uv1.Num() == numSectionVertices;
+        const bool bHasColors = section.vertexColors.Num() == numSectionVertices;
+        const int32 numInfluences = section.boneIndices.Num() == numSectionVertices * section.numBoneInfluences ? section.numBoneInfluences : 0;
+        data->bHasVertexColors |= bHasColors;
+
+        FSkelMeshRenderSection& renderSection = lod.RenderSections.AddDefaulted_GetRef();
+        renderSection.BoneMap = numInfluences > 0 ? GetSectionBoneMap(section) : TArray<FBoneIndexType>();
+        if (renderSection.BoneMap.Num() == 0)
+        {
+            // Bound rigidly to the first bone, it keeps the bind pose of the mesh
+            renderSection.BoneMap.Add(0);
+        }
+        if (renderSection.BoneMap.Num() > maxGPUSkinBones)
+        {
+            RMIE_LOG(Warning, "Mesh %s: section %d uses %d bones, GPU skinning supports %d. No skeletal mesh is created."
+                , *meshInfo.meshName.ToString(), sectionIndex, renderSection.BoneMap.Num(), maxGPUSkinBones);
+            return nullptr;
+        }
+        b16BitBoneIndices |= renderSection.BoneMap.Num() > MAX_uint8 + 1;
+
+        for (int32 vertexIndex = 0; vertexIndex < numSectionVertices; ++vertexIndex)
+        {
+            FStaticMeshBuildVertex& vertex = vertices[firstVertex + vertexIndex];
+            vertex.Position = section.vertices[vertexIndex];
+            vertex.TangentZ = bHasNormals ? section.normals[vertexIndex] : FVector::UpVector;
+            vertex.TangentX = bHasTangents ? section.tangents[vertexIndex] : FVector::ForwardVector;
+            vertex.TangentY = FVector::CrossProduct(vertex.TangentZ, vertex.TangentX);
+            vertex.UVs[0] = bHasUVs ? section.uv0[vertexIndex] : FVector2D::ZeroVector;
+            vertex.UVs[1] = bHasSectionLightmapUVs ? section.uv1[vertexIndex] : FVector2D::ZeroVector;
+            // Not sRGB, like UProceduralMeshComponent::CreateMeshSection_LinearColor
+            vertex.Color = bHasColors ? section.vertexColors[vertexIndex].ToFColor(false) : FColor::White;
+            data->bounds += vertex.Position;
+        }
+
+        // The weights of the import are sorted descending and sum up to 255, the bone indices become indices into the bone map
+        const int32 numSlots = FMath::Min(numInfluences, int32(MAX_TOTAL_INFLUENCES));
+        maxBoneInfluences = FMath::Max(maxBoneInfluences, numSlots);
+        for (int32 vertexIndex = 0; vertexIndex < numSectionVertices; ++vertexIndex)
+        {
+            FSkinWeightInfo& weight = weights[firstVertex + vertexIndex];
+            const uint16* vertexBones = section.boneIndices.GetData() + vertexIndex * numInfluences;
+            const uint8* vertexWeights = section.boneWeights.GetData() + vertexIndex * numInfluences;
+            // A vertex without weights follows the first bone of the section instead of collapsing to the origin
+            if (numSlots == 0 || vertexWeights[0] == 0)
+            {
+                weight.InfluenceWeights[0] = 255;
+                continue;
+            }
+            for (int32 slot = 0; slot < numSlots; ++slot)
+            {
+                if (vertexWeights[slot] > 0)
+                {
+                    weight.InfluenceBones[slot] = FBoneIndexType(Algo::BinarySearch(renderSection.BoneMap, FBoneIndexType(vertexBones[slot])));
+                    weight.InfluenceWeights[slot] = vertexWeights[slot];
+                }
+            }
+        }
+
+        for (int32 index = 0; index < section.triangles.Num(); ++index)
+        {
+            indices[firstIndex + index] = uint32(section.triangles[index] + firstVertex);
+        }
+
+        renderSection.MaterialIndex = uint16(sectionIndex);
+        renderSection.BaseIndex = firstIndex;
+        renderSection.NumTriangles = section.triangles.Num() / 3;
+        renderSection.BaseVertexIndex = firstVertex;
+        renderSection.NumVertices = numSectionVertices;
+        renderSection.bCastShadow = true;
+        renderSection.DuplicatedVerticesBuffer.Init(numSectionVertices, TMap<int, TArray<int32>>());
+
+        data->slotNames.Add(section.materialName);
+        firstVertex += numSectionVertices;
+        firstIndex += section.triangles.Num();
+    }
+
+    for (FSkelMeshRenderSection& renderSection : lod.RenderSections)
+    {
+        renderSection.MaxBoneInfluences = maxBoneInfluences;
+    }
+
+    // Every bone is active, the parents are stored before their children
+    lod.ActiveBoneIndices.SetNumUninitialized(bones.Num());
+    for (int32 boneIndex = 0; boneIndex < bones.Num(); ++boneIndex)
+    {
+        lod.ActiveBoneIndices[boneIndex] = FBoneIndexType(boneIndex);
+    }
+    lod.RequiredBones = lod.ActiveBoneIndices;
+
+    lod.StaticVertexBuffers.PositionVertexBuffer.Init(vertices);
+    lod.StaticVertexBuffers.StaticMeshVertexBuffer.Init(vertices, bHasLightmapUVs ? 2 : 1);
+    lod.StaticVertexBuffers.ColorVertexBuffer.Init(vertices);
+    lod.SkinWeightVertexBuffer.SetMaxBoneInfluences(maxBoneInfluences);
+    lod.SkinWeightVertexBuffer.SetUse16BitBoneIndex(b16BitBoneIndices);
+    lod.SkinWeightVertexBuffer = weights;
+    lod.MultiSizeIndexContainer.RebuildIndexBuffer(numVertices > MAX_uint16 + 1 ? sizeof(uint32) : sizeof(uint16), indices);
+    return data;
+}
+
+USkeletalMesh* FRuntimeMeshSkeletalMeshBuilder::CreateSkeletalMesh_GameThread(TUniquePtr<FRuntimeMeshSkeletalMeshData>&& data, TArrayView<UMaterialInterface* const> materials)
+{
+    check(IsInGameThread());
+    if (!data.IsValid())
+    {
+        return nullptr;
+    }
+
+    USkeletalMesh* skeletalMesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+    skeletalMesh->RefSkeleton = MoveTemp(data->refSkeleton);
+    skeletalMesh->CalculateInvRefMatrices();
+    skeletalMesh->bHasVertexColors = data->bHasVertexColors;
+    for (int32 slotIndex = 0; slotIndex < data->slotNames.Num(); ++slotIndex)
+    {
+        UMaterialInterface* material = materials.IsValidIndex(slotIndex) ? materials[slotIndex] : nullptr;
+        skeletalMesh->Materials.Add(FSkeletalMaterial(material, true, false, data->slotNames[slotIndex], data->slotNames[slotIndex]));
+    }
+
+    FSkeletalMeshLODInfo& lodInfo = skeletalMesh->AddLODInfo();
+    lodInfo.ScreenSize.Default = 1.f;
+    lodInfo.LODHysteresis = 0.02f;
+
+    skeletalMesh->AllocateResourceForRendering();
+    skeletalMesh->GetResourceForRendering()->LODRenderData.Add(data->lodRenderData.Release());
+    skeletalMesh->SetImportedBounds(FBoxSphereBounds(data->bounds));
+
+    USkeleton* skeleton = NewObject<USkeleton>(GetTransientPackage(), NAME_None, RF_Transient);
+    skeleton->MergeAllBonesToBoneTree(skeletalMesh);
+    skeletalMesh->Skeleton = skeleton;
+
+    skeletalMesh->InitResources();
+    return skeletalMesh;
+}
@@ -0,0 +1,52 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReferenceSkeleton.h"
+
+class USkeletalMesh;
+class UMaterialInterface;
+class FSkeletalMeshLODRenderData;
+struct FRuntimeMeshImportMeshInfo;
+struct FRuntimeMeshImportBone;
+
+// What FRuntimeMeshSkeletalMeshBuilder::BuildRenderData_AnyThread hands to the GameThread
+struct FRuntimeMeshSkeletalMeshData
+{
+    TUniquePtr<FSkeletalMeshLODRenderData> lodRenderData;
+    FReferenceSkeleton refSkeleton;
+    TArray<FName> slotNames;
+    FBox bounds = FBox(ForceInit);
+    bool bHasVertexColors = false;
+
+    FRuntimeMeshSkeletalMeshData();
+    ~FRuntimeMeshSkeletalMeshData();
+};
+
+/**
+ *	Builds runtime skeletal meshes in two steps, like FRuntimeMeshStaticMeshBuilder.
+ *	The reference skeleton and the vertex, skin weight and index buffers are filled on any thread,
+ *	the GameThread only creates the USkeletalMesh with its USkeleton and initializes the render resources.
+ *
+ *	The reference pose is taken from FRuntimeMeshImportBone::inverseBindTransform, so the inverse reference matrices
+ *	of the mesh are exactly the inverse bind transforms the vertices were imported with.
+ *	Morph targets and the generated LODs are not built, the mesh has a single LOD.
+ */
+struct FRuntimeMeshSkeletalMeshBuilder
+{
+    /**
+     * One render section per section of 'meshInfo'. Sections without skin weights are bound to the first bone.
+     * Returns nullptr when the mesh has no triangles, there are no bones, the bones or skin weights are not valid,
+     * or a section uses more bones than GPU skinning supports.
+     */
+    static TUniquePtr<FRuntimeMeshSkeletalMeshData> BuildRenderData_AnyThread(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<FRuntimeMeshImportBone>& bones);
+
+    /**
+     * Creates a transient skeletal mesh and its skeleton from 'data' and starts its upload to the GPU.
+     * @param materials		The material of each slot. Can be shorter than the slots, missing slots get the default material.
+     */
+    static USkeletalMesh* CreateSkeletalMesh_GameThread(TUniquePtr<FRuntimeMeshSkeletalMeshData>&& data, TArrayView<UMaterialInterface* const> materials);
+};
@@ -0,0 +1,226 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshStaticMeshBuilder.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportCompactTypes.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+
+namespace
+{
+    int32 GetNumSectionIndices(const FRuntimeMeshImportSectionInfo& section)
+    {
+        return section.triangles.Num();
+    }
+
+    int32 GetNumSectionIndices(const FRuntimeMeshImportCompactSection& section)
+    {
+        return section.GetNumIndices();
+    }
+
+    template<typename SectionType>
+    int32 GetNumIndices(const TArray<SectionType>& sections)
+    {
+        int32 numIndices = 0;
+        for (const SectionType& section : sections)
+        {
+            numIndices += GetNumSectionIndices(section);
+        }
+        return numIndices;
+    }
+
+    // Writes the vertices and the indices, offset by 'firstVertex', of 'section'
+    void WriteSection(const FRuntimeMeshImportSectionInfo& section, const int32 firstVertex, FStaticMeshBuildVertex* outVertices, uint32* outIndices, FBox& bounds)
+    {
+        const int32 numSectionVertices = section.vertices.Num();
+        const bool bHasNormals = section.normals.Num() == numSectionVertices;
+        const bool bHasTangents = section.tangents.Num() == numSectionVertices;
+        const bool bHasUVs = section.uv0.Num() == numSectionVertices;
+        const bool bHasLightmapUVs = section.uv1.Num() == numSectionVertices;
+        const bool bHasColors = section.vertexColors.Num() == numSectionVertices;
+
+        for (int32 vertexIndex = 0; vertexIndex < numSectionVertices; ++vertexIndex)
+        {
+            FStaticMeshBuildVertex& vertex = outVertices[vertexIndex];
+            vertex.Position = section.vertices[vertexIndex];
+            vertex.TangentZ = bHasNormals ? section.normals[vertexIndex] : FVector::UpVector;
+            vertex.TangentX = bHasTangents ? section.tangents[vertexIndex] : FVector::ForwardVector;
+            vertex.TangentY = FVector::CrossProduct(vertex.TangentZ, vertex.TangentX);
+            vertex.UVs[0] = bHasUVs ? section.uv0[vertexIndex] : FVector2D::ZeroVector;
+            vertex.UVs[1] = bHasLightmapUVs ? section.uv1[vertexIndex] : FVector2D::ZeroVector;
+            // Not sRGB, like UProceduralMeshComponent::CreateMeshSection_LinearColor
+            vertex.Color = bHasColors ? section.vertexColors[vertexIndex].ToFColor(false) : FColor::White;
+            bounds += vertex.Position;
+        }
+
+        for (int32 index = 0; index < section.triangles.Num(); ++index)
+        {
+            outIndices[index] = uint32(section.triangles[index] + firstVertex);
+        }
+    }
+
+    // The packed streams are unpacked right into the build vertices, without the full precision section in between
+    void WriteSection(const FRuntimeMeshImportCompactSection& section, const int32 firstVertex, FStaticMeshBuildVertex* outVertices, uint32* outIndices, FBox& bounds)
+    {
+        const int32 numSectionVertices = section.vertices.Num();
+        const bool bHasNormals = section.normals.Num() == numSectionVertices;
+        const bool bHasTangents = section.tangents.Num() == numSectionVertices;
+        const bool bHasUVs = section.GetNumUVs() == numSectionVertices;
+        const bool bHasLightmapUVs = section.uv1.Num() == numSectionVertices;
+        const bool bHasColors = section.vertexColors.Num() == numSectionVertices;
+
+        for (int32 vertexIndex = 0; vertexIndex < numSectionVertices; ++vertexIndex)
+        {
+            FStaticMeshBuildVertex& vertex = outVertices[vertexIndex];
+            vertex.Position = section.vertices[vertexIndex];
+            vertex.TangentZ = bHasNormals ? section.normals[vertexIndex].ToFVector() : FVector::UpVector;
+            vertex.TangentX = bHasTangents ? section.tangents[vertexIndex].ToFVector() : FVector::ForwardVector;
+            vertex.TangentY = FVector::CrossProduct(vertex.TangentZ, vertex.TangentX);
+            vertex.UVs[0] = bHasUVs ? section.GetUV(vertexIndex) : FVector2D::ZeroVector;
+            vertex.UVs[1] = bHasLightmapUVs ? section.uv1[vertexIndex] : FVector2D::ZeroVector;
+            vertex.Color = bHasColors ? section.vertexColors[vertexIndex] : FColor::White;
+            bounds += vertex.Position;
+        }
+
+        const int32 numIndices = section.GetNumIndices();
+        for (int32 index = 0; index < numIndices; ++index)
+        {
+            outIndices[index] = uint32(section.GetIndex(index) + firstVertex);
+        }
+    }
+
+    /**
+     * Fills the buffers of 'lod' with 'sections'. Section i uses material slot i.
+     * @param bSkipEmptySections	Generated LODs can lose a whole section, LOD 0 keeps one section per slot
+     * @param numTexCoords			2 when the mesh has lightmap UVs, they are UV channel 1
+     */
+    template<typename SectionType>
+    void FillLODResources(const TArray<SectionType>& sections, const bool bSkipEmptySections, const uint32 numTexCoords, FStaticMeshLODResources& lod, FBox& bounds)
+    {
+        int32 numVertices = 0;
+        for (const SectionType& section : sections)
+        {
+            numVertices += section.vertices.Num();
+        }
+
+        TArray<FStaticMeshBuildVertex> vertices;
+        vertices.SetNumUninitialized(numVertices);
+        TArray<uint32> indices;
+        indices.SetNumUninitialized(GetNumIndices(sections));
+
+        int32 firstVertex = 0;
+        int32 firstIndex = 0;
+        for (int32 sectionIndex = 0; sectionIndex < sections.Num(); ++sectionIndex)
+        {
+            const SectionType& section = sections[sectionIndex];
+            const int32 numSectionVertices = section.vertices.Num();
+            const int32 numSectionIndices = GetNumSectionIndices(section);
+            WriteSection(section, firstVertex, vertices.GetData() + firstVertex, indices.GetData() + firstIndex, bounds);
+
+            if (!bSkipEmptySections || numSectionIndices > 0)
+            {
+                FStaticMeshSection& meshSection = lod.Sections.AddDefaulted_GetRef();
+                meshSection.MaterialIndex = sectionIndex;
+                meshSection.FirstIndex = firstIndex;
+                meshSection.NumTriangles = numSectionIndices / 3;
+                meshSection.MinVertexIndex = firstVertex;
+                meshSection.MaxVertexIndex = FMath::Max(firstVertex + numSectionVertices - 1, firstVertex);
+                meshSection.bEnableCollision = true;
+                meshSection.bCastShadow = true;
+            }
+
+            firstVertex += numSectionVertices;
+            firstIndex += numSectionIndices;
+        }
+
+        // No CPU copies, the buffers are only needed on the GPU
+        lod.VertexBuffers.PositionVertexBuffer.Init(vertices, false);
+        lod.VertexBuffers.StaticMeshVertexBuffer.Init(vertices, numTexCoords, false);
+        lod.VertexBuffers.ColorVertexBuffer.Init(vertices, false);
+        lod.IndexBuffer.SetIndices(indices, EIndexBufferStride::AutoDetect);
+    }
+
+    // For FRuntimeMeshImportMeshInfo and FRuntimeMeshImportCompactMeshInfo, @see FRuntimeMeshStaticMeshBuilder::BuildRenderData_AnyThread
+    template<typename MeshInfoType>
+    TUniquePtr<FStaticMeshRenderData> BuildRenderData(const MeshInfoType& meshInfo, TArray<FName>& outSlotNames)
+    {
+        if (GetNumIndices(meshInfo.sections) == 0)
+        {
+            return nullptr;
+        }
+
+        // The generated LODs up to the first one that lost all triangles
+        int32 numLODs = 1;
+        while (numLODs < MAX_STATIC_MESH_LODS && meshInfo.lods.IsValidIndex(numLODs - 1) && GetNumIndices(meshInfo.lods[numLODs - 1].sections) > 0)
+        {
+            ++numLODs;
+        }
+
+        // One material slot per section
+        outSlotNames.Reset(meshInfo.sections.Num());
+        for (const auto& section : meshInfo.sections)
+        {
+            outSlotNames.Add(section.materialName);
+        }
+
+        TUniquePtr<FStaticMeshRenderData> renderData = MakeUnique<FStaticMeshRenderData>();
+        renderData->AllocateLODResources(numLODs);
+
+        const bool bHasLightmapUVs = meshInfo.sections.ContainsByPredicate([](const auto& section) {
+            return section.uv1.Num() > 0;
+        });
+        const uint32 numTexCoords = bHasLightmapUVs ? 2 : 1;
+
+        FBox bounds(ForceInit);
+        FillLODResources(meshInfo.sections, false, numTexCoords, renderData->LODResources[0], bounds);
+        renderData->ScreenSize[0].Default = 1.f;
+        for (int32 lodIndex = 1; lodIndex < numLODs; ++lodIndex)
+        {
+            const auto& meshLOD = meshInfo.lods[lodIndex - 1];
+            FillLODResources(meshLOD.sections, true, numTexCoords, renderData->LODResources[lodIndex], bounds);
+            renderData->ScreenSize[lodIndex].Default = meshLOD.screenSize;
+        }
+
+        renderData->Bounds = FBoxSphereBounds(bounds);
+        return renderData;
+    }
+}
+
+TUniquePtr<FStaticMeshRenderData> FRuntimeMeshStaticMeshBuilder::BuildRenderData_AnyThread(const FRuntimeMeshImportMeshInfo& meshInfo, TArray<FName>& outSlotNames)
+{
+    return BuildRenderData(meshInfo, outSlotNames);
+}
+
+TUniquePtr<FStaticMeshRenderData> FRuntimeMeshStaticMeshBuilder::BuildRenderData_AnyThread(const FRuntimeMeshImportCompactMeshInfo& meshInfo, TArray<FName>& outSlotNames)
+{
+    return BuildRenderData(meshInfo, outSlotNames);
+}
+
+UStaticMesh* FRuntimeMeshStaticMeshBuilder::CreateStaticMesh_GameThread(TUniquePtr<FStaticMeshRenderData>&& renderData, const TArray<FName>& slotNames, TArrayView<UMaterialInterface* const> materials)
+{
+    check(IsInGameThread());
+    if (!renderData.IsValid())
+    {
+        return nullptr;
+    }
+
+    UStaticMesh* staticMesh = NewObject<UStaticMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+    staticMesh->NeverStream = true;
+    if (renderData->LODResources[0].VertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords() > 1)
+    {
+        staticMesh->LightMapCoordinateIndex = 1;
+    }
+    for (int32 slotIndex = 0; slotIndex < slotNames.Num(); ++slotIndex)
+    {
+        UMaterialInterface* material = materials.IsValidIndex(slotIndex) ? materials[slotIndex] : nullptr;
+        staticMesh->StaticMaterials.Add(FStaticMaterial(material, slotNames[slotIndex], slotNames[slotIndex]));
+    }
+
+    staticMesh->RenderData = MoveTemp(renderData);
+    staticMesh->InitResources();
+    staticMesh->CalculateExtendedBounds();
+    return staticMesh;
+}
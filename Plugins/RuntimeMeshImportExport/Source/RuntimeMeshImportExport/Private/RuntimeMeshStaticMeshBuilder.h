@@ -0,0 +1,35 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UStaticMesh;
+class UMaterialInterface;
+class FStaticMeshRenderData;
+struct FRuntimeMeshImportMeshInfo;
+struct FRuntimeMeshImportCompactMeshInfo;
+
+/**
+ *	Builds runtime static meshes in two steps, like FRuntimeMeshTextureBuilder.
+ *	The vertex and index buffers of the render data are filled on any thread,
+ *	the GameThread only creates the UStaticMesh and initializes the render resources.
+ */
+struct FRuntimeMeshStaticMeshBuilder
+{
+    /**
+     * Fills LOD 0 with one section per section of 'meshInfo', followed by the generated LODs of 'meshInfo'. Returns nullptr when the mesh has no triangles.
+     * 'outSlotNames' gets the material name of each section, for the material slots.
+     */
+    static TUniquePtr<FStaticMeshRenderData> BuildRenderData_AnyThread(const FRuntimeMeshImportMeshInfo& meshInfo, TArray<FName>& outSlotNames);
+    // Same from the packed streams of a compact mesh
+    static TUniquePtr<FStaticMeshRenderData> BuildRenderData_AnyThread(const FRuntimeMeshImportCompactMeshInfo& meshInfo, TArray<FName>& outSlotNames);
+
+    /**
+     * Creates a transient static mesh from 'renderData' and starts its upload to the GPU.
+     * @param materials		The material of each slot. Can be shorter than 'slotNames', missing slots get the default material.
+     */
+    static UStaticMesh* CreateStaticMesh_GameThread(TUniquePtr<FStaticMeshRenderData>&& renderData, const TArray<FName>& slotNames, TArrayView<UMaterialInterface* const> materials);
+};
@@ -0,0 +1,995 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshStreamWriter.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "MeshConversionKernels.h"
+#include "HAL/FileManager.h"
+#include "Materials/MaterialInterface.h"
+#include "Misc/Paths.h"
+#include "Hash/CityHash.h"
+
+namespace
+{
+    // Collects small writes and passes them to the file in large blocks
+    class FStreamFile
+    {
+    public:
+        ~FStreamFile()
+        {
+            Close();
+        }
+
+        bool Open(const FString& inFile)
+        {
+            file = inFile;
+            archive.Reset(IFileManager::Get().CreateFileWriter(*file));
+            buffer.Reset(blockSize);
+            return archive.IsValid();
+        }
+
+        void Write(const void* data, const int64 numBytes)
+        {
+            if (buffer.Num() + numBytes > blockSize)
+            {
+                Flush();
+                if (numBytes > blockSize)
+                {
+                    archive->Serialize(const_cast<void*>(data), numBytes);
+                    return;
+                }
+            }
+            buffer.Append(static_cast<const uint8*>(data), numBytes);
+        }
+
+        template<typename T>
+        void Write(const T& value)
+        {
+            Write(&value, sizeof(T));
+        }
+
+        void Printf(const ANSICHAR* format, ...)
+        {
+            ANSICHAR line[512];
+            va_list args;
+            va_start(args, format);
+            const int32 length = FCStringAnsi::GetVarArgs(line, UE_ARRAY_COUNT(line), format, args);
+            va_end(args);
+            if (length > 0)
+            {
+                Write(line, FMath::Min<int32>(length, UE_ARRAY_COUNT(line) - 1));
+            }
+        }
+
+        void WriteText(const FString& text)
+        {
+            FTCHARToUTF8 utf8(*text);
+            Write(utf8.Get(), utf8.Length());
+        }
+
+        // Overwrites already written bytes, e.g. a count in the header
+        void WriteAt(const int64 position, const void* data, const int64 numBytes)
+        {
+            Flush();
+            const int64 end = archive->Tell();
+            archive->Seek(position);
+            archive->Serialize(const_cast<void*>(data), numBytes);
+            archive->Seek(end);
+        }
+
+        // Appends another file in blocks
+        bool AppendFile(const FString& otherFile)
+        {
+            Flush();
+            TUniquePtr<FArchive> reader(IFileManager::Get().CreateFileReader(*otherFile));
+            if (!reader)
+            {
+                return false;
+            }
+            TArray<uint8> block;
+            block.SetNumUninitialized(blockSize);
+            for (int64 remaining = reader->TotalSize(); remaining > 0;)
+            {
+                const int64 numBytes = FMath::Min<int64>(remaining, blockSize);
+                reader->Serialize(block.GetData(), numBytes);
+                archive->Serialize(block.GetData(), numBytes);
+                remaining -= numBytes;
+            }
+            return !reader->IsError();
+        }
+
+        int64 Tell() const
+        {
+            return archive->Tell() + buffer.Num();
+        }
+
+        void Flush()
+        {
+            if (archive && buffer.Num() > 0)
+            {
+                archive->Serialize(buffer.GetData(), buffer.Num());
+                buffer.Reset();
+            }
+        }
+
+        bool Close()
+        {
+            if (!archive)
+            {
+                return true;
+            }
+            Flush();
+            const bool bSuccess = archive->Close() && !archive->IsError();
+            archive.Reset();
+            return bSuccess;
+        }
+
+        const FString& GetFile() const
+        {
+            return file;
+        }
+
+    private:
+        static const int32 blockSize = 1024 * 1024;
+        FString file;
+        TUniquePtr<FArchive> archive;
+        TArray<uint8> buffer;
+    };
+
+    FString GetMaterialName(const UMaterialInterface* material)
+    {
+        // Same as the Assimp export, names with spaces break obj and mtl
+        return (material ? material->GetName() : FString(TEXT("Unknown"))).Replace(TEXT(" "), TEXT("_"));
+    }
+
+    // The face normal with the winding of the section, as the Assimp exporters compute it
+    FVector GetFaceNormal(const FExportableMeshSection& section, const int32 triangleIndex)
+    {
+        const FVector& v0 = section.vertices[section.triangles[triangleIndex * 3]];
+        const FVector& v1 = section.vertices[section.triangles[triangleIndex * 3 + 1]];
+        const FVector& v2 = section.vertices[section.triangles[triangleIndex * 3 + 2]];
+        return FVector::CrossProduct(v1 - v0, v2 - v0).GetSafeNormal();
+    }
+
+    class FObjStreamWriter : public FRuntimeMeshStreamWriter
+    {
+    public:
+        FObjStreamWriter(const bool bInWriteMaterials) : bWriteMaterials(bInWriteMaterials)
+        {}
+
+        virtual bool Begin(const FString& file) override
+        {
+            if (!objFile.Open(file))
+            {
+                error = FString::Printf(TEXT("Could not open %s for writing."), *file);
+                return false;
+            }
+            objFile.Printf("# Exported with RuntimeMeshImportExport\n");
+            if (bWriteMaterials)
+            {
+                mtlFile = FPaths::ChangeExtension(file, TEXT("mtl"));
+                objFile.WriteText(FString::Printf(TEXT("mtllib %s\n"), *FPaths::GetCleanFilename(mtlFile)));
+            }
+            return true;
+        }
+
+        virtual void WriteMesh(const FString& name, TArrayView<const FExportableMeshSection> sections, const int32 parentNode) override
+        {
+            objFile.WriteText(FString::Printf(TEXT("o %s\n"), *name.Replace(TEXT(" "), TEXT("_"))));
+            for (const FExportableMeshSection& section : sections)
+            {
+                if (bWriteMaterials)
+                {
+                    const FString materialName = GetMaterialName(section.material);
+                    materialNames.Add(materialName);
+                    objFile.WriteText(FString::Printf(TEXT("usemtl %s\n"), *materialName));
+                }
+
+                for (const FVector& vertex : section.vertices)
+                {
+                    objFile.Printf("v %.6g %.6g %.6g\n", vertex.X, vertex.Y, vertex.Z);
+                }
+                for (const FVector2D& coord : section.textureCoordinates)
+                {
+                    objFile.Printf("vt %.6g %.6g\n", coord.X, coord.Y);
+                }
+                for (const FVector& normal : section.normals)
+                {
+                    objFile.Printf("vn %.6g %.6g %.6g\n", normal.X, normal.Y, normal.Z);
+                }
+
+                // 1 based and global over the file
+                const int64 offset = numVerticesWritten + 1;
+                for (int32 index = 0; index + 2 < section.triangles.Num(); index += 3)
+                {
+                    const int64 a = section.triangles[index] + offset;
+                    const int64 b = section.triangles[index + 1] + offset;
+                    const int64 c = section.triangles[index + 2] + offset;
+                    objFile.Printf("f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n", a, a, a, b, b, b, c, c, c);
+                }
+                numVerticesWritten += section.vertices.Num();
+            }
+        }
+
+        virtual bool End() override
+        {
+            if (!objFile.Close())
+            {
+                error = FString::Printf(TEXT("Failed to write %s."), *objFile.GetFile());
+                return false;
+            }
+            if (!bWriteMaterials)
+            {
+                return true;
+            }
+
+            FStreamFile materialFile;
+            if (!materialFile.Open(mtlFile))
+            {
+                error = FString::Printf(TEXT("Could not open %s for writing."), *mtlFile);
+                return false;
+            }
+            for (const FString& materialName : materialNames)
+            {
+                materialFile.WriteText(FString::Printf(TEXT("newmtl %s\n"), *materialName));
+                materialFile.Printf("Kd 0.8 0.8 0.8\n\n");
+            }
+            return materialFile.Close();
+        }
+
+    private:
+        const bool bWriteMaterials;
+        FStreamFile objFile;
+        FString mtlFile;
+        TSet<FString> materialNames;
+        int64 numVerticesWritten = 0;
+    };
+
+    class FStlStreamWriter : public FRuntimeMeshStreamWriter
+    {
+    public:
+        FStlStreamWriter(const bool bInBinary) : bBinary(bInBinary)
+        {}
+
+        virtual bool Begin(const FString& file) override
+        {
+            if (!stlFile.Open(file))
+            {
+                error = FString::Printf(TEXT("Could not open %s for writing."), *file);
+                return false;
+            }
+            if (bBinary)
+            {
+                // 80 byte header and the number of triangles, which is patched in End
+                ANSICHAR header[80] = {};
+                FCStringAnsi::Strncpy(header, "Exported with RuntimeMeshImportExport", UE_ARRAY_COUNT(header));
+                stlFile.Write(header, sizeof(header));
+                stlFile.Write(uint32(0));
+            }
+            else
+            {
+                stlFile.Printf("solid Scene\n");
+            }
+            return true;
+        }
+
+        virtual void WriteMesh(const FString& name, TArrayView<const FExportableMeshSection> sections, const int32 parentNode) override
+        {
+            for (const FExportableMeshSection& section : sections)
+            {
+                const int32 numTriangles = section.triangles.Num() / 3;
+                for (int32 triangleIndex = 0; triangleIndex < numTriangles; ++triangleIndex)
+                {
+                    const FVector normal = GetFaceNormal(section, triangleIndex);
+                    const FVector& v0 = section.vertices[section.triangles[triangleIndex * 3]];
+                    const FVector& v1 = section.vertices[section.triangles[triangleIndex * 3 + 1]];
+                    const FVector& v2 = section.vertices[section.triangles[triangleIndex * 3 + 2]];
+                    if (bBinary)
+                    {
+                        stlFile.Write(normal);
+                        stlFile.Write(v0);
+                        stlFile.Write(v1);
+                        stlFile.Write(v2);
+                        stlFile.Write(uint16(0));
+                    }
+                    else
+                    {
+                        stlFile.Printf(" facet normal %.6g %.6g %.6g\n  outer loop\n", normal.X, normal.Y, normal.Z);
+                        stlFile.Printf("   vertex %.6g %.6g %.6g\n", v0.X, v0.Y, v0.Z);
+                        stlFile.Printf("   vertex %.6g %.6g %.6g\n", v1.X, v1.Y, v1.Z);
+                        stlFile.Printf("   vertex %.6g %.6g %.6g\n", v2.X, v2.Y, v2.Z);
+                        stlFile.Printf("  endloop\n endfacet\n");
+                    }
+                }
+                numTrianglesWritten += numTriangles;
+            }
+        }
+
+        virtual bool End() override
+        {
+            if (bBinary)
+            {
+                const uint32 numTriangles = uint32(numTrianglesWritten);
+                stlFile.WriteAt(80, &numTriangles, sizeof(numTriangles));
+            }
+            else
+            {
+                stlFile.Printf("endsolid Scene\n");
+            }
+            if (!stlFile.Close())
+            {
+                error = FString::Printf(TEXT("Failed to write %s."), *stlFile.GetFile());
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        const bool bBinary;
+        FStreamFile stlFile;
+        int64 numTrianglesWritten = 0;
+    };
+
+    // Binary little endian. The faces go to a temporary file, since they have to follow all vertices.
+    class FPlyStreamWriter : public FRuntimeMeshStreamWriter
+    {
+    public:
+        virtual bool Begin(const FString& file) override
+        {
+            faceFile = file + TEXT(".faces.tmp");
+            if (!plyFile.Open(file) || !facesFile.Open(faceFile))
+            {
+                error = FString::Printf(TEXT("Could not open %s for writing."), *file);
+                return false;
+            }
+            WriteHeader();
+            return true;
+        }
+
+        virtual void WriteMesh(const FString& name, TArrayView<const FExportableMeshSection> sections, const int32 parentNode) override
+        {
+            for (const FExportableMeshSection& section : sections)
+            {
+                for (int32 vertexIndex = 0; vertexIndex < section.vertices.Num(); ++vertexIndex)
+                {
+                    const FColor& color = section.vertexColors[vertexIndex];
+                    plyFile.Write(section.vertices[vertexIndex]);
+                    plyFile.Write(section.normals[vertexIndex]);
+                    plyFile.Write(section.textureCoordinates[vertexIndex]);
+                    const uint8 rgba[4] = { color.R, color.G, color.B, color.A };
+                    plyFile.Write(rgba, sizeof(rgba));
+                }
+
+                const int32 offset = int32(numVerticesWritten);
+                for (int32 index = 0; index + 2 < section.triangles.Num(); index += 3)
+                {
+                    const uint8 numCorners = 3;
+                    const int32 face[3] = { section.triangles[index] + offset, section.triangles[index + 1] + offset, section.triangles[index + 2] + offset };
+                    facesFile.Write(numCorners);
+                    facesFile.Write(face, sizeof(face));
+                }
+                numVerticesWritten += section.vertices.Num();
+                numFacesWritten += section.triangles.Num() / 3;
+            }
+        }
+
+        virtual bool End() override
+        {
+            const bool bFacesWritten = facesFile.Close();
+            const bool bSuccess = bFacesWritten && plyFile.AppendFile(faceFile);
+            IFileManager::Get().Delete(*faceFile, false, true, true);
+            if (bSuccess)
+            {
+                // Same length as the first one, the counts have a fixed width
+                WriteHeader();
+            }
+            if (!plyFile.Close() || !bSuccess)
+            {
+                error = FString::Printf(TEXT("Failed to write %s."), *plyFile.GetFile());
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        void WriteHeader()
+        {
+            const FTCHARToUTF8 header(*FString::Printf(TEXT("ply\nformat binary_little_endian 1.0\ncomment Exported with RuntimeMeshImportExport\n"
+                "element vertex %010lld\nproperty float x\nproperty float y\nproperty float z\n"
+                "property float nx\nproperty float ny\nproperty float nz\nproperty float s\nproperty float t\n"
+                "property uchar red\nproperty uchar green\nproperty uchar blue\nproperty uchar alpha\n"
+                "element face %010lld\nproperty list uchar int vertex_indices\nend_header\n"), numVerticesWritten, numFacesWritten));
+            if (plyFile.Tell() == 0)
+            {
+                plyFile.Write(header.Get(), header.Length());
+            }
+            else
+            {
+                plyFile.WriteAt(0, header.Get(), header.Length());
+            }
+        }
+
+        FStreamFile plyFile;
+        FStreamFile facesFile;
+        FString faceFile;
+        int64 numVerticesWritten = 0;
+        int64 numFacesWritten = 0;
+    };
+
+    /**
+     *	glTF 2.0 with an external .bin, or glb. The binary data is streamed, only the json is kept until End.
+     *	A glb needs the json before the binary chunk, so the binary data goes to a temporary file that is appended in End.
+     *	The streams of the sections are copied as they are, or quantized with KHR_mesh_quantization.
+     *	Streams with the same content, e.g. the indices of meshes with the same topology, share one buffer view.
+     */
+    class FGltfStreamWriter : public FRuntimeMeshStreamWriter
+    {
+    public:
+        FGltfStreamWriter(const bool bInBinary, const FRuntimeMeshExportParam& param)
+            : bBinary(bInBinary), bQuantize(param.bQuantizeGltf)
+            , bQuantizeNormals(param.bQuantizeGltf && param.bQuantizeGltfNormals), bQuantizeTexCoords(param.bQuantizeGltf && param.bQuantizeGltfTexCoords)
+            , bGpuInstancing(param.bGltfGpuInstancing), bSRGBColors(param.vertexColorSpace == ERuntimeMeshVertexColorSpace::SRGB)
+        {}
+
+        virtual bool KeepsHierarchy() const override
+        {
+            return true;
+        }
+
+        virtual bool Begin(const FString& file) override
+        {
+            gltfFile = file;
+            binFile = bBinary ? file + TEXT(".bin.tmp") : FPaths::ChangeExtension(file, TEXT("bin"));
+            if (!bin.Open(binFile))
+            {
+                error = FString::Printf(TEXT("Could not open %s for writing."), *binFile);
+                return false;
+            }
+            return true;
+        }
+
+        virtual int32 AddNode(const FString& name, const int32 parentNode, const FMatrix& localToParent) override
+        {
+            return AddNodeJson(FString::Printf(TEXT("\"name\":\"%s\",\"matrix\":%s"), *name.ReplaceCharWithEscapedChar(), *MatrixToJson(localToParent)), parentNode);
+        }
+
+        virtual void WriteMesh(const FString& name, TArrayView<const FExportableMeshSection> sections, const int32 parentNode) override
+        {
+            FMatrix quantizationMatrix;
+            const int32 meshIndex = AddMesh(name, sections, bQuantize, quantizationMatrix);
+            if (meshIndex == INDEX_NONE)
+            {
+                return;
+            }
+            FString node = FString::Printf(TEXT("\"name\":\"%s\",\"mesh\":%d"), *name.ReplaceCharWithEscapedChar(), meshIndex);
+            if (bQuantize)
+            {
+                node += TEXT(",\"matrix\":") + MatrixToJson(quantizationMatrix);
+            }
+            AddNodeJson(node, parentNode);
+        }
+
+        virtual bool WritesLods() const override
+        {
+            return true;
+        }
+
+        virtual void WriteMeshWithLods(const FString& name, TArrayView<const FExportableMeshSection> sections, TArrayView<const TArrayView<const FExportableMeshSection>> lodSections, const int32 parentNode) override
+        {
+            FMatrix quantizationMatrix;
+            const int32 meshIndex = AddMesh(name, sections, bQuantize, quantizationMatrix);
+            if (meshIndex == INDEX_NONE)
+            {
+                return;
+            }
+            const FString escapedName = name.ReplaceCharWithEscapedChar();
+            // The LOD nodes are only referenced by the node of the first LOD, each with its own quantization range
+            TArray<FString> lodNodes;
+            for (int32 lodIndex = 0; lodIndex < lodSections.Num(); ++lodIndex)
+            {
+                FMatrix lodQuantizationMatrix;
+                const int32 lodMesh = AddMesh(FString::Printf(TEXT("%s_LOD%d"), *name, lodIndex + 1), lodSections[lodIndex], bQuantize, lodQuantizationMatrix);
+                if (lodMesh != INDEX_NONE)
+                {
+                    FString lodNode = FString::Printf(TEXT("\"name\":\"%s_LOD%d\",\"mesh\":%d"), *escapedName, lodIndex + 1, lodMesh);
+                    if (bQuantize)
+                    {
+                        lodNode += TEXT(",\"matrix\":") + MatrixToJson(lodQuantizationMatrix);
+                    }
+                    lodNodes.Add(FString::FromInt(AddNodeJson(lodNode, INDEX_NONE, true)));
+                }
+            }
+            FString node = FString::Printf(TEXT("\"name\":\"%s\",\"mesh\":%d"), *escapedName, meshIndex);
+            if (bQuantize)
+            {
+                node += TEXT(",\"matrix\":") + MatrixToJson(quantizationMatrix);
+            }
+            if (lodNodes.Num() > 0)
+            {
+                node += FString::Printf(TEXT(",\"extensions\":{\"MSFT_lod\":{\"ids\":[%s]}}"), *FString::Join(lodNodes, TEXT(",")));
+                bLodsUsed = true;
+            }
+            AddNodeJson(node, parentNode);
+        }
+
+        virtual void WriteInstancedMesh(const FString& name, TArrayView<const FExportableMeshSection> sections, TArrayView<const FMatrix> instanceToSpace, const int32 parentNode) override
+        {
+            const FString escapedName = name.ReplaceCharWithEscapedChar();
+            if (!bGpuInstancing || instanceToSpace.Num() < 2)
+            {
+                // A node per instance, all of them reference the one mesh
+                FMatrix quantizationMatrix;
+                const int32 meshIndex = AddMesh(name, sections, bQuantize, quantizationMatrix);
+                for (int32 instanceIndex = 0; instanceIndex < instanceToSpace.Num() && meshIndex != INDEX_NONE; ++instanceIndex)
+                {
+                    AddNodeJson(FString::Printf(TEXT("\"name\":\"%s_%d\",\"mesh\":%d,\"matrix\":%s"), *escapedName, instanceIndex, meshIndex
+                        , *MatrixToJson(quantizationMatrix * instanceToSpace[instanceIndex])), parentNode);
+                }
+                return;
+            }
+
+            // The instance transforms are applied before the matrix of the node, which leaves no place to scale quantized positions back
+            FMatrix quantizationMatrix;
+            const int32 meshIndex = AddMesh(name, sections, false, quantizationMatrix);
+            if (meshIndex == INDEX_NONE)
+            {
+                return;
+            }
+            const int32 numInstances = instanceToSpace.Num();
+            TArray<FVector> translations;
+            TArray<FQuat> rotations;
+            TArray<FVector> scales;
+            translations.SetNumUninitialized(numInstances);
+            rotations.SetNumUninitialized(numInstances);
+            scales.SetNumUninitialized(numInstances);
+            for (int32 instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex)
+            {
+                // The same matrix layout as glTF, so the rotation is the same quaternion
+                const FTransform transform(instanceToSpace[instanceIndex]);
+                translations[instanceIndex] = transform.GetTranslation();
+                rotations[instanceIndex] = transform.GetRotation();
+                scales[instanceIndex] = transform.GetScale3D();
+            }
+            const int32 translationAccessor = AddAccessor(WriteView(translations.GetData(), numInstances * sizeof(FVector), 0), numInstances, 5126, TEXT("VEC3"));
+            const int32 rotationAccessor = AddAccessor(WriteView(rotations.GetData(), numInstances * sizeof(FQuat), 0), numInstances, 5126, TEXT("VEC4"));
+            const int32 scaleAccessor = AddAccessor(WriteView(scales.GetData(), numInstances * sizeof(FVector), 0), numInstances, 5126, TEXT("VEC3"));
+            AddNodeJson(FString::Printf(TEXT("\"name\":\"%s\",\"mesh\":%d,\"extensions\":{\"EXT_mesh_gpu_instancing\":{\"attributes\":{\"TRANSLATION\":%d,\"ROTATION\":%d,\"SCALE\":%d}}}")
+                , *escapedName, meshIndex, translationAccessor, rotationAccessor, scaleAccessor), parentNode);
+            bGpuInstancingUsed = true;
+        }
+
+        virtual bool End() override
+        {
+            const int64 binLength = bin.Tell();
+            if (!bin.Close())
+            {
+                error = FString::Printf(TEXT("Failed to write %s."), *binFile);
+                return false;
+            }
+
+            // The nodes get their children only now, they are added before them
+            TArray<FString> nodeJson;
+            TArray<FString> rootNodes;
+            for (int32 nodeIndex = 0; nodeIndex < nodes.Num(); ++nodeIndex)
+            {
+                const FNode& node = nodes[nodeIndex];
+                nodeJson.Add(node.children.Num() > 0 ? FString::Printf(TEXT("{%s,\"children\":[%s]}"), *node.json, *FString::Join(node.children, TEXT(","))) : TEXT("{") + node.json + TEXT("}"));
+                if (node.parent == INDEX_NONE && !node.bDetached)
+                {
+                    rootNodes.Add(FString::FromInt(nodeIndex));
+                }
+            }
+
+            const FString buffer = bBinary ? FString::Printf(TEXT("{\"byteLength\":%lld}"), binLength)
+                : FString::Printf(TEXT("{\"uri\":\"%s\",\"byteLength\":%lld}"), *FPaths::GetCleanFilename(binFile), binLength);
+            // Viewers without EXT_mesh_gpu_instancing still show one instance and the ones without MSFT_lod the first LOD, so they are not required
+            TArray<FString> extensionsUsed;
+            if (bQuantize)
+            {
+                extensionsUsed.Add(TEXT("\"KHR_mesh_quantization\""));
+            }
+            if (bGpuInstancingUsed)
+            {
+                extensionsUsed.Add(TEXT("\"EXT_mesh_gpu_instancing\""));
+            }
+            if (bLodsUsed)
+            {
+                extensionsUsed.Add(TEXT("\"MSFT_lod\""));
+            }
+            FString extensions = extensionsUsed.Num() > 0 ? FString::Printf(TEXT(",\"extensionsUsed\":[%s]"), *FString::Join(extensionsUsed, TEXT(","))) : FString();
+            if (bQuantize)
+            {
+                extensions += TEXT(",\"extensionsRequired\":[\"KHR_mesh_quantization\"]");
+            }
+            FString json = FString::Printf(TEXT("{\"asset\":{\"version\":\"2.0\",\"generator\":\"RuntimeMeshImportExport\"}%s,\"scene\":0,\"scenes\":[{\"nodes\":[%s]}]"
+                ",\"nodes\":[%s],\"meshes\":[%s],\"materials\":[%s],\"accessors\":[%s],\"bufferViews\":[%s],\"buffers\":[%s]}")
+                , *extensions, *FString::Join(rootNodes, TEXT(",")), *FString::Join(nodeJson, TEXT(",")), *FString::Join(meshes, TEXT(",")), *FString::Join(materials, TEXT(","))
+                , *FString::Join(accessors, TEXT(",")), *FString::Join(bufferViews, TEXT(",")), *buffer);
+
+            FStreamFile outFile;
+            if (!outFile.Open(gltfFile))
+            {
+                error = FString::Printf(TEXT("Could not open %s for writing."), *gltfFile);
+                return false;
+            }
+            if (!bBinary)
+            {
+                outFile.WriteText(json);
+                return outFile.Close();
+            }
+
+            // Both chunks are padded to 4 bytes, the json with spaces
+            FTCHARToUTF8 jsonUtf8(*json);
+            const uint32 jsonLength = Align(jsonUtf8.Length(), 4);
+            const uint32 binChunkLength = Align(binLength, 4);
+            const uint32 header[3] = { 0x46546C67, 2, 12 + 8 + jsonLength + 8 + binChunkLength };
+            const uint32 jsonChunk[2] = { jsonLength, 0x4E4F534A };
+            const uint32 binChunk[2] = { binChunkLength, 0x004E4942 };
+            outFile.Write(header, sizeof(header));
+            outFile.Write(jsonChunk, sizeof(jsonChunk));
+            outFile.Write(jsonUtf8.Get(), jsonUtf8.Length());
+            const ANSICHAR spaces[3] = { ' ', ' ', ' ' };
+            outFile.Write(spaces, jsonLength - jsonUtf8.Length());
+            outFile.Write(binChunk, sizeof(binChunk));
+            const bool bAppended = outFile.AppendFile(binFile);
+            IFileManager::Get().Delete(*binFile, false, true, true);
+            // The views are already 4 byte aligned, the padding is only for safety
+            const uint8 zeros[3] = {};
+            outFile.Write(zeros, binChunkLength - binLength);
+            if (!outFile.Close() || !bAppended)
+            {
+                error = FString::Printf(TEXT("Failed to write %s."), *gltfFile);
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        struct FNode
+        {
+            FString json;
+            int32 parent = INDEX_NONE;
+            TArray<FString> children;
+            // Not a node of the scene, only referenced by an extension of another node
+            bool bDetached = false;
+        };
+
+        int32 AddNodeJson(const FString& json, const int32 parentNode, const bool bDetached = false)
+        {
+            const int32 nodeIndex = nodes.Num();
+            FNode& node = nodes.AddDefaulted_GetRef();
+            node.json = json;
+            node.parent = parentNode;
+            node.bDetached = bDetached;
+            if (nodes.IsValidIndex(parentNode))
+            {
+                nodes[parentNode].children.Add(FString::FromInt(nodeIndex));
+            }
+            return nodeIndex;
+        }
+
+        /**
+         * Adds a mesh with a primitive per section and returns its index, INDEX_NONE when no section has triangles.
+         * Quantized positions share one range per mesh, 'outQuantizationMatrix' scales them back. Identity without 'bQuantizePositions'.
+         */
+        int32 AddMesh(const FString& name, TArrayView<const FExportableMeshSection> sections, const bool bQuantizePositions, FMatrix& outQuantizationMatrix)
+        {
+            outQuantizationMatrix = FMatrix::Identity;
+            FBox bounds(ForceInit);
+            for (const FExportableMeshSection& section : sections)
+            {
+                bounds += FMeshConversionKernels::ComputeBounds(section.vertices.GetData(), section.vertices.Num());
+            }
+            if (!bounds.IsValid)
+            {
+                return INDEX_NONE;
+            }
+            const FVector quantizationScale = (bounds.Max - bounds.Min).ComponentMax(FVector(KINDA_SMALL_NUMBER)) / 65535.f;
+
+            FString primitives;
+            for (const FExportableMeshSection& section : sections)
+            {
+                if (section.vertices.Num() > 0 && section.triangles.Num() > 0)
+                {
+                    primitives += (primitives.IsEmpty() ? TEXT("") : TEXT(",")) + WritePrimitive(section, bQuantizePositions, bounds.Min, quantizationScale);
+                }
+            }
+            if (primitives.IsEmpty())
+            {
+                return INDEX_NONE;
+            }
+            if (bQuantizePositions)
+            {
+                outQuantizationMatrix = FScaleMatrix(quantizationScale) * FTranslationMatrix(bounds.Min);
+            }
+            return meshes.Add(FString::Printf(TEXT("{\"name\":\"%s\",\"primitives\":[%s]}"), *name.ReplaceCharWithEscapedChar(), *primitives));
+        }
+
+        // FMatrix is row major for row vectors, which is the same memory layout as the column major glTF matrix
+        static FString MatrixToJson(const FMatrix& matrix)
+        {
+            TArray<FString> values;
+            for (int32 row = 0; row < 4; ++row)
+            {
+                for (int32 column = 0; column < 4; ++column)
+                {
+                    values.Add(FString::Printf(TEXT("%.9g"), matrix.M[row][column]));
+                }
+            }
+            return TEXT("[") + FString::Join(values, TEXT(",")) + TEXT("]");
+        }
+
+        FString WritePrimitive(const FExportableMeshSection& section, const bool bQuantizePositions, const FVector& quantizationOffset, const FVector& quantizationScale)
+        {
+            const int32 numVertices = section.vertices.Num();
+            int32 positionAccessor, normalAccessor, coordAccessor;
+            if (bQuantizePositions)
+            {
+                // Unsigned shorts over the bounds of the mesh, padded to 8 bytes per vertex for the alignment
+                TArray<uint16> positions;
+                positions.SetNumZeroed(numVertices * 4);
+                FIntVector quantizedMin(MAX_int32), quantizedMax(MIN_int32);
+                for (int32 index = 0; index < numVertices; ++index)
+                {
+                    const FVector quantized = (section.vertices[index] - quantizationOffset) / quantizationScale;
+                    for (int32 axis = 0; axis < 3; ++axis)
+                    {
+                        const int32 value = FMath::Clamp(FMath::RoundToInt(quantized[axis]), 0, 65535);
+                        positions[index * 4 + axis] = uint16(value);
+                        quantizedMin[axis] = FMath::Min(quantizedMin[axis], value);
+                        quantizedMax[axis] = FMath::Max(quantizedMax[axis], value);
+                    }
+                }
+                positionAccessor = AddAccessor(WriteView(positions.GetData(), positions.Num() * sizeof(uint16), 34962, 8), numVertices, 5123, TEXT("VEC3")
+                    , FString::Printf(TEXT(",\"min\":[%d,%d,%d],\"max\":[%d,%d,%d]"), quantizedMin.X, quantizedMin.Y, quantizedMin.Z, quantizedMax.X, quantizedMax.Y, quantizedMax.Z));
+            }
+            else
+            {
+                const FBox bounds = FMeshConversionKernels::ComputeBounds(section.vertices.GetData(), numVertices);
+                positionAccessor = AddAccessor(WriteView(section.vertices.GetData(), numVertices * sizeof(FVector), 34962), numVertices, 5126, TEXT("VEC3")
+                    , FString::Printf(TEXT(",\"min\":[%.9g,%.9g,%.9g],\"max\":[%.9g,%.9g,%.9g]"), bounds.Min.X, bounds.Min.Y, bounds.Min.Z, bounds.Max.X, bounds.Max.Y, bounds.Max.Z));
+            }
+
+            if (bQuantizeNormals)
+            {
+                // Normalized bytes, padded to 4 bytes per vertex
+                TArray<int8> normals;
+                normals.SetNumZeroed(numVertices * 4);
+                for (int32 index = 0; index < numVertices; ++index)
+                {
+                    const FVector normal = section.normals[index].GetSafeNormal();
+                    for (int32 axis = 0; axis < 3; ++axis)
+                    {
+                        normals[index * 4 + axis] = int8(FMath::Clamp(FMath::RoundToInt(normal[axis] * 127.f), -127, 127));
+                    }
+                }
+                normalAccessor = AddAccessor(WriteView(normals.GetData(), normals.Num(), 34962, 4), numVertices, 5120, TEXT("VEC3"), TEXT(",\"normalized\":true"));
+            }
+            else
+            {
+                normalAccessor = AddAccessor(WriteView(section.normals.GetData(), numVertices * sizeof(FVector), 34962), numVertices, 5126, TEXT("VEC3"));
+            }
+
+            // Flipped like the glTF exporter of Assimp does. Normalized shorts only fit when all coordinates are within 0 to 1.
+            bool bCoordsNormalized = bQuantizeTexCoords;
+            TArray<FVector2D> coords;
+            coords.SetNumUninitialized(numVertices);
+            for (int32 index = 0; index < numVertices; ++index)
+            {
+                coords[index] = FVector2D(section.textureCoordinates[index].X, 1.f - section.textureCoordinates[index].Y);
+                bCoordsNormalized &= coords[index].X >= 0.f && coords[index].X <= 1.f && coords[index].Y >= 0.f && coords[index].Y <= 1.f;
+            }
+            if (bCoordsNormalized)
+            {
+                TArray<uint16> quantizedCoords;
+                quantizedCoords.SetNumUninitialized(numVertices * 2);
+                for (int32 index = 0; index < numVertices; ++index)
+                {
+                    quantizedCoords[index * 2] = uint16(FMath::RoundToInt(coords[index].X * 65535.f));
+                    quantizedCoords[index * 2 + 1] = uint16(FMath::RoundToInt(coords[index].Y * 65535.f));
+                }
+                coordAccessor = AddAccessor(WriteView(quantizedCoords.GetData(), quantizedCoords.Num() * sizeof(uint16), 34962), numVertices, 5123, TEXT("VEC2"), TEXT(",\"normalized\":true"));
+            }
+            else
+            {
+                coordAccessor = AddAccessor(WriteView(coords.GetData(), numVertices * sizeof(FVector2D), 34962), numVertices, 5126, TEXT("VEC2"));
+            }
+
+            // FColor is BGRA. The placeholders of a mesh without colors are not written, the viewers use white then.
+            FString colorAttribute;
+            const bool bHasColors = !FMeshConversionKernels::HasOnlyDefaultColors(section.vertexColors.GetData(), section.vertexColors.Num());
+            if (bHasColors && bSRGBColors)
+            {
+                // Decoded to floats, 8 bit linear colors would band in the dark
+                TArray<FLinearColor> colors;
+                colors.SetNumUninitialized(numVertices);
+                FMeshConversionKernels::SRGBColorsToLinear(section.vertexColors.GetData(), colors.GetData(), numVertices);
+                const int32 colorAccessor = AddAccessor(WriteView(colors.GetData(), numVertices * sizeof(FLinearColor), 34962), numVertices, 5126, TEXT("VEC4"));
+                colorAttribute = FString::Printf(TEXT(",\"COLOR_0\":%d"), colorAccessor);
+            }
+            else if (bHasColors)
+            {
+                TArray<uint8> colors;
+                colors.SetNumUninitialized(numVertices * 4);
+                for (int32 index = 0; index < numVertices; ++index)
+                {
+                    const FColor& color = section.vertexColors[index];
+                    colors[index * 4] = color.R;
+                    colors[index * 4 + 1] = color.G;
+                    colors[index * 4 + 2] = color.B;
+                    colors[index * 4 + 3] = color.A;
+                }
+                const int32 colorAccessor = AddAccessor(WriteView(colors.GetData(), colors.Num(), 34962), numVertices, 5121, TEXT("VEC4"), TEXT(",\"normalized\":true"));
+                colorAttribute = FString::Printf(TEXT(",\"COLOR_0\":%d"), colorAccessor);
+            }
+
+            // The smallest index type that fits
+            int32 indexAccessor;
+            if (numVertices <= 65535)
+            {
+                TArray<uint16> indices;
+                indices.SetNumUninitialized(section.triangles.Num());
+                for (int32 index = 0; index < section.triangles.Num(); ++index)
+                {
+                    indices[index] = uint16(section.triangles[index]);
+                }
+                indexAccessor = AddAccessor(WriteView(indices.GetData(), indices.Num() * sizeof(uint16), 34963), indices.Num(), 5123, TEXT("SCALAR"));
+            }
+            else
+            {
+                indexAccessor = AddAccessor(WriteView(section.triangles.GetData(), section.triangles.Num() * sizeof(int32), 34963), section.triangles.Num(), 5125, TEXT("SCALAR"));
+            }
+
+            return FString::Printf(TEXT("{\"attributes\":{\"POSITION\":%d,\"NORMAL\":%d,\"TEXCOORD_0\":%d%s},\"indices\":%d,\"material\":%d,\"mode\":4}")
+                , positionAccessor, normalAccessor, coordAccessor, *colorAttribute, indexAccessor, GetMaterialIndex(section.material));
+        }
+
+        // The same parameters the Assimp export reads, without the textures
+        int32 GetMaterialIndex(UMaterialInterface* material)
+        {
+            if (const int32* found = materialIndices.Find(material))
+            {
+                return *found;
+            }
+
+            FString pbr;
+            if (material)
+            {
+                FHashedMaterialParameterInfo paramInfo;
+                FLinearColor baseColor;
+                float value = 0.f;
+                paramInfo.Name = FName("BaseColor");
+                if (material->GetVectorParameterValue(paramInfo, baseColor))
+                {
+                    pbr += FString::Printf(TEXT(",\"baseColorFactor\":[%.6g,%.6g,%.6g,%.6g]"), baseColor.R, baseColor.G, baseColor.B, baseColor.A);
+                }
+                paramInfo.Name = FName("Metallic_strength");
+                if (material->GetScalarParameterValue(paramInfo, value))
+                {
+                    pbr += FString::Printf(TEXT(",\"metallicFactor\":%.6g"), FMath::Clamp(value, 0.f, 1.f));
+                }
+                paramInfo.Name = FName("Roughness_strength");
+                if (material->GetScalarParameterValue(paramInfo, value))
+                {
+                    pbr += FString::Printf(TEXT(",\"roughnessFactor\":%.6g"), FMath::Clamp(value, 0.f, 1.f));
+                }
+            }
+            const FString name = GetMaterialName(material).ReplaceCharWithEscapedChar();
+            const int32 materialIndex = materials.Add(pbr.IsEmpty() ? FString::Printf(TEXT("{\"name\":\"%s\",\"doubleSided\":true}"), *name)
+                : FString::Printf(TEXT("{\"name\":\"%s\",\"doubleSided\":true,\"pbrMetallicRoughness\":{%s}}"), *name, *pbr.RightChop(1)));
+            materialIndices.Add(material, materialIndex);
+            return materialIndex;
+        }
+
+        // Writes the data 4 byte aligned and returns the index of its buffer view. Data that was written before is not written again.
+        // 'target' 0 is data that is no vertex attribute or index, e.g. of the instances.
+        int32 WriteView(const void* data, const int64 numBytes, const int32 target, const int32 byteStride = 0)
+        {
+            const FViewKey key(CityHash64(static_cast<const char*>(data), uint32(numBytes)), numBytes, target, byteStride);
+            if (const int32* foundView = viewsByContent.Find(key))
+            {
+                return *foundView;
+            }
+
+            const int64 offset = bin.Tell();
+            bin.Write(data, numBytes);
+            const uint8 padding[3] = {};
+            bin.Write(padding, Align(numBytes, 4) - numBytes);
+            const FString stride = byteStride > 0 ? FString::Printf(TEXT(",\"byteStride\":%d"), byteStride) : FString();
+            const FString targetJson = target > 0 ? FString::Printf(TEXT(",\"target\":%d"), target) : FString();
+            const int32 viewIndex = bufferViews.Add(FString::Printf(TEXT("{\"buffer\":0,\"byteOffset\":%lld,\"byteLength\":%lld%s%s}"), offset, numBytes, *stride, *targetJson));
+            viewsByContent.Add(key, viewIndex);
+            return viewIndex;
+        }
+
+        // Equal accessors of shared views are shared as well
+        int32 AddAccessor(const int32 bufferView, const int32 count, const int32 componentType, const TCHAR* type, const FString& extra = FString())
+        {
+            FString accessor = FString::Printf(TEXT("{\"bufferView\":%d,\"componentType\":%d,\"count\":%d,\"type\":\"%s\"%s}"), bufferView, componentType, count, type, *extra);
+            if (const int32* foundAccessor = accessorIndices.Find(accessor))
+            {
+                return *foundAccessor;
+            }
+            const int32 accessorIndex = accessors.Add(accessor);
+            accessorIndices.Add(MoveTemp(accessor), accessorIndex);
+            return accessorIndex;
+        }
+
+        const bool bBinary;
+        const bool bQuantize;
+        const bool bQuantizeNormals;
+        const bool bQuantizeTexCoords;
+        const bool bGpuInstancing;
+        // @see FRuntimeMeshExportParam::vertexColorSpace
+        const bool bSRGBColors;
+        bool bGpuInstancingUsed = false;
+        bool bLodsUsed = false;
+        FString gltfFile;
+        FString binFile;
+        FStreamFile bin;
+        TArray<FString> bufferViews;
+        // Hash, length, target and stride of the written views
+        using FViewKey = TTuple<uint64, int64, int32, int32>;
+        TMap<FViewKey, int32> viewsByContent;
+        TArray<FString> accessors;
+        TMap<FString, int32> accessorIndices;
+        TArray<FString> meshes;
+        TArray<FNode> nodes;
+        TMap<const UMaterialInterface*, int32> materialIndices;
+        TArray<FString> materials;
+    };
+}
+
+TUniquePtr<FRuntimeMeshStreamWriter> FRuntimeMeshStreamWriter::Create(const FRuntimeMeshExportParam& param)
+{
+    const FString& formatId = param.formatId;
+    if (formatId == TEXT("obj") || formatId == TEXT("objnomtl"))
+    {
+        return MakeUnique<FObjStreamWriter>(formatId == TEXT("obj"));
+    }
+    if (formatId == TEXT("stl") || formatId == TEXT("stlb"))
+    {
+        return MakeUnique<FStlStreamWriter>(formatId == TEXT("stlb"));
+    }
+    if (formatId == TEXT("plyb"))
+    {
+        return MakeUnique<FPlyStreamWriter>();
+    }
+    if (IsGltf(formatId))
+    {
+        return MakeUnique<FGltfStreamWriter>(formatId == TEXT("glb2"), param);
+    }
+    return nullptr;
+}
+
+bool FRuntimeMeshStreamWriter::IsSupported(const FString& formatId)
+{
+    return formatId == TEXT("obj") || formatId == TEXT("objnomtl") || formatId == TEXT("stl") || formatId == TEXT("stlb")
+        || formatId == TEXT("plyb") || IsGltf(formatId);
+}
+
+void FRuntimeMeshStreamWriter::WriteInstancedMesh(const FString& name, TArrayView<const FExportableMeshSection> sections, TArrayView<const FMatrix> instanceToSpace
+    , const int32 parentNode)
+{
+    TArray<FExportableMeshSection> instanceSections;
+    for (int32 instanceIndex = 0; instanceIndex < instanceToSpace.Num(); ++instanceIndex)
+    {
+        const FMatrix& matrix = instanceToSpace[instanceIndex];
+        instanceSections = TArray<FExportableMeshSection>(sections.GetData(), sections.Num());
+        for (FExportableMeshSection& section : instanceSections)
+        {
+            const int32 numVertices = section.vertices.Num();
+            FMeshConversionKernels::TransformPositions(matrix, section.vertices.GetData(), section.vertices.GetData(), numVertices);
+            FMeshConversionKernels::TransformDirections(matrix, section.normals.GetData(), section.normals.GetData(), numVertices, true);
+            FMeshConversionKernels::TransformDirections(matrix, section.tangents.GetData(), section.tangents.GetData(), numVertices, true);
+        }
+        WriteMesh(FString::Printf(TEXT("%s_%d"), *name, instanceIndex), instanceSections, parentNode);
+    }
+}
+
+bool FRuntimeMeshStreamWriter::IsGltf(const FString& formatId)
+{
+    return formatId == TEXT("gltf2") || formatId == TEXT("glb2");
+}
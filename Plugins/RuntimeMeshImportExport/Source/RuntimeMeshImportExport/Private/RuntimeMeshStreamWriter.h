@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FExportableMeshSection;
+struct FRuntimeMeshExportParam;
+
+/**
+ *	Writes an export incrementally without building the Assimp scene, one exportable at a time.
+ *	Only the formats that can be appended to are supported: obj, objnomtl, stl, stlb, plyb, gltf2 with an external .bin and glb2.
+ *	Counts, headers and the glTF json are patched or written in End, everything else goes to disk right away.
+ *	glTF is also the native glTF export, it keeps the node hierarchy and can quantize the streams with KHR_mesh_quantization.
+ *	glTF writes additional LODs as MSFT_lod alternatives of the node, the other formats write a file per LOD.
+ *	The format ids are the ones of Assimp, @see URuntimeMeshImportExportLibrary::GetSupportedExtensionsExport.
+ */
+class FRuntimeMeshStreamWriter
+{
+public:
+    virtual ~FRuntimeMeshStreamWriter() {}
+
+    // Null when 'param.formatId' can not be streamed
+    static TUniquePtr<FRuntimeMeshStreamWriter> Create(const FRuntimeMeshExportParam& param);
+    static bool IsSupported(const FString& formatId);
+    static bool IsGltf(const FString& formatId);
+
+    /**
+     * False: the meshes are written in the space of the exported file and AddNode is not used.
+     * True: the nodes are added parents first and the meshes are in the space of their node.
+     */
+    virtual bool KeepsHierarchy() const
+    {
+        return false;
+    }
+
+    virtual bool Begin(const FString& file) = 0;
+    // Returns the index of the node to pass as 'parentNode', INDEX_NONE for the root
+    virtual int32 AddNode(const FString& name, const int32 parentNode, const FMatrix& localToParent)
+    {
+        return INDEX_NONE;
+    }
+    // The sections are not needed anymore after the call
+    virtual void WriteMesh(const FString& name, TArrayView<const FExportableMeshSection> sections, const int32 parentNode) = 0;
+    /**
+     * The sections are in the space of the instances, 'instanceToSpace' places each instance like the meshes of WriteMesh are placed.
+     * By default each instance is written as a transformed copy of the sections, glTF writes the meshes once.
+     */
+    virtual void WriteInstancedMesh(const FString& name, TArrayView<const FExportableMeshSection> sections, TArrayView<const FMatrix> instanceToSpace, const int32 parentNode);
+    // True when WriteMeshWithLods writes the LODs into the file, otherwise each additional LOD is written by a writer of its own
+    virtual bool WritesLods() const
+    {
+        return false;
+    }
+    /**
+     * Writes 'sections' as the first LOD and 'lodSections' as the lower ones, in the order of FRuntimeMeshExportParam::additionalLods.
+     * An empty entry of 'lodSections' is an LOD the exportable does not have. By default only 'sections' is written.
+     */
+    virtual void WriteMeshWithLods(const FString& name, TArrayView<const FExportableMeshSection> sections, TArrayView<const TArrayView<const FExportableMeshSection>> lodSections, const int32 parentNode)
+    {
+        WriteMesh(name, sections, parentNode);
+    }
+    // Writes what can only be written at the end and closes the files
+    virtual bool End() = 0;
+
+    const FString& GetError() const
+    {
+        return error;
+    }
+
+protected:
+    FString error;
+};
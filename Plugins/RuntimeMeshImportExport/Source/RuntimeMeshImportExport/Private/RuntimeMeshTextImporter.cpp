@@ -0,0 +1,1190 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshTextImporter.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "AssimpIOSystem.h"
+#include "MeshConversionKernels.h"
+#include "MeshTangentGenerator.h"
+#include "MeshTextParsing.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+    // AI_DEFAULT_MATERIAL_NAME, the material of the faces without one
+    const TCHAR* defaultMaterialName = TEXT("DefaultMaterial");
+
+    // Up to 'maxValues' numbers separated by blanks, returns how many were read
+    int32 ParseFloats(const uint8*& cursor, const uint8* end, double* outValues, const int32 maxValues)
+    {
+        int32 numValues = 0;
+        while (numValues < maxValues)
+        {
+            FMeshTextParsing::SkipBlanks(cursor, end);
+            if (!FMeshTextParsing::ParseFloat(cursor, end, outValues[numValues]))
+            {
+                break;
+            }
+            ++numValues;
+        }
+        return numValues;
+    }
+
+    // The rgb of a Kd, Ks or Ke line, a single value is gray. False for the spectral and xyz forms, which are not read.
+    bool ParseMtlColor(const uint8*& cursor, const uint8* end, FLinearColor& outColor)
+    {
+        double values[3];
+        const int32 numValues = ParseFloats(cursor, end, values, 3);
+        if (numValues == 0)
+        {
+            return false;
+        }
+        outColor = FLinearColor(values[0], numValues > 1 ? values[1] : values[0], numValues > 2 ? values[2] : values[0]);
+        return true;
+    }
+
+    // Position, uv and normal index of an OBJ face corner
+    struct FObjCorner
+    {
+        int32 streams[3];
+    };
+
+    // An 'o', 'g' or 'usemtl' line, before the face with the index 'face' of its chunk
+    struct FObjEvent
+    {
+        bool bMaterial = false;
+        FString name;
+        int32 face = 0;
+    };
+
+    struct FObjChunk
+    {
+        TArray<FVector> positions;
+        TArray<FLinearColor> colors;
+        bool bHasColors = false;
+        TArray<FVector2D> uvs;
+        TArray<FVector> normals;
+        TArray<FObjCorner> corners;
+        // The first corner of each face
+        TArray<int32> faceStarts;
+        bool bAllTriangles = true;
+        // The corner streams with a negative index, corner * 3 + stream. Offset by the elements of the chunks before.
+        TArray<int32> relativeStreams;
+        TArray<FObjEvent> events;
+        TArray<FString> materialLibraries;
+    };
+
+    // OBJ indices are 1 based, negative ones count back from the last element read
+    int32 ResolveObjIndex(const int64 index, const int32 numRead, const int32 slot, FObjChunk& chunk)
+    {
+        if (index > 0)
+        {
+            return int32(index - 1);
+        }
+        if (index < 0)
+        {
+            chunk.relativeStreams.Add(slot);
+            return int32(numRead + index);
+        }
+        return INDEX_NONE;
+    }
+
+    void ParseObjFace(const uint8*& cursor, const uint8* end, FObjChunk& chunk)
+    {
+        const int32 firstCorner = chunk.corners.Num();
+        const int32 firstRelative = chunk.relativeStreams.Num();
+        while (true)
+        {
+            FMeshTextParsing::SkipBlanks(cursor, end);
+            int64 index;
+            if (!FMeshTextParsing::ParseInt(cursor, end, index))
+            {
+                break;
+            }
+            const int32 slot = chunk.corners.Num() * 3;
+            FObjCorner corner = { { INDEX_NONE, INDEX_NONE, INDEX_NONE } };
+            corner.streams[0] = ResolveObjIndex(index, chunk.positions.Num(), slot, chunk);
+            if (cursor < end && *cursor == '/')
+            {
+                ++cursor;
+                if (FMeshTextParsing::ParseInt(cursor, end, index))
+                {
+                    corner.streams[1] = ResolveObjIndex(index, chunk.uvs.Num(), slot + 1, chunk);
+                }
+                if (cursor < end && *cursor == '/')
+                {
+                    ++cursor;
+                    if (FMeshTextParsing::ParseInt(cursor, end, index))
+                    {
+                        corner.streams[2] = ResolveObjIndex(index, chunk.normals.Num(), slot + 2, chunk);
+                    }
+                }
+            }
+            chunk.corners.Add(corner);
+        }
+
+        const int32 numCorners = chunk.corners.Num() - firstCorner;
+        if (numCorners < 3)
+        {
+            // Lines and points are not imported
+            chunk.corners.SetNum(firstCorner, false);
+            chunk.relativeStreams.SetNum(firstRelative, false);
+            return;
+        }
+        chunk.faceStarts.Add(firstCorner);
+        chunk.bAllTriangles &= numCorners == 3;
+    }
+
+    void ParseObjChunk(const uint8* cursor, const uint8* end, FObjChunk& chunk)
+    {
+        double values[6];
+        while (cursor < end)
+        {
+            FMeshTextParsing::SkipBlanks(cursor, end);
+            if (cursor < end && *cursor == 'v')
+            {
+                // Missing components are zero, so the indices of the elements after stay right
+                if (FMeshTextParsing::MatchToken(cursor, end, "v"))
+                {
+                    const int32 numValues = ParseFloats(cursor, end, values, 6);
+                    chunk.positions.Add(FVector(numValues > 0 ? values[0] : 0.f, numValues > 1 ? values[1] : 0.f, numValues > 2 ? values[2] : 0.f));
+                    // The vertex colors that many scanners write after the position
+                    const bool bHasColor = numValues == 6;
+                    chunk.colors.Add(bHasColor ? FLinearColor(values[3], values[4], values[5]) : FLinearColor::White);
+                    chunk.bHasColors |= bHasColor;
+                }
+                else if (FMeshTextParsing::MatchToken(cursor, end, "vt"))
+                {
+                    const int32 numValues = ParseFloats(cursor, end, values, 3);
+                    chunk.uvs.Add(FVector2D(numValues > 0 ? values[0] : 0.f, numValues > 1 ? values[1] : 0.f));
+                }
+                else if (FMeshTextParsing::MatchToken(cursor, end, "vn"))
+                {
+                    const int32 numValues = ParseFloats(cursor, end, values, 3);
+                    chunk.normals.Add(FVector(numValues > 0 ? values[0] : 0.f, numValues > 1 ? values[1] : 0.f, numValues > 2 ? values[2] : 0.f));
+                }
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "f"))
+            {
+                ParseObjFace(cursor, end, chunk);
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "usemtl"))
+            {
+                FObjEvent& event = chunk.events.AddDefaulted_GetRef();
+                event.bMaterial = true;
+                event.name = FMeshTextParsing::ReadRestOfLine(cursor, end);
+                event.face = chunk.faceStarts.Num();
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "o") || FMeshTextParsing::MatchToken(cursor, end, "g"))
+            {
+                FObjEvent& event = chunk.events.AddDefaulted_GetRef();
+                event.name = FMeshTextParsing::ReadRestOfLine(cursor, end);
+                event.face = chunk.faceStarts.Num();
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "mtllib"))
+            {
+                chunk.materialLibraries.Add(FMeshTextParsing::ReadRestOfLine(cursor, end));
+            }
+            FMeshTextParsing::SkipLine(cursor, end);
+        }
+    }
+
+    struct FStlChunk
+    {
+        TArray<FVector> positions;
+        TArray<FVector> normals;
+    };
+
+    void ParseStlChunk(const uint8* cursor, const uint8* end, FStlChunk& chunk)
+    {
+        double values[3];
+        while (cursor < end)
+        {
+            FMeshTextParsing::SkipBlanks(cursor, end);
+            if (FMeshTextParsing::MatchToken(cursor, end, "vertex"))
+            {
+                const int32 numValues = ParseFloats(cursor, end, values, 3);
+                chunk.positions.Add(FVector(numValues > 0 ? values[0] : 0.f, numValues > 1 ? values[1] : 0.f, numValues > 2 ? values[2] : 0.f));
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "facet"))
+            {
+                FMeshTextParsing::SkipBlanks(cursor, end);
+                FMeshTextParsing::MatchToken(cursor, end, "normal");
+                const int32 numValues = ParseFloats(cursor, end, values, 3);
+                chunk.normals.Add(FVector(numValues > 0 ? values[0] : 0.f, numValues > 1 ? values[1] : 0.f, numValues > 2 ? values[2] : 0.f));
+            }
+            FMeshTextParsing::SkipLine(cursor, end);
+        }
+    }
+
+    struct FPlyProperty
+    {
+        FString name;
+        bool bList = false;
+        // Integer colors are normalized like the PLY importer of Assimp does
+        double colorScale = 1.0;
+    };
+
+    struct FPlyElement
+    {
+        FString name;
+        int64 count = 0;
+        int64 firstLine = 0;
+        TArray<FPlyProperty> properties;
+
+        int32 FindProperty(const TCHAR* name) const
+        {
+            return properties.IndexOfByPredicate([name](const FPlyProperty& property) { return property.name == name; });
+        }
+    };
+
+    double GetPlyColorScale(const FString& type)
+    {
+        if (type == TEXT("uchar") || type == TEXT("uint8"))
+        {
+            return 1.0 / 255.0;
+        }
+        if (type == TEXT("ushort") || type == TEXT("uint16"))
+        {
+            return 1.0 / 65535.0;
+        }
+        if (type == TEXT("char") || type == TEXT("int8"))
+        {
+            return 1.0 / 127.0;
+        }
+        if (type == TEXT("short") || type == TEXT("int16"))
+        {
+            return 1.0 / 32767.0;
+        }
+        return 1.0;
+    }
+
+    struct FPlyChunk
+    {
+        // The position index of each face corner
+        TArray<int32> corners;
+        TArray<int32> faceStarts;
+        bool bAllTriangles = true;
+    };
+
+    // Skips a PLY value or list that is not imported
+    void SkipPlyProperty(const FPlyProperty& property, const uint8*& cursor, const uint8* end)
+    {
+        double value;
+        FMeshTextParsing::SkipBlanks(cursor, end);
+        if (!FMeshTextParsing::ParseFloat(cursor, end, value) || !property.bList)
+        {
+            return;
+        }
+        for (int32 item = 0; item < int32(value); ++item)
+        {
+            FMeshTextParsing::SkipBlanks(cursor, end);
+            FMeshTextParsing::SkipToken(cursor, end);
+        }
+    }
+}
+
+bool FRuntimeMeshTextScene::GetFormat(const FString& extension, EFormat& outFormat)
+{
+    if (extension.Equals(TEXT("obj"), ESearchCase::IgnoreCase))
+    {
+        outFormat = EFormat::Obj;
+        return true;
+    }
+    if (extension.Equals(TEXT("stl"), ESearchCase::IgnoreCase))
+    {
+        outFormat = EFormat::Stl;
+        return true;
+    }
+    if (extension.Equals(TEXT("ply"), ESearchCase::IgnoreCase))
+    {
+        outFormat = EFormat::Ply;
+        return true;
+    }
+    return false;
+}
+
+bool FRuntimeMeshTextScene::IsTextFile(const FString& file)
+{
+    EFormat format;
+    return GetFormat(FPaths::GetExtension(file), format);
+}
+
+bool FRuntimeMeshTextScene::Load(const FString& file, FAssimpIOSystem& ioSystem)
+{
+    EFormat format;
+    if (!GetFormat(FPaths::GetExtension(file), format))
+    {
+        error = FString::Printf(TEXT("The format of %s is not read natively"), *file);
+        return false;
+    }
+
+    TArray<uint8> buffer;
+    TArrayView<const uint8> fileData;
+    Assimp::IOStream* stream = ioSystem.OpenView(TCHAR_TO_UTF8(*file), buffer, fileData);
+    if (!stream)
+    {
+        error = FString::Printf(TEXT("Failed to open the file %s"), *file);
+        return false;
+    }
+    // Everything is copied out of the file while it is parsed
+    const bool bParsed = Parse(fileData, format, file, ioSystem);
+    ioSystem.Close(stream);
+    return bParsed;
+}
+
+bool FRuntimeMeshTextScene::LoadFromMemory(TArrayView<const uint8> data, const FString& formatHint, FAssimpIOSystem& ioSystem)
+{
+    FString extension = formatHint;
+    extension.RemoveFromStart(TEXT("."));
+    EFormat format;
+    if (!GetFormat(extension, format))
+    {
+        error = FString::Printf(TEXT("The format %s is not read natively"), *formatHint);
+        return false;
+    }
+    return Parse(data, format, TEXT("memory.") + extension, ioSystem);
+}
+
+bool FRuntimeMeshTextScene::Parse(TArrayView<const uint8> data, const EFormat format, const FString& sceneName, FAssimpIOSystem& ioSystem)
+{
+    error.Reset();
+    nodes.Reset();
+    FNode& root = nodes.AddDefaulted_GetRef();
+    root.name = FName(*FPaths::GetCleanFilename(sceneName));
+
+    switch (format)
+    {
+    case EFormat::Obj:
+        return ParseObj(data, ioSystem);
+    case EFormat::Stl:
+        return ParseStl(data);
+    case EFormat::Ply:
+        return ParsePly(data);
+    default:
+        checkNoEntry(); // Every case must be handled
+    }
+    return false;
+}
+
+bool FRuntimeMeshTextScene::ParseObj(TArrayView<const uint8> data, FAssimpIOSystem& ioSystem)
+{
+    TArray<const uint8*> chunkStarts;
+    FMeshTextParsing::SplitIntoLineChunks(data, FMeshTextParsing::defaultChunkSize, chunkStarts);
+    const int32 numChunks = chunkStarts.Num() - 1;
+    TArray<FObjChunk> chunks;
+    chunks.SetNum(numChunks);
+    ParallelFor(numChunks, [&chunkStarts, &chunks](int32 chunkIndex)
+    {
+        ParseObjChunk(chunkStarts[chunkIndex], chunkStarts[chunkIndex + 1], chunks[chunkIndex]);
+    });
+
+    // Stitches the chunks in the order of the file
+    int32 numPositions = 0;
+    int32 numUVs = 0;
+    int32 numNormals = 0;
+    int32 numCorners = 0;
+    int32 numChunkFaces = 0;
+    bool bHasColors = false;
+    bool bAllTriangles = true;
+    for (const FObjChunk& chunk : chunks)
+    {
+        numPositions += chunk.positions.Num();
+        numUVs += chunk.uvs.Num();
+        numNormals += chunk.normals.Num();
+        numCorners += chunk.corners.Num();
+        numChunkFaces += chunk.faceStarts.Num();
+        bHasColors |= chunk.bHasColors;
+        bAllTriangles &= chunk.bAllTriangles;
+    }
+    positions.Reset(numPositions);
+    colors.Reset(bHasColors ? numPositions : 0);
+    uvs.Reset(numUVs);
+    normals.Reset(numNormals);
+    corners.Reset(numCorners);
+    faceStarts.Reset(bAllTriangles ? 0 : numChunkFaces + 1);
+    numFaces = numChunkFaces;
+
+    TArray<FString> materialLibraries;
+    TMap<FString, int32> objectNodes;
+    TMap<TPair<int32, FName>, int32> primitiveIndices;
+    TArray<FName> primitiveMaterials;
+    FString currentObject;
+    FName currentMaterial = NAME_None;
+    auto addFaces = [&](const int32 firstFace, const int32 count)
+    {
+        if (count <= 0)
+        {
+            return;
+        }
+        int32 nodeIndex = 0;
+        if (!currentObject.IsEmpty())
+        {
+            int32& objectNode = objectNodes.FindOrAdd(currentObject, INDEX_NONE);
+            if (objectNode == INDEX_NONE)
+            {
+                objectNode = nodes.Num();
+                FNode& node = nodes.AddDefaulted_GetRef();
+                node.name = FName(*currentObject);
+                node.parentIndex = 0;
+            }
+            nodeIndex = objectNode;
+        }
+        int32& primitiveIndex = primitiveIndices.FindOrAdd(TPair<int32, FName>(nodeIndex, currentMaterial), INDEX_NONE);
+        if (primitiveIndex == INDEX_NONE)
+        {
+            primitiveIndex = primitives.AddDefaulted();
+            primitiveMaterials.Add(currentMaterial);
+            nodes[nodeIndex].primitives.Add(primitiveIndex);
+        }
+        TArray<TPair<int32, int32>>& ranges = primitives[primitiveIndex].faceRanges;
+        if (ranges.Num() > 0 && ranges.Last().Key + ranges.Last().Value == firstFace)
+        {
+            ranges.Last().Value += count;
+        }
+        else
+        {
+            ranges.Emplace(firstFace, count);
+        }
+    };
+
+    int32 faceBase = 0;
+    for (FObjChunk& chunk : chunks)
+    {
+        const int32 streamBases[3] = { positions.Num(), uvs.Num(), normals.Num() };
+        const int32 cornerBase = corners.Num();
+        for (const int32 relativeStream : chunk.relativeStreams)
+        {
+            chunk.corners[relativeStream / 3].streams[relativeStream % 3] += streamBases[relativeStream % 3];
+        }
+        for (const FObjCorner& objCorner : chunk.corners)
+        {
+            FCorner& corner = corners.AddDefaulted_GetRef();
+            corner.position = objCorner.streams[0];
+            corner.uv = objCorner.streams[1];
+            corner.normal = objCorner.streams[2];
+        }
+        if (!bAllTriangles)
+        {
+            for (const int32 faceStart : chunk.faceStarts)
+            {
+                faceStarts.Add(cornerBase + faceStart);
+            }
+        }
+
+        positions.Append(MoveTemp(chunk.positions));
+        if (bHasColors)
+        {
+            colors.Append(MoveTemp(chunk.colors));
+        }
+        uvs.Append(MoveTemp(chunk.uvs));
+        normals.Append(MoveTemp(chunk.normals));
+
+        int32 localFace = 0;
+        for (const FObjEvent& event : chunk.events)
+        {
+            addFaces(faceBase + localFace, event.face - localFace);
+            localFace = event.face;
+            if (event.bMaterial)
+            {
+                currentMaterial = FName(*event.name);
+            }
+            else
+            {
+                currentObject = event.name;
+            }
+        }
+        addFaces(faceBase + localFace, chunk.faceStarts.Num() - localFace);
+        faceBase += chunk.faceStarts.Num();
+
+        for (const FString& library : chunk.materialLibraries)
+        {
+            materialLibraries.AddUnique(library);
+        }
+        chunk = FObjChunk();
+    }
+    if (!bAllTriangles)
+    {
+        faceStarts.Add(corners.Num());
+    }
+
+    if (primitives.Num() == 0)
+    {
+        error = TEXT("The file has no faces");
+        return false;
+    }
+
+    for (const FString& library : materialLibraries)
+    {
+        ParseMtl(library, ioSystem);
+    }
+    FinishPrimitives(primitiveMaterials);
+    return true;
+}
+
+void FRuntimeMeshTextScene::ParseMtl(const FString& mtlFile, FAssimpIOSystem& ioSystem)
+{
+    TArray<uint8> buffer;
+    TArrayView<const uint8> data;
+    Assimp::IOStream* stream = ioSystem.OpenView(TCHAR_TO_UTF8(*mtlFile), buffer, data);
+    if (!stream)
+    {
+        RMIE_LOG(Warning, "Could not open the material library %s, its materials are imported as the default material.", *mtlFile);
+        return;
+    }
+
+    // The texture stacks of the OBJ importer of Assimp
+    static const TPair<const ANSICHAR*, const TCHAR*> textureKeywords[] = {
+        { "map_Kd", TEXT("TexDiffuse") }, { "map_Ks", TEXT("TexSpecular") }, { "map_Ke", TEXT("TexEmissive") },
+        { "map_bump", TEXT("TexHeight") }, { "map_Bump", TEXT("TexHeight") }, { "bump", TEXT("TexHeight") },
+        { "norm", TEXT("TexNormal") }, { "map_Kn", TEXT("TexNormal") }, { "map_d", TEXT("TexOpacity") },
+        { "map_Ns", TEXT("TexShininess") }, { "disp", TEXT("TexDisplacement") } };
+
+    const uint8* cursor = data.GetData();
+    const uint8* end = cursor + data.Num();
+    int32 materialIndex = INDEX_NONE;
+    double values[3];
+    while (cursor < end)
+    {
+        FMeshTextParsing::SkipBlanks(cursor, end);
+        if (FMeshTextParsing::MatchToken(cursor, end, "newmtl"))
+        {
+            materialIndex = materials.AddDefaulted();
+            materials[materialIndex].name = FName(*FMeshTextParsing::ReadRestOfLine(cursor, end));
+        }
+        else if (materialIndex != INDEX_NONE)
+        {
+            FMaterial& material = materials[materialIndex];
+            if (FMeshTextParsing::MatchToken(cursor, end, "Kd"))
+            {
+                ParseMtlColor(cursor, end, material.diffuse);
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "Ks"))
+            {
+                ParseMtlColor(cursor, end, material.specular);
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "Ke"))
+            {
+                ParseMtlColor(cursor, end, material.emissive);
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "Ns") && ParseFloats(cursor, end, values, 1) == 1)
+            {
+                material.shininess = float(values[0]);
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "d") && ParseFloats(cursor, end, values, 1) == 1)
+            {
+                material.opacity = float(values[0]);
+            }
+            else if (FMeshTextParsing::MatchToken(cursor, end, "Tr") && ParseFloats(cursor, end, values, 1) == 1)
+            {
+                material.opacity = 1.f - float(values[0]);
+            }
+            else
+            {
+                for (const TPair<const ANSICHAR*, const TCHAR*>& keyword : textureKeywords)
+                {
+                    if (FMeshTextParsing::MatchToken(cursor, end, keyword.Key))
+                    {
+                        // The options like "-bm 0.5" come before the file
+                        FString textureFile = FMeshTextParsing::ReadRestOfLine(cursor, end).Replace(TEXT("\t"), TEXT(" "));
+                        int32 lastSpace;
+                        if (textureFile.FindLastChar(TEXT(' '), lastSpace))
+                        {
+                            textureFile = textureFile.Mid(lastSpace + 1);
+                        }
+                        if (!textureFile.IsEmpty())
+                        {
+                            material.textures.Emplace(FName(keyword.Value), textureFile);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        FMeshTextParsing::SkipLine(cursor, end);
+    }
+    ioSystem.Close(stream);
+}
+
+bool FRuntimeMeshTextScene::ParseStl(TArrayView<const uint8> data)
+{
+    // A binary STL has an 80 byte header, the triangle count and 50 bytes per triangle. Its header may start with "solid" as well.
+    if (data.Num() >= 84)
+    {
+        uint32 numTriangles = 0;
+        FMemory::Memcpy(&numTriangles, data.GetData() + 80, sizeof(uint32));
+        if (84 + int64(numTriangles) * 50 == data.Num())
+        {
+            error = TEXT("Binary STL files are read by Assimp");
+            return false;
+        }
+    }
+    const uint8* start = data.GetData();
+    FMeshTextParsing::SkipBlanks(start, data.GetData() + data.Num());
+    if (!FMeshTextParsing::MatchToken(start, data.GetData() + data.Num(), "solid"))
+    {
+        error = TEXT("The file is no ASCII STL");
+        return false;
+    }
+
+    TArray<const uint8*> chunkStarts;
+    FMeshTextParsing::SplitIntoLineChunks(data, FMeshTextParsing::defaultChunkSize, chunkStarts);
+    const int32 numChunks = chunkStarts.Num() - 1;
+    TArray<FStlChunk> chunks;
+    chunks.SetNum(numChunks);
+    ParallelFor(numChunks, [&chunkStarts, &chunks](int32 chunkIndex)
+    {
+        ParseStlChunk(chunkStarts[chunkIndex], chunkStarts[chunkIndex + 1], chunks[chunkIndex]);
+    });
+
+    int32 numPositions = 0;
+    int32 numFacetNormals = 0;
+    for (const FStlChunk& chunk : chunks)
+    {
+        numPositions += chunk.positions.Num();
+        numFacetNormals += chunk.normals.Num();
+    }
+    positions.Reset(numPositions);
+    normals.Reset(numFacetNormals);
+    for (FStlChunk& chunk : chunks)
+    {
+        positions.Append(MoveTemp(chunk.positions));
+        normals.Append(MoveTemp(chunk.normals));
+    }
+
+    numFaces = positions.Num() / 3;
+    if (numFaces == 0)
+    {
+        error = TEXT("The file has no facets");
+        return false;
+    }
+    // Each facet has its own vertices with the normal of the facet, like Assimp makes them
+    const bool bHasNormals = normals.Num() == numFaces;
+    corners.SetNumUninitialized(numFaces * 3);
+    for (int32 cornerIndex = 0; cornerIndex < corners.Num(); ++cornerIndex)
+    {
+        FCorner& corner = corners[cornerIndex];
+        corner.position = cornerIndex;
+        corner.uv = INDEX_NONE;
+        corner.normal = bHasNormals ? cornerIndex / 3 : INDEX_NONE;
+    }
+    faceStarts.Reset();
+
+    primitives.AddDefaulted_GetRef().faceRanges.Emplace(0, numFaces);
+    nodes[0].primitives.Add(0);
+    const FName noMaterial = NAME_None;
+    FinishPrimitives(MakeArrayView(&noMaterial, 1));
+    return true;
+}
+
+bool FRuntimeMeshTextScene::ParsePly(TArrayView<const uint8> data)
+{
+    const uint8* cursor = data.GetData();
+    const uint8* end = cursor + data.Num();
+    if (!FMeshTextParsing::MatchToken(cursor, end, "ply"))
+    {
+        error = TEXT("The file is no PLY");
+        return false;
+    }
+    FMeshTextParsing::SkipLine(cursor, end);
+
+    TArray<FPlyElement> elements;
+    bool bHeaderEnded = false;
+    while (cursor < end && !bHeaderEnded)
+    {
+        FMeshTextParsing::SkipBlanks(cursor, end);
+        if (FMeshTextParsing::MatchToken(cursor, end, "format"))
+        {
+            FMeshTextParsing::SkipBlanks(cursor, end);
+            if (!FMeshTextParsing::MatchToken(cursor, end, "ascii"))
+            {
+                error = TEXT("Binary PLY files are read by Assimp");
+                return false;
+            }
+        }
+        else if (FMeshTextParsing::MatchToken(cursor, end, "element"))
+        {
+            FPlyElement& element = elements.AddDefaulted_GetRef();
+            element.name = FMeshTextParsing::ReadToken(cursor, end);
+            FMeshTextParsing::SkipBlanks(cursor, end);
+            FMeshTextParsing::ParseInt(cursor, end, element.count);
+        }
+        else if (FMeshTextParsing::MatchToken(cursor, end, "property"))
+        {
+            if (elements.Num() == 0)
+            {
+                error = TEXT("The PLY header has a property without an element");
+                return false;
+            }
+            FPlyProperty& property = elements.Last().properties.AddDefaulted_GetRef();
+            FMeshTextParsing::SkipBlanks(cursor, end);
+            if (FMeshTextParsing::MatchToken(cursor, end, "list"))
+            {
+                // The types of the count and of the items
+                property.bList = true;
+                FMeshTextParsing::ReadToken(cursor, end);
+                FMeshTextParsing::ReadToken(cursor, end);
+            }
+            else
+            {
+                property.colorScale = GetPlyColorScale(FMeshTextParsing::ReadToken(cursor, end));
+            }
+            property.name = FMeshTextParsing::ReadToken(cursor, end);
+        }
+        else if (FMeshTextParsing::MatchToken(cursor, end, "end_header"))
+        {
+            bHeaderEnded = true;
+        }
+        FMeshTextParsing::SkipLine(cursor, end);
+    }
+    if (!bHeaderEnded)
+    {
+        error = TEXT("The PLY header has no end");
+        return false;
+    }
+
+    const int32 vertexElementIndex = elements.IndexOfByPredicate([](const FPlyElement& element) { return element.name == TEXT("vertex"); });
+    const int32 faceElementIndex = elements.IndexOfByPredicate([](const FPlyElement& element) { return element.name == TEXT("face"); });
+    if (vertexElementIndex == INDEX_NONE || faceElementIndex == INDEX_NONE || elements[faceElementIndex].count == 0)
+    {
+        error = TEXT("The PLY has no faces, points are imported with FRuntimeMeshImportPointCloudImporter");
+        return false;
+    }
+    int64 numLines = 0;
+    for (FPlyElement& element : elements)
+    {
+        element.firstLine = numLines;
+        numLines += element.count;
+    }
+    const FPlyElement& vertexElement = elements[vertexElementIndex];
+    const FPlyElement& faceElement = elements[faceElementIndex];
+    if (vertexElement.count > MAX_int32 || faceElement.count > MAX_int32)
+    {
+        error = TEXT("The PLY has more than 2^31 vertices or faces");
+        return false;
+    }
+
+    // The streams of the vertex element, by property
+    const int32 numVertices = int32(vertexElement.count);
+    const int32 positionProperties[3] = { vertexElement.FindProperty(TEXT("x")), vertexElement.FindProperty(TEXT("y")), vertexElement.FindProperty(TEXT("z")) };
+    if (positionProperties[0] == INDEX_NONE || positionProperties[1] == INDEX_NONE || positionProperties[2] == INDEX_NONE)
+    {
+        error = TEXT("The PLY vertices have no position");
+        return false;
+    }
+    const int32 normalProperties[3] = { vertexElement.FindProperty(TEXT("nx")), vertexElement.FindProperty(TEXT("ny")), vertexElement.FindProperty(TEXT("nz")) };
+    // The names of the UV properties that the PLY importer of Assimp reads
+    static const TCHAR* uvNames[][2] = { { TEXT("u"), TEXT("v") }, { TEXT("s"), TEXT("t") }, { TEXT("texture_u"), TEXT("texture_v") }, { TEXT("texture_s"), TEXT("texture_t") } };
+    int32 uvProperties[2] = { INDEX_NONE, INDEX_NONE };
+    for (const TCHAR* const* names : uvNames)
+    {
+        if (uvProperties[0] == INDEX_NONE || uvProperties[1] == INDEX_NONE)
+        {
+            uvProperties[0] = vertexElement.FindProperty(names[0]);
+            uvProperties[1] = vertexElement.FindProperty(names[1]);
+        }
+    }
+    const int32 colorProperties[4] = { vertexElement.FindProperty(TEXT("red")), vertexElement.FindProperty(TEXT("green")), vertexElement.FindProperty(TEXT("blue")), vertexElement.FindProperty(TEXT("alpha")) };
+    const bool bHasNormals = normalProperties[0] != INDEX_NONE && normalProperties[1] != INDEX_NONE && normalProperties[2] != INDEX_NONE;
+    const bool bHasUVs = uvProperties[0] != INDEX_NONE && uvProperties[1] != INDEX_NONE;
+    const bool bHasColors = colorProperties[0] != INDEX_NONE && colorProperties[1] != INDEX_NONE && colorProperties[2] != INDEX_NONE;
+    const int32 indicesProperty = faceElement.properties.IndexOfByPredicate([](const FPlyProperty& property) {
+        return property.bList && (property.name == TEXT("vertex_indices") || property.name == TEXT("vertex_index"));
+    });
+    if (indicesProperty == INDEX_NONE)
+    {
+        error = TEXT("The PLY faces have no vertex indices");
+        return false;
+    }
+
+    // The vertices are written straight into the streams by their line, the faces into the chunks
+    positions.SetNumZeroed(numVertices);
+    normals.SetNumZeroed(bHasNormals ? numVertices : 0);
+    uvs.SetNumZeroed(bHasUVs ? numVertices : 0);
+    colors.Init(FLinearColor::White, bHasColors ? numVertices : 0);
+
+    TArray<const uint8*> chunkStarts;
+    FMeshTextParsing::SplitIntoLineChunks(TArrayView<const uint8>(cursor, int32(end - cursor)), FMeshTextParsing::defaultChunkSize, chunkStarts);
+    const int32 numChunks = chunkStarts.Num() - 1;
+    TArray<int64> chunkFirstLines;
+    chunkFirstLines.SetNumZeroed(numChunks + 1);
+    ParallelFor(numChunks, [&chunkStarts, &chunkFirstLines](int32 chunkIndex)
+    {
+        int64 numChunkLines = 0;
+        for (const uint8* read = chunkStarts[chunkIndex]; read < chunkStarts[chunkIndex + 1]; ++read)
+        {
+            numChunkLines += FMeshTextParsing::IsLineEnd(*read) ? 1 : 0;
+        }
+        // The last line may have no line break
+        if (chunkStarts[chunkIndex + 1] > chunkStarts[chunkIndex] && !FMeshTextParsing::IsLineEnd(chunkStarts[chunkIndex + 1][-1]))
+        {
+            ++numChunkLines;
+        }
+        chunkFirstLines[chunkIndex + 1] = numChunkLines;
+    });
+    for (int32 chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+    {
+        chunkFirstLines[chunkIndex + 1] += chunkFirstLines[chunkIndex];
+    }
+
+    TArray<FPlyChunk> chunks;
+    chunks.SetNum(numChunks);
+    ParallelFor(numChunks, [&](int32 chunkIndex)
+    {
+        FPlyChunk& chunk = chunks[chunkIndex];
+        const uint8* read = chunkStarts[chunkIndex];
+        const uint8* chunkEnd = chunkStarts[chunkIndex + 1];
+        TArray<double, TInlineAllocator<16>> values;
+        for (int64 line = chunkFirstLines[chunkIndex]; read < chunkEnd; ++line)
+        {
+            if (line >= vertexElement.firstLine && line < vertexElement.firstLine + vertexElement.count)
+            {
+                values.SetNumZeroed(vertexElement.properties.Num(), false);
+                for (int32 propertyIndex = 0; propertyIndex < vertexElement.properties.Num(); ++propertyIndex)
+                {
+                    const FPlyProperty& property = vertexElement.properties[propertyIndex];
+                    if (property.bList)
+                    {
+                        SkipPlyProperty(property, read, chunkEnd);
+                        continue;
+                    }
+                    FMeshTextParsing::SkipBlanks(read, chunkEnd);
+                    FMeshTextParsing::ParseFloat(read, chunkEnd, values[propertyIndex]);
+                }
+                const int32 vertex = int32(line - vertexElement.firstLine);
+                positions[vertex] = FVector(values[positionProperties[0]], values[positionProperties[1]], values[positionProperties[2]]);
+                if (bHasNormals)
+                {
+                    normals[vertex] = FVector(values[normalProperties[0]], values[normalProperties[1]], values[normalProperties[2]]);
+                }
+                if (bHasUVs)
+                {
+                    uvs[vertex] = FVector2D(values[uvProperties[0]], values[uvProperties[1]]);
+                }
+                if (bHasColors)
+                {
+                    FLinearColor& color = colors[vertex];
+                    for (int32 channel = 0; channel < 4; ++channel)
+                    {
+                        const int32 propertyIndex = colorProperties[channel];
+                        if (propertyIndex != INDEX_NONE)
+                        {
+                            color.Component(channel) = float(values[propertyIndex] * vertexElement.properties[propertyIndex].colorScale);
+                        }
+                    }
+                }
+            }
+            else if (line >= faceElement.firstLine && line < faceElement.firstLine + faceElement.count)
+            {
+                const int32 firstCorner = chunk.corners.Num();
+                for (int32 propertyIndex = 0; propertyIndex < faceElement.properties.Num(); ++propertyIndex)
+                {
+                    const FPlyProperty& property = faceElement.properties[propertyIndex];
+                    if (propertyIndex != indicesProperty)
+                    {
+                        SkipPlyProperty(property, read, chunkEnd);
+                        continue;
+                    }
+                    int64 numIndices = 0;
+                    FMeshTextParsing::SkipBlanks(read, chunkEnd);
+                    FMeshTextParsing::ParseInt(read, chunkEnd, numIndices);
+                    for (int64 item = 0; item < numIndices; ++item)
+                    {
+                        int64 index = INDEX_NONE;
+                        FMeshTextParsing::SkipBlanks(read, chunkEnd);
+                        FMeshTextParsing::ParseInt(read, chunkEnd, index);
+                        chunk.corners.Add(int32(index));
+                    }
+                }
+                // Every face line is a face, so the faces stay in the order of the element
+                chunk.faceStarts.Add(firstCorner);
+                chunk.bAllTriangles &= chunk.corners.Num() - firstCorner == 3;
+            }
+            FMeshTextParsing::SkipLine(read, chunkEnd);
+        }
+    });
+
+    int32 numCorners = 0;
+    bool bAllTriangles = true;
+    numFaces = 0;
+    for (const FPlyChunk& chunk : chunks)
+    {
+        numCorners += chunk.corners.Num();
+        numFaces += chunk.faceStarts.Num();
+        bAllTriangles &= chunk.bAllTriangles;
+    }
+    // The faces with fewer than 3 corners are kept, so the face count matches, IsFaceValid skips them
+    corners.Reset(numCorners);
+    faceStarts.Reset(bAllTriangles ? 0 : numFaces + 1);
+    for (FPlyChunk& chunk : chunks)
+    {
+        const int32 cornerBase = corners.Num();
+        for (const int32 position : chunk.corners)
+        {
+            FCorner& corner = corners.AddDefaulted_GetRef();
+            corner.position = position;
+            corner.uv = bHasUVs ? position : INDEX_NONE;
+            corner.normal = bHasNormals ? position : INDEX_NONE;
+        }
+        if (!bAllTriangles)
+        {
+            for (const int32 faceStart : chunk.faceStarts)
+            {
+                faceStarts.Add(cornerBase + faceStart);
+            }
+        }
+        chunk = FPlyChunk();
+    }
+    if (!bAllTriangles)
+    {
+        faceStarts.Add(corners.Num());
+    }
+
+    primitives.AddDefaulted_GetRef().faceRanges.Emplace(0, numFaces);
+    nodes[0].primitives.Add(0);
+    const FName noMaterial = NAME_None;
+    FinishPrimitives(MakeArrayView(&noMaterial, 1));
+    return true;
+}
+
+void FRuntimeMeshTextScene::FinishPrimitives(TArrayView<const FName> primitiveMaterials)
+{
+    int32 defaultMaterial = INDEX_NONE;
+    for (int32 primitiveIndex = 0; primitiveIndex < primitives.Num(); ++primitiveIndex)
+    {
+        const FName materialName = primitiveMaterials[primitiveIndex];
+        int32 material = materialName.IsNone() ? INDEX_NONE : materials.IndexOfByPredicate([materialName](const FMaterial& candidate) { return candidate.name == materialName; });
+        if (material == INDEX_NONE)
+        {
+            if (defaultMaterial == INDEX_NONE)
+            {
+                defaultMaterial = materials.AddDefaulted();
+                materials[defaultMaterial].name = FName(defaultMaterialName);
+            }
+            material = defaultMaterial;
+        }
+        primitives[primitiveIndex].material = material;
+    }
+
+    ParallelFor(primitives.Num(), [this](int32 primitiveIndex)
+    {
+        FPrimitive& primitive = primitives[primitiveIndex];
+        bool bAllNormals = true;
+        bool bAllUVs = true;
+        bool bIndexed = true;
+        int32 numTriangles = 0;
+        for (const TPair<int32, int32>& range : primitive.faceRanges)
+        {
+            for (int32 face = range.Key; face < range.Key + range.Value; ++face)
+            {
+                if (!IsFaceValid(face))
+                {
+                    continue;
+                }
+                const int32 faceStart = GetFaceStart(face);
+                const int32 faceSize = GetFaceSize(face);
+                numTriangles += faceSize - 2;
+                for (int32 cornerIndex = faceStart; cornerIndex < faceStart + faceSize; ++cornerIndex)
+                {
+                    const FCorner& corner = corners[cornerIndex];
+                    bAllNormals &= uint32(corner.normal) < uint32(normals.Num());
+                    bAllUVs &= uint32(corner.uv) < uint32(uvs.Num());
+                    bIndexed &= (corner.uv == INDEX_NONE || corner.uv == corner.position) && (corner.normal == INDEX_NONE || corner.normal == corner.position);
+                }
+            }
+        }
+        primitive.numTriangles = numTriangles;
+        primitive.bHasNormals = bAllNormals && numTriangles > 0;
+        primitive.bHasUVs = bAllUVs && numTriangles > 0;
+        primitive.bIndexed = bIndexed;
+    });
+}
+
+bool FRuntimeMeshTextScene::IsFaceValid(const int32 face) const
+{
+    const int32 faceStart = GetFaceStart(face);
+    const int32 faceSize = GetFaceSize(face);
+    if (faceSize < 3)
+    {
+        return false;
+    }
+    for (int32 cornerIndex = faceStart; cornerIndex < faceStart + faceSize; ++cornerIndex)
+    {
+        if (uint32(corners[cornerIndex].position) >= uint32(positions.Num()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FRuntimeMeshTextScene::HasAllNormals() const
+{
+    return !primitives.ContainsByPredicate([](const FPrimitive& primitive) { return !primitive.bHasNormals; });
+}
+
+FBox FRuntimeMeshTextScene::ComputePrimitiveBounds(const uint32 primitiveIndex, const FMatrix& matrix) const
+{
+    const FMatrix mirroredMatrix = FScaleMatrix(FVector(1.f, 1.f, -1.f)) * matrix;
+    FBox bounds(ForceInit);
+    for (const TPair<int32, int32>& range : primitives[primitiveIndex].faceRanges)
+    {
+        for (int32 face = range.Key; face < range.Key + range.Value; ++face)
+        {
+            if (!IsFaceValid(face))
+            {
+                continue;
+            }
+            const int32 faceStart = GetFaceStart(face);
+            for (int32 cornerIndex = faceStart; cornerIndex < faceStart + GetFaceSize(face); ++cornerIndex)
+            {
+                bounds += mirroredMatrix.TransformPosition(positions[corners[cornerIndex].position]);
+            }
+        }
+    }
+    return bounds;
+}
+
+void FRuntimeMeshTextScene::GetPrimitiveCounts(const uint32 primitiveIndex, int64& outVertices, int64& outTriangles) const
+{
+    const FPrimitive& primitive = primitives[primitiveIndex];
+    outTriangles = primitive.numTriangles;
+    // Indexed primitives share the positions between their faces, the others have a vertex per corner
+    outVertices = primitive.bIndexed ? FMath::Min<int64>(positions.Num(), outTriangles * 3) : outTriangles * 3;
+}
+
+void FRuntimeMeshTextScene::ConvertPrimitive(const uint32 primitiveIndex, const FTransform& transform, const bool bCalcTangents, FRuntimeMeshImportSectionInfo& outSection) const
+{
+    const FPrimitive& primitive = primitives[primitiveIndex];
+    outSection.materialIndex = primitive.material;
+    outSection.materialName = materials[primitive.material].name;
+
+    // The corner each vertex reads its streams from. Indexed primitives have a vertex per position, the others one per face corner.
+    TArray<int32> vertexCorners;
+    outSection.triangles.Reset(primitive.numTriangles * 3);
+    // A map for the small primitives of a large file, so each of them does not allocate the remap of all positions
+    const bool bDenseRemap = primitive.bIndexed && int64(primitive.numTriangles) * 2 >= positions.Num();
+    TArray<int32> denseRemap;
+    TMap<int32, int32> sparseRemap;
+    if (bDenseRemap)
+    {
+        denseRemap.Init(INDEX_NONE, positions.Num());
+    }
+    TArray<int32, TInlineAllocator<16>> faceVertices;
+    for (const TPair<int32, int32>& range : primitive.faceRanges)
+    {
+        for (int32 face = range.Key; face < range.Key + range.Value; ++face)
+        {
+            if (!IsFaceValid(face))
+            {
+                continue;
+            }
+            const int32 faceStart = GetFaceStart(face);
+            const int32 faceSize = GetFaceSize(face);
+            faceVertices.Reset();
+            for (int32 cornerIndex = faceStart; cornerIndex < faceStart + faceSize; ++cornerIndex)
+            {
+                if (!primitive.bIndexed)
+                {
+                    faceVertices.Add(vertexCorners.Add(cornerIndex));
+                    continue;
+                }
+                const int32 position = corners[cornerIndex].position;
+                int32& vertex = bDenseRemap ? denseRemap[position] : sparseRemap.FindOrAdd(position, INDEX_NONE);
+                if (vertex == INDEX_NONE)
+                {
+                    vertex = vertexCorners.Add(cornerIndex);
+                }
+                faceVertices.Add(vertex);
+            }
+            // A fan, like aiProcess_Triangulate does for convex polygons
+            for (int32 corner = 1; corner + 1 < faceSize; ++corner)
+            {
+                outSection.triangles.Add(faceVertices[0]);
+                outSection.triangles.Add(faceVertices[corner]);
+                outSection.triangles.Add(faceVertices[corner + 1]);
+            }
+        }
+    }
+
+    const int32 numVertices = vertexCorners.Num();
+    // The mirror of aiProcess_MakeLeftHanded is folded into the matrices, the streams are gathered in the space of the file
+    const FMatrix positionMatrix = FScaleMatrix(FVector(1.f, 1.f, -1.f)) * transform.ToMatrixWithScale();
+    outSection.vertices.SetNumUninitialized(numVertices);
+    for (int32 vertex = 0; vertex < numVertices; ++vertex)
+    {
+        outSection.vertices[vertex] = positions[corners[vertexCorners[vertex]].position];
+    }
+    FMeshConversionKernels::TransformPositions(positionMatrix, outSection.vertices.GetData(), outSection.vertices.GetData(), numVertices, &outSection.bounds);
+
+    if (primitive.bHasNormals)
+    {
+        outSection.normals.SetNumUninitialized(numVertices);
+        for (int32 vertex = 0; vertex < numVertices; ++vertex)
+        {
+            outSection.normals[vertex] = normals[corners[vertexCorners[vertex]].normal];
+        }
+        FMeshConversionKernels::TransformDirections(FMeshConversionKernels::GetNormalMatrix(positionMatrix), outSection.normals.GetData(), outSection.normals.GetData(), numVertices, true);
+    }
+
+    if (primitive.bHasUVs)
+    {
+        // The importers of Assimp keep V as in the file and the Assimp conversion negates it
+        outSection.uv0.SetNumUninitialized(numVertices);
+        for (int32 vertex = 0; vertex < numVertices; ++vertex)
+        {
+            const FVector2D& uv = uvs[corners[vertexCorners[vertex]].uv];
+            outSection.uv0[vertex] = FVector2D(uv.X, -uv.Y);
+        }
+    }
+
+    if (colors.Num() > 0)
+    {
+        outSection.vertexColors.SetNumUninitialized(numVertices);
+        for (int32 vertex = 0; vertex < numVertices; ++vertex)
+        {
+            outSection.vertexColors[vertex] = colors[corners[vertexCorners[vertex]].position];
+        }
+    }
+
+    // When the mesh is inside out cause of the scale, flip the winding order of the triangles
+    const FVector scale = transform.GetScale3D();
+    if (scale.X * scale.Y * scale.Z < 0)
+    {
+        for (int32 index = 0; index < outSection.triangles.Num(); index += 3)
+        {
+            Swap(outSection.triangles[index + 1], outSection.triangles[index + 2]);
+        }
+    }
+
+    if (bCalcTangents && primitive.bHasNormals && primitive.bHasUVs)
+    {
+        FMeshTangentGenerator::GenerateMikkTSpaceTangents(outSection);
+    }
+}
+
+void FRuntimeMeshTextScene::ImportMaterial(const int32 materialIndex, FRuntimeMeshImportMaterialInfo& materialInfo, TArray<TPair<int32, FString>>& outTextureUris) const
+{
+    const FMaterial& material = materials[materialIndex];
+    materialInfo.name = material.name;
+    materialInfo.bTwoSided = false;
+    materialInfo.shadingMode = ERuntimeMeshImportExportMaterialShadingMode::Unknown;
+    materialInfo.shadingModeInt = -1;
+    materialInfo.blendMode = ERuntimeMeshImportExportMaterialBlendMode::Unknown;
+    materialInfo.blendModeInt = -1;
+
+    // The params and texture stacks in the order the Assimp import adds them
+    materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Diffuse"), material.diffuse));
+    materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Specular"), material.specular));
+    materialInfo.vectors.Add(FRuntimeMeshImportExportMaterialParamVector(TEXT("Emissive"), material.emissive));
+    materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Opacity"), material.opacity));
+    materialInfo.scalars.Add(FRuntimeMeshImportExportMaterialParamScalar(TEXT("Shininess"), material.shininess));
+
+    for (const TPair<FName, FString>& texture : material.textures)
+    {
+        outTextureUris.Add(TPair<int32, FString>(materialInfo.textures.Add(FRuntimeMeshImportExportMaterialParamTexture(texture.Key)), texture.Value));
+    }
+}
@@ -0,0 +1,162 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FAssimpIOSystem;
+struct FRuntimeMeshImportSectionInfo;
+struct FRuntimeMeshImportMaterialInfo;
+
+/**
+ *	Reads ASCII OBJ, STL and PLY files without Assimp, whose line parsers run on one thread.
+ *	The file is split into chunks that start at a line break, the chunks are parsed in parallel and stitched together after,
+ *	which offsets the relative indices of OBJ faces and the faces of each PLY element by the lines of the chunks before.
+ *	The materials of OBJ files are read from their MTL files.
+ *
+ *	The scene is laid out like the one Assimp with aiProcess_MakeLeftHanded makes of the file: a root node with a child per OBJ object
+ *	and a primitive per material of each object, the vertices mirrored at z. Polygons are triangulated as fans.
+ *	A face whose corners use the same index for all their streams, like the faces of every PLY, shares its vertices with the other faces,
+ *	otherwise each face corner is a vertex of its own, as Assimp makes them.
+ *	Load fails, with the reason in GetError, for binary STL and PLY files, so the import falls back to Assimp for them.
+ *	After Load the scene is only read, so the primitives can be converted in parallel.
+ */
+class FRuntimeMeshTextScene
+{
+public:
+    struct FNode
+    {
+        FName name;
+        // Parents are stored before their children
+        int32 parentIndex = INDEX_NONE;
+        FTransform localTransform;
+        TArray<uint32> primitives;
+    };
+
+    // By the extension of 'file', .obj, .stl or .ply
+    static bool IsTextFile(const FString& file);
+
+    // Relative MTL files are resolved by 'ioSystem'
+    bool Load(const FString& file, FAssimpIOSystem& ioSystem);
+    // 'formatHint' is the extension of the format, the data is copied into the scene while it is parsed
+    bool LoadFromMemory(TArrayView<const uint8> data, const FString& formatHint, FAssimpIOSystem& ioSystem);
+
+    const FString& GetError() const
+    {
+        return error;
+    }
+
+    const TArray<FNode>& GetNodes() const
+    {
+        return nodes;
+    }
+
+    // False when a primitive has corners without a normal
+    bool HasAllNormals() const;
+
+    FBox ComputePrimitiveBounds(const uint32 primitiveIndex, const FMatrix& matrix) const;
+
+    // The triangles of a primitive and about the vertices the conversion makes of them
+    void GetPrimitiveCounts(const uint32 primitiveIndex, int64& outVertices, int64& outTriangles) const;
+
+    /**
+     * Converts one primitive to a section, transformed by 'transform'. Only writes to 'outSection'.
+     * The normals are left empty when the primitive has none.
+     * @param bCalcTangents		Generates the MikkTSpace tangents from the normals and UVs, the files have no tangents
+     */
+    void ConvertPrimitive(const uint32 primitiveIndex, const FTransform& transform, const bool bCalcTangents, FRuntimeMeshImportSectionInfo& outSection) const;
+
+    // The materials of the MTL files and the default material of the primitives without one
+    int32 NumMaterials() const
+    {
+        return materials.Num();
+    }
+
+    // The texture files are added to 'outTextureUris' with the index of their texture in 'materialInfo'
+    void ImportMaterial(const int32 materialIndex, FRuntimeMeshImportMaterialInfo& materialInfo, TArray<TPair<int32, FString>>& outTextureUris) const;
+
+private:
+    enum class EFormat : uint8
+    {
+        Obj,
+        Stl,
+        Ply,
+    };
+
+    // Indices into the streams of the file, INDEX_NONE for a stream the corner does not have
+    struct FCorner
+    {
+        int32 position = INDEX_NONE;
+        int32 uv = INDEX_NONE;
+        int32 normal = INDEX_NONE;
+    };
+
+    struct FPrimitive
+    {
+        int32 material = INDEX_NONE;
+        // First face and number of faces of each run of faces
+        TArray<TPair<int32, int32>> faceRanges;
+        int32 numTriangles = 0;
+        // Set by FinishPrimitives
+        bool bHasNormals = false;
+        bool bHasUVs = false;
+        // Every corner uses its position index for all its streams
+        bool bIndexed = false;
+    };
+
+    struct FMaterial
+    {
+        FName name;
+        // The defaults of the OBJ importer of Assimp
+        FLinearColor diffuse = FLinearColor(0.6f, 0.6f, 0.6f);
+        FLinearColor specular = FLinearColor::Black;
+        FLinearColor emissive = FLinearColor::Black;
+        float opacity = 1.f;
+        float shininess = 0.f;
+        // Texture files by stack name, in the order of the MTL file
+        TArray<TPair<FName, FString>> textures;
+    };
+
+    static bool GetFormat(const FString& extension, EFormat& outFormat);
+    bool Parse(TArrayView<const uint8> data, const EFormat format, const FString& sceneName, FAssimpIOSystem& ioSystem);
+    bool ParseObj(TArrayView<const uint8> data, FAssimpIOSystem& ioSystem);
+    void ParseMtl(const FString& mtlFile, FAssimpIOSystem& ioSystem);
+    bool ParseStl(TArrayView<const uint8> data);
+    bool ParsePly(TArrayView<const uint8> data);
+    // Adds the default material and sets the flags of the primitives
+    void FinishPrimitives(TArrayView<const FName> primitiveMaterials);
+
+    int32 GetFaceStart(const int32 face) const
+    {
+        return faceStarts.Num() > 0 ? faceStarts[face] : face * 3;
+    }
+
+    int32 GetFaceSize(const int32 face) const
+    {
+        return faceStarts.Num() > 0 ? faceStarts[face + 1] - faceStarts[face] : 3;
+    }
+
+    // A face with fewer than 3 corners or a corner outside of the positions is skipped
+    bool IsFaceValid(const int32 face) const;
+
+    FString error;
+
+    // The streams of the file, in the space of the file
+    TArray<FVector> positions;
+    // Empty when the file has no vertex colors, white for the vertices without one otherwise
+    TArray<FLinearColor> colors;
+    TArray<FVector> normals;
+    TArray<FVector2D> uvs;
+
+    // The corners of all faces
+    TArray<FCorner> corners;
+    // The first corner of each face followed by the number of corners, empty when all faces are triangles
+    TArray<int32> faceStarts;
+    int32 numFaces = 0;
+
+    TArray<FPrimitive> primitives;
+    TArray<FMaterial> materials;
+    TArray<FNode> nodes;
+};
@@ -0,0 +1,477 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshTextureBuilder.h"
+#include "RuntimeMeshImportExport.h"
+#include "TextureBlockCompression.h"
+#include "RuntimeMeshImportExportStats.h"
+#include "Engine/Texture2D.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+
+static const FName imageWrapperModuleName(TEXT("ImageWrapper"));
+
+// Same as UTexture2D::CreateTransient, without allocating a mip
+static UTexture2D* NewTransientTexture(const FIntPoint& size, const EPixelFormat pixelFormat)
+{
+    UTexture2D* texture = NewObject<UTexture2D>(GetTransientPackage(), NAME_None, RF_Transient);
+    texture->PlatformData = new FTexturePlatformData();
+    texture->PlatformData->SizeX = size.X;
+    texture->PlatformData->SizeY = size.Y;
+    texture->PlatformData->PixelFormat = pixelFormat;
+    return texture;
+}
+
+static void AddMip(UTexture2D* texture, const FIntPoint& size, TArrayView<const uint8> data)
+{
+    FTexture2DMipMap* mip = new FTexture2DMipMap();
+    texture->PlatformData->Mips.Add(mip);
+    mip->SizeX = size.X;
+    mip->SizeY = size.Y;
+
+    mip->BulkData.Lock(LOCK_READ_WRITE);
+    void* bulkData = mip->BulkData.Realloc(data.Num());
+    FMemory::Memcpy(bulkData, data.GetData(), data.Num());
+    mip->BulkData.Unlock();
+}
+
+void FRuntimeMeshTextureBuilder::LoadModules_GameThread()
+{
+    check(IsInGameThread());
+    FModuleManager::LoadModuleChecked<IImageWrapperModule>(imageWrapperModuleName);
+}
+
+bool FRuntimeMeshTextureBuilder::DecodeImage_AnyThread(TArrayView<const uint8> fileBytes, FRuntimeMeshTextureMips& outMips)
+{
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_DecodedTextures);
+    IImageWrapperModule* imageWrapperModule = FModuleManager::GetModulePtr<IImageWrapperModule>(imageWrapperModuleName);
+    if (!imageWrapperModule)
+    {
+        RMIE_LOG(Error, "The ImageWrapper module is not loaded. Call LoadModules_GameThread before.");
+        return false;
+    }
+
+    const EImageFormat imageFormat = imageWrapperModule->DetectImageFormat(fileBytes.GetData(), fileBytes.Num());
+    if (imageFormat == EImageFormat::Invalid)
+    {
+        RMIE_LOG(Error, "Unknown image format.");
+        return false;
+    }
+
+    TSharedPtr<IImageWrapper> imageWrapper = imageWrapperModule->CreateImageWrapper(imageFormat);
+    const TArray<uint8>* rawData = nullptr;
+    if (!imageWrapper.IsValid() || !imageWrapper->SetCompressed(fileBytes.GetData(), fileBytes.Num())
+        || !imageWrapper->GetRaw(ERGBFormat::BGRA, 8, rawData) || !rawData)
+    {
+        RMIE_LOG(Error, "Failed to decode the image.");
+        return false;
+    }
+
+    outMips.pixelFormat = PF_B8G8R8A8;
+    outMips.sizes.Reset();
+    outMips.mips.Reset();
+    outMips.sizes.Add(FIntPoint(imageWrapper->GetWidth(), imageWrapper->GetHeight()));
+    outMips.mips.Add(*rawData);
+    return true;
+}
+
+bool FRuntimeMeshTextureBuilder::FromTexels_AnyThread(TArray<uint8>&& texels, const int32 width, const int32 height, FRuntimeMeshTextureMips& outMips)
+{
+    if (!IsValidTexelSize(texels.Num(), width, height))
+    {
+        RMIE_LOG(Error, "The texels do not match the size of the texture. Bytes: %d, Width: %d, Height: %d", texels.Num(), width, height);
+        return false;
+    }
+
+    outMips.pixelFormat = PF_B8G8R8A8;
+    outMips.sizes.Reset();
+    outMips.mips.Reset();
+    outMips.sizes.Add(FIntPoint(width, height));
+    outMips.mips.Add(MoveTemp(texels));
+    return true;
+}
+
+bool FRuntimeMeshTextureBuilder::ReadPixels(UTexture* texture, FRuntimeMeshTextureMips& outMips)
+{
+    if (!texture)
+    {
+        return false;
+    }
+
+    outMips.pixelFormat = PF_B8G8R8A8;
+    outMips.sizes.Reset();
+    outMips.mips.Reset();
+
+#if WITH_EDITORONLY_DATA
+    if (texture->Source.IsValid() && texture->Source.GetFormat() == TSF_BGRA8)
+    {
+        const FIntPoint size(texture->Source.GetSizeX(), texture->Source.GetSizeY());
+        const uint8* sourceData = texture->Source.LockMip(0);
+        if (sourceData)
+        {
+            outMips.sizes.Add(size);
+            outMips.mips.Emplace(sourceData, size.X * size.Y * 4);
+        }
+        texture->Source.UnlockMip(0);
+        return outMips.IsValid();
+    }
+#endif
+
+    UTexture2D* texture2D = Cast<UTexture2D>(texture);
+    if (!texture2D || !texture2D->PlatformData || texture2D->PlatformData->PixelFormat != PF_B8G8R8A8 || texture2D->PlatformData->Mips.Num() == 0)
+    {
+        return false;
+    }
+
+    FTexture2DMipMap& mip = texture2D->PlatformData->Mips[0];
+    if (!IsValidTexelSize(mip.BulkData.GetBulkDataSize(), mip.SizeX, mip.SizeY))
+    {
+        // The bulk data was already released after the upload
+        return false;
+    }
+    const uint8* mipData = static_cast<const uint8*>(mip.BulkData.LockReadOnly());
+    if (mipData)
+    {
+        outMips.sizes.Add(FIntPoint(mip.SizeX, mip.SizeY));
+        outMips.mips.Emplace(mipData, mip.SizeX * mip.SizeY * 4);
+    }
+    mip.BulkData.Unlock();
+    return outMips.IsValid();
+}
+
+bool FRuntimeMeshTextureBuilder::EncodeImage_AnyThread(const FRuntimeMeshTextureMips& mips, const ERuntimeMeshExportTextureFormat format, const int32 quality, TArray<uint8>& outFileBytes)
+{
+    check(mips.IsValid() && mips.pixelFormat == PF_B8G8R8A8);
+    IImageWrapperModule* imageWrapperModule = FModuleManager::GetModulePtr<IImageWrapperModule>(imageWrapperModuleName);
+    if (!imageWrapperModule)
+    {
+        RMIE_LOG(Error, "The ImageWrapper module is not loaded. Call LoadModules_GameThread before.");
+        return false;
+    }
+
+    TSharedPtr<IImageWrapper> imageWrapper = imageWrapperModule->CreateImageWrapper(format == ERuntimeMeshExportTextureFormat::JPG ? EImageFormat::JPEG : EImageFormat::PNG);
+    const FIntPoint& size = mips.sizes[0];
+    if (!imageWrapper.IsValid() || !imageWrapper->SetRaw(mips.mips[0].GetData(), mips.mips[0].Num(), size.X, size.Y, ERGBFormat::BGRA, 8))
+    {
+        RMIE_LOG(Error, "Failed to encode the image.");
+        return false;
+    }
+
+    const auto& compressed = imageWrapper->GetCompressed(format == ERuntimeMeshExportTextureFormat::JPG ? FMath::Clamp(quality, 1, 100) : 0);
+    outFileBytes = TArray<uint8>(compressed.GetData(), compressed.Num());
+    return outFileBytes.Num() > 0;
+}
+
+const TCHAR* FRuntimeMeshTextureBuilder::GetExtension(const ERuntimeMeshExportTextureFormat format)
+{
+    return format == ERuntimeMeshExportTextureFormat::JPG ? TEXT("jpg") : TEXT("png");
+}
+
+bool FRuntimeMeshTextureBuilder::IsValidTexelSize(const int64 numBytes, const int32 width, const int32 height)
+{
+    return width > 0 && height > 0 && numBytes == int64(width) * height * 4;
+}
+
+void FRuntimeMeshTextureBuilder::GenerateMips_AnyThread(FRuntimeMeshTextureMips& mips)
+{
+    check(mips.IsValid() && mips.pixelFormat == PF_B8G8R8A8);
+    mips.sizes.SetNum(1);
+    mips.mips.SetNum(1);
+
+    while (mips.sizes.Last().X > 1 || mips.sizes.Last().Y > 1)
+    {
+        const FIntPoint sourceSize = mips.sizes.Last();
+        const FIntPoint mipSize(FMath::Max(sourceSize.X / 2, 1), FMath::Max(sourceSize.Y / 2, 1));
+
+        TArray<uint8> mip;
+        mip.SetNumUninitialized(mipSize.X * mipSize.Y * 4);
+        const uint8* source = mips.mips.Last().GetData();
+        uint8* dest = mip.GetData();
+        for (int32 y = 0; y < mipSize.Y; ++y)
+        {
+            // Clamped, a side of 1 pixel is not halved
+            const int32 y0 = FMath::Min(y * 2, sourceSize.Y - 1);
+            const int32 y1 = FMath::Min(y * 2 + 1, sourceSize.Y - 1);
+            for (int32 x = 0; x < mipSize.X; ++x)
+            {
+                const int32 x0 = FMath::Min(x * 2, sourceSize.X - 1);
+                const int32 x1 = FMath::Min(x * 2 + 1, sourceSize.X - 1);
+                const uint8* p00 = source + (y0 * sourceSize.X + x0) * 4;
+                const uint8* p01 = source + (y0 * sourceSize.X + x1) * 4;
+                const uint8* p10 = source + (y1 * sourceSize.X + x0) * 4;
+                const uint8* p11 = source + (y1 * sourceSize.X + x1) * 4;
+                for (int32 channel = 0; channel < 4; ++channel)
+                {
+                    dest[channel] = (uint8)((p00[channel] + p01[channel] + p10[channel] + p11[channel] + 2) / 4);
+                }
+                dest += 4;
+            }
+        }
+
+        mips.sizes.Add(mipSize);
+        mips.mips.Add(MoveTemp(mip));
+    }
+}
+
+static EPixelFormat ResolveCompression(const FRuntimeMeshTextureMips& mips, const ERuntimeMeshImportTextureCompression compression)
+{
+    switch (compression)
+    {
+    case ERuntimeMeshImportTextureCompression::Auto:
+    {
+        // BC3 only when the alpha is used, BC1 is half the size
+        const TArray<uint8>& pixels = mips.mips[0];
+        for (int32 index = 3; index < pixels.Num(); index += 4)
+        {
+            if (pixels[index] != 255)
+            {
+                return PF_DXT5;
+            }
+        }
+        return PF_DXT1;
+    }
+    case ERuntimeMeshImportTextureCompression::BC1:
+        return PF_DXT1;
+    case ERuntimeMeshImportTextureCompression::BC3:
+        return PF_DXT5;
+    case ERuntimeMeshImportTextureCompression::BC4:
+        return PF_BC4;
+    case ERuntimeMeshImportTextureCompression::BC5:
+        return PF_BC5;
+    default:
+        checkNoEntry(); // None is handled by the caller, every other case must be handled
+    }
+    return PF_B8G8R8A8;
+}
+
+void FRuntimeMeshTextureBuilder::Compress_AnyThread(FRuntimeMeshTextureMips& mips, const ERuntimeMeshImportTextureCompression compression)
+{
+    check(mips.IsValid() && mips.pixelFormat == PF_B8G8R8A8);
+    if (compression == ERuntimeMeshImportTextureCompression::None)
+    {
+        return;
+    }
+
+    const FIntPoint size = mips.sizes[0];
+    if (size.X % 4 != 0 || size.Y % 4 != 0)
+    {
+        RMIE_LOG(Warning, "Texture of %dx%d is not a multiple of 4, it is not compressed.", size.X, size.Y);
+        return;
+    }
+
+    const EPixelFormat pixelFormat = ResolveCompression(mips, compression);
+    if (!GPixelFormats[pixelFormat].Supported)
+    {
+        RMIE_LOG(Warning, "The pixel format %s is not supported on this platform, the texture is not compressed.", GPixelFormats[pixelFormat].Name);
+        return;
+    }
+
+    TArray<uint8> blocks;
+    for (int32 mipIndex = 0; mipIndex < mips.mips.Num(); ++mipIndex)
+    {
+        FTextureBlockCompression::CompressImage(mips.mips[mipIndex].GetData(), mips.sizes[mipIndex].X, mips.sizes[mipIndex].Y, pixelFormat, blocks);
+        Swap(mips.mips[mipIndex], blocks);
+    }
+    mips.pixelFormat = pixelFormat;
+    // BC4 and BC5 hold data like roughness or normals, not colors
+    mips.bSRGB = pixelFormat != PF_BC4 && pixelFormat != PF_BC5;
+}
+
+UTexture2D* FRuntimeMeshTextureBuilder::CreateTexture_GameThread(FRuntimeMeshTextureMips&& mips)
+{
+    check(IsInGameThread());
+    if (!mips.IsValid())
+    {
+        return nullptr;
+    }
+
+    UTexture2D* texture = NewTransientTexture(mips.sizes[0], mips.pixelFormat);
+    texture->SRGB = mips.bSRGB;
+    for (int32 mipIndex = 0; mipIndex < mips.mips.Num(); ++mipIndex)
+    {
+        AddMip(texture, mips.sizes[mipIndex], mips.mips[mipIndex]);
+    }
+    mips.mips.Empty();
+    mips.sizes.Empty();
+
+    texture->UpdateResource();
+    return texture;
+}
+
+void FRuntimeMeshTextureBuilder::ReplaceMips_GameThread(UTexture2D* texture, FRuntimeMeshTextureMips&& mips)
+{
+    check(IsInGameThread());
+    if (!texture || !texture->PlatformData || !mips.IsValid())
+    {
+        return;
+    }
+
+    // The resource copies the mips when it is created, the old one does not read them anymore
+    FTexturePlatformData* platformData = texture->PlatformData;
+    platformData->Mips.Empty(mips.mips.Num());
+    platformData->SizeX = mips.sizes[0].X;
+    platformData->SizeY = mips.sizes[0].Y;
+    platformData->PixelFormat = mips.pixelFormat;
+    for (int32 mipIndex = 0; mipIndex < mips.mips.Num(); ++mipIndex)
+    {
+        AddMip(texture, mips.sizes[mipIndex], mips.mips[mipIndex]);
+    }
+    mips.mips.Empty();
+    mips.sizes.Empty();
+
+    texture->UpdateResource();
+}
+
+void FRuntimeMeshTextureBuilder::DropMips_GameThread(UTexture2D* texture, const int32 maxSize)
+{
+    check(IsInGameThread());
+    if (!texture || !texture->PlatformData)
+    {
+        return;
+    }
+
+    FTexturePlatformData* platformData = texture->PlatformData;
+    int32 numDropped = 0;
+    while (numDropped + 1 < platformData->Mips.Num() && FMath::Max(platformData->Mips[numDropped].SizeX, platformData->Mips[numDropped].SizeY) > maxSize)
+    {
+        ++numDropped;
+    }
+    if (numDropped == 0)
+    {
+        return;
+    }
+
+    platformData->Mips.RemoveAt(0, numDropped);
+    platformData->SizeX = platformData->Mips[0].SizeX;
+    platformData->SizeY = platformData->Mips[0].SizeY;
+    texture->UpdateResource();
+}
+
+void FRuntimeMeshTextureBuilder::DropMips_AnyThread(FRuntimeMeshTextureMips& mips, const int32 maxSize)
+{
+    int32 numDropped = 0;
+    while (numDropped + 1 < mips.sizes.Num() && FMath::Max(mips.sizes[numDropped].X, mips.sizes[numDropped].Y) > maxSize)
+    {
+        ++numDropped;
+    }
+    mips.sizes.RemoveAt(0, numDropped);
+    mips.mips.RemoveAt(0, numDropped);
+}
+
+namespace
+{
+    // "RMIT"
+    const uint32 mipFileMagic = 0x54494D52;
+    const uint32 mipFileVersion = 1;
+}
+
+bool FRuntimeMeshTextureBuilder::SaveMips_AnyThread(const FRuntimeMeshTextureMips& mips, const FString& file)
+{
+    if (!mips.IsValid())
+    {
+        return false;
+    }
+
+    // Streamed mip by mip, the chain of a large texture is not copied into one more buffer
+    const FString tempFile = FString::Printf(TEXT("%s.%s.tmp"), *file, *FGuid::NewGuid().ToString());
+    TUniquePtr<FArchive> writer(IFileManager::Get().CreateFileWriter(*tempFile));
+    if (!writer.IsValid())
+    {
+        RMIE_LOG(Warning, "Failed to create the mip file %s", *file);
+        return false;
+    }
+
+    uint32 magic = mipFileMagic;
+    uint32 version = mipFileVersion;
+    int32 pixelFormat = mips.pixelFormat;
+    uint8 bSRGB = mips.bSRGB;
+    int32 numMips = mips.mips.Num();
+    *writer << magic << version << pixelFormat << bSRGB << numMips;
+    for (int32 mipIndex = 0; mipIndex < numMips; ++mipIndex)
+    {
+        FIntPoint size = mips.sizes[mipIndex];
+        int64 numBytes = mips.mips[mipIndex].Num();
+        *writer << size << numBytes;
+        writer->Serialize(const_cast<uint8*>(mips.mips[mipIndex].GetData()), numBytes);
+    }
+    const bool bWritten = writer->Close() && !writer->IsError();
+    writer.Reset();
+
+    if (!bWritten || !IFileManager::Get().Move(*file, *tempFile, true, true))
+    {
+        RMIE_LOG(Warning, "Failed to write the mip file %s", *file);
+        IFileManager::Get().Delete(*tempFile, false, true, true);
+        return false;
+    }
+    return true;
+}
+
+bool FRuntimeMeshTextureBuilder::LoadMips_AnyThread(const FString& file, FRuntimeMeshTextureMips& outMips)
+{
+    RMIE_LLM_SCOPE(STAT_RMIE_LLM_DecodedTextures);
+    TUniquePtr<FArchive> reader(IFileManager::Get().CreateFileReader(*file, FILEREAD_Silent));
+    if (!reader.IsValid())
+    {
+        return false;
+    }
+
+    uint32 magic = 0;
+    uint32 version = 0;
+    int32 pixelFormat = 0;
+    uint8 bSRGB = 0;
+    int32 numMips = 0;
+    *reader << magic << version << pixelFormat << bSRGB << numMips;
+    if (reader->IsError() || magic != mipFileMagic || version != mipFileVersion || pixelFormat <= PF_Unknown || pixelFormat >= PF_MAX
+        || numMips <= 0 || numMips > MAX_TEXTURE_MIP_COUNT)
+    {
+        RMIE_LOG(Warning, "The mip file %s is broken or outdated.", *file);
+        return false;
+    }
+
+    FRuntimeMeshTextureMips mips;
+    mips.pixelFormat = EPixelFormat(pixelFormat);
+    mips.bSRGB = bSRGB != 0;
+    mips.sizes.SetNum(numMips);
+    mips.mips.SetNum(numMips);
+    for (int32 mipIndex = 0; mipIndex < numMips; ++mipIndex)
+    {
+        int64 numBytes = 0;
+        *reader << mips.sizes[mipIndex] << numBytes;
+        // Bounds checked, a broken file fails instead of allocating garbage
+        if (reader->IsError() || numBytes < 0 || numBytes > reader->TotalSize() - reader->Tell() || numBytes > MAX_int32)
+        {
+            RMIE_LOG(Warning, "The mip file %s is broken.", *file);
+            return false;
+        }
+        mips.mips[mipIndex].SetNumUninitialized(int32(numBytes));
+        reader->Serialize(mips.mips[mipIndex].GetData(), numBytes);
+    }
+    if (reader->IsError())
+    {
+        RMIE_LOG(Warning, "Failed to read the mip file %s", *file);
+        return false;
+    }
+
+    outMips = MoveTemp(mips);
+    return true;
+}
+
+UTexture2D* FRuntimeMeshTextureBuilder::CreateTextureFromTexels_GameThread(TArrayView<const uint8> texels, const int32 width, const int32 height)
+{
+    check(IsInGameThread());
+    if (!IsValidTexelSize(texels.Num(), width, height))
+    {
+        RMIE_LOG(Error, "The texels do not match the size of the texture. Bytes: %d, Width: %d, Height: %d", texels.Num(), width, height);
+        return nullptr;
+    }
+
+    UTexture2D* texture = NewTransientTexture(FIntPoint(width, height), PF_B8G8R8A8);
+    AddMip(texture, FIntPoint(width, height), texels);
+    texture->UpdateResource();
+    return texture;
+}
@@ -0,0 +1,95 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+class UTexture;
+class UTexture2D;
+
+/**
+ *	The pixels of a texture with its mip chain, ready to be copied to a UTexture2D.
+ *	Mip 0 is the full resolution.
+ */
+struct FRuntimeMeshTextureMips
+{
+    EPixelFormat pixelFormat = PF_B8G8R8A8;
+    // False for data textures like normal maps, set by Compress_AnyThread
+    bool bSRGB = true;
+    TArray<FIntPoint> sizes;
+    TArray<TArray<uint8>> mips;
+
+    bool IsValid() const
+    {
+        return mips.Num() > 0 && mips.Num() == sizes.Num();
+    }
+};
+
+/**
+ *	Builds textures in two steps. Everything expensive runs on any thread,
+ *	only the creation of the UTexture2D is left for the GameThread.
+ */
+struct FRuntimeMeshTextureBuilder
+{
+    // Loads the ImageWrapper module. Modules can only be loaded on the GameThread, call it before decoding on a worker.
+    static void LoadModules_GameThread();
+
+    // Decodes an image file (png, jpg, bmp, ...) to BGRA8. Returns false when the format is unknown or broken.
+    static bool DecodeImage_AnyThread(TArrayView<const uint8> fileBytes, FRuntimeMeshTextureMips& outMips);
+
+    /**
+     * Takes the raw texels of an embedded Assimp texture. aiTexel is BGRA8, so no conversion is needed.
+     * Returns false when the size of 'texels' does not match the dimensions.
+     */
+    static bool FromTexels_AnyThread(TArray<uint8>&& texels, const int32 width, const int32 height, FRuntimeMeshTextureMips& outMips);
+
+    // Adds the mips down to 1x1 to a BGRA8 texture that has only mip 0, with a 2x2 box filter
+    static void GenerateMips_AnyThread(FRuntimeMeshTextureMips& mips);
+
+    /**
+     * Block compresses all mips of a BGRA8 texture. Call it after GenerateMips_AnyThread.
+     * Leaves the texture uncompressed when the platform does not support the format or mip 0 is not a multiple of 4.
+     * Mips smaller than a block are padded to 4x4, as the GPU expects.
+     */
+    static void Compress_AnyThread(FRuntimeMeshTextureMips& mips, const ERuntimeMeshImportTextureCompression compression);
+
+    // Creates a transient texture from 'mips' and starts its upload to the GPU. The mip data is consumed.
+    static UTexture2D* CreateTexture_GameThread(FRuntimeMeshTextureMips&& mips);
+
+    // Replaces the mips of a texture of CreateTexture_GameThread with 'mips', which may have another size. The texture object stays the same.
+    static void ReplaceMips_GameThread(UTexture2D* texture, FRuntimeMeshTextureMips&& mips);
+
+    // Removes the mips of a texture of CreateTexture_GameThread that are larger than 'maxSize' on a side, the last mip is always kept
+    static void DropMips_GameThread(UTexture2D* texture, const int32 maxSize);
+
+    // Removes the mips larger than 'maxSize' on a side, the last mip is always kept
+    static void DropMips_AnyThread(FRuntimeMeshTextureMips& mips, const int32 maxSize);
+
+    // Writes all mips of 'mips' to 'file', replacing an existing file
+    static bool SaveMips_AnyThread(const FRuntimeMeshTextureMips& mips, const FString& file);
+
+    // Reads a file of SaveMips_AnyThread. Returns false for a missing or broken file.
+    static bool LoadMips_AnyThread(const FString& file, FRuntimeMeshTextureMips& outMips);
+
+    // Creates a transient texture with a single mip from BGRA8 texels, copies them once into the platform data
+    static UTexture2D* CreateTextureFromTexels_GameThread(TArrayView<const uint8> texels, const int32 width, const int32 height);
+
+    /**
+     * Copies mip 0 of 'texture' as BGRA8. Uses the source data in the editor and the platform data of uncompressed BGRA8 textures otherwise.
+     * Returns false for anything else, e.g. block compressed cooked textures.
+     */
+    static bool ReadPixels(UTexture* texture, FRuntimeMeshTextureMips& outMips);
+
+    // Encodes mip 0 of a BGRA8 texture to an image file. 'quality' is only used by JPG.
+    static bool EncodeImage_AnyThread(const FRuntimeMeshTextureMips& mips, const ERuntimeMeshExportTextureFormat format, const int32 quality, TArray<uint8>& outFileBytes);
+
+    // The file extension of 'format' without the dot
+    static const TCHAR* GetExtension(const ERuntimeMeshExportTextureFormat format);
+
+    // Whether 'numBytes' are BGRA8 texels of the dimensions
+    static bool IsValidTexelSize(const int64 numBytes, const int32 width, const int32 height);
+};
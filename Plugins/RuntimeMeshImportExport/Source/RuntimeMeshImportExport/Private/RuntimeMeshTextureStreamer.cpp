@@ -0,0 +1,158 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshTextureStreamer.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "RuntimeMeshTextureBuilder.h"
+#include "Async/Async.h"
+#include "Engine/Texture2D.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+
+static TUniquePtr<FRuntimeMeshTextureStreamer> textureStreamerInstance;
+
+// Seconds between the checks whether the streamed textures are rendered
+static const float textureStreamerInterval = 0.5f;
+
+FRuntimeMeshTextureStreamer& FRuntimeMeshTextureStreamer::Get()
+{
+    check(textureStreamerInstance.IsValid());
+    return *textureStreamerInstance;
+}
+
+void FRuntimeMeshTextureStreamer::Startup()
+{
+    textureStreamerInstance = MakeUnique<FRuntimeMeshTextureStreamer>();
+    textureStreamerInstance->tickHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(textureStreamerInstance.Get(), &FRuntimeMeshTextureStreamer::Tick)
+        , textureStreamerInterval);
+}
+
+void FRuntimeMeshTextureStreamer::Shutdown()
+{
+    if (textureStreamerInstance.IsValid())
+    {
+        FTicker::GetCoreTicker().RemoveTicker(textureStreamerInstance->tickHandle);
+    }
+    textureStreamerInstance.Reset();
+}
+
+void FRuntimeMeshTextureStreamer::SetSettings(const FRuntimeMeshImportTextureStreamingSettings& inSettings)
+{
+    FScopeLock lock(&settingsLock);
+    settings = inSettings;
+}
+
+FRuntimeMeshImportTextureStreamingSettings FRuntimeMeshTextureStreamer::GetSettings() const
+{
+    FScopeLock lock(&settingsLock);
+    return settings;
+}
+
+FString FRuntimeMeshTextureStreamer::PrepareMips_AnyThread(FRuntimeMeshTextureMips& mips, const uint64 contentHash)
+{
+    const FRuntimeMeshImportTextureStreamingSettings currentSettings = GetSettings();
+    if (!currentSettings.bEnabled || !mips.IsValid() || mips.mips.Num() < 2
+        || FMath::Max(mips.sizes[0].X, mips.sizes[0].Y) < currentSettings.minStreamedSize
+        || FMath::Max(mips.sizes[0].X, mips.sizes[0].Y) <= currentSettings.residentSize)
+    {
+        return FString();
+    }
+
+    FString directory = currentSettings.cacheDirectory;
+    if (FPaths::IsRelative(directory))
+    {
+        directory = FPaths::Combine(FPaths::ProjectSavedDir(), directory);
+    }
+    // The content hash contains the compression, so the file of an earlier session has the same mips
+    const FString mipFile = FPaths::Combine(directory, FString::Printf(TEXT("%016llx.rmit"), contentHash));
+    if (IFileManager::Get().FileSize(*mipFile) <= 0 && !FRuntimeMeshTextureBuilder::SaveMips_AnyThread(mips, mipFile))
+    {
+        // Without the file the texture can not come back, it keeps all mips
+        return FString();
+    }
+
+    FRuntimeMeshTextureBuilder::DropMips_AnyThread(mips, currentSettings.residentSize);
+    return mipFile;
+}
+
+void FRuntimeMeshTextureStreamer::Register_GameThread(UTexture2D* texture, const FString& mipFile)
+{
+    check(IsInGameThread());
+    if (texture && !mipFile.IsEmpty())
+    {
+        FEntry& entry = entries.AddDefaulted_GetRef();
+        entry.texture = texture;
+        entry.mipFile = mipFile;
+    }
+}
+
+bool FRuntimeMeshTextureStreamer::Tick(float deltaTime)
+{
+    const FRuntimeMeshImportTextureStreamingSettings currentSettings = GetSettings();
+    const double now = FApp::GetCurrentTime();
+    for (int32 entryIndex = entries.Num() - 1; entryIndex >= 0; --entryIndex)
+    {
+        FEntry& entry = entries[entryIndex];
+        UTexture2D* texture = entry.texture.Get();
+        if (!texture)
+        {
+            entries.RemoveAtSwap(entryIndex, 1, false);
+            continue;
+        }
+        if (entry.bLoading)
+        {
+            continue;
+        }
+
+        // The renderer stamps the resource every frame it draws the texture
+        const bool bRendered = texture->Resource && now - texture->Resource->LastRenderTime < currentSettings.evictSeconds;
+        if (bRendered && !entry.bFullChain)
+        {
+            entry.bLoading = true;
+            TWeakObjectPtr<UTexture2D> weakTexture(texture);
+            FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([weakTexture, mipFile = entry.mipFile]() {
+                FRuntimeMeshTextureMips mips;
+                const bool bLoaded = FRuntimeMeshTextureBuilder::LoadMips_AnyThread(mipFile, mips);
+                AsyncTask(ENamedThreads::GameThread, [weakTexture, mips = MoveTemp(mips), bLoaded]() mutable {
+                    if (textureStreamerInstance.IsValid())
+                    {
+                        textureStreamerInstance->OnMipsLoaded(weakTexture, MoveTemp(mips), bLoaded);
+                    }
+                });
+            });
+        }
+        else if (!bRendered && entry.bFullChain)
+        {
+            FRuntimeMeshTextureBuilder::DropMips_GameThread(texture, currentSettings.residentSize);
+            entry.bFullChain = false;
+        }
+    }
+    return true;
+}
+
+void FRuntimeMeshTextureStreamer::OnMipsLoaded(const TWeakObjectPtr<UTexture2D>& texture, FRuntimeMeshTextureMips&& mips, const bool bLoaded)
+{
+    check(IsInGameThread());
+    const int32 entryIndex = entries.IndexOfByPredicate([&texture](const FEntry& entry) {
+        return entry.texture == texture;
+    });
+    if (entryIndex == INDEX_NONE || !texture.IsValid())
+    {
+        return;
+    }
+
+    FEntry& entry = entries[entryIndex];
+    if (!bLoaded)
+    {
+        RMIE_LOG(Warning, "Failed to stream in the mips of %s, the texture keeps its resident mips. Mip file: %s", *texture->GetName(), *entry.mipFile);
+        entries.RemoveAtSwap(entryIndex, 1, false);
+        return;
+    }
+
+    FRuntimeMeshTextureBuilder::ReplaceMips_GameThread(texture.Get(), MoveTemp(mips));
+    entry.bLoading = false;
+    entry.bFullChain = true;
+}
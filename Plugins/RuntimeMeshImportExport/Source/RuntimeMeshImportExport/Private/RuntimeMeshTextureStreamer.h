@@ -0,0 +1,60 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Containers/Ticker.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+class UTexture2D;
+struct FRuntimeMeshTextureMips;
+
+/**
+ *	Streams the mips of large runtime textures by whether they are rendered, @see FRuntimeMeshImportTextureStreamingSettings.
+ *	A streamed texture starts with the mips up to the resident size. Once the renderer draws it, the full chain is read back
+ *	from its mip file on the import thread pool. When it was not drawn for a while, the large mips are dropped again.
+ *	The textures are only referenced weakly, a destroyed texture is forgotten.
+ */
+class FRuntimeMeshTextureStreamer
+{
+public:
+    // Is created and destroyed with the module
+    static FRuntimeMeshTextureStreamer& Get();
+    static void Startup();
+    static void Shutdown();
+
+    // Any thread
+    void SetSettings(const FRuntimeMeshImportTextureStreamingSettings& inSettings);
+    FRuntimeMeshImportTextureStreamingSettings GetSettings() const;
+
+    /**
+     *	When 'mips' is large enough to be streamed, makes sure its full chain is in its mip file and drops the mips above the resident size.
+     *	Any thread. Returns the mip file to register the texture with, empty when the texture is not streamed.
+     */
+    FString PrepareMips_AnyThread(FRuntimeMeshTextureMips& mips, const uint64 contentHash);
+
+    // Streams 'texture', created from the mips PrepareMips_AnyThread returned 'mipFile' for
+    void Register_GameThread(UTexture2D* texture, const FString& mipFile);
+
+private:
+    bool Tick(float deltaTime);
+    void OnMipsLoaded(const TWeakObjectPtr<UTexture2D>& texture, FRuntimeMeshTextureMips&& mips, const bool bLoaded);
+
+    struct FEntry
+    {
+        TWeakObjectPtr<UTexture2D> texture;
+        FString mipFile;
+        bool bFullChain = false;
+        bool bLoading = false;
+    };
+
+    mutable FCriticalSection settingsLock;
+    FRuntimeMeshImportTextureStreamingSettings settings;
+
+    TArray<FEntry> entries;
+    FDelegateHandle tickHandle;
+};
@@ -0,0 +1,517 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "RuntimeMeshThumbnailRenderer.h"
+#include "RuntimeMeshImportExport.h"
+#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshImportExportThreadPool.h"
+#include "RuntimeMeshDeferredRelease.h"
+#include "RuntimeMeshTextureBuilder.h"
+#include "Async/Async.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Materials/Material.h"
+#include "ProceduralMeshComponent.h"
+#include "Misc/SecureHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "RenderCommandFence.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+
+namespace
+{
+    FString GetThumbnailDirectory(const FString& cacheDirectory)
+    {
+        if (FPaths::IsRelative(cacheDirectory))
+        {
+            return FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / cacheDirectory);
+        }
+        return cacheDirectory;
+    }
+
+    // Everything that changes how a thumbnail looks. Part of the file names, so other settings don't pick up stale PNGs.
+    uint32 HashThumbnailSettings(const FRuntimeMeshThumbnailParam& param)
+    {
+        uint32 hash = GetTypeHash(param.resolution);
+        hash = HashCombine(hash, GetTypeHash(param.maxTriangles));
+        hash = HashCombine(hash, GetTypeHash(param.fieldOfView));
+        hash = HashCombine(hash, GetTypeHash(param.viewRotation.Pitch));
+        hash = HashCombine(hash, GetTypeHash(param.viewRotation.Yaw));
+        hash = HashCombine(hash, GetTypeHash(param.viewRotation.Roll));
+        hash = HashCombine(hash, GetTypeHash(uint8(param.captureSource)));
+        hash = HashCombine(hash, GetTypeHash(param.material ? param.material->GetPathName() : FString()));
+        return hash;
+    }
+
+    // A single merged mesh without textures is enough for a thumbnail
+    FRuntimeMeshImportParam MakeThumbnailImportParam(const FString& filePath)
+    {
+        FRuntimeMeshImportParam importParam;
+        importParam.file = filePath;
+        importParam.pathType = EPathType::Absolute;
+        importParam.importMethodMesh = EImportMethodMesh::Merge;
+        importParam.importMethodSection = EImportMethodSection::MergeSameMaterial;
+        importParam.bNormalizeScene = true;
+        importParam.vertexAttributes = int32(ERuntimeMeshImportVertexAttributes::Normals);
+        importParam.postProcess.preset = ERuntimeMeshImportPostProcessPreset::Fast;
+        importParam.bDeferTextureReads = true;
+        importParam.bUseTextureCache = false;
+        return importParam;
+    }
+}
+
+void URuntimeMeshThumbnailRenderer::BeginDestroy()
+{
+    // The running jobs only hold a weak pointer, their results are dropped
+    if (tickHandle.IsValid())
+    {
+        FTicker::GetCoreTicker().RemoveTicker(tickHandle);
+        tickHandle.Reset();
+    }
+    DestroyStage();
+    bIsRendering = false;
+
+    Super::BeginDestroy();
+}
+
+bool URuntimeMeshThumbnailRenderer::RenderThumbnails_Async_Cpp(UObject* worldContextObject, const TArray<FString>& files, const FRuntimeMeshThumbnailParam& inParam
+        , FRuntimeThumbnailFinished callbackThumbnail
+        , FRuntimeMeshImportExportProgressUpdate callbackProgress
+        , FRuntimeThumbnailBatchFinished callbackFinished)
+{
+    check(IsInGameThread());
+
+    if (bIsRendering)
+    {
+        RMIE_LOG(Warning, "Already rendering a batch of thumbnails!");
+        return false;
+    }
+
+    UWorld* world = GEngine ? GEngine->GetWorldFromContextObject(worldContextObject, EGetWorldErrorMode::LogAndReturnNull) : nullptr;
+    if (!world)
+    {
+        RMIE_LOG(Error, "No world to render the thumbnails in.");
+        return false;
+    }
+
+    if (files.Num() == 0)
+    {
+        callbackFinished.ExecuteIfBound();
+        return true;
+    }
+
+    param = inParam;
+    param.resolution = FMath::Clamp(param.resolution, 16, 2048);
+    param.maxTriangles = FMath::Max(param.maxTriangles, 100);
+    param.maxConcurrentImports = FMath::Max(param.maxConcurrentImports, 1);
+    param.batchSize = FMath::Clamp(param.batchSize, 1, 64);
+    param.fieldOfView = FMath::Clamp(param.fieldOfView, 5.f, 120.f);
+    settingsHash = HashThumbnailSettings(param);
+
+    if (!CreateStage(world))
+    {
+        DestroyStage();
+        return false;
+    }
+
+    // The PNG encoder is loaded on the GameThread, the workers use it
+    FRuntimeMeshTextureBuilder::LoadModules_GameThread();
+
+    delegateThumbnail = callbackThumbnail;
+    delegateProgress = callbackProgress;
+    delegateFinished = callbackFinished;
+
+    pendingFiles.Reset(files.Num());
+    for (const FString& file : files)
+    {
+        pendingFiles.Add(URuntimeMeshImportExportLibrary::ResolveImportFilePath(file, param.pathType));
+    }
+    readyFiles.Empty();
+    nextPendingIndex = 0;
+    numInFlight = 0;
+    numFinished = 0;
+
+    bIsRendering = true;
+    delegateProgress.ExecuteIfBound(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ImportingFiles, 0, pendingFiles.Num()));
+    tickHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &URuntimeMeshThumbnailRenderer::Tick));
+    StartPendingImports();
+    return true;
+}
+
+bool URuntimeMeshThumbnailRenderer::RenderThumbnails_Async(UObject* worldContextObject, const TArray<FString>& files, const FRuntimeMeshThumbnailParam& inParam
+        , FRuntimeThumbnailFinishedDyn thumbnailDelegate
+        , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
+        , FRuntimeThumbnailBatchFinishedDyn finishedDelegate)
+{
+    FRuntimeThumbnailFinished thumbnailDelegateRaw;
+    thumbnailDelegateRaw.BindLambda([thumbnailDelegate](const int32 fileIndex, const FString& pngFile) {
+        thumbnailDelegate.ExecuteIfBound(fileIndex, pngFile);
+    });
+
+    FRuntimeMeshImportExportProgressUpdate progressDelegateRaw;
+    progressDelegateRaw.BindLambda([progressDelegate](const FRuntimeMeshImportExportProgress& progress) {
+        progressDelegate.ExecuteIfBound(progress);
+    });
+
+    FRuntimeThumbnailBatchFinished finishedDelegateRaw;
+    finishedDelegateRaw.BindLambda([finishedDelegate]() {
+        finishedDelegate.ExecuteIfBound();
+    });
+
+    return RenderThumbnails_Async_Cpp(worldContextObject, files, inParam, thumbnailDelegateRaw, progressDelegateRaw, finishedDelegateRaw);
+}
+
+bool URuntimeMeshThumbnailRenderer::GetIsRendering() const
+{
+    return bIsRendering;
+}
+
+bool URuntimeMeshThumbnailRenderer::CreateStage(UWorld* world)
+{
+    FActorSpawnParameters spawnParameters;
+    spawnParameters.ObjectFlags = RF_Transient;
+    spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    stageActor = world->SpawnActor<AActor>(AActor::StaticClass(), FTransform(param.stageLocation), spawnParameters);
+    if (!stageActor)
+    {
+        RMIE_LOG(Error, "Failed to spawn the stage for the thumbnails.");
+        return false;
+    }
+
+    USceneComponent* root = NewObject<USceneComponent>(stageActor, NAME_None, RF_Transient);
+    stageActor->SetRootComponent(root);
+    root->SetWorldLocation(param.stageLocation);
+    root->RegisterComponent();
+
+    // Only captures when asked to, and only the mesh of the slot that is captured
+    captureComponent = NewObject<USceneCaptureComponent2D>(stageActor, NAME_None, RF_Transient);
+    captureComponent->bCaptureEveryFrame = false;
+    captureComponent->bCaptureOnMovement = false;
+    captureComponent->PrimitiveRenderMode = ESceneCapturePrimitiveRenderMode::PRM_UseShowOnlyList;
+    captureComponent->CaptureSource = param.captureSource;
+    captureComponent->FOVAngle = param.fieldOfView;
+    captureComponent->ShowFlags.SetFog(false);
+    captureComponent->ShowFlags.SetAtmosphericFog(false);
+    captureComponent->SetupAttachment(root);
+    captureComponent->RegisterComponent();
+
+    slots.SetNum(param.batchSize);
+    meshComponents.Reset(param.batchSize);
+    renderTargets.Reset(param.batchSize);
+    for (int32 slotIndex = 0; slotIndex < param.batchSize; ++slotIndex)
+    {
+        UProceduralMeshComponent* meshComponent = NewObject<UProceduralMeshComponent>(stageActor, NAME_None, RF_Transient);
+        meshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+        meshComponent->SetCastShadow(false);
+        meshComponent->SetVisibleInSceneCaptureOnly(true);
+        meshComponent->SetupAttachment(root);
+        meshComponent->RegisterComponent();
+        meshComponents.Add(meshComponent);
+
+        UTextureRenderTarget2D* renderTarget = NewObject<UTextureRenderTarget2D>(this, NAME_None, RF_Transient);
+        renderTarget->ClearColor = FLinearColor::Transparent;
+        renderTarget->InitCustomFormat(param.resolution, param.resolution, PF_B8G8R8A8, false);
+        renderTargets.Add(renderTarget);
+
+        slots[slotIndex] = FSlot();
+        slots[slotIndex].fence = MakeShared<FRenderCommandFence>();
+    }
+    return true;
+}
+
+void URuntimeMeshThumbnailRenderer::DestroyStage()
+{
+    // A read back that is still enqueued keeps its pixels alive, the render targets are released after it by the GC
+    if (stageActor && !stageActor->IsPendingKill())
+    {
+        stageActor->Destroy();
+    }
+    stageActor = nullptr;
+    captureComponent = nullptr;
+    meshComponents.Empty();
+    renderTargets.Empty();
+    slots.Empty();
+    readyFiles.Empty();
+}
+
+void URuntimeMeshThumbnailRenderer::StartPendingImports()
+{
+    check(IsInGameThread());
+
+    // Imported meshes wait for a slot, so don't import far ahead of the capture
+    while (nextPendingIndex < pendingFiles.Num() && numInFlight < param.maxConcurrentImports
+           && numInFlight + readyFiles.Num() < param.maxConcurrentImports + param.batchSize)
+    {
+        const int32 fileIndex = nextPendingIndex++;
+        ++numInFlight;
+
+        TWeakObjectPtr<URuntimeMeshThumbnailRenderer> weakThis(this);
+        const FString thumbnailDirectory = GetThumbnailDirectory(param.cacheDirectory);
+        FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([weakThis, fileIndex, filePath = pendingFiles[fileIndex], thumbnailDirectory
+                                                                 , maxTriangles = param.maxTriangles, hash = settingsHash]()
+        {
+            auto finish = [weakThis, fileIndex](const FString& pngFile, const bool bCached, FRuntimeMeshImportResultPtr result)
+            {
+                AsyncTask(ENamedThreads::GameThread, [weakThis, fileIndex, pngFile, bCached, result]()
+                {
+                    if (URuntimeMeshThumbnailRenderer* renderer = weakThis.Get())
+                    {
+                        renderer->OnFilePrepared(fileIndex, pngFile, bCached, result);
+                    }
+                });
+            };
+
+            const FMD5Hash fileHash = FMD5Hash::HashFile(*filePath);
+            if (!fileHash.IsValid())
+            {
+                RMIE_LOG(Warning, "Thumbnail: Failed to read %s", *filePath);
+                finish(FString(), false, nullptr);
+                return;
+            }
+
+            const FString pngFile = thumbnailDirectory / FString::Printf(TEXT("%s_%08x.png"), *LexToString(fileHash), hash);
+            if (IFileManager::Get().FileExists(*pngFile))
+            {
+                finish(pngFile, true, nullptr);
+                return;
+            }
+
+            FRuntimeMeshImportParam importParam = MakeThumbnailImportParam(filePath);
+            FRuntimeMeshImportSummary summary;
+            URuntimeMeshImportExportLibrary::ProbeScene_AnyThread(importParam, summary);
+            if (!summary.bSuccess)
+            {
+                finish(FString(), false, nullptr);
+                return;
+            }
+            if (summary.numTriangles > maxTriangles)
+            {
+                FRuntimeMeshImportLODSetting& lod = importParam.lodSettings.AddDefaulted_GetRef();
+                lod.triangleRatio = FMath::Clamp(float(double(maxTriangles) / double(summary.numTriangles)), 0.001f, 1.f);
+            }
+
+            FRuntimeMeshImportResultRef result = FRuntimeMeshDeferredRelease::MakeImportResult();
+            URuntimeMeshImportExportLibrary::ImportSceneWithParam(importParam, *result);
+            if (!result->bSuccess)
+            {
+                finish(FString(), false, nullptr);
+                return;
+            }
+
+            // Only the simplified LOD is shown
+            for (FRuntimeMeshImportMeshInfo& meshInfo : result->meshInfos)
+            {
+                if (meshInfo.lods.Num() > 0)
+                {
+                    meshInfo.sections = MoveTemp(meshInfo.lods[0].sections);
+                    meshInfo.lods.Empty();
+                }
+            }
+            finish(pngFile, false, result);
+        });
+    }
+}
+
+void URuntimeMeshThumbnailRenderer::OnFilePrepared(const int32 fileIndex, const FString& pngFile, const bool bCached, FRuntimeMeshImportResultPtr result)
+{
+    check(IsInGameThread());
+
+    if (!bIsRendering)
+    {
+        return;
+    }
+
+    --numInFlight;
+    if (bCached || !result.IsValid())
+    {
+        OnFileFinished(fileIndex, pngFile);
+        return;
+    }
+
+    FReadyFile& readyFile = readyFiles.AddDefaulted_GetRef();
+    readyFile.fileIndex = fileIndex;
+    readyFile.pngFile = pngFile;
+    readyFile.result = result;
+}
+
+void URuntimeMeshThumbnailRenderer::OnFileFinished(const int32 fileIndex, const FString& pngFile)
+{
+    check(IsInGameThread());
+
+    if (!bIsRendering)
+    {
+        return;
+    }
+
+    ++numFinished;
+    delegateThumbnail.ExecuteIfBound(fileIndex, pngFile);
+    delegateProgress.ExecuteIfBound(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::ImportingFiles, numFinished, pendingFiles.Num()));
+
+    if (numFinished == pendingFiles.Num())
+    {
+        FinishBatch();
+    }
+}
+
+bool URuntimeMeshThumbnailRenderer::Tick(float deltaTime)
+{
+    check(IsInGameThread());
+
+    if (!bIsRendering || !stageActor)
+    {
+        return true;
+    }
+
+    UMaterialInterface* material = param.material ? param.material : UMaterial::GetDefaultMaterial(MD_Surface);
+    for (int32 slotIndex = 0; slotIndex < slots.Num(); ++slotIndex)
+    {
+        FSlot& slot = slots[slotIndex];
+
+        // The read back is done, the PNG is encoded and written on a worker
+        if (slot.state == ESlotState::Capturing && slot.fence->IsFenceComplete())
+        {
+            TWeakObjectPtr<URuntimeMeshThumbnailRenderer> weakThis(this);
+            FRuntimeMeshImportExportThreadPool::Get().Run_AnyThread([weakThis, fileIndex = slot.fileIndex, pngFile = slot.pngFile
+                                                                     , pixels = slot.pixels, resolution = param.resolution]()
+            {
+                FRuntimeMeshTextureMips mips;
+                mips.pixelFormat = PF_B8G8R8A8;
+                mips.sizes.Add(FIntPoint(resolution, resolution));
+                TArray<uint8>& mip = mips.mips.AddDefaulted_GetRef();
+                mip.SetNumUninitialized(pixels->Num() * sizeof(FColor));
+                FColor* outPixels = reinterpret_cast<FColor*>(mip.GetData());
+                for (int32 pixel = 0; pixel < pixels->Num(); ++pixel)
+                {
+                    // The scene color has no meaningful alpha
+                    outPixels[pixel] = (*pixels)[pixel];
+                    outPixels[pixel].A = 255;
+                }
+
+                TArray<uint8> pngBytes;
+                bool bSaved = false;
+                if (pixels->Num() == resolution * resolution
+                    && FRuntimeMeshTextureBuilder::EncodeImage_AnyThread(mips, ERuntimeMeshExportTextureFormat::PNG, 0, pngBytes))
+                {
+                    IFileManager::Get().MakeDirectory(*FPaths::GetPath(pngFile), true);
+                    bSaved = FFileHelper::SaveArrayToFile(pngBytes, *pngFile);
+                }
+                if (!bSaved)
+                {
+                    RMIE_LOG(Warning, "Thumbnail: Failed to write %s", *pngFile);
+                }
+
+                AsyncTask(ENamedThreads::GameThread, [weakThis, fileIndex, pngFile = bSaved ? pngFile : FString()]()
+                {
+                    if (URuntimeMeshThumbnailRenderer* renderer = weakThis.Get())
+                    {
+                        renderer->OnFileFinished(fileIndex, pngFile);
+                    }
+                });
+            });
+
+            meshComponents[slotIndex]->ClearAllMeshSections();
+            slot.pixels.Reset();
+            slot.state = ESlotState::Free;
+        }
+
+        // The mesh was applied in an earlier frame, so its render state exists
+        if (slot.state == ESlotState::Applied && GFrameCounter > slot.appliedFrame)
+        {
+            CaptureSlot(slotIndex);
+        }
+
+        if (slot.state == ESlotState::Free && readyFiles.Num() > 0)
+        {
+            FReadyFile readyFile = MoveTemp(readyFiles[0]);
+            readyFiles.RemoveAt(0, 1, false);
+
+            slot.state = ESlotState::Applying;
+            slot.fileIndex = readyFile.fileIndex;
+            slot.pngFile = readyFile.pngFile;
+            slot.bounds = FBox(ForceInit);
+            for (const FRuntimeMeshImportMeshInfo& meshInfo : readyFile.result->meshInfos)
+            {
+                slot.bounds += meshInfo.bounds;
+            }
+
+            TWeakObjectPtr<URuntimeMeshThumbnailRenderer> weakThis(this);
+            TWeakObjectPtr<UProceduralMeshComponent> weakComponent(meshComponents[slotIndex]);
+            FRuntimeImportExportGameThreadDone callbackApplied;
+            callbackApplied.BindLambda([weakThis, weakComponent, slotIndex, material]()
+            {
+                URuntimeMeshThumbnailRenderer* renderer = weakThis.Get();
+                UProceduralMeshComponent* meshComponent = weakComponent.Get();
+                if (!renderer || !meshComponent || !renderer->slots.IsValidIndex(slotIndex))
+                {
+                    return;
+                }
+                for (int32 section = 0; section < meshComponent->GetNumSections(); ++section)
+                {
+                    meshComponent->SetMaterial(section, material);
+                }
+                FSlot& appliedSlot = renderer->slots[slotIndex];
+                appliedSlot.state = ESlotState::Applied;
+                appliedSlot.appliedFrame = GFrameCounter;
+            });
+            URuntimeMeshImportExportLibrary::ApplyImportResultToProceduralMesh_Async_Cpp(meshComponents[slotIndex], MoveTemp(*readyFile.result), TArray<UMaterialInterface*>()
+                                                                                         , callbackApplied);
+        }
+    }
+
+    StartPendingImports();
+    return true;
+}
+
+void URuntimeMeshThumbnailRenderer::CaptureSlot(const int32 slotIndex)
+{
+    FSlot& slot = slots[slotIndex];
+    UTextureRenderTarget2D* renderTarget = renderTargets[slotIndex];
+
+    // Frame the bounding sphere of the mesh
+    const FVector center = param.stageLocation + (slot.bounds.IsValid ? slot.bounds.GetCenter() : FVector::ZeroVector);
+    const float radius = slot.bounds.IsValid ? FMath::Max(slot.bounds.GetExtent().Size(), KINDA_SMALL_NUMBER) : 1.f;
+    const float distance = radius / FMath::Sin(FMath::DegreesToRadians(param.fieldOfView * 0.5f));
+    captureComponent->SetWorldLocationAndRotation(center - param.viewRotation.Vector() * distance, param.viewRotation);
+
+    captureComponent->ShowOnlyComponents.Reset();
+    captureComponent->ShowOnlyComponent(meshComponents[slotIndex]);
+    captureComponent->TextureTarget = renderTarget;
+    captureComponent->CaptureScene();
+
+    // Enqueued after the capture, the fence tells when the pixels are there without waiting for the RenderThread
+    slot.pixels = MakeShared<TArray<FColor>, ESPMode::ThreadSafe>();
+    FTextureRenderTargetResource* resource = renderTarget->GameThread_GetRenderTargetResource();
+    ENQUEUE_RENDER_COMMAND(RuntimeMeshReadBackThumbnail)([resource, pixels = slot.pixels](FRHICommandListImmediate& RHICmdList)
+    {
+        const FIntPoint size = resource->GetSizeXY();
+        RHICmdList.ReadSurfaceData(resource->GetRenderTargetTexture(), FIntRect(0, 0, size.X, size.Y), *pixels, FReadSurfaceDataFlags(RCM_UNorm));
+    });
+    slot.fence->BeginFence();
+    slot.state = ESlotState::Capturing;
+}
+
+void URuntimeMeshThumbnailRenderer::FinishBatch()
+{
+    // Reset everything before the callback, so a new batch can be started from within it
+    FRuntimeThumbnailBatchFinished callbackFinished = delegateFinished;
+    delegateThumbnail.Unbind();
+    delegateProgress.Unbind();
+    delegateFinished.Unbind();
+    if (tickHandle.IsValid())
+    {
+        FTicker::GetCoreTicker().RemoveTicker(tickHandle);
+        tickHandle.Reset();
+    }
+    pendingFiles.Empty();
+    DestroyStage();
+    bIsRendering = false;
+
+    callbackFinished.ExecuteIfBound();
+}
@@ -0,0 +1,212 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#include "TextureBlockCompression.h"
+
+namespace
+{
+    FORCEINLINE uint16 ToRGB565(const uint8* bgr)
+    {
+        return ((bgr[2] >> 3) << 11) | ((bgr[1] >> 2) << 5) | (bgr[0] >> 3);
+    }
+
+    // To BGR888 with the low bits replicated, the way the GPU decodes it
+    FORCEINLINE void FromRGB565(const uint16 color, int32* outBgr)
+    {
+        const int32 r = (color >> 11) & 0x1F;
+        const int32 g = (color >> 5) & 0x3F;
+        const int32 b = color & 0x1F;
+        outBgr[0] = (b << 3) | (b >> 2);
+        outBgr[1] = (g << 2) | (g >> 4);
+        outBgr[2] = (r << 3) | (r >> 2);
+    }
+
+    FORCEINLINE void WriteUint16(uint8* out, const uint16 value)
+    {
+        out[0] = value & 0xFF;
+        out[1] = value >> 8;
+    }
+}
+
+void FTextureBlockCompression::EncodeBC1(const uint8* pixels, uint8* outBlock)
+{
+    uint8 minColor[3] = { 255, 255, 255 };
+    uint8 maxColor[3] = { 0, 0, 0 };
+    for (int32 pixel = 0; pixel < 16; ++pixel)
+    {
+        for (int32 channel = 0; channel < 3; ++channel)
+        {
+            minColor[channel] = FMath::Min(minColor[channel], pixels[pixel * 4 + channel]);
+            maxColor[channel] = FMath::Max(maxColor[channel], pixels[pixel * 4 + channel]);
+        }
+    }
+
+    // Insetting the box by 1/16 of its size lowers the error of the interpolated colors
+    for (int32 channel = 0; channel < 3; ++channel)
+    {
+        const int32 inset = (maxColor[channel] - minColor[channel]) >> 4;
+        minColor[channel] = FMath::Min(minColor[channel] + inset, 255);
+        maxColor[channel] = FMath::Max(maxColor[channel] - inset, 0);
+    }
+
+    uint16 color0 = ToRGB565(maxColor);
+    uint16 color1 = ToRGB565(minColor);
+    // color0 > color1 selects the four color mode
+    if (color0 < color1)
+    {
+        Swap(color0, color1);
+    }
+    WriteUint16(outBlock, color0);
+    WriteUint16(outBlock + 2, color1);
+
+    uint32 indices = 0;
+    if (color0 != color1)
+    {
+        int32 palette[4][3];
+        FromRGB565(color0, palette[0]);
+        FromRGB565(color1, palette[1]);
+        for (int32 channel = 0; channel < 3; ++channel)
+        {
+            palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+            palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+        }
+
+        for (int32 pixel = 0; pixel < 16; ++pixel)
+        {
+            const uint8* bgr = pixels + pixel * 4;
+            uint32 bestIndex = 0;
+            int32 bestDistance = MAX_int32;
+            for (uint32 index = 0; index < 4; ++index)
+            {
+                const int32 db = bgr[0] - palette[index][0];
+                const int32 dg = bgr[1] - palette[index][1];
+                const int32 dr = bgr[2] - palette[index][2];
+                const int32 distance = db * db + dg * dg + dr * dr;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+            indices |= bestIndex << (pixel * 2);
+        }
+    }
+
+    outBlock[4] = indices & 0xFF;
+    outBlock[5] = (indices >> 8) & 0xFF;
+    outBlock[6] = (indices >> 16) & 0xFF;
+    outBlock[7] = (indices >> 24) & 0xFF;
+}
+
+void FTextureBlockCompression::EncodeBC3(const uint8* pixels, uint8* outBlock)
+{
+    EncodeBC4(pixels, 3, outBlock);
+    EncodeBC1(pixels, outBlock + 8);
+}
+
+void FTextureBlockCompression::EncodeBC4(const uint8* pixels, const int32 channel, uint8* outBlock)
+{
+    uint8 minValue = 255;
+    uint8 maxValue = 0;
+    for (int32 pixel = 0; pixel < 16; ++pixel)
+    {
+        minValue = FMath::Min(minValue, pixels[pixel * 4 + channel]);
+        maxValue = FMath::Max(maxValue, pixels[pixel * 4 + channel]);
+    }
+
+    // value0 > value1 selects the eight value mode
+    outBlock[0] = maxValue;
+    outBlock[1] = minValue;
+
+    uint64 indices = 0;
+    if (maxValue != minValue)
+    {
+        int32 palette[8];
+        palette[0] = maxValue;
+        palette[1] = minValue;
+        for (int32 index = 2; index < 8; ++index)
+        {
+            palette[index] = ((8 - index) * maxValue + (index - 1) * minValue) / 7;
+        }
+
+        for (int32 pixel = 0; pixel < 16; ++pixel)
+        {
+            const int32 value = pixels[pixel * 4 + channel];
+            uint64 bestIndex = 0;
+            int32 bestDistance = MAX_int32;
+            for (int32 index = 0; index < 8; ++index)
+            {
+                const int32 distance = FMath::Abs(value - palette[index]);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+            indices |= bestIndex << (pixel * 3);
+        }
+    }
+
+    for (int32 byteIndex = 0; byteIndex < 6; ++byteIndex)
+    {
+        outBlock[2 + byteIndex] = (indices >> (byteIndex * 8)) & 0xFF;
+    }
+}
+
+void FTextureBlockCompression::EncodeBC5(const uint8* pixels, uint8* outBlock)
+{
+    EncodeBC4(pixels, 2, outBlock);
+    EncodeBC4(pixels, 1, outBlock + 8);
+}
+
+bool FTextureBlockCompression::IsSupportedFormat(const EPixelFormat pixelFormat)
+{
+    return pixelFormat == PF_DXT1 || pixelFormat == PF_DXT5 || pixelFormat == PF_BC4 || pixelFormat == PF_BC5;
+}
+
+void FTextureBlockCompression::CompressImage(const uint8* bgra, const int32 width, const int32 height, const EPixelFormat pixelFormat, TArray<uint8>& outBlocks)
+{
+    check(IsSupportedFormat(pixelFormat));
+    const int32 blockBytes = (pixelFormat == PF_DXT1 || pixelFormat == PF_BC4) ? 8 : 16;
+    const int32 numBlocksX = FMath::DivideAndRoundUp(width, 4);
+    const int32 numBlocksY = FMath::DivideAndRoundUp(height, 4);
+    outBlocks.SetNumUninitialized(numBlocksX * numBlocksY * blockBytes);
+
+    uint8 blockPixels[16 * 4];
+    uint8* out = outBlocks.GetData();
+    for (int32 blockY = 0; blockY < numBlocksY; ++blockY)
+    {
+        for (int32 blockX = 0; blockX < numBlocksX; ++blockX)
+        {
+            for (int32 y = 0; y < 4; ++y)
+            {
+                const int32 sourceY = FMath::Min(blockY * 4 + y, height - 1);
+                for (int32 x = 0; x < 4; ++x)
+                {
+                    const int32 sourceX = FMath::Min(blockX * 4 + x, width - 1);
+                    FMemory::Memcpy(&blockPixels[(y * 4 + x) * 4], &bgra[(sourceY * width + sourceX) * 4], 4);
+                }
+            }
+
+            switch (pixelFormat)
+            {
+            case PF_DXT1:
+                EncodeBC1(blockPixels, out);
+                break;
+            case PF_DXT5:
+                EncodeBC3(blockPixels, out);
+                break;
+            case PF_BC4:
+                EncodeBC4(blockPixels, 2, out);
+                break;
+            case PF_BC5:
+                EncodeBC5(blockPixels, out);
+                break;
+            default:
+                checkNoEntry();
+            }
+            out += blockBytes;
+        }
+    }
+}
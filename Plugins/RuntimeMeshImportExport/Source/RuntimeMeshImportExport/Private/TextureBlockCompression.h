@@ -0,0 +1,37 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PixelFormat.h"
+
+/**
+ *	Runtime block compression of BGRA8 pixels to BC1, BC3, BC4 and BC5.
+ *	The engine only ships its encoders with the editor, so these are simple range fit encoders:
+ *	the endpoints are the slightly inset bounding box of the block, each pixel picks the closest palette entry.
+ *	Fast enough for imports, the quality is below an offline encoder.
+ *
+ *	Blocks are 4x4 pixels in rows, 'pixels' always point to 16 BGRA8 pixels.
+ */
+struct FTextureBlockCompression
+{
+    // 8 bytes
+    static void EncodeBC1(const uint8* pixels, uint8* outBlock);
+    // 16 bytes, the alpha block followed by a BC1 block
+    static void EncodeBC3(const uint8* pixels, uint8* outBlock);
+    // 8 bytes. 'channel' is the byte offset in the BGRA8 pixel, 2 for red.
+    static void EncodeBC4(const uint8* pixels, const int32 channel, uint8* outBlock);
+    // 16 bytes, a BC4 block of red followed by one of green
+    static void EncodeBC5(const uint8* pixels, uint8* outBlock);
+
+    // PF_DXT1, PF_DXT5, PF_BC4 or PF_BC5
+    static bool IsSupportedFormat(const EPixelFormat pixelFormat);
+
+    /**
+     *	Compresses a BGRA8 image to 'pixelFormat'. The size of 'outBlocks' is ceil(width / 4) * ceil(height / 4) blocks.
+     *	Blocks at the border repeat the last row and column.
+     */
+    static void CompressImage(const uint8* bgra, const int32 width, const int32 height, const EPixelFormat pixelFormat, TArray<uint8>& outBlocks);
+};
@@ -4,33 +4,36 @@
 #include <Assimp/ProgressHandler.hpp>
 #include "RuntimeMeshImportExportTypes.h"
 #include "Async/Async.h"
-#include "RuntimeMeshImportExportLibrary.h"
+#include "RuntimeMeshImportExportProgressCoalescer.h"
 
 class FAssimpProgressHandler : public Assimp::ProgressHandler
 {
 public:
-	FAssimpProgressHandler(FRuntimeMeshImportExportProgressUpdate& inDelegateProgress) : delegateProgress(inDelegateProgress) {}
-	FRuntimeMeshImportExportProgressUpdate delegateProgress;
+	FAssimpProgressHandler(const FRuntimeMeshImportExportProgressCoalescerRef& inProgress, const FRuntimeMeshImportExportCancellationToken& inCancellationToken = FRuntimeMeshImportExportCancellationToken())
+		: progress(inProgress), cancellationToken(inCancellationToken) {}
+	FRuntimeMeshImportExportProgressCoalescerRef progress;
+	FRuntimeMeshImportExportCancellationToken cancellationToken;
 
+	// Returning false tells Assimp to abort
 	virtual bool Update(float percentage = -1.f) override
 	{
-		URuntimeMeshImportExportLibrary::SendProgress_AnyThread(delegateProgress, FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::Unknown, 100 * percentage, 100));
-		return true;
+		progress->Send_AnyThread(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::Unknown, 100 * percentage, 100));
+		return !cancellationToken.IsCancelled();
 	}
 
 	virtual void UpdateFileRead(int currentStep, int numberOfSteps) override
 	{
-		URuntimeMeshImportExportLibrary::SendProgress_AnyThread(delegateProgress, FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::AssimpFileRead, currentStep, numberOfSteps));
+		progress->Send_AnyThread(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::AssimpFileRead, currentStep, numberOfSteps));
 	}
 
 	virtual void UpdatePostProcess(int currentStep, int numberOfSteps) override
 	{
-		URuntimeMeshImportExportLibrary::SendProgress_AnyThread(delegateProgress, FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::AssimpPostProcess, currentStep, numberOfSteps));
+		progress->Send_AnyThread(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::AssimpPostProcess, currentStep, numberOfSteps));
 	}
 
 	virtual void UpdateFileWrite(int currentStep, int numberOfSteps) override
 	{
-		URuntimeMeshImportExportLibrary::SendProgress_AnyThread(delegateProgress, FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::AssimpFileWrite, currentStep, numberOfSteps));
+		progress->Send_AnyThread(FRuntimeMeshImportExportProgress(ERuntimeMeshImportExportProgressType::AssimpFileWrite, currentStep, numberOfSteps));
 	}
 
 };
\ No newline at end of file
@@ -41,4 +41,62 @@ public:
     UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "MeshExportable")
     bool GetMeshData(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSection>& outSectionData) const;
 
+    /**
+     *	Return true when GetMeshData may be called from worker threads, e.g. because it only copies cached buffers.
+     *	Those exportables are gathered in parallel instead of on the GameThread ticks. Only C++ implementations can opt in,
+     *	exportables implemented in Blueprint are always gathered on the GameThread.
+     */
+    virtual bool IsThreadSafeGather() const
+    {
+        return false;
+    }
+
+    /**
+     *	Return true to be gathered with GetMeshDataViews instead of GetMeshData, so the exporter reads the buffers
+     *	of the exportable and transforms them into its own storage without copying them first. Only C++ implementations can opt in.
+     */
+    virtual bool HasMeshDataViews() const
+    {
+        return false;
+    }
+
+    // Same as GetMeshData, but returns views into the buffers of the exportable, @see FExportableMeshSectionView for their lifetime
+    virtual bool GetMeshDataViews(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSectionView>& outSectionViews) const
+    {
+        return false;
+    }
+
+    /**
+     *	Return a stamp that changes whenever the data returned by GetMeshData or GetMeshDataViews changes, including 'meshToWorld'.
+     *	While all exportables of a node return the same stamps as in the last export, the exporter reuses the meshes it built for the node
+     *	and does not gather them again. 0 means unknown, the exportable is gathered on every export. Only C++ implementations can opt in.
+     */
+    virtual int64 GetMeshDataVersion() const
+    {
+        return 0;
+    }
+
+    /**
+     *	Return a key that is the same for all exportables whose GetMeshData returns the same sections relative to 'outMeshToWorld',
+     *	e.g. the address of the UStaticMesh they show with the LOD, or a hash of its content. 'outMeshToWorld' places this exportable.
+     *	With FRuntimeMeshExportParam::bShareIdenticalMeshes the meshes of a key are exported once and the exportables after the first are not gathered.
+     *	0 means the geometry is not shared. Only C++ implementations can opt in.
+     */
+    virtual uint64 GetSharedMeshKey(const int32 forLod, FTransform& outMeshToWorld) const
+    {
+        return 0;
+    }
+
+    /**
+     *	Return true for an exportable that shows its mesh many times, e.g. an instanced static mesh component. The sections of GetMeshData
+     *	or GetMeshDataViews are then in the space of the instances, their 'meshToWorld' is relative to an instance, and 'outInstanceToWorld'
+     *	places each instance. The meshes are exported once, as a node per instance that references them, or with EXT_mesh_gpu_instancing
+     *	by the plugin's glTF writer. An instanced exportable without instances returns false. Called on the GameThread before the gather.
+     *	Only C++ implementations can opt in.
+     */
+    virtual bool GetInstanceTransforms(const int32 forLod, TArray<FTransform>& outInstanceToWorld) const
+    {
+        return false;
+    }
+
 };
@@ -0,0 +1,96 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshBatchImporter.generated.h"
+
+class FQueuedThreadPool;
+
+DECLARE_DELEGATE_TwoParams(FRuntimeBatchImportFileFinished, const int32 /*fileIndex*/, FRuntimeMeshImportResultRef /*result*/);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FRuntimeBatchImportFileFinishedDyn, int32, fileIndex, const FRuntimeMeshImportResult&, result);
+DECLARE_DELEGATE(FRuntimeBatchImportFinished);
+DECLARE_DYNAMIC_DELEGATE(FRuntimeBatchImportFinishedDyn);
+
+/**
+ *	Imports many files concurrently on a bounded pool of worker threads.
+ *
+ *	The files are started in the order they are passed in. Each result is delivered on the GameThread
+ *	as soon as its file is done, so the order of the results depends on the duration of the imports.
+ *	The progress reports the number of finished files with type ERuntimeMeshImportExportProgressType::ImportingFiles.
+ *	Only one batch can be imported at a time per importer.
+ */
+UCLASS(BlueprintType)
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshBatchImporter : public UObject
+{
+    GENERATED_BODY()
+public:
+
+    virtual void BeginDestroy() override;
+
+    /**
+     *	Imports the files asynchronous. Must be called on the GameThread.
+     *
+     *	@param params				One entry per file to import
+     *	@param batchParam			Limits for the batch
+     *	@param callbackFileFinished	Fired for each file when its import is done. 'fileIndex' is the index in 'params'
+     *	@param callbackProgress		Fired when a file is done
+     *	@param callbackFinished		Fired after all files are done
+     *	@returns					false when a batch is already being imported
+     */
+    bool ImportBatch_Async_Cpp(const TArray<FRuntimeMeshImportParam>& params, const FRuntimeMeshBatchImportParam& batchParam
+                               , FRuntimeBatchImportFileFinished callbackFileFinished
+                               , FRuntimeMeshImportExportProgressUpdate callbackProgress
+                               , FRuntimeBatchImportFinished callbackFinished);
+
+    /**
+     *	Imports the files asynchronous.
+     *
+     *	@param params				One entry per file to import
+     *	@param batchParam			Limits for the batch
+     *	@param fileFinishedDelegate	Fired for each file when its import is done. 'fileIndex' is the index in 'params'
+     *	@param progressDelegate		Fired when a file is done
+     *	@param finishedDelegate		Fired after all files are done
+     *	@returns					false when a batch is already being imported
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    bool ImportBatch_Async(const TArray<FRuntimeMeshImportParam>& params, const FRuntimeMeshBatchImportParam& batchParam
+                           , FRuntimeBatchImportFileFinishedDyn fileFinishedDelegate
+                           , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
+                           , FRuntimeBatchImportFinishedDyn finishedDelegate);
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    bool GetIsImporting() const;
+
+private:
+    struct FPendingFile
+    {
+        int32 fileIndex = INDEX_NONE;
+        FRuntimeMeshImportParam param;
+        int64 estimatedBytes = 0;
+    };
+
+    // Starts pending files as long as the limits of the batch allow it
+    void StartPendingImports();
+    void OnFileFinished(const int32 fileIndex, const int64 estimatedBytes, FRuntimeMeshImportResultRef result);
+    void FinishBatch();
+    void DestroyThreadPool();
+
+    FQueuedThreadPool* threadPool = nullptr;
+    FRuntimeMeshBatchImportParam batchParam;
+    TArray<FPendingFile> pendingFiles;
+    int32 nextPendingIndex = 0;
+    int32 numInFlight = 0;
+    int64 bytesInFlight = 0;
+    int32 numFinished = 0;
+    int32 numTotal = 0;
+    bool bIsImporting = false;
+
+    FRuntimeBatchImportFileFinished delegateFileFinished;
+    FRuntimeMeshImportExportProgressUpdate delegateProgress;
+    FRuntimeBatchImportFinished delegateFinished;
+};
@@ -0,0 +1,84 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interface/MeshExportable.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshComponentExportables.generated.h"
+
+class UPrimitiveComponent;
+
+/**
+ *	The built-in exportables of the mesh components of the engine, so they are exported without an implementation of IMeshExportable.
+ *	They copy the buffers of the meshes in bulk and hand them to the exporter as views, @see IMeshExportable::GetMeshDataViews.
+ *	The node of a component is the name of its actor followed by its own. @see URuntimeMeshExporter::AddComponent
+ */
+UCLASS(Abstract)
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshComponentExportable : public UObject, public IMeshExportable
+{
+    GENERATED_BODY()
+public:
+
+    // Null for a component without a built-in exportable
+    static UObject* CreateForComponent(UPrimitiveComponent* component, UObject* outer);
+
+    UPrimitiveComponent* GetComponent() const
+    {
+        return component.Get();
+    }
+
+    //~ Begin IMeshExportable Interface
+    virtual FString GetHierarchicalNodeName_Implementation() const override;
+    // Copies the streams of GetMeshDataViews
+    virtual bool GetMeshData_Implementation(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSection>& outSectionData) const override;
+    virtual bool HasMeshDataViews() const override
+    {
+        return true;
+    }
+    //~ End IMeshExportable Interface
+
+protected:
+    UPROPERTY()
+    TWeakObjectPtr<UPrimitiveComponent> component;
+};
+
+/**
+ *	Exports a UStaticMeshComponent, and the instances of a UInstancedStaticMeshComponent with IMeshExportable::GetInstanceTransforms.
+ *	The streams are read from the CPU copy of the LOD, or from its GPU buffers on the render thread when the mesh has no CPU access.
+ *	The extracted LODs are cached by mesh, components with the same mesh and all later exports share them until the mesh is rebuilt.
+ */
+UCLASS()
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshStaticMeshExportable : public URuntimeMeshComponentExportable
+{
+    GENERATED_BODY()
+public:
+
+    // Frees the extracted LODs of the meshes. Exports that still read them keep theirs until they are done.
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Exporter")
+    static void EmptyStaticMeshCache();
+
+    //~ Begin IMeshExportable Interface
+    virtual bool GetMeshDataViews(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSectionView>& outSectionViews) const override;
+    virtual int64 GetMeshDataVersion() const override;
+    virtual uint64 GetSharedMeshKey(const int32 forLod, FTransform& outMeshToWorld) const override;
+    virtual bool GetInstanceTransforms(const int32 forLod, TArray<FTransform>& outInstanceToWorld) const override;
+    //~ End IMeshExportable Interface
+};
+
+/**
+ *	Exports the visible sections of a UProceduralMeshComponent. The sections are converted on every gather,
+ *	they change without a version the exporter could compare.
+ */
+UCLASS()
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshProceduralMeshExportable : public URuntimeMeshComponentExportable
+{
+    GENERATED_BODY()
+public:
+
+    //~ Begin IMeshExportable Interface
+    virtual bool GetMeshDataViews(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSectionView>& outSectionViews) const override;
+    //~ End IMeshExportable Interface
+};
@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "Interface/MeshExportable.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshConvertCommandlet.generated.h"
+
+// The metrics of one job of URuntimeMeshConvertCommandlet, written to the metrics file
+USTRUCT(BlueprintType)
+struct FRuntimeMeshConvertJobMetrics
+{
+    GENERATED_BODY()
+
+    // The index of the job in the manifest
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 jobIndex = INDEX_NONE;
+
+    // "convert", "import" or "export"
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FString type;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FString file;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    bool bSuccess = false;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FString error;
+
+    // Of the whole job
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float seconds = 0.f;
+
+    // Only of "convert" jobs
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshConvertResult convert;
+
+    // Of "import" and "export" jobs
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshImportStageTimings importTimings;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshImportMetrics importMetrics;
+
+    // Only of "export" jobs
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshExportStageTimings exportTimings;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshExportMetrics exportMetrics;
+};
+
+/**
+ *	Exports one mesh of an import result, once per instance transform. The sections have no materials.
+ *	Used by URuntimeMeshConvertCommandlet to export imported files without a world.
+ */
+UCLASS()
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportResultExportable : public UObject, public IMeshExportable
+{
+    GENERATED_BODY()
+public:
+
+    /**
+     * @param inVertexColorSpace	FRuntimeMeshExportParam::vertexColorSpace of the export. The colors are encoded the way the exporter decodes them,
+     *								so the exported colors are the imported ones.
+     */
+    void SetMeshInfo(const FString& inNodeName, FRuntimeMeshImportMeshInfo&& inMeshInfo, const ERuntimeMeshVertexColorSpace inVertexColorSpace);
+
+    //~ Begin IMeshExportable Interface
+    virtual FString GetHierarchicalNodeName_Implementation() const override;
+    virtual bool GetMeshData_Implementation(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSection>& outSectionData) const override;
+    virtual bool IsThreadSafeGather() const override
+    {
+        return true;
+    }
+    //~ End IMeshExportable Interface
+
+private:
+    FString nodeName;
+    FRuntimeMeshImportMeshInfo meshInfo;
+    ERuntimeMeshVertexColorSpace vertexColorSpace = ERuntimeMeshVertexColorSpace::Linear;
+};
+
+/**
+ *	Runs the conversion, import and export jobs of a manifest without a world, e.g. on a build machine:
+ *
+ *		UE4Editor-Cmd <Project> -run=RuntimeMeshConvert -Manifest=<file> [-Threads=<n>] [-Shard=<i> -NumShards=<n>] [-Metrics=<file>]
+ *
+ *	The manifest is a json object. Each job has a 'type' and a 'param' with the fields of the struct of its type:
+ *		{ "numThreads": 8, "metricsFile": "Metrics.json", "jobs": [
+ *			{ "type": "convert", "param": { FRuntimeMeshConvertParam } },
+ *			{ "type": "import", "param": { FRuntimeMeshImportParam } },
+ *			{ "type": "export", "param": { FRuntimeMeshImportParam }, "exportParam": { FRuntimeMeshExportParam } } ] }
+ *	An import job is useful with a 'resultCacheDirectory', to fill the result cache. An export job imports 'param.file'
+ *	and exports the meshes without their materials, with the import steps like the welding or the LODs applied.
+ *
+ *	The jobs run on 'numThreads' threads, the export step of the export jobs on the main thread after the others.
+ *	A conversion farm starts several processes with the same manifest, each runs the jobs whose index modulo 'NumShards' is its 'Shard'.
+ *	The metrics of the jobs are written as a json array of FRuntimeMeshConvertJobMetrics. Returns 1 when a job failed.
+ */
+UCLASS()
+class URuntimeMeshConvertCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+public:
+
+    URuntimeMeshConvertCommandlet();
+
+    //~ Begin UCommandlet Interface
+    virtual int32 Main(const FString& params) override;
+    //~ End UCommandlet Interface
+};
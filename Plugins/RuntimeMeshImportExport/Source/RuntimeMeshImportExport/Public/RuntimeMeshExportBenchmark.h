@@ -0,0 +1,158 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "Interface/MeshExportable.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshExportBenchmark.generated.h"
+
+class UMaterialInterface;
+
+// The scenes of a benchmark, each combination of the counts is exported with each format
+USTRUCT(BlueprintType)
+struct FRuntimeMeshExportBenchmarkParam
+{
+    GENERATED_BODY()
+
+    FRuntimeMeshExportBenchmarkParam()
+        : formatIds({ TEXT("obj"), TEXT("fbx"), TEXT("glb2") })
+        , nodeCounts({ 1, 64 })
+        , verticesPerMesh({ 1024, 65536 })
+        , materialCounts({ 1, 8 })
+        , textureCounts({ 0, 4 })
+    {}
+
+    // Can be obtained with URuntimeMeshImportExportLibrary::GetSupportedExtensionsExport
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<FString> formatIds;
+
+    // Each node has one exportable with one mesh
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<int32> nodeCounts;
+
+    // The meshes are grids, the count is rounded to the next square
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<int32> verticesPerMesh;
+
+    // The meshes use the materials in turn
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<int32> materialCounts;
+
+    // The materials use the textures in turn as "DiffuseMap", a texture count above the material count is clamped
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<int32> textureCounts;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default", meta = (ClampMin = "1"))
+    int32 textureSize = 512;
+
+    // The parent of the generated materials. The default surface material when not set.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    UMaterialInterface* sourceMaterial = nullptr;
+
+    // The exported files are written to this directory, one file per combination and format
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FString directory;
+
+    // Every combination is exported this often, the same scene each time
+    UPROPERTY(BlueprintReadWrite, Category = "Default", meta = (ClampMin = "1"))
+    int32 numRepetitions = 3;
+
+    // The same seed generates the same scenes
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 seed = 1;
+
+    // The params of the exports, 'formatId', 'file' and 'bOverrideExisting' are set by the benchmark
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshExportParam exportParam;
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshExportBenchmarkSample
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FString formatId;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 numNodes = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 numVerticesPerMesh = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 numMaterials = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 numTextures = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 repetition = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    bool bSuccess = false;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshExportStageTimings timings;
+
+    // The size of the exported file, without the textures and extra files
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int64 fileSize = 0;
+};
+
+/**
+ *	Exportable with a generated grid mesh, for benchmarks. The heights of the grid are random by 'seed',
+ *	so the same seed always exports the same mesh. Gathered on worker threads.
+ */
+UCLASS(BlueprintType)
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshSyntheticExportable : public UObject, public IMeshExportable
+{
+    GENERATED_BODY()
+public:
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Benchmark")
+    void Generate(const FString& inNodeName, const int32 numVertices, UMaterialInterface* material, const FTransform& meshToWorld, const int32 seed);
+
+    //~ Begin IMeshExportable Interface
+    virtual FString GetHierarchicalNodeName_Implementation() const override;
+    virtual bool GetMeshData_Implementation(const int32 forLod, const bool bSkipLodNotValid, TArray<FExportableMeshSection>& outSectionData) const override;
+    virtual bool IsThreadSafeGather() const override
+    {
+        return true;
+    }
+    //~ End IMeshExportable Interface
+
+private:
+    UPROPERTY()
+    FString nodeName;
+
+    UPROPERTY()
+    FExportableMeshSection section;
+};
+
+/**
+ *	Measures the stages of the export, @see FRuntimeMeshExportStageTimings, over generated scenes.
+ *	The exports run synchronously, one after the other.
+ */
+UCLASS()
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshExportBenchmark : public UBlueprintFunctionLibrary
+{
+    GENERATED_BODY()
+public:
+
+    // One sample per export, failed exports are part of the samples
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Benchmark")
+    static void RunExportBenchmark(const FRuntimeMeshExportBenchmarkParam& param, TArray<FRuntimeMeshExportBenchmarkSample>& outSamples);
+
+    // One line per sample with a header line
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Benchmark")
+    static FString SamplesToCsv(const TArray<FRuntimeMeshExportBenchmarkSample>& samples);
+
+    // An array with one object per sample
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Benchmark")
+    static FString SamplesToJson(const TArray<FRuntimeMeshExportBenchmarkSample>& samples);
+};
@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshExportQueue.generated.h"
+
+class FQueuedThreadPool;
+class URuntimeMeshExporter;
+
+DECLARE_DELEGATE_TwoParams(FRuntimeExportJobFinished, const int32 /*jobId*/, FRuntimeMeshExportResultRef /*result*/);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FRuntimeExportJobFinishedDyn, int32, jobId, const FRuntimeMeshExportResult&, result);
+
+/**
+ *	Queue for the async exports of the game instance. The jobs are started by priority and in the order they were enqueued,
+ *	their work after the gather runs on a pool of 'maxConcurrentExports' threads that belongs to the queue.
+ *	While there is more than one slot, one slot is kept for ERuntimeMeshExportJobPriority::High jobs, so they never wait for lower jobs.
+ *
+ *	A job is an exporter that holds the scene and the params of the export. The exporter is kept alive until its job is done,
+ *	even when the game instance shuts down in between. It must not be used for anything else until then.
+ */
+UCLASS()
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshExportQueue : public UGameInstanceSubsystem
+{
+    GENERATED_BODY()
+public:
+
+    //~ Begin USubsystem Interface
+    virtual void Deinitialize() override;
+    //~ End USubsystem Interface
+
+    /**
+     *	Enqueues an async export of the scene of 'exporter', @see URuntimeMeshExporter::Export_Async_Cpp.
+     *	@returns	The id of the job, INDEX_NONE when the exporter is already exporting or queued
+     */
+    int32 EnqueueExport_Cpp(URuntimeMeshExporter* exporter, const FRuntimeMeshExportAsyncParam& param, const ERuntimeMeshExportJobPriority priority
+                            , FRuntimeMeshImportExportProgressUpdate callbackProgress
+                            , FRuntimeImportExportGameThreadDone callbackGatherDone
+                            , FRuntimeExportJobFinished callbackFinished);
+
+    /**
+     *	Enqueues an async export of the scene of 'exporter'.
+     *	@param finishedDelegate		Fired with the result when the job is done or cancelled
+     *	@returns					The id of the job, INDEX_NONE when the exporter is already exporting or queued
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|ExportQueue")
+    int32 EnqueueExport(URuntimeMeshExporter* exporter, const FRuntimeMeshExportAsyncParam& param, const ERuntimeMeshExportJobPriority priority
+                        , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate, FRuntimeExportJobFinishedDyn finishedDelegate);
+
+    // A queued job is removed and finishes unsuccessful, a running job is cancelled with the cancellation token of its params
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|ExportQueue")
+    bool CancelJob(const int32 jobId);
+
+    // The pool is created with the next job that starts while no job is running
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|ExportQueue")
+    void SetMaxConcurrentExports(const int32 inMaxConcurrentExports);
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|ExportQueue")
+    FRuntimeMeshExportQueueStats GetStats() const;
+
+private:
+    struct FExportJob
+    {
+        int32 id = INDEX_NONE;
+        URuntimeMeshExporter* exporter = nullptr;
+        FRuntimeMeshExportAsyncParam param;
+        ERuntimeMeshExportJobPriority priority = ERuntimeMeshExportJobPriority::Normal;
+        double enqueueTime = 0.0;
+        FRuntimeMeshImportExportProgressUpdate delegateProgress;
+        FRuntimeImportExportGameThreadDone delegateGatherDone;
+        FRuntimeExportJobFinished delegateFinished;
+    };
+
+    // Starts queued jobs as long as there are free slots
+    void StartQueuedJobs();
+    void OnJobFinished(const int32 jobId, FRuntimeMeshExportResultRef result);
+    bool IsQueuedOrRunning(const URuntimeMeshExporter* exporter) const;
+    void DestroyThreadPool();
+
+    FQueuedThreadPool* threadPool = nullptr;
+    int32 threadPoolSize = 0;
+    int32 maxConcurrentExports = 2;
+    int32 nextJobId = 0;
+    bool bStartingJobs = false;
+
+    // Sorted by priority, then by id
+    TArray<FExportJob> queuedJobs;
+    TArray<FExportJob> runningJobs;
+
+    int32 numStarted = 0;
+    int32 numFinished = 0;
+    double totalWaitSeconds = 0.0;
+    double totalLatencySeconds = 0.0;
+    double lastLatencySeconds = 0.0;
+};
@@ -7,24 +7,27 @@
 #include "CoreMinimal.h"
 #include "Interface/MeshExportable.h"
 #include "UObject/NoExportTypes.h"
-#include "Assimp/LogStream.hpp"
-#include "Assimp/Logger.hpp"
 #include "AssimpCustom.h"
 #include "RuntimeMeshImportExportTypes.h"
 #include "Engine/LatentActionManager.h"
+#include "Async/Future.h"
 #include "RuntimeMeshExporter.generated.h"
 
 struct aiScene;
 struct aiMesh;
 struct aiNode;
 struct aiMaterial;
-class Assimp::Logger;
+class FQueuedThreadPool;
+class UPrimitiveComponent;
 
 /**
  *	Exporter that uses Assimp library http://www.assimp.org/
  *
  *	Objects are placed in Nodes. Nodes are simple transform objects like a SceneComponent in Unreal.
  *	Nodes can contain Child Nodes to create a node tree (the scene).
+ *
+ *	Each exporter runs one export at a time. Different exporters can export at the same time, sync or async,
+ *	they share no state and the log of Assimp is routed to the export that logs, @see FAssimpLogRouter.
  */
 UCLASS(BlueprintType)
 class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshExporter : public UObject
@@ -89,6 +92,26 @@ public:
     UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Exporter")
     void AddObjectsIfExportable(UPARAM(ref) TArray<UObject*>& objects, const bool bOverrideNode, const FString& hierarchicalNodeName, TArray<UObject*>& notExportable);
 
+    /**
+     *	Adds a UStaticMeshComponent, UInstancedStaticMeshComponent or UProceduralMeshComponent with its built-in exportable,
+     *	which copies the buffers of the mesh in bulk. @see URuntimeMeshComponentExportable
+     *
+     *	@param component				The component you want to get exported
+     *	@param bOverrideNode			false: the node is the name of the actor followed by the name of the component
+     *									true: 'hierarchicalNodeName' is used to place the component in the scene
+     *  @param hierarchicalNodeName		If bOverrideNode==true this is used to place the component in the scene. e.g.: Outer1.Outer2.Outer3.MyNode
+     *  @returns						false: The component has no built-in exportable and was rejected.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Exporter")
+    bool AddComponent(UPrimitiveComponent* component, const bool bOverrideNode, const FString& hierarchicalNodeName);
+
+    /**
+     *	@param components				The components you want to get exported, @see AddComponent
+     *  @param notExportable			Components without a built-in exportable
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Exporter")
+    void AddComponents(UPARAM(ref) TArray<UPrimitiveComponent*>& components, const bool bOverrideNode, const FString& hierarchicalNodeName, TArray<UPrimitiveComponent*>& notExportable);
+
     /**
      *	Exports the scene synchronous. This will block the game until export is finished.
      * 
@@ -102,7 +125,7 @@ public:
     /**
      *	Export the scene asynchronous. Gathering of the mesh data is done in tick on the GameThread. During that time you should not modify the scene
      *	to ensure consistency of the scene. As soon as the data gathering on the GameThread is done 'callbackGatherDone' is fired and the export process
-     *	is send to another thread where everything else is done.
+     *	is send to another thread where everything else is done. With FRuntimeMeshExportAsyncParam::bSnapshotGather the gathering is done in the tick of the call.
      *
      *	@param param				The parameters for the export
      *	@param callbackProgress		Callback for a progress update of the exporter
@@ -113,10 +136,18 @@ public:
                           , FRuntimeImportExportGameThreadDone callbackGatherDone
                           , FRuntimeExportFinished callbackFinished);
 
+    /**
+     *	Same as Export_Async_Cpp as a future, it is set on the GameThread when the export finished.
+     *	Chains of futures, e.g. an import with URuntimeMeshImportExportLibrary::ImportSceneWithParam_Future, can continue with the export this way.
+     */
+    TFuture<FRuntimeMeshExportResultPtr> Export_Future(const FRuntimeMeshExportAsyncParam& param
+                                                       , FRuntimeMeshImportExportProgressUpdate callbackProgress = FRuntimeMeshImportExportProgressUpdate()
+                                                       , FRuntimeImportExportGameThreadDone callbackGatherDone = FRuntimeImportExportGameThreadDone());
+
     /**
 	 *	Export the scene asynchronous. Gathering of the mesh data is done in tick on the GameThread. During that time you should not modify the scene
 	 *	to ensure consistency of the scene. As soon as the data gathering on the GameThread is done 'gatherDoneDelegate' is fired and the export process
-	 *	is send to another thread where everything else is done.
+	 *	is send to another thread where everything else is done. With FRuntimeMeshExportAsyncParam::bSnapshotGather the gathering is done in the tick of the call.
 	 *	
 	 *	@param param				The parameters for the export
 	 *	@param progressDelegate		Callback for a progress update of the exporter
@@ -131,35 +162,29 @@ public:
     UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Exporter")
     bool GetIsExporting();
 
+    // The async export runs its work after the gather on 'pool' instead of the thread pool of the plugin, null resets it. It is read on the GameThread when the gather is done.
+    void SetExportThreadPool(FQueuedThreadPool* pool);
+
 private:
 
     // This function does most of the export work
     void Export_Async_AnyThread(const FRuntimeMeshExportParam param);
     void Export_Async_Finish();
 
-    struct FExportLogger : public Assimp::LogStream
-    {
-        FExportLogger(FAssimpScene& inScene) : scene(inScene)
-        { }
-
-        virtual void write(const char* message) override
-        {
-            // log messages from Assimp should already contain a newline
-            scene.WriteToLogWithNewLine(message);
-        }
-
-    private:
-        FAssimpScene& scene;
-    };
-
     bool bIsExporting = false;
     FAssimpScene* scene = nullptr;
+    FQueuedThreadPool* exportThreadPool = nullptr;
+    // The built-in exportables of AddComponent, the scene does not keep its exportables alive
+    UPROPERTY()
+    TArray<UObject*> componentExportables;
+    // For FRuntimeMeshExportStageTimings::totalSeconds
+    double exportStartTime = 0.0;
+    // For FRuntimeMeshExportMetrics::usedPhysicalGrowthMB
+    uint64 exportStartUsedPhysical = 0;
 
     bool PreExportWork(const FRuntimeMeshExportParam& param, FRuntimeMeshExportResult& result);
     bool PostExportWork(FRuntimeMeshExportResult& result);
 
-    Assimp::Logger* assimpLogger = nullptr;
-    FExportLogger* exportLogger = nullptr;
     aiReturn aiExporterReturn;
     FString aiExporterError;
 
@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Tickable.h"
+#include "ProceduralMeshComponent.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportApplier.generated.h"
+
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+class UTexture2D;
+
+/**
+ *	Applies an import result to a UProceduralMeshComponent over several ticks, so a big model pops in progressively
+ *	without a long frame. The sections are converted on a worker thread, @see URuntimeMeshImportExportLibrary::ImportResultToProcMeshSections.
+ *	Each tick then applies sections, creates the dynamic materials of the applied sections and starts their textures,
+ *	within the limits of FRuntimeMeshImportApplyParam.
+ *
+ *	The vertices are used as imported, the instance transforms of the meshes are not applied.
+ *	Only one result can be applied at a time per applier.
+ */
+UCLASS(BlueprintType)
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportApplier : public UObject, public FTickableGameObject
+{
+    GENERATED_BODY()
+public:
+
+    virtual void BeginDestroy() override;
+
+    //~ Begin FTickableGameObject Interface
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual bool IsTickableWhenPaused() const override
+    {
+        return true;
+    }
+    virtual bool IsTickableInEditor() const override
+    {
+        return true;
+    }
+    virtual TStatId GetStatId() const override;
+    //~ End FTickableGameObject Interface
+
+    /**
+     *	Replaces the sections of 'component' with the sections of 'result', over the next ticks. Must be called on the GameThread.
+     *
+     *	@param sourceMaterial		The parent of the dynamic materials, @see URuntimeMeshImportExportLibrary::MaterialInfoToDynamicMaterial.
+     *								Without it the sections keep the materials the component has.
+     *	@param callbackProgress		Fired after each tick that applied something
+     *	@param callbackFinished		Fired when all sections, materials and textures are applied, or when the component was destroyed in between
+     *	@returns					false when a result is already being applied
+     */
+    bool ApplyImportResult_Async_Cpp(UProceduralMeshComponent* component, FRuntimeMeshImportResult&& result, UMaterialInterface* sourceMaterial
+                                     , const FRuntimeMeshImportApplyParam& param
+                                     , FRuntimeMeshImportExportProgressUpdate callbackProgress
+                                     , FRuntimeImportExportGameThreadDone callbackFinished);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    bool ApplyImportResult_Async(UProceduralMeshComponent* component, const FRuntimeMeshImportResult& result, UMaterialInterface* sourceMaterial
+                                 , const FRuntimeMeshImportApplyParam& param
+                                 , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
+                                 , FRuntimeImportExportGameThreadDoneDyn finishedDelegate);
+
+    // Stops applying, what is already applied stays on the component. The finished delegate is not fired.
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    void Cancel();
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    bool GetIsApplying() const;
+
+private:
+    struct FPendingTexture
+    {
+        int32 materialIndex = INDEX_NONE;
+        int32 textureIndex = INDEX_NONE;
+    };
+
+    void OnSectionsBuilt(TArray<FProcMeshSection>&& inSections, TArray<int32>&& inSectionMaterialIndices);
+    // Sorts 'pendingSections', so the closest section is the last one
+    void SortPendingSections(const UProceduralMeshComponent& component);
+    void ApplySection(UProceduralMeshComponent& component, const int32 sectionIndex);
+    void CreateMaterial(UProceduralMeshComponent& component, const int32 materialIndex);
+    void SetMaterialOfAppliedSections(UProceduralMeshComponent& component, const int32 materialIndex);
+    void AddMaterialToCache(const int32 materialIndex);
+    void StartTexture(const FPendingTexture& pendingTexture);
+    void OnTextureCreated(const int32 requestId, const int32 materialIndex, const FName parameterName, UTexture2D* texture);
+    void FinishIfDone();
+    void Reset();
+
+    UPROPERTY()
+    UMaterialInterface* sourceMaterial = nullptr;
+
+    // One per material info, nullptr until it is created
+    UPROPERTY()
+    TArray<UMaterialInstanceDynamic*> materials;
+
+    TWeakObjectPtr<UProceduralMeshComponent> weakComponent;
+    FRuntimeMeshImportApplyParam param;
+    TArray<FRuntimeMeshImportMaterialInfo> materialInfos;
+    TArray<uint64> materialInfoHashes;
+    TArray<int32> materialRemainingTextures;
+
+    // Freed as soon as they are applied
+    TArray<FProcMeshSection> sections;
+    TArray<int32> sectionMaterialIndices;
+    TArray<bool> sectionApplied;
+    TArray<int32> pendingSections;
+    TArray<int32> pendingMaterials;
+    TArray<FPendingTexture> pendingTextures;
+    TSet<int32> queuedMaterials;
+    int32 numTexturesInFlight = 0;
+    int32 numApplied = 0;
+    int32 numTotal = 0;
+
+    // Each call gets its own id, so the callbacks of an earlier call are ignored
+    int32 requestId = 0;
+    bool bIsApplying = false;
+    bool bSectionsBuilt = false;
+
+    FRuntimeMeshImportExportProgressUpdate delegateProgress;
+    FRuntimeImportExportGameThreadDone delegateFinished;
+};
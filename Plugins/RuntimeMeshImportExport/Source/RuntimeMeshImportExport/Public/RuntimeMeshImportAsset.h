@@ -0,0 +1,196 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "ProceduralMeshComponent.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportAsset.generated.h"
+
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+class UBodySetup;
+
+// The dynamic materials of all material infos of an import asset, created from one source material
+USTRUCT()
+struct FRuntimeMeshImportAssetMaterials
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    UMaterialInterface* sourceMaterial = nullptr;
+
+    // One per material info of the result
+    UPROPERTY()
+    TArray<UMaterialInstanceDynamic*> materials;
+};
+
+// The memory held by an import asset, @see URuntimeMeshImportAsset::GetMemoryUsage
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportAssetMemory
+{
+    GENERATED_BODY()
+
+    // The meshes of the result, with their LODs and collision
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+    int64 geometryBytes = 0;
+
+    // The texture files of the result and the textures of the dynamic materials
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+    int64 textureBytes = 0;
+
+    // The sections converted for UProceduralMeshComponent
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+    int64 derivedBytes = 0;
+
+    int64 GetTotalBytes() const
+    {
+        return geometryBytes + textureBytes + derivedBytes;
+    }
+};
+
+/**
+ *	An immutable import result that several consumers share, e.g. a preview, the collision and a minimap of the same model.
+ *	The result is never copied after the asset is created. What is derived from it, the sections of UProceduralMeshComponent,
+ *	the dynamic materials and the body setups, is built once on first use and shared by all consumers.
+ *	Memory scales with the unique models, not with the number of components that show them.
+ *
+ *	The derived data lives as long as the asset, @see EmptyDerivedData. Must be used on the GameThread.
+ */
+UCLASS(BlueprintType)
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportAsset : public UObject
+{
+    GENERATED_BODY()
+public:
+
+    // Wraps 'result' of e.g. ImportSceneWithParam_Async_Cpp without copying it. It must not be modified afterwards.
+    static URuntimeMeshImportAsset* Create(FRuntimeMeshImportResultRef result);
+
+    // Copies 'result' once, into the asset
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    static URuntimeMeshImportAsset* CreateImportAsset(const FRuntimeMeshImportResult& result);
+
+    // The meshes whose geometry is shared have sections without vertices, @see GetMeshGeometry
+    const FRuntimeMeshImportResult& GetResult() const
+    {
+        return *result;
+    }
+
+    /**
+     *	The mesh info with the sections of the mesh at 'meshIndex', the one of its shared geometry when it has one.
+     *	The material of each section is the one of the section in GetResult, a shared geometry has the materials of the asset it came from.
+     */
+    const FRuntimeMeshImportMeshInfo& GetMeshGeometry(const int32 meshIndex) const;
+
+    /**
+     *	The geometry of the mesh at 'meshIndex' when it is shared with other assets, an asset with this one mesh. nullptr when the mesh has its own.
+     *	@see URuntimeMeshImportAssetManager, FRuntimeMeshImportParam::bHashGeometry
+     */
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    URuntimeMeshImportAsset* GetSharedGeometry(const int32 meshIndex) const;
+
+    // Used by URuntimeMeshImportAssetManager after the sections of 'meshIndex' were moved to 'geometry', before the asset is used
+    void SetSharedGeometry(const int32 meshIndex, URuntimeMeshImportAsset* geometry);
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    int32 GetNumMeshes() const;
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    int32 GetNumMaterials() const;
+
+    /**
+     *	Replaces the sections of 'component' with the sections of all meshes, @see URuntimeMeshImportExportLibrary::ApplyImportResultToProceduralMesh.
+     *	The sections are converted once on a worker thread per combination of 'bCreateCollision' and 'bFlipTangentY', every component gets a copy of them.
+     *	'callbackDone' is called on the GameThread after they were applied, right away when they were already converted.
+     *	It is not called when the component was destroyed in the meantime.
+     */
+    void ApplyToProceduralMesh_Async_Cpp(UProceduralMeshComponent* component, const TArray<UMaterialInterface*>& materials
+                                         , FRuntimeImportExportGameThreadDone callbackDone, const bool bCreateCollision = false, const bool bFlipTangentY = false);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    void ApplyToProceduralMesh_Async(UProceduralMeshComponent* component, const TArray<UMaterialInterface*>& materials
+                                     , FRuntimeImportExportGameThreadDoneDyn callbackDone, const bool bCreateCollision = false, const bool bFlipTangentY = false);
+
+    /**
+     *	The dynamic material of each material info, @see URuntimeMeshImportExportLibrary::MaterialInfoToDynamicMaterial.
+     *	They are created once per 'sourceMaterial' and kept alive by the asset. The materials must not be modified.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import", meta = (WorldContext = "worldContextObject"))
+    void GetDynamicMaterials(UObject* worldContextObject, UMaterialInterface* sourceMaterial, TArray<UMaterialInterface*>& outMaterials);
+
+    /**
+     *	The cooked body setup of the mesh at 'meshIndex', @see URuntimeMeshImportExportLibrary::MeshInfoToBodySetup_Async_Cpp.
+     *	It is cooked once, the requests during the cooking wait for it. 'callbackCreated' is called on the GameThread,
+     *	right away when the body setup is already cooked, with nullptr when the mesh has no collision.
+     */
+    void GetBodySetup_Async_Cpp(const int32 meshIndex, FRuntimeBodySetupCreated callbackCreated);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    void GetBodySetup_Async(const int32 meshIndex, FRuntimeBodySetupCreatedDyn callbackCreated);
+
+    /**
+     *	The memory held by the asset. The textures are counted with their resident mips,
+     *	a texture that the texture cache shares with other assets is counted by each of them. The shared geometries are not counted.
+     */
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    FRuntimeMeshImportAssetMemory GetMemoryUsage() const;
+
+    // Frees the sections, materials and body setups that are built. The components keep what was applied to them, running builds finish.
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    void EmptyDerivedData();
+
+private:
+    struct FProcMeshSections
+    {
+        TArray<FProcMeshSection> sections;
+        TArray<int32> materialIndices;
+    };
+
+    struct FPendingApply
+    {
+        TWeakObjectPtr<UProceduralMeshComponent> component;
+        TArray<TWeakObjectPtr<UMaterialInterface>> materials;
+        FRuntimeImportExportGameThreadDone callbackDone;
+    };
+
+    struct FSectionsEntry
+    {
+        TSharedPtr<const FProcMeshSections, ESPMode::ThreadSafe> sections;
+        TArray<FPendingApply> pendingApplies;
+        bool bIsBuilding = false;
+    };
+
+    struct FBodySetupEntry
+    {
+        TArray<FRuntimeBodySetupCreated> pendingCallbacks;
+        bool bIsCreated = false;
+        bool bIsCooking = false;
+    };
+
+    static void ApplySections(const FProcMeshSections& sections, const FPendingApply& pendingApply);
+    void OnSectionsBuilt(const int32 entryIndex, TSharedRef<const FProcMeshSections, ESPMode::ThreadSafe> builtSections);
+    void OnBodySetupCreated(const int32 meshIndex, UBodySetup* bodySetup);
+
+    TSharedRef<const FRuntimeMeshImportResult, ESPMode::ThreadSafe> result = MakeShared<FRuntimeMeshImportResult, ESPMode::ThreadSafe>();
+    // The result does not change, its size is computed once
+    int64 geometryBytes = 0;
+    int64 textureFileBytes = 0;
+
+    // Indexed by bCreateCollision | bFlipTangentY << 1
+    FSectionsEntry sectionsEntries[4];
+
+    UPROPERTY()
+    TArray<FRuntimeMeshImportAssetMaterials> materialSets;
+
+    // One per mesh, nullptr for the meshes with their own geometry
+    UPROPERTY()
+    TArray<URuntimeMeshImportAsset*> sharedGeometries;
+
+    // One per mesh, nullptr until it is cooked
+    UPROPERTY()
+    TArray<UBodySetup*> bodySetups;
+    TArray<FBodySetupEntry> bodySetupEntries;
+};
@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportAsset.h"
+#include "RuntimeMeshImportAssetManager.generated.h"
+
+DECLARE_DELEGATE_OneParam(FRuntimeImportAssetLoaded, URuntimeMeshImportAsset* /*asset*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FRuntimeImportAssetLoadedDyn, URuntimeMeshImportAsset*, asset);
+
+/**
+ *	Owns the import assets of the game instance and keeps the memory they hold within a budget.
+ *	An asset is identified by its file and the params that change the result. Loading an asset that is resident returns it right away,
+ *	loading one that is being imported waits for that import.
+ *
+ *	When the assets hold more than the budget, the least recently loaded ones are evicted: their derived data is freed and
+ *	the manager forgets them. Whoever still references an evicted asset can keep using it, the next load imports it again.
+ *	With a result cache directory that import reads the persistent import cache instead of running Assimp,
+ *	@see FRuntimeMeshImportParam::resultCacheDirectory.
+ *
+ *	The meshes of imports with FRuntimeMeshImportParam::bHashGeometry share their geometry: each distinct geometry hash is kept once,
+ *	in an asset of its own that all assets with the mesh reference, @see URuntimeMeshImportAsset::GetSharedGeometry.
+ *	E.g. the same screw in hundreds of part files is stored once and placed by the instance transforms of each file.
+ *	A shared geometry lives as long as an asset references it.
+ */
+UCLASS()
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportAssetManager : public UGameInstanceSubsystem
+{
+    GENERATED_BODY()
+public:
+
+    //~ Begin USubsystem Interface
+    virtual void Deinitialize() override;
+    //~ End USubsystem Interface
+
+    /**
+     *	Returns the asset of 'param' through 'callbackLoaded' on the GameThread, importing it when it is not resident.
+     *	'callbackLoaded' gets nullptr when the import failed. Must be called on the GameThread.
+     */
+    void LoadAsset_Async_Cpp(const FRuntimeMeshImportParam& param, FRuntimeImportAssetLoaded callbackLoaded);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    void LoadAsset_Async(const FRuntimeMeshImportParam& param, FRuntimeImportAssetLoadedDyn loadedDelegate);
+
+    // The resident asset of 'param', nullptr when it is not loaded. Counts as a use of the asset.
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    URuntimeMeshImportAsset* FindAsset(const FRuntimeMeshImportParam& param);
+
+    // Forgets 'asset' and frees its derived data
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    void ReleaseAsset(URuntimeMeshImportAsset* asset);
+
+    /**
+     *	@param budgetMB		The memory the resident assets may hold. 0 disables the eviction.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    void SetMemoryBudget(const int32 budgetMB = 1024);
+
+    // Used by the loads whose params have no result cache directory. Empty disables it for them.
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    void SetResultCacheDirectory(const FString& directory);
+
+    /**
+     *	Evicts the least recently used assets until the resident assets are within the budget.
+     *	Loading an asset does it as well. Call it after the derived data of the assets grew, e.g. their materials were created.
+     *	The most recently used asset is never evicted.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    void EnforceMemoryBudget();
+
+    // The memory of all resident assets
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    FRuntimeMeshImportAssetMemory GetMemoryUsage() const;
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    int32 GetNumResidentAssets() const;
+
+    // The distinct geometries that the assets share, @see FRuntimeMeshImportParam::bHashGeometry
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    int32 GetNumSharedGeometries() const;
+
+private:
+    static FString GetAssetKey(const FRuntimeMeshImportParam& param);
+    void OnAssetImported(const FString& key, FRuntimeMeshImportResultRef result);
+    void TouchAsset(const FString& key);
+    void EvictAsset(const FString& key);
+    // Moves the geometry of the hashed meshes of 'result' to the shared geometries, the asset of 'result' references them
+    void ShareGeometry(FRuntimeMeshImportResult& result, TArray<URuntimeMeshImportAsset*>& outGeometries);
+
+    UPROPERTY()
+    TMap<FString, URuntimeMeshImportAsset*> residentAssets;
+
+    // The keys of 'residentAssets', the least recently used first
+    TArray<FString> usageOrder;
+
+    TMap<FString, TArray<FRuntimeImportAssetLoaded>> pendingLoads;
+
+    // By the geometry hash of their mesh, the assets that reference them keep them alive
+    TMap<int64, TWeakObjectPtr<URuntimeMeshImportAsset>> sharedGeometries;
+
+    int64 memoryBudgetBytes = int64(1024) * 1024 * 1024;
+    FString resultCacheDirectory = FString(TEXT("RuntimeMeshImportCache"));
+};
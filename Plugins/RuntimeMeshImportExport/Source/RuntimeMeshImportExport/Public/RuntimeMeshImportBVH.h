@@ -0,0 +1,74 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+struct FKBoxElem;
+
+// 32 bytes, two nodes share a cache line
+struct FRuntimeMeshImportBVHNode
+{
+    FVector boundsMin;
+    // Leaf: the first entry in FRuntimeMeshImportBVH::triangles. Inner node: the first of the two children, the second one follows it.
+    int32 firstIndex;
+    FVector boundsMax;
+    // 0 for inner nodes
+    int32 numTriangles;
+
+    bool IsLeaf() const
+    {
+        return numTriangles > 0;
+    }
+};
+
+/**
+ *	Bounding volume hierarchy over the triangles of a section, built with binned SAH.
+ *	It only stores the nodes and a triangle order, the queries read the vertices and triangles of the section it was built for.
+ *	It becomes invalid when the triangles or vertices of the section change.
+ */
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportBVH
+{
+    TArray<FRuntimeMeshImportBVHNode> nodes;
+    // Triangle indices of the section, the leaves reference ranges of it
+    TArray<int32> triangles;
+
+    /**
+     * Builds the hierarchy for 'section'. The upper levels are split on the calling thread,
+     * the subtrees below are built in parallel when 'bParallel'.
+     * @param maxLeafTriangles	Nodes with more triangles are always split
+     */
+    static TSharedRef<FRuntimeMeshImportBVH, ESPMode::ThreadSafe> Build(const FRuntimeMeshImportSectionInfo& section, const int32 maxLeafTriangles = 4, const bool bParallel = true);
+
+    // The closest triangle hit by the segment from 'start' to 'end', both faces count. 'outHit.sectionIndex' is not touched.
+    bool Raycast(const FRuntimeMeshImportSectionInfo& section, const FVector& start, const FVector& end, FRuntimeMeshImportRaycastHit& outHit) const;
+
+    // Adds the triangles that intersect 'box' to 'outTriangles'
+    void OverlapBox(const FRuntimeMeshImportSectionInfo& section, const FBox& box, TArray<int32>& outTriangles) const;
+
+    // Adds the triangles that intersect the sphere to 'outTriangles'
+    void OverlapSphere(const FRuntimeMeshImportSectionInfo& section, const FVector& center, const float radius, TArray<int32>& outTriangles) const;
+
+    /**
+     * The nodes of a cut through the hierarchy that covers every triangle once: starting at the root,
+     * the node with the largest volume is replaced by its children until there are 'maxNodes' nodes or only leaves.
+     */
+    void GetFrontier(const int32 maxNodes, TArray<int32>& outNodes) const;
+
+    // The triangles below a node are a consecutive range of 'triangles', [outBegin, outEnd)
+    void GetTriangleRange(const int32 nodeIndex, int32& outBegin, int32& outEnd) const;
+
+    /**
+     * Simple collision from the node bounds of GetFrontier.
+     * Boxes need no cooking, so a UBodySetup with them is ready without running PhysX cooking.
+     */
+    void GetCollisionBoxes(const int32 maxBoxes, TArray<FKBoxElem>& outBoxes) const;
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return nodes.GetAllocatedSize() + triangles.GetAllocatedSize();
+    }
+};
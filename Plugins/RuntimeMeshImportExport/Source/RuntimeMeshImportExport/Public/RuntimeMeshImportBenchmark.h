@@ -0,0 +1,120 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportBenchmark.generated.h"
+
+// Each file of the corpus is imported with each combination of the import methods
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportBenchmarkParam
+{
+    GENERATED_BODY()
+
+    FRuntimeMeshImportBenchmarkParam()
+        : importMethodsMesh({ EImportMethodMesh::Keep, EImportMethodMesh::Merge, EImportMethodMesh::MergeByCluster })
+        , importMethodsSection({ EImportMethodSection::Keep, EImportMethodSection::MergeSameMaterial })
+    {}
+
+    // Absolute paths, e.g. fbx, obj, gltf, ply and stl files of different sizes
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<FString> files;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<EImportMethodMesh> importMethodsMesh;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<EImportMethodSection> importMethodsSection;
+
+    // Every combination is imported this often
+    UPROPERTY(BlueprintReadWrite, Category = "Default", meta = (ClampMin = "1"))
+    int32 numRepetitions = 3;
+
+    // How often the used physical memory is sampled during an import
+    UPROPERTY(BlueprintReadWrite, Category = "Default", meta = (ClampMin = "1"))
+    float memorySampleIntervalMs = 5.f;
+
+    // The params of the imports, 'file', 'pathType' and the import methods are set by the benchmark. Without a result cache directory, all imports read the file.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshImportParam importParam;
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportBenchmarkSample
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FString file;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int64 fileSize = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    EImportMethodMesh importMethodMesh = EImportMethodMesh::Keep;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    EImportMethodSection importMethodSection = EImportMethodSection::Keep;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 repetition = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    bool bSuccess = false;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshImportStageTimings timings;
+
+    // The vertices of LOD 0 of all imported sections
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 numVertices = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float verticesPerSecond = 0.f;
+
+    // The highest used physical memory of the process during the import, above the memory before it
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float peakMemoryMB = 0.f;
+};
+
+/**
+ *	Measures the stages of the import, @see FRuntimeMeshImportStageTimings, over a corpus of files.
+ *	The imports run one after the other on the calling thread with ImportScene_AnyThread.
+ */
+UCLASS()
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportBenchmark : public UBlueprintFunctionLibrary
+{
+    GENERATED_BODY()
+public:
+
+    // One sample per import, failed imports are part of the samples
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Benchmark")
+    static void RunImportBenchmark(const FRuntimeMeshImportBenchmarkParam& param, TArray<FRuntimeMeshImportBenchmarkSample>& outSamples);
+
+    // One line per sample with a header line
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Benchmark")
+    static FString SamplesToCsv(const TArray<FRuntimeMeshImportBenchmarkSample>& samples);
+
+    // An array with one object per sample, can be read back with SamplesFromJson
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Benchmark")
+    static FString SamplesToJson(const TArray<FRuntimeMeshImportBenchmarkSample>& samples);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Benchmark")
+    static bool SamplesFromJson(const FString& json, TArray<FRuntimeMeshImportBenchmarkSample>& outSamples);
+
+    /**
+     *	Compares the median total seconds of each file and import method combination with the stored baseline.
+     *	The files are matched by their clean file name, so a baseline can be recorded on another machine.
+     *
+     *	@param tolerance		A combination regressed when it is slower than the baseline by more than this fraction
+     *	@param outRegressions	One line per regressed combination
+     *	@returns				True when no combination regressed
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Benchmark")
+    static bool CompareToBaseline(const TArray<FRuntimeMeshImportBenchmarkSample>& samples, const TArray<FRuntimeMeshImportBenchmarkSample>& baseline
+                                  , const float tolerance, TArray<FString>& outRegressions);
+};
@@ -0,0 +1,34 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Interfaces/Interface_CollisionDataProvider.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportCollisionProvider.generated.h"
+
+/**
+ *	The outer of the body setups of MeshInfoToBodySetup_Async. The cooking asks it for the trimesh of FRuntimeMeshImportCollision,
+ *	which it keeps until the body setup is destroyed.
+ */
+UCLASS()
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportCollisionProvider : public UObject, public IInterface_CollisionDataProvider
+{
+    GENERATED_BODY()
+public:
+
+    TArray<FVector> trimeshVertices;
+    TArray<int32> trimeshTriangles;
+
+    //~ Begin IInterface_CollisionDataProvider Interface
+    virtual bool GetPhysicsTriMeshData(struct FTriMeshCollisionData* collisionData, bool bInUseAllTriData) override;
+    virtual bool ContainsPhysicsTriMeshData(bool bInUseAllTriData) const override;
+    virtual bool WantsNegXTriMesh() override
+    {
+        return false;
+    }
+    //~ End IInterface_CollisionDataProvider Interface
+};
@@ -0,0 +1,216 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PackedNormal.h"
+#include "Math/Vector2DHalf.h"
+#include "Math/Float16.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+struct FProcMeshTangent;
+struct FStaticMeshBuildVertex;
+
+// How FRuntimeMeshImportCompactConversion packs the vertex streams
+struct FRuntimeMeshImportCompactOptions
+{
+    // Half precision UVs. Exact enough for UVs in [-2, 2] of textures up to 2048, tiled UVs far outside lose precision.
+    bool bHalfUVs = true;
+    // 16 bit indices for sections with at most 65536 vertices
+    bool b16BitIndices = true;
+};
+
+// @see FRuntimeMeshImportMorphTarget. The position deltas stay full precision like the vertices, the normal deltas are half precision.
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportCompactMorphTarget
+{
+    FName name;
+    TArray<int32> vertexIndices;
+    TArray<FVector> positionDeltas;
+    // X, Y and Z per entry of 'vertexIndices', empty when the target does not change the normals
+    TArray<FFloat16> normalDeltas;
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return vertexIndices.GetAllocatedSize() + positionDeltas.GetAllocatedSize() + normalDeltas.GetAllocatedSize();
+    }
+};
+
+/**
+ *	A FRuntimeMeshImportSectionInfo with packed vertex streams, for holding many imported meshes in memory.
+ *	About 28 bytes per vertex instead of 60: positions stay full precision, normals and tangents are FPackedNormal,
+ *	UVs half precision, colors FColor. The indices are 16 bit when the vertex count allows it.
+ *	The streams are separate arrays, a stream is empty when the section does not have it.
+ */
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportCompactSection
+{
+    FName materialName;
+    int32 materialIndex = INDEX_NONE;
+
+    TArray<FVector> vertices;
+    TArray<FPackedNormal> normals;
+    // W is the sign of the binormal, always positive as the imported tangents do not have one
+    TArray<FPackedNormal> tangents;
+    // Only one of 'uv0Half' and 'uv0' is used, depending on FRuntimeMeshImportCompactOptions::bHalfUVs
+    TArray<FVector2DHalf> uv0Half;
+    TArray<FVector2D> uv0;
+    // The lightmap UVs stay full precision, they address single texels
+    TArray<FVector2D> uv1;
+    TArray<FColor> vertexColors;
+    // Only one of 'indices16' and 'indices32' is used
+    TArray<uint16> indices16;
+    TArray<uint32> indices32;
+
+    TMap<FString, TArray<TTuple<int32, float>>> BoneInfo;
+    // @see FRuntimeMeshImportSectionInfo::boneIndices, already packed
+    int32 numBoneInfluences = 0;
+    TArray<uint16> boneIndices;
+    TArray<uint8> boneWeights;
+    FBox bounds = FBox(ForceInit);
+    // Shared with the full precision section, the triangle order is kept
+    TSharedPtr<const FRuntimeMeshImportBVH, ESPMode::ThreadSafe> bvh;
+    TArray<FRuntimeMeshImportCompactMorphTarget> morphTargets;
+    // Compact already, the same as the full precision section
+    FRuntimeMeshImportLinesAndPoints linesAndPoints;
+
+    int32 GetNumIndices() const
+    {
+        return indices16.Num() > 0 ? indices16.Num() : indices32.Num();
+    }
+
+    int32 GetIndex(const int32 index) const
+    {
+        return indices16.Num() > 0 ? int32(indices16[index]) : int32(indices32[index]);
+    }
+
+    int32 GetNumUVs() const
+    {
+        return uv0Half.Num() > 0 ? uv0Half.Num() : uv0.Num();
+    }
+
+    FVector2D GetUV(const int32 index) const
+    {
+        return uv0Half.Num() > 0 ? FVector2D(uv0Half[index]) : uv0[index];
+    }
+
+    SIZE_T GetAllocatedSize() const;
+};
+
+// @see FRuntimeMeshImportMeshLOD
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportCompactMeshLOD
+{
+    float screenSize = 0.f;
+    TArray<FRuntimeMeshImportCompactSection> sections;
+};
+
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportCompactMeshInfo
+{
+    // Name of the imported mesh. Name None when merged
+    FName meshName;
+    TArray<FRuntimeMeshImportCompactSection> sections;
+    // @see FRuntimeMeshImportMeshInfo::instanceTransforms
+    TArray<FTransform> instanceTransforms;
+    FBox bounds = FBox(ForceInit);
+    // @see FRuntimeMeshImportMeshInfo::lods
+    TArray<FRuntimeMeshImportCompactMeshLOD> lods;
+    // @see FRuntimeMeshImportMeshInfo::collision, kept in full precision for the cooking
+    FRuntimeMeshImportCollision collision;
+    // @see FRuntimeMeshImportMeshInfo::geometryHash
+    int64 geometryHash = 0;
+
+    SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ *	A unit quaternion in 48 bits. The largest component is dropped and rebuilt from the others, which are stored with 15 bits each.
+ *	The error per component is below 3e-5. The index of the dropped component is in the top bits of the first two words.
+ */
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportQuantizedQuat
+{
+    uint16 data[3] = { 0, 0, 0 };
+
+    FRuntimeMeshImportQuantizedQuat() = default;
+    explicit FRuntimeMeshImportQuantizedQuat(const FQuat& rotation);
+
+    FQuat ToQuat() const;
+};
+
+// @see FRuntimeMeshImportAnimationTrack, with quantized rotations. The positions and scales stay full precision.
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportCompactAnimationTrack
+{
+    int32 boneIndex = INDEX_NONE;
+    int32 nodeIndex = INDEX_NONE;
+    TArray<float> positionTimes;
+    TArray<FVector> positions;
+    TArray<float> rotationTimes;
+    TArray<FRuntimeMeshImportQuantizedQuat> rotations;
+    TArray<float> scaleTimes;
+    TArray<FVector> scales;
+
+    // @see FRuntimeMeshImportAnimationTrack::Sample
+    FTransform Sample(const float time, const FTransform& restTransform) const;
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return positionTimes.GetAllocatedSize() + positions.GetAllocatedSize() + rotationTimes.GetAllocatedSize() + rotations.GetAllocatedSize()
+            + scaleTimes.GetAllocatedSize() + scales.GetAllocatedSize();
+    }
+};
+
+// @see FRuntimeMeshImportAnimation
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportCompactAnimation
+{
+    FName name;
+    float duration = 0.f;
+    TArray<FRuntimeMeshImportCompactAnimationTrack> tracks;
+
+    // @see FRuntimeMeshImportAnimation::SampleBones
+    void SampleBones(const float time, const TArray<FRuntimeMeshImportBone>& bones, TArray<FTransform>& outLocalTransforms) const;
+    // @see FRuntimeMeshImportAnimation::SampleNodes
+    void SampleNodes(const float time, const TArray<FRuntimeMeshImportNode>& nodes, TArray<FTransform>& outLocalTransforms) const;
+
+    SIZE_T GetAllocatedSize() const;
+};
+
+// FRuntimeMeshImportResult with compact meshes and animations. The materials, nodes and bones are the same.
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportCompactResult
+{
+    bool bSuccess = false;
+    TArray<FRuntimeMeshImportCompactMeshInfo> meshInfos;
+    TArray<FRuntimeMeshImportMaterialInfo> materialInfos;
+    TArray<FRuntimeMeshImportNode> nodes;
+    TArray<FRuntimeMeshImportBone> bones;
+    TArray<FRuntimeMeshImportCompactAnimation> animations;
+
+    // Of the meshes and animations, the materials are not counted
+    SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ *	Converts between the compact and the regular import result and creates the inputs of ProceduralMeshComponent and UStaticMesh.
+ *	The conversions from FRuntimeMeshImportResult take it by rvalue and free each section as soon as it is packed,
+ *	so the peak memory stays close to the size of the regular result.
+ */
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportCompactConversion
+{
+    static void ToCompact(const FRuntimeMeshImportSectionInfo& section, const FRuntimeMeshImportCompactOptions& options, FRuntimeMeshImportCompactSection& outSection);
+    // Moves the streams that keep their type, e.g. the vertices and the bone weights
+    static void ToCompact(FRuntimeMeshImportSectionInfo&& section, const FRuntimeMeshImportCompactOptions& options, FRuntimeMeshImportCompactSection& outSection);
+    static void ToCompact(FRuntimeMeshImportResult&& result, const FRuntimeMeshImportCompactOptions& options, FRuntimeMeshImportCompactResult& outResult);
+
+    static void ToCompact(const FRuntimeMeshImportAnimation& animation, FRuntimeMeshImportCompactAnimation& outAnimation);
+    static void ToCompact(FRuntimeMeshImportAnimation&& animation, FRuntimeMeshImportCompactAnimation& outAnimation);
+
+    // Unpacks to full precision. Normals, tangents, UVs and colors have the precision of the compact streams.
+    static void ToSectionInfo(const FRuntimeMeshImportCompactSection& section, FRuntimeMeshImportSectionInfo& outSection);
+    static void ToResult(FRuntimeMeshImportCompactResult&& result, FRuntimeMeshImportResult& outResult);
+    static void ToAnimation(const FRuntimeMeshImportCompactAnimation& animation, FRuntimeMeshImportAnimation& outAnimation);
+
+    // The arrays of UProceduralMeshComponent::CreateMeshSection
+    static void ToProceduralMeshSection(const FRuntimeMeshImportCompactSection& section, TArray<FVector>& outVertices, TArray<int32>& outTriangles
+        , TArray<FVector>& outNormals, TArray<FVector2D>& outUV0, TArray<FColor>& outVertexColors, TArray<FProcMeshTangent>& outTangents);
+
+    // The vertices and indices of a static mesh LOD, e.g. for FStaticMeshLODResources. Missing streams are zero, colors white.
+    static void ToStaticMeshBuildVertices(const FRuntimeMeshImportCompactSection& section, TArray<FStaticMeshBuildVertex>& outVertices, TArray<uint32>& outIndices);
+};
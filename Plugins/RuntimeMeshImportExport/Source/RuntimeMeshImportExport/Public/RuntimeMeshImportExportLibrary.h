@@ -7,6 +7,7 @@
 
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "LatentActions.h"
+#include "Async/Future.h"
 #include "Engine/LatentActionManager.h"
 #include "Interface/MeshExportable.h"
 #include "assimp/matrix4x4.h"
@@ -14,6 +15,15 @@
 #include "ProceduralMeshComponent.h"
 #include "RuntimeMeshImportExportLibrary.generated.h"
 
+class FAssimpIOSystem;
+class UInstancedStaticMeshComponent;
+class UBodySetup;
+struct aiScene;
+namespace Assimp
+{
+    class Importer;
+}
+
 
 /**
  * Library to import meshes from disk at runtime using Assimp library.
@@ -27,7 +37,7 @@ public:
 
     /**
      *	Import a mesh from various scene description files like fbx, gltf, obj, ... . @see GetSupportedExtensionsImport
-     *	Note: The hierarchy of the scene is not retained on import
+     *	Note: The hierarchy of the scene is only retained with FRuntimeMeshImportParam::bImportHierarchy
      *
      *	@param file					Depending on 'pathType'
      *	@param transform			A transform that is applied to the imported scene
@@ -46,7 +56,7 @@ public:
 
     /**
      *	Import a mesh from various scene description files like fbx, gltf, obj, ... . @see GetSupportedExtensionsImport
-     *	Note: The hierarchy of the scene is not retained on import
+     *	Note: The hierarchy of the scene is only retained with FRuntimeMeshImportParam::bImportHierarchy
      *
      *	@param file					Depending on 'pathType'
      *	@param transform			A transform that is applied to the imported scene
@@ -67,7 +77,7 @@ public:
 
     /**
      *	Import a mesh from various scene description files like fbx, gltf, obj, ... . @see GetSupportedExtensionsImpor
-     *	Note: The hierarchy of the scene is not retained on import
+     *	Note: The hierarchy of the scene is only retained with FRuntimeMeshImportParam::bImportHierarchy
      *
      *	@param file					Depending on 'pathType'
      *	@param transform			A transform that is applied to the imported scene
@@ -76,6 +86,7 @@ public:
      *	@param pathType				Choose whether the 'file' provided is absolute or relative
      *	@param importMethod			Choose if multiple mesh sections should get combined
      *	@param bNormalizeScene		When checked, the object is transformed to fit into a 100cm cube, objects placed around the center.
+     *	@param cancellationToken	Cancel the import with it. The result is empty then.
      */
     static void ImportScene_Async_Cpp(const FString file, const FTransform& transform
                                       , FRuntimeImportFinished callbackFinished
@@ -83,9 +94,154 @@ public:
                                       , const EPathType pathType = EPathType::Absolute
                                       , const EImportMethodMesh importMethodMesh = EImportMethodMesh::Keep
                                       , const EImportMethodSection importMethodSection = EImportMethodSection::MergeSameMaterial
-                                      , const bool bNormalizeMesh = false );
+                                      , const bool bNormalizeMesh = false
+                                      , const FRuntimeMeshImportExportCancellationToken& cancellationToken = FRuntimeMeshImportExportCancellationToken());
+
+    /**
+     *	Import a mesh from various scene description files like fbx, gltf, obj, ... . @see GetSupportedExtensionsImport
+     *	Note: The hierarchy of the scene is only retained with FRuntimeMeshImportParam::bImportHierarchy
+     *
+     *	@param param				The parameters for the import
+     *	@param result				Is filled with the result of the import
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    static void ImportSceneWithParam(const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& result);
+
+    /**
+     *	Import a mesh from various scene description files like fbx, gltf, obj, ... . @see GetSupportedExtensionsImport
+     *	Note: The hierarchy of the scene is only retained with FRuntimeMeshImportParam::bImportHierarchy
+     *
+     *	@param param				The parameters for the import
+     *	@param progressDelegate		Callback for a progress update of the import
+     *	@param result				Is filled with the result of the import
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import", meta = (Latent, WorldContext = "WorldContextObject", LatentInfo = "latentInfo"))
+    static void	ImportSceneWithParam_Async(UObject* worldContextObject, FLatentActionInfo latentInfo
+                                           , const FRuntimeMeshImportParam& param
+                                           , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
+                                           , FRuntimeMeshImportResult& result);
+
+    /**
+     *	Import a mesh from various scene description files like fbx, gltf, obj, ... . @see GetSupportedExtensionsImport
+     *	Note: The hierarchy of the scene is only retained with FRuntimeMeshImportParam::bImportHierarchy
+     *
+     *	@param param				The parameters for the import
+     *	@param callbackFinished     Called when the Import is finished
+     *  @param callbackProgress		Callback for a progress update of the import
+     */
+    static void ImportSceneWithParam_Async_Cpp(const FRuntimeMeshImportParam& param
+                                               , FRuntimeImportFinished callbackFinished
+                                               , FRuntimeMeshImportExportProgressUpdate callbackProgress);
+
+    /**
+     *	Import a scene asynchronous and receive each mesh as soon as all of its sections are converted,
+     *	while the other meshes are still converting. The mesh data is released after 'callbackMeshReady' returned.
+     *	The meshes arrive in the order they finish, not in the order of the scene.
+     *	Merging meshes and normalizing the scene need all meshes, they are ignored for a streaming import.
+     *	With FRuntimeMeshImportParam::bStreamProxies a box per mesh arrives first. Replace it with the mesh of the same streamingIndex.
+     *
+     *	@param param				The parameters for the import
+     *	@param callbackMeshReady	Called on the GameThread for each mesh. The material indices of the sections refer to the materials of 'callbackFinished'.
+     *	@param callbackFinished     Called after the last mesh. The result only contains the materials.
+     *  @param callbackProgress		Callback for a progress update of the import
+     */
+    static void ImportSceneWithParam_Streaming_Async_Cpp(const FRuntimeMeshImportParam& param
+                                                         , FRuntimeImportMeshReady callbackMeshReady
+                                                         , FRuntimeImportFinished callbackFinished
+                                                         , FRuntimeMeshImportExportProgressUpdate callbackProgress);
+
+    /**
+     *	Same as ImportSceneWithParam_Async_Cpp as a future. It is set on the worker thread right after the import, without a hop to the GameThread.
+     *	Chain the next stages with TFuture::Next, a continuation runs on the thread that sets the future,
+     *	e.g. PostProcessImportResult_AnyThread followed by MeshInfoToStaticMesh_Future or ApplyImportResultToProceduralMesh_Future.
+     *	The stages of several files overlap when each file has its own future.
+     *
+     *	@param param				The parameters for the import
+     *  @param callbackProgress		Callback for a progress update of the import
+     */
+    static TFuture<FRuntimeMeshImportResultPtr> ImportSceneWithParam_Future(const FRuntimeMeshImportParam& param
+                                                                            , FRuntimeMeshImportExportProgressUpdate callbackProgress = FRuntimeMeshImportExportProgressUpdate());
+
+    /**
+     *	Splits the large sections, welds, generates the LODs, optimizes and builds the BVHs, the collision and the geometry hashes of 'result' as requested by 'param', on the calling thread.
+     *	For a stage of its own, e.g. to import without them first. The import does the same, the merging and normalization are not repeated.
+     */
+    static void PostProcessImportResult_AnyThread(const FRuntimeMeshImportParam& param, FRuntimeMeshImportResult& result);
+
+    /**
+     *	Import a scene from a buffer in memory, e.g. an asset that was downloaded.
+     *	Note: The hierarchy of the scene is only retained with FRuntimeMeshImportParam::bImportHierarchy
+     *
+     *	@param buffer				The content of the scene file
+     *	@param formatHint			The extension of the format, e.g. "gltf" or "obj"
+     *	@param param				The parameters for the import. 'file' is optional, when set files the scene references are looked up relative to it.
+     *	@param siblingFiles			Files the scene references, e.g. the .mtl of an .obj. They are looked up before the file system.
+     *	@param result				Is filled with the result of the import
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    static void ImportSceneFromMemory(const TArray<uint8>& buffer, const FString& formatHint, const FRuntimeMeshImportParam& param
+                                      , const TArray<FRuntimeMeshImportMemoryFile>& siblingFiles, FRuntimeMeshImportResult& result);
 
-    // Returns all supported extensions for import
+    // Same as ImportSceneFromMemory, for buffers that are not in a TArray
+    static void ImportSceneFromMemory_Cpp(TArrayView<const uint8> buffer, const FString& formatHint, const FRuntimeMeshImportParam& param
+                                          , TArrayView<const FRuntimeMeshImportMemoryFile> siblingFiles, FRuntimeMeshImportResult& result);
+
+    /**
+     *	Import a scene from a buffer in memory asynchronous. The buffers are moved to the import task.
+     *	@see ImportSceneFromMemory
+     *
+     *	@param callbackFinished     Called when the Import is finished
+     *  @param callbackProgress		Callback for a progress update of the import
+     */
+    static void ImportSceneFromMemory_Async_Cpp(TArray<uint8> buffer, const FString& formatHint, const FRuntimeMeshImportParam& param
+                                                , TArray<FRuntimeMeshImportMemoryFile> siblingFiles
+                                                , FRuntimeImportFinished callbackFinished
+                                                , FRuntimeMeshImportExportProgressUpdate callbackProgress);
+
+    /**
+     *	Reads what the files contain without importing them, @see FRuntimeMeshImportSummary. The files are read in parallel.
+     *	Assimp only reads the files, no post processing besides the handedness runs, the meshes are not converted and no texture is loaded.
+     *	Of the params only 'file', 'pathType', 'transform' and 'bMemoryMapFile' are used.
+     *
+     *	@param outSummaries		One summary per param, in the same order
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    static void ProbeScenes(const TArray<FRuntimeMeshImportParam>& params, TArray<FRuntimeMeshImportSummary>& outSummaries);
+
+    // Same as ProbeScenes on a worker thread. 'callbackFinished' is called on the GameThread.
+    static void ProbeScenes_Async_Cpp(const TArray<FRuntimeMeshImportParam>& params, FRuntimeImportProbeFinished callbackFinished);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
+    static void ProbeScenes_Async(const TArray<FRuntimeMeshImportParam>& params, FRuntimeImportProbeFinishedDyn finishedDelegate);
+
+    // One file of ProbeScenes, on the calling thread
+    static void ProbeScene_AnyThread(const FRuntimeMeshImportParam& param, FRuntimeMeshImportSummary& outSummary);
+
+    /**
+     *	Converts a file to another format without importing it, @see FRuntimeMeshConvertParam.
+     *	The textures the file references are written as they are referenced, relative ones are not copied next to 'outputFile'.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Convert")
+    static void ConvertScene(const FRuntimeMeshConvertParam& param, FRuntimeMeshConvertResult& result);
+
+    // Same as ConvertScene on a worker thread. 'callbackFinished' is called on the GameThread.
+    static void ConvertScene_Async_Cpp(const FRuntimeMeshConvertParam& param, FRuntimeConvertFinished callbackFinished);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Convert")
+    static void ConvertScene_Async(const FRuntimeMeshConvertParam& param, FRuntimeConvertFinishedDyn finishedDelegate);
+
+    // Creates a token to cancel an import or export. Pass it with the parameters.
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static FRuntimeMeshImportExportCancellationToken MakeCancellationToken();
+
+    // Cancels the import or export that uses 'token'.
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void CancelToken(const FRuntimeMeshImportExportCancellationToken& token);
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport")
+    static bool IsTokenCancelled(const FRuntimeMeshImportExportCancellationToken& token);
+
+    // Whether files with the extension can be imported, with or without the dot. The extensions are queried once when the module starts.
     UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
     static bool GetIsExtensionSupportedImport(FString extension);
 
@@ -93,7 +249,7 @@ public:
     UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import")
     static void GetSupportedExtensionsImport(TArray<FString>& extensions);
 
-    // Returns all supported extensions for export
+    // Whether a format exports files with the extension, with or without the dot. The formats are queried once when the module starts.
     UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Export")
     static bool GetIsExtensionSupportedExport(FString extension);
 
@@ -120,46 +276,249 @@ public:
     UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport")
     static FString MaterialInfoToLogString(const FRuntimeMeshImportMaterialInfo& materialInfo);
 
+    /**
+     * Texture params with the same content share one texture through the texture cache, so the returned texture must not be modified.
+     * The texture is always uncompressed, 'compression' of the param is only applied by MaterialParamTextureToTexture2D_Async_Cpp.
+     * @param bUseTextureCache		Share the texture with earlier calls for the same content. When false, always creates a new texture
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static UTexture2D* MaterialParamTextureToTexture2D(const FRuntimeMeshImportExportMaterialParamTexture& textureParam, const bool bUseTextureCache = false);
+
+    /**
+     * Same as MaterialParamTextureToTexture2D, but the image is decoded and the mips are generated on a worker thread.
+     * Only the texture is created on the GameThread. 'callbackCreated' is called on the GameThread, with nullptr when it failed.
+     * The mips are block compressed on the worker thread as well, when the param has a compression.
+     * Large textures are streamed, @see SetTextureStreamingSettings.
+     * @param bGenerateMips			Generate the mip chain down to 1x1
+     */
+    static void MaterialParamTextureToTexture2D_Async_Cpp(const FRuntimeMeshImportExportMaterialParamTexture& textureParam, FRuntimeTextureCreated callbackCreated
+                                                          , const bool bGenerateMips = true, const bool bUseTextureCache = false);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void MaterialParamTextureToTexture2D_Async(const FRuntimeMeshImportExportMaterialParamTexture& textureParam, FRuntimeTextureCreatedDyn callbackCreated
+                                                      , const bool bGenerateMips = true, const bool bUseTextureCache = false);
+
+    /**
+     * Reads the file of a texture that was imported with FRuntimeMeshImportParam::bDeferTextureReads into its 'byteData', on the calling thread.
+     * The texture converters read it themselves, this is for other consumers of the bytes. Returns false when the texture has no data.
+     */
+    static bool LoadTextureData_AnyThread(FRuntimeMeshImportExportMaterialParamTexture& texture, const bool bUseTextureCache = false);
+
+    /**
+     * Sets the memory budgets of the texture cache that is shared by all imports of the session.
+     * @param fileBudgetMB		For the bytes of texture files
+     * @param textureBudgetMB	For the textures created by MaterialParamTextureToTexture2D
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void SetTextureCacheBudget(const int32 fileBudgetMB = 128, const int32 textureBudgetMB = 256);
+
+    // Removes everything from the texture cache. Textures that are still in use stay valid.
     UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
-    static UTexture2D* MaterialParamTextureToTexture2D(const FRuntimeMeshImportExportMaterialParamTexture& textureParam);
+    static void EmptyTextureCache();
+
+    /**
+     *	Sets the threads that the async imports, probes and exports run Assimp on, instead of the TaskGraph workers.
+     *	The threads are created again once the work that already runs on them is done.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void SetThreadPoolSettings(const FRuntimeMeshImportExportThreadPoolSettings& settings);
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport")
+    static FRuntimeMeshImportExportThreadPoolSettings GetThreadPoolSettings();
+
+    /**
+     *	Sets which textures that MaterialParamTextureToTexture2D_Async creates are streamed, @see FRuntimeMeshImportTextureStreamingSettings.
+     *	Only textures created afterwards are affected.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void SetTextureStreamingSettings(const FRuntimeMeshImportTextureStreamingSettings& settings);
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport")
+    static FRuntimeMeshImportTextureStreamingSettings GetTextureStreamingSettings();
 
     /**
      * Create a DynamicMaterialInstance from a given SourceMaterial and pass in parameters from MaterialInfo.
      * Only parameters from MaterialInfo that also exist in SourceMaterial can be assigned.
      * TextureParameter from MaterialInfo will only be loaded as UTexture2D if the parameter is present in SourceMaterial.
      * The Dnamic material will be name: SOURCEMATERIALNAME_MATERIALINFONAME
+     * Material infos with the same params share one material through the texture cache, so the returned material must not be modified.
+     * @param bUseMaterialCache		When false, always creates a new material
      */
     UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport", meta = (WorldContext = "worldContextObject"))
-    static UMaterialInstanceDynamic* MaterialInfoToDynamicMaterial(UObject* worldContextObject, const FRuntimeMeshImportMaterialInfo& materialInfo, UMaterialInterface* sourceMaterial);
+    static UMaterialInstanceDynamic* MaterialInfoToDynamicMaterial(UObject* worldContextObject, const FRuntimeMeshImportMaterialInfo& materialInfo, UMaterialInterface* sourceMaterial
+                                                                   , const bool bUseMaterialCache = true);
+
+    /**
+     * Same as MaterialInfoToDynamicMaterial, but the textures are created with MaterialParamTextureToTexture2D_Async_Cpp.
+     * The material is created right away, 'callbackCreated' is called on the GameThread when all textures are assigned.
+     * When the material or all textures are in the texture cache, it is called before this function returns.
+     * A material is shared once all its textures are assigned, the same material infos that are requested before get their own material.
+     */
+    static void MaterialInfoToDynamicMaterial_Async_Cpp(UObject* worldContextObject, const FRuntimeMeshImportMaterialInfo& materialInfo, UMaterialInterface* sourceMaterial
+                                                        , FRuntimeDynamicMaterialCreated callbackCreated, const bool bGenerateMips = true, const bool bUseMaterialCache = true);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport", meta = (WorldContext = "worldContextObject"))
+    static void MaterialInfoToDynamicMaterial_Async(UObject* worldContextObject, const FRuntimeMeshImportMaterialInfo& materialInfo, UMaterialInterface* sourceMaterial
+                                                    , FRuntimeDynamicMaterialCreatedDyn callbackCreated, const bool bGenerateMips = true, const bool bUseMaterialCache = true);
+
+    /**
+     * Creates a transient UStaticMesh from 'meshInfo' with one material slot per section, named after the material of the section.
+     * The vertex and index buffers are filled on a worker thread, only the creation of the mesh and its render resources run on the GameThread.
+     * 'callbackCreated' is called on the GameThread, with nullptr when the mesh has no triangles.
+     * The mesh has no collision, it is meant for rendering.
+     * @param materials		The material of each section, by section index. Missing materials are the default material.
+     */
+    static void MeshInfoToStaticMesh_Async_Cpp(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeStaticMeshCreated callbackCreated);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void MeshInfoToStaticMesh_Async(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeStaticMeshCreatedDyn callbackCreated);
+
+    /**
+     * Same as MeshInfoToStaticMesh_Async_Cpp as a stage of a chain of futures. The buffers are built on the calling thread, e.g. in a continuation
+     * of ImportSceneWithParam_Future. The future is set on the GameThread after the mesh was created, so its continuation runs there.
+     * The mesh is not kept alive by the future, use it within the continuation.
+     */
+    static TFuture<UStaticMesh*> MeshInfoToStaticMesh_Future(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<TWeakObjectPtr<UMaterialInterface>>& materials);
+
+    /**
+     * Creates a transient USkeletalMesh with its own USkeleton from 'meshInfo' and the bones of an import with bImportSkinning.
+     * Like MeshInfoToStaticMesh_Async_Cpp the buffers are filled on a worker thread and there is one material slot per section.
+     * The reference pose is the bind pose of the bones. The mesh has a single LOD and no morph targets.
+     * 'callbackCreated' is called on the GameThread, with nullptr when the mesh has no triangles or a section has more bones than GPU skinning supports.
+     * @param bones			FRuntimeMeshImportResult::bones of the result 'meshInfo' is from
+     */
+    static void MeshInfoToSkeletalMesh_Async_Cpp(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<FRuntimeMeshImportBone>& bones, const TArray<UMaterialInterface*>& materials
+                                                 , FRuntimeSkeletalMeshCreated callbackCreated);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void MeshInfoToSkeletalMesh_Async(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<FRuntimeMeshImportBone>& bones, const TArray<UMaterialInterface*>& materials
+                                             , FRuntimeSkeletalMeshCreatedDyn callbackCreated);
+
+    // Same as MeshInfoToSkeletalMesh_Async_Cpp as a stage of a chain of futures, @see MeshInfoToStaticMesh_Future
+    static TFuture<USkeletalMesh*> MeshInfoToSkeletalMesh_Future(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<FRuntimeMeshImportBone>& bones
+                                                                 , const TArray<TWeakObjectPtr<UMaterialInterface>>& materials);
+
+    /**
+     * Converts the sections of all meshes of 'result', mesh by mesh, into sections of UProceduralMeshComponent, in parallel. Can run on any thread.
+     * @param bReleaseResult		The arrays of each section of 'result' are freed right after it was converted
+     * @param outMaterialIndices	The material index of each section
+     */
+    static void ImportResultToProcMeshSections(FRuntimeMeshImportResult& result, const bool bReleaseResult, const bool bCreateCollision, const bool bFlipTangentY
+                                               , TArray<FProcMeshSection>& outSections, TArray<int32>& outMaterialIndices);
+
+    /**
+     * Replaces the sections of 'component' with copies of 'sections', e.g. of ImportResultToProcMeshSections. Must be called on the GameThread.
+     * The bounds, the collision and the render state are updated once.
+     * @param materials		The material of each section by its entry in 'materialIndices'. Missing materials are not set.
+     */
+    static void SetProcMeshSections(UProceduralMeshComponent& component, const TArray<FProcMeshSection>& sections, const TArray<int32>& materialIndices
+                                    , const TArray<UMaterialInterface*>& materials);
+
+    /**
+     * Replaces the sections of 'component' with the sections of all meshes of 'result', mesh by mesh.
+     * Each section is converted into the interleaved vertex buffer of the component in one pass, the sections in parallel,
+     * and moved into the component. The bounds, the collision and the render state are updated once.
+     * The vertices are used as imported, the instance transforms of the meshes are not applied.
+     * @param materials			The material of each section by its material index, e.g. created from 'result.materialInfos'. Missing materials are not set.
+     * @param bCreateCollision	Enables the collision of the sections, it is cooked by the component
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void ApplyImportResultToProceduralMesh(UProceduralMeshComponent* component, const FRuntimeMeshImportResult& result, const TArray<UMaterialInterface*>& materials
+                                                  , const bool bCreateCollision = false, const bool bFlipTangentY = false);
+
+    /**
+     * Same as ApplyImportResultToProceduralMesh, but the sections are converted on a worker thread from the moved 'result'.
+     * Only moving them into the component runs on the GameThread. 'callbackDone' is called on the GameThread after they were applied,
+     * it is not called when the component was destroyed in the meantime.
+     */
+    static void ApplyImportResultToProceduralMesh_Async_Cpp(UProceduralMeshComponent* component, FRuntimeMeshImportResult&& result, const TArray<UMaterialInterface*>& materials
+                                                            , FRuntimeImportExportGameThreadDone callbackDone, const bool bCreateCollision = false, const bool bFlipTangentY = false);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void ApplyImportResultToProceduralMesh_Async(UProceduralMeshComponent* component, const FRuntimeMeshImportResult& result, const TArray<UMaterialInterface*>& materials
+                                                        , FRuntimeImportExportGameThreadDoneDyn callbackDone, const bool bCreateCollision = false, const bool bFlipTangentY = false);
+
+    /**
+     * Same as ApplyImportResultToProceduralMesh_Async_Cpp as a stage of a chain of futures. The sections are converted on the calling thread,
+     * the arrays of 'result' are freed while converting when nothing else references it.
+     * The future is set on the GameThread after the sections were applied, it is false when the component was destroyed in the meantime.
+     */
+    static TFuture<bool> ApplyImportResultToProceduralMesh_Future(TWeakObjectPtr<UProceduralMeshComponent> component, const FRuntimeMeshImportResultRef& result
+                                                                  , const TArray<TWeakObjectPtr<UMaterialInterface>>& materials
+                                                                  , const bool bCreateCollision = false, const bool bFlipTangentY = false);
+
+    /**
+     * Adds an instance for each of 'meshInfo.instanceTransforms' to 'component', e.g. a UHierarchicalInstancedStaticMeshComponent
+     * with the static mesh of MeshInfoToStaticMesh_Async. The transforms are relative to the component.
+     * Returns the number of instances added.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static int32 AddMeshInfoInstances(UInstancedStaticMeshComponent* component, const FRuntimeMeshImportMeshInfo& meshInfo);
+
+    /**
+     * Traces the segment from 'start' to 'end' against the sections of 'meshInfo', in the space of its vertices.
+     * Needs the BVHs of FRuntimeMeshImportParam::bBuildBVH, sections without one are skipped.
+     * Returns true and the closest hit when a triangle is hit.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static bool RaycastMeshInfo(const FRuntimeMeshImportMeshInfo& meshInfo, const FVector& start, const FVector& end, FRuntimeMeshImportRaycastHit& hit);
+
+    /**
+     * Creates a UBodySetup with simple box collision from the BVHs of the sections, @see FRuntimeMeshImportBVH::GetCollisionBoxes.
+     * Boxes need no cooking, so the body setup can be used right away, e.g. for UStaticMesh::BodySetup. Complex traces use the boxes as well.
+     * Returns nullptr when no section has a BVH.
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static UBodySetup* CreateBodySetupFromBVH(UObject* outer, const FRuntimeMeshImportMeshInfo& meshInfo, const int32 maxBoxesPerSection = 16);
+
+    /**
+     * Creates a UBodySetup from the collision geometry of FRuntimeMeshImportParam::collision and cooks it on worker threads.
+     * Must be called on the GameThread. 'callbackCreated' is called on the GameThread with the cooked body setup,
+     * e.g. for UStaticMesh::BodySetup, or with nullptr when the mesh has no collision or the cooking failed.
+     */
+    static void MeshInfoToBodySetup_Async_Cpp(const FRuntimeMeshImportMeshInfo& meshInfo, FRuntimeBodySetupCreated callbackCreated);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport")
+    static void MeshInfoToBodySetup_Async(const FRuntimeMeshImportMeshInfo& meshInfo, FRuntimeBodySetupCreatedDyn callbackCreated);
 
     // Append 'append' to 'appendTo'. Add a newline before appending if last character of 'appendTo' is not already a newline
     static void NewLineAndAppend(FString& appendTo, const FString& append);
 
     static void OffsetTriangleArray(int32 offset, TArray<int32>& triangles);
 
+    // Returns the absolute path of 'file' depending on 'pathType'
+    static FString ResolveImportFilePath(const FString& file, const EPathType pathType);
+
     static FTransform AiTransformToFTransform(const aiMatrix4x4& transform);
     static aiMatrix4x4 FTransformToAiTransform(const FTransform& transform);
 
+	// Queues one GameThread task per call. For frequent updates use FRuntimeMeshImportExportProgressCoalescer.
 	static void SendProgress_AnyThread(FRuntimeMeshImportExportProgressUpdate delegateProgress, FRuntimeMeshImportExportProgress progress);
 
 private:
     /**
     *	Import a mesh from various scene description files like fbx, gltf, obj, ... . @see GetSupportedExtensionsImport
-    *	Note: The hierarchy of the scene is not retained on import
+    *	Note: The hierarchy of the scene is only retained with FRuntimeMeshImportParam::bImportHierarchy
     *
-    *	@param file					Depending on 'pathType'
-    *	@param transform			A transform that is applied to the imported scene
+    *	@param param				The parameters for the import
     *	@param callbackProgress     Callback for a progress update of the import
-    *	@param pathType				Choose whether the 'file' provided is absolute or relative
-    *	@param importMethodMesh		Choose how meshes shall be treated on import (applied before 'importMethodSection')
-    *	@param importMethodSection	Choose how mesh sections are treated on import (applied after 'importMethodMesh')
-    *	@param bNormalizeScene		When checked, the scene is transformed to fit into a 100cm cube, objects placed around the center.
+    *	@param result				Is filled with the result of the import
+    *	@param callbackMeshReady	When bound each mesh is moved to it instead of being added to 'result'
     */
-    static void ImportScene_AnyThread(const FString file, const FTransform& transform
+    static void ImportScene_AnyThread(const FRuntimeMeshImportParam& param
                                         , FRuntimeMeshImportExportProgressUpdate callbackProgress
                                         , FRuntimeMeshImportResult& result
-                                        , const EPathType pathType = EPathType::Absolute
-                                        , const EImportMethodMesh importMethodMesh = EImportMethodMesh::Keep
-                                        , const EImportMethodSection importMethodSection = EImportMethodSection::MergeSameMaterial
-                                        , const bool bNormalizeScene = false);
+                                        , FRuntimeImportMeshReady callbackMeshReady = FRuntimeImportMeshReady());
+
+    static void ImportSceneFromMemory_AnyThread(TArrayView<const uint8> buffer, const FString& formatHint, const FRuntimeMeshImportParam& param
+                                                , TArrayView<const FRuntimeMeshImportMemoryFile> siblingFiles
+                                                , FRuntimeMeshImportExportProgressUpdate callbackProgress
+                                                , FRuntimeMeshImportResult& result);
+
+    // Sets up the importer, lets 'readScene' read the scene and converts it to 'result'
+    static void ImportScene_Internal(const FRuntimeMeshImportParam& param, const FString& sceneName, FAssimpIOSystem& ioSystem
+                                     , TFunctionRef<const aiScene*(Assimp::Importer& importer, const unsigned int postProcessFlags)> readScene
+                                     , FRuntimeMeshImportExportProgressUpdate callbackProgress
+                                     , FRuntimeMeshImportResult& result
+                                     , FRuntimeImportMeshReady callbackMeshReady = FRuntimeImportMeshReady());
 };
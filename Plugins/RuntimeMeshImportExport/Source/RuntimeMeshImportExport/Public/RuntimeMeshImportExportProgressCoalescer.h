@@ -0,0 +1,53 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "RuntimeMeshImportExportTypes.h"
+
+/**
+ *	Collects the progress of one import or export from any thread and delivers it on the GameThread.
+ *
+ *	Workers only overwrite the latest progress of each progress type. At most one task is queued on the
+ *	GameThread at a time, it delivers the latest value of each type that changed since the last delivery.
+ *	Updates that advance a type by less than 'minPercentageStep', or that come less than 'minIntervalSeconds'
+ *	after the last queued task, are stored but do not queue a task, the first and the last update of a type always do.
+ */
+class RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportExportProgressCoalescer : public TSharedFromThis<FRuntimeMeshImportExportProgressCoalescer, ESPMode::ThreadSafe>
+{
+public:
+    static TSharedRef<FRuntimeMeshImportExportProgressCoalescer, ESPMode::ThreadSafe> Create(FRuntimeMeshImportExportProgressUpdate delegateProgress, const float minPercentageStep = 1.f, const float minIntervalSeconds = 0.05f);
+
+    // Thread safe. Called on the GameThread the progress is delivered immediately.
+    void Send_AnyThread(const FRuntimeMeshImportExportProgress& progress);
+
+private:
+    FRuntimeMeshImportExportProgressCoalescer(FRuntimeMeshImportExportProgressUpdate inDelegateProgress, const float inMinPercentageStep, const float inMinIntervalSeconds);
+
+    void Deliver_GameThread();
+
+    struct FProgressSlot
+    {
+        FRuntimeMeshImportExportProgress latest;
+        // Percentage of the last value that queued a delivery
+        float queuedPercentage = -1.f;
+        bool bDirty = false;
+    };
+
+    FRuntimeMeshImportExportProgressUpdate delegateProgress;
+    const float minPercentageStep;
+    const float minIntervalSeconds;
+
+    // Guards 'slots', 'bDeliveryQueued' and 'lastQueueTime'
+    FCriticalSection slotsLock;
+    // In the order the types appeared first
+    TArray<FProgressSlot, TInlineAllocator<8>> slots;
+    bool bDeliveryQueued = false;
+    // FPlatformTime::Seconds of the last queued delivery
+    double lastQueueTime = 0.;
+};
+
+typedef TSharedRef<FRuntimeMeshImportExportProgressCoalescer, ESPMode::ThreadSafe> FRuntimeMeshImportExportProgressCoalescerRef;
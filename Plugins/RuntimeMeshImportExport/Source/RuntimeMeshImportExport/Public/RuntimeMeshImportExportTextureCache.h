@@ -0,0 +1,129 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "UObject/GCObject.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UTexture;
+class UTexture2D;
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+struct FRuntimeMeshImportExportMaterialParamTexture;
+struct FRuntimeMeshImportMaterialInfo;
+
+/**
+ *	Session wide cache of texture files and of the UTexture2D that are created from texture bytes,
+ *	so textures that are used by many materials and imports are only read and decoded once.
+ *
+ *	Files are keyed by their absolute path, a cached file is only used while its size and modification time did not change.
+ *	Textures are keyed by the content hash of their bytes, @see HashContent.
+ *	Files and textures have their own memory budget, the least recently used entries are evicted first.
+ *	The files can be used from any thread, the textures only on the GameThread.
+ *
+ *	It also remembers the texture files written by the export, these are rewritten only when the texture
+ *	changed (its lighting guid) or the file was changed or removed on disk.
+ *
+ *	The dynamic materials created from material infos are shared as well, keyed by their source material and @see HashMaterialInfo.
+ *	They are only referenced weakly, so a material stays shared as long as something else uses it. GameThread only.
+ */
+class RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportExportTextureCache : public FGCObject
+{
+public:
+    // Is created and destroyed with the module
+    static FRuntimeMeshImportExportTextureCache& Get();
+    static void Startup();
+    static void Shutdown();
+
+    // Budgets in bytes. A budget of 0 disables that part of the cache.
+    void SetBudget(const int64 inFileBudget, const int64 inTextureBudget);
+    void Empty();
+
+    // Copies the bytes of 'file' to 'outData' and returns true when the file is cached and did not change on disk
+    bool FindFile_AnyThread(const FString& file, TArray<uint8>& outData);
+    void AddFile_AnyThread(const FString& file, const TArray<uint8>& data);
+
+    // True when 'file' was written from 'texture' before and both are unchanged
+    bool FindExportedTexture_AnyThread(const FString& file, UTexture* texture);
+    void AddExportedTexture_AnyThread(const FString& file, UTexture* texture);
+
+    UTexture2D* FindTexture(const uint64 contentHash);
+    void AddTexture(const uint64 contentHash, UTexture2D* texture);
+
+    /**
+     * Hash of the bytes and the dimensions of 'texture', or the file identity when its read is deferred. Never 0.
+     * It is not stored with the texture, 'byteData' and 'sourceFile' can be changed after the import.
+     */
+    static uint64 HashContent(const FRuntimeMeshImportExportMaterialParamTexture& texture);
+    static uint64 HashContent(TArrayView<const uint8> bytes, const int32 width, const int32 height);
+
+    // Hash of the path, size and modification time of 'file', in place of the content hash of a texture that is not read yet. 0 when the file does not exist.
+    static uint64 HashFileIdentity(const FString& file);
+
+    // Only materials with all their textures assigned must be added
+    UMaterialInstanceDynamic* FindMaterial(UMaterialInterface* sourceMaterial, const uint64 materialInfoHash);
+    void AddMaterial(UMaterialInterface* sourceMaterial, const uint64 materialInfoHash, UMaterialInstanceDynamic* material);
+
+    // Hash of the params and modes of 'materialInfo', without its name, so identical materials of different files match
+    static uint64 HashMaterialInfo(const FRuntimeMeshImportMaterialInfo& materialInfo);
+
+    //~ Begin FGCObject Interface
+    virtual void AddReferencedObjects(FReferenceCollector& collector) override;
+    virtual FString GetReferencerName() const override;
+    //~ End FGCObject Interface
+
+private:
+    struct FFileEntry
+    {
+        TArray<uint8> data;
+        int64 numBytes = 0;
+        int64 fileSize = 0;
+        FDateTime modificationTime;
+        uint64 lastUse = 0;
+    };
+
+    struct FTextureEntry
+    {
+        UTexture2D* texture = nullptr;
+        int64 numBytes = 0;
+        uint64 lastUse = 0;
+    };
+
+    struct FExportedTextureEntry
+    {
+        TWeakObjectPtr<UTexture> texture;
+        FGuid lightingGuid;
+        int64 fileSize = 0;
+        FDateTime modificationTime;
+    };
+
+    // Removes the least recently used entries until 'usedBytes' fits into 'budget'
+    template<typename KeyType, typename EntryType>
+    static void Evict(TMap<KeyType, EntryType>& entries, int64& usedBytes, const int64 budget);
+
+    // Guards everything about the files
+    FCriticalSection filesLock;
+    TMap<FString, FFileEntry> files;
+    int64 fileBudget = 128 * 1024 * 1024;
+    int64 fileBytes = 0;
+    uint64 fileUseCounter = 0;
+    // Only a path and a few stamps each, not part of the budgets
+    TMap<FString, FExportedTextureEntry> exportedTextures;
+
+    struct FMaterialEntry
+    {
+        TWeakObjectPtr<UMaterialInterface> sourceMaterial;
+        TWeakObjectPtr<UMaterialInstanceDynamic> material;
+    };
+    // Keyed by the hash of the material info combined with the source material, the entry tells them apart on collision
+    TMultiMap<uint64, FMaterialEntry> materials;
+
+    TMap<uint64, FTextureEntry> textures;
+    int64 textureBudget = 256 * 1024 * 1024;
+    int64 textureBytes = 0;
+    uint64 textureUseCounter = 0;
+};
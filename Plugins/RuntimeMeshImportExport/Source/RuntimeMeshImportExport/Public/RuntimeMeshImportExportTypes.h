@@ -6,18 +6,46 @@
 
 #include "CoreMinimal.h"
 #include "Materials/MaterialInterface.h"
+#include "HAL/ThreadSafeBool.h"
 #include "RuntimeMeshImportExportTypes.generated.h"
 
 struct FRuntimeMeshExportResult;
 struct FRuntimeMeshImportResult;
+struct FRuntimeMeshImportSummary;
+struct FRuntimeMeshImportMeshInfo;
+struct FRuntimeMeshImportNode;
 struct FRuntimeMeshImportExportProgress;
 struct aiExportFormatDesc;
+struct FRuntimeMeshImportBVH;
+struct FMorphTargetDelta;
+class UTexture2D;
+class UMaterialInstanceDynamic;
+class UStaticMesh;
+class USkeletalMesh;
+class UBodySetup;
 
 
 DECLARE_DELEGATE(FRuntimeImportExportGameThreadDone);
 DECLARE_DYNAMIC_DELEGATE(FRuntimeImportExportGameThreadDoneDyn);
-DECLARE_DELEGATE_OneParam(FRuntimeExportFinished, const FRuntimeMeshExportResult /*result*/);
-DECLARE_DELEGATE_OneParam(FRuntimeImportFinished, const FRuntimeMeshImportResult /*result*/);
+// The results are handed from the worker thread to the callbacks without copying them
+typedef TSharedRef<FRuntimeMeshExportResult, ESPMode::ThreadSafe> FRuntimeMeshExportResultRef;
+typedef TSharedRef<FRuntimeMeshImportResult, ESPMode::ThreadSafe> FRuntimeMeshImportResultRef;
+// For the futures of the results, TFuture needs a value that can be default constructed. They are never null.
+typedef TSharedPtr<FRuntimeMeshExportResult, ESPMode::ThreadSafe> FRuntimeMeshExportResultPtr;
+typedef TSharedPtr<FRuntimeMeshImportResult, ESPMode::ThreadSafe> FRuntimeMeshImportResultPtr;
+DECLARE_DELEGATE_OneParam(FRuntimeExportFinished, FRuntimeMeshExportResultRef /*result*/);
+DECLARE_DELEGATE_OneParam(FRuntimeImportFinished, FRuntimeMeshImportResultRef /*result*/);
+DECLARE_DELEGATE_OneParam(FRuntimeImportMeshReady, const FRuntimeMeshImportMeshInfo /*meshInfo*/);
+DECLARE_DELEGATE_OneParam(FRuntimeTextureCreated, UTexture2D* /*texture*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FRuntimeTextureCreatedDyn, UTexture2D*, texture);
+DECLARE_DELEGATE_OneParam(FRuntimeDynamicMaterialCreated, UMaterialInstanceDynamic* /*material*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FRuntimeDynamicMaterialCreatedDyn, UMaterialInstanceDynamic*, material);
+DECLARE_DELEGATE_OneParam(FRuntimeStaticMeshCreated, UStaticMesh* /*staticMesh*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FRuntimeStaticMeshCreatedDyn, UStaticMesh*, staticMesh);
+DECLARE_DELEGATE_OneParam(FRuntimeSkeletalMeshCreated, USkeletalMesh* /*skeletalMesh*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FRuntimeSkeletalMeshCreatedDyn, USkeletalMesh*, skeletalMesh);
+DECLARE_DELEGATE_OneParam(FRuntimeBodySetupCreated, UBodySetup* /*bodySetup*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FRuntimeBodySetupCreatedDyn, UBodySetup*, bodySetup);
 
 UENUM(BlueprintType)
 enum class ERuntimeMeshImportExportProgressType : uint8
@@ -36,7 +64,11 @@ enum class ERuntimeMeshImportExportProgressType : uint8
 	// Iterating scene nodes for meshes
     ImportingMeshes,
 	// Importing material data from Assimp to Unreal
-    ImportingMaterials
+    ImportingMaterials,
+	// Importing the files of a batch, current and max are counted in files
+    ImportingFiles,
+	// Applying an import result to a component, current and max are counted in sections, materials and textures
+    ApplyingImportResult
 };
 
 USTRUCT(BlueprintType)
@@ -56,9 +88,128 @@ struct FRuntimeMeshImportExportProgress
     int32 max = 0;
 };
 
+/**
+ *	Allows to cancel an import or export that is running on another thread.
+ *	Copies of a token share the same state. A default constructed token can not be cancelled,
+ *	use URuntimeMeshImportExportLibrary::MakeCancellationToken to create one that can.
+ */
+USTRUCT(BlueprintType)
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportExportCancellationToken
+{
+    GENERATED_BODY()
+
+    static FRuntimeMeshImportExportCancellationToken Create();
+
+    // Thread safe
+    void Cancel() const;
+    // Thread safe
+    bool IsCancelled() const;
+    // False for a token that was not made with Create, it can not be cancelled
+    bool IsValid() const
+    {
+        return bCancelled.IsValid();
+    }
+
+private:
+    TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> bCancelled;
+};
+
 DECLARE_DELEGATE_OneParam(FRuntimeMeshImportExportProgressUpdate, const FRuntimeMeshImportExportProgress& /*status*/);
 DECLARE_DYNAMIC_DELEGATE_OneParam(FRuntimeMeshImportExportProgressUpdateDyn, const FRuntimeMeshImportExportProgress&, progress);
 
+// A file of an export to memory, @see FRuntimeMeshExportParam::bExportToMemory
+USTRUCT(BlueprintType)
+struct FRuntimeMeshExportedFile
+{
+    GENERATED_BODY()
+
+    // The clean file name, e.g. the name of 'file' of the export, its .mtl or .bin, or a texture
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FString name;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<uint8> data;
+};
+
+/**
+ *	The wall clock seconds of the stages of an export. The async gather includes the time between its ticks.
+ *	The streaming export gathers while it writes, it only has 'writeSeconds'.
+ */
+USTRUCT(BlueprintType)
+struct FRuntimeMeshExportStageTimings
+{
+    GENERATED_BODY()
+
+    // Reading the mesh data of the exportables
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float gatherSeconds = 0.f;
+
+    // Grouping, optimizing and converting the gathered data into the Assimp scene, including the materials
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float processSeconds = 0.f;
+
+    // Encoding and writing the textures. The files are written while Assimp writes the geometry.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float textureSeconds = 0.f;
+
+    // Assimp or the stream writer writing the export file
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float writeSeconds = 0.f;
+
+    // How long the export waited for the textures after the write
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float textureWaitSeconds = 0.f;
+
+    // From the start of the export until its result is ready
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float totalSeconds = 0.f;
+};
+
+/**
+ *	What an export wrote and what it cost besides the wall clock, collected by every export.
+ *	The streaming export does not count the materials and textures, its writer handles them.
+ */
+USTRUCT(BlueprintType)
+struct FRuntimeMeshExportMetrics
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 numMeshes = 0;
+
+    // The nodes or glTF instances that reference the meshes of a shared or instanced exportable, @see IMeshExportable::GetInstanceTransforms
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 numInstances = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int64 numVertices = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int64 numTriangles = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 numMaterials = 0;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int32 numTextures = 0;
+
+    // The exported file and the textures. The extra files of a format (e.g. mtl or bin) are only counted by the Assimp export with bBufferedFileWrites or bExportToMemory.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    int64 bytesWritten = 0;
+
+    // The parallel stages (thread safe gathers, optimization, filling the meshes, texture encoding) summed over all threads
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float threadSeconds = 0.f;
+
+    // The high water mark of the physical memory of the process when the export finished
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float peakUsedPhysicalMB = 0.f;
+
+    // How much more physical memory the process used after the export than before it
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    float usedPhysicalGrowthMB = 0.f;
+};
+
 USTRUCT(BlueprintType)
 struct FRuntimeMeshExportResult
 {
@@ -67,7 +218,7 @@ struct FRuntimeMeshExportResult
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     bool bSuccess;
 
-    // 	The log created during export (independent of bLogToUnreal).
+    // 	The log created during export (independent of bLogToUnreal), the lines of FRuntimeMeshExportParam::exportLogSeverity and above.
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     FString exportLog;
 
@@ -78,6 +229,16 @@ struct FRuntimeMeshExportResult
     // If this is > 0, you should check the exportLog for reasons.
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     int32 numObjectsSkipped;
+
+    // The files of an export to memory, the exported file first. Empty when FRuntimeMeshExportParam::exportedFileSink took them.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<FRuntimeMeshExportedFile> files;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshExportStageTimings timings;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshExportMetrics metrics;
 };
 
 UENUM(BlueprintType)
@@ -111,24 +272,91 @@ struct FTransformCorrection
     float scaleFactor = 1;
 };
 
+// File format of the textures written by the export
+UENUM(BlueprintType)
+enum class ERuntimeMeshExportTextureFormat : uint8
+{
+    // Lossless, keeps the alpha
+    PNG,
+    // Lossy and much smaller, for color maps. @see FRuntimeMeshExportParam::textureQuality
+    JPG,
+};
+
+// How important a line of the export log is, @see FRuntimeMeshExportParam::exportLogSeverity
+UENUM(BlueprintType)
+enum class ERuntimeMeshExportLogSeverity : uint8
+{
+    // Details per node and per material, and the debug messages of Assimp
+    Verbose,
+    // The stages of the export and their durations
+    Log,
+    // Skipped exportables and textures
+    Warning,
+    Error,
+    // Nothing is logged
+    Off,
+};
+
+// How the nodes of the hierarchical names are written, @see FRuntimeMeshExportParam::hierarchy
+UENUM(BlueprintType)
+enum class ERuntimeMeshExportHierarchy : uint8
+{
+    // A node for every segment of the names
+    Keep,
+    // Nodes without exportables are removed when they have a single child, or no exportables below them. Their transforms are baked into the children.
+    CollapseEmpty,
+    // The nodes with exportables become children of the root with their transform relative to it, all others are removed
+    Flatten,
+};
+
+// How vertex colors are converted between the floats of the files and the FColor of Unreal, @see FRuntimeMeshImportParam::vertexColorSpace, FRuntimeMeshExportParam::vertexColorSpace
+UENUM(BlueprintType)
+enum class ERuntimeMeshVertexColorSpace : uint8
+{
+    // The floats are the bytes divided by 255, like FColor::ReinterpretAsLinear and FLinearColor::ToFColor(false)
+    Linear,
+    // The bytes are sRGB encoded, like FLinearColor(FColor) and FLinearColor::ToFColor(true)
+    SRGB,
+};
+
 USTRUCT(BlueprintType)
 struct FRuntimeMeshExportParam
 {
     GENERATED_BODY()
 
-    // Set to true to combine mesh sections with the same material within the same node
+    // Set to true to combine mesh sections with the same material within the same node.
+    // The stream writers combine the sections of each exportable, @see bStreamingExport, bNativeGltfExport.
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     bool bCombineSameMaterial = false;
 
+    // Fewer nodes load faster in the engines and viewers that walk every node. The meshes stay in the space of their node.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    ERuntimeMeshExportHierarchy hierarchy = ERuntimeMeshExportHierarchy::Keep;
+
+    // Exports the meshes of the exportables with the same IMeshExportable::GetSharedMeshKey once. Each of the exportables is a node under its node
+    // that references them with its transform, only the first one is gathered. Not used by the stream writers, @see bStreamingExport, bNativeGltfExport.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    bool bShareIdenticalMeshes = false;
+
     // The LOD that shall be exported
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     int32 lod = 0;
 
+    // SRGB decodes the FColor of the exportables to linear floats for the formats with float colors and glTF, which expects linear colors like Unreal materials.
+    // Linear writes the bytes divided by 255.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    ERuntimeMeshVertexColorSpace vertexColorSpace = ERuntimeMeshVertexColorSpace::Linear;
+
     // True: Skip the mesh if 'lod' is not available.
     // False: Mesh shall return the next possible LOD
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     bool bSkipLodNotValid = false;
 
+    // More LODs gathered from the exportables in the same pass as 'lod'. Only written by the stream writers, @see bStreamingExport, bNativeGltfExport:
+    // glTF adds them as MSFT_lod alternatives of each node, the other formats write them to <file>_LOD<n>.<ext>. The Assimp export only writes 'lod'.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    TArray<int32> additionalLods;
+
     // Can be obtained with URuntimeMeshImportExportLibrary::GetSupportedExtensionsExport
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     FString formatId;
@@ -150,6 +378,114 @@ struct FRuntimeMeshExportParam
     // Note: Important stuff is logged nonetheless.
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     bool bLogToUnreal;
+
+    // The lines below this severity are neither formatted nor kept, for the export log and for bLogToUnreal
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    ERuntimeMeshExportLogSeverity exportLogSeverity = ERuntimeMeshExportLogSeverity::Log;
+
+    // Cancels the export when set. The gathering checks it between the nodes.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshImportExportCancellationToken cancellationToken;
+
+    // Format of the texture files. They are written next to 'file' while Assimp writes the geometry.
+    UPROPERTY(BlueprintReadWrite, Category = "Textures")
+    ERuntimeMeshExportTextureFormat textureFormat = ERuntimeMeshExportTextureFormat::PNG;
+
+    // Quality of JPG textures, 1 to 100
+    UPROPERTY(BlueprintReadWrite, Category = "Textures", meta = (ClampMin = "1", ClampMax = "100"))
+    int32 textureQuality = 85;
+
+    // Embeds the textures into the exported file instead of writing them next to it, e.g. for glb.
+    // Only formats that support embedded textures keep them.
+    UPROPERTY(BlueprintReadWrite, Category = "Textures")
+    bool bEmbedTextures = false;
+
+    /**
+     * Writes each exportable to the file right after it is gathered and frees it, instead of building the whole scene for Assimp first.
+     * Only one exportable is in memory at a time. Materials are only written by name and 'bCombineSameMaterial' is not used.
+     * obj, stl and ply are written in the space of the file without the node hierarchy.
+     * Supported by the formats obj, objnomtl, stl, stlb, plyb, gltf2 and glb2. Other formats and Export_Async use the regular export.
+     */
+    UPROPERTY(BlueprintReadWrite, Category = "Streaming")
+    bool bStreamingExport = false;
+
+    // gltf2 and glb2 are written by the plugin instead of Assimp, the streams are copied to the buffers as they are. Also with Export_Async.
+    // The materials only get the BaseColor, Metallic_strength and Roughness_strength parameters, no textures.
+    UPROPERTY(BlueprintReadWrite, Category = "glTF")
+    bool bNativeGltfExport = false;
+
+    // With the plugin's glTF writer: positions, normals and texture coordinates are quantized with KHR_mesh_quantization
+    UPROPERTY(BlueprintReadWrite, Category = "glTF")
+    bool bQuantizeGltf = false;
+
+    // With 'bQuantizeGltf': normals as normalized bytes, otherwise they stay floats
+    UPROPERTY(BlueprintReadWrite, Category = "glTF")
+    bool bQuantizeGltfNormals = true;
+
+    // With 'bQuantizeGltf': texture coordinates as normalized shorts, for the primitives whose coordinates are all within 0 to 1
+    UPROPERTY(BlueprintReadWrite, Category = "glTF")
+    bool bQuantizeGltfTexCoords = true;
+
+    // With the plugin's glTF writer: the instances of an instanced exportable are one node with EXT_mesh_gpu_instancing instead of a node each.
+    // Their positions are not quantized then, the instance transforms are applied before the node's.
+    UPROPERTY(BlueprintReadWrite, Category = "glTF")
+    bool bGltfGpuInstancing = true;
+
+    /**
+     * Exports with Assimp::Exporter::ExportToBlob into FRuntimeMeshExportResult::files instead of writing to disk, including the textures
+     * and the extra files of a format like the .mtl of obj. 'file' only names the files, it is not checked or created.
+     * The streaming export and the plugin's glTF writer are not used.
+     */
+    UPROPERTY(BlueprintReadWrite, Category = "Memory")
+    bool bExportToMemory = false;
+
+    // C++ only: with 'bExportToMemory' each file is passed here as soon as it is complete instead of to the result, e.g. to start its upload.
+    // Called on the export threads, textures can arrive while the geometry is still exported.
+    TFunction<void(FRuntimeMeshExportedFile&& file)> exportedFileSink;
+
+    /**
+     * Collects the writes of Assimp in buffers of 'fileWriteBufferSizeKB' and writes each full buffer on a worker thread while Assimp fills the next one,
+     * instead of writing every small write of Assimp synchronously. Helps most with network shares. Not used by the streaming export and the plugin's glTF writer.
+     */
+    UPROPERTY(BlueprintReadWrite, Category = "File Writes")
+    bool bBufferedFileWrites = true;
+
+    UPROPERTY(BlueprintReadWrite, Category = "File Writes", meta = (ClampMin = "4"))
+    int32 fileWriteBufferSizeKB = 4096;
+
+    // The optimization steps below run in parallel per exported mesh, after the sections are grouped and before Assimp writes them.
+    // Not used by the streaming export and the plugin's glTF writer.
+
+    // Merges the vertices of each exported mesh that are equal within the tolerances below, e.g. the duplicates along former section seams
+    UPROPERTY(BlueprintReadWrite, Category = "Optimization")
+    bool bWeldVertices = false;
+
+    // Distance in units of the node the mesh is exported in
+    UPROPERTY(BlueprintReadWrite, Category = "Optimization", meta = (ClampMin = "0"))
+    float weldPositionTolerance = 0.001f;
+
+    // Distance between the normals and between the tangents
+    UPROPERTY(BlueprintReadWrite, Category = "Optimization", meta = (ClampMin = "0"))
+    float weldNormalTolerance = 0.01f;
+
+    UPROPERTY(BlueprintReadWrite, Category = "Optimization", meta = (ClampMin = "0"))
+    float weldUVTolerance = 0.0001f;
+
+    // Removes the triangles with repeated corners or without area, after the welding
+    UPROPERTY(BlueprintReadWrite, Category = "Optimization")
+    bool bRemoveDegenerateTriangles = false;
+
+    // Share of the triangles of each mesh that is kept, simplified with quadric edge collapse. 1 keeps the geometry.
+    UPROPERTY(BlueprintReadWrite, Category = "Optimization", meta = (ClampMin = "0.01", ClampMax = "1"))
+    float triangleRatio = 1.f;
+
+    // Reorders the triangles of each mesh for the post transform vertex cache and the vertices by their first use, as the last step
+    UPROPERTY(BlueprintReadWrite, Category = "Optimization")
+    bool bOptimizeVertexCache = false;
+
+    // Entries of the post transform cache to optimize for
+    UPROPERTY(BlueprintReadWrite, Category = "Optimization", meta = (ClampMin = "3", ClampMax = "64"))
+    int32 vertexCacheSize = 16;
 };
 
 
@@ -158,14 +494,69 @@ struct FRuntimeMeshExportAsyncParam
 {
     GENERATED_BODY()
 
-    // The number of mesh data to gather per tick from exportables
+    // The number of mesh data to gather per tick from exportables. Not used with 'gatherBudgetMs'.
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     int32 numGatherPerTick;
 
+    // When above 0, the exportables are gathered per tick until this many milliseconds are spent instead of 'numGatherPerTick'.
+    // At least one exportable is gathered per tick.
+    UPROPERTY(BlueprintReadWrite, Category = "Default", meta = (ClampMin = "0"))
+    float gatherBudgetMs = 0.f;
+
+    // With 'gatherBudgetMs', an exportable is left for the next tick when the average duration of earlier gathers
+    // of its class does not fit into the remaining budget
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    bool bUseGatherCostEstimates = true;
+
+    /**
+     * Takes a snapshot of the scene in the tick the export starts instead of gathering over several ticks, so the game can modify the scene right after.
+     * The exportables with IMeshExportable::GetMeshDataViews only hand over references to their buffers, the copies are made on the worker threads.
+     * The other exportables copy their data in that tick, the thread safe ones still on the worker threads. Not used with 'numGatherPerTick' and 'gatherBudgetMs'.
+     */
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    bool bSnapshotGather = false;
+
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     FRuntimeMeshExportParam param;
 };
 
+UENUM(BlueprintType)
+enum class ERuntimeMeshExportJobPriority : uint8
+{
+    // Exports the user waits for, e.g. "save as". They never wait for Normal or Background jobs to finish.
+    High,
+    Normal,
+    // e.g. auto saves
+    Background,
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshExportQueueStats
+{
+    GENERATED_BODY()
+
+    // Jobs waiting to be started
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+    int32 numQueued = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+    int32 numRunning = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+    int32 numFinished = 0;
+
+    // Average seconds from enqueuing a job to starting it
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+    float averageWaitSeconds = 0.f;
+
+    // Average seconds from enqueuing a job to its result
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+    float averageLatencySeconds = 0.f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+    float lastLatencySeconds = 0.f;
+};
+
 
 USTRUCT(BlueprintType)
 struct FExportableMeshSection
@@ -191,11 +582,34 @@ struct FExportableMeshSection
     UPROPERTY(BlueprintReadWrite, Category = "Default")
     TArray<int32> triangles;
 
-    // Append other data to this if it has the same material
+    // Append other data to this if it has the same material. The buffers of 'other' are taken over when this is empty.
     void Append(FExportableMeshSection&& other);
+    // Appends all of 'others', which must have the same material, with one allocation per stream. They are emptied.
+    void AppendAll(TArrayView<FExportableMeshSection* const> others);
 
 };
 
+/**
+ *	The C++ counterpart of FExportableMeshSection, @see IMeshExportable::GetMeshDataViews.
+ *	The streams are views into the buffers of the exportable. They are read after the gather on worker threads,
+ *	so they must stay valid and unchanged until the export is done. An exportable whose buffers can change
+ *	can keep them alive with 'owner', e.g. by replacing a shared buffer instead of writing to it.
+ */
+struct FExportableMeshSectionView
+{
+    FTransform meshToWorld;
+    UMaterialInterface* material = nullptr;
+    TArrayView<const FVector> vertices;
+    TArrayView<const FVector> normals;
+    TArrayView<const FVector> tangents;
+    TArrayView<const FVector2D> textureCoordinates;
+    // May be empty when the mesh has no colors
+    TArrayView<const FColor> vertexColors;
+    TArrayView<const int32> triangles;
+    // Released after the export read the streams
+    TSharedPtr<const void, ESPMode::ThreadSafe> owner;
+};
+
 UENUM(BlueprintType)
 enum class EPathType : uint8
 {
@@ -211,6 +625,9 @@ enum class EImportMethodMesh : uint8
     Keep,
     // Merge all meshes together to a single mesh
     Merge,
+    // Merge the sections of the same material into spatial clusters of about 'clusterTargetTriangles', one mesh per cluster.
+    // Saves draw calls like Merge and the clusters are still culled.
+    MergeByCluster,
 };
 
 UENUM(BlueprintType)
@@ -224,119 +641,867 @@ enum class EImportMethodSection : uint8
     MergeSameMaterial,
 };
 
+// @see FRuntimeMeshImportParam::importProfile
+UENUM(BlueprintType)
+enum class ERuntimeMeshImportProfile : uint8
+{
+    // The params are used as they are set
+    Manual,
+    // The mesh and section methods, the instancing, the welding and the splitting of large sections are chosen from the counts of the scene
+    Auto,
+};
+
+UENUM(BlueprintType)
+enum class ERuntimeMeshImportPostProcessPreset : uint8
+{
+    // Tangents, smooth normals and mesh optimization. The behavior of previous versions.
+    Quality,
+    // Only what is needed for the conversion and normals where they are missing. Good for collision.
+    Fast,
+    // Use the steps of FRuntimeMeshImportPostProcessParam
+    Custom,
+};
+
+// The collision geometry prepared by the import, @see FRuntimeMeshImportMeshInfo::collision
+UENUM(BlueprintType)
+enum class ERuntimeMeshImportCollision : uint8
+{
+    None,
+    // One simplified triangle mesh of all sections, used for simple and complex collision
+    SimplifiedTrimesh,
+    // Convex hulls around spatial clusters of the triangles. Cheaper to simulate, but not exact on concave parts.
+    ConvexDecomposition,
+};
+
+// Block compression of a texture on the GPU
+UENUM(BlueprintType)
+enum class ERuntimeMeshImportTextureCompression : uint8
+{
+    // Uncompressed BGRA8
+    None,
+    // BC1 for opaque textures, BC3 when the texture has alpha
+    Auto,
+    // Color without alpha, 8:1
+    BC1,
+    // Color with alpha, 4:1
+    BC3,
+    // The red channel only, for grayscale maps like roughness, metallic or ambient occlusion
+    BC4,
+    // The red and green channel, for normal maps
+    BC5,
+};
+
+/**
+ *	The Assimp post processing that is run on the imported scene.
+ *	Triangulation and conversion to left handed coordinates are always done, the import relies on them.
+ *	The steps are only used with ERuntimeMeshImportPostProcessPreset::Custom, the config values with every preset.
+ */
 USTRUCT(BlueprintType)
-struct FRuntimeMeshImportSectionInfo
+struct FRuntimeMeshImportPostProcessParam
 {
     GENERATED_BODY()
 
-    // Name of the material for this section.
-    // Can be None when everything gets combined.
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    FName materialName;
+    ERuntimeMeshImportPostProcessPreset preset = ERuntimeMeshImportPostProcessPreset::Quality;
 
-    // Index of the material in the material list.
-    // Can be -1 when everything gets combined.
+    // aiProcess_CalcTangentSpace
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Custom")
+    bool bCalcTangentSpace = true;
+
+    // aiProcess_GenSmoothNormals, only for meshes without normals
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Custom")
+    bool bGenSmoothNormals = true;
+
+    // aiProcess_OptimizeMeshes
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Custom")
+    bool bOptimizeMeshes = true;
+
+    // aiProcess_JoinIdenticalVertices
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Custom")
+    bool bJoinIdenticalVertices = false;
+
+    // aiProcess_ImproveCacheLocality
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Custom")
+    bool bImproveCacheLocality = false;
+
+    // aiProcess_SplitLargeMeshes, uses 'splitLargeMeshesVertexLimit' and 'splitLargeMeshesTriangleLimit'
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Custom")
+    bool bSplitLargeMeshes = false;
+
+    // aiProcess_FindInstances
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Custom")
+    bool bFindInstances = false;
+
+    // AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE in degree
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Config", meta = (ClampMin = "0", ClampMax = "175"))
+    float smoothingAngle = 175.f;
+
+    // AI_CONFIG_PP_SLM_VERTEX_LIMIT
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Config", meta = (ClampMin = "3"))
+    int32 splitLargeMeshesVertexLimit = 1000000;
+
+    // AI_CONFIG_PP_SLM_TRIANGLE_LIMIT
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Config", meta = (ClampMin = "1"))
+    int32 splitLargeMeshesTriangleLimit = 1000000;
+
+    // AI_CONFIG_PP_ICL_PTCACHE_SIZE
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Config", meta = (ClampMin = "3"))
+    int32 vertexCacheSize = 12;
+};
+
+// The vertex streams that are imported besides the positions and the triangles, @see FRuntimeMeshImportParam::vertexAttributes
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ERuntimeMeshImportVertexAttributes : uint8
+{
+    None = 0 UMETA(Hidden),
+    Normals = 1 << 0,
+    UV0 = 1 << 1,
+    Tangents = 1 << 2,
+    VertexColors = 1 << 3,
+};
+ENUM_CLASS_FLAGS(ERuntimeMeshImportVertexAttributes);
+
+// A LOD generated on import, @see FRuntimeMeshImportParam::lodSettings
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportLODSetting
+{
+    GENERATED_BODY()
+
+    // Triangles of the LOD relative to LOD 0. Less is reached when the mesh cannot be simplified further without breaking its borders.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "0.001", ClampMax = "1"))
+    float triangleRatio = 0.5f;
+
+    // Screen size below which the LOD is shown, like FStaticMeshSourceModel::ScreenSize
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "0", ClampMax = "1"))
+    float screenSize = 0.5f;
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportParam
+{
+    GENERATED_BODY()
+
+    // Scene description file to import. Depending on 'pathType'
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    int32 materialIndex;
+    FString file;
 
+    // Choose whether the 'file' provided is absolute or relative
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    TArray<FVector> vertices;
+    EPathType pathType = EPathType::Absolute;
 
+    // A transform that is applied to the imported scene
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    TArray<int32> triangles;
+    FTransform transform;
 
+    // With Auto, 'importMethodMesh', 'importMethodSection', 'bImportInstanced', 'bWeldVertices' and 'bSplitLargeSections' are chosen after the file is read,
+    // from the counts of its nodes, meshes, vertices and materials. No vertex is read for it. The decision is logged and kept in FRuntimeMeshImportMetrics::profileDecision.
+    // An import with 'bImportHierarchy', skinning or streaming keeps its meshes separated.
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    TArray<FVector> normals;
+    ERuntimeMeshImportProfile importProfile = ERuntimeMeshImportProfile::Manual;
 
+    // Choose how meshes shall be treated on import (applied before 'importMethodSection')
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    TArray<FVector2D> uv0;
+    EImportMethodMesh importMethodMesh = EImportMethodMesh::Keep;
 
+    // The triangles a cluster of the 'importMethodMesh' MergeByCluster is split down to. A single section that has more stays one cluster.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "1"))
+    int32 clusterTargetTriangles = 65536;
+
+    // Choose how mesh sections are treated on import (applied after 'importMethodMesh')
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    TArray<FLinearColor> vertexColors;
+    EImportMethodSection importMethodSection = EImportMethodSection::MergeSameMaterial;
 
+    // When checked, the scene is transformed to fit into a 100cm cube, objects placed around the center.
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    TArray<FVector> tangents;
+    bool bNormalizeScene = false;
 
-	TMap<FString, TArray<TTuple<int32, float>>> BoneInfo;
+    // Nodes that use the same meshes share one mesh info, converted once in the space of the meshes.
+    // Each mesh info lists the transform of every node that uses it in 'instanceTransforms', e.g. for an instanced static mesh component.
+    // 'importMethodMesh' Merge and MergeByCluster are ignored.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bImportInstanced = false;
 
-    // Append other section data to this
-    void Append_Move(FRuntimeMeshImportSectionInfo&& other);
+    // Keeps the node tree of the scene in FRuntimeMeshImportResult::nodes. The meshes stay in the space of their node
+    // and are placed by the transforms of the nodes. 'importMethodMesh' Merge and MergeByCluster are ignored.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bImportHierarchy = false;
+
+    // Imports the lines and points of the meshes to FRuntimeMeshImportSectionInfo::linesAndPoints, e.g. the edges of CAD files.
+    // Otherwise they are skipped. The import always sorts the faces by primitive type, so the triangles are copied without a check per face.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bImportLinesAndPoints = false;
+
+    // Imports the bones and skin weights of skinned meshes, @see FRuntimeMeshImportResult::bones
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Skinning")
+    bool bImportSkinning = false;
+
+    // The bone influences stored per vertex. The smallest weights are dropped when a vertex has more.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Skinning", meta = (ClampMin = "1", ClampMax = "8"))
+    int32 maxBoneInfluences = 4;
+
+    // Imports the animations of the scene. Needs 'bImportSkinning' for the tracks of bones and 'bImportHierarchy' for the tracks of nodes.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Skinning")
+    bool bImportAnimations = false;
+
+    // Animation keys that the interpolation of the kept keys around them reproduces within this tolerance are removed.
+    // In units for positions and scales, in radians for rotations. 0 keeps all keys.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Skinning", meta = (ClampMin = "0"))
+    float animationKeyTolerance = 0.001f;
+
+    // Imports the blend shapes of the meshes, @see FRuntimeMeshImportSectionInfo::morphTargets
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Skinning")
+    bool bImportMorphTargets = false;
+
+    // A morph target only stores the vertices it moves further than this, in units
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Skinning", meta = (ClampMin = "0"))
+    float morphTargetThreshold = 0.0001f;
+
+    // Simplified LODs generated for every mesh, in decreasing detail. Each LOD is simplified from the one before on worker threads.
+    // @see FRuntimeMeshImportMeshInfo::lods
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "LOD")
+    TArray<FRuntimeMeshImportLODSetting> lodSettings;
+
+    // Splits the sections with more vertices or triangles than the limits below into spatially coherent chunks of the same material,
+    // each with its own bounds. Runs after the merge steps, so the welding, LODs, lightmap UVs and collision run on the chunks in parallel.
+    // Unlike 'bSplitLargeMeshes' of the post process the chunks are compact in space.
+    // With 'importMethodMesh' MergeByCluster the split runs before the clustering, so the chunks of a large section are culled separately.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization")
+    bool bSplitLargeSections = false;
+
+    // 65535 keeps the chunks within 16 bit indices
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization", meta = (ClampMin = "3"))
+    int32 splitSectionVertexLimit = 65535;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization", meta = (ClampMin = "1"))
+    int32 splitSectionTriangleLimit = 65536;
+
+    // Merges the vertices of each section that are equal within the tolerances below, e.g. the duplicates along former section seams
+    // after merging or the unshared vertices of STL and OBJ files. Runs in parallel per section after the merge steps.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization")
+    bool bWeldVertices = false;
+
+    // Distance in units of the imported mesh, after 'transform'
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization", meta = (ClampMin = "0"))
+    float weldPositionTolerance = 0.001f;
+
+    // Distance between the normals and between the tangents
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization", meta = (ClampMin = "0"))
+    float weldNormalTolerance = 0.01f;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization", meta = (ClampMin = "0"))
+    float weldUVTolerance = 0.0001f;
+
+    // Reorders the triangles of every section, including the generated LODs, for the post transform vertex cache
+    // and the vertices by their first use. Runs in parallel per section after the conversion, the geometry stays the same.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization")
+    bool bOptimizeSections = false;
+
+    // Entries of the post transform cache to optimize for. 16 fits most mobile GPUs, desktop GPUs have more.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization", meta = (ClampMin = "3", ClampMax = "64"))
+    int32 vertexCacheSize = 16;
+
+    // With 'bOptimizeSections', draws the triangle clusters that face outwards first, so less of the mesh shades over itself
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization")
+    bool bOptimizeOverdraw = true;
+
+    // Computes FRuntimeMeshImportMeshInfo::geometryHash of every mesh in parallel after the other steps.
+    // With 'bImportInstanced' the meshes with the same geometry and materials are merged into one mesh info with the instance transforms of all,
+    // URuntimeMeshImportAssetManager shares the geometry of the meshes with the same hash across its assets.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization")
+    bool bHashGeometry = false;
+
+    // The positions are rounded to this grid before they are hashed, in units of the imported mesh
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Optimization", meta = (ClampMin = "0.000001"))
+    float geometryHashPrecision = 0.001f;
+
+    // Builds a BVH for every section of LOD 0 after the other steps, for RaycastMeshInfo and CreateBodySetupFromBVH.
+    // The hierarchies are built in parallel and are not kept when the sections are changed later.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Collision")
+    bool bBuildBVH = false;
+
+    // Leaves with more triangles are always split. Smaller leaves make the queries faster and the BVH larger.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Collision", meta = (ClampMin = "1", ClampMax = "64"))
+    int32 bvhMaxLeafTriangles = 4;
+
+    // Prepares collision geometry for every mesh on the import threads, ready to be cooked with MeshInfoToBodySetup_Async
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Collision")
+    ERuntimeMeshImportCollision collision = ERuntimeMeshImportCollision::None;
+
+    // Share of the triangles kept for ERuntimeMeshImportCollision::SimplifiedTrimesh
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Collision", meta = (ClampMin = "0.01", ClampMax = "1"))
+    float collisionTriangleRatio = 0.25f;
+
+    // The most hulls per mesh for ERuntimeMeshImportCollision::ConvexDecomposition
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Collision", meta = (ClampMin = "1", ClampMax = "256"))
+    int32 maxConvexHulls = 16;
+
+    // The most points per hull. Larger clusters keep their extreme points in this many directions.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Collision", meta = (ClampMin = "4", ClampMax = "255"))
+    int32 maxConvexHullVertices = 32;
+
+    // The streams of the vertices that are imported, e.g. none for collision or navigation that only need the positions.
+    // Assimp does not generate the tangents and normals that are not imported.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Filter", meta = (Bitmask, BitmaskEnum = "ERuntimeMeshImportVertexAttributes"))
+    int32 vertexAttributes = int32(ERuntimeMeshImportVertexAttributes::Normals | ERuntimeMeshImportVertexAttributes::UV0
+                                   | ERuntimeMeshImportVertexAttributes::Tangents | ERuntimeMeshImportVertexAttributes::VertexColors);
+
+    // The encoding of the vertex colors in the file. SRGB decodes them to linear FRuntimeMeshImportSectionInfo::vertexColors while the meshes are converted,
+    // e.g. for the 8 bit colors of scans that are stored as they were captured.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Filter")
+    ERuntimeMeshVertexColorSpace vertexColorSpace = ERuntimeMeshVertexColorSpace::Linear;
+
+    // When not empty, only the meshes of the nodes whose name matches one of these wildcards are imported, e.g. "Wall*"
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Filter")
+    TArray<FString> nodeIncludeFilters;
+
+    // The meshes of the nodes whose name matches one of these wildcards are not imported, after 'nodeIncludeFilters'.
+    // The nodes stay in the hierarchy of a 'bImportHierarchy' import.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Filter")
+    TArray<FString> nodeExcludeFilters;
+
+    // Skips the materials and their textures. FRuntimeMeshImportResult::materialInfos stays empty, the sections keep their material index.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Filter")
+    bool bGeometryOnly = false;
+
+    // Generates the missing smooth normals and the tangents after the conversion, in parallel over the sections, instead of
+    // aiProcess_GenSmoothNormals and aiProcess_CalcTangentSpace. The tangents are MikkTSpace, like the ones of the engine.
+    // Follows the normal and tangent steps of 'postProcess', tangents that the file has are kept.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bMikkTSpaceTangents = false;
+
+    // Generate non-overlapping lightmap UVs into UV channel 1 on the import threads, the engine only generates them in the editor.
+    // Adjacent triangles that face the same axis form a chart, the vertices along the chart borders are split. Runs before the LODs.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bGenerateLightmapUVs = false;
+
+    // The lightmap resolution the gutters between the charts are sized for
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = 4, ClampMax = 4096))
+    int32 lightmapResolution = 64;
+
+    // The gutter between the lightmap charts, in texels of 'lightmapResolution'
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = 0))
+    float lightmapPadding = 2.f;
+
+    // Convert the meshes of all scene nodes in parallel on the TaskGraph.
+    // The result is the same as with a single threaded conversion.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bParallelMeshConversion = true;
+
+    // For a streaming import, a box around each mesh is sent before any mesh is converted, so something shows within milliseconds.
+    // The converted mesh replaces it later, @see FRuntimeMeshImportMeshInfo::bIsProxy. Not sent when the result cache has the file.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bStreamProxies = false;
+
+    // Map the files into memory instead of reading them into buffers. Lowers the peak memory for very large files.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bMemoryMapFile = false;
+
+    // Read .gltf and .glb files without Assimp, their accessors are converted straight into the sections.
+    // Quantized streams (KHR_mesh_quantization) are supported. Skinning, sparse accessors, compressed buffers and
+    // post process steps that need normals generated or change the topology of the meshes fall back to Assimp.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "glTF")
+    bool bNativeGltfImport = false;
+
+    // Read ASCII .obj (with its .mtl files), .stl and .ply files without Assimp, parsed in parallel chunks of lines.
+    // Binary STL and PLY files and post process steps that change the topology of the meshes fall back to Assimp.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bNativeTextImport = false;
+
+    // Texture files that were read by an earlier import and did not change are taken from the texture cache
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bUseTextureCache = false;
+
+    // The texture files are not read by the import, only their path is kept in FRuntimeMeshImportExportMaterialParamTexture::sourceFile.
+    // They are read on the worker thread of MaterialParamTextureToTexture2D_Async_Cpp, so a material only reads the textures its source material has a parameter for.
+    // The textures that are embedded in the scene are always read, the scene is freed after the import.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bDeferTextureReads = false;
+
+    // When set, the converted result is written to a cache file in this directory and later imports of the unchanged file load it
+    // instead of running Assimp. Relative to the project's Saved directory unless absolute. Empty disables the cache.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString resultCacheDirectory;
+
+    // Sets the block compression of the imported textures, depending on their texture stack. e.g. BC5 for "TexNormal".
+    // It is applied when the texture is created with MaterialParamTextureToTexture2D_Async_Cpp.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bCompressTextures = false;
+
+    // Overrides the compression of a texture stack when 'bCompressTextures' is set, e.g. "TexRoughness" to None
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TMap<FName, ERuntimeMeshImportTextureCompression> textureStackCompression;
+
+    // Packs the textures of compatible materials into atlases, remaps the UV0 of their sections and replaces them by one material per atlas,
+    // so they need fewer sections and dynamic materials. Flat colored materials are merged into a "TexDiffuse" palette with a white "Diffuse".
+    // Runs on the import thread after the materials are imported. Ignored by a streaming import.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bAtlasMaterials = false;
+
+    // The largest width and height of an atlas of 'bAtlasMaterials'. Materials whose textures do not fit anymore get another atlas.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "64", ClampMax = "16384"))
+    int32 atlasMaxSize = 4096;
+
+    // The Assimp post processing applied to the scene
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FRuntimeMeshImportPostProcessParam postProcess;
+
+    // Cancels the import when set. Assimp is asked to abort and the conversion of the meshes is skipped.
+    UPROPERTY(BlueprintReadWrite, Category = "Default")
+    FRuntimeMeshImportExportCancellationToken cancellationToken;
 };
 
+// A file that is imported from memory, e.g. the .mtl of an .obj or the .bin of a .gltf
 USTRUCT(BlueprintType)
-struct FRuntimeMeshImportMeshInfo
+struct FRuntimeMeshImportMemoryFile
 {
     GENERATED_BODY()
 
-    // Name of the imported mesh. Name None when merged
+    // The name the file is referenced with by the scene, e.g. 'model.mtl'
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    FName meshName;
+    FString name;
 
-    // Mesh material sections
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    TArray<FRuntimeMeshImportSectionInfo> sections;
+    TArray<uint8> data;
+};
+
+UENUM(BlueprintType)
+enum class ERuntimeMeshImportExportThreadPriority : uint8
+{
+    Normal,
+    BelowNormal,
+    Lowest,
 };
 
+// The threads of the async imports and exports, @see URuntimeMeshImportExportLibrary::SetThreadPoolSettings
 USTRUCT(BlueprintType)
-struct FRuntimeMeshImportExportMaterialParam
+struct FRuntimeMeshImportExportThreadPoolSettings
 {
     GENERATED_BODY()
 
-    FRuntimeMeshImportExportMaterialParam() {}
-    FRuntimeMeshImportExportMaterialParam(FName&& inName) : name(MoveTemp(inName)) {}
+    // 0 uses half of the cores, at least one
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "0"))
+    int32 numThreads = 0;
 
-    // Material parameter name
+    // Below the TaskGraph workers, so the frame critical tasks run first
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    FName name;
+    ERuntimeMeshImportExportThreadPriority priority = ERuntimeMeshImportExportThreadPriority::BelowNormal;
+
+    // The cores the threads may run on, one bit per core. 0 lets them run on all cores.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int64 affinityMask = 0;
 };
 
+/**
+ *	The streaming of large textures created from imported materials, @see URuntimeMeshImportExportLibrary::SetTextureStreamingSettings.
+ *	Runtime textures have no package the engine could stream their mips from. Instead the full mip chain of a streamed texture is
+ *	written to a cache file and only the mips up to 'residentSize' stay loaded, until the texture is rendered.
+ *	The file is named after the content hash of the texture, so later sessions find it again.
+ */
 USTRUCT(BlueprintType)
-struct FRuntimeMeshImportExportMaterialParamScalar : public FRuntimeMeshImportExportMaterialParam
+struct FRuntimeMeshImportTextureStreamingSettings
 {
     GENERATED_BODY()
 
-    FRuntimeMeshImportExportMaterialParamScalar() {}
-    FRuntimeMeshImportExportMaterialParamScalar(FName&& inName, const float& inValue)
-        : FRuntimeMeshImportExportMaterialParam(MoveTemp(inName)), value(inValue)
-    {}
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bEnabled = false;
 
+    // Textures with mip 0 at least this large on one side are streamed. They need mips.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "1"))
+    int32 minStreamedSize = 4096;
+
+    // A streamed texture has its mips up to this size loaded while it is not rendered
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "1"))
+    int32 residentSize = 1024;
+
+    // A texture drops back to 'residentSize' when it was not rendered for this long
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "0"))
+    float evictSeconds = 10.f;
+
+    // Relative to the project's Saved directory unless absolute
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    float value = 0.f;
+    FString cacheDirectory = TEXT("RuntimeMeshImportExport/TextureMips");
 };
 
 USTRUCT(BlueprintType)
-struct FRuntimeMeshImportExportMaterialParamVector : public FRuntimeMeshImportExportMaterialParam
+struct FRuntimeMeshBatchImportParam
 {
     GENERATED_BODY()
 
-    FRuntimeMeshImportExportMaterialParamVector() {}
-    FRuntimeMeshImportExportMaterialParamVector(FName&& inName, const FLinearColor& inValue)
-        : FRuntimeMeshImportExportMaterialParam(MoveTemp(inName)), value(inValue)
-    {}
+    // The maximum number of files that are imported at the same time. Each import runs on its own worker thread.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "1"))
+    int32 maxConcurrentImports = 4;
+
+    // Imports are only started while the summed size of the files in flight stays below this value. 0 means no limit.
+    // The size on disk is only an estimate of the memory needed, at least one file is always imported.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "0"))
+    int32 memoryBudgetMB = 0;
 
+    // Run the import threads with below normal priority so they do not compete with the game and render threads
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
-    FLinearColor value = FLinearColor::Black;
+    bool bLowPriority = true;
 };
 
+// Limits for each tick of URuntimeMeshImportApplier. At least one section, material or texture is applied per tick.
 USTRUCT(BlueprintType)
-struct FRuntimeMeshImportExportMaterialParamTexture : public FRuntimeMeshImportExportMaterialParam
+struct FRuntimeMeshImportApplyParam
 {
     GENERATED_BODY()
 
-    FRuntimeMeshImportExportMaterialParamTexture() {}
-    FRuntimeMeshImportExportMaterialParamTexture(FName inName) : FRuntimeMeshImportExportMaterialParam(MoveTemp(inName)) {}
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "1"))
+    int32 maxSectionsPerTick = 4;
 
-    // CONSULT THE ASSIMP DOCUMENTATION ABOUT THE MEANING IN aiTexture
-    int32 width = 0;
+    // Dynamic material instances, created when the first section that uses the material is applied
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "1"))
+    int32 maxMaterialsPerTick = 4;
+
+    // Textures that are started per tick. They are decoded on worker threads, only their creation runs on the GameThread.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "1"))
+    int32 maxTexturesPerTick = 2;
+
+    // Nothing more is applied in a tick once it took this long. 0 means only the counts limit a tick.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "0"))
+    float budgetMs = 4.f;
+
+    // The sections closest to the camera of the first player are applied first. Without a player they are applied in order.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bPrioritizeByCameraDistance = true;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bCreateCollision = false;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bFlipTangentY = false;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bGenerateMips = true;
+
+    // Share the materials with the same params, @see URuntimeMeshImportExportLibrary::MaterialInfoToDynamicMaterial
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bUseMaterialCache = true;
+};
+
+// The state of a file of URuntimeMeshImportStreamingComponent
+UENUM(BlueprintType)
+enum class ERuntimeMeshImportStreamingState : uint8
+{
+    Unloaded,
+    // Imported by the asset manager or applied to its component
+    Loading,
+    Loaded,
+};
+
+/**
+ *	A blend shape of a section, stored sparse: only the vertices it moves have a delta.
+ *	The deltas are added to the vertices and normals of the section, weighted by the morph target.
+ */
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportMorphTarget
+{
+    FName name;
+    // Ascending vertices of the section
+    TArray<int32> vertexIndices;
+    // Per entry of 'vertexIndices'
+    TArray<FVector> positionDeltas;
+    // Per entry of 'vertexIndices', empty when the target does not change the normals
+    TArray<FVector> normalDeltas;
+
+    SIZE_T GetAllocatedSize() const;
+
+    /**
+     *	The deltas of UMorphTarget::PopulateDeltas for a skeletal mesh whose LOD vertex buffer has the section at 'vertexOffset'.
+     *	The normal deltas become the tangent Z deltas.
+     */
+    void ToMorphTargetDeltas(const int32 vertexOffset, TArray<FMorphTargetDelta>& outDeltas) const;
+
+    // Appends the targets of a section appended at 'vertexOffset'. Targets of the same name become one.
+    static void Append(TArray<FRuntimeMeshImportMorphTarget>& targets, TArray<FRuntimeMeshImportMorphTarget>&& other, const int32 vertexOffset);
+
+    /**
+     *	Remaps 'targets' to a section whose vertex i was vertex sourceVertices[i] of the section the targets belong to,
+     *	like the remapped streams of FMeshOptimizer. Targets without a delta left are dropped.
+     */
+    static void Remap(TArray<FRuntimeMeshImportMorphTarget>& targets, TArrayView<const int32> sourceVertices, const int32 numSourceVertices);
+};
+
+/**
+ *	The lines and points of a section, e.g. the edges and markers of a CAD file. They have their own vertices,
+ *	so the welding, splitting and LODs of the triangles leave them as they are. Not rendered by the plugin.
+ */
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportLinesAndPoints
+{
+    TArray<FVector> vertices;
+    // Per vertex, empty when the mesh has no vertex colors
+    TArray<FColor> colors;
+    // Two per line segment
+    TArray<int32> lineIndices;
+    TArray<int32> pointIndices;
+    FBox bounds = FBox(ForceInit);
+
+    bool IsEmpty() const
+    {
+        return lineIndices.Num() == 0 && pointIndices.Num() == 0;
+    }
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return vertices.GetAllocatedSize() + colors.GetAllocatedSize() + lineIndices.GetAllocatedSize() + pointIndices.GetAllocatedSize();
+    }
+
+    // The colors of the side without colors are white
+    void Append(FRuntimeMeshImportLinesAndPoints&& other);
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportSectionInfo
+{
+    GENERATED_BODY()
+
+    // Name of the material for this section.
+    // Can be None when everything gets combined.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FName materialName;
+
+    // Index of the material in the material list.
+    // Can be -1 when everything gets combined.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 materialIndex;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FVector> vertices;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<int32> triangles;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FVector> normals;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FVector2D> uv0;
+
+    // Non-overlapping UVs for lightmaps, only filled with FRuntimeMeshImportParam::bGenerateLightmapUVs. UV channel 1 of the created meshes.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FVector2D> uv1;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FLinearColor> vertexColors;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FVector> tangents;
+
+    // Bounds of 'vertices', computed while the vertices are converted. Invalid when the section was not imported.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FBox bounds = FBox(ForceInit);
+
+    // Not filled by the import, the skin weights are in 'boneIndices' and 'boneWeights'
+	TMap<FString, TArray<TTuple<int32, float>>> BoneInfo;
+
+    // Bone influences per vertex, 0 when the section is not skinned
+    int32 numBoneInfluences = 0;
+    // 'numBoneInfluences' indices into FRuntimeMeshImportResult::bones per vertex, sorted by weight
+    TArray<uint16> boneIndices;
+    // 'numBoneInfluences' weights per vertex, matching 'boneIndices'. The weights of a vertex sum up to 255.
+    TArray<uint8> boneWeights;
+
+    // Built with FRuntimeMeshImportParam::bBuildBVH. Only valid for the vertices and triangles it was built for.
+    TSharedPtr<const FRuntimeMeshImportBVH, ESPMode::ThreadSafe> bvh;
+
+    // Filled with FRuntimeMeshImportParam::bImportMorphTargets
+    TArray<FRuntimeMeshImportMorphTarget> morphTargets;
+
+    // Filled with FRuntimeMeshImportParam::bImportLinesAndPoints
+    FRuntimeMeshImportLinesAndPoints linesAndPoints;
+
+    // Append other section data to this. A stream only one of the sections has is zero filled for the other.
+    void Append_Move(FRuntimeMeshImportSectionInfo&& other);
+};
+
+// The result of RaycastMeshInfo
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportRaycastHit
+{
+    GENERATED_BODY()
+
+    // Distance from the start of the ray
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float distance = 0.f;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FVector location = FVector::ZeroVector;
+
+    // Normal of the hit triangle, facing the start of the ray
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FVector normal = FVector::ZeroVector;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 sectionIndex = INDEX_NONE;
+
+    // Index of the triangle in the section, its first index is at 3 * triangleIndex
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 triangleIndex = INDEX_NONE;
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportConvexHull
+{
+    GENERATED_BODY()
+
+    // The points the hull is computed from when it is cooked
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FVector> vertices;
+};
+
+// Collision geometry of a mesh, in the same space as its sections. @see FRuntimeMeshImportParam::collision
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportCollision
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FVector> trimeshVertices;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<int32> trimeshTriangles;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FRuntimeMeshImportConvexHull> convexHulls;
+
+    bool IsEmpty() const
+    {
+        return trimeshTriangles.Num() == 0 && convexHulls.Num() == 0;
+    }
+};
+
+// A generated LOD of FRuntimeMeshImportMeshInfo
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportMeshLOD
+{
+    GENERATED_BODY()
+
+    // @see FRuntimeMeshImportLODSetting::screenSize
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float screenSize = 0.f;
+
+    // One section per section of the mesh, with the same material. A section can be empty.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FRuntimeMeshImportSectionInfo> sections;
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportMeshInfo
+{
+    GENERATED_BODY()
+
+    // Name of the imported mesh. Name None when merged
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FName meshName;
+
+    // Mesh material sections
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FRuntimeMeshImportSectionInfo> sections;
+
+    // Only filled by an import with bImportInstanced: one transform per node that uses the mesh.
+    // The vertices of the sections are in the space of the mesh then.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FTransform> instanceTransforms;
+
+    // Bounds of all sections, in the same space as their vertices
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FBox bounds = FBox(ForceInit);
+
+    // The LODs after LOD 0, which is 'sections'. Only filled when FRuntimeMeshImportParam::lodSettings is set.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FRuntimeMeshImportMeshLOD> lods;
+
+    // Only filled when FRuntimeMeshImportParam::collision is set
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FRuntimeMeshImportCollision collision;
+
+    // The index of the mesh in a streaming import, the proxy and the converted mesh share it. INDEX_NONE for other imports.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 streamingIndex = INDEX_NONE;
+
+    // Only filled with FRuntimeMeshImportParam::bHashGeometry: a hash of the quantized positions, UVs and triangles of all sections and LODs,
+    // without their materials. Meshes with the same hash have the same geometry. 0 when it is not computed.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int64 geometryHash = 0;
+
+    // A box around the mesh with a single section, @see FRuntimeMeshImportParam::bStreamProxies
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bIsProxy = false;
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportExportMaterialParam
+{
+    GENERATED_BODY()
+
+    FRuntimeMeshImportExportMaterialParam() {}
+    FRuntimeMeshImportExportMaterialParam(FName&& inName) : name(MoveTemp(inName)) {}
+
+    // Material parameter name
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FName name;
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportExportMaterialParamScalar : public FRuntimeMeshImportExportMaterialParam
+{
+    GENERATED_BODY()
+
+    FRuntimeMeshImportExportMaterialParamScalar() {}
+    FRuntimeMeshImportExportMaterialParamScalar(FName&& inName, const float& inValue)
+        : FRuntimeMeshImportExportMaterialParam(MoveTemp(inName)), value(inValue)
+    {}
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float value = 0.f;
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportExportMaterialParamVector : public FRuntimeMeshImportExportMaterialParam
+{
+    GENERATED_BODY()
+
+    FRuntimeMeshImportExportMaterialParamVector() {}
+    FRuntimeMeshImportExportMaterialParamVector(FName&& inName, const FLinearColor& inValue)
+        : FRuntimeMeshImportExportMaterialParam(MoveTemp(inName)), value(inValue)
+    {}
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FLinearColor value = FLinearColor::Black;
+};
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportExportMaterialParamTexture : public FRuntimeMeshImportExportMaterialParam
+{
+    GENERATED_BODY()
+
+    FRuntimeMeshImportExportMaterialParamTexture() {}
+    FRuntimeMeshImportExportMaterialParamTexture(FName inName) : FRuntimeMeshImportExportMaterialParam(MoveTemp(inName)) {}
+
+    // CONSULT THE ASSIMP DOCUMENTATION ABOUT THE MEANING IN aiTexture
+    int32 width = 0;
     // CONSULT THE ASSIMP DOCUMENTATION ABOUT THE MEANING IN aiTexture
     int32 height = 0;
     // CONSULT THE ASSIMP DOCUMENTATION ABOUT THE MEANING IN aiTexture
     FString byteDescription;
 
+    // The block compression MaterialParamTextureToTexture2D_Async_Cpp applies. Falls back to None when the platform does not support it.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    ERuntimeMeshImportTextureCompression compression = ERuntimeMeshImportTextureCompression::None;
+
     // Each texture is imported as byte array.
     // NOTE: For each texture type e.g. Diffuse, Assimp has a texture stack. Though the plugin for now only imports the first texture within the stack.
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
     TArray<uint8> byteData;
+
+    // The absolute path of a texture file that is not read yet, 'byteData' is empty until then. @see FRuntimeMeshImportParam::bDeferTextureReads
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString sourceFile;
+
+    bool IsDataDeferred() const
+    {
+        return byteData.Num() == 0 && !sourceFile.IsEmpty();
+    }
 };
 
 
@@ -444,6 +1609,202 @@ struct FRuntimeMeshImportMaterialInfo
     TArray<FRuntimeMeshImportExportMaterialParamTexture> textures;
 };
 
+// A bone of the skeleton, @see FRuntimeMeshImportParam::bImportSkinning
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportBone
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FName name;
+
+    // Index of the parent bone, -1 for a root bone. Parents are always stored before their children.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 parentIndex = INDEX_NONE;
+
+    // The bind pose relative to the parent bone
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FTransform localTransform;
+
+    // From the space of the vertices to the space of the bone in the bind pose, aiBone::mOffsetMatrix.
+    // Without bImportHierarchy the vertices are in the space of the result, then the root bones contain the scene transform as well.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FTransform inverseBindTransform;
+};
+
+// The keys of one bone or node. Times are in seconds. A channel with a single key is constant, one without keys keeps the rest transform.
+USTRUCT(BlueprintType)
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportAnimationTrack
+{
+    GENERATED_BODY()
+
+    // Index into FRuntimeMeshImportResult::bones, -1 when the animated node is no bone
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 boneIndex = INDEX_NONE;
+
+    // Index into FRuntimeMeshImportResult::nodes with FRuntimeMeshImportParam::bImportHierarchy, otherwise -1.
+    // The keys of a root node replace its transform, which then no longer contains the transform of the import.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 nodeIndex = INDEX_NONE;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<float> positionTimes;
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FVector> positions;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<float> rotationTimes;
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FQuat> rotations;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<float> scaleTimes;
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FVector> scales;
+
+    // The local transform at 'time', the channels without keys come from 'restTransform'
+    FTransform Sample(const float time, const FTransform& restTransform) const;
+};
+
+USTRUCT(BlueprintType)
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportAnimation
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FName name;
+
+    // In seconds
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float duration = 0.f;
+
+    // One track per animated bone or node
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FRuntimeMeshImportAnimationTrack> tracks;
+
+    // The local transforms of 'bones' at 'time', the bones without a track keep their bind pose
+    void SampleBones(const float time, const TArray<FRuntimeMeshImportBone>& bones, TArray<FTransform>& outLocalTransforms) const;
+    // The local transforms of 'nodes' at 'time', @see FRuntimeMeshImportParam::bImportHierarchy
+    void SampleNodes(const float time, const TArray<FRuntimeMeshImportNode>& nodes, TArray<FTransform>& outLocalTransforms) const;
+};
+
+// A node of the scene tree, @see FRuntimeMeshImportParam::bImportHierarchy
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportNode
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FName name;
+
+    // Index of the parent in FRuntimeMeshImportResult::nodes, -1 for the root. Parents are always stored before their children.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 parentIndex = INDEX_NONE;
+
+    // Relative to the parent. The transform of the root contains the transform of the import param.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FTransform localTransform;
+
+    // Index of the mesh of the node in FRuntimeMeshImportResult::meshInfos, -1 when the node has no mesh
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 meshInfoIndex = INDEX_NONE;
+};
+
+/**
+ *	The wall clock seconds of the stages of an import. A streaming import finishes each mesh within 'conversionSeconds'.
+ *	A result from the result cache only has 'totalSeconds'.
+ */
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportStageTimings
+{
+    GENERATED_BODY()
+
+    // Assimp ReadFile including its post processing, or the load of the native glTF import
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float readSeconds = 0.f;
+
+    // Converting the meshes of the nodes into sections, including the skinning
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float conversionSeconds = 0.f;
+
+    // EImportMethodMesh, EImportMethodSection and the vertex welding
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float mergeSeconds = 0.f;
+
+    // The bounds and transforms of bNormalizeScene
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float normalizeSeconds = 0.f;
+
+    // Extracting the materials, without reading their external textures
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float materialSeconds = 0.f;
+
+    // Reading the external textures of the materials
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float textureSeconds = 0.f;
+
+    // LODs, optimization, BVHs and collision
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float postProcessSeconds = 0.f;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float totalSeconds = 0.f;
+};
+
+/**
+ *	What an import read and what it cost besides the wall clock, collected by every import.
+ *	The counts are of the converted sections, before merging, welding and LODs, so a streaming import has them as well.
+ *	A result from the result cache only has the memory.
+ */
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportMetrics
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 numMeshes = 0;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 numSections = 0;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int64 numVertices = 0;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int64 numTriangles = 0;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 numMaterials = 0;
+
+    // The texture parameters of the materials
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 numTextures = 0;
+
+    // The scene and the files it references, including the external textures that were not in the texture cache
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int64 bytesRead = 0;
+
+    // The conversion of the sections summed over all threads, for a streaming import including the finishing of the meshes
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float threadSeconds = 0.f;
+
+    // The high water mark of the physical memory of the process when the import finished
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float peakUsedPhysicalMB = 0.f;
+
+    // How much more physical memory the process used after the import than before it
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float usedPhysicalGrowthMB = 0.f;
+
+    // What the ERuntimeMeshImportProfile Auto chose and why, empty for other imports
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString profileDecision;
+
+    // Counting the scene and choosing the params, before FRuntimeMeshImportStageTimings::conversionSeconds
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float profileSeconds = 0.f;
+};
+
 USTRUCT(BlueprintType)
 struct FRuntimeMeshImportResult
 {
@@ -458,8 +1819,167 @@ struct FRuntimeMeshImportResult
     // Materials will only get imported when sectionImportMethod != EImportMethodSection::Merge
     UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
     TArray<FRuntimeMeshImportMaterialInfo> materialInfos;
+
+    // The node tree of the scene, only filled by an import with bImportHierarchy
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FRuntimeMeshImportNode> nodes;
+
+    // The skeleton shared by all skinned sections, only filled by an import with bImportSkinning
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FRuntimeMeshImportBone> bones;
+
+    // Only filled by an import with bImportAnimations
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FRuntimeMeshImportAnimation> animations;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FRuntimeMeshImportStageTimings timings;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FRuntimeMeshImportMetrics metrics;
+};
+
+/**
+ *	What a file contains, read without converting the meshes or loading the textures, @see URuntimeMeshImportExportLibrary::ProbeScene_AnyThread.
+ *	The counts are of the meshes in the file, a mesh that several nodes instance is counted once.
+ */
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportSummary
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString file;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bSuccess = false;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 numMeshes = 0;
+
+    // How often the nodes reference the meshes
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 numMeshInstances = 0;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int64 numVertices = 0;
+
+    // Polygons count as the triangles they are triangulated into
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int64 numTriangles = 0;
+
+    // Of all mesh instances, with the transforms of the nodes and the import param. Not valid without vertices.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FBox bounds = FBox(ForceInit);
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FName> materialNames;
+
+    // The paths of the textures the materials reference, as written in the file. Embedded textures start with '*'.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TArray<FString> textureReferences;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bHasBones = false;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 numAnimations = 0;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float seconds = 0.f;
+};
+
+DECLARE_DELEGATE_OneParam(FRuntimeImportProbeFinished, const TArray<FRuntimeMeshImportSummary>& /*summaries*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FRuntimeImportProbeFinishedDyn, const TArray<FRuntimeMeshImportSummary>&, summaries);
+
+/**
+ *	A conversion from one file format to another, @see URuntimeMeshImportExportLibrary::ConvertScene.
+ *	The scene Assimp reads is handed to the Assimp exporter as it is, the meshes are not converted to Unreal types.
+ *	It stays in the coordinate system of the file, without the handedness conversion of the import and the export.
+ */
+USTRUCT(BlueprintType)
+struct FRuntimeMeshConvertParam
+{
+    GENERATED_BODY()
+
+    // The file to read, depending on 'pathType'
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString file;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    EPathType pathType = EPathType::Absolute;
+
+    // The absolute path of the file to write
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString outputFile;
+
+    // The id of the export format, @see URuntimeMeshImportExportLibrary::GetSupportedExtensionsExport
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString formatId;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bOverrideExisting = true;
+
+    // Applied to the root node, in the coordinate system of the file
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FTransform transform;
+
+    // Runs the Assimp steps of 'postProcess' on the scene before it is written. Without it the scene is written as it was read.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bPostProcess = false;
+
+    // The triangulation is always done with 'bPostProcess', the handedness is never changed
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FRuntimeMeshImportPostProcessParam postProcess;
+
+    // @see FRuntimeMeshImportParam::bMemoryMapFile
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bMemoryMapFile = false;
+
+    // @see FRuntimeMeshExportParam::fileWriteBufferSizeKB
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "4"))
+    int32 fileWriteBufferSizeKB = 4096;
+
+    // Cancels the read
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FRuntimeMeshImportExportCancellationToken cancellationToken;
 };
 
+USTRUCT(BlueprintType)
+struct FRuntimeMeshConvertResult
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bSuccess = false;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString error;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 numMeshes = 0;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int32 numMaterials = 0;
+
+    // Reading and post processing the scene
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float readSeconds = 0.f;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    float writeSeconds = 0.f;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int64 bytesRead = 0;
+
+    // Of all files the format writes, e.g. the .mtl of an .obj
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    int64 bytesWritten = 0;
+};
+
+DECLARE_DELEGATE_OneParam(FRuntimeConvertFinished, const FRuntimeMeshConvertResult& /*result*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FRuntimeConvertFinishedDyn, const FRuntimeMeshConvertResult&, result);
+
 USTRUCT(BlueprintType)
 struct FAssimpExportFormat
 {
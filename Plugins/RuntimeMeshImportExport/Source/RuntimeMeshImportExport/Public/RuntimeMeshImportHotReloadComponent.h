@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportHotReloadComponent.generated.h"
+
+class UMaterialInterface;
+class UProceduralMeshComponent;
+struct FFileChangeData;
+
+DECLARE_DELEGATE_TwoParams(FRuntimeHotReloadFinished, const int32 /*numChangedMeshes*/, const int32 /*numChangedMaterials*/);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FRuntimeHotReloadFinishedDyn, int32, numChangedMeshes, int32, numChangedMaterials);
+
+/**
+ *	Imports a file and imports it again whenever it is saved, e.g. while an artist iterates on it in a DCC tool.
+ *	Each mesh of the file is applied to its own UProceduralMeshComponent attached to this component.
+ *
+ *	The file is watched with the DirectoryWatcher module where it is available, otherwise its timestamp is polled every 'pollInterval'.
+ *	A reload waits until the file was quiet for 'debounceSeconds', so the many writes of one save import once.
+ *	The file is imported on the import thread pool with FRuntimeMeshImportParam::bHashGeometry and the meshes kept separate.
+ *	Meshes are matched to the previous import by their name, only the meshes whose geometry hash changed are applied again
+ *	and only the materials whose params changed are created again. Unchanged meshes and materials are not touched.
+ *	Changes of only the normals, vertex colors or UV channels after the first are not detected, @see FRuntimeMeshImportMeshInfo::geometryHash.
+ */
+UCLASS(ClassGroup = (RuntimeMeshImportExport), meta = (BlueprintSpawnableComponent))
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportHotReloadComponent : public USceneComponent
+{
+    GENERATED_BODY()
+public:
+
+    URuntimeMeshImportHotReloadComponent();
+
+    //~ Begin UActorComponent Interface
+    virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    //~ End UActorComponent Interface
+
+    /**
+     *	Imports the file of 'param' and starts watching it. The meshes of a file that was watched before are removed.
+     *	@param callbackReloaded		Fired on the GameThread after each import, also after the first one, with the number of meshes and materials it changes.
+     *								Their sections and textures are applied over the next frames.
+     *	@returns					false when the file does not exist
+     */
+    bool StartWatching_Cpp(const FRuntimeMeshImportParam& param, FRuntimeHotReloadFinished callbackReloaded);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|HotReload")
+    bool StartWatching(const FRuntimeMeshImportParam& param, FRuntimeHotReloadFinishedDyn reloadedDelegate);
+
+    // Stops watching, the imported meshes stay
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|HotReload")
+    void StopWatching();
+
+    // Imports the watched file again right away, without waiting for a change
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|HotReload")
+    void Reload();
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|HotReload")
+    bool GetIsWatching() const;
+
+    // The component of the mesh with 'meshName', nullptr when the file has no such mesh
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|HotReload")
+    UProceduralMeshComponent* GetMeshComponent(const FName meshName) const;
+
+    // Seconds the file must not change before it is imported again
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "HotReload", meta = (ClampMin = "0"))
+    float debounceSeconds = 0.5f;
+
+    // Seconds between the checks of the timestamp of the file when there is no directory watcher
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "HotReload", meta = (ClampMin = "0.05"))
+    float pollInterval = 1.f;
+
+    // The parent of the dynamic materials of the meshes. Without it the sections have the default material.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "HotReload")
+    UMaterialInterface* sourceMaterial = nullptr;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "HotReload")
+    bool bCreateCollision = false;
+
+private:
+    struct FWatchedMesh
+    {
+        TWeakObjectPtr<UProceduralMeshComponent> component;
+        int64 geometryHash = 0;
+        // @see FRuntimeMeshImportExportTextureCache::HashMaterialInfo, one per section, 0 for a section without material
+        TArray<uint64> sectionMaterialHashes;
+    };
+
+    struct FReloadedScene;
+
+    void StartReload();
+    void OnReloadImported(const int32 reloadId, TSharedPtr<FReloadedScene, ESPMode::ThreadSafe> scene);
+    void ApplyMesh(const FName key, FWatchedMesh& mesh, FRuntimeMeshImportMeshInfo&& meshInfo);
+    void SetMeshMaterials(const FWatchedMesh& mesh) const;
+    void CreateMaterial(const uint64 materialHash, const FRuntimeMeshImportMaterialInfo& materialInfo);
+    void OnDirectoryChanged(const TArray<FFileChangeData>& changes);
+    void RegisterDirectoryWatcher();
+    void UnregisterDirectoryWatcher();
+
+    // The dynamic materials by @see FRuntimeMeshImportExportTextureCache::HashMaterialInfo, nullptr while one is created
+    UPROPERTY()
+    TMap<uint64, UMaterialInterface*> materials;
+
+    // By the name of the mesh, meshes with the same name are told apart by the number of the FName
+    TMap<FName, FWatchedMesh> meshes;
+    FRuntimeMeshImportParam importParam;
+    FString watchedDirectory;
+    FDelegateHandle watcherHandle;
+    FDateTime lastTimeStamp;
+    // Seconds since the last change of the file, negative when no reload is due
+    float secondsSinceChange = -1.f;
+    float secondsSincePoll = 0.f;
+    // Each reload gets its own id, so an import that finishes after StopWatching or StartWatching is dropped
+    int32 reloadId = 0;
+    bool bIsWatching = false;
+    bool bIsImporting = false;
+
+    FRuntimeHotReloadFinished delegateReloaded;
+};
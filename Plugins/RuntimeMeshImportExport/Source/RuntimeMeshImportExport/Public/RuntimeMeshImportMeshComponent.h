@@ -0,0 +1,69 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/StaticMeshComponent.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportMeshComponent.generated.h"
+
+struct FRuntimeMeshImportCompactMeshInfo;
+class FStaticMeshRenderData;
+class UMaterialInterface;
+
+/**
+ *	Shows an imported mesh that does not change, without a CPU copy of its vertices.
+ *	The vertex and index buffers are built from the mesh on the import thread pool and uploaded to the GPU once,
+ *	after that the mesh is released. Unlike UProceduralMeshComponent there is nothing to update, so nothing is kept.
+ *	Each section has its own material slot, named after its material, and the component is culled by the bounds of the mesh.
+ *
+ *	The collision is cooked from FRuntimeMeshImportMeshInfo::collision when 'bCreateCollision' is set, only the collision is kept for it.
+ */
+UCLASS(ClassGroup = (RuntimeMeshImportExport), meta = (BlueprintSpawnableComponent))
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportMeshComponent : public UStaticMeshComponent
+{
+    GENERATED_BODY()
+public:
+
+    //~ Begin UActorComponent Interface
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    //~ End UActorComponent Interface
+
+    /**
+     *	Shows 'meshInfo' instead of the current mesh once its buffers are built. The mesh is moved in and released after the build.
+     *	@param materials	The material of each section, missing ones get the default material
+     */
+    void SetCompactMesh(FRuntimeMeshImportCompactMeshInfo&& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeImportExportGameThreadDone callbackDone);
+
+    // Same with a full precision mesh, which is copied, @see SetCompactMesh
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Mesh")
+    void SetMeshInfo(const FRuntimeMeshImportMeshInfo& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeImportExportGameThreadDoneDyn callbackDone);
+
+    void SetMeshInfo_Cpp(FRuntimeMeshImportMeshInfo&& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeImportExportGameThreadDone callbackDone);
+
+    // True while the buffers of the last mesh are built
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Mesh")
+    bool IsBuildPending() const
+    {
+        return bBuildPending;
+    }
+
+    // Cooks the collision of the meshes for the static mesh, they need FRuntimeMeshImportParam::collision
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Mesh")
+    bool bCreateCollision = false;
+
+private:
+    // Builds the render data of 'meshInfo' on the import thread pool and frees 'meshInfo' there, except for the collision with bCreateCollision
+    template<typename MeshInfoType>
+    void BuildMesh(MeshInfoType&& meshInfo, const TArray<UMaterialInterface*>& materials, FRuntimeImportExportGameThreadDone callbackDone);
+
+    // 'collisionMesh' only has the name and the collision of the mesh
+    void OnRenderDataBuilt(const int32 thisBuildId, TUniquePtr<FStaticMeshRenderData>&& renderData, const TArray<FName>& slotNames
+        , const TArray<TWeakObjectPtr<UMaterialInterface>>& materials, FRuntimeMeshImportMeshInfo&& collisionMesh, FRuntimeImportExportGameThreadDone callbackDone);
+
+    // Each mesh gets its own id, so only the last one is shown
+    int32 buildId = 0;
+    bool bBuildPending = false;
+};
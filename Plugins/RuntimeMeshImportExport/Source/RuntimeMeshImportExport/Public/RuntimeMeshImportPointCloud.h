@@ -0,0 +1,121 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportPointCloud.generated.h"
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshImportPointCloudParam
+{
+    GENERATED_BODY()
+
+    // A .xyz, .pts or .txt file with one point per line, or any file Assimp reads, e.g. a PLY without faces
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString file;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    EPathType pathType = EPathType::Absolute;
+
+    // Applied to the points, like FRuntimeMeshImportParam::transform
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FTransform transform;
+
+    // @see FRuntimeMeshImportParam::bMemoryMapFile
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    bool bMemoryMapFile = false;
+
+    // Each octree node keeps at most one point per cell of a grid with this many cells per axis, the rest goes to its children
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = 4, ClampMax = 1024))
+    int32 nodeGridSize = 64;
+
+    // A node with at most this many points keeps all of them and has no children
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = 1))
+    int32 maxLeafPoints = 8192;
+
+    // The nodes at this depth keep all their points
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = 0, ClampMax = 20))
+    int32 maxDepth = 12;
+};
+
+// 16 bit per axis, relative to the bounds of the node of the point
+struct FRuntimeMeshImportPointCloudPosition
+{
+    uint16 x = 0;
+    uint16 y = 0;
+    uint16 z = 0;
+};
+
+/**
+ *	A node of FRuntimeMeshImportPointCloud. Its points are a subset of the points within its bounds, spread evenly
+ *	with about 'spacing' between them. The children hold the points it does not, so drawing a node and its children adds detail.
+ */
+struct FRuntimeMeshImportPointCloudNode
+{
+    // A cube
+    FBox bounds = FBox(ForceInit);
+    int32 firstPoint = 0;
+    int32 numPoints = 0;
+    // The cell size of the sampling grid, the distance between the points of the node
+    float spacing = 0.f;
+    int32 depth = 0;
+    // By octant, bit 0 is X, bit 1 Y and bit 2 Z. INDEX_NONE when the octant has no points.
+    int32 children[8] = { INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE, INDEX_NONE };
+};
+
+/**
+ *	Points without faces, as they come from laser scans, in an octree with level of detail subsets, @see FRuntimeMeshImportPointCloudNode.
+ *	About 10 bytes per point: quantized positions and an FColor. The points of a node are stored contiguous.
+ */
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportPointCloud
+{
+    // The root is the first node, parents are stored before their children
+    TArray<FRuntimeMeshImportPointCloudNode> nodes;
+    TArray<FRuntimeMeshImportPointCloudPosition> positions;
+    // Empty when the file has no colors
+    TArray<FColor> colors;
+    FBox bounds = FBox(ForceInit);
+
+    FVector GetPosition(const FRuntimeMeshImportPointCloudNode& node, const int32 pointIndex) const
+    {
+        const FRuntimeMeshImportPointCloudPosition& position = positions[pointIndex];
+        return node.bounds.Min + FVector(position.x, position.y, position.z) * (node.bounds.GetSize() / 65535.f);
+    }
+
+    FColor GetColor(const int32 pointIndex) const
+    {
+        return colors.Num() > 0 ? colors[pointIndex] : FColor::White;
+    }
+
+    int32 NumPoints() const
+    {
+        return positions.Num();
+    }
+
+    SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ *	Imports point clouds, instead of the mesh import that only keeps the triangles of the faces.
+ *	.xyz, .pts and .txt files are read without Assimp: one point per line, "x y z", "x y z r g b" or "x y z intensity r g b",
+ *	lines with fewer numbers are skipped, e.g. the point count of a .pts file. The lines are parsed in parallel.
+ *	The points are mirrored at z like aiProcess_MakeLeftHanded does, so they match the PLY files that Assimp reads.
+ *	From other files the vertices and first vertex colors of all meshes are read with Assimp, their faces are ignored.
+ */
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportPointCloudImporter
+{
+    // On the calling thread, the octree levels are built in parallel
+    static bool Import_AnyThread(const FRuntimeMeshImportPointCloudParam& param, FRuntimeMeshImportPointCloud& outPointCloud);
+
+    /**
+     * Builds the octree of 'points'. 'colors' is empty or has one color per point.
+     * The nodes of each depth are sampled in parallel, the result does not depend on the number of threads.
+     */
+    static void BuildOctree(const FRuntimeMeshImportPointCloudParam& param, TArray<FVector>&& points, TArray<FColor>&& colors, FRuntimeMeshImportPointCloud& outPointCloud);
+
+    // By the extension, the formats read without Assimp
+    static bool IsTextPointFile(const FString& file);
+};
@@ -0,0 +1,111 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "RuntimeMeshImportPointCloud.h"
+#include "RuntimeMeshImportPointCloudComponent.generated.h"
+
+class UMaterialInterface;
+class UProceduralMeshComponent;
+
+/**
+ *	Shows a point cloud by the distance of the viewer, @see FRuntimeMeshImportPointCloud.
+ *	Starting at the root, the octree nodes closest to the viewer relative to the spacing of their points are shown, until 'pointBudget' is reached.
+ *	Each shown node is one section of a UProceduralMeshComponent attached to this component, with a quad per point that faces
+ *	the viewer as it was when the node was shown. UV0 is the corner of the quad, so a material can round the points,
+ *	the vertex colors are the colors of the points.
+ *
+ *	The viewer is the camera of the first player, @see SetViewerLocationOverride.
+ */
+UCLASS(ClassGroup = (RuntimeMeshImportExport), meta = (BlueprintSpawnableComponent))
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportPointCloudComponent : public USceneComponent
+{
+    GENERATED_BODY()
+public:
+
+    URuntimeMeshImportPointCloudComponent();
+
+    //~ Begin UActorComponent Interface
+    virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    //~ End UActorComponent Interface
+
+    // Imports the point cloud on the import thread pool and shows it instead of the current one
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|PointCloud")
+    void LoadPointCloud(const FRuntimeMeshImportPointCloudParam& param);
+
+    // Shows 'inPointCloud' instead of the current one, relative to this component. Null clears it.
+    void SetPointCloud(TSharedPtr<const FRuntimeMeshImportPointCloud, ESPMode::ThreadSafe> inPointCloud);
+
+    TSharedPtr<const FRuntimeMeshImportPointCloud, ESPMode::ThreadSafe> GetPointCloud() const
+    {
+        return pointCloud;
+    }
+
+    // All points of the point cloud, 0 while none is loaded
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|PointCloud")
+    int32 GetNumPoints() const;
+
+    // The points of the nodes that are shown
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|PointCloud")
+    int32 GetNumShownPoints() const
+    {
+        return numShownPoints;
+    }
+
+    // Shows the nodes around 'location' instead of the camera of the first player
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|PointCloud")
+    void SetViewerLocationOverride(const FVector& location);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|PointCloud")
+    void ClearViewerLocationOverride();
+
+    // The points that are shown at most
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "PointCloud", meta = (ClampMin = "1"))
+    int32 pointBudget = 2000000;
+
+    // The edge length of the quads, relative to this component
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "PointCloud", meta = (ClampMin = "0"))
+    float pointSize = 2.f;
+
+    // A node is shown while the spacing of its points divided by its distance to the viewer is above this. Smaller shows more detail.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "PointCloud", meta = (ClampMin = "0"))
+    float minSpacingPerDistance = 0.002f;
+
+    // The nodes that are shown per update at most, so the GameThread does not stall when the viewer jumps
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "PointCloud", meta = (ClampMin = "1"))
+    int32 maxNodesPerUpdate = 8;
+
+    // Seconds between the updates of the shown nodes
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "PointCloud", meta = (ClampMin = "0"))
+    float updateInterval = 0.25f;
+
+    // The material of all sections. Without it the sections have the default material.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "PointCloud")
+    UMaterialInterface* pointMaterial = nullptr;
+
+private:
+    void UpdateNodes();
+    bool GetViewerLocation(FVector& outLocation) const;
+    void ShowNode(const int32 nodeIndex, const FVector& localViewerLocation);
+    void HideNode(const int32 nodeIndex);
+    void ClearNodes();
+
+    UPROPERTY()
+    UProceduralMeshComponent* meshComponent = nullptr;
+
+    TSharedPtr<const FRuntimeMeshImportPointCloud, ESPMode::ThreadSafe> pointCloud;
+    // The section of each shown node
+    TMap<int32, int32> nodeSections;
+    TArray<int32> freeSections;
+    int32 numShownPoints = 0;
+    // Each load gets its own id, so only the last load is shown
+    int32 loadId = 0;
+    float secondsSinceUpdate = 0.f;
+    FVector viewerLocationOverride = FVector::ZeroVector;
+    bool bHasViewerLocationOverride = false;
+};
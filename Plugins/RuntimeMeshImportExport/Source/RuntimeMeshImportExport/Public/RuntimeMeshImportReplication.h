@@ -0,0 +1,104 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RuntimeMeshImportCompactTypes.h"
+
+// How FRuntimeMeshImportReplication encodes a result
+struct FRuntimeMeshImportReplicationOptions
+{
+    // 16 bit positions within the bounds of each section, like KHR_mesh_quantization. A section of 10 m is exact to 0.15 mm.
+    bool bQuantizePositions = true;
+    // Bytes of the payload per chunk before compression. Each chunk is compressed on its own, so it can be decoded as it arrives.
+    // Clamped to FRuntimeMeshImportReplicationReceiver::maxChunkSize.
+    int32 chunkSize = 64 * 1024;
+};
+
+// The chunks of a serialized result, ready to send. Any chunk can be sent again, e.g. the missing ones of a peer that reconnects.
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportReplicationPayload
+{
+    // Same for all chunks of the payload, the hash of the uncompressed payload
+    uint64 transferId = 0;
+    TArray<TArray<uint8>> chunks;
+
+    int64 GetNumBytes() const;
+};
+
+typedef TSharedRef<const FRuntimeMeshImportReplicationPayload, ESPMode::ThreadSafe> FRuntimeMeshImportReplicationPayloadRef;
+typedef TSharedPtr<FRuntimeMeshImportCompactResult, ESPMode::ThreadSafe> FRuntimeMeshImportCompactResultPtr;
+DECLARE_DELEGATE_OneParam(FRuntimeReplicationSerialized, FRuntimeMeshImportReplicationPayloadRef /*payload*/);
+// Null when the received chunks did not decode
+DECLARE_DELEGATE_OneParam(FRuntimeReplicationDeserialized, FRuntimeMeshImportCompactResultPtr /*result*/);
+
+/**
+ *	Collects the chunks of one payload in any order and decodes them as they arrive.
+ *	The chunks of another transfer are rejected, so a late joiner that reconnects can keep its receiver and only ask for GetMissingChunks.
+ *	Not thread safe, but it can live on any thread.
+ */
+class RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportReplicationReceiver
+{
+public:
+    // Larger chunks are rejected, the senders never make them
+    static const int32 maxChunkSize = 1024 * 1024;
+
+    // The payload is allocated when the first chunk arrives. Transfers that announce more than 'maxPayloadSize' bytes are rejected.
+    explicit FRuntimeMeshImportReplicationReceiver(const int64 inMaxPayloadSize = 256 * 1024 * 1024)
+        : maxPayloadSize(inMaxPayloadSize)
+    {
+    }
+
+    // False for a broken chunk or one of another transfer. A chunk that was received already is ignored.
+    bool AddChunk(TArrayView<const uint8> chunk);
+
+    // 0 until the first chunk arrived
+    int32 GetNumChunks() const
+    {
+        return numChunks;
+    }
+
+    int32 GetNumReceivedChunks() const
+    {
+        return numReceived;
+    }
+
+    bool IsComplete() const
+    {
+        return numChunks > 0 && numReceived == numChunks;
+    }
+
+    void GetMissingChunks(TArray<int32>& outChunks) const;
+
+    // Decodes the result once all chunks arrived
+    bool Finish_AnyThread(FRuntimeMeshImportCompactResult& outResult) const;
+
+private:
+    int64 maxPayloadSize;
+    uint64 transferId = 0;
+    int64 payloadSize = 0;
+    int32 chunkSize = 0;
+    int32 numChunks = 0;
+    int32 numReceived = 0;
+    TBitArray<> receivedChunks;
+    TArray<uint8> payload;
+};
+
+/**
+ *	A versioned wire format for sharing import results between peers, so they get render ready meshes without running Assimp.
+ *	The compact result is encoded with quantized positions, the packed streams of FRuntimeMeshImportCompactSection and delta coded indices,
+ *	then split into chunks that are zlib compressed on the worker threads. The BVHs are not sent, the receiver rebuilds them when it needs them.
+ *	The lines and points of the sections are not sent.
+ *	The data is in the native byte order, which is little endian on all platforms the engine supports.
+ */
+struct RUNTIMEMESHIMPORTEXPORT_API FRuntimeMeshImportReplication
+{
+    static FRuntimeMeshImportReplicationPayloadRef Serialize_AnyThread(const FRuntimeMeshImportCompactResult& result, const FRuntimeMeshImportReplicationOptions& options);
+
+    // Serializes on the import thread pool, 'callbackSerialized' is called on the GameThread
+    static void Serialize_Async_Cpp(FRuntimeMeshImportCompactResultPtr result, const FRuntimeMeshImportReplicationOptions& options, FRuntimeReplicationSerialized callbackSerialized);
+
+    // Decodes a complete 'receiver' on the import thread pool, 'callbackDeserialized' is called on the GameThread
+    static void Deserialize_Async_Cpp(FRuntimeMeshImportReplicationReceiver&& receiver, FRuntimeReplicationDeserialized callbackDeserialized);
+};
@@ -0,0 +1,116 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshImportStreamingComponent.generated.h"
+
+class UMaterialInterface;
+class UProceduralMeshComponent;
+class URuntimeMeshImportAsset;
+
+/**
+ *	Streams the files of a model that is split into many files, e.g. a site, by the distance of the viewer.
+ *	Each file is registered with its bounds. A file is loaded through URuntimeMeshImportAssetManager and applied to its own
+ *	UProceduralMeshComponent attached to this component while the viewer is within 'loadRadius' of its bounds,
+ *	the closest files first. It is unloaded once the viewer is farther than 'loadRadius' + 'unloadHysteresis'.
+ *
+ *	The viewer is the camera of the first player, @see SetViewerLocationOverride.
+ *	The unloaded assets stay in the asset manager until its budget evicts them, so coming back is fast.
+ */
+UCLASS(ClassGroup = (RuntimeMeshImportExport), meta = (BlueprintSpawnableComponent))
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshImportStreamingComponent : public USceneComponent
+{
+    GENERATED_BODY()
+public:
+
+    URuntimeMeshImportStreamingComponent();
+
+    //~ Begin UActorComponent Interface
+    virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+    //~ End UActorComponent Interface
+
+    /**
+     *	Registers a file that is streamed in when the viewer comes within range of 'bounds'.
+     *	@param bounds	The bounds of the file after the import, relative to this component
+     *	@returns		The id of the file
+     */
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Streaming")
+    int32 AddStreamingFile(const FRuntimeMeshImportParam& param, const FBox& bounds);
+
+    // Unloads the file and stops streaming it
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Streaming")
+    void RemoveStreamingFile(const int32 fileId);
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Streaming")
+    ERuntimeMeshImportStreamingState GetFileState(const int32 fileId) const;
+
+    // The component of a loaded file, nullptr while it is not loaded
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Streaming")
+    UProceduralMeshComponent* GetFileComponent(const int32 fileId) const;
+
+    // Streams around 'location' instead of the camera of the first player
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Streaming")
+    void SetViewerLocationOverride(const FVector& location);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Streaming")
+    void ClearViewerLocationOverride();
+
+    // Files closer than this to the viewer are loaded
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Streaming", meta = (ClampMin = "0"))
+    float loadRadius = 10000.f;
+
+    // Loaded files are unloaded beyond 'loadRadius' plus this, so a viewer at the border does not load and unload them every update
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Streaming", meta = (ClampMin = "0"))
+    float unloadHysteresis = 2000.f;
+
+    // The files that are loaded at the same time
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Streaming", meta = (ClampMin = "1"))
+    int32 maxConcurrentLoads = 2;
+
+    // Seconds between the distance checks
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Streaming", meta = (ClampMin = "0"))
+    float updateInterval = 0.25f;
+
+    // The parent of the dynamic materials of the files. Without it the sections have the default material.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Streaming")
+    UMaterialInterface* sourceMaterial = nullptr;
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Streaming")
+    bool bCreateCollision = false;
+
+private:
+    struct FStreamingFile
+    {
+        FRuntimeMeshImportParam param;
+        FBox bounds = FBox(ForceInit);
+        ERuntimeMeshImportStreamingState state = ERuntimeMeshImportStreamingState::Unloaded;
+        TWeakObjectPtr<UProceduralMeshComponent> component;
+        // Each load gets its own id, so a load that finishes after the file was unloaded is dropped
+        int32 loadId = 0;
+        // A file that failed to import is not loaded again
+        bool bLoadFailed = false;
+    };
+
+    void UpdateStreaming();
+    bool GetViewerLocation(FVector& outLocation) const;
+    void LoadFile(const int32 fileId, FStreamingFile& file);
+    void UnloadFile(const int32 fileId, FStreamingFile& file);
+    void OnAssetLoaded(const int32 fileId, const int32 loadId, URuntimeMeshImportAsset* asset);
+    void OnFileApplied(const int32 fileId, const int32 loadId);
+
+    // The assets that are applied to the components of their files, by file id. The loaded files do not keep their asset.
+    UPROPERTY()
+    TMap<int32, URuntimeMeshImportAsset*> applyingAssets;
+
+    TMap<int32, FStreamingFile> files;
+    int32 nextFileId = 0;
+    float secondsSinceUpdate = 0.f;
+    FVector viewerLocationOverride = FVector::ZeroVector;
+    bool bHasViewerLocationOverride = false;
+};
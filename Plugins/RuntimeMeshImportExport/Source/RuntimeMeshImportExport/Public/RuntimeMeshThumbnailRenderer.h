@@ -0,0 +1,186 @@
+// MIT License
+//
+// Copyright (c) 2019 Lucid Layers
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Engine/EngineTypes.h"
+#include "RuntimeMeshImportExportTypes.h"
+#include "RuntimeMeshThumbnailRenderer.generated.h"
+
+class AActor;
+class FRenderCommandFence;
+class UMaterialInterface;
+class UProceduralMeshComponent;
+class USceneCaptureComponent2D;
+class UTextureRenderTarget2D;
+class UWorld;
+
+USTRUCT(BlueprintType)
+struct FRuntimeMeshThumbnailParam
+{
+    GENERATED_BODY()
+
+    // Depending on 'pathType', like FRuntimeMeshImportParam::file
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    EPathType pathType = EPathType::Absolute;
+
+    // Width and height of the thumbnails
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "16", ClampMax = "2048"))
+    int32 resolution = 256;
+
+    // The PNG files are named by the MD5 of the file they show and a hash of these settings. Relative to the project's Saved directory unless absolute.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FString cacheDirectory = TEXT("RuntimeMeshThumbnails");
+
+    // Files the probe finds more triangles in are simplified down to about this many on the import thread
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "100"))
+    int32 maxTriangles = 50000;
+
+    // Files that are hashed, probed and imported at the same time on the import thread pool
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "1"))
+    int32 maxConcurrentImports = 4;
+
+    // The render targets in the pool, also the most thumbnails captured per tick
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "1", ClampMax = "64"))
+    int32 batchSize = 8;
+
+    // The direction the camera looks at the imported scene
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FRotator viewRotation = FRotator(-25.f, -135.f, 0.f);
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default", meta = (ClampMin = "5", ClampMax = "120"))
+    float fieldOfView = 30.f;
+
+    // Where the meshes are placed in the world. Only the scene capture renders them, but they are lit by the lights of the world.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    FVector stageLocation = FVector(0.f, 0.f, -100000.f);
+
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    TEnumAsByte<ESceneCaptureSource> captureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+
+    // The material of all sections, the textures of the files are not read. The default surface material when not set.
+    UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Default")
+    UMaterialInterface* material = nullptr;
+};
+
+// 'pngFile' is empty when the file could not be imported
+DECLARE_DELEGATE_TwoParams(FRuntimeThumbnailFinished, const int32 /*fileIndex*/, const FString& /*pngFile*/);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FRuntimeThumbnailFinishedDyn, int32, fileIndex, const FString&, pngFile);
+DECLARE_DELEGATE(FRuntimeThumbnailBatchFinished);
+DECLARE_DYNAMIC_DELEGATE(FRuntimeThumbnailBatchFinishedDyn);
+
+/**
+ *	Renders thumbnails of many files to cached PNG files.
+ *
+ *	Each file is hashed, probed and imported on the import thread pool, reduced to a single merged mesh without textures
+ *	and simplified when the probe finds more than FRuntimeMeshThumbnailParam::maxTriangles. The meshes are converted for a pool
+ *	of procedural mesh components on the workers as well. A single scene capture renders them off-screen in batches into a pool of render targets
+ *	that are read back without stalling the GameThread, the PNGs are encoded and written on the workers.
+ *	A file whose PNG is already in the cache is neither imported nor rendered.
+ *	The progress reports the number of finished files with type ERuntimeMeshImportExportProgressType::ImportingFiles.
+ *	Only one batch can be rendered at a time per renderer.
+ */
+UCLASS(BlueprintType)
+class RUNTIMEMESHIMPORTEXPORT_API URuntimeMeshThumbnailRenderer : public UObject
+{
+    GENERATED_BODY()
+public:
+
+    virtual void BeginDestroy() override;
+
+    /**
+     *	Renders the thumbnails of 'files' asynchronous. Must be called on the GameThread.
+     *
+     *	@param worldContextObject		The meshes and the scene capture are spawned in its world
+     *	@param callbackThumbnail		Fired for each file when its PNG is written. 'fileIndex' is the index in 'files'
+     *	@param callbackProgress			Fired when a file is done
+     *	@param callbackFinished			Fired after all files are done
+     *	@returns						false when a batch is already being rendered or there is no world
+     */
+    bool RenderThumbnails_Async_Cpp(UObject* worldContextObject, const TArray<FString>& files, const FRuntimeMeshThumbnailParam& param
+                                    , FRuntimeThumbnailFinished callbackThumbnail
+                                    , FRuntimeMeshImportExportProgressUpdate callbackProgress
+                                    , FRuntimeThumbnailBatchFinished callbackFinished);
+
+    UFUNCTION(BlueprintCallable, Category = "RuntimeMeshImportExport|Import", meta = (WorldContext = "worldContextObject"))
+    bool RenderThumbnails_Async(UObject* worldContextObject, const TArray<FString>& files, const FRuntimeMeshThumbnailParam& param
+                                , FRuntimeThumbnailFinishedDyn thumbnailDelegate
+                                , FRuntimeMeshImportExportProgressUpdateDyn progressDelegate
+                                , FRuntimeThumbnailBatchFinishedDyn finishedDelegate);
+
+    UFUNCTION(BlueprintPure, Category = "RuntimeMeshImportExport|Import")
+    bool GetIsRendering() const;
+
+private:
+    enum class ESlotState : uint8
+    {
+        Free,
+        // The sections are converted for the component
+        Applying,
+        // The render state of the component is created at the end of the frame it was applied in
+        Applied,
+        // Waiting for the read back of the render target
+        Capturing,
+    };
+
+    struct FSlot
+    {
+        ESlotState state = ESlotState::Free;
+        int32 fileIndex = INDEX_NONE;
+        FString pngFile;
+        FBox bounds = FBox(ForceInit);
+        uint64 appliedFrame = 0;
+        TSharedPtr<FRenderCommandFence> fence;
+        TSharedPtr<TArray<FColor>, ESPMode::ThreadSafe> pixels;
+    };
+
+    // A file whose mesh is imported and waits for a free slot
+    struct FReadyFile
+    {
+        int32 fileIndex = INDEX_NONE;
+        FString pngFile;
+        FRuntimeMeshImportResultPtr result;
+    };
+
+    bool CreateStage(UWorld* world);
+    void DestroyStage();
+    void StartPendingImports();
+    void OnFilePrepared(const int32 fileIndex, const FString& pngFile, const bool bCached, FRuntimeMeshImportResultPtr result);
+    void OnFileFinished(const int32 fileIndex, const FString& pngFile);
+    bool Tick(float deltaTime);
+    void CaptureSlot(const int32 slotIndex);
+    void FinishBatch();
+
+    UPROPERTY()
+    FRuntimeMeshThumbnailParam param;
+
+    UPROPERTY()
+    AActor* stageActor = nullptr;
+
+    UPROPERTY()
+    USceneCaptureComponent2D* captureComponent = nullptr;
+
+    // One of each per slot
+    UPROPERTY()
+    TArray<UProceduralMeshComponent*> meshComponents;
+
+    UPROPERTY()
+    TArray<UTextureRenderTarget2D*> renderTargets;
+
+    TArray<FSlot> slots;
+    TArray<FString> pendingFiles;
+    TArray<FReadyFile> readyFiles;
+    uint32 settingsHash = 0;
+    int32 nextPendingIndex = 0;
+    int32 numInFlight = 0;
+    int32 numFinished = 0;
+    bool bIsRendering = false;
+    FDelegateHandle tickHandle;
+
+    FRuntimeThumbnailFinished delegateThumbnail;
+    FRuntimeMeshImportExportProgressUpdate delegateProgress;
+    FRuntimeThumbnailBatchFinished delegateFinished;
+};
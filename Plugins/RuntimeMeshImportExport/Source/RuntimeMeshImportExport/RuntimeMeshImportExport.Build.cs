@@ -8,6 +8,7 @@ using UnrealBuildTool;
 using System;
 using System.IO;
 using System.Diagnostics;
+using Tools.DotNETCommon;
 
 namespace UnrealBuildTool.Rules
 {
@@ -23,6 +24,42 @@ namespace UnrealBuildTool.Rules
             get { return Path.GetFullPath(Path.Combine(ModulePath, "../ThirdParty/")); }
         }
 
+        /**
+         * The Assimp build to link on Windows, set in the DefaultEngine.ini of the project:
+         *     [RuntimeMeshImportExport]
+         *     AssimpBuild=Release
+         * "Debug"      The debug dll, the default while it is the only build in ThirdParty
+         * "Release"    The optimized dll, so Development and Test builds profile the Assimp that ships
+         * "StaticLTO"  The static libraries built with /GL from assimp/lib/<Platform>/ReleaseLTO, linked with the program by link time code generation
+         * A build whose files are missing falls back to Debug with a warning.
+         */
+        private string GetAssimpBuild(ReadOnlyTargetRules Target, string PlatformString)
+        {
+            string assimpBuild = "Debug";
+            DirectoryReference projectDirectory = Target.ProjectFile != null ? Target.ProjectFile.Directory : null;
+            ConfigHierarchy engineConfig = ConfigCache.ReadHierarchy(ConfigHierarchyType.Engine, projectDirectory, Target.Platform);
+            string configuredBuild;
+            if (engineConfig.GetString("RuntimeMeshImportExport", "AssimpBuild", out configuredBuild) && !String.IsNullOrEmpty(configuredBuild))
+            {
+                assimpBuild = configuredBuild;
+            }
+            if (assimpBuild != "Release" && assimpBuild != "Debug" && assimpBuild != "StaticLTO")
+            {
+                Log.TraceWarning("Unknown AssimpBuild " + assimpBuild + ", using Debug");
+                assimpBuild = "Debug";
+            }
+
+            string buildDirectory = assimpBuild == "StaticLTO"
+                ? Path.Combine(ThirdPartyPath, "assimp/lib", PlatformString, "ReleaseLTO")
+                : Path.Combine(ThirdPartyPath, "assimp/bin", PlatformString, assimpBuild);
+            if (assimpBuild != "Debug" && !Directory.Exists(buildDirectory))
+            {
+                Log.TraceWarning("The " + assimpBuild + " build of Assimp is missing in " + buildDirectory + ", using Debug");
+                assimpBuild = "Debug";
+            }
+            return assimpBuild;
+        }
+
 
         public RuntimeMeshImportExport(ReadOnlyTargetRules Target) : base(Target)
         {
@@ -31,8 +68,6 @@ namespace UnrealBuildTool.Rules
             PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
             bEnableExceptions = true;
 
-            PublicDefinitions.AddRange(new string[] { "ASSIMP_DLL" });
-
             PublicIncludePaths.AddRange(
                 new string[] {
                 Path.Combine(ModuleDirectory, "Public"),
@@ -78,11 +113,31 @@ namespace UnrealBuildTool.Rules
                     //	"SlateCore",
                     // ... add private dependencies that you statically link with here ...	
                     // 
-                    "Projects"                    
+                    "Projects",
+                    "ImageWrapper",
+                    "PhysicsCore",
+                    "Json",
+                    "JsonUtilities",
+                    "MikkTSpace",
+                    "RHI",
+                    "RenderCore"
                 }
                 );
 
 
+            // DirectoryWatcher is a Developer module, it can only be linked where the developer tools are built.
+            // URuntimeMeshImportHotReloadComponent polls the timestamp of its file without it.
+            if (Target.bBuildDeveloperTools)
+            {
+                PrivateDependencyModuleNames.Add("DirectoryWatcher");
+                PrivateDefinitions.Add("WITH_RMIE_DIRECTORY_WATCHER=1");
+            }
+            else
+            {
+                PrivateDefinitions.Add("WITH_RMIE_DIRECTORY_WATCHER=0");
+            }
+
+
             DynamicallyLoadedModuleNames.AddRange(
                 new string[]
                 {
@@ -92,30 +147,65 @@ namespace UnrealBuildTool.Rules
             if ((Target.Platform == UnrealTargetPlatform.Win64) || (Target.Platform == UnrealTargetPlatform.Win32))
             {
                 string PlatformString = (Target.Platform == UnrealTargetPlatform.Win64) ? "x64" : "Win32";
-                string ConfigurationString = (Target.Configuration == UnrealTargetConfiguration.Shipping) ? "Release" : "Debug";
-                string FileNameNoExt = "assimp-vc141-mt" + (Target.Configuration == UnrealTargetConfiguration.Shipping ? "" : "d");
+                string assimpBuild = GetAssimpBuild(Target, PlatformString);
+                Log.TraceInformation("RuntimeMeshImportExport links the " + assimpBuild + " build of Assimp");
 
-                string libFile = Path.Combine(ThirdPartyPath, "assimp/lib", PlatformString, ConfigurationString, FileNameNoExt + ".lib");
-                if(!File.Exists(libFile))
+                if (assimpBuild == "StaticLTO")
                 {
-                    //Log.TraceInformation("Missing file: " + libFile);
-                    Console.Error.WriteLine("Missing file: " + libFile);
+                    // Assimp and the libraries it was built with, e.g. zlibstatic and IrrXML
+                    string libDirectory = Path.Combine(ThirdPartyPath, "assimp/lib", PlatformString, "ReleaseLTO");
+                    string[] libFiles = Directory.Exists(libDirectory) ? Directory.GetFiles(libDirectory, "*.lib") : new string[0];
+                    if (libFiles.Length == 0)
+                    {
+                        Console.Error.WriteLine("Missing files: " + Path.Combine(libDirectory, "*.lib"));
+                    }
+                    PublicAdditionalLibraries.AddRange(libFiles);
+                    // The objects are compiled with /GL, without LTCG the linker restarts with it for this module anyway
+                    PublicDefinitions.Add("RMIE_ASSIMP_STATIC=1");
                 }
-                PublicAdditionalLibraries.Add(libFile);
-
-                string dllFileName = FileNameNoExt + ".dll";
-                string dllFile = Path.Combine(ThirdPartyPath, "assimp/bin", PlatformString, ConfigurationString, dllFileName);
-                if (!File.Exists(dllFile))
+                else
                 {
-                    //Log.TraceInformation("Missing file: " + dllFile);
-                    Console.Error.WriteLine("Missing file: " + dllFile);
+                    string ConfigurationString = assimpBuild;
+                    string FileNameNoExt = "assimp-vc141-mt" + (assimpBuild == "Debug" ? "d" : "");
+
+                    string libFile = Path.Combine(ThirdPartyPath, "assimp/lib", PlatformString, ConfigurationString, FileNameNoExt + ".lib");
+                    if(!File.Exists(libFile))
+                    {
+                        //Log.TraceInformation("Missing file: " + libFile);
+                        Console.Error.WriteLine("Missing file: " + libFile);
+                    }
+                    PublicAdditionalLibraries.Add(libFile);
+
+                    string dllFileName = FileNameNoExt + ".dll";
+                    string dllFile = Path.Combine(ThirdPartyPath, "assimp/bin", PlatformString, ConfigurationString, dllFileName);
+                    if (!File.Exists(dllFile))
+                    {
+                        //Log.TraceInformation("Missing file: " + dllFile);
+                        Console.Error.WriteLine("Missing file: " + dllFile);
+                    }
+
+                    // Does only declare the file as dependency and seems important for packaging. Though it does not load the file.
+                    RuntimeDependencies.Add(dllFile);
+                    // The .dll is loaded manually with the start of the module. See the AnswerHub entry.
+                    // https://answers.unrealengine.com/questions/427772/adding-dll-path-for-plugin.html
+                    PublicDelayLoadDLLs.Add(dllFileName);
+                    PublicDefinitions.AddRange(new string[] { "ASSIMP_DLL", "RMIE_ASSIMP_STATIC=0" });
+                    // Relative to Source/ThirdParty/assimp/bin of the plugin
+                    PrivateDefinitions.Add("RMIE_ASSIMP_DLL_PATH=\"" + PlatformString + "/" + ConfigurationString + "/" + dllFileName + "\"");
                 }
-
-                // Does only declare the file as dependency and seems important for packaging. Though it does not load the file.
-                RuntimeDependencies.Add(dllFile);
-                // The .dll is loaded manually with the start of the module. See the AnswerHub entry.
-                // https://answers.unrealengine.com/questions/427772/adding-dll-path-for-plugin.html
-                PublicDelayLoadDLLs.Add(dllFileName);
+            }
+            else if (Target.Platform == UnrealTargetPlatform.Linux)
+            {
+                // Build Assimp as a shared library with the libc++ of the engine toolchain, e.g. with -DCMAKE_CXX_FLAGS="-stdlib=libc++ -nostdinc++ -I<Engine>/Source/ThirdParty/Linux/LibCxx/include/c++/v1"
+                string soFile = Path.Combine(ThirdPartyPath, "assimp/lib/Linux", Target.Architecture, "libassimp.so");
+                if (!File.Exists(soFile))
+                {
+                    Console.Error.WriteLine("Missing file: " + soFile);
+                }
+                PublicAdditionalLibraries.Add(soFile);
+                // Staged next to the module, the rpath of the module finds it
+                RuntimeDependencies.Add(soFile);
+                PublicDefinitions.AddRange(new string[] { "ASSIMP_DLL", "RMIE_ASSIMP_STATIC=0" });
             }
             //else if (Target.Platform == UnrealTargetPlatform.Mac)
             //{